@@ -43,7 +43,7 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
 {
   int error;
   uint key;
-  ulong records=0, deleted=0, pos, next_block;
+  ulong records=0, deleted=0, continued=0, pos, next_block;
   HP_SHARE *share=info->s;
   HP_INFO save_info= *info;			/* Needed because scan_init */
   DBUG_ENTER("heap_check_heap");
@@ -69,26 +69,32 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
     else
     {
       next_block+= share->block.records_in_block;
-      if (next_block >= share->records+share->deleted)
+      if (next_block >= share->used_slots)
       {
-	next_block= share->records+share->deleted;
+	next_block= share->used_slots;
 	if (pos >= next_block)
 	  break;				/* End of file */
       }
     }
     hp_find_record(info,pos);
 
-    if (!info->current_ptr[share->reclength])
+    switch (info->current_ptr[share->visible]) {
+    case HP_SLOT_DELETED:
       deleted++;
-    else
+      break;
+    case HP_SLOT_CONTINUED:
+      continued++;
+      break;
+    default:
       records++;
+    }
   }
 
   if (records != share->records || deleted != share->deleted)
   {
-    DBUG_PRINT("error",("Found rows: %lu (%lu)  deleted %lu (%lu)",
-			records, (ulong) share->records,
-                        deleted, (ulong) share->deleted));
+    DBUG_PRINT("error",("Found rows: %lu (%lu)  deleted %lu (%lu)  "
+                        "continued %lu", records, (ulong) share->records,
+                        deleted, (ulong) share->deleted, continued));
     error= 1;
   }
   *info= save_info;
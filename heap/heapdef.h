@@ -33,6 +33,22 @@
 #define HP_MIN_RECORDS_IN_BLOCK 16
 #define HP_MAX_RECORDS_IN_BLOCK 8192
 
+/*
+  The byte at HP_SHARE::visible of a record slot tells if the slot is
+  free, holds a row or holds a continuation chunk of a dynamic row
+*/
+
+#define HP_SLOT_DELETED		0
+#define HP_SLOT_ROW		1
+#define HP_SLOT_CONTINUED	2
+
+/* Minimum number of data bytes in a chunk of a dynamic row */
+#define HP_MIN_CHUNK_LENGTH	64
+
+/* Next chunk of a dynamic row, stored after the data of the chunk */
+#define HP_NEXT_CHUNK(share, pos) \
+  (*((byte**) ((pos) + (share)->chunk_length)))
+
 	/* Some extern variables */
 
 extern LIST *heap_open_list,*heap_share_list;
@@ -63,6 +79,12 @@ extern HP_SHARE *hp_find_named_heap(const char *name);
 extern int hp_rectest(HP_INFO *info,const byte *old);
 extern byte *hp_find_block(HP_BLOCK *info,ulong pos);
 extern int hp_get_new_block(HP_BLOCK *info, ulong* alloc_length);
+extern byte *hp_alloc_slot(HP_SHARE *info);
+extern void hp_free_slots(HP_SHARE *info, byte *pos);
+extern int hp_reserve_chunks(HP_INFO *info, const byte *record, byte *pos);
+extern void hp_store_dynamic(HP_INFO *info, const byte *record, byte *pos);
+extern int hp_extract_record(HP_INFO *info, byte *record, const byte *pos);
+extern int hp_dynamic_rectest(HP_INFO *info, const byte *old);
 extern void hp_free(HP_SHARE *info);
 extern byte *hp_free_level(HP_BLOCK *block,uint level,HP_PTRS *pos,
 			   byte *last_pos);
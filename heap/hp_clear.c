@@ -36,6 +36,7 @@ void hp_clear(HP_SHARE *info)
   info->block.levels=0;
   hp_clear_keys(info);
   info->records= info->deleted= 0;
+  info->used_slots= 0;
   info->data_length= 0;
   info->blength=1;
   info->changed=0;
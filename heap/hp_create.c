@@ -18,12 +18,14 @@
 static int keys_compare(heap_rb_param *param, uchar *key1, uchar *key2);
 static void init_block(HP_BLOCK *block,uint reclength,ulong min_records,
 		       ulong max_records);
+static void init_dynamic_columns(HP_SHARE *share, HP_CREATE_INFO *create_info);
 
 int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
 		uint reclength, ulong max_records, ulong min_records,
 		HP_CREATE_INFO *create_info)
 {
-  uint i, j, key_segs, max_length, length;
+  uint i, j, key_segs, max_length, length, columns;
+  ulong max_slots;
   HP_SHARE *share;
   HA_KEYSEG *keyseg;
   
@@ -46,6 +48,8 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       so the record length should be at least sizeof(byte*)
     */
     set_if_bigger(reclength, sizeof (byte*));
+    /* Room for the packed columns and the gaps between them */
+    columns= create_info->columns ? 2 * create_info->columns + 1 : 0;
     
     for (i= key_segs= max_length= 0, keyinfo= keydef; i < keys; i++, keyinfo++)
     {
@@ -129,7 +133,8 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+				       columns*sizeof(HP_COLUMNDEF),
 				       MYF(MY_ZEROFILL))))
     {
       pthread_mutex_unlock(&THR_LOCK_heap);
@@ -138,7 +143,7 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
     share->keydef= (HP_KEYDEF*) (share + 1);
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
-    init_block(&share->block, reclength + 1, min_records, max_records);
+    share->columndef= (HP_COLUMNDEF*) (keyseg + key_segs);
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
@@ -173,13 +178,24 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
       if ((keyinfo->flag & HA_AUTO_KEY) && create_info->with_auto_increment)
         share->auto_key= i + 1;
     }
+    share->keys= keys;
+    share->reclength= reclength;
+    max_slots= max_records;
+    if (create_info->columns)
+    {
+      init_dynamic_columns(share, create_info);
+      share->visible= share->chunk_length + sizeof(byte*);
+      /* A row takes an unknown number of slots, size blocks by memory */
+      max_slots= (ulong) (create_info->max_table_size / (share->visible + 1));
+    }
+    else
+      share->visible= reclength;
+    init_block(&share->block, share->visible + 1, min_records, max_slots);
     share->min_records= min_records;
     share->max_records= max_records;
     share->max_table_size= create_info->max_table_size;
     share->data_length= share->index_length= 0;
-    share->reclength= reclength;
     share->blength= 1;
-    share->keys= keys;
     share->max_key_length= max_length;
     share->changed= 0;
     share->auto_key= create_info->auto_key;
@@ -203,6 +219,117 @@ int heap_create(const char *name, uint keys, HP_KEYDEF *keydef,
   DBUG_RETURN(0);
 } /* heap_create */
 
+/*
+  Set up the storage of rows of variable length
+
+  SYNOPSIS
+    init_dynamic_columns()
+    share		Table, with keys already set up
+    create_info		Columns of the record, ordered by offset
+
+  DESCRIPTION
+    The part of the record up to the end of the last key column is stored
+    as is in the first chunk of a row, so that the keys can compare the
+    stored row directly. The columns after it (and the data of BLOBs that
+    happen to lie in the first part) are packed, gaps between the given
+    columns are kept as fixed columns. The chunk is big enough for the
+    shortest packed row plus a quarter of the maximum length of the
+    VARCHARs, or some bytes of every BLOB.
+*/
+
+static void init_dynamic_columns(HP_SHARE *share, HP_CREATE_INFO *create_info)
+{
+  HP_KEYDEF *keyinfo, *keyend;
+  HA_KEYSEG *seg, *segend;
+  HP_COLUMNDEF *column, *end, *def, *last= 0;
+  uint fixed_length= 0, pos, min_length, var_length= 0, blobs= 0;
+  uint chunk_length;
+
+  for (keyinfo= share->keydef, keyend= keyinfo + share->keys;
+       keyinfo < keyend; keyinfo++)
+  {
+    for (seg= keyinfo->seg, segend= seg + keyinfo->keysegs; seg < segend; seg++)
+    {
+      pos= seg->start + seg->length;
+      if (seg->type == HA_KEYTYPE_VARTEXT1)
+        pos+= seg->bit_start;
+      set_if_bigger(fixed_length, pos);
+      if (seg->null_bit)
+        set_if_bigger(fixed_length, seg->null_pos + 1);
+      if (seg->type == HA_KEYTYPE_BIT && seg->bit_length)
+        set_if_bigger(fixed_length, (uint) seg->bit_pos + 1);
+    }
+  }
+  end= create_info->columndef + create_info->columns;
+  for (column= create_info->columndef; column < end; column++)
+  {
+    if (column->offset < fixed_length &&
+        column->offset + column->length > fixed_length)
+      fixed_length= column->offset + column->length;
+  }
+
+  def= share->columndef;
+  for (column= create_info->columndef; column < end; column++)
+  {
+    if (column->type == HP_COLUMN_BLOB && column->offset < fixed_length)
+      *def++= *column;
+  }
+  for (column= create_info->columndef, pos= fixed_length; column < end;
+       column++)
+  {
+    if (column->offset < fixed_length || !column->length)
+      continue;
+    if (column->offset > pos)
+    {
+      bzero((char*) def, sizeof(*def));
+      def->offset= pos;
+      def->length= column->offset - pos;
+      last= def++;
+    }
+    if (column->type == HP_COLUMN_FIXED && last &&
+        last->type == HP_COLUMN_FIXED &&
+        last->offset + last->length == column->offset)
+      last->length+= column->length;
+    else
+    {
+      *def= *column;
+      last= def++;
+    }
+    pos= column->offset + column->length;
+  }
+  if (pos < share->reclength)
+  {
+    bzero((char*) def, sizeof(*def));
+    def->offset= pos;
+    def->length= share->reclength - pos;
+    def++;
+  }
+  share->columns= (uint) (def - share->columndef);
+  share->fixed_length= fixed_length;
+
+  /* The fixed part and the length of the packed part are always stored */
+  min_length= fixed_length + 4;
+  for (def= share->columndef, end= def + share->columns; def < end; def++)
+  {
+    if (def->type == HP_COLUMN_FIXED)
+      min_length+= def->length;
+    else
+    {
+      min_length+= def->length_bytes;
+      if (def->type == HP_COLUMN_BLOB)
+        blobs++;
+      else
+        var_length+= def->length - def->length_bytes;
+    }
+  }
+  chunk_length= min_length + var_length / 4 + blobs * HP_MIN_CHUNK_LENGTH;
+  set_if_bigger(chunk_length, HP_MIN_CHUNK_LENGTH);
+  if (!blobs)
+    set_if_smaller(chunk_length, min_length + var_length);
+  share->chunk_length= MY_ALIGN(chunk_length, sizeof(byte*));
+}
+
+
 static int keys_compare(heap_rb_param *param, uchar *key1, uchar *key2)
 {
   uint not_used[2];
@@ -43,10 +43,7 @@ int heap_delete(HP_INFO *info, const byte *record)
   }
 
   info->update=HA_STATE_DELETED;
-  *((byte**) pos)=share->del_link;
-  share->del_link=pos;
-  pos[share->reclength]=0;		/* Record deleted */
-  share->deleted++;
+  hp_free_slots(share, pos);		/* Record deleted */
   info->current_hash_ptr=0;
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
   DBUG_EXECUTE("check_heap",heap_check_heap(info, 0););
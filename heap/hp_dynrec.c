@@ -0,0 +1,462 @@
+/* Copyright (C) 2000-2006 MySQL AB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Allocation of record slots and rows of variable length.
+
+  A table with rows of variable length (share->chunk_length != 0) stores
+  a row in a chain of record slots (chunks). Every chunk has chunk_length
+  bytes of data followed by a pointer to the next chunk of the row and
+  the byte at share->visible, which is HP_SLOT_ROW for the first chunk of
+  a row and HP_SLOT_CONTINUED for the others.
+
+  The data of a row is:
+    - the first share->fixed_length bytes of the record, which contain all
+      key columns, so that the keys can use the stored row as is
+    - 4 bytes with the length of the packed columns
+    - the packed columns of share->columndef: fixed columns as they are,
+      VARCHAR and BLOB columns as length + used data
+*/
+
+#include "heapdef.h"
+
+typedef struct st_hp_chunk_pos
+{
+  byte *chunk;				/* Current chunk */
+  uint offset;				/* Offset of the next byte in chunk */
+} HP_CHUNK_POS;
+
+typedef my_bool (*hp_chunk_op)(HP_SHARE *share, HP_CHUNK_POS *cur,
+                               const byte *data, ulong length);
+
+
+	/* Find where to place new record */
+
+byte *hp_alloc_slot(HP_SHARE *info)
+{
+  int block_pos;
+  byte *pos;
+  ulong length;
+  DBUG_ENTER("hp_alloc_slot");
+
+  if (info->del_link)
+  {
+    pos=info->del_link;
+    info->del_link= *((byte**) pos);
+    info->deleted--;
+    DBUG_PRINT("exit",("Used old position: 0x%lx",(long) pos));
+    DBUG_RETURN(pos);
+  }
+  if (!(block_pos=(info->used_slots % info->block.records_in_block)))
+  {
+    if ((info->records > info->max_records && info->max_records) ||
+        (info->data_length + info->index_length >= info->max_table_size))
+    {
+      my_errno=HA_ERR_RECORD_FILE_FULL;
+      DBUG_RETURN(NULL);
+    }
+    if (hp_get_new_block(&info->block,&length))
+      DBUG_RETURN(NULL);
+    info->data_length+=length;
+  }
+  info->used_slots++;
+  DBUG_PRINT("exit",("Used new position: 0x%lx",
+		     (long) ((byte*) info->block.level_info[0].last_blocks+
+                             block_pos * info->block.recbuffer)));
+  DBUG_RETURN((byte*) info->block.level_info[0].last_blocks+
+	      block_pos*info->block.recbuffer);
+}
+
+
+/*
+  Put a record slot and all following chunks of its row on the free list
+*/
+
+void hp_free_slots(HP_SHARE *info, byte *pos)
+{
+  byte *next;
+  do
+  {
+    next= info->chunk_length ? HP_NEXT_CHUNK(info, pos) : 0;
+    *((byte**) pos)= info->del_link;
+    info->del_link= pos;
+    pos[info->visible]= HP_SLOT_DELETED;
+    info->deleted++;
+  } while ((pos= next));
+}
+
+
+static void hp_next_chunk(HP_SHARE *share, HP_CHUNK_POS *cur)
+{
+  if (cur->offset == share->chunk_length)
+  {
+    cur->chunk= HP_NEXT_CHUNK(share, cur->chunk);
+    cur->offset= 0;
+  }
+}
+
+
+static my_bool hp_chunk_write(HP_SHARE *share, HP_CHUNK_POS *cur,
+                              const byte *data, ulong length)
+{
+  while (length)
+  {
+    uint part;
+    hp_next_chunk(share, cur);
+    part= (uint) min(length, share->chunk_length - cur->offset);
+    memcpy(cur->chunk + cur->offset, data, part);
+    cur->offset+= part;
+    data+= part;
+    length-= part;
+  }
+  return 0;
+}
+
+
+static my_bool hp_chunk_cmp(HP_SHARE *share, HP_CHUNK_POS *cur,
+                            const byte *data, ulong length)
+{
+  while (length)
+  {
+    uint part;
+    hp_next_chunk(share, cur);
+    part= (uint) min(length, share->chunk_length - cur->offset);
+    if (memcmp(cur->chunk + cur->offset, data, part))
+      return 1;
+    cur->offset+= part;
+    data+= part;
+    length-= part;
+  }
+  return 0;
+}
+
+
+static my_bool hp_chunk_skip(HP_SHARE *share, HP_CHUNK_POS *cur,
+                             const byte *data __attribute__((unused)),
+                             ulong length)
+{
+  while (length)
+  {
+    uint part;
+    hp_next_chunk(share, cur);
+    part= (uint) min(length, share->chunk_length - cur->offset);
+    cur->offset+= part;
+    length-= part;
+  }
+  return 0;
+}
+
+
+static void hp_chunk_read(HP_SHARE *share, HP_CHUNK_POS *cur,
+                          byte *to, ulong length)
+{
+  while (length)
+  {
+    uint part;
+    hp_next_chunk(share, cur);
+    part= (uint) min(length, share->chunk_length - cur->offset);
+    memcpy(to, cur->chunk + cur->offset, part);
+    cur->offset+= part;
+    to+= part;
+    length-= part;
+  }
+}
+
+
+static ulong hp_get_data_length(const byte *pos, uint length_bytes)
+{
+  switch (length_bytes) {
+  case 1:
+    return (ulong) (uchar) *pos;
+  case 2:
+    return (ulong) uint2korr(pos);
+  case 3:
+    return (ulong) uint3korr(pos);
+  }
+  return (ulong) uint4korr(pos);
+}
+
+
+static void hp_store_data_length(byte *pos, uint length_bytes, ulong length)
+{
+  switch (length_bytes) {
+  case 1:
+    *pos= (byte) length;
+    break;
+  case 2:
+    int2store(pos, length);
+    break;
+  case 3:
+    int3store(pos, length);
+    break;
+  default:
+    int4store(pos, length);
+  }
+}
+
+
+/* Used length of a VARCHAR or BLOB column; NULL values are stored empty */
+
+static ulong hp_column_data_length(HP_COLUMNDEF *column, const byte *record)
+{
+  if (column->null_bit && (record[column->null_pos] & column->null_bit))
+    return 0;
+  return hp_get_data_length(record + column->offset, column->length_bytes);
+}
+
+
+static const byte *hp_column_data(HP_COLUMNDEF *column, const byte *record)
+{
+  const byte *data= record + column->offset + column->length_bytes;
+  if (column->type == HP_COLUMN_BLOB)
+    memcpy_fixed(&data, data, sizeof(char*));
+  return data;
+}
+
+
+/* Length of the packed columns of a record */
+
+static ulong hp_packed_length(HP_SHARE *share, const byte *record)
+{
+  HP_COLUMNDEF *column, *end;
+  ulong length= 0;
+
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    if (column->type == HP_COLUMN_FIXED)
+      length+= column->length;
+    else
+      length+= column->length_bytes + hp_column_data_length(column, record);
+  }
+  return length;
+}
+
+
+/*
+  Run op on the data of a row as it is stored in the chunks
+
+  NOTES
+    The pointers of the BLOBs in the fixed part of the record are
+    skipped, the data of these BLOBs follows with the packed columns.
+
+  RETURN
+    0	ok
+    1	op returned 1
+*/
+
+static my_bool hp_pack_row(HP_SHARE *share, const byte *record,
+                           HP_CHUNK_POS *cur, hp_chunk_op op)
+{
+  HP_COLUMNDEF *column, *end;
+  uint start= 0, length_bytes;
+  ulong length;
+  byte buff[4];
+
+  end= share->columndef + share->columns;
+  for (column= share->columndef;
+       column < end && column->offset < share->fixed_length; column++)
+  {
+    uint ptr_pos= column->offset + column->length_bytes;
+    if ((*op)(share, cur, record + start, ptr_pos - start) ||
+        hp_chunk_skip(share, cur, 0, sizeof(char*)))
+      return 1;
+    start= ptr_pos + sizeof(char*);
+  }
+  if ((*op)(share, cur, record + start, share->fixed_length - start))
+    return 1;
+
+  int4store(buff, hp_packed_length(share, record));
+  if ((*op)(share, cur, buff, 4))
+    return 1;
+
+  for (column= share->columndef; column < end; column++)
+  {
+    if (column->type == HP_COLUMN_FIXED)
+    {
+      if ((*op)(share, cur, record + column->offset, column->length))
+        return 1;
+      continue;
+    }
+    length_bytes= column->length_bytes;
+    length= hp_column_data_length(column, record);
+    hp_store_data_length(buff, length_bytes, length);
+    if ((*op)(share, cur, buff, length_bytes) ||
+        (*op)(share, cur, hp_column_data(column, record), length))
+      return 1;
+  }
+  return 0;
+}
+
+
+/*
+  Make sure the chain of chunks starting at pos can hold a record
+
+  SYNOPSIS
+    hp_reserve_chunks()
+    info		Table handler
+    record		Record that will be stored
+    pos			First chunk of the row
+
+  DESCRIPTION
+    Missing chunks are added to the end of the chain. The data already in
+    the chain is not changed, so that the old row is kept if a later step
+    of the update fails.
+
+  RETURN
+    0	ok
+    #	error, the chain is unchanged
+*/
+
+int hp_reserve_chunks(HP_INFO *info, const byte *record, byte *pos)
+{
+  HP_SHARE *share= info->s;
+  byte *last, *end, *chunk;
+  ulong chunks;
+
+  chunks= (share->fixed_length + 4 + hp_packed_length(share, record) +
+           share->chunk_length - 1) / share->chunk_length;
+  for (last= pos; chunks > 1 && HP_NEXT_CHUNK(share, last); chunks--)
+    last= HP_NEXT_CHUNK(share, last);
+  for (end= last; chunks > 1; chunks--)
+  {
+    if (!(chunk= hp_alloc_slot(share)))
+    {
+      if ((chunk= HP_NEXT_CHUNK(share, end)))
+      {
+        HP_NEXT_CHUNK(share, end)= 0;
+        hp_free_slots(share, chunk);
+      }
+      return my_errno;
+    }
+    HP_NEXT_CHUNK(share, chunk)= 0;
+    chunk[share->visible]= HP_SLOT_CONTINUED;
+    HP_NEXT_CHUNK(share, last)= chunk;
+    last= chunk;
+  }
+  return 0;
+}
+
+
+/*
+  Store a record in the chunks reserved by hp_reserve_chunks()
+
+  NOTES
+    Chunks that are not needed any more are freed.
+*/
+
+void hp_store_dynamic(HP_INFO *info, const byte *record, byte *pos)
+{
+  HP_SHARE *share= info->s;
+  HP_CHUNK_POS cur;
+  byte *next;
+
+  cur.chunk= pos;
+  cur.offset= 0;
+  VOID(hp_pack_row(share, record, &cur, hp_chunk_write));
+  if ((next= HP_NEXT_CHUNK(share, cur.chunk)))
+  {
+    HP_NEXT_CHUNK(share, cur.chunk)= 0;
+    hp_free_slots(share, next);
+  }
+}
+
+
+/*
+  Copy a stored row to a record
+
+  NOTES
+    The data of BLOBs is copied to info->blob_buffer, which is valid until
+    the next row is read with the handler.
+
+  RETURN
+    0	ok
+    #	error (out of memory)
+*/
+
+int hp_extract_record(HP_INFO *info, byte *record, const byte *pos)
+{
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  HP_CHUNK_POS cur;
+  byte buff[4], *blob_pos= 0;
+  ulong packed_length, length;
+
+  if (!share->chunk_length)
+  {
+    memcpy(record, pos, (size_t) share->reclength);
+    return 0;
+  }
+  cur.chunk= (byte*) pos;
+  cur.offset= 0;
+  hp_chunk_read(share, &cur, record, share->fixed_length);
+  hp_chunk_read(share, &cur, buff, 4);
+  packed_length= uint4korr(buff);
+
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    byte *to= record + column->offset;
+    if (column->type == HP_COLUMN_FIXED)
+    {
+      hp_chunk_read(share, &cur, to, column->length);
+      continue;
+    }
+    hp_chunk_read(share, &cur, to, column->length_bytes);
+    length= hp_get_data_length(to, column->length_bytes);
+    to+= column->length_bytes;
+    if (column->type == HP_COLUMN_VARCHAR)
+    {
+      hp_chunk_read(share, &cur, to, length);
+      continue;
+    }
+    if (!blob_pos)
+    {
+      if (packed_length > info->blob_buffer_length)
+      {
+        byte *buffer;
+        if (!(buffer= (byte*) my_realloc((gptr) info->blob_buffer,
+                                         (uint) packed_length,
+                                         MYF(MY_ALLOW_ZERO_PTR))))
+          return my_errno= HA_ERR_OUT_OF_MEM;
+        info->blob_buffer= buffer;
+        info->blob_buffer_length= (uint) packed_length;
+      }
+      blob_pos= info->blob_buffer;
+    }
+    hp_chunk_read(share, &cur, blob_pos, length);
+    memcpy_fixed(to, &blob_pos, sizeof(char*));
+    blob_pos+= length;
+  }
+  return 0;
+}
+
+
+/*
+  Test if a record differs from the stored row at info->current_ptr
+
+  RETURN
+    0	Same
+    1	Different
+*/
+
+int hp_dynamic_rectest(HP_INFO *info, const byte *old)
+{
+  HP_CHUNK_POS cur;
+
+  cur.chunk= info->current_ptr;
+  cur.offset= 0;
+  return (int) hp_pack_row(info->s, old, &cur, hp_chunk_cmp);
+}
@@ -31,7 +31,7 @@ int heap_rsame(register HP_INFO *info, byte *record, int inx)
   DBUG_ENTER("heap_rsame");
 
   test_active(info);
-  if (info->current_ptr[share->reclength])
+  if (info->current_ptr[share->visible] == HP_SLOT_ROW)
   {
     if (inx < -1 || inx >= (int) share->keys)
     {
@@ -47,8 +47,7 @@ int heap_rsame(register HP_INFO *info, byte *record, int inx)
 	DBUG_RETURN(my_errno);
       }
     }
-    memcpy(record,info->current_ptr,(size_t) share->reclength);
-    DBUG_RETURN(0);
+    DBUG_RETURN(hp_extract_record(info, record, info->current_ptr));
   }
   info->update=0;
 
@@ -40,33 +40,38 @@ int heap_scan(register HP_INFO *info, byte *record)
   ulong pos;
   DBUG_ENTER("heap_scan");
 
-  pos= ++info->current_record;
-  if (pos < info->next_block)
+  /* Continuation chunks of rows of variable length are skipped */
+  do
   {
-    info->current_ptr+=share->block.recbuffer;
-  }
-  else
-  {
-    info->next_block+=share->block.records_in_block;
-    if (info->next_block >= share->records+share->deleted)
+    pos= ++info->current_record;
+    if (pos < info->next_block)
     {
-      info->next_block= share->records+share->deleted;
-      if (pos >= info->next_block)
+      info->current_ptr+=share->block.recbuffer;
+    }
+    else
+    {
+      info->next_block+=share->block.records_in_block;
+      if (info->next_block >= share->used_slots)
       {
-	info->update= 0;
-	DBUG_RETURN(my_errno= HA_ERR_END_OF_FILE);
+        info->next_block= share->used_slots;
+        if (pos >= info->next_block)
+        {
+          info->update= 0;
+          DBUG_RETURN(my_errno= HA_ERR_END_OF_FILE);
+        }
       }
+      hp_find_record(info, pos);
     }
-    hp_find_record(info, pos);
-  }
-  if (!info->current_ptr[share->reclength])
+  } while (info->current_ptr[share->visible] == HP_SLOT_CONTINUED);
+  if (info->current_ptr[share->visible] == HP_SLOT_DELETED)
   {
     DBUG_PRINT("warning",("Found deleted record"));
     info->update= HA_STATE_PREV_FOUND | HA_STATE_NEXT_FOUND;
     DBUG_RETURN(my_errno=HA_ERR_RECORD_DELETED);
   }
   info->update= HA_STATE_PREV_FOUND | HA_STATE_NEXT_FOUND | HA_STATE_AKTIV;
-  memcpy(record,info->current_ptr,(size_t) share->reclength);
+  if (hp_extract_record(info, record, info->current_ptr))
+    DBUG_RETURN(my_errno);
   info->current_hash_ptr=0;			/* Can't use read_next */
   DBUG_RETURN(0);
 } /* heap_scan */
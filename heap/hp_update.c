@@ -30,6 +30,8 @@ int heap_update(HP_INFO *info, const byte *old, const byte *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  if (share->chunk_length && hp_reserve_chunks(info, heap_new, pos))
+    DBUG_RETURN(my_errno);
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -46,7 +48,10 @@ int heap_update(HP_INFO *info, const byte *old, const byte *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  if (share->chunk_length)
+    hp_store_dynamic(info, heap_new, pos);
+  else
+    memcpy(pos,heap_new,(size_t) share->reclength);
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -67,6 +72,8 @@ int heap_update(HP_INFO *info, const byte *old, const byte *heap_new)
       {
         if (++(share->records) == share->blength)
 	  share->blength+= share->blength;
+        if (share->chunk_length)
+          hp_store_dynamic(info, old, pos);
         DBUG_RETURN(my_errno);
       }
       keydef--;
@@ -84,5 +91,7 @@ int heap_update(HP_INFO *info, const byte *old, const byte *heap_new)
   }
   if (++(share->records) == share->blength)
     share->blength+= share->blength;
+  if (share->chunk_length)
+    hp_store_dynamic(info, old, pos);		/* Free the reserved chunks */
   DBUG_RETURN(my_errno);
 } /* heap_update */
@@ -25,7 +25,6 @@
 #define HIGHFIND 4
 #define HIGHUSED 8
 
-static byte *next_free_record_pos(HP_SHARE *info);
 static HASH_INFO *hp_find_free_hash(HP_SHARE *info, HP_BLOCK *block,
 				     ulong records);
 
@@ -41,8 +40,17 @@ int heap_write(HP_INFO *info, const byte *record)
     DBUG_RETURN(my_errno=EACCES);
   }
 #endif
-  if (!(pos=next_free_record_pos(share)))
+  if (!(pos=hp_alloc_slot(share)))
     DBUG_RETURN(my_errno);
+  if (share->chunk_length)
+  {
+    HP_NEXT_CHUNK(share, pos)= 0;
+    if (hp_reserve_chunks(info, record, pos))
+    {
+      hp_free_slots(share, pos);
+      DBUG_RETURN(my_errno);
+    }
+  }
   share->changed=1;
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
@@ -52,8 +60,11 @@ int heap_write(HP_INFO *info, const byte *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
-  pos[share->reclength]=1;		/* Mark record as not deleted */
+  if (share->chunk_length)
+    hp_store_dynamic(info, record, pos);
+  else
+    memcpy(pos,record,(size_t) share->reclength);
+  pos[share->visible]=HP_SLOT_ROW;	/* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
   info->current_ptr=pos;
@@ -87,10 +98,7 @@ err:
     keydef--;
   } 
 
-  share->deleted++;
-  *((byte**) pos)=share->del_link;
-  share->del_link=pos;
-  pos[share->reclength]=0;			/* Record deleted */
+  hp_free_slots(share, pos);			/* Record deleted */
 
   DBUG_RETURN(my_errno);
 } /* heap_write */
@@ -128,43 +136,6 @@ int hp_rb_write_key(HP_INFO *info, HP_KEYDEF *keyinfo, const byte *record,
   return 0;
 }
 
-	/* Find where to place new record */
-
-static byte *next_free_record_pos(HP_SHARE *info)
-{
-  int block_pos;
-  byte *pos;
-  ulong length;
-  DBUG_ENTER("next_free_record_pos");
-
-  if (info->del_link)
-  {
-    pos=info->del_link;
-    info->del_link= *((byte**) pos);
-    info->deleted--;
-    DBUG_PRINT("exit",("Used old position: 0x%lx",(long) pos));
-    DBUG_RETURN(pos);
-  }
-  if (!(block_pos=(info->records % info->block.records_in_block)))
-  {
-    if ((info->records > info->max_records && info->max_records) ||
-        (info->data_length + info->index_length >= info->max_table_size))
-    {
-      my_errno=HA_ERR_RECORD_FILE_FULL;
-      DBUG_RETURN(NULL);
-    }
-    if (hp_get_new_block(&info->block,&length))
-      DBUG_RETURN(NULL);
-    info->data_length+=length;
-  }
-  DBUG_PRINT("exit",("Used new position: 0x%lx",
-		     (long) ((byte*) info->block.level_info[0].last_blocks+
-                             block_pos * info->block.recbuffer)));
-  DBUG_RETURN((byte*) info->block.level_info[0].last_blocks+
-	      block_pos*info->block.recbuffer);
-}
-
-
 /*
   Write a hash-key to the hash-index
   SYNOPSIS
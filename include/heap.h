@@ -108,6 +108,26 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+/*
+  Column of a table with rows of variable length (see hp_dynrec.c).
+  Columns that are not in the part of the record that is stored as is
+  are packed to their used length.
+*/
+
+#define HP_COLUMN_FIXED		0	/* Stored with its full length */
+#define HP_COLUMN_VARCHAR	1	/* VARCHAR, length_bytes + data */
+#define HP_COLUMN_BLOB		2	/* BLOB, length_bytes + pointer to data */
+
+typedef struct st_hp_columndef
+{
+  uint offset;				/* Offset of the column in the record */
+  uint length;				/* Length of the column in the record */
+  uint null_pos;			/* Position of the NULL bit */
+  uint8 null_bit;			/* NULL bit, 0 if not nullable */
+  uint8 type;				/* HP_COLUMN_FIXED ... HP_COLUMN_BLOB */
+  uint8 length_bytes;			/* Bytes of the length for VARCHAR/BLOB */
+} HP_COLUMNDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME |HA_NULL_PART_KEY */
@@ -140,6 +160,17 @@ typedef struct st_heap_share
   uint blength;				/* records rounded up to 2^n */
   uint deleted;				/* Deleted records in database */
   uint reclength;			/* Length of one record */
+  uint visible;				/* Offset of the deleted/used mark */
+  /*
+    Rows of variable length are stored in a chain of chunks of
+    chunk_length data bytes. The first fixed_length bytes of the record,
+    which contain all key columns, are stored as is in the first chunk.
+    chunk_length is 0 if all rows have the fixed length reclength.
+  */
+  uint chunk_length, fixed_length;
+  uint columns;				/* Columns packed in a dynamic row */
+  HP_COLUMNDEF *columndef;
+  ulong used_slots;			/* Record slots taken from block */
   uint changed;
   uint keys,max_key_length;
   uint currently_disabled_keys;    /* saved value from "keys" when disabled */
@@ -170,6 +201,8 @@ typedef struct st_heap_info
   uint opt_flag,update;
   byte *lastkey;			/* Last used key with rkey */
   byte *recbuf;                         /* Record buffer for rb-tree keys */
+  byte *blob_buffer;                    /* BLOB data of the last read row */
+  uint blob_buffer_length;
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -189,6 +222,12 @@ typedef struct st_heap_create_info
   ulonglong max_table_size;
   ulonglong auto_increment;
   my_bool with_auto_increment;
+  /*
+    Columns of the record in the order of their offset. If columns is
+    not 0 the table gets rows of variable length.
+  */
+  uint columns;
+  HP_COLUMNDEF *columndef;
 } HP_CREATE_INFO;
 
 	/* Prototypes for heap-functions */
@@ -35,6 +35,7 @@ typedef struct st_keycache_wqueue
 } KEYCACHE_WQUEUE;
 
 #define CHANGED_BLOCKS_HASH 128             /* must be power of 2 */
+#define KEY_CACHE_MAX_SEGMENTS 64           /* max number of cache segments */
 
 /*
   The key cache structure
@@ -75,6 +76,8 @@ typedef struct st_key_cache
   KEYCACHE_WQUEUE waiting_for_block;    /* requests waiting for a free block */
   BLOCK_LINK *changed_blocks[CHANGED_BLOCKS_HASH]; /* hash for dirty file bl.*/
   BLOCK_LINK *file_blocks[CHANGED_BLOCKS_HASH];    /* hash for other file bl.*/
+  uint segments;                 /* number of segments, 0 - not segmented    */
+  struct st_key_cache *segment;  /* segments, each one a separate key cache  */
 
   /*
     The following variables are and variables used to hold parameters for
@@ -85,6 +88,7 @@ typedef struct st_key_cache
   ulong param_block_size;       /* size of the blocks in the key cache      */
   ulong param_division_limit;   /* min. percentage of warm blocks           */
   ulong param_age_threshold;    /* determines when hot block is downgraded  */
+  ulong param_segments;         /* number of segments (0 - not segmented)   */
 
   /* Statistics variables. These are reset in reset_key_cache_counters(). */
   ulong global_blocks_changed;	/* number of currently dirty blocks         */
@@ -92,6 +96,7 @@ typedef struct st_key_cache
   ulonglong global_cache_write;     /* number of writes from cache to files  */
   ulonglong global_cache_r_requests;/* number of read requests (read hits)   */
   ulonglong global_cache_read;      /* number of reads from files to cache   */
+  ulonglong global_cache_lock_waits;/* number of waits for the cache lock    */
 
   int blocks;                   /* max number of blocks in the cache        */
   my_bool in_init;		/* Set to 1 in MySQL during init/resize     */
@@ -133,5 +138,6 @@ extern void multi_key_cache_change(KEY_CACHE *old_data,
 				   KEY_CACHE *new_data);
 extern int reset_key_cache_counters(const char *name,
                                     KEY_CACHE *key_cache);
+extern void sum_key_cache_counters(KEY_CACHE *keycache);
 C_MODE_END
 #endif /* _keycache_h */
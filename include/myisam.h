@@ -308,6 +308,7 @@ extern ha_rows mi_records_in_range(struct st_myisam_info *info,int inx,
 extern int mi_log(int activate_log);
 extern int mi_is_changed(struct st_myisam_info *info);
 extern int mi_delete_all_rows(struct st_myisam_info *info);
+extern void mi_compact_deleted_chains(void);
 extern ulong _mi_calc_blob_length(uint length , const byte *pos);
 extern uint mi_get_pointer_length(ulonglong file_length, uint def);
 
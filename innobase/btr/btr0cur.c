@@ -247,7 +247,8 @@ btr_cur_search_to_nth_level(
 	btr_cur_t*	cursor, /* in/out: tree cursor; the cursor page is
 				s- or x-latched, but see also above! */
 	ulint		has_search_latch,/* in: info on the latch mode the
-				caller currently has on btr_search_latch:
+				caller currently has on the hash index
+				partition latch of index:
 				RW_S_LATCH, or 0 */
 	mtr_t*		mtr)	/* in: mtr */
 {
@@ -271,6 +272,7 @@ btr_cur_search_to_nth_level(
 	ulint		estimate;
 	ulint		ignore_sec_unique;
 	ulint		root_height = 0; /* remove warning */
+	rw_lock_t*	search_latch;
 #ifdef BTR_CUR_ADAPT
 	btr_search_t*	info;
 #endif
@@ -301,6 +303,8 @@ btr_cur_search_to_nth_level(
 	cursor->flag = BTR_CUR_BINARY;
 	cursor->index = index;
 
+	search_latch = btr_search_get_latch(index->id);
+
 #ifndef BTR_CUR_ADAPT
 	guess = NULL;
 #else
@@ -313,7 +317,7 @@ btr_cur_search_to_nth_level(
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_searches++;
 #endif	
-	if (btr_search_latch.writer == RW_LOCK_NOT_LOCKED
+	if (search_latch->writer == RW_LOCK_NOT_LOCKED
 		&& latch_mode <= BTR_MODIFY_LEAF && info->last_hash_succ
 		&& !estimate
 #ifdef PAGE_CUR_LE_OR_EXTENDS
@@ -345,7 +349,7 @@ btr_cur_search_to_nth_level(
 
 	if (has_search_latch) {
 		/* Release possible search latch to obey latching order */
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 	}
 
 	/* Store the position of the tree latch we push to mtr so that we
@@ -558,7 +562,7 @@ retry_page_get:
 func_exit:
 	if (has_search_latch) {
 		
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(search_latch);
 	}
 }
 
@@ -1394,8 +1398,9 @@ btr_cur_parse_update_in_place(
 	ut_a((ibool)!!page_is_comp(page) == index->table->comp);
 	rec = page + rec_offset;
 	
-	/* We do not need to reserve btr_search_latch, as the page is only
-	being recovered, and there cannot be a hash index to it. */
+	/* We do not need to reserve the hash index partition latch, as the
+	page is only being recovered, and there cannot be a hash index to
+	it. */
 
 	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED, &heap);
 
@@ -1481,7 +1486,7 @@ btr_cur_update_in_place(
 	                btr_search_update_hash_on_delete(cursor);
 	        }
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(index->id));
 	}
 
 	if (!(flags & BTR_KEEP_SYS_FLAG)) {
@@ -1497,7 +1502,7 @@ btr_cur_update_in_place(
 	row_upd_rec_in_place(rec, offsets, update);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(index->id));
 	}
 
 	btr_cur_update_in_place_log(flags, rec, index, update, trx, roll_ptr,
@@ -2103,8 +2108,8 @@ btr_cur_parse_del_mark_set_clust_rec(
 			}
 		}
 
-		/* We do not need to reserve btr_search_latch, as the page
-		is only being recovered, and there cannot be a hash index to
+		/* We do not need to reserve the hash index partition latch,
+		as the page is only being recovered, and there cannot be a hash index to
 		it. */
 
 		rec_set_deleted_flag(rec, page_is_comp(page), val);
@@ -2181,7 +2186,7 @@ btr_cur_del_mark_set_clust_rec(
 	block = buf_block_align(rec);
 
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(index->id));
 	}
 
 	rec_set_deleted_flag(rec, rec_offs_comp(offsets), val);
@@ -2193,7 +2198,7 @@ btr_cur_del_mark_set_clust_rec(
 	}
 	
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(index->id));
 	}
 
 	btr_cur_del_mark_set_clust_rec_log(flags, rec, index, val, trx,
@@ -2269,8 +2274,8 @@ btr_cur_parse_del_mark_set_sec_rec(
 	if (page) {
 		rec = page + offset;
 	
-		/* We do not need to reserve btr_search_latch, as the page
-		is only being recovered, and there cannot be a hash index to
+		/* We do not need to reserve the hash index partition latch,
+		as the page is only being recovered, and there cannot be a hash index to
 		it. */
 
 		rec_set_deleted_flag(rec, page_is_comp(page), val);
@@ -2319,14 +2324,14 @@ btr_cur_del_mark_set_sec_rec(
 			== cursor->index->table->comp);
 	
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(cursor->index->id));
 	}
 
 	rec_set_deleted_flag(rec, page_is_comp(buf_block_get_frame(block)),
 									val);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(cursor->index->id));
 	}
 
 	btr_cur_del_mark_set_sec_rec_log(rec, val, mtr);
@@ -2344,8 +2349,9 @@ btr_cur_del_unmark_for_ibuf(
 	rec_t*		rec,	/* in: record to delete unmark */
 	mtr_t*		mtr)	/* in: mtr */
 {
-	/* We do not need to reserve btr_search_latch, as the page has just
-	been read to the buffer pool and there cannot be a hash index to it. */
+	/* We do not need to reserve the hash index partition latch, as the
+	page has just been read to the buffer pool and there cannot be a hash
+	index to it. */
 
 	rec_set_deleted_flag(rec, page_is_comp(buf_frame_align(rec)), FALSE);
 
@@ -18,6 +18,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "btr0pcur.h"
 #include "btr0btr.h"
 #include "ha0ha.h"
+#include "srv0srv.h"
 
 ulint	btr_search_this_is_zero = 0;	/* A dummy variable to fool the
 					compiler */
@@ -27,24 +28,11 @@ ulint	btr_search_n_succ	= 0;
 #endif /* UNIV_SEARCH_PERF_STAT */
 ulint	btr_search_n_hash_fail	= 0;
 
-byte	btr_sea_pad1[64];	/* padding to prevent other memory update
-				hotspots from residing on the same memory
-				cache line as btr_search_latch */
-
-/* The latch protecting the adaptive search system: this latch protects the
-(1) positions of records on those pages where a hash index has been built.
-NOTE: It does not protect values of non-ordering fields within a record from
-being updated in-place! We can use fact (1) to perform unique searches to
-indexes. */
-
-rw_lock_t*	btr_search_latch_temp; /* We will allocate the latch from
-					dynamic memory to get it to the
-					same DRAM page as other hotspot
-					semaphores */
-
-byte	btr_sea_pad2[64];	/* padding to prevent other memory update
-				hotspots from residing on the same memory
-				cache line */
+/* The adaptive search system. The latch of each partition protects the
+(1) positions of records on those pages where a hash index has been built
+for an index of the partition. NOTE: It does not protect values of
+non-ordering fields within a record from being updated in-place! We can use
+fact (1) to perform unique searches to indexes. */
 
 btr_search_sys_t*	btr_search_sys;
 
@@ -88,19 +76,20 @@ allocate a new node to the hash table, it will succeed. However, the check
 will not guarantee success. */
 static
 void
-btr_search_check_free_space_in_heap(void)
-/*=====================================*/
+btr_search_check_free_space_in_heap(
+/*================================*/
+	btr_search_part_t*	part)	/* in: hash index partition */
 {
 	buf_frame_t*	frame;
 	hash_table_t*	table;
 	mem_heap_t*	heap;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	table = btr_search_sys->hash_index;
+	table = part->hash_index;
 
 	heap = table->heap;
 			
@@ -111,7 +100,7 @@ btr_search_check_free_space_in_heap(void)
 	if (heap->free_block == NULL) {
 		frame = buf_frame_alloc();
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(&part->latch);
 
 		if (heap->free_block == NULL) {
 			heap->free_block = frame;
@@ -119,7 +108,7 @@ btr_search_check_free_space_in_heap(void)
 			buf_frame_free(frame);
 		}
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	}
 }
 
@@ -131,18 +120,34 @@ btr_search_sys_create(
 /*==================*/
 	ulint	hash_size)	/* in: hash index hash table size */
 {
-	/* We allocate the search latch from dynamic memory:
-	see above at the global variable definition */
-	
-	btr_search_latch_temp = mem_alloc(sizeof(rw_lock_t));
-	
-	rw_lock_create(&btr_search_latch);
+	btr_search_part_t*	part;
+	ulint			n_parts;
+	ulint			i;
+
+	n_parts = srv_adaptive_hash_index_partitions;
+
+	if (n_parts == 0) {
+		n_parts = 1;
+	} else if (n_parts > BTR_SEARCH_MAX_PARTS) {
+		n_parts = BTR_SEARCH_MAX_PARTS;
+	}
 
 	btr_search_sys = mem_alloc(sizeof(btr_search_sys_t));
 
-	btr_search_sys->hash_index = ha_create(TRUE, hash_size, 0, 0);
+	btr_search_sys->n_parts = n_parts;
+	btr_search_sys->parts = mem_alloc(n_parts * sizeof(btr_search_part_t));
+
+	for (i = 0; i < n_parts; i++) {
+		part = btr_search_sys->parts + i;
 
-	rw_lock_set_level(&btr_search_latch, SYNC_SEARCH_SYS);
+		rw_lock_create(&part->latch);
+		rw_lock_set_level(&part->latch, SYNC_SEARCH_SYS);
+
+		part->hash_index = ha_create(TRUE, hash_size / n_parts + 1,
+					     0, 0);
+		part->n_hash_succ = 0;
+		part->n_hash_fail = 0;
+	}
 }
 
 /*********************************************************************
@@ -199,8 +204,10 @@ btr_search_info_update_hash(
 	int		cmp;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index->id),
+			   RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index->id),
+			   RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	index = cursor->index;
@@ -324,8 +331,10 @@ btr_search_update_block_hash_info(
 	btr_cur_t*	cursor)	/* in: cursor */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index->id),
+			   RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(btr_search_get_latch(cursor->index->id),
+			   RW_LOCK_EX));
 	ut_ad(rw_lock_own(&((buf_block_t*) block)->lock, RW_LOCK_SHARED)
 		|| rw_lock_own(&((buf_block_t*) block)->lock, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -401,13 +410,16 @@ btr_search_update_hash_ref(
 	buf_block_t*	block,	/* in: buffer block where cursor positioned */
 	btr_cur_t*	cursor)	/* in: cursor */
 {
-	ulint	fold;
-	rec_t*	rec;
-	dulint	tree_id;
+	btr_search_part_t*	part;
+	ulint			fold;
+	rec_t*			rec;
+	dulint			tree_id;
+
+	part = btr_search_get_part(cursor->index->id);
 
 	ut_ad(cursor->flag == BTR_CUR_HASH_FAIL);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(rw_lock_own(&part->latch, RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 				|| rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -439,10 +451,10 @@ btr_search_update_hash_ref(
 			mem_heap_free(heap);
 		}
 #ifdef UNIV_SYNC_DEBUG
-		ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+		ut_ad(rw_lock_own(&part->latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-		ha_insert_for_fold(btr_search_sys->hash_index, fold, rec);
+		ha_insert_for_fold(part->hash_index, fold, rec);
 	}
 }	
 	
@@ -455,14 +467,17 @@ btr_search_info_update_slow(
 	btr_search_t*	info,	/* in/out: search info */
 	btr_cur_t*	cursor)	/* in: cursor which was just positioned */
 {
-	buf_block_t*	block;
-	ibool		build_index;
-	ulint*		params;
-	ulint*		params2;
-	
+	btr_search_part_t*	part;
+	buf_block_t*		block;
+	ibool			build_index;
+	ulint*			params;
+	ulint*			params2;
+
+	part = btr_search_get_part(cursor->index->id);
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	block = buf_block_align(btr_cur_get_rec(cursor));
@@ -478,7 +493,7 @@ btr_search_info_update_slow(
 
 	if (build_index || (cursor->flag == BTR_CUR_HASH_FAIL)) {
 
-		btr_search_check_free_space_in_heap();
+		btr_search_check_free_space_in_heap(part);
 	}
 	
 	if (cursor->flag == BTR_CUR_HASH_FAIL) {
@@ -486,11 +501,11 @@ btr_search_info_update_slow(
 
 		btr_search_n_hash_fail++;
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(&part->latch);
 
 		btr_search_update_hash_ref(info, block, cursor);
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	}
 
 	if (build_index) {
@@ -534,7 +549,7 @@ btr_search_check_guess(
 	ibool           can_only_compare_to_cursor_rec,
 	                        /* in: if we do not have a latch on the page
 				of cursor, but only a latch on
-			        btr_search_latch, then ONLY the columns
+			        the hash index partition, then ONLY the columns
 				of the record UNDER the cursor are
 				protected, not the next or previous record
 				in the chain: we cannot look at the next or
@@ -689,17 +704,19 @@ btr_search_guess_on_hash(
 					to protect the record! */
 	btr_cur_t*	cursor, 	/* out: tree cursor */
 	ulint		has_search_latch,/* in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the hash index
+					partition latch of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr)		/* in: mtr */
 {
-	buf_block_t*	block;
-	rec_t*		rec;
-	page_t*		page;
-	ulint		fold;
-	ulint		tuple_n_fields;
-	dulint		tree_id;
-	ibool           can_only_compare_to_cursor_rec = TRUE;
+	btr_search_part_t*	part;
+	buf_block_t*		block;
+	rec_t*			rec;
+	page_t*			page;
+	ulint			fold;
+	ulint			tuple_n_fields;
+	dulint			tree_id;
+	ibool			can_only_compare_to_cursor_rec = TRUE;
 #ifdef notdefined
 	btr_cur_t	cursor2;
 	btr_pcur_t	pcur;
@@ -734,6 +751,8 @@ btr_search_guess_on_hash(
 
 	tree_id = (index->tree)->id;
 
+	part = btr_search_get_part(index->id);
+
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_succ++;
 #endif
@@ -743,13 +762,13 @@ btr_search_guess_on_hash(
 	cursor->flag = BTR_CUR_HASH;
 	
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(&part->latch);
 	}
 
-	ut_ad(btr_search_latch.writer != RW_LOCK_EX);
-	ut_ad(btr_search_latch.reader_count > 0);
+	ut_ad(part->latch.writer != RW_LOCK_EX);
+	ut_ad(part->latch.reader_count > 0);
 
-	rec = ha_search_and_get_data(btr_search_sys->hash_index, fold);
+	rec = ha_search_and_get_data(part->hash_index, fold);
 
 	if (UNIV_UNLIKELY(!rec)) {
 		goto failure_unlock;
@@ -766,7 +785,7 @@ btr_search_guess_on_hash(
 			goto failure_unlock;
 		}
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 		can_only_compare_to_cursor_rec = FALSE;
 
 #ifdef UNIV_SYNC_DEBUG
@@ -792,7 +811,7 @@ btr_search_guess_on_hash(
 
 	/* Check the validity of the guess within the page */
 
-	/* If we only have the latch on btr_search_latch, not on the
+	/* If we only have the latch on the hash index partition, not on the
 	page, it only protects the columns of the record the cursor
 	is positioned on. We cannot look at the next of the previous
 	record to determine if our guess for the cursor position is
@@ -846,6 +865,7 @@ btr_search_guess_on_hash(
 	meanwhile! Thus it might not be a bug. */
 #endif
 	info->last_hash_succ = TRUE;
+	part->n_hash_succ++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
@@ -866,10 +886,11 @@ btr_search_guess_on_hash(
 	/*-------------------------------------------*/
 failure_unlock:
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 	}
 failure:
 	info->n_hash_fail++;
+	part->n_hash_fail++;
 
 	cursor->flag = BTR_CUR_HASH_FAIL;
 
@@ -892,39 +913,48 @@ btr_search_drop_page_hash_index(
 	page_t*	page)	/* in: index page, s- or x-latched, or an index page
 			for which we know that block->buf_fix_count == 0 */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	ulint		n_fields;
-	ulint		n_bytes;
-	rec_t*		rec;
-	ulint		fold;
-	ulint		prev_fold;
-	dulint		tree_id;
-	ulint		n_cached;
-	ulint		n_recs;
-	ulint*		folds;
-	ulint		i;
-	mem_heap_t*	heap;
-	dict_index_t*	index;
-	ulint*		offsets;
+	btr_search_part_t*	part;
+	hash_table_t*		table;
+	buf_block_t*		block;
+	ulint			n_fields;
+	ulint			n_bytes;
+	rec_t*			rec;
+	ulint			fold;
+	ulint			prev_fold;
+	dulint			tree_id;
+	ulint			n_cached;
+	ulint			n_recs;
+	ulint*			folds;
+	ulint			i;
+	mem_heap_t*		heap;
+	dict_index_t*		index;
+	ulint*			offsets;
+
+	/* The page is latched or not buffer-fixed by anyone, so that the
+	index id on it cannot change: if the page is hashed, the id tells
+	the partition whose latch protects the hash fields of the block */
+
+	tree_id = btr_page_get_index_id(page);
+
+	part = btr_search_get_part(tree_id);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 retry:
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(&part->latch);
 
 	block = buf_block_align(page);
 
 	if (UNIV_LIKELY(!block->is_hashed)) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 
 		return;
 	}
 
-	table = btr_search_sys->hash_index;
+	table = part->hash_index;
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
@@ -937,10 +967,10 @@ retry:
 	index = block->index;
 
 	/* NOTE: The fields of block must not be accessed after
-	releasing btr_search_latch, as the index page might only
+	releasing the partition latch, as the index page might only
 	be s-latched! */
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(&part->latch);
 	
 	ut_a(n_fields + n_bytes > 0);
 
@@ -956,8 +986,6 @@ retry:
 	rec = page_get_infimum_rec(page);
 	rec = page_rec_get_next(rec);
 
-	tree_id = btr_page_get_index_id(page);
-	
 	ut_a(0 == ut_dulint_cmp(tree_id, index->id));
 
 	prev_fold = 0;
@@ -992,7 +1020,7 @@ next_rec:
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
 	if (UNIV_UNLIKELY(!block->is_hashed)) {
 		/* Someone else has meanwhile dropped the hash index */
@@ -1008,7 +1036,7 @@ next_rec:
 		/* Someone else has meanwhile built a new hash index on the
 		page, with different parameters */
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 
 		mem_free(folds);
 		goto retry;
@@ -1029,11 +1057,11 @@ cleanup:
 "  InnoDB: Corruption of adaptive hash index. After dropping\n"
 "InnoDB: the hash index to a page of %s, still %lu hash nodes remain.\n",
 			index->name, (ulong) block->n_pointers);
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 
 		btr_search_validate();
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	}
 
 	mem_free(folds);
@@ -1096,45 +1124,48 @@ btr_search_build_page_hash_index(
 				field */
 	ulint		side)	/* in: hash for searches from this side */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	rec_t*		rec;
-	rec_t*		next_rec;
-	ulint		fold;
-	ulint		next_fold;
-	dulint		tree_id;
-	ulint		n_cached;
-	ulint		n_recs;
-	ulint*		folds;
-	rec_t**		recs;
-	ulint		i;
-	mem_heap_t*	heap		= NULL;
-	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
-	ulint*		offsets		= offsets_;
+	btr_search_part_t*	part;
+	hash_table_t*		table;
+	buf_block_t*		block;
+	rec_t*			rec;
+	rec_t*			next_rec;
+	ulint			fold;
+	ulint			next_fold;
+	dulint			tree_id;
+	ulint			n_cached;
+	ulint			n_recs;
+	ulint*			folds;
+	rec_t**			recs;
+	ulint			i;
+	mem_heap_t*		heap		= NULL;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*			offsets		= offsets_;
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
 	ut_ad(index);
 
+	part = btr_search_get_part(index->id);
+
 	block = buf_block_align(page);
-	table = btr_search_sys->hash_index;
+	table = part->hash_index;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(&part->latch, RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 				|| rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(&part->latch);
 				
 	if (block->is_hashed && ((block->curr_n_fields != n_fields)
 	        			|| (block->curr_n_bytes != n_bytes)
 	        			|| (block->curr_side != side))) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 
 		btr_search_drop_page_hash_index(page);
 	} else {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 	}
 
 	n_recs = page_get_n_recs(page);
@@ -1231,9 +1262,9 @@ btr_search_build_page_hash_index(
 		fold = next_fold;
 	}
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(part);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
 	if (block->is_hashed && ((block->curr_n_fields != n_fields)
 	        			|| (block->curr_n_bytes != n_bytes)
@@ -1255,7 +1286,7 @@ btr_search_build_page_hash_index(
 	}
 
 exit_func:
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(&part->latch);
 
 	mem_free(folds);
 	mem_free(recs);
@@ -1281,11 +1312,14 @@ btr_search_move_or_delete_hash_entries(
 					from this page */
 	dict_index_t*	index)		/* in: record descriptor */
 {
-	buf_block_t*	block;
-	buf_block_t*	new_block;
-	ulint		n_fields;
-	ulint		n_bytes;
-	ulint		side;
+	btr_search_part_t*	part;
+	buf_block_t*		block;
+	buf_block_t*		new_block;
+	ulint			n_fields;
+	ulint			n_bytes;
+	ulint			side;
+
+	part = btr_search_get_part(index->id);
 
 	block = buf_block_align(page);
 	new_block = buf_block_align(new_page);
@@ -1298,11 +1332,11 @@ btr_search_move_or_delete_hash_entries(
 	ut_a(!new_block->is_hashed || new_block->index == index);
 	ut_a(!block->is_hashed || block->index == index);
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(&part->latch);
 			
 	if (new_block->is_hashed) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 
 		btr_search_drop_page_hash_index(page);
 
@@ -1319,7 +1353,7 @@ btr_search_move_or_delete_hash_entries(
 		new_block->n_bytes = block->curr_n_bytes;
 		new_block->side = block->curr_side;
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(&part->latch);
 
 		ut_a(n_fields + n_bytes > 0);
 
@@ -1332,7 +1366,7 @@ btr_search_move_or_delete_hash_entries(
 		return;
 	}
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(&part->latch);
 }
 
 /************************************************************************
@@ -1345,14 +1379,15 @@ btr_search_update_hash_on_delete(
 				record to delete using btr_cur_search_...,
 				the record is not yet deleted */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	rec_t*		rec;
-	ulint		fold;
-	dulint		tree_id;
-	ibool		found;
-	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
-	mem_heap_t*	heap		= NULL;
+	btr_search_part_t*	part;
+	hash_table_t*		table;
+	buf_block_t*		block;
+	rec_t*			rec;
+	ulint			fold;
+	dulint			tree_id;
+	ibool			found;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	mem_heap_t*		heap		= NULL;
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
 	rec = btr_cur_get_rec(cursor);
@@ -1371,7 +1406,8 @@ btr_search_update_hash_on_delete(
 	ut_a(block->index == cursor->index);
 	ut_a(block->curr_n_fields + block->curr_n_bytes > 0);
 
-	table = btr_search_sys->hash_index;
+	part = btr_search_get_part(cursor->index->id);
+	table = part->hash_index;
 
 	tree_id = cursor->index->tree->id;
 	fold = rec_fold(rec, rec_get_offsets(rec, cursor->index, offsets_,
@@ -1380,11 +1416,11 @@ btr_search_update_hash_on_delete(
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
 	found = ha_search_and_delete_if_found(table, fold, rec);
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(&part->latch);
 }
 
 /************************************************************************
@@ -1398,9 +1434,10 @@ btr_search_update_hash_node_on_insert(
 				and the new record has been inserted next
 				to the cursor */
 {
-	hash_table_t*	table;
-	buf_block_t*	block;
-	rec_t*		rec;
+	btr_search_part_t*	part;
+	hash_table_t*		table;
+	buf_block_t*		block;
+	rec_t*			rec;
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1417,21 +1454,23 @@ btr_search_update_hash_node_on_insert(
 
 	ut_a(block->index == cursor->index);
 
-	rw_lock_x_lock(&btr_search_latch);
+	part = btr_search_get_part(cursor->index->id);
+
+	rw_lock_x_lock(&part->latch);
 
 	if ((cursor->flag == BTR_CUR_HASH)
 	    && (cursor->n_fields == block->curr_n_fields)
 	    && (cursor->n_bytes == block->curr_n_bytes)
 	    && (block->curr_side == BTR_SEARCH_RIGHT_SIDE)) {
 
-	    	table = btr_search_sys->hash_index;
+	    	table = part->hash_index;
 	    	
 	    	ha_search_and_update_if_found(table, cursor->fold, rec,
 						page_rec_get_next(rec));
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 
 		btr_search_update_hash_on_insert(cursor);
 	}
@@ -1448,27 +1487,29 @@ btr_search_update_hash_on_insert(
 				and the new record has been inserted next
 				to the cursor */
 {
-	hash_table_t*	table; 
-	buf_block_t*	block;
-	rec_t*		rec;
-	rec_t*		ins_rec;
-	rec_t*		next_rec;
-	dulint		tree_id;
-	ulint		fold;
-	ulint		ins_fold;
-	ulint		next_fold = 0; /* remove warning (??? bug ???) */
-	ulint		n_fields;
-	ulint		n_bytes;
-	ulint		side;
-	ibool		locked		= FALSE;
-	mem_heap_t*	heap		= NULL;
-	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
-	ulint*		offsets		= offsets_;
+	btr_search_part_t*	part;
+	hash_table_t*		table; 
+	buf_block_t*		block;
+	rec_t*			rec;
+	rec_t*			ins_rec;
+	rec_t*			next_rec;
+	dulint			tree_id;
+	ulint			fold;
+	ulint			ins_fold;
+	ulint			next_fold = 0; /* remove warning (??? bug ???) */
+	ulint			n_fields;
+	ulint			n_bytes;
+	ulint			side;
+	ibool			locked		= FALSE;
+	mem_heap_t*		heap		= NULL;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*			offsets		= offsets_;
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
-	table = btr_search_sys->hash_index;
+	part = btr_search_get_part(cursor->index->id);
+	table = part->hash_index;
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(part);
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1512,7 +1553,7 @@ btr_search_update_hash_on_insert(
 	} else {
 		if (side == BTR_SEARCH_LEFT_SIDE) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 
 			locked = TRUE;
 
@@ -1526,7 +1567,7 @@ btr_search_update_hash_on_insert(
 
  		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 
 			locked = TRUE;
 		}
@@ -1544,7 +1585,7 @@ check_next_rec:
 		if (side == BTR_SEARCH_RIGHT_SIDE) {
 
  			if (!locked) {
-				rw_lock_x_lock(&btr_search_latch);
+				rw_lock_x_lock(&part->latch);
 
 				locked = TRUE;
 			}
@@ -1559,7 +1600,7 @@ check_next_rec:
 
  		if (!locked) {
 	
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 
 			locked = TRUE;
 		}
@@ -1582,17 +1623,18 @@ function_exit:
 		mem_heap_free(heap);
 	}
 	if (locked) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(&part->latch);
 	}
 }
 
 /************************************************************************
-Validates the search system. */
-
+Validates a partition of the search system. */
+static
 ibool
-btr_search_validate(void)
+btr_search_validate_part(
 /*=====================*/
-				/* out: TRUE if ok */
+					/* out: TRUE if ok */
+	btr_search_part_t*	part)	/* in: hash index partition */
 {
 	buf_block_t*	block;
 	page_t*		page;
@@ -1606,25 +1648,25 @@ btr_search_validate(void)
 	ulint*		offsets		= offsets_;
 
 	/* How many cells to check before temporarily releasing
-	btr_search_latch. */
+	the partition latch. */
 	ulint		chunk_size = 10000;
 	
 	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(&part->latch);
 
-	cell_count = hash_get_n_cells(btr_search_sys->hash_index);
+	cell_count = hash_get_n_cells(part->hash_index);
 	
 	for (i = 0; i < cell_count; i++) {
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if ((i != 0) && ((i % chunk_size) == 0)) {
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(&part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 		}
 		
-		node = hash_get_nth_cell(btr_search_sys->hash_index, i)->node;
+		node = hash_get_nth_cell(part->hash_index, i)->node;
 
 		while (node != NULL) {
 			block = buf_block_align(node->data);
@@ -1680,23 +1722,71 @@ btr_search_validate(void)
 	for (i = 0; i < cell_count; i += chunk_size) {
 		ulint end_index = ut_min(i + chunk_size - 1, cell_count - 1);
 		
-		/* We release btr_search_latch every once in a while to
+		/* We release the partition latch every once in a while to
 		give other queries a chance to run. */
 		if (i != 0) {
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(&part->latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(&part->latch);
 		}
 
-		if (!ha_validate(btr_search_sys->hash_index, i, end_index)) {
+		if (!ha_validate(part->hash_index, i, end_index)) {
 			ok = FALSE;
 		}
 	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(&part->latch);
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
 
 	return(ok);
 }
+
+/************************************************************************
+Validates the search system. */
+
+ibool
+btr_search_validate(void)
+/*=====================*/
+				/* out: TRUE if ok */
+{
+	ibool	ok	= TRUE;
+	ulint	i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+
+		if (!btr_search_validate_part(btr_search_sys->parts + i)) {
+
+			ok = FALSE;
+		}
+	}
+
+	return(ok);
+}
+
+/************************************************************************
+Prints info of the adaptive hash index partitions. */
+
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file)	/* in: file where to print */
+{
+	btr_search_part_t*	part;
+	ulint			i;
+
+	for (i = 0; i < btr_search_sys->n_parts; i++) {
+		part = btr_search_sys->parts + i;
+
+		if (btr_search_sys->n_parts > 1) {
+			fprintf(file, "Partition %lu: ", (ulong) i);
+		}
+
+		ha_print_info(file, part->hash_index);
+
+		fprintf(file, "%lu hash hits, %lu hash misses\n",
+			(ulong) part->n_hash_succ,
+			(ulong) part->n_hash_fail);
+	}
+}
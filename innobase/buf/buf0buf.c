@@ -67,8 +67,17 @@ in the file along with the file page, resides in the control block.
 
 		Buffer pool struct
 		------------------
-The buffer buf_pool contains a single mutex which protects all the
-control data structures of the buf_pool. The content of a buffer frame is
+The buffer buf_pool is divided into one or more instances. Each instance
+owns a contiguous range of the control blocks and contains a mutex which
+protects all the control data structures of the instance: the page hash
+table, the free list, the LRU list and the flush list. A file page is
+always buffered in the instance which buf_pool_inst_get() computes from
+the page address, and all the pages of an aligned area of 64 pages of a
+space are buffered in the same instance, so that read-ahead and the
+flushing of neighbors only need one instance mutex. The oldest
+modification of the pool, which determines the checkpoint, is the minimum
+of the oldest modifications in the flush lists of the instances.
+The content of a buffer frame is
 protected by a separate read-write lock in its control block, though.
 These locks can be locked and unlocked without owning the buf_pool mutex.
 The OS events in the buf_pool struct can be waited for without owning the
@@ -478,6 +487,7 @@ buf_block_init(
 
 	block->buf_fix_count = 0;
 	block->io_fix = 0;
+	block->dblwr_region = ULINT_UNDEFINED;
 
 	block->modify_clock = ut_dulint_zero;
 	
@@ -503,6 +513,94 @@ buf_block_init(
 #endif /* UNIV_SYNC_DEBUG */
 }
 
+/************************************************************************
+Initializes a buffer pool instance and puts its control blocks to its free
+list. */
+static
+void
+buf_pool_inst_init(
+/*===============*/
+	buf_pool_inst_t* inst,	/* in: instance to initialize */
+	ulint		id,	/* in: number of the instance */
+	ulint		first,	/* in: index of the first control block of the
+				instance */
+	ulint		n)	/* in: number of control blocks */
+{
+	buf_block_t*	block;
+	ulint		i;
+
+	mutex_create(&(inst->mutex));
+	mutex_set_level(&(inst->mutex), SYNC_BUF_POOL);
+
+	mutex_enter(&(inst->mutex));
+
+	inst->id = id;
+	inst->blocks = buf_pool_get_nth_block(buf_pool, first);
+	inst->curr_size = n;
+
+	inst->page_hash = hash_create(2 * n);
+
+	inst->n_pend_reads = 0;
+
+	inst->stat.n_pages_read = 0;
+	inst->stat.n_pages_written = 0;
+	inst->stat.n_pages_created = 0;
+
+	/* 2. Initialize flushing fields
+	   ---------------------------- */
+	UT_LIST_INIT(inst->flush_list);
+
+	for (i = BUF_FLUSH_LRU; i <= BUF_FLUSH_LIST; i++) {
+		inst->n_flush[i] = 0;
+		inst->init_flush[i] = FALSE;
+		inst->no_flush[i] = os_event_create(NULL);
+	}
+
+	inst->LRU_flush_ended = 0;
+
+	inst->ulint_clock = 1;
+	inst->freed_page_clock = 0;
+
+	/* 3. Initialize LRU fields
+	   ---------------------------- */
+	UT_LIST_INIT(inst->LRU);
+
+	inst->LRU_old = NULL;
+
+	UT_LIST_INIT(inst->awe_LRU_free_mapped);
+
+	/* Add control blocks to the free list */
+	UT_LIST_INIT(inst->free);
+
+	for (i = 0; i < n; i++) {
+
+		block = inst->blocks + i;
+
+		block->inst = inst;
+
+		if (block->frame) {
+			/* Wipe contents of frame to eliminate a Purify
+			warning */
+
+#ifdef HAVE_purify
+			memset(block->frame, '\0', UNIV_PAGE_SIZE);
+#endif
+			if (srv_use_awe) {
+				/* Add to the list of blocks mapped to
+				frames */
+
+				UT_LIST_ADD_LAST(awe_LRU_free_mapped,
+					inst->awe_LRU_free_mapped, block);
+			}
+		}
+
+		UT_LIST_ADD_LAST(free, inst->free, block);
+		block->in_free_list = TRUE;
+	}
+
+	mutex_exit(&(inst->mutex));
+}
+
 /************************************************************************
 Creates the buffer pool. */
 
@@ -524,8 +622,9 @@ buf_pool_init(
 {
 	byte*		frame;
 	ulint		i;
+	ulint		n_instances;
 	buf_block_t*	block;
-	
+
 	ut_a(max_size == curr_size);
 	ut_a(srv_use_awe || n_frames == max_size);
 	
@@ -542,11 +641,6 @@ buf_pool_init(
 
 	/* 1. Initialize general fields
 	   ---------------------------- */
-	mutex_create(&(buf_pool->mutex));
-	mutex_set_level(&(buf_pool->mutex), SYNC_BUF_POOL);
-
-	mutex_enter(&(buf_pool->mutex));
-
 	if (srv_use_awe) {
 		/*----------------------------------------*/
 		/* Allocate the virtual address space window, i.e., the
@@ -649,76 +743,57 @@ buf_pool_init(
 		}
 	}
 
-	buf_pool->page_hash = hash_create(2 * max_size);
-
-	buf_pool->n_pend_reads = 0;
-
 	buf_pool->last_printout_time = time(NULL);
 
-	buf_pool->n_pages_read = 0;
-	buf_pool->n_pages_written = 0;
-	buf_pool->n_pages_created = 0;
 	buf_pool->n_pages_awe_remapped = 0;
-	
+
 	buf_pool->n_page_gets = 0;
 	buf_pool->n_page_gets_old = 0;
-	buf_pool->n_pages_read_old = 0;
-	buf_pool->n_pages_written_old = 0;
-	buf_pool->n_pages_created_old = 0;
+	buf_pool->old_stat.n_pages_read = 0;
+	buf_pool->old_stat.n_pages_written = 0;
+	buf_pool->old_stat.n_pages_created = 0;
 	buf_pool->n_pages_awe_remapped_old = 0;
-	
-	/* 2. Initialize flushing fields
-	   ---------------------------- */
-	UT_LIST_INIT(buf_pool->flush_list);
-
-	for (i = BUF_FLUSH_LRU; i <= BUF_FLUSH_LIST; i++) {
-		buf_pool->n_flush[i] = 0;
-		buf_pool->init_flush[i] = FALSE;
-		buf_pool->no_flush[i] = os_event_create(NULL);
-	}
-
-	buf_pool->LRU_flush_ended = 0;
 
-	buf_pool->ulint_clock = 1;
-	buf_pool->freed_page_clock = 0;
-	
-	/* 3. Initialize LRU fields
-	   ---------------------------- */
-	UT_LIST_INIT(buf_pool->LRU);
+	/* Divide the control blocks into the instances. The AWE frame
+	window is managed through the awe_LRU_free_mapped list of a single
+	instance. */
 
-	buf_pool->LRU_old = NULL;
+	n_instances = srv_buf_pool_instances;
 
-	UT_LIST_INIT(buf_pool->awe_LRU_free_mapped);
+	if (n_instances > BUF_POOL_MAX_INSTANCES) {
+		n_instances = BUF_POOL_MAX_INSTANCES;
+	}
 
-	/* Add control blocks to the free list */
-	UT_LIST_INIT(buf_pool->free);
+	if (n_instances > curr_size / BUF_POOL_INST_MIN_SIZE) {
+		n_instances = curr_size / BUF_POOL_INST_MIN_SIZE;
+	}
 
-	for (i = 0; i < curr_size; i++) {
+	if (srv_use_awe || n_instances == 0) {
+		n_instances = 1;
+	}
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+	if (n_instances != srv_buf_pool_instances) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+"  InnoDB: Warning: using %lu buffer pool instances instead of %lu:\n"
+"InnoDB: each instance must have at least %lu pages.\n",
+			(ulong) n_instances, (ulong) srv_buf_pool_instances,
+			(ulong) BUF_POOL_INST_MIN_SIZE);
 
-		if (block->frame) {
-			/* Wipe contents of frame to eliminate a Purify
-			warning */
+		srv_buf_pool_instances = n_instances;
+	}
 
-#ifdef HAVE_purify
-			memset(block->frame, '\0', UNIV_PAGE_SIZE);
-#endif
-			if (srv_use_awe) {
-				/* Add to the list of blocks mapped to
-				frames */
-				
-				UT_LIST_ADD_LAST(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
-			}
-		}
+	buf_pool->n_instances = n_instances;
+	buf_pool->instances = mem_alloc(n_instances * sizeof(buf_pool_inst_t));
+	buf_pool->next_inst = 0;
 
-		UT_LIST_ADD_LAST(free, buf_pool->free, block);
-		block->in_free_list = TRUE;
+	for (i = 0; i < n_instances; i++) {
+		buf_pool_inst_init(buf_pool->instances + i, i,
+				   i * curr_size / n_instances,
+				   (i + 1) * curr_size / n_instances
+				   - i * curr_size / n_instances);
 	}
 
-	mutex_exit(&(buf_pool->mutex));
-
 	if (srv_use_adaptive_hash_indexes) {
 	  	btr_search_sys_create(
 			  curr_size * UNIV_PAGE_SIZE / sizeof(void*) / 64);
@@ -744,12 +819,15 @@ buf_awe_map_page_to_frame(
 					add the block to the
 					awe_LRU_free_mapped list */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	bck;
 
+	ut_ad(block);
+
+	inst = block->inst;
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
-	ut_ad(block);
 
 	if (block->frame) {
 
@@ -759,7 +837,7 @@ buf_awe_map_page_to_frame(
 	/* Scan awe_LRU_free_mapped from the end and try to find a block
 	which is not bufferfixed or io-fixed */
 
-	bck = UT_LIST_GET_LAST(buf_pool->awe_LRU_free_mapped);
+	bck = UT_LIST_GET_LAST(inst->awe_LRU_free_mapped);
 
 	while (bck) {	
 		ibool skip;
@@ -792,12 +870,12 @@ buf_awe_map_page_to_frame(
 			
 			bck->frame = NULL;
 			UT_LIST_REMOVE(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped,
+					inst->awe_LRU_free_mapped,
 					bck);
 
 			if (add_to_mapped_list) {
 				UT_LIST_ADD_FIRST(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped,
+					inst->awe_LRU_free_mapped,
 					block);
 			}
 
@@ -812,7 +890,7 @@ buf_awe_map_page_to_frame(
 	fprintf(stderr,
 "InnoDB: AWE: Fatal error: cannot find a page to unmap\n"
 "InnoDB: awe_LRU_free_mapped list length %lu\n",
-		(ulong) UT_LIST_GET_LEN(buf_pool->awe_LRU_free_mapped));
+		(ulong) UT_LIST_GET_LEN(inst->awe_LRU_free_mapped));
 
 	ut_a(0);
 }
@@ -827,9 +905,16 @@ buf_block_alloc(void)
 				is used it is guaranteed that the page is
 				mapped to a frame */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 
-	block = buf_LRU_get_free_block();
+	/* Blocks which do not contain file pages are taken from the
+	instances in turn */
+
+	inst = buf_pool_get_nth_inst(buf_pool->next_inst++
+				     % buf_pool->n_instances);
+
+	block = buf_LRU_get_free_block(inst);
 
 	return(block);
 }
@@ -843,22 +928,24 @@ buf_block_make_young(
 /*=================*/
 	buf_block_t*	block)	/* in: block to make younger */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!mutex_own(&(buf_pool->mutex)));
+	ut_ad(!mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	/* Note that we read freed_page_clock's without holding any mutex:
 	this is allowed since the result is used only in heuristics */
 
-	if (buf_pool->freed_page_clock >= block->freed_page_clock 
-				+ 1 + (buf_pool->curr_size / 4)) {
+	if (inst->freed_page_clock >= block->freed_page_clock
+				+ 1 + (inst->curr_size / 4)) {
 
-		mutex_enter(&buf_pool->mutex);
+		mutex_enter(&inst->mutex);
 		/* There has been freeing activity in the LRU list:
 		best to move to the head of the LRU list */
 
 		buf_LRU_make_block_young(block);
-		mutex_exit(&buf_pool->mutex);
+		mutex_exit(&inst->mutex);
 	}
 }
 
@@ -873,16 +960,16 @@ buf_page_make_young(
 	buf_frame_t*	frame)	/* in: buffer frame of a file page */
 {
 	buf_block_t*	block;
-	
-	mutex_enter(&(buf_pool->mutex));
 
 	block = buf_block_align(frame);
 
+	mutex_enter(&(block->inst->mutex));
+
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	buf_LRU_make_block_young(block);
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(block->inst->mutex));
 }
 
 /************************************************************************
@@ -893,7 +980,9 @@ buf_block_free(
 /*===========*/
 	buf_block_t*	block)	/* in, own: block to be freed */
 {
-	mutex_enter(&(buf_pool->mutex));
+	buf_pool_inst_t* inst	= block->inst;
+
+	mutex_enter(&(inst->mutex));
 
 	mutex_enter(&block->mutex);
 
@@ -903,7 +992,7 @@ buf_block_free(
 
 	mutex_exit(&block->mutex);
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 }
 
 /*************************************************************************
@@ -942,13 +1031,14 @@ buf_page_peek_block(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst	= buf_pool_inst_get(space, offset);
 	buf_block_t*	block;
 
-	mutex_enter_fast(&(buf_pool->mutex));
+	mutex_enter_fast(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(block);
 }
@@ -963,17 +1053,18 @@ buf_reset_check_index_page_at_flush(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst	= buf_pool_inst_get(space, offset);
 	buf_block_t*	block;
 
-	mutex_enter_fast(&(buf_pool->mutex));
+	mutex_enter_fast(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
 	if (block) {
 		block->check_index_page_at_flush = FALSE;
 	}
-	
-	mutex_exit(&(buf_pool->mutex));
+
+	mutex_exit(&(inst->mutex));
 }
 
 /************************************************************************
@@ -989,10 +1080,11 @@ buf_page_peek_if_search_hashed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst	= buf_pool_inst_get(space, offset);
 	buf_block_t*	block;
 	ibool		is_hashed;
 
-	mutex_enter_fast(&(buf_pool->mutex));
+	mutex_enter_fast(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
@@ -1002,7 +1094,7 @@ buf_page_peek_if_search_hashed(
 		is_hashed = block->is_hashed;
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(is_hashed);
 }
@@ -1042,9 +1134,10 @@ buf_page_set_file_page_was_freed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst	= buf_pool_inst_get(space, offset);
 	buf_block_t*	block;
 
-	mutex_enter_fast(&(buf_pool->mutex));
+	mutex_enter_fast(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
@@ -1052,7 +1145,7 @@ buf_page_set_file_page_was_freed(
 		block->file_page_was_freed = TRUE;
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(block);
 }
@@ -1071,9 +1164,10 @@ buf_page_reset_file_page_was_freed(
 	ulint	space,	/* in: space id */
 	ulint	offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst	= buf_pool_inst_get(space, offset);
 	buf_block_t*	block;
 
-	mutex_enter_fast(&(buf_pool->mutex));
+	mutex_enter_fast(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
@@ -1081,7 +1175,7 @@ buf_page_reset_file_page_was_freed(
 		block->file_page_was_freed = FALSE;
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(block);
 }
@@ -1103,12 +1197,13 @@ buf_page_get_gen(
 	ulint		line,	/* in: line where called */
 	mtr_t*		mtr)	/* in: mini-transaction */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 	ibool		accessed;
 	ulint		fix_type;
 	ibool		success;
 	ibool		must_read;
-	
+
 	ut_ad(mtr);
 	ut_ad((rw_latch == RW_S_LATCH)
 	      || (rw_latch == RW_X_LATCH)
@@ -1120,15 +1215,22 @@ buf_page_get_gen(
 	ut_ad(!ibuf_inside() || ibuf_page(space, offset));
 #endif
 	buf_pool->n_page_gets++;
+
+	inst = buf_pool_inst_get(space, offset);
 loop:
 	block = NULL;
-	mutex_enter_fast(&(buf_pool->mutex));
-	
+	mutex_enter_fast(&(inst->mutex));
+
 	if (guess) {
 		block = buf_block_align(guess);
 
-		if ((offset != block->offset) || (space != block->space)
-				|| (block->state != BUF_BLOCK_FILE_PAGE)) {
+		/* The fields of a block of another instance are not
+		protected by our mutex; such a block cannot contain the
+		page anyway */
+
+		if ((block->inst != inst)
+		    || (offset != block->offset) || (space != block->space)
+		    || (block->state != BUF_BLOCK_FILE_PAGE)) {
 
 			block = NULL;
 		}
@@ -1141,7 +1243,7 @@ loop:
 	if (block == NULL) {
 		/* Page not in buf_pool: needs to be read from file */
 
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		if (mode == BUF_GET_IF_IN_POOL) {
 
@@ -1172,7 +1274,7 @@ loop:
 
 		if (mode == BUF_GET_IF_IN_POOL) {
 			/* The page is only being read to buffer */
-			mutex_exit(&buf_pool->mutex);
+			mutex_exit(&inst->mutex);
 			mutex_exit(&block->mutex);
 
 			return(NULL);
@@ -1197,7 +1299,7 @@ loop:
 #else
 	buf_block_buf_fix_inc(block);
 #endif
-	mutex_exit(&buf_pool->mutex);
+	mutex_exit(&inst->mutex);
 
 	/* Check if this is the first access to the page */
 
@@ -1612,10 +1714,11 @@ buf_page_init(
 	buf_block_t*	block)	/* in: block to init */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(block->inst->mutex)));
 	ut_ad(mutex_own(&(block->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_a(block->state != BUF_BLOCK_FILE_PAGE);
+	ut_ad(block->inst == buf_pool_inst_get(space, offset));
 
 	/* Set the state of the block */
 	block->magic_n		= BUF_BLOCK_MAGIC_N;
@@ -1645,7 +1748,7 @@ buf_page_init(
                 ut_a(0);
         }
 
-	HASH_INSERT(buf_block_t, hash, buf_pool->page_hash,
+	HASH_INSERT(buf_block_t, hash, block->inst->page_hash,
 				buf_page_address_fold(space, offset), block);
 
 	block->freed_page_clock = 0;
@@ -1690,6 +1793,7 @@ buf_page_init_for_read(
 				DISCARD + IMPORT */
 	ulint		offset)	/* in: page number */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 	mtr_t		mtr;
 
@@ -1715,11 +1819,13 @@ buf_page_init_for_read(
 		ut_ad(mode == BUF_READ_ANY_PAGE);
 	}
 	
-	block = buf_block_alloc();
+	inst = buf_pool_inst_get(space, offset);
+
+	block = buf_LRU_get_free_block(inst);
 
 	ut_a(block);
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 	mutex_enter(&block->mutex);
 
 	if (fil_tablespace_deleted_or_being_deleted_in_mem(space,
@@ -1734,7 +1840,7 @@ buf_page_init_for_read(
 		being deleted, or the page is already in buf_pool, return */
 
 		mutex_exit(&block->mutex);
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		buf_block_free(block);
 
@@ -1756,8 +1862,8 @@ buf_page_init_for_read(
 	
 	block->io_fix = BUF_IO_READ;
 
-	buf_pool->n_pend_reads++;
-	
+	inst->n_pend_reads++;
+
 	/* We set a pass-type x-lock on the frame because then the same
 	thread which called for the read operation (and is running now at
 	this point of code) can wait for the read to complete by waiting
@@ -1766,9 +1872,9 @@ buf_page_init_for_read(
 	is completed. The x-lock is cleared by the io-handler thread. */
 	
 	rw_lock_x_lock_gen(&(block->lock), BUF_IO_READ);
-	
+
 	mutex_exit(&block->mutex);
- 	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	if (mode == BUF_READ_IBUF_PAGES_ONLY) {
 
@@ -1793,15 +1899,18 @@ buf_page_create(
 			a page */
 	mtr_t*	mtr)	/* in: mini-transaction handle */
 {
+	buf_pool_inst_t* inst;
 	buf_frame_t*	frame;
 	buf_block_t*	block;
 	buf_block_t*	free_block	= NULL;
-	
+
 	ut_ad(mtr);
 
-	free_block = buf_LRU_get_free_block();
-	
-	mutex_enter(&(buf_pool->mutex));
+	inst = buf_pool_inst_get(space, offset);
+
+	free_block = buf_LRU_get_free_block(inst);
+
+	mutex_enter(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
@@ -1812,7 +1921,7 @@ buf_page_create(
 		block->file_page_was_freed = FALSE;
 
 		/* Page can be found in buf_pool */
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		buf_block_free(free_block);
 
@@ -1844,9 +1953,9 @@ buf_page_create(
 #else
 	buf_block_buf_fix_inc(block);
 #endif
-	buf_pool->n_pages_created++;
+	inst->stat.n_pages_created++;
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	mtr_memo_push(mtr, block, MTR_MEMO_BUF_FIX);
 
@@ -1860,7 +1969,7 @@ buf_page_create(
 	ibuf_merge_or_delete_for_page(NULL, space, offset, TRUE);
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(inst);
 
 	frame = block->frame;
 
@@ -1894,11 +2003,14 @@ buf_page_io_complete(
 /*=================*/
 	buf_block_t*	block)	/* in: pointer to the block in question */
 {
+	buf_pool_inst_t* inst;
 	ulint		io_type;
 	ulint		read_page_no;
-	
+
 	ut_ad(block);
 
+	inst = block->inst;
+
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	/* We do not need protect block->io_fix here by block->mutex to read
@@ -1975,7 +2087,7 @@ buf_page_io_complete(
 		}
 	}
 	
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 	mutex_enter(&block->mutex);
 
 #ifdef UNIV_IBUF_DEBUG
@@ -1993,9 +2105,9 @@ buf_page_io_complete(
 		the x-latch to this OS thread: do not let this confuse you in
 		debugging! */		
 	
-		ut_ad(buf_pool->n_pend_reads > 0);
-		buf_pool->n_pend_reads--;
-		buf_pool->n_pages_read++;
+		ut_ad(inst->n_pend_reads > 0);
+		inst->n_pend_reads--;
+		inst->stat.n_pages_read++;
 
 		rw_lock_x_unlock_gen(&(block->lock), BUF_IO_READ);
 
@@ -2014,7 +2126,7 @@ buf_page_io_complete(
 
 		rw_lock_s_unlock_gen(&(block->lock), BUF_IO_WRITE);
 
-		buf_pool->n_pages_written++;
+		inst->stat.n_pages_written++;
 
 #ifdef UNIV_DEBUG
 		if (buf_debug_prints) {
@@ -2024,7 +2136,7 @@ buf_page_io_complete(
 	}
 	
 	mutex_exit(&block->mutex);
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
@@ -2043,29 +2155,36 @@ void
 buf_pool_invalidate(void)
 /*=====================*/
 {
-	ibool	freed;
+	buf_pool_inst_t* inst;
+	ibool		freed;
+	ulint		i;
 
 	ut_ad(buf_all_freed());
-	
-	freed = TRUE;
 
-	while (freed) {
-		freed = buf_LRU_search_and_free_block(100);
-	}
-	
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
 
-	ut_ad(UT_LIST_GET_LEN(buf_pool->LRU) == 0);
+		freed = TRUE;
 
-	mutex_exit(&(buf_pool->mutex));
+		while (freed) {
+			freed = buf_LRU_search_and_free_block(inst, 100);
+		}
+
+		mutex_enter(&(inst->mutex));
+
+		ut_ad(UT_LIST_GET_LEN(inst->LRU) == 0);
+
+		mutex_exit(&(inst->mutex));
+	}
 }
 
 /*************************************************************************
-Validates the buffer buf_pool data structure. */
-
-ibool
-buf_validate(void)
+Validates a buffer pool instance. */
+static
+void
+buf_validate_inst(
 /*==============*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		i;
@@ -2076,19 +2195,21 @@ buf_validate(void)
 	ulint		n_flush		= 0;
 	ulint		n_free		= 0;
 	ulint		n_page		= 0;
-	
-	ut_ad(buf_pool);
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	for (i = 0; i < buf_pool->curr_size; i++) {
+	for (i = 0; i < inst->curr_size; i++) {
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+		block = inst->blocks + i;
+
+		ut_a(block->inst == inst);
 
 		mutex_enter(&block->mutex);
 
 		if (block->state == BUF_BLOCK_FILE_PAGE) {
 
+			ut_a(buf_pool_inst_get(block->space, block->offset)
+			     == inst);
 			ut_a(buf_page_hash_get(block->space,
 						block->offset) == block);
 			n_page++;
@@ -2119,45 +2240,61 @@ buf_validate(void)
 				ut_a(rw_lock_is_locked(&(block->lock),
 							RW_LOCK_EX));
 			}
-			
+
 			n_lru++;
 
 			if (ut_dulint_cmp(block->oldest_modification,
 						ut_dulint_zero) > 0) {
 					n_flush++;
-			}	
-		
+			}
+
 		} else if (block->state == BUF_BLOCK_NOT_USED) {
 			n_free++;
 		}
 
 		mutex_exit(&block->mutex);
- 	}
+	}
 
-	if (n_lru + n_free > buf_pool->curr_size) {
+	if (n_lru + n_free > inst->curr_size) {
 		fprintf(stderr, "n LRU %lu, n free %lu\n", (ulong) n_lru, (ulong) n_free);
 		ut_error;
 	}
 
-	ut_a(UT_LIST_GET_LEN(buf_pool->LRU) == n_lru);
-	if (UT_LIST_GET_LEN(buf_pool->free) != n_free) {
+	ut_a(UT_LIST_GET_LEN(inst->LRU) == n_lru);
+	if (UT_LIST_GET_LEN(inst->free) != n_free) {
 		fprintf(stderr, "Free list len %lu, free blocks %lu\n",
-			(ulong) UT_LIST_GET_LEN(buf_pool->free), (ulong) n_free);
+			(ulong) UT_LIST_GET_LEN(inst->free), (ulong) n_free);
 		ut_error;
 	}
-	ut_a(UT_LIST_GET_LEN(buf_pool->flush_list) == n_flush);
+	ut_a(UT_LIST_GET_LEN(inst->flush_list) == n_flush);
 
-	ut_a(buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE] == n_single_flush);
-	ut_a(buf_pool->n_flush[BUF_FLUSH_LIST] == n_list_flush);
-	ut_a(buf_pool->n_flush[BUF_FLUSH_LRU] == n_lru_flush);
-	
-	mutex_exit(&(buf_pool->mutex));
+	ut_a(inst->n_flush[BUF_FLUSH_SINGLE_PAGE] == n_single_flush);
+	ut_a(inst->n_flush[BUF_FLUSH_LIST] == n_list_flush);
+	ut_a(inst->n_flush[BUF_FLUSH_LRU] == n_lru_flush);
+
+	mutex_exit(&(inst->mutex));
+}
+
+/*************************************************************************
+Validates the buffer buf_pool data structure. */
+
+ibool
+buf_validate(void)
+/*==============*/
+{
+	ulint	i;
+
+	ut_ad(buf_pool);
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		buf_validate_inst(buf_pool_get_nth_inst(i));
+	}
 
 	ut_a(buf_LRU_validate());
 	ut_a(buf_flush_validate());
 
 	return(TRUE);
-}	
+}
 
 /*************************************************************************
 Prints info of the buffer buf_pool data structure. */
@@ -2166,16 +2303,18 @@ void
 buf_print(void)
 /*===========*/
 {
+	buf_pool_inst_t* inst;
 	dulint*		index_ids;
 	ulint*		counts;
 	ulint		size;
 	ulint		i;
 	ulint		j;
+	ulint		k;
 	dulint		id;
 	ulint		n_found;
 	buf_frame_t* 	frame;
 	dict_index_t*	index;
-	
+
 	ut_ad(buf_pool);
 
 	size = buf_pool->curr_size;
@@ -2183,60 +2322,70 @@ buf_print(void)
 	index_ids = mem_alloc(sizeof(dulint) * size);
 	counts = mem_alloc(sizeof(ulint) * size);
 
-	mutex_enter(&(buf_pool->mutex));
-	
 	fprintf(stderr,
-		"buf_pool size %lu\n"
-		"database pages %lu\n"
-		"free pages %lu\n"
-		"modified database pages %lu\n"
-		"n pending reads %lu\n"
-		"n pending flush LRU %lu list %lu single page %lu\n"
-		"pages read %lu, created %lu, written %lu\n",
-		(ulong) size,
-		(ulong) UT_LIST_GET_LEN(buf_pool->LRU),
-		(ulong) UT_LIST_GET_LEN(buf_pool->free),
-		(ulong) UT_LIST_GET_LEN(buf_pool->flush_list),
-		(ulong) buf_pool->n_pend_reads,
-		(ulong) buf_pool->n_flush[BUF_FLUSH_LRU],
-		(ulong) buf_pool->n_flush[BUF_FLUSH_LIST],
-		(ulong) buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE],
-		(ulong) buf_pool->n_pages_read, buf_pool->n_pages_created,
-		(ulong) buf_pool->n_pages_written);
+		"buf_pool size %lu, instances %lu\n",
+		(ulong) size, (ulong) buf_pool->n_instances);
 
 	/* Count the number of blocks belonging to each index in the buffer */
-	
-	n_found = 0;
 
-	for (i = 0; i < size; i++) {
-		frame = buf_pool_get_nth_block(buf_pool, i)->frame;
-
-		if (fil_page_get_type(frame) == FIL_PAGE_INDEX) {
-
-			id = btr_page_get_index_id(frame);
-
-			/* Look for the id in the index_ids array */
-			j = 0;
+	n_found = 0;
 
-			while (j < n_found) {
+	for (k = 0; k < buf_pool->n_instances; k++) {
+		inst = buf_pool_get_nth_inst(k);
 
-				if (ut_dulint_cmp(index_ids[j], id) == 0) {
-					(counts[j])++;
+		mutex_enter(&(inst->mutex));
 
-					break;
+		fprintf(stderr,
+			"instance %lu size %lu\n"
+			"database pages %lu\n"
+			"free pages %lu\n"
+			"modified database pages %lu\n"
+			"n pending reads %lu\n"
+			"n pending flush LRU %lu list %lu single page %lu\n"
+			"pages read %lu, created %lu, written %lu\n",
+			(ulong) k, (ulong) inst->curr_size,
+			(ulong) UT_LIST_GET_LEN(inst->LRU),
+			(ulong) UT_LIST_GET_LEN(inst->free),
+			(ulong) UT_LIST_GET_LEN(inst->flush_list),
+			(ulong) inst->n_pend_reads,
+			(ulong) inst->n_flush[BUF_FLUSH_LRU],
+			(ulong) inst->n_flush[BUF_FLUSH_LIST],
+			(ulong) inst->n_flush[BUF_FLUSH_SINGLE_PAGE],
+			(ulong) inst->stat.n_pages_read,
+			(ulong) inst->stat.n_pages_created,
+			(ulong) inst->stat.n_pages_written);
+
+		for (i = 0; i < inst->curr_size; i++) {
+			frame = (inst->blocks + i)->frame;
+
+			if (fil_page_get_type(frame) == FIL_PAGE_INDEX) {
+
+				id = btr_page_get_index_id(frame);
+
+				/* Look for the id in the index_ids array */
+				j = 0;
+
+				while (j < n_found) {
+
+					if (ut_dulint_cmp(index_ids[j], id)
+					    == 0) {
+						(counts[j])++;
+
+						break;
+					}
+					j++;
 				}
-				j++;
-			}
 
-			if (j == n_found) {
-				n_found++;
-				index_ids[j] = id;
-				counts[j] = 1;
+				if (j == n_found) {
+					n_found++;
+					index_ids[j] = id;
+					counts[j] = 1;
+				}
 			}
 		}
-	}
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
+	}
 
 	for (i = 0; i < n_found; i++) {
 		index = dict_index_get_if_in_cache(index_ids[i]);
@@ -2253,12 +2402,12 @@ buf_print(void)
 
 		putc('\n', stderr);
 	}
-	
+
 	mem_free(index_ids);
 	mem_free(counts);
 
 	ut_a(buf_validate());
-}	
+}
 
 /*************************************************************************
 Returns the number of latched pages in the buffer pool. */
@@ -2266,28 +2415,36 @@ Returns the number of latched pages in the buffer pool. */
 ulint
 buf_get_latched_pages_number(void)
 {
+        buf_pool_inst_t* inst;
         buf_block_t* block;
         ulint i;
+        ulint k;
         ulint fixed_pages_number = 0;
 
-        mutex_enter(&(buf_pool->mutex));
+        for (k = 0; k < buf_pool->n_instances; k++) {
+		inst = buf_pool_get_nth_inst(k);
 
-        for (i = 0; i < buf_pool->curr_size; i++) {
+		mutex_enter(&(inst->mutex));
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+		for (i = 0; i < inst->curr_size; i++) {
 
-		if (block->magic_n == BUF_BLOCK_MAGIC_N) {
-			mutex_enter(&block->mutex);
+			block = inst->blocks + i;
 
-			if (block->buf_fix_count != 0 || block->io_fix != 0) {
-				fixed_pages_number++;
-			}
+			if (block->magic_n == BUF_BLOCK_MAGIC_N) {
+				mutex_enter(&block->mutex);
 
-			mutex_exit(&block->mutex);
+				if (block->buf_fix_count != 0
+				    || block->io_fix != 0) {
+					fixed_pages_number++;
+				}
+
+				mutex_exit(&block->mutex);
+			}
 		}
+
+		mutex_exit(&(inst->mutex));
         }
 
-        mutex_exit(&(buf_pool->mutex));
         return fixed_pages_number;
 }
 
@@ -2298,10 +2455,90 @@ ulint
 buf_get_n_pending_ios(void)
 /*=======================*/
 {
-	return(buf_pool->n_pend_reads
-		+ buf_pool->n_flush[BUF_FLUSH_LRU]
-		+ buf_pool->n_flush[BUF_FLUSH_LIST]
-		+ buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]);
+	buf_pool_inst_t* inst;
+	ulint		n	= 0;
+	ulint		i;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
+
+		n += inst->n_pend_reads
+			+ inst->n_flush[BUF_FLUSH_LRU]
+			+ inst->n_flush[BUF_FLUSH_LIST]
+			+ inst->n_flush[BUF_FLUSH_SINGLE_PAGE];
+	}
+
+	return(n);
+}
+
+/*************************************************************************
+Returns the number of pending reads summed over the buffer pool instances.
+The counters are read without latching the instances. */
+
+ulint
+buf_pool_get_n_pend_reads(void)
+/*===========================*/
+{
+	ulint	n	= 0;
+	ulint	i;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		n += buf_pool_get_nth_inst(i)->n_pend_reads;
+	}
+
+	return(n);
+}
+
+/*************************************************************************
+Sums up the lengths of the lists of all buffer pool instances. The lists
+are read without latching the instances. */
+
+void
+buf_get_total_list_len(
+/*===================*/
+	ulint*	LRU_len,	/* out: length of all LRU lists */
+	ulint*	free_len,	/* out: length of all free lists */
+	ulint*	flush_list_len)	/* out: length of all flush lists */
+{
+	buf_pool_inst_t* inst;
+	ulint		i;
+
+	*LRU_len = 0;
+	*free_len = 0;
+	*flush_list_len = 0;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
+
+		*LRU_len += UT_LIST_GET_LEN(inst->LRU);
+		*free_len += UT_LIST_GET_LEN(inst->free);
+		*flush_list_len += UT_LIST_GET_LEN(inst->flush_list);
+	}
+}
+
+/*************************************************************************
+Sums up the i/o counters of all buffer pool instances. The counters are
+read without latching the instances. */
+
+void
+buf_get_total_stat(
+/*===============*/
+	buf_pool_stat_t*	tot_stat)	/* out: the sums */
+{
+	buf_pool_inst_t* inst;
+	ulint		i;
+
+	tot_stat->n_pages_read = 0;
+	tot_stat->n_pages_written = 0;
+	tot_stat->n_pages_created = 0;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
+
+		tot_stat->n_pages_read += inst->stat.n_pages_read;
+		tot_stat->n_pages_written += inst->stat.n_pages_written;
+		tot_stat->n_pages_created += inst->stat.n_pages_created;
+	}
 }
 
 /*************************************************************************
@@ -2313,16 +2550,15 @@ buf_get_modified_ratio_pct(void)
 /*============================*/
 {
 	ulint	ratio;
+	ulint	LRU_len;
+	ulint	free_len;
+	ulint	flush_list_len;
 
-	mutex_enter(&(buf_pool->mutex));
+	buf_get_total_list_len(&LRU_len, &free_len, &flush_list_len);
 
-	ratio = (100 * UT_LIST_GET_LEN(buf_pool->flush_list))
-		     / (1 + UT_LIST_GET_LEN(buf_pool->LRU)
-		        + UT_LIST_GET_LEN(buf_pool->free));
+	ratio = (100 * flush_list_len) / (1 + LRU_len + free_len);
 
-		       /* 1 + is there to avoid division by zero */   
-
-	mutex_exit(&(buf_pool->mutex));
+		       /* 1 + is there to avoid division by zero */
 
 	return(ratio);
 }
@@ -2335,23 +2571,53 @@ buf_print_io(
 /*=========*/
 	FILE*	file)	/* in/out: buffer where to print */
 {
-	time_t	current_time;
-	double	time_elapsed;
-	ulint	size;
-	
+	buf_pool_inst_t* inst;
+	buf_pool_stat_t	stat;
+	time_t		current_time;
+	double		time_elapsed;
+	ulint		size;
+	ulint		LRU_len		= 0;
+	ulint		free_len	= 0;
+	ulint		flush_list_len	= 0;
+	ulint		n_pend_reads	= 0;
+	ulint		n_flush[BUF_FLUSH_LIST + 1];
+	ulint		i;
+
 	ut_ad(buf_pool);
 	size = buf_pool->curr_size;
 
-	mutex_enter(&(buf_pool->mutex));
-	
+	n_flush[BUF_FLUSH_LRU] = 0;
+	n_flush[BUF_FLUSH_LIST] = 0;
+	n_flush[BUF_FLUSH_SINGLE_PAGE] = 0;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
+
+		mutex_enter(&(inst->mutex));
+
+		LRU_len += UT_LIST_GET_LEN(inst->LRU);
+		free_len += UT_LIST_GET_LEN(inst->free);
+		flush_list_len += UT_LIST_GET_LEN(inst->flush_list);
+		n_pend_reads += inst->n_pend_reads;
+		n_flush[BUF_FLUSH_LRU] += inst->n_flush[BUF_FLUSH_LRU]
+			+ inst->init_flush[BUF_FLUSH_LRU];
+		n_flush[BUF_FLUSH_LIST] += inst->n_flush[BUF_FLUSH_LIST]
+			+ inst->init_flush[BUF_FLUSH_LIST];
+		n_flush[BUF_FLUSH_SINGLE_PAGE]
+			+= inst->n_flush[BUF_FLUSH_SINGLE_PAGE];
+
+		mutex_exit(&(inst->mutex));
+	}
+
 	if (srv_use_awe) {
 		fprintf(stderr,
 		"AWE: Buffer pool memory frames                        %lu\n",
 				(ulong) buf_pool->n_frames);
-		
+
 		fprintf(stderr,
 		"AWE: Database pages and free buffers mapped in frames %lu\n",
-				(ulong) UT_LIST_GET_LEN(buf_pool->awe_LRU_free_mapped));
+				(ulong) UT_LIST_GET_LEN(
+				buf_pool->instances->awe_LRU_free_mapped));
 	}
 	fprintf(file,
 		"Buffer pool size   %lu\n"
@@ -2361,15 +2627,32 @@ buf_print_io(
 		"Pending reads %lu\n"
 		"Pending writes: LRU %lu, flush list %lu, single page %lu\n",
 		(ulong) size,
-		(ulong) UT_LIST_GET_LEN(buf_pool->free),
-		(ulong) UT_LIST_GET_LEN(buf_pool->LRU),
-		(ulong) UT_LIST_GET_LEN(buf_pool->flush_list),
-		(ulong) buf_pool->n_pend_reads,
-		(ulong) buf_pool->n_flush[BUF_FLUSH_LRU]
-			+ buf_pool->init_flush[BUF_FLUSH_LRU],
-		(ulong) buf_pool->n_flush[BUF_FLUSH_LIST]
-			+ buf_pool->init_flush[BUF_FLUSH_LIST],
-		(ulong) buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]);
+		(ulong) free_len,
+		(ulong) LRU_len,
+		(ulong) flush_list_len,
+		(ulong) n_pend_reads,
+		(ulong) n_flush[BUF_FLUSH_LRU],
+		(ulong) n_flush[BUF_FLUSH_LIST],
+		(ulong) n_flush[BUF_FLUSH_SINGLE_PAGE]);
+
+	if (buf_pool->n_instances > 1) {
+		for (i = 0; i < buf_pool->n_instances; i++) {
+			inst = buf_pool_get_nth_inst(i);
+
+			fprintf(file,
+				"Instance %lu: size %lu, free %lu,"
+				" database pages %lu, modified %lu,"
+				" pending reads %lu\n",
+				(ulong) i,
+				(ulong) inst->curr_size,
+				(ulong) UT_LIST_GET_LEN(inst->free),
+				(ulong) UT_LIST_GET_LEN(inst->LRU),
+				(ulong) UT_LIST_GET_LEN(inst->flush_list),
+				(ulong) inst->n_pend_reads);
+		}
+	}
+
+	buf_get_total_stat(&stat);
 
 	current_time = time(NULL);
 	time_elapsed = 0.001 + difftime(current_time,
@@ -2379,14 +2662,14 @@ buf_print_io(
 	fprintf(file,
 		"Pages read %lu, created %lu, written %lu\n"
 		"%.2f reads/s, %.2f creates/s, %.2f writes/s\n",
-		(ulong) buf_pool->n_pages_read,
-		(ulong) buf_pool->n_pages_created,
-		(ulong) buf_pool->n_pages_written,
-		(buf_pool->n_pages_read - buf_pool->n_pages_read_old)
+		(ulong) stat.n_pages_read,
+		(ulong) stat.n_pages_created,
+		(ulong) stat.n_pages_written,
+		(stat.n_pages_read - buf_pool->old_stat.n_pages_read)
 		/ time_elapsed,
-		(buf_pool->n_pages_created - buf_pool->n_pages_created_old)
+		(stat.n_pages_created - buf_pool->old_stat.n_pages_created)
 		/ time_elapsed,
-		(buf_pool->n_pages_written - buf_pool->n_pages_written_old)
+		(stat.n_pages_written - buf_pool->old_stat.n_pages_written)
 		/ time_elapsed);
 
 	if (srv_use_awe) {
@@ -2395,12 +2678,12 @@ buf_print_io(
 				- buf_pool->n_pages_awe_remapped_old)
 			/ time_elapsed);
 	}
-		
+
 	if (buf_pool->n_page_gets > buf_pool->n_page_gets_old) {
 		fprintf(file, "Buffer pool hit rate %lu / 1000\n",
        (ulong) (1000
 		- ((1000 *
-		    (buf_pool->n_pages_read - buf_pool->n_pages_read_old))
+		    (stat.n_pages_read - buf_pool->old_stat.n_pages_read))
 		/ (buf_pool->n_page_gets - buf_pool->n_page_gets_old))));
 	} else {
 		fputs("No buffer pool page gets since the last printout\n",
@@ -2408,12 +2691,8 @@ buf_print_io(
 	}
 
 	buf_pool->n_page_gets_old = buf_pool->n_page_gets;
-	buf_pool->n_pages_read_old = buf_pool->n_pages_read;
-	buf_pool->n_pages_created_old = buf_pool->n_pages_created;
-	buf_pool->n_pages_written_old = buf_pool->n_pages_written;
+	buf_pool->old_stat = stat;
 	buf_pool->n_pages_awe_remapped_old = buf_pool->n_pages_awe_remapped;
-
-	mutex_exit(&(buf_pool->mutex));
 }
 
 /**************************************************************************
@@ -2425,10 +2704,8 @@ buf_refresh_io_stats(void)
 {
         buf_pool->last_printout_time = time(NULL);
 	buf_pool->n_page_gets_old = buf_pool->n_page_gets;
-	buf_pool->n_pages_read_old = buf_pool->n_pages_read;
-	buf_pool->n_pages_created_old = buf_pool->n_pages_created;
-	buf_pool->n_pages_written_old = buf_pool->n_pages_written;
-	buf_pool->n_pages_awe_remapped_old = buf_pool->n_pages_awe_remapped; 
+	buf_get_total_stat(&buf_pool->old_stat);
+	buf_pool->n_pages_awe_remapped_old = buf_pool->n_pages_awe_remapped;
 }
 
 /*************************************************************************
@@ -2438,38 +2715,44 @@ ibool
 buf_all_freed(void)
 /*===============*/
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 	ulint		i;
-	
+	ulint		k;
+
 	ut_ad(buf_pool);
 
-	mutex_enter(&(buf_pool->mutex));
+	for (k = 0; k < buf_pool->n_instances; k++) {
+		inst = buf_pool_get_nth_inst(k);
 
-	for (i = 0; i < buf_pool->curr_size; i++) {
+		mutex_enter(&(inst->mutex));
 
-		block = buf_pool_get_nth_block(buf_pool, i);
+		for (i = 0; i < inst->curr_size; i++) {
 
-		mutex_enter(&block->mutex);
+			block = inst->blocks + i;
 
-		if (block->state == BUF_BLOCK_FILE_PAGE) {
+			mutex_enter(&block->mutex);
 
-			if (!buf_flush_ready_for_replace(block)) {
+			if (block->state == BUF_BLOCK_FILE_PAGE) {
 
-				fprintf(stderr,
+				if (!buf_flush_ready_for_replace(block)) {
+
+					fprintf(stderr,
 					"Page %lu %lu still fixed or dirty\n",
-					(ulong) block->space,
-					(ulong) block->offset);
-			    	ut_error;
+						(ulong) block->space,
+						(ulong) block->offset);
+					ut_error;
+				}
 			}
-		}
 
-		mutex_exit(&block->mutex);
- 	}
+			mutex_exit(&block->mutex);
+		}
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
+	}
 
 	return(TRUE);
-}	
+}
 
 /*************************************************************************
 Checks that there currently are no pending i/o-operations for the buffer
@@ -2480,19 +2763,23 @@ buf_pool_check_no_pending_io(void)
 /*==============================*/
 				/* out: TRUE if there is no pending i/o */
 {
-	ibool	ret;
+	buf_pool_inst_t* inst;
+	ibool		ret	= TRUE;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
 
-	if (buf_pool->n_pend_reads + buf_pool->n_flush[BUF_FLUSH_LRU]
-				+ buf_pool->n_flush[BUF_FLUSH_LIST]
-				+ buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]) {
-		ret = FALSE;
-	} else {
-		ret = TRUE;
-	}
+		mutex_enter(&(inst->mutex));
+
+		if (inst->n_pend_reads + inst->n_flush[BUF_FLUSH_LRU]
+				+ inst->n_flush[BUF_FLUSH_LIST]
+				+ inst->n_flush[BUF_FLUSH_SINGLE_PAGE]) {
+			ret = FALSE;
+		}
 
-	mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
+	}
 
 	return(ret);
 }
@@ -2504,13 +2791,19 @@ ulint
 buf_get_free_list_len(void)
 /*=======================*/
 {
-	ulint	len;
+	buf_pool_inst_t* inst;
+	ulint		len	= 0;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
 
-	len = UT_LIST_GET_LEN(buf_pool->free);
+		mutex_enter(&(inst->mutex));
 
-	mutex_exit(&(buf_pool->mutex));
+		len += UT_LIST_GET_LEN(inst->free);
+
+		mutex_exit(&(inst->mutex));
+	}
 
 	return(len);
 }
@@ -25,6 +25,40 @@ Created 11/11/1995 Heikki Tuuri
 #include "os0file.h"
 #include "trx0sys.h"
 #include "srv0srv.h"
+#include "ut0ut.h"
+
+/* The state of the adaptive flushing of the master thread; only the
+master thread updates it, SHOW INNODB STATUS reads it without a latch */
+
+typedef struct buf_flush_stat_struct	buf_flush_stat_t;
+
+struct buf_flush_stat_struct{
+	ulint	redo[BUF_FLUSH_STAT_N_INTERVAL];
+				/* bytes of redo log generated in each of
+				the last intervals */
+	ulint	usec[BUF_FLUSH_STAT_N_INTERVAL];
+				/* length of each interval in microseconds */
+	ulint	redo_sum;	/* sum of redo[] */
+	ulint	usec_sum;	/* sum of usec[] */
+	ulint	ind;		/* next slot to use in the arrays */
+	dulint	last_lsn;	/* log_sys->lsn at the end of the previous
+				interval */
+	ulint	last_sec;	/* time of the end of the previous interval */
+	ulint	last_ms;
+	double	redo_rate;	/* estimated redo generation rate in bytes
+				per second */
+	ulint	age;		/* lsn - oldest modification in the buffer
+				pool at the previous call */
+	ulint	target_age;	/* the age we try to keep the oldest dirty
+				page at */
+	ulint	n_dirty;	/* length of the flush list */
+	ulint	n_requested;	/* pages requested in the previous batch */
+	ulint	n_flushed;	/* pages flushed in the previous batch */
+	ulint	n_flushed_total;/* pages flushed by the adaptive flushing
+				since startup */
+};
+
+static buf_flush_stat_t	buf_flush_stat;
 
 /* When flushed, dirty blocks are searched in neigborhoods of this size, and
 flushed along with the original page. */
@@ -32,13 +66,165 @@ flushed along with the original page. */
 #define BUF_FLUSH_AREA		ut_min(BUF_READ_AHEAD_AREA,\
 					       buf_pool->curr_size / 16)
 
+/*************************************************************************
+Flushes pages from the end of the flush list at the rate needed to keep
+the age of the oldest modified page in the buffer pool at a target below
+the asynchronous preflush margin of the log. The rate is estimated from
+the average redo generation rate over the last BUF_FLUSH_STAT_N_INTERVAL
+calls: if the dirty pages are spread evenly over the age, flushing
+n_dirty * rate / age pages in a second moves the oldest modification
+forward as fast as the log grows. The difference of the age from the
+target is worked off over BUF_FLUSH_ADAPTIVE_CATCH_UP seconds. The master
+thread calls this about once per second. */
+
+ulint
+buf_flush_adaptive(void)
+/*====================*/
+				/* out: number of pages for which the write
+				request was queued */
+{
+	buf_flush_stat_t*	stat	= &buf_flush_stat;
+	dulint			lsn;
+	dulint			oldest;
+	ulint			capacity;
+	ulint			sec;
+	ulint			ms;
+	ulint			usec;
+	ulint			redo;
+	double			advance;
+	double			n_pages;
+	ulint			n_req;
+	ulint			n_flushed;
+	ulint			n_lru;
+	ulint			n_free;
+
+	mutex_enter(&(log_sys->mutex));
+
+	lsn = log_sys->lsn;
+	capacity = log_sys->max_modified_age_async;
+
+	mutex_exit(&(log_sys->mutex));
+
+	ut_usectime(&sec, &ms);
+
+	if (ut_dulint_is_zero(stat->last_lsn)) {
+		/* The first call: start measuring */
+
+		stat->last_lsn = lsn;
+		stat->last_sec = sec;
+		stat->last_ms = ms;
+
+		return(0);
+	}
+
+	redo = ut_dulint_minus(lsn, stat->last_lsn);
+
+	if (sec < stat->last_sec
+	    || (sec == stat->last_sec && ms < stat->last_ms)) {
+		/* The clock was set back */
+
+		usec = 0;
+	} else {
+		usec = (sec - stat->last_sec) * 1000000 + ms - stat->last_ms;
+	}
+
+	stat->last_lsn = lsn;
+	stat->last_sec = sec;
+	stat->last_ms = ms;
+
+	stat->redo_sum += redo - stat->redo[stat->ind];
+	stat->usec_sum += usec - stat->usec[stat->ind];
+	stat->redo[stat->ind] = redo;
+	stat->usec[stat->ind] = usec;
+	stat->ind = (stat->ind + 1) % BUF_FLUSH_STAT_N_INTERVAL;
+
+	if (stat->usec_sum > 0) {
+		stat->redo_rate = 1000000.0 * stat->redo_sum / stat->usec_sum;
+	}
+
+	oldest = buf_pool_get_oldest_modification();
+
+	buf_get_total_list_len(&n_lru, &n_free, &stat->n_dirty);
+
+	stat->target_age = capacity / 2;
+	stat->n_requested = 0;
+	stat->n_flushed = 0;
+
+	if (ut_dulint_is_zero(oldest)) {
+		stat->age = 0;
+
+		return(0);
+	}
+
+	stat->age = ut_dulint_minus(lsn, oldest);
+
+	advance = stat->redo_rate
+		+ ((double) stat->age - (double) stat->target_age)
+		/ BUF_FLUSH_ADAPTIVE_CATCH_UP;
+
+	if (advance <= 0 || stat->age == 0) {
+
+		return(0);
+	}
+
+	n_pages = stat->n_dirty * advance / stat->age;
+
+	if (n_pages > srv_io_capacity) {
+		n_pages = srv_io_capacity;
+	}
+
+	n_req = (ulint) n_pages;
+
+	if (n_req == 0) {
+
+		return(0);
+	}
+
+	stat->n_requested = n_req;
+
+	n_flushed = buf_flush_batch(BUF_FLUSH_LIST, n_req, ut_dulint_max);
+
+	if (n_flushed == ULINT_UNDEFINED) {
+		/* Another flush list batch was running, most probably a
+		preflush by a user thread */
+
+		return(0);
+	}
+
+	stat->n_flushed = n_flushed;
+	stat->n_flushed_total += n_flushed;
+
+	return(n_flushed);
+}
+
+/*************************************************************************
+Prints the state of the adaptive flushing. */
+
+void
+buf_flush_print_adaptive(
+/*=====================*/
+	FILE*	file)	/* in: file where to print */
+{
+	buf_flush_stat_t*	stat	= &buf_flush_stat;
+
+	fprintf(file,
+		"Adaptive flushing: redo %.2f bytes/s, oldest modification"
+		" age %lu, target %lu\n"
+		"%lu dirty pages, %lu requested, %lu flushed in the last batch,"
+		" %lu flushed in total\n",
+		stat->redo_rate, (ulong) stat->age, (ulong) stat->target_age,
+		(ulong) stat->n_dirty, (ulong) stat->n_requested,
+		(ulong) stat->n_flushed, (ulong) stat->n_flushed_total);
+}
+
 /**********************************************************************
-Validates the flush list. */
+Validates the flush list of a buffer pool instance. */
 static
 ibool
-buf_flush_validate_low(void);
-/*========================*/
-		/* out: TRUE if ok */
+buf_flush_validate_low(
+/*===================*/
+				/* out: TRUE if ok */
+	buf_pool_inst_t* inst);	/* in: buffer pool instance */
 
 /************************************************************************
 Inserts a modified block into the flush list. */
@@ -48,21 +234,23 @@ buf_flush_insert_into_flush_list(
 /*=============================*/
 	buf_block_t*	block)	/* in: block which is modified */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
-	ut_ad((UT_LIST_GET_FIRST(buf_pool->flush_list) == NULL)
+	ut_ad((UT_LIST_GET_FIRST(inst->flush_list) == NULL)
 	      || (ut_dulint_cmp(
-			(UT_LIST_GET_FIRST(buf_pool->flush_list))
+			(UT_LIST_GET_FIRST(inst->flush_list))
 						->oldest_modification,
 			block->oldest_modification) <= 0));
 
-	UT_LIST_ADD_FIRST(flush_list, buf_pool->flush_list, block);
+	UT_LIST_ADD_FIRST(flush_list, inst->flush_list, block);
 
-	ut_ad(buf_flush_validate_low());
+	ut_ad(buf_flush_validate_low(inst));
 }
 
 /************************************************************************
@@ -75,15 +263,16 @@ buf_flush_insert_sorted_into_flush_list(
 /*====================================*/
 	buf_block_t*	block)	/* in: block which is modified */
 {
+	buf_pool_inst_t* inst	= block->inst;
 	buf_block_t*	prev_b;
 	buf_block_t*	b;
 	
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	prev_b = NULL;
-	b = UT_LIST_GET_FIRST(buf_pool->flush_list);
+	b = UT_LIST_GET_FIRST(inst->flush_list);
 
 	while (b && (ut_dulint_cmp(b->oldest_modification,
 					block->oldest_modification) > 0)) {
@@ -92,13 +281,13 @@ buf_flush_insert_sorted_into_flush_list(
 	}
 
 	if (prev_b == NULL) {
-		UT_LIST_ADD_FIRST(flush_list, buf_pool->flush_list, block);
+		UT_LIST_ADD_FIRST(flush_list, inst->flush_list, block);
 	} else {
-		UT_LIST_INSERT_AFTER(flush_list, buf_pool->flush_list, prev_b,
+		UT_LIST_INSERT_AFTER(flush_list, inst->flush_list, prev_b,
 								block);
 	}
 
-	ut_ad(buf_flush_validate_low());
+	ut_ad(buf_flush_validate_low(inst));
 }
 
 /************************************************************************
@@ -113,7 +302,7 @@ buf_flush_ready_for_replace(
 				BUF_BLOCK_FILE_PAGE and in the LRU list */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(block->inst->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 #endif /* UNIV_SYNC_DEBUG */
 	if (block->state != BUF_BLOCK_FILE_PAGE) {
@@ -148,7 +337,7 @@ buf_flush_ready_for_flush(
 	ulint		flush_type)/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(block->inst->mutex)));
 	ut_ad(mutex_own(&(block->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
@@ -180,19 +369,21 @@ buf_flush_write_complete(
 /*=====================*/
 	buf_block_t*	block)	/* in: pointer to the block in question */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 	ut_ad(block);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	block->oldest_modification = ut_dulint_zero;
 
-	UT_LIST_REMOVE(flush_list, buf_pool->flush_list, block);
+	UT_LIST_REMOVE(flush_list, inst->flush_list, block);
 
-	ut_d(UT_LIST_VALIDATE(flush_list, buf_block_t, buf_pool->flush_list));
+	ut_d(UT_LIST_VALIDATE(flush_list, buf_block_t, inst->flush_list));
 
-	(buf_pool->n_flush[block->flush_type])--;
+	(inst->n_flush[block->flush_type])--;
 
 	if (block->flush_type == BUF_FLUSH_LRU) {
 		/* Put the block to the end of the LRU list to wait to be
@@ -200,18 +391,18 @@ buf_flush_write_complete(
 
 		buf_LRU_make_block_old(block);
 
-		buf_pool->LRU_flush_ended++;
+		inst->LRU_flush_ended++;
 	}
 
 	/* fprintf(stderr, "n pending flush %lu\n",
-		buf_pool->n_flush[block->flush_type]); */
+		inst->n_flush[block->flush_type]); */
 
-	if ((buf_pool->n_flush[block->flush_type] == 0)
-	    && (buf_pool->init_flush[block->flush_type] == FALSE)) {
+	if ((inst->n_flush[block->flush_type] == 0)
+	    && (inst->init_flush[block->flush_type] == FALSE)) {
 
 		/* The running flush batch has ended */
 
-		os_event_set(buf_pool->no_flush[block->flush_type]);
+		os_event_set(inst->no_flush[block->flush_type]);
 	}
 }
 
@@ -529,20 +720,23 @@ buf_flush_try_page(
 	ulint	flush_type)	/* in: BUF_FLUSH_LRU, BUF_FLUSH_LIST, or
 				BUF_FLUSH_SINGLE_PAGE */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 	ibool		locked;
-	
+
 	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST
 				|| flush_type == BUF_FLUSH_SINGLE_PAGE);
 
-	mutex_enter(&(buf_pool->mutex));
+	inst = buf_pool_inst_get(space, offset);
+
+	mutex_enter(&(inst->mutex));
 
 	block = buf_page_hash_get(space, offset);
 
 	ut_a(!block || block->state == BUF_BLOCK_FILE_PAGE);
 
 	if (!block) {
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 		return(0);
 	}
 
@@ -568,12 +762,12 @@ buf_flush_try_page(
 
 		block->flush_type = flush_type;
 
-		if (buf_pool->n_flush[flush_type] == 0) {
+		if (inst->n_flush[flush_type] == 0) {
 
-			os_event_reset(buf_pool->no_flush[flush_type]);
+			os_event_reset(inst->no_flush[flush_type]);
 		}
 
-		(buf_pool->n_flush[flush_type])++;
+		(inst->n_flush[flush_type])++;
 
 		locked = FALSE;
 		
@@ -588,7 +782,7 @@ buf_flush_try_page(
 		}
 
 		mutex_exit(&block->mutex);
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		if (!locked) {
 			buf_flush_buffered_writes();
@@ -636,12 +830,12 @@ buf_flush_try_page(
 
 		block->flush_type = flush_type;
 
-		if (buf_pool->n_flush[flush_type] == 0) {
+		if (inst->n_flush[flush_type] == 0) {
 
-			os_event_reset(buf_pool->no_flush[flush_type]);
+			os_event_reset(inst->no_flush[flush_type]);
 		}
 
-		(buf_pool->n_flush[flush_type])++;
+		(inst->n_flush[flush_type])++;
 
 		rw_lock_s_lock_gen(&(block->lock), BUF_IO_WRITE);
 
@@ -650,7 +844,7 @@ buf_flush_try_page(
 		immediately. */
 		
 		mutex_exit(&block->mutex);
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		buf_flush_write_block_low(block);
 
@@ -676,15 +870,15 @@ buf_flush_try_page(
 
 		block->flush_type = flush_type;
 
-		if (buf_pool->n_flush[block->flush_type] == 0) {
+		if (inst->n_flush[block->flush_type] == 0) {
 
-			os_event_reset(buf_pool->no_flush[block->flush_type]);
+			os_event_reset(inst->no_flush[block->flush_type]);
 		}
 
-		(buf_pool->n_flush[flush_type])++;
+		(inst->n_flush[flush_type])++;
 
 		mutex_exit(&block->mutex);
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		rw_lock_s_lock_gen(&(block->lock), BUF_IO_WRITE);
 
@@ -703,7 +897,7 @@ buf_flush_try_page(
 	}
 
 	mutex_exit(&block->mutex);
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(0);
 }
@@ -719,6 +913,7 @@ buf_flush_try_neighbors(
 	ulint	offset,		/* in: page offset */
 	ulint	flush_type)	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 {
+	buf_pool_inst_t* inst;
 	buf_block_t*	block;
 	ulint		low, high;
 	ulint		count		= 0;
@@ -726,10 +921,12 @@ buf_flush_try_neighbors(
 
 	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
+	inst = buf_pool_inst_get(space, offset);
+
 	low = (offset / BUF_FLUSH_AREA) * BUF_FLUSH_AREA;
 	high = (offset / BUF_FLUSH_AREA + 1) * BUF_FLUSH_AREA;
 
-	if (UT_LIST_GET_LEN(buf_pool->LRU) < BUF_LRU_OLD_MIN_LEN) {
+	if (UT_LIST_GET_LEN(inst->LRU) < BUF_LRU_OLD_MIN_LEN) {
 		/* If there is little space, it is better not to flush any
 		block except from the end of the LRU list */
 	
@@ -743,10 +940,18 @@ buf_flush_try_neighbors(
 		high = fil_space_get_size(space);
 	}
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
 	for (i = low; i < high; i++) {
 
+		if (buf_pool_inst_get(space, i) != inst) {
+			/* The neighbor is buffered in another instance:
+			an area smaller than 2 ^ BUF_POOL_INST_PAGE_SHIFT
+			pages may cross the boundary */
+
+			continue;
+		}
+
 		block = buf_page_hash_get(space, i);
 		ut_a(!block || block->state == BUF_BLOCK_FILE_PAGE);
 
@@ -777,7 +982,7 @@ buf_flush_try_neighbors(
 
 				mutex_exit(&block->mutex);
 
-				mutex_exit(&(buf_pool->mutex));
+				mutex_exit(&(inst->mutex));
 
 				/* Note: as we release the buf_pool mutex
 				above, in buf_flush_try_page we cannot be sure
@@ -788,31 +993,29 @@ buf_flush_try_neighbors(
 				count += buf_flush_try_page(space, i,
 							    flush_type);
 
-				mutex_enter(&(buf_pool->mutex));
+				mutex_enter(&(inst->mutex));
 			} else {
 				mutex_exit(&block->mutex);
 			}
 		}
 	}
 				
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(count);
 }
 
 /***********************************************************************
-This utility flushes dirty blocks from the end of the LRU list or flush_list.
-NOTE 1: in the case of an LRU flush the calling thread may own latches to
-pages: to avoid deadlocks, this function must be written so that it cannot
-end up waiting for these latches! NOTE 2: in the case of a flush list flush,
-the calling thread is not allowed to own any latches on pages! */
-
+Flushes dirty blocks from the end of the LRU list or flush_list of a buffer
+pool instance. See buf_flush_batch. */
+static
 ulint
-buf_flush_batch(
-/*============*/
+buf_flush_batch_inst(
+/*=================*/
 				/* out: number of blocks for which the write
 				request was queued; ULINT_UNDEFINED if there
 				was a flush of the same type already running */
+	buf_pool_inst_t* inst,	/* in: buffer pool instance */
 	ulint	flush_type,	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST; if
 				BUF_FLUSH_LIST, then the caller must not own
 				any latches on pages */
@@ -835,19 +1038,19 @@ buf_flush_batch(
 					|| (flush_type == BUF_FLUSH_LIST)); 
 	ut_ad((flush_type != BUF_FLUSH_LIST)
 					|| sync_thread_levels_empty_gen(TRUE));
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	if ((buf_pool->n_flush[flush_type] > 0)
-	    || (buf_pool->init_flush[flush_type] == TRUE)) {
+	if ((inst->n_flush[flush_type] > 0)
+	    || (inst->init_flush[flush_type] == TRUE)) {
 
 		/* There is already a flush batch of the same type running */
 		
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		return(ULINT_UNDEFINED);
 	}
 
-	(buf_pool->init_flush)[flush_type] = TRUE;
+	(inst->init_flush)[flush_type] = TRUE;
 	
 	for (;;) {
 		/* If we have flushed enough, leave the loop */
@@ -860,11 +1063,11 @@ buf_flush_batch(
 		block to be flushed. */
 		
 	    	if (flush_type == BUF_FLUSH_LRU) {
-			block = UT_LIST_GET_LAST(buf_pool->LRU);
+			block = UT_LIST_GET_LAST(inst->LRU);
 	    	} else {
 			ut_ad(flush_type == BUF_FLUSH_LIST);
 
-			block = UT_LIST_GET_LAST(buf_pool->flush_list);
+			block = UT_LIST_GET_LAST(inst->flush_list);
 			if (!block
 			    || (ut_dulint_cmp(block->oldest_modification,
 			    				lsn_limit) >= 0)) {
@@ -894,7 +1097,7 @@ buf_flush_batch(
 				offset = block->offset;
 	    
 				mutex_exit(&block->mutex);
-				mutex_exit(&(buf_pool->mutex));
+				mutex_exit(&(inst->mutex));
 
 				old_page_count = page_count;
 				
@@ -907,7 +1110,7 @@ buf_flush_batch(
 				flush_type, offset,
 				page_count - old_page_count); */
 
-				mutex_enter(&(buf_pool->mutex));
+				mutex_enter(&(inst->mutex));
 
 			} else if (flush_type == BUF_FLUSH_LRU) {
 
@@ -930,17 +1133,17 @@ buf_flush_batch(
 	    	}
 	}
 
-	(buf_pool->init_flush)[flush_type] = FALSE;
+	(inst->init_flush)[flush_type] = FALSE;
 
-	if ((buf_pool->n_flush[flush_type] == 0)
-	    && (buf_pool->init_flush[flush_type] == FALSE)) {
+	if ((inst->n_flush[flush_type] == 0)
+	    && (inst->init_flush[flush_type] == FALSE)) {
 
 		/* The running flush batch has ended */
 
-		os_event_set(buf_pool->no_flush[flush_type]);
+		os_event_set(inst->no_flush[flush_type]);
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	buf_flush_buffered_writes();
 
@@ -961,17 +1164,72 @@ buf_flush_batch(
 	return(page_count);
 }
 
+/***********************************************************************
+This utility flushes dirty blocks from the end of the LRU list or flush_list.
+NOTE 1: in the case of an LRU flush the calling thread may own latches to
+pages: to avoid deadlocks, this function must be written so that it cannot
+end up waiting for these latches! NOTE 2: in the case of a flush list flush,
+the calling thread is not allowed to own any latches on pages! The work is
+divided evenly between the buffer pool instances. */
+
+ulint
+buf_flush_batch(
+/*============*/
+				/* out: number of blocks for which the write
+				request was queued; ULINT_UNDEFINED if there
+				was a flush of the same type already running
+				in some instance */
+	ulint	flush_type,	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST; if
+				BUF_FLUSH_LIST, then the caller must not own
+				any latches on pages */
+	ulint	min_n,		/* in: wished minimum mumber of blocks flushed
+				(it is not guaranteed that the actual number
+				is that big, though) */
+	dulint	lsn_limit)	/* in the case BUF_FLUSH_LIST all blocks whose
+				oldest_modification is smaller than this
+				should be flushed (if their number does not
+				exceed min_n), otherwise ignored */
+{
+	ulint	n_instances	= buf_pool->n_instances;
+	ulint	page_count	= 0;
+	ibool	skipped		= FALSE;
+	ulint	n;
+	ulint	i;
+
+	if (min_n != ULINT_MAX) {
+		min_n = (min_n + n_instances - 1) / n_instances;
+	}
+
+	for (i = 0; i < n_instances; i++) {
+		n = buf_flush_batch_inst(buf_pool_get_nth_inst(i),
+					 flush_type, min_n, lsn_limit);
+
+		if (n == ULINT_UNDEFINED) {
+			skipped = TRUE;
+		} else {
+			page_count += n;
+		}
+	}
+
+	return(skipped ? ULINT_UNDEFINED : page_count);
+}
+
 /**********************************************************************
-Waits until a flush batch of the given type ends */
+Waits until a flush batch of the given type ends in all the buffer pool
+instances */
 
 void
 buf_flush_wait_batch_end(
 /*=====================*/
 	ulint	type)	/* in: BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 {
+	ulint	i;
+
 	ut_ad((type == BUF_FLUSH_LRU) || (type == BUF_FLUSH_LIST));
-	
-	os_event_wait(buf_pool->no_flush[type]);
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		os_event_wait(buf_pool_get_nth_inst(i)->no_flush[type]);
+	}
 }	
 
 /**********************************************************************
@@ -980,20 +1238,21 @@ a big enough margin of replaceable blocks near the end of the LRU list
 and in the free list. */
 static
 ulint
-buf_flush_LRU_recommendation(void)
-/*==============================*/
-			/* out: number of blocks which should be flushed
-			from the end of the LRU list */
+buf_flush_LRU_recommendation(
+/*=========================*/
+				/* out: number of blocks which should be
+				flushed from the end of the LRU list */
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		n_replaceable;
 	ulint		distance	= 0;
 	
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	n_replaceable = UT_LIST_GET_LEN(buf_pool->free);
+	n_replaceable = UT_LIST_GET_LEN(inst->free);
 
-	block = UT_LIST_GET_LAST(buf_pool->LRU);
+	block = UT_LIST_GET_LAST(inst->LRU);
 
 	while ((block != NULL)
 	       && (n_replaceable < BUF_FLUSH_FREE_BLOCK_MARGIN
@@ -1013,7 +1272,7 @@ buf_flush_LRU_recommendation(void)
 		block = UT_LIST_GET_PREV(LRU, block);
 	}
 	
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	if (n_replaceable >= BUF_FLUSH_FREE_BLOCK_MARGIN) {
 
@@ -1029,25 +1288,36 @@ Flushes pages from the end of the LRU list if there is too small a margin
 of replaceable pages there or in the free list. VERY IMPORTANT: this function
 is called also by threads which have locks on pages. To avoid deadlocks, we
 flush only pages such that the s-lock required for flushing can be acquired
-immediately, without waiting. */ 
+immediately, without waiting. */
 
 void
-buf_flush_free_margin(void)
-/*=======================*/
+buf_flush_free_margin(
+/*==================*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance, or NULL to
+				check all the instances */
 {
 	ulint	n_to_flush;
 	ulint	n_flushed;
+	ulint	i;
+
+	if (inst == NULL) {
+		for (i = 0; i < buf_pool->n_instances; i++) {
+			buf_flush_free_margin(buf_pool_get_nth_inst(i));
+		}
+
+		return;
+	}
+
+	n_to_flush = buf_flush_LRU_recommendation(inst);
 
-	n_to_flush = buf_flush_LRU_recommendation();
-	
 	if (n_to_flush > 0) {
-		n_flushed = buf_flush_batch(BUF_FLUSH_LRU, n_to_flush,
-							ut_dulint_zero);
+		n_flushed = buf_flush_batch_inst(inst, BUF_FLUSH_LRU,
+						 n_to_flush, ut_dulint_zero);
 		if (n_flushed == ULINT_UNDEFINED) {
 			/* There was an LRU type flush batch already running;
 			let us wait for it to end */
-		   
-		        buf_flush_wait_batch_end(BUF_FLUSH_LRU);
+
+		        os_event_wait(inst->no_flush[BUF_FLUSH_LRU]);
 		}
 	}
 }
@@ -1056,16 +1326,17 @@ buf_flush_free_margin(void)
 Validates the flush list. */
 static
 ibool
-buf_flush_validate_low(void)
-/*========================*/
-		/* out: TRUE if ok */
+buf_flush_validate_low(
+/*===================*/
+				/* out: TRUE if ok */
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	dulint		om;
 	
-	UT_LIST_VALIDATE(flush_list, buf_block_t, buf_pool->flush_list);
+	UT_LIST_VALIDATE(flush_list, buf_block_t, inst->flush_list);
 
-	block = UT_LIST_GET_FIRST(buf_pool->flush_list);
+	block = UT_LIST_GET_FIRST(inst->flush_list);
 
 	while (block != NULL) {
 		om = block->oldest_modification;
@@ -1091,13 +1362,18 @@ buf_flush_validate(void)
 /*====================*/
 		/* out: TRUE if ok */
 {
-	ibool	ret;
-	
-	mutex_enter(&(buf_pool->mutex));
+	buf_pool_inst_t* inst;
+	ulint		i;
 
-	ret = buf_flush_validate_low();
-	
-	mutex_exit(&(buf_pool->mutex));
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
+
+		mutex_enter(&(inst->mutex));
 
-	return(ret);
+		ut_a(buf_flush_validate_low(inst));
+
+		mutex_exit(&(inst->mutex));
+	}
+
+	return(TRUE);
 }
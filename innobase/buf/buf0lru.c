@@ -66,24 +66,25 @@ buf_LRU_block_free_hashed_page(
 				be in a state where it can be freed */
 
 /**********************************************************************
-Invalidates all pages belonging to a given tablespace when we are deleting
-the data file(s) of that tablespace. */
-
+Invalidates all pages of a buffer pool instance belonging to a given
+tablespace. */
+static
 void
-buf_LRU_invalidate_tablespace(
-/*==========================*/
-	ulint	id)	/* in: space id */
+buf_LRU_invalidate_tablespace_inst(
+/*===============================*/
+	buf_pool_inst_t* inst,	/* in: buffer pool instance */
+	ulint		id)	/* in: space id */
 {
 	buf_block_t*	block;
 	ulint		page_no;
 	ibool		all_freed;
 
 scan_again:
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 	
 	all_freed = TRUE;
 	
-	block = UT_LIST_GET_LAST(buf_pool->LRU);
+	block = UT_LIST_GET_LAST(inst->LRU);
 
 	while (block != NULL) {
 
@@ -117,7 +118,7 @@ scan_again:
 			
 				mutex_exit(&block->mutex);
 
-				mutex_exit(&(buf_pool->mutex));
+				mutex_exit(&(inst->mutex));
 
 				/* Note that the following call will acquire
 				an S-latch on the page */
@@ -135,7 +136,7 @@ scan_again:
 				block->oldest_modification = ut_dulint_zero;
 
 				UT_LIST_REMOVE(flush_list, 
-						buf_pool->flush_list, block);
+						inst->flush_list, block);
 			}
 
 			/* Remove from the LRU list */
@@ -147,7 +148,7 @@ next_page:
 		block = UT_LIST_GET_PREV(LRU, block);
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 	
 	if (!all_freed) {
 		os_thread_sleep(20000);
@@ -156,37 +157,56 @@ next_page:
 	}
 }
 
+/**********************************************************************
+Invalidates all pages belonging to a given tablespace when we are deleting
+the data file(s) of that tablespace. */
+
+void
+buf_LRU_invalidate_tablespace(
+/*==========================*/
+	ulint	id)	/* in: space id */
+{
+	ulint	i;
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		buf_LRU_invalidate_tablespace_inst(buf_pool_get_nth_inst(i),
+						   id);
+	}
+}
+
 /**********************************************************************
 Gets the minimum LRU_position field for the blocks in an initial segment
 (determined by BUF_LRU_INITIAL_RATIO) of the LRU list. The limit is not
 guaranteed to be precise, because the ulint_clock may wrap around. */
 
 ulint
-buf_LRU_get_recent_limit(void)
-/*==========================*/
-			/* out: the limit; zero if could not determine it */
+buf_LRU_get_recent_limit(
+/*=====================*/
+				/* out: the limit; zero if could not
+				determine it */
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		len;
 	ulint		limit;
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	len = UT_LIST_GET_LEN(buf_pool->LRU);
+	len = UT_LIST_GET_LEN(inst->LRU);
 
 	if (len < BUF_LRU_OLD_MIN_LEN) {
 		/* The LRU list is too short to do read-ahead */
 
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		return(0);
 	}
 
-	block = UT_LIST_GET_FIRST(buf_pool->LRU);
+	block = UT_LIST_GET_FIRST(inst->LRU);
 
 	limit = block->LRU_position - len / BUF_LRU_INITIAL_RATIO;
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
 	return(limit);
 }
@@ -199,21 +219,22 @@ ibool
 buf_LRU_search_and_free_block(
 /*==========================*/
 				/* out: TRUE if freed */
+	buf_pool_inst_t* inst,	/* in: buffer pool instance */
 	ulint	n_iterations)   /* in: how many times this has been called
 				repeatedly without result: a high value means
 				that we should search farther; if value is
 				k < 10, then we only search k/10 * [number
-				of pages in the buffer pool] from the end
+				of pages in the instance] from the end
 				of the LRU list */
 {
 	buf_block_t*	block;
 	ulint		distance = 0;
 	ibool		freed;
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 	
 	freed = FALSE;
-	block = UT_LIST_GET_LAST(buf_pool->LRU);
+	block = UT_LIST_GET_LAST(inst->LRU);
 
 	while (block != NULL) {
 	        ut_a(block->in_LRU_list);
@@ -233,7 +254,7 @@ buf_LRU_search_and_free_block(
 
 			buf_LRU_block_remove_hashed_page(block);
 
-			mutex_exit(&(buf_pool->mutex));
+			mutex_exit(&(inst->mutex));
 			mutex_exit(&block->mutex);
 
 			/* Remove possible adaptive hash index built on the
@@ -246,7 +267,7 @@ buf_LRU_search_and_free_block(
 
 			ut_a(block->buf_fix_count == 0);
 
-			mutex_enter(&(buf_pool->mutex));
+			mutex_enter(&(inst->mutex));
 			mutex_enter(&block->mutex);
 
 			buf_LRU_block_free_hashed_page(block);
@@ -262,22 +283,22 @@ buf_LRU_search_and_free_block(
 		distance++;
 
 		if (!freed && n_iterations <= 10
-		    && distance > 100 + (n_iterations * buf_pool->curr_size)
+		    && distance > 100 + (n_iterations * inst->curr_size)
 					/ 10) {
-			buf_pool->LRU_flush_ended = 0;
+			inst->LRU_flush_ended = 0;
 
-			mutex_exit(&(buf_pool->mutex));
+			mutex_exit(&(inst->mutex));
 			
 			return(FALSE);
 		}
 	}
-	if (buf_pool->LRU_flush_ended > 0) {
-		buf_pool->LRU_flush_ended--;
+	if (inst->LRU_flush_ended > 0) {
+		inst->LRU_flush_ended--;
 	}
  	if (!freed) {
-		buf_pool->LRU_flush_ended = 0;
+		inst->LRU_flush_ended = 0;
 	}
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 	
 	return(freed);
 }
@@ -292,21 +313,34 @@ operations need new buffer blocks, and the i/o work done in flushing would be
 wasted. */
 
 void
-buf_LRU_try_free_flushed_blocks(void)
-/*=================================*/
+buf_LRU_try_free_flushed_blocks(
+/*============================*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance, or NULL for
+				all the instances */
 {
-	mutex_enter(&(buf_pool->mutex));
+	ulint	i;
 
-	while (buf_pool->LRU_flush_ended > 0) {
+	if (inst == NULL) {
+		for (i = 0; i < buf_pool->n_instances; i++) {
+			buf_LRU_try_free_flushed_blocks(
+				buf_pool_get_nth_inst(i));
+		}
 
-		mutex_exit(&(buf_pool->mutex));
+		return;
+	}
+
+	mutex_enter(&(inst->mutex));
 
-		buf_LRU_search_and_free_block(1);
+	while (inst->LRU_flush_ended > 0) {
+
+		mutex_exit(&(inst->mutex));
+
+		buf_LRU_search_and_free_block(inst, 1);
 		
-		mutex_enter(&(buf_pool->mutex));
+		mutex_enter(&(inst->mutex));
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 }	
 
 /**********************************************************************
@@ -320,32 +354,41 @@ buf_LRU_buf_pool_running_out(void)
 				/* out: TRUE if less than 25 % of buffer pool
 				left */
 {
-	ibool	ret	= FALSE;
+	buf_pool_inst_t* inst;
+	ulint		len	= 0;
+	ulint		i;
 
-	mutex_enter(&(buf_pool->mutex));
+	if (recv_recovery_on) {
 
-	if (!recv_recovery_on && UT_LIST_GET_LEN(buf_pool->free)
-	   + UT_LIST_GET_LEN(buf_pool->LRU) < buf_pool->max_size / 4) {
-		
-		ret = TRUE;
+		return(FALSE);
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		inst = buf_pool_get_nth_inst(i);
 
-	return(ret);
+		mutex_enter(&(inst->mutex));
+
+		len += UT_LIST_GET_LEN(inst->free)
+			+ UT_LIST_GET_LEN(inst->LRU);
+
+		mutex_exit(&(inst->mutex));
+	}
+
+	return(len < buf_pool->curr_size / 4);
 }
 
 /**********************************************************************
-Returns a free block from buf_pool. The block is taken off the free list.
-If it is empty, blocks are moved from the end of the LRU list to the free
-list. */
+Returns a free block from a buffer pool instance. The block is taken off the
+free list. If it is empty, blocks are moved from the end of the LRU list to
+the free list. */
 
 buf_block_t*
-buf_LRU_get_free_block(void)
-/*========================*/
+buf_LRU_get_free_block(
+/*===================*/
 				/* out: the free control block; also if AWE is
 				used, it is guaranteed that the block has its
 				page mapped to a frame when we return */
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block		= NULL;
 	ibool		freed;
@@ -353,10 +396,10 @@ buf_LRU_get_free_block(void)
 	ibool		mon_value_was   = FALSE;
 	ibool		started_monitor	= FALSE;
 loop:
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	if (!recv_recovery_on && UT_LIST_GET_LEN(buf_pool->free)
-	   + UT_LIST_GET_LEN(buf_pool->LRU) < buf_pool->max_size / 20) {
+	if (!recv_recovery_on && UT_LIST_GET_LEN(inst->free)
+	   + UT_LIST_GET_LEN(inst->LRU) < inst->curr_size / 20) {
 	   	ut_print_timestamp(stderr);
 
 	   	fprintf(stderr,
@@ -371,8 +414,8 @@ loop:
 
 		ut_error;
 	   
-	} else if (!recv_recovery_on && UT_LIST_GET_LEN(buf_pool->free)
-	   + UT_LIST_GET_LEN(buf_pool->LRU) < buf_pool->max_size / 3) {
+	} else if (!recv_recovery_on && UT_LIST_GET_LEN(inst->free)
+	   + UT_LIST_GET_LEN(inst->LRU) < inst->curr_size / 3) {
 
 		if (!buf_lru_switched_on_innodb_mon) {
 
@@ -407,11 +450,11 @@ loop:
 	}
 	
 	/* If there is a block in the free list, take it */
-	if (UT_LIST_GET_LEN(buf_pool->free) > 0) {
+	if (UT_LIST_GET_LEN(inst->free) > 0) {
 		
-		block = UT_LIST_GET_FIRST(buf_pool->free);
+		block = UT_LIST_GET_FIRST(inst->free);
 		ut_a(block->in_free_list);
-		UT_LIST_REMOVE(free, buf_pool->free, block);
+		UT_LIST_REMOVE(free, inst->free, block);
 		block->in_free_list = FALSE;
 		ut_a(block->state != BUF_BLOCK_FILE_PAGE);
 	        ut_a(!block->in_LRU_list);
@@ -421,7 +464,7 @@ loop:
 				/* Remove from the list of mapped pages */
 		
 				UT_LIST_REMOVE(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
+					inst->awe_LRU_free_mapped, block);
 			} else {
 				/* We map the page to a frame; second param
 				FALSE below because we do not want it to be
@@ -437,7 +480,7 @@ loop:
 
 		mutex_exit(&block->mutex);
 
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		if (started_monitor) {
 			srv_print_innodb_monitor = mon_value_was;
@@ -449,9 +492,9 @@ loop:
 	/* If no block was in the free list, search from the end of the LRU
 	list and try to free a block there */
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 
-	freed = buf_LRU_search_and_free_block(n_iterations);
+	freed = buf_LRU_search_and_free_block(inst, n_iterations);
 
 	if (freed > 0) {
 		goto loop;
@@ -486,23 +529,23 @@ loop:
 
 	/* No free block was found: try to flush the LRU list */
 
-	buf_flush_free_margin();
+	buf_flush_free_margin(inst);
         ++srv_buf_pool_wait_free;
 
 	os_aio_simulated_wake_handler_threads();
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
 
-	if (buf_pool->LRU_flush_ended > 0) {
+	if (inst->LRU_flush_ended > 0) {
 		/* We have written pages in an LRU flush. To make the insert
 		buffer more efficient, we try to move these pages to the free
 		list. */
 
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
-		buf_LRU_try_free_flushed_blocks();
+		buf_LRU_try_free_flushed_blocks(inst);
 	} else {
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 	}
 
 	if (n_iterations > 10) {
@@ -520,41 +563,42 @@ Moves the LRU_old pointer so that the length of the old blocks list
 is inside the allowed limits. */
 UNIV_INLINE
 void
-buf_LRU_old_adjust_len(void)
-/*========================*/
+buf_LRU_old_adjust_len(
+/*===================*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	ulint	old_len;
 	ulint	new_len;
 
-	ut_a(buf_pool->LRU_old);
+	ut_a(inst->LRU_old);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(3 * (BUF_LRU_OLD_MIN_LEN / 8) > BUF_LRU_OLD_TOLERANCE + 5);
 
 	for (;;) {
-		old_len = buf_pool->LRU_old_len;
-		new_len = 3 * (UT_LIST_GET_LEN(buf_pool->LRU) / 8);
+		old_len = inst->LRU_old_len;
+		new_len = 3 * (UT_LIST_GET_LEN(inst->LRU) / 8);
 
-		ut_a(buf_pool->LRU_old->in_LRU_list);
+		ut_a(inst->LRU_old->in_LRU_list);
 
 		/* Update the LRU_old pointer if necessary */
 	
 		if (old_len < new_len - BUF_LRU_OLD_TOLERANCE) {
 		
-			buf_pool->LRU_old = UT_LIST_GET_PREV(LRU,
-							buf_pool->LRU_old);
-			(buf_pool->LRU_old)->old = TRUE;
-			buf_pool->LRU_old_len++;
+			inst->LRU_old = UT_LIST_GET_PREV(LRU,
+							inst->LRU_old);
+			(inst->LRU_old)->old = TRUE;
+			inst->LRU_old_len++;
 
 		} else if (old_len > new_len + BUF_LRU_OLD_TOLERANCE) {
 
-			(buf_pool->LRU_old)->old = FALSE;
-			buf_pool->LRU_old = UT_LIST_GET_NEXT(LRU,
-							buf_pool->LRU_old);
-			buf_pool->LRU_old_len--;
+			(inst->LRU_old)->old = FALSE;
+			inst->LRU_old = UT_LIST_GET_NEXT(LRU,
+							inst->LRU_old);
+			inst->LRU_old_len--;
 		} else {
-			ut_a(buf_pool->LRU_old); /* Check that we did not
+			ut_a(inst->LRU_old); /* Check that we did not
 						fall out of the LRU list */
 			return;
 		}
@@ -566,18 +610,19 @@ Initializes the old blocks pointer in the LRU list. This function should be
 called when the LRU list grows to BUF_LRU_OLD_MIN_LEN length. */
 static
 void
-buf_LRU_old_init(void)
-/*==================*/
+buf_LRU_old_init(
+/*=============*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 
-	ut_a(UT_LIST_GET_LEN(buf_pool->LRU) == BUF_LRU_OLD_MIN_LEN);
+	ut_a(UT_LIST_GET_LEN(inst->LRU) == BUF_LRU_OLD_MIN_LEN);
 
 	/* We first initialize all blocks in the LRU list as old and then use
 	the adjust function to move the LRU_old pointer to the right
 	position */
 
-	block = UT_LIST_GET_FIRST(buf_pool->LRU);
+	block = UT_LIST_GET_FIRST(inst->LRU);
 
 	while (block != NULL) {
 		ut_a(block->state == BUF_BLOCK_FILE_PAGE);
@@ -586,10 +631,10 @@ buf_LRU_old_init(void)
 		block = UT_LIST_GET_NEXT(LRU, block);
 	}
 
-	buf_pool->LRU_old = UT_LIST_GET_FIRST(buf_pool->LRU);
-	buf_pool->LRU_old_len = UT_LIST_GET_LEN(buf_pool->LRU);
-	
-	buf_LRU_old_adjust_len();
+	inst->LRU_old = UT_LIST_GET_FIRST(inst->LRU);
+	inst->LRU_old_len = UT_LIST_GET_LEN(inst->LRU);
+
+	buf_LRU_old_adjust_len(inst);
 }	    	
 
 /**********************************************************************
@@ -600,10 +645,12 @@ buf_LRU_remove_block(
 /*=================*/
 	buf_block_t*	block)	/* in: control block */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 	ut_ad(buf_pool);
 	ut_ad(block);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 		
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
@@ -612,48 +659,48 @@ buf_LRU_remove_block(
 	/* If the LRU_old pointer is defined and points to just this block,
 	move it backward one step */
 
-	if (block == buf_pool->LRU_old) {
+	if (block == inst->LRU_old) {
 
 		/* Below: the previous block is guaranteed to exist, because
 		the LRU_old pointer is only allowed to differ by the
 		tolerance value from strict 3/8 of the LRU list length. */
 
-		buf_pool->LRU_old = UT_LIST_GET_PREV(LRU, block);
-		(buf_pool->LRU_old)->old = TRUE;
+		inst->LRU_old = UT_LIST_GET_PREV(LRU, block);
+		(inst->LRU_old)->old = TRUE;
 
-		buf_pool->LRU_old_len++;
-		ut_a(buf_pool->LRU_old);
+		inst->LRU_old_len++;
+		ut_a(inst->LRU_old);
 	}
 
 	/* Remove the block from the LRU list */
-	UT_LIST_REMOVE(LRU, buf_pool->LRU, block);
+	UT_LIST_REMOVE(LRU, inst->LRU, block);
 	block->in_LRU_list = FALSE;
 
 	if (srv_use_awe && block->frame) {
 		/* Remove from the list of mapped pages */
 		
 		UT_LIST_REMOVE(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
+					inst->awe_LRU_free_mapped, block);
 	}	
 
 	/* If the LRU list is so short that LRU_old not defined, return */
-	if (UT_LIST_GET_LEN(buf_pool->LRU) < BUF_LRU_OLD_MIN_LEN) {
+	if (UT_LIST_GET_LEN(inst->LRU) < BUF_LRU_OLD_MIN_LEN) {
 
-		buf_pool->LRU_old = NULL;
+		inst->LRU_old = NULL;
 
 		return;
 	}
 
-	ut_ad(buf_pool->LRU_old);	
+	ut_ad(inst->LRU_old);	
 
 	/* Update the LRU_old_len field if necessary */
 	if (block->old) {
 
-		buf_pool->LRU_old_len--;
+		inst->LRU_old_len--;
 	}
 
 	/* Adjust the length of the old block list if necessary */
-	buf_LRU_old_adjust_len();
+	buf_LRU_old_adjust_len(inst);
 }	    	
 
 /**********************************************************************
@@ -664,56 +711,57 @@ buf_LRU_add_block_to_end_low(
 /*=========================*/
 	buf_block_t*	block)	/* in: control block */
 {
+	buf_pool_inst_t* inst	= block->inst;
 	buf_block_t*	last_block;
-	
+
 	ut_ad(buf_pool);
 	ut_ad(block);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 
 	block->old = TRUE;
 
-	last_block = UT_LIST_GET_LAST(buf_pool->LRU);
+	last_block = UT_LIST_GET_LAST(inst->LRU);
 
 	if (last_block) {
 		block->LRU_position = last_block->LRU_position;
 	} else {
-		block->LRU_position = buf_pool_clock_tic();
+		block->LRU_position = buf_pool_clock_tic(inst);
 	}			
 
 	ut_a(!block->in_LRU_list);
-	UT_LIST_ADD_LAST(LRU, buf_pool->LRU, block);
+	UT_LIST_ADD_LAST(LRU, inst->LRU, block);
 	block->in_LRU_list = TRUE;
 
 	if (srv_use_awe && block->frame) {
 		/* Add to the list of mapped pages */
 		
 		UT_LIST_ADD_LAST(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
+					inst->awe_LRU_free_mapped, block);
 	}
 	
-	if (UT_LIST_GET_LEN(buf_pool->LRU) >= BUF_LRU_OLD_MIN_LEN) {
+	if (UT_LIST_GET_LEN(inst->LRU) >= BUF_LRU_OLD_MIN_LEN) {
 
-		buf_pool->LRU_old_len++;
+		inst->LRU_old_len++;
 	}
 
-	if (UT_LIST_GET_LEN(buf_pool->LRU) > BUF_LRU_OLD_MIN_LEN) {
+	if (UT_LIST_GET_LEN(inst->LRU) > BUF_LRU_OLD_MIN_LEN) {
 
-		ut_ad(buf_pool->LRU_old);
+		ut_ad(inst->LRU_old);
 
 		/* Adjust the length of the old block list if necessary */
 
-		buf_LRU_old_adjust_len();
+		buf_LRU_old_adjust_len(inst);
 
-	} else if (UT_LIST_GET_LEN(buf_pool->LRU) == BUF_LRU_OLD_MIN_LEN) {
+	} else if (UT_LIST_GET_LEN(inst->LRU) == BUF_LRU_OLD_MIN_LEN) {
 
 		/* The LRU list is now long enough for LRU_old to become
 		defined: init it */
 
-		buf_LRU_old_init();
+		buf_LRU_old_init(inst);
 	}
 }	    	
 
@@ -729,19 +777,20 @@ buf_LRU_add_block_low(
 				LRU list is very short, the block is added to
 				the start, regardless of this parameter */
 {
-	ulint	cl;
-	
+	buf_pool_inst_t* inst	= block->inst;
+	ulint		cl;
+
 	ut_ad(buf_pool);
 	ut_ad(block);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	ut_a(block->state == BUF_BLOCK_FILE_PAGE);
 	ut_a(!block->in_LRU_list);
 
 	block->old = old;
-	cl = buf_pool_clock_tic();
+	cl = buf_pool_clock_tic(inst);
 
 	if (srv_use_awe && block->frame) {
 		/* Add to the list of mapped pages; for simplicity we always
@@ -749,43 +798,43 @@ buf_LRU_add_block_low(
 		TRUE */
 		
 		UT_LIST_ADD_FIRST(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
+					inst->awe_LRU_free_mapped, block);
 	}
 
-	if (!old || (UT_LIST_GET_LEN(buf_pool->LRU) < BUF_LRU_OLD_MIN_LEN)) {
+	if (!old || (UT_LIST_GET_LEN(inst->LRU) < BUF_LRU_OLD_MIN_LEN)) {
 
-		UT_LIST_ADD_FIRST(LRU, buf_pool->LRU, block);
+		UT_LIST_ADD_FIRST(LRU, inst->LRU, block);
 
 		block->LRU_position = cl;		
-		block->freed_page_clock = buf_pool->freed_page_clock;
+		block->freed_page_clock = inst->freed_page_clock;
 	} else {
-		UT_LIST_INSERT_AFTER(LRU, buf_pool->LRU, buf_pool->LRU_old,
+		UT_LIST_INSERT_AFTER(LRU, inst->LRU, inst->LRU_old,
 								block);
-		buf_pool->LRU_old_len++;
+		inst->LRU_old_len++;
 
 		/* We copy the LRU position field of the previous block
 		to the new block */
 
-		block->LRU_position = (buf_pool->LRU_old)->LRU_position;
+		block->LRU_position = (inst->LRU_old)->LRU_position;
 	}
 
 	block->in_LRU_list = TRUE;
 
-	if (UT_LIST_GET_LEN(buf_pool->LRU) > BUF_LRU_OLD_MIN_LEN) {
+	if (UT_LIST_GET_LEN(inst->LRU) > BUF_LRU_OLD_MIN_LEN) {
 
-		ut_ad(buf_pool->LRU_old);
+		ut_ad(inst->LRU_old);
 
 		/* Adjust the length of the old block list if necessary */
 
-		buf_LRU_old_adjust_len();
+		buf_LRU_old_adjust_len(inst);
 
-	} else if (UT_LIST_GET_LEN(buf_pool->LRU) == BUF_LRU_OLD_MIN_LEN) {
+	} else if (UT_LIST_GET_LEN(inst->LRU) == BUF_LRU_OLD_MIN_LEN) {
 
 		/* The LRU list is now long enough for LRU_old to become
 		defined: init it */
 
-		buf_LRU_old_init();
-	}	
+		buf_LRU_old_init(inst);
+	}
 }	    	
 
 /**********************************************************************
@@ -836,8 +885,10 @@ buf_LRU_block_free_non_file_page(
 /*=============================*/
 	buf_block_t*	block)	/* in: block, must not contain a file page */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(block);
@@ -854,14 +905,14 @@ buf_LRU_block_free_non_file_page(
 	/* Wipe contents of page to reveal possible stale pointers to it */
 	memset(block->frame, '\0', UNIV_PAGE_SIZE);
 #endif	
-	UT_LIST_ADD_FIRST(free, buf_pool->free, block);
+	UT_LIST_ADD_FIRST(free, inst->free, block);
 	block->in_free_list = TRUE;
 
 	if (srv_use_awe && block->frame) {
 		/* Add to the list of mapped pages */
 		
 		UT_LIST_ADD_FIRST(awe_LRU_free_mapped,
-					buf_pool->awe_LRU_free_mapped, block);
+					inst->awe_LRU_free_mapped, block);
 	}
 }
 
@@ -876,8 +927,10 @@ buf_LRU_block_remove_hashed_page(
 				be in a state where it can be freed; there
 				may or may not be a hash index to the page */
 {
+	buf_pool_inst_t* inst	= block->inst;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(inst->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(block);
@@ -889,7 +942,7 @@ buf_LRU_block_remove_hashed_page(
 
 	buf_LRU_remove_block(block);
 
-	buf_pool->freed_page_clock += 1;
+	inst->freed_page_clock += 1;
 
 	/* Note that if AWE is enabled the block may not have a frame at all */
 	
@@ -918,7 +971,7 @@ buf_LRU_block_remove_hashed_page(
                 ut_a(0);
         }	
 
-	HASH_DELETE(buf_block_t, hash, buf_pool->page_hash,
+	HASH_DELETE(buf_block_t, hash, inst->page_hash,
 			buf_page_address_fold(block->space, block->offset),
 			block);
 
@@ -935,7 +988,7 @@ buf_LRU_block_free_hashed_page(
 				be in a state where it can be freed */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&(buf_pool->mutex)));
+	ut_ad(mutex_own(&(block->inst->mutex)));
 	ut_ad(mutex_own(&block->mutex));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_a(block->state == BUF_BLOCK_REMOVE_HASH);
@@ -946,32 +999,32 @@ buf_LRU_block_free_hashed_page(
 }
 
 /**************************************************************************
-Validates the LRU list. */
-
-ibool
-buf_LRU_validate(void)
+Validates the LRU list of a buffer pool instance. */
+static
+void
+buf_LRU_validate_inst(
 /*==================*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	ulint		old_len;
 	ulint		new_len;
 	ulint		LRU_pos;
-	
-	ut_ad(buf_pool);
-	mutex_enter(&(buf_pool->mutex));
 
-	if (UT_LIST_GET_LEN(buf_pool->LRU) >= BUF_LRU_OLD_MIN_LEN) {
+	mutex_enter(&(inst->mutex));
+
+	if (UT_LIST_GET_LEN(inst->LRU) >= BUF_LRU_OLD_MIN_LEN) {
 
-		ut_a(buf_pool->LRU_old);
-		old_len = buf_pool->LRU_old_len;
-		new_len = 3 * (UT_LIST_GET_LEN(buf_pool->LRU) / 8);
+		ut_a(inst->LRU_old);
+		old_len = inst->LRU_old_len;
+		new_len = 3 * (UT_LIST_GET_LEN(inst->LRU) / 8);
 		ut_a(old_len >= new_len - BUF_LRU_OLD_TOLERANCE);
 		ut_a(old_len <= new_len + BUF_LRU_OLD_TOLERANCE);
 	}
 		
-	UT_LIST_VALIDATE(LRU, buf_block_t, buf_pool->LRU);
+	UT_LIST_VALIDATE(LRU, buf_block_t, inst->LRU);
 
-	block = UT_LIST_GET_FIRST(buf_pool->LRU);
+	block = UT_LIST_GET_FIRST(inst->LRU);
 
 	old_len = 0;
 
@@ -983,8 +1036,8 @@ buf_LRU_validate(void)
 			old_len++;
 		}
 
-		if (buf_pool->LRU_old && (old_len == 1)) {
-			ut_a(buf_pool->LRU_old == block);
+		if (inst->LRU_old && (old_len == 1)) {
+			ut_a(inst->LRU_old == block);
 		}
 
 		LRU_pos	= block->LRU_position;
@@ -999,13 +1052,13 @@ buf_LRU_validate(void)
 		}
 	}
 
-	if (buf_pool->LRU_old) {
-		ut_a(buf_pool->LRU_old_len == old_len);
+	if (inst->LRU_old) {
+		ut_a(inst->LRU_old_len == old_len);
 	} 
 
-	UT_LIST_VALIDATE(free, buf_block_t, buf_pool->free);
+	UT_LIST_VALIDATE(free, buf_block_t, inst->free);
 
-	block = UT_LIST_GET_FIRST(buf_pool->free);
+	block = UT_LIST_GET_FIRST(inst->free);
 
 	while (block != NULL) {
 		ut_a(block->state == BUF_BLOCK_NOT_USED);
@@ -1013,27 +1066,45 @@ buf_LRU_validate(void)
 		block = UT_LIST_GET_NEXT(free, block);
 	}
 
-	mutex_exit(&(buf_pool->mutex));
-	return(TRUE);
+	mutex_exit(&(inst->mutex));
 }
 
 /**************************************************************************
-Prints the LRU list. */
+Validates the LRU list. */
+
+ibool
+buf_LRU_validate(void)
+/*==================*/
+{
+	ulint	i;
+
+	ut_ad(buf_pool);
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		buf_LRU_validate_inst(buf_pool_get_nth_inst(i));
+	}
 
+	return(TRUE);
+}
+
+/**************************************************************************
+Prints the LRU list of a buffer pool instance. */
+static
 void
-buf_LRU_print(void)
+buf_LRU_print_inst(
 /*===============*/
+	buf_pool_inst_t* inst)	/* in: buffer pool instance */
 {
 	buf_block_t*	block;
 	buf_frame_t*	frame;
 	ulint		len;
-	
-	ut_ad(buf_pool);
-	mutex_enter(&(buf_pool->mutex));
 
-	fprintf(stderr, "Pool ulint clock %lu\n", (ulong) buf_pool->ulint_clock);
+	mutex_enter(&(inst->mutex));
+
+	fprintf(stderr, "Instance %lu ulint clock %lu\n",
+		(ulong) inst->id, (ulong) inst->ulint_clock);
 
-	block = UT_LIST_GET_FIRST(buf_pool->LRU);
+	block = UT_LIST_GET_FIRST(inst->LRU);
 
 	len = 0;
 
@@ -1073,5 +1144,21 @@ buf_LRU_print(void)
 		}
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
+}
+
+/**************************************************************************
+Prints the LRU list. */
+
+void
+buf_LRU_print(void)
+/*===============*/
+{
+	ulint	i;
+
+	ut_ad(buf_pool);
+
+	for (i = 0; i < buf_pool->n_instances; i++) {
+		buf_LRU_print_inst(buf_pool_get_nth_inst(i));
+	}
 }
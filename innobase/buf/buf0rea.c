@@ -38,9 +38,9 @@ a random read-ahead */
 /* The linear read-ahead threshold */
 #define BUF_READ_AHEAD_LINEAR_THRESHOLD	(3 * BUF_READ_AHEAD_LINEAR_AREA / 8)
 
-/* If there are buf_pool->curr_size per the number below pending reads, then
-read-ahead is not done: this is to prevent flooding the buffer pool with
-i/o-fixed buffer blocks */
+/* If there are curr_size per the number below pending reads in a buffer pool
+instance, then read-ahead is not done in it: this is to prevent flooding the
+buffer pool with i/o-fixed buffer blocks */
 #define BUF_READ_AHEAD_PEND_LIMIT	2
 
 /************************************************************************
@@ -177,6 +177,7 @@ buf_read_ahead_random(
 	ulint	offset)	/* in: page number of a page which the current thread
 			wants to access */
 {
+	buf_pool_inst_t* inst;
 	ib_longlong	tablespace_version;
 	buf_block_t*	block;
 	ulint		recent_blocks	= 0;
@@ -216,17 +217,23 @@ buf_read_ahead_random(
 		high = fil_space_get_size(space);
 	}
 
+	/* The read-ahead area is aligned and at most
+	2 ^ BUF_POOL_INST_PAGE_SHIFT pages: all of its pages are buffered in
+	the same instance */
+
+	inst = buf_pool_inst_get(space, offset);
+
 	/* Get the minimum LRU_position field value for an initial segment
 	of the LRU list, to determine which blocks have recently been added
 	to the start of the list. */
-	
-	LRU_recent_limit = buf_LRU_get_recent_limit();
 
-	mutex_enter(&(buf_pool->mutex));
+	LRU_recent_limit = buf_LRU_get_recent_limit(inst);
 
-	if (buf_pool->n_pend_reads >
-			buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
-		mutex_exit(&(buf_pool->mutex));
+	mutex_enter(&(inst->mutex));
+
+	if (inst->n_pend_reads >
+			inst->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+		mutex_exit(&(inst->mutex));
 
 		return(0);
 	}	
@@ -245,7 +252,7 @@ buf_read_ahead_random(
 		}
 	}
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 	
 	if (recent_blocks < BUF_READ_AHEAD_RANDOM_THRESHOLD) {
 		/* Do nothing */
@@ -340,7 +347,7 @@ buf_read_page(
 	}
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(buf_pool_inst_get(space, offset));
 
 	return(count + count2);
 }
@@ -377,6 +384,7 @@ buf_read_ahead_linear(
 	ulint	offset)	/* in: page number of a page; NOTE: the current thread
 			must want access to this page (see NOTE 3 above) */
 {
+	buf_pool_inst_t* inst;
 	ib_longlong	tablespace_version;
 	buf_block_t*	block;
 	buf_frame_t*	frame;
@@ -423,18 +431,22 @@ buf_read_ahead_linear(
 
 	tablespace_version = fil_space_get_version(space);
 
-	mutex_enter(&(buf_pool->mutex));
+	/* All the pages of the area are buffered in the same instance */
+
+	inst = buf_pool_inst_get(space, offset);
+
+	mutex_enter(&(inst->mutex));
 
 	if (high > fil_space_get_size(space)) {
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 		/* The area is not whole, return */
 
 		return(0);
 	}
 
-	if (buf_pool->n_pend_reads >
-			buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
-		mutex_exit(&(buf_pool->mutex));
+	if (inst->n_pend_reads >
+			inst->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+		mutex_exit(&(inst->mutex));
 
 		return(0);
 	}	
@@ -472,7 +484,7 @@ buf_read_ahead_linear(
 			 BUF_READ_AHEAD_LINEAR_THRESHOLD) {
 		/* Too many failures: return */
 
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		return(0);
 	}
@@ -483,7 +495,7 @@ buf_read_ahead_linear(
 	block = buf_page_hash_get(space, offset);
 
 	if (block == NULL) {
-		mutex_exit(&(buf_pool->mutex));
+		mutex_exit(&(inst->mutex));
 
 		return(0);
 	}
@@ -499,7 +511,7 @@ buf_read_ahead_linear(
 	pred_offset = fil_page_get_prev(frame);
 	succ_offset = fil_page_get_next(frame);
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(inst->mutex));
 	
 	if ((offset == low) && (succ_offset == offset + 1)) {
 
@@ -575,7 +587,7 @@ buf_read_ahead_linear(
 	os_aio_simulated_wake_handler_threads();
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(inst);
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && (count > 0)) {
@@ -617,7 +629,7 @@ buf_read_ibuf_merge_pages(
 #ifdef UNIV_IBUF_DEBUG
 	ut_a(n_stored < UNIV_PAGE_SIZE);
 #endif	
-	while (buf_pool->n_pend_reads >
+	while (buf_pool_get_n_pend_reads() >
 			buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
 		os_thread_sleep(500000);
 	}	
@@ -643,7 +655,7 @@ buf_read_ibuf_merge_pages(
 	os_aio_simulated_wake_handler_threads();
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(NULL);
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
@@ -681,7 +693,7 @@ buf_read_recv_pages(
 
 		os_aio_print_debug = FALSE;
 
-		while (buf_pool->n_pend_reads >= recv_n_pool_free_frames / 2) {
+		while (buf_pool_get_n_pend_reads() >= recv_n_pool_free_frames / 2) {
 
 			os_aio_simulated_wake_handler_threads();
 			os_thread_sleep(500000);
@@ -693,7 +705,7 @@ buf_read_recv_pages(
 "InnoDB: Error: InnoDB has waited for 50 seconds for pending\n"
 "InnoDB: reads to the buffer pool to be finished.\n"
 "InnoDB: Number of pending reads %lu, pending pread calls %lu\n",
-				(ulong) buf_pool->n_pend_reads,
+				(ulong) buf_pool_get_n_pend_reads(),
 				(ulong)os_file_n_pending_preads);
 
 				os_aio_print_debug = TRUE;
@@ -715,7 +727,7 @@ buf_read_recv_pages(
 	os_aio_simulated_wake_handler_threads();
 
 	/* Flush pages from the end of the LRU list if necessary */
-	buf_flush_free_margin();
+	buf_flush_free_margin(NULL);
 
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints) {
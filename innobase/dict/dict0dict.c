@@ -108,14 +108,6 @@ dict_col_remove_from_cache(
 /*=======================*/
 	dict_table_t*	table,	/* in: table */
 	dict_col_t*	col);	/* in: column */
-/**************************************************************************
-Removes an index from the dictionary cache. */
-static
-void
-dict_index_remove_from_cache(
-/*=========================*/
-	dict_table_t*	table,	/* in: table */
-	dict_index_t*	index);	/* in, own: index */
 /***********************************************************************
 Copies fields contained in index2 to index1. */
 static
@@ -1546,7 +1538,7 @@ dict_index_add_to_cache(
 
 /**************************************************************************
 Removes an index from the dictionary cache. */
-static
+
 void
 dict_index_remove_from_cache(
 /*=========================*/
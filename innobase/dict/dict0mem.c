@@ -223,6 +223,7 @@ dict_mem_index_create(
 					/* The '1 +' above prevents allocation
 					of an empty mem block */
 	index->stat_n_diff_key_vals = NULL;
+	index->trx_id = ut_dulint_zero;
 
 	index->cached = FALSE;
 	index->magic_n = DICT_INDEX_MAGIC_N;
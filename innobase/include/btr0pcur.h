@@ -100,7 +100,8 @@ btr_pcur_open_with_no_init(
 				btr search latch to protect the record! */
 	btr_pcur_t*	cursor, /* in: memory buffer for persistent cursor */
 	ulint		has_search_latch,/* in: latch mode the caller
-				currently has on btr_search_latch:
+				currently has on the hash index
+				partition latch of index:
 				RW_S_LATCH, or 0 */
 	mtr_t*		mtr);	/* in: mtr */
 /*********************************************************************
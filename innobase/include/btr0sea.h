@@ -25,6 +25,23 @@ btr_search_sys_create(
 /*==================*/
 	ulint	hash_size);	/* in: hash index hash table size */
 /************************************************************************
+Returns the adaptive hash index partition of an index. */
+UNIV_INLINE
+btr_search_part_t*
+btr_search_get_part(
+/*================*/
+				/* out: hash index partition */
+	dulint	index_id);	/* in: index id */
+/************************************************************************
+Returns the latch protecting the adaptive hash index partition of an
+index. */
+UNIV_INLINE
+rw_lock_t*
+btr_search_get_latch(
+/*=================*/
+				/* out: partition latch */
+	dulint	index_id);	/* in: index id */
+/************************************************************************
 Returns search info for an index. */
 UNIV_INLINE
 btr_search_t*
@@ -65,7 +82,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode, 	/* in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor, 	/* out: tree cursor */
 	ulint		has_search_latch,/* in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the hash index
+					partition latch of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/* in: mtr */
 /************************************************************************
@@ -133,6 +151,13 @@ ibool
 btr_search_validate(void);
 /*======================*/
 				/* out: TRUE if ok */
+/************************************************************************
+Prints info of the adaptive hash index partitions. */
+
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file);	/* in: file where to print */
 
 /* Search info directions */
 #define BTR_SEA_NO_DIRECTION	1
@@ -190,32 +215,53 @@ struct btr_search_struct{
 
 #define BTR_SEARCH_MAGIC_N	1112765
 
+/* The maximum number of adaptive hash index partitions */
+#define BTR_SEARCH_MAX_PARTS	64
+
+/* A partition of the adaptive hash index. Each index is assigned to one
+partition by its id, so that searches and updates in unrelated indexes do
+not contend for the same latch. */
+
+struct btr_search_part_struct{
+	rw_lock_t	latch;		/* the latch protecting the partition:
+					this latch protects the
+					(1) hash index of the partition;
+					(2) columns of a record to which we
+					have a pointer in that hash index;
+					(3) is_hashed, index and curr_...
+					fields of the blocks of the indexes
+					in the partition;
+
+					but does NOT protect:
+
+					(4) next record offset field in a
+					record;
+					(5) next or previous records on the
+					same page.
+
+					Bear in mind (4) and (5) when using
+					the hash index. */
+	hash_table_t*	hash_index;	/* the hash table */
+	ulint		n_hash_succ;	/* number of successful hash searches
+					in the partition; not protected by
+					any latch */
+	ulint		n_hash_fail;	/* number of failed hash searches */
+	byte		pad[64];	/* padding to keep the latches of
+					adjacent partitions on different
+					cache lines */
+};
+
 /* The hash index system */
 
 typedef struct btr_search_sys_struct	btr_search_sys_t;
 
 struct btr_search_sys_struct{
-	hash_table_t*	hash_index;
+	ulint			n_parts;/* number of partitions */
+	btr_search_part_t*	parts;	/* array of the partitions */
 };
 
 extern btr_search_sys_t*	btr_search_sys;
 
-/* The latch protecting the adaptive search system: this latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
-
-but does NOT protect:
-
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
-
-Bear in mind (3) and (4) when using the hash index.
-*/
-
-extern rw_lock_t*	btr_search_latch_temp;
-
-#define btr_search_latch	(*btr_search_latch_temp)
-
 #ifdef UNIV_SEARCH_PERF_STAT
 extern ulint	btr_search_n_succ;
 #endif /* UNIV_SEARCH_PERF_STAT */
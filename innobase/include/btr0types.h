@@ -17,5 +17,6 @@ Created 2/17/1996 Heikki Tuuri
 typedef struct btr_pcur_struct		btr_pcur_t;
 typedef struct btr_cur_struct 		btr_cur_t;
 typedef struct btr_search_struct	btr_search_t;
+typedef struct btr_search_part_struct	btr_search_part_t;
 
 #endif 
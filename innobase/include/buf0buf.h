@@ -55,6 +55,16 @@ Created 11/5/1995 Heikki Tuuri
 /* Magic value to use instead of checksums when they are disabled */
 #define BUF_NO_CHECKSUM_MAGIC 0xDEADBEEFUL
 
+/* All the pages of an aligned area of 2 ^ BUF_POOL_INST_PAGE_SHIFT pages
+of a space are buffered in the same buffer pool instance: this must not be
+smaller than the read-ahead and flush neighborhood areas */
+#define BUF_POOL_INST_PAGE_SHIFT	6
+/* Maximum number of buffer pool instances */
+#define BUF_POOL_MAX_INSTANCES		64
+/* Minimum number of blocks in a buffer pool instance: the number of
+instances is reduced if the buffer pool is too small for them */
+#define BUF_POOL_INST_MIN_SIZE		256
+
 extern buf_pool_t* 	buf_pool; 	/* The buffer pool of the database */
 #ifdef UNIV_DEBUG
 extern ibool		buf_debug_prints;/* If this is set TRUE, the program
@@ -107,6 +117,25 @@ buf_pool_get_oldest_modification(void);
 /*==================================*/
 				/* out: oldest modification in pool,
 				ut_dulint_zero if none */
+/************************************************************************
+Returns the buffer pool instance which buffers a file page. All the pages
+of an aligned area of 2 ^ BUF_POOL_INST_PAGE_SHIFT pages of a space belong
+to the same instance. */
+UNIV_INLINE
+buf_pool_inst_t*
+buf_pool_inst_get(
+/*==============*/
+			/* out: buffer pool instance */
+	ulint	space,	/* in: space id */
+	ulint	offset);/* in: page number */
+/************************************************************************
+Returns the nth buffer pool instance. */
+UNIV_INLINE
+buf_pool_inst_t*
+buf_pool_get_nth_inst(
+/*==================*/
+			/* out: buffer pool instance */
+	ulint	i);	/* in: index of the instance, < buf_pool->n_instances */
 /*************************************************************************
 Allocates a buffer frame. */
 
@@ -516,6 +545,31 @@ ulint
 buf_get_n_pending_ios(void);
 /*=======================*/
 /*************************************************************************
+Returns the number of pending reads summed over the buffer pool instances.
+The counters are read without latching the instances. */
+
+ulint
+buf_pool_get_n_pend_reads(void);
+/*===========================*/
+/*************************************************************************
+Sums up the lengths of the lists of all buffer pool instances. The lists
+are read without latching the instances. */
+
+void
+buf_get_total_list_len(
+/*===================*/
+	ulint*	LRU_len,	/* out: length of all LRU lists */
+	ulint*	free_len,	/* out: length of all free lists */
+	ulint*	flush_list_len);/* out: length of all flush lists */
+/*************************************************************************
+Sums up the i/o counters of all buffer pool instances. The counters are
+read without latching the instances. */
+
+void
+buf_get_total_stat(
+/*===============*/
+	buf_pool_stat_t*	tot_stat);	/* out: the sums */
+/*************************************************************************
 Prints info of the buffer i/o. */
 
 void
@@ -680,7 +734,8 @@ buf_page_address_fold(
 	ulint	space,	/* in: space id */
 	ulint	offset);/* in: offset of the page within space */
 /**********************************************************************
-Returns the control block of a file page, NULL if not found. */
+Returns the control block of a file page, NULL if not found. The caller
+must own the mutex of the buffer pool instance of the page. */
 UNIV_INLINE
 buf_block_t*
 buf_page_hash_get(
@@ -689,13 +744,15 @@ buf_page_hash_get(
 	ulint	space,	/* in: space id */
 	ulint	offset);/* in: offset of the page within space */
 /***********************************************************************
-Increments the pool clock by one and returns its new value. Remember that
-in the 32 bit version the clock wraps around at 4 billion! */
+Increments the clock of a buffer pool instance by one and returns its new
+value. Remember that in the 32 bit version the clock wraps around at 4
+billion! */
 UNIV_INLINE
 ulint
-buf_pool_clock_tic(void);
-/*====================*/
-			/* out: new clock value */
+buf_pool_clock_tic(
+/*===============*/
+				/* out: new clock value */
+	buf_pool_inst_t*	inst);	/* in: buffer pool instance */
 /*************************************************************************
 Gets the current length of the free list of buffer blocks. */
 
@@ -717,6 +774,9 @@ struct buf_block_struct{
 					this is only allowed when a thread
 					has BOTH the buffer pool mutex AND
 					block->mutex locked */
+	buf_pool_inst_t* inst;		/* the buffer pool instance which
+					owns this block; this is fixed
+					when the buffer pool is created */
 	byte*		frame;		/* pointer to buffer frame which
 					is of size UNIV_PAGE_SIZE, and
 					aligned to an address divisible by
@@ -771,6 +831,11 @@ struct buf_block_struct{
 					flushed to disk, this tells the
 					flush_type: BUF_FLUSH_LRU or
 					BUF_FLUSH_LIST */
+	ulint		dblwr_region;	/* if the block is being written to
+					a data file from the doublewrite
+					buffer, the number of the doublewrite
+					region holding its copy; otherwise
+					ULINT_UNDEFINED */
 
 	/* 3. LRU replacement algorithm fields */
 
@@ -846,7 +911,8 @@ struct buf_block_struct{
 					indexed in the hash index */
 					
 	/* These 6 fields may only be modified when we have
-	an x-latch on btr_search_latch AND
+	an x-latch on the adaptive hash index partition
+	latch of the index of the page AND
 	a) we are holding an s-latch or x-latch on block->lock or
 	b) we know that block->buf_fix_count == 0.
 
@@ -884,16 +950,31 @@ struct buf_block_struct{
 
 #define BUF_BLOCK_MAGIC_N	41526563
 
+/* The buffer pool statistics summed over the instances */
+
+struct buf_pool_stat_struct{
+	ulint		n_pages_read;	/* number read operations */
+	ulint		n_pages_written;/* number write operations */
+	ulint		n_pages_created;/* number of pages created in the pool
+					with no read */
+};
+
 /* The buffer pool structure. NOTE! The definition appears here only for
-other modules of this directory (buf) to see it. Do not use from outside! */
+other modules of this directory (buf) to see it. Do not use from outside!
+
+The frames and control blocks are allocated in one piece for the whole
+pool, but the control blocks are divided into n_instances contiguous
+ranges, each owned by a buf_pool_inst_t which has its own mutex, page
+hash table, free list, LRU list and flush list. A file page is always
+buffered in a block of the instance which buf_pool_inst_get() returns
+for its address, so that a thread only needs the mutex of that instance
+to look up, read in or replace the page. Blocks which do not contain
+file pages are allocated from the instances in turn. */
 
 struct buf_pool_struct{
 
 	/* 1. General fields */
 
-	mutex_t		mutex;		/* mutex protecting the buffer pool
-					struct and control blocks, except the
-					read-write lock in them */
 	byte*		frame_mem;	/* pointer to the memory area which
 					was allocated for the frames; in AWE
 					this is the virtual address space
@@ -925,16 +1006,14 @@ struct buf_pool_struct{
 	ulint		curr_size;	/* current pool size in pages;
 					currently always the same as
 					max_size */
-	hash_table_t*	page_hash;	/* hash table of the file pages */
-
-	ulint		n_pend_reads;	/* number of pending read operations */
+	ulint		n_instances;	/* number of buffer pool instances */
+	buf_pool_inst_t* instances;	/* array of the instances */
+	ulint		next_inst;	/* the instance from which the next
+					block for a non-file page is allocated;
+					this is NOT protected by any mutex */
 
 	time_t		last_printout_time; /* when buf_print was last time
 					called */
-	ulint		n_pages_read;	/* number read operations */
-	ulint		n_pages_written;/* number write operations */
-	ulint		n_pages_created;/* number of pages created in the pool
-					with no read */
 	ulint		n_page_gets;	/* number of page gets performed;
 					also successful searches through
 					the adaptive hash index are
@@ -947,12 +1026,31 @@ struct buf_pool_struct{
 	ulint		n_page_gets_old;/* n_page_gets when buf_print was
 					last time called: used to calculate
 					hit rate */
-	ulint		n_pages_read_old;/* n_pages_read when buf_print was
-					last time called */
-	ulint		n_pages_written_old;/* number write operations */
-	ulint		n_pages_created_old;/* number of pages created in
-					the pool with no read */
+	buf_pool_stat_t	old_stat;	/* the sums of the instance counters
+					when buf_print was last time called */
 	ulint		n_pages_awe_remapped_old;
+};
+
+/* A buffer pool instance. NOTE! The definition appears here only for
+other modules of this directory (buf) to see it. Do not use from outside! */
+
+struct buf_pool_inst_struct{
+
+	/* 1. General fields */
+
+	mutex_t		mutex;		/* mutex protecting the instance
+					struct and its control blocks, except
+					the read-write lock in them */
+	ulint		id;		/* number of the instance */
+	buf_block_t*	blocks;		/* the first control block of the
+					instance in buf_pool->blocks */
+	ulint		curr_size;	/* number of control blocks owned by
+					the instance */
+	hash_table_t*	page_hash;	/* hash table of the file pages */
+
+	ulint		n_pend_reads;	/* number of pending read operations */
+	buf_pool_stat_t	stat;		/* i/o counters of the instance */
+
 	/* 2. Page flushing algorithm fields */
 
 	UT_LIST_BASE_NODE_T(buf_block_t) flush_list;
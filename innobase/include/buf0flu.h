@@ -26,8 +26,10 @@ Flushes pages from the end of the LRU list if there is too small
 a margin of replaceable pages there. */
 
 void
-buf_flush_free_margin(void);
-/*=======================*/
+buf_flush_free_margin(
+/*==================*/
+	buf_pool_inst_t* inst);	/* in: buffer pool instance, or NULL to
+				check all the instances */
 /************************************************************************
 Initializes a page for writing to the tablespace. */
 
@@ -97,6 +99,24 @@ buf_flush_ready_for_replace(
 				/* out: TRUE if can replace immediately */
 	buf_block_t*	block);	/* in: buffer control block, must be in state
 				BUF_BLOCK_FILE_PAGE and in the LRU list */
+/*************************************************************************
+Flushes pages from the end of the flush list at the rate needed to keep
+the age of the oldest modified page in the buffer pool at a target below
+the asynchronous preflush margin of the log. The master thread calls this
+about once per second. */
+
+ulint
+buf_flush_adaptive(void);
+/*====================*/
+				/* out: number of pages for which the write
+				request was queued */
+/*************************************************************************
+Prints the state of the adaptive flushing. */
+
+void
+buf_flush_print_adaptive(
+/*=====================*/
+	FILE*	file);	/* in: file where to print */
 /**********************************************************************
 Validates the flush list. */
 
@@ -113,6 +133,14 @@ sweep). */
 #define BUF_FLUSH_FREE_BLOCK_MARGIN 	(5 + BUF_READ_AHEAD_AREA)
 #define BUF_FLUSH_EXTRA_MARGIN 		(BUF_FLUSH_FREE_BLOCK_MARGIN / 4 + 100)
 
+/* Number of calls of buf_flush_adaptive over which the redo generation
+rate is averaged */
+#define BUF_FLUSH_STAT_N_INTERVAL	20
+
+/* Number of seconds in which buf_flush_adaptive tries to bring the age of
+the oldest modified page back to the target */
+#define BUF_FLUSH_ADAPTIVE_CATCH_UP	10
+
 #ifndef UNIV_NONINL
 #include "buf0flu.ic"
 #endif
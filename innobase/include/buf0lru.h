@@ -23,8 +23,10 @@ operations need new buffer blocks, and the i/o work done in flushing would be
 wasted. */
 
 void
-buf_LRU_try_free_flushed_blocks(void);
-/*==================================*/
+buf_LRU_try_free_flushed_blocks(
+/*============================*/
+	buf_pool_inst_t* inst);	/* in: buffer pool instance, or NULL for
+				all the instances */
 /**********************************************************************
 Returns TRUE if less than 25 % of the buffer pool is available. This can be
 used in heuristics to prevent huge transactions eating up the whole buffer
@@ -62,9 +64,11 @@ Gets the minimum LRU_position field for the blocks in an initial segment
 guaranteed to be precise, because the ulint_clock may wrap around. */
 
 ulint
-buf_LRU_get_recent_limit(void);
-/*==========================*/
-			/* out: the limit; zero if could not determine it */
+buf_LRU_get_recent_limit(
+/*=====================*/
+				/* out: the limit; zero if could not
+				determine it */
+	buf_pool_inst_t* inst);	/* in: buffer pool instance */
 /**********************************************************************
 Look for a replaceable block from the end of the LRU list and put it to
 the free list if found. */
@@ -73,23 +77,25 @@ ibool
 buf_LRU_search_and_free_block(
 /*==========================*/
 				/* out: TRUE if freed */
+	buf_pool_inst_t* inst,	/* in: buffer pool instance */
 	ulint	n_iterations);   /* in: how many times this has been called
 				repeatedly without result: a high value means
 				that we should search farther; if value is
 				k < 10, then we only search k/10 * number
-				of pages in the buffer pool from the end
+				of pages in the instance from the end
 				of the LRU list */
 /**********************************************************************
-Returns a free block from the buf_pool. The block is taken off the
-free list. If it is empty, blocks are moved from the end of the
+Returns a free block from a buffer pool instance. The block is taken off
+the free list. If it is empty, blocks are moved from the end of the
 LRU list to the free list. */
 
 buf_block_t*
-buf_LRU_get_free_block(void);
-/*=========================*/
+buf_LRU_get_free_block(
+/*===================*/
 				/* out: the free control block; also if AWE is
 				used, it is guaranteed that the block has its
 				page mapped to a frame when we return */
+	buf_pool_inst_t* inst);	/* in: buffer pool instance */
 /**********************************************************************
 Puts a block back to the free list. */
 
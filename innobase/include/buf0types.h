@@ -11,6 +11,8 @@ Created 11/17/1995 Heikki Tuuri
 
 typedef	struct buf_block_struct		buf_block_t;
 typedef	struct buf_pool_struct		buf_pool_t;
+typedef	struct buf_pool_inst_struct	buf_pool_inst_t;
+typedef	struct buf_pool_stat_struct	buf_pool_stat_t;
 
 /* The 'type' used of a buffer frame */
 typedef	byte	buf_frame_t;
@@ -69,6 +69,9 @@ Created 5/24/1996 Heikki Tuuri
 					a feature that it can't recoginize or
 					work with e.g., FT indexes created by
 					a later version of the engine. */
+#define DB_MISSING_HISTORY	49	/* a consistent read cannot use an
+					index that was built after its read
+					view was created */
 
 /* The following are partial failure codes */
 #define DB_FAIL 		1000
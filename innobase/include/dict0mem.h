@@ -263,6 +263,10 @@ struct dict_index_struct{
 	ulint		stat_n_leaf_pages;
 				/* approximate number of leaf pages in the
 				index tree */
+	dulint		trx_id;	/* id of the transaction that built this
+				index with row_merge_build_index(), or
+				ut_dulint_zero; consistent reads of older
+				read views cannot use the index */
 	ulint		magic_n;/* magic number */
 };
 
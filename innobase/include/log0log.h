@@ -184,6 +184,15 @@ log_preflush_pool_modified_pages(
 	ibool	sync);		/* in: TRUE if synchronous operation is
 				desired */
 /**********************************************************
+Checks if the checkpoint age has grown so big that a background thread
+should make a new checkpoint, so that user threads do not have to make
+one at the log margins. */
+
+ibool
+log_checkpoint_is_due(void);
+/*=======================*/
+			/* out: TRUE if a checkpoint should be made */
+/**********************************************************
 Makes a checkpoint. Note that this function does not flush dirty
 blocks from the buffer pool: it only checks what is lsn of the oldest
 modification in the pool, and writes information about the lsn in
@@ -41,6 +41,18 @@ extern ulint    os_n_pending_writes;
 
 #endif
 
+#if defined(HAVE_LINUX_AIO_ABI_H) && defined(HAVE_SYS_SYSCALL_H) \
+	&& !defined(UNIV_HOTBACKUP)
+#include <sys/syscall.h>
+#if defined(__NR_io_setup) && defined(__NR_io_destroy) \
+	&& defined(__NR_io_submit) && defined(__NR_io_getevents)
+/* We use the Linux kernel aio system calls directly, so that we do not
+need libaio. Whether the running kernel supports them is checked at
+startup in os_aio_linux_is_supported(). */
+#define LINUX_NATIVE_AIO
+#endif
+#endif
+
 #ifdef __WIN__
 #define os_file_t	HANDLE
 #else
@@ -647,6 +659,42 @@ os_aio_windows_handle(
 	ulint*	type);		/* out: OS_FILE_WRITE or ..._READ */
 #endif
 
+#ifdef LINUX_NATIVE_AIO
+/**************************************************************************
+Checks if the Linux kernel aio system calls work. */
+
+ibool
+os_aio_linux_is_supported(
+/*======================*/
+				/* out: TRUE if Linux native aio can be
+				used */
+	ulint	n);		/* in: number of aio requests that must be
+				able to be pending at the same time */
+/**************************************************************************
+This function is only used in Linux native asynchronous i/o.
+Waits for an aio operation to complete. Each i/o-handler thread reaps the
+completed requests of its own segment from the kernel with io_getevents().
+NOTE: this function will also take care of freeing the aio slot,
+therefore no other thread is allowed to do the freeing! */
+
+ibool
+os_aio_linux_handle(
+/*================*/
+				/* out: TRUE if the aio operation succeeded */
+	ulint	global_segment,	/* in: the number of the segment in the aio
+				arrays to wait for; segment 0 is the ibuf
+				i/o thread, segment 1 the log i/o thread,
+				then follow the non-ibuf read threads, and as
+				the last are the non-ibuf write threads */
+	fil_node_t**message1,	/* out: the messages passed with the aio
+				request; note that also in the case where
+				the aio operation failed, these output
+				parameters are valid and can be used to
+				restart the operation, for example */
+	void**	message2,
+	ulint*	type);		/* out: OS_FILE_WRITE or ..._READ */
+#endif
+
 /* Currently we do not use Posix async i/o */
 #ifdef POSIX_ASYNC_IO
 /**************************************************************************
@@ -0,0 +1,95 @@
+/******************************************************
+Creation and removal of secondary indexes of existing tables
+
+(c) 2008 Innobase Oy
+
+Created 10/18/2008
+*******************************************************/
+
+#ifndef row0merge_h
+#define row0merge_h
+
+#include "univ.i"
+#include "data0data.h"
+#include "dict0types.h"
+#include "trx0types.h"
+
+/*************************************************************************
+Creates a secondary index in the data dictionary and adds it to the
+dictionary cache. The index is empty: it is filled with
+row_merge_build_index(). The caller must hold the dictionary lock, and
+commit the transaction after the index has been built, or roll back the
+transaction, which frees the index tree, and then remove the index from
+the cache with dict_index_remove_from_cache(). */
+
+ulint
+row_merge_create_index(
+/*===================*/
+					/* out: DB_SUCCESS or error code */
+	trx_t*		trx,		/* in: dictionary transaction */
+	dict_index_t*	index_def,	/* in, own: index definition from
+					dict_mem_index_create() */
+	const ulint*	field_lengths,	/* in: actual field lengths of the
+					index columns, or NULL, see
+					row_check_index_for_mysql() */
+	dict_index_t**	index);		/* out: the index in the dictionary
+					cache */
+/*************************************************************************
+Fills an empty secondary index created with row_merge_create_index().
+The clustered index is scanned once, the entries of the new index are
+sorted in buffers of buf_size bytes, the sorted runs are merged in
+temporary files, and the entries are inserted into the index tree in
+ascending order, so that the pages get filled. The caller must hold an
+S-lock on the table, so that there are neither uncommitted changes nor
+new changes to the rows while the index is built. */
+
+ulint
+row_merge_build_index(
+/*==================*/
+					/* out: DB_SUCCESS, DB_DUPLICATE_KEY,
+					DB_OUT_OF_FILE_SPACE or DB_ERROR */
+	trx_t*		trx,		/* in: transaction that created the
+					index */
+	dict_index_t*	index,		/* in: the new index */
+	ulint		buf_size);	/* in: size of the sort buffer */
+/*************************************************************************
+Checks that secondary indexes can be dropped: each foreign key constraint
+that uses one of them must be able to use another index of the table, to
+which the constraint is switched. The caller must hold the dictionary
+lock. */
+
+ulint
+row_merge_check_drop_indexes(
+/*=========================*/
+					/* out: DB_SUCCESS or
+					DB_CANNOT_DROP_CONSTRAINT */
+	dict_table_t*	table,		/* in: table */
+	dict_index_t**	indexes,	/* in: secondary indexes */
+	ulint		n_indexes);	/* in: number of indexes */
+/*************************************************************************
+Drops a secondary index: deletes its definition from the data dictionary,
+which frees the index tree, and removes it from the dictionary cache. The
+caller must hold the dictionary lock and an X-lock on the table, and
+commit the transaction. */
+
+ulint
+row_merge_drop_index(
+/*=================*/
+					/* out: DB_SUCCESS or error code */
+	trx_t*		trx,		/* in: dictionary transaction */
+	dict_table_t*	table,		/* in: table */
+	dict_index_t*	index);		/* in, own: secondary index */
+/*************************************************************************
+Checks if a consistent read of a transaction can use an index. An index
+built by row_merge_build_index() only contains the latest versions of the
+rows, which a read view created before the index is not allowed to see. */
+
+ibool
+row_merge_is_index_usable(
+/*======================*/
+					/* out: TRUE if the index can be
+					used */
+	trx_t*		trx,		/* in: transaction */
+	dict_index_t*	index);		/* in: index */
+
+#endif
@@ -32,6 +32,14 @@ row_mysql_prebuilt_free_blob_heap(
 	row_prebuilt_t*	prebuilt);	/* in: prebuilt struct of a
 					ha_innobase:: table handle */
 /***********************************************************************
+Frees the fetch cache in prebuilt. Any rows still cached are discarded. */
+
+void
+row_mysql_prebuilt_free_fetch_cache(
+/*================================*/
+	row_prebuilt_t*	prebuilt);	/* in: prebuilt struct of a
+					ha_innobase:: table handle */
+/***********************************************************************
 Stores a >= 5.0.3 format true VARCHAR length to dest, in the MySQL row
 format. */
 
@@ -330,6 +338,23 @@ row_create_table_for_mysql(
 	dict_table_t*	table,		/* in: table definition */
 	trx_t*		trx);		/* in: transaction handle */
 /*************************************************************************
+Checks the columns of an index definition before the index is created. */
+
+ulint
+row_check_index_for_mysql(
+/*======================*/
+					/* out: DB_SUCCESS,
+					DB_COL_APPEARS_TWICE_IN_INDEX or
+					DB_TOO_BIG_RECORD */
+	dict_index_t*	index,		/* in: index definition */
+	trx_t*		trx,		/* in: transaction handle */
+	const ulint*	field_lengths); /* in: if not NULL, must contain
+					dict_index_get_n_fields(index)
+					actual field lengths for the
+					index columns, which are
+					then checked for not being too
+					large. */
+/*************************************************************************
 Does an index creation operation for MySQL. TODO: currently failure
 to create an index results in dropping the whole table! This is no problem
 currently as all indexes must be created at the same time as the table. */
@@ -504,9 +529,16 @@ struct mysql_row_templ_struct {
 					it is an unsigned integer type */
 };
 
+/* Number of rows in the first batch that we cache in fetch_cache after
+positioning a cursor; each following batch of the same scan is twice as
+big as the previous one */
 #define MYSQL_FETCH_CACHE_SIZE		8
 /* After fetching this many rows, we start caching them in fetch_cache */
 #define MYSQL_FETCH_CACHE_THRESHOLD	4
+/* Upper limit for the number of rows in one batch of fetch_cache */
+#define MYSQL_FETCH_CACHE_MAX_SIZE	4096
+/* Memory budget in bytes for fetch_cache if MySQL has not given one */
+#define MYSQL_FETCH_CACHE_BUDGET	131072
 
 #define ROW_PREBUILT_ALLOCATED	78540783
 #define ROW_PREBUILT_FREED	26423527
@@ -622,16 +654,36 @@ struct row_prebuilt_struct {
 	ulint		n_rows_fetched;	/* number of rows fetched after
 					positioning the current cursor */
 	ulint		fetch_direction;/* ROW_SEL_NEXT or ROW_SEL_PREV */
-	byte*		fetch_cache[MYSQL_FETCH_CACHE_SIZE];
-					/* a cache for fetched rows if we
+	byte**		fetch_cache;	/* a cache for fetched rows if we
 					fetch many rows from the same cursor:
 					it saves CPU time to fetch them in a
-					batch; we reserve mysql_row_len
-					bytes for each such row; these
-					pointers point 4 bytes past the
-					allocated mem buf start, because
-					there is a 4 byte magic number at the
-					start and at the end */
+					batch; this is an array of
+					fetch_cache_size pointers, allocated
+					in the same memory block as the rows;
+					we reserve mysql_row_len bytes for
+					each such row; these pointers point
+					4 bytes past the start of the row
+					slot, because there is a 4 byte
+					magic number at the start and at the
+					end of each row; NULL if not
+					allocated yet */
+	ulint		fetch_cache_size;/* number of rows allocated in
+					fetch_cache */
+	ulint		fetch_batch;	/* number of rows we try to cache
+					in the current batch of fetch_cache;
+					0 if no batch has been fetched after
+					positioning the cursor */
+	ulint		fetch_cache_budget;/* memory budget in bytes for
+					fetch_cache, or 0 if not given by
+					MySQL */
+	ibool		fetch_bulk;	/* TRUE if MySQL is going to read
+					the whole result set of a scan:
+					then we start caching rows at the
+					first fetch after positioning the
+					cursor, and a scan from either end
+					of the index starts with the largest
+					batch that fits in
+					fetch_cache_budget */
 	ibool		keep_other_fields_on_keyread; /* when using fetch 
 					cache with HA_EXTRA_KEYREAD, don't 
 					overwrite other fields in mysql row 
@@ -83,10 +83,13 @@ extern byte	srv_latin1_ordering[256];/* The sort order table of the latin1
 					character set */
 extern ulint	srv_pool_size;
 extern ulint	srv_awe_window_size;
+extern ulint	srv_buf_pool_instances;
 extern ulint	srv_mem_pool_size;
 extern ulint	srv_lock_table_size;
 
 extern ulint	srv_n_file_io_threads;
+extern ibool	srv_use_native_aio;
+extern ulint	srv_aio_queue_depth;
 
 #ifdef UNIV_LOG_ARCHIVE
 extern ibool	srv_log_archive_on;
@@ -128,9 +131,13 @@ extern ibool    srv_set_thread_priorities;
 extern int      srv_query_thread_priority;
 
 extern ulong	srv_max_buf_pool_modified_pct;
+extern ibool	srv_adaptive_flushing;
+extern ulong	srv_io_capacity;
 extern ulong	srv_max_purge_lag;
+extern ulint	srv_n_purge_threads;
 extern ibool	srv_use_awe;
 extern ibool	srv_use_adaptive_hash_indexes;
+extern ulint	srv_adaptive_hash_index_partitions;
 /*-------------------------------------------*/
 
 extern ulint	srv_n_rows_inserted;
@@ -188,8 +195,8 @@ extern ulint	srv_activity_count;
 extern ulint	srv_fatal_semaphore_wait_threshold;
 extern ulint	srv_dml_needed_delay;
 
-extern mutex_t*	kernel_mutex_temp;/* mutex protecting the server, trx structs,
-				query threads, and lock table: we allocate
+extern mutex_t*	kernel_mutex_temp;/* mutex protecting the lock table, trx
+				structs and query threads: we allocate
 				it from dynamic memory to get it to the
 				same DRAM page as other hotspot semaphores */
 #define kernel_mutex (*kernel_mutex_temp)
@@ -350,7 +357,7 @@ srv_set_io_thread_op_info(
 				state */
 /*************************************************************************
 Releases threads of the type given from suspension in the thread table.
-NOTE! The server mutex has to be reserved by the caller! */
+NOTE! The server mutex srv_sys->mutex has to be reserved by the caller! */
 
 ulint
 srv_release_threads(
@@ -390,6 +397,42 @@ void
 srv_wake_master_thread(void);
 /*========================*/
 /*************************************************************************
+The purge coordinator thread. It runs the purge batches which the master
+thread runs when srv_n_purge_threads is 0, and hands out a query thread of
+each batch to every purge worker thread. */
+
+#ifndef __WIN__
+void*
+#else
+ulint
+#endif
+srv_purge_thread(
+/*=============*/
+			/* out: a dummy parameter */
+	void*	arg);	/* in: a dummy parameter required by
+			os_thread_create */
+/*************************************************************************
+A purge worker thread. It runs the query threads which the purge coordinator
+puts to the server task queue. */
+
+#ifndef __WIN__
+void*
+#else
+ulint
+#endif
+srv_purge_worker_thread(
+/*====================*/
+			/* out: a dummy parameter */
+	void*	arg);	/* in: a dummy parameter required by
+			os_thread_create */
+/***********************************************************************
+Wakes up the purge coordinator thread if it is suspended, and at shutdown
+also the purge worker threads so that they exit. */
+
+void
+srv_wake_purge_thread(void);
+/*=======================*/
+/*************************************************************************
 Puts an OS thread to wait if there are too many concurrent threads
 (>= srv_thread_concurrency) inside InnoDB. The threads wait in a FIFO queue. */
 
@@ -507,9 +550,14 @@ cleaning versions from the buffer pool. */
 				not currently in use */
 #define SRV_INSERT	6	/* thread flushing the insert buffer to disk,
 				not currently in use */
-#define SRV_MASTER	7      	/* the master thread, (whose type number must
+#define SRV_PURGE	7	/* the purge coordinator thread */
+#define SRV_MASTER	8      	/* the master thread, (whose type number must
 				be biggest) */
 
+/* Maximum number of purge threads; a purge batch has one query thread for
+each, and the purge array of trx0purge.c must have a cell for each */
+#define SRV_MAX_N_PURGE_THREADS	UNIV_MAX_PARALLELISM
+
 /* Thread slot in the thread table */
 typedef struct srv_slot_struct	srv_slot_t;
 
@@ -541,6 +589,7 @@ struct export_var_struct{
         ulint innodb_buffer_pool_read_ahead_rnd;
         ulint innodb_dblwr_pages_written;
         ulint innodb_dblwr_writes;
+        ulint innodb_history_list_length;
         ulint innodb_log_waits;
         ulint innodb_log_write_requests;
         ulint innodb_log_writes;
@@ -552,6 +601,7 @@ struct export_var_struct{
         ulint innodb_pages_created;
         ulint innodb_pages_read;
         ulint innodb_pages_written;
+        ulint innodb_purge_undo_records;
         ulint innodb_row_lock_waits;
         ulint innodb_row_lock_current_waits;
         ib_longlong innodb_row_lock_time;
@@ -565,6 +615,9 @@ struct export_var_struct{
 
 /* The server system struct */
 struct srv_sys_struct{
+	mutex_t		mutex;		/* mutex protecting the server thread
+					table and the thread counts; the
+					kernel mutex protects the rest */
 	os_event_t	operational;	/* created threads must wait for the
 					server to become operational by
 					waiting for this event */
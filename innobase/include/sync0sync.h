@@ -429,6 +429,8 @@ or row lock! */
 #define	SYNC_KERNEL		300
 #define SYNC_REC_LOCK		299
 #define	SYNC_TRX_LOCK_HEAP	298
+#define	SYNC_TRX_SYS		297
+#define	SYNC_SRV_SYS		296
 #define SYNC_TRX_SYS_HEADER	290
 #define SYNC_LOG		170
 #define SYNC_RECV		168
@@ -119,9 +119,13 @@ struct trx_purge_struct{
 					obtaining an s-latch here. */
 	read_view_t*	view;		/* The purge will not remove undo logs
 					which are >= this view (purge view) */
+	os_event_t	event;		/* Set when the last query thread of
+					a purge batch has completed */
 	mutex_t		mutex;		/* Mutex protecting the fields below */
 	ulint		n_pages_handled;/* Approximate number of undo log
 					pages processed in purge */
+	ulint		n_recs_handled;	/* Number of undo log records handed
+					to the purge query threads */
 	ulint		handle_limit;	/* Target of how many pages to get
 					processed in the current purge */
 	/*------------------------------*/
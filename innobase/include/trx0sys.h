@@ -257,6 +257,33 @@ trx_in_trx_list(
 /*============*/
 			/* out: TRUE if is in */
 	trx_t*	in_trx);/* in: trx */
+/********************************************************************
+Looks for a trx id in trx_sys->active_ids. */
+
+ulint
+trx_sys_find_active_id(
+/*===================*/
+			/* out: position of the id in the array, or
+			ULINT_UNDEFINED if the transaction is not active */
+	dulint	trx_id);/* in: trx id */
+/********************************************************************
+Adds the id of a transaction which becomes active to
+trx_sys->active_ids. The caller must own both the kernel mutex and
+trx_sys->mutex. */
+
+void
+trx_sys_add_active_id(
+/*==================*/
+	dulint	trx_id);/* in: trx id */
+/********************************************************************
+Removes the id of a transaction which stops being active from
+trx_sys->active_ids. The caller must own both the kernel mutex and
+trx_sys->mutex. */
+
+void
+trx_sys_remove_active_id(
+/*=====================*/
+	dulint	trx_id);/* in: trx id */
 /*********************************************************************
 Updates the offset information about the end of the MySQL binlog entry
 which corresponds to the transaction just being committed. In a MySQL
@@ -392,15 +419,46 @@ this contains the same fields as TRX_SYS_MYSQL_LOG_INFO below */
 
 #define TRX_SYS_DOUBLEWRITE_BLOCK_SIZE	FSP_EXTENT_SIZE	
 
+/* Maximum number of regions the two doublewrite blocks are divided into;
+each flush batch writes its pages through a region of its own, so that the
+LRU and flush list batches of the buffer pool instances can fill and write
+the doublewrite buffer at the same time */
+#define TRX_SYS_DOUBLEWRITE_MAX_REGIONS	4
+
+/* A region of the doublewrite buffer */
+struct trx_doublewrite_region_struct{
+	mutex_t	mutex;		/* mutex protecting the first_free field,
+				write_buf and must_flush */
+	ulint	page_no;	/* page number of the first page of the
+				region in the system tablespace */
+	ulint	size;		/* number of pages in the region */
+	ulint	first_free;	/* first free position in write_buf measured
+				in units of UNIV_PAGE_SIZE */
+	byte*	write_buf;	/* the part of trx_doublewrite->write_buf
+				used by this region */
+	buf_block_t**
+		buf_block_arr;	/* array to store pointers to the buffer
+				blocks which have been cached to write_buf */
+	ibool	must_flush;	/* TRUE if data file writes have been
+				posted from the region after the data files
+				were last flushed: the region must not be
+				overwritten on disk before they have been
+				flushed */
+	mutex_t	pending_mutex;	/* mutex protecting n_pending; the
+				completion of a write cannot reserve the
+				region mutex, because a thread posting
+				writes may hold it while waiting for a free
+				aio slot */
+	ulint	n_pending;	/* number of data file writes posted from
+				the region which have not completed yet */
+	os_event_t no_pending;	/* set when n_pending is zero */
+};
+
 /* Doublewrite control struct */
 struct trx_doublewrite_struct{
-	mutex_t	mutex;		/* mutex protecting the first_free field and
-				write_buf */
 	ulint	block1;		/* the page number of the first
 				doublewrite block (64 pages) */
 	ulint	block2;		/* page number of the second block */
-	ulint	first_free;	/* first free position in write_buf measured
-				in units of UNIV_PAGE_SIZE */
 	byte*	write_buf; 	/* write buffer used in writing to the
 				doublewrite buffer, aligned to an
 				address divisible by UNIV_PAGE_SIZE
@@ -409,11 +467,24 @@ struct trx_doublewrite_struct{
 	buf_block_t**
 		buf_block_arr;	/* array to store pointers to the buffer
 				blocks which have been cached to write_buf */
+	ulint	n_regions;	/* number of regions in use */
+	trx_doublewrite_region_t
+		regions[TRX_SYS_DOUBLEWRITE_MAX_REGIONS];
+				/* the regions of the doublewrite buffer;
+				each lies within one of the two blocks */
 };
 
 /* The transaction system central memory data structure; protected by the
-kernel mutex */
+kernel mutex, except the fields that its own mutex protects */
 struct trx_sys_struct{
+	mutex_t		mutex;		/* mutex protecting max_trx_id,
+					latest_rseg, serial_list and
+					view_list; trx_list, active_ids and
+					the state of the transactions in
+					trx_list are changed under both this
+					mutex and the kernel mutex, so that
+					they can be read under either of
+					them */
 	dulint		max_trx_id;	/* The smallest number not yet
 					assigned as a transaction id or
 					transaction number */
@@ -421,6 +492,19 @@ struct trx_sys_struct{
 					/* List of active and committed in
 					memory transactions, sorted on trx id,
 					biggest first */
+	dulint*		active_ids;	/* Ids of the active and prepared
+					transactions in trx_list, sorted
+					ascending: a read view is created by
+					copying this array, without walking
+					trx_list */
+	ulint		n_active_ids;	/* number of ids in active_ids */
+	ulint		active_ids_size;/* number of ids active_ids has
+					space for */
+	UT_LIST_BASE_NODE_T(trx_t) serial_list;
+					/* Transactions which have been
+					assigned a trx number but are not yet
+					committed in memory, sorted on trx no,
+					smallest first */
 	UT_LIST_BASE_NODE_T(trx_t) mysql_trx_list;
 					/* List of transactions created
 					for MySQL */
@@ -446,6 +530,10 @@ two) is assigned, the field TRX_SYS_TRX_ID_STORE on the transaction system
 page is updated */
 #define TRX_SYS_TRX_ID_WRITE_MARGIN	256
 
+/* Initial size of trx_sys->active_ids; the array is doubled when it
+becomes full */
+#define TRX_SYS_ACTIVE_IDS_INIT_SIZE	256
+
 #ifndef UNIV_NONINL
 #include "trx0sys.ic"
 #endif
@@ -438,6 +438,13 @@ struct trx_struct{
 	dulint		no;		/* transaction serialization number ==
 					max trx id when the transaction is 
 					moved to COMMITTED_IN_MEMORY state */
+	ibool		read_only;	/* TRUE if MySQL has told that this
+					is an autocommit consistent read
+					SELECT: such a transaction is not put
+					to trx_list, is not assigned an id
+					of its own, and its trx->id is only
+					the value of trx_sys->max_trx_id when
+					it was started */
 	ibool		flush_log_later;/* when we commit the transaction
 					in MySQL's binlog write, we will
 					flush the log to disk later in
@@ -518,6 +525,9 @@ struct trx_struct{
         ibool           has_search_latch;
 			                /* TRUE if this trx has latched the
 			                search system latch in S-mode */
+	rw_lock_t*	search_latch;	/* if has_search_latch is TRUE, the
+					latch of the adaptive hash index
+					partition this trx has S-latched */
 	ulint		search_latch_timeout;
 					/* If we notice that someone is
 					waiting for our S-lock on the search
@@ -560,6 +570,10 @@ struct trx_struct{
 	UT_LIST_NODE_T(trx_t)
 			mysql_trx_list;	/* list of transactions created for
 					MySQL */
+	UT_LIST_NODE_T(trx_t)
+			serial_list;	/* list of transactions which have
+					been assigned a trx number but are
+					not yet committed in memory */
 	/*------------------------------*/
 	ulint		error_state;	/* 0 if no error, otherwise error
 					number; NOTE That ONLY the thread
@@ -459,17 +459,13 @@ lock_check_trx_id_sanity(
 	dulint		trx_id,		/* in: trx id */
 	rec_t*		rec,		/* in: user record */
 	dict_index_t*	index,		/* in: index */
-	const ulint*	offsets,	/* in: rec_get_offsets(rec, index) */
-	ibool		has_kernel_mutex)/* in: TRUE if the caller owns the
-					kernel mutex */
+	const ulint*	offsets)	/* in: rec_get_offsets(rec, index) */
 {
 	ibool	is_ok		= TRUE;
 	
 	ut_ad(rec_offs_validate(rec, index, offsets));
 
-	if (!has_kernel_mutex) {
-		mutex_enter(&kernel_mutex);
-	}
+	mutex_enter(&(trx_sys->mutex));
 
 	/* A sanity check: the trx_id in rec must be smaller than the global
 	trx id counter */
@@ -492,10 +488,8 @@ lock_check_trx_id_sanity(
 
 		is_ok = FALSE;
 	}
-	
-	if (!has_kernel_mutex) {
-		mutex_exit(&kernel_mutex);
-	}
+
+	mutex_exit(&(trx_sys->mutex));
 
 	return(is_ok);
 }
@@ -1685,7 +1679,7 @@ lock_sec_rec_some_has_impl_off_kernel(
 	implicit x-lock. We have to look in the clustered index. */
 			
 	if (!lock_check_trx_id_sanity(page_get_max_trx_id(page),
-				rec, index, offsets, TRUE)) {
+				rec, index, offsets)) {
 		buf_page_print(page);
 		
 		/* The page is corrupt: try to avoid a crash by returning
@@ -3915,9 +3909,13 @@ lock_release_off_kernel(
 				for all currently active transactions. */
 
 				table = lock->un_member.tab_lock.table;
+
+				mutex_enter(&(trx_sys->mutex));
 			
 				table->query_cache_inv_trx_id =
 							trx_sys->max_trx_id;
+
+				mutex_exit(&(trx_sys->mutex));
 			}
 
 			lock_table_dequeue(lock);
@@ -4292,12 +4290,13 @@ lock_print_info_all_transactions(
 
 	fprintf(file, "LIST OF TRANSACTIONS FOR EACH SESSION:\n");
 
-	/* First print info on non-active transactions */
+	/* First print info on non-active transactions, and on read-only
+	transactions, which are not in the trx list */
 
 	trx = UT_LIST_GET_FIRST(trx_sys->mysql_trx_list);
 
 	while (trx) {
-		if (trx->conc_state == TRX_NOT_STARTED) {
+		if (trx->conc_state == TRX_NOT_STARTED || trx->read_only) {
 			fputs("---", file);
 			trx_print(file, trx, 600);
 		}
@@ -4332,6 +4331,10 @@ loop:
 	if (nth_lock == 0) {
 		fputs("---", file);
 		trx_print(file, trx, 600);
+
+		/* Read views are closed under the trx sys mutex only */
+
+		mutex_enter(&(trx_sys->mutex));
 		
 	        if (trx->read_view) {
 			fprintf(file,
@@ -4342,6 +4345,8 @@ loop:
        		      (ulong) ut_dulint_get_low(trx->read_view->up_limit_id));
 	        }
 
+		mutex_exit(&(trx_sys->mutex));
+
 		if (trx->que_state == TRX_QUE_LOCK_WAIT) {
 			fprintf(file,
  "------- TRX HAS BEEN WAITING %lu SEC FOR THIS LOCK TO BE GRANTED:\n",
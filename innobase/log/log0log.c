@@ -1894,6 +1894,31 @@ log_groups_write_checkpoint_info(void)
 	}
 }
 
+/**********************************************************
+Checks if the checkpoint age has grown so big that a background thread
+should make a new checkpoint, so that user threads do not have to make
+one at the log margins. */
+
+ibool
+log_checkpoint_is_due(void)
+/*=======================*/
+			/* out: TRUE if a checkpoint should be made */
+{
+	ulint	checkpoint_age;
+	ibool	due;
+
+	mutex_enter(&(log_sys->mutex));
+
+	checkpoint_age = ut_dulint_minus(log_sys->lsn,
+					 log_sys->last_checkpoint_lsn);
+
+	due = checkpoint_age > log_sys->max_checkpoint_age_async / 2;
+
+	mutex_exit(&(log_sys->mutex));
+
+	return(due);
+}
+
 /**********************************************************
 Makes a checkpoint. Note that this function does not flush dirty
 blocks from the buffer pool: it only checks what is lsn of the oldest
@@ -3101,9 +3126,11 @@ loop:
        }
 
 
-	/* Check that the master thread is suspended */
+	/* Check that the master thread and the purge thread are
+	suspended */
 
-	if (srv_n_threads_active[SRV_MASTER] != 0) {
+	if (srv_n_threads_active[SRV_MASTER] != 0
+	    || srv_n_threads_active[SRV_PURGE] != 0) {
 
 		mutex_exit(&kernel_mutex);
 
@@ -3201,6 +3228,7 @@ loop:
 
 	/* Make some checks that the server really is quiet */
 	ut_a(srv_n_threads_active[SRV_MASTER] == 0);
+	ut_a(srv_n_threads_active[SRV_PURGE] == 0);
        ut_a(buf_all_freed());
 	ut_a(0 == ut_dulint_cmp(lsn, log_sys->lsn));
 
@@ -1693,11 +1693,11 @@ recv_compare_replicate(
 
 	mtr_start(&mtr);
 
-	mutex_enter(&(buf_pool->mutex));
+	mutex_enter(&(buf_pool_inst_get(space, page_no)->mutex));
 
 	page = buf_page_hash_get(space, page_no)->frame;
 
-	mutex_exit(&(buf_pool->mutex));
+	mutex_exit(&(buf_pool_inst_get(space, page_no)->mutex));
 
 	replica = buf_page_get(space + RECV_REPLICA_SPACE_ADD, page_no,
 							RW_X_LATCH, &mtr);
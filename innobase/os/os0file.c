@@ -30,6 +30,14 @@ Created 10/21/1995 Heikki Tuuri
 
 #endif
 
+#ifdef LINUX_NATIVE_AIO
+#include <linux/aio_abi.h>
+
+/* An i/o-handler thread waits at most this many microseconds in
+io_getevents() before it checks if the server is shutting down */
+#define OS_AIO_LINUX_REAP_TIMEOUT	500000
+#endif
+
 /* This specifies the file permissions InnoDB uses when it creates files in
 Unix; the value of os_innodb_umask is initialized in ha_innodb.cc to
 my_umask */
@@ -82,11 +90,13 @@ struct os_aio_slot_struct{
 	ulint		offset_high;	/* 32 high bits of file offset */
 	os_file_t	file;		/* file where to read or write */
 	const char*	name;		/* file name or path */
-	ibool		io_already_done;/* used only in simulated aio:
-					TRUE if the physical i/o already
-					made and only the slot message
-					needs to be passed to the caller
-					of os_aio_simulated_handle */
+	ibool		io_already_done;/* used only in simulated aio and
+					Linux native aio: TRUE if the
+					physical i/o already made and only
+					the slot message needs to be passed
+					to the caller of
+					os_aio_simulated_handle or
+					os_aio_linux_handle */
 	fil_node_t*	message1;	/* message which is given by the */
 	void*		message2;	/* the requester of an aio operation
 					and which can be used to identify
@@ -97,6 +107,12 @@ struct os_aio_slot_struct{
 					OVERLAPPED struct */
 	OVERLAPPED	control;	/* Windows control block for the
 					aio request */
+#elif defined(LINUX_NATIVE_AIO)
+	struct iocb	control;	/* Linux control block for aio
+					request */
+	long		n_bytes;	/* number of bytes transferred, or
+					a negative error number, as
+					reported by io_getevents() */
 #elif defined(POSIX_ASYNC_IO)
 	struct aiocb	control;	/* Posix control block for aio
 					request */
@@ -130,6 +146,15 @@ struct os_aio_array_struct{
 				  in WaitForMultipleObjects; used only in
 				  Windows */
 #endif
+#ifdef LINUX_NATIVE_AIO
+	aio_context_t*	aio_ctx;  /* Kernel aio contexts, one for each
+				  segment; used only in Linux native aio */
+	struct io_event* aio_events;
+				  /* Array of n_slots events where the
+				  i/o-handler thread of a segment collects
+				  the completed requests of its slots;
+				  used only in Linux native aio */
+#endif
 };
 
 /* Array of events used in simulated aio */
@@ -2777,6 +2802,73 @@ os_aio_array_get_nth_slot(
 	return((array->slots) + index);
 }
 
+#ifdef LINUX_NATIVE_AIO
+/* The Linux kernel aio system calls; glibc does not provide wrappers for
+them */
+
+static
+int
+os_aio_linux_io_setup(unsigned nr_events, aio_context_t* ctx)
+{
+	return(syscall(__NR_io_setup, nr_events, ctx));
+}
+
+static
+int
+os_aio_linux_io_destroy(aio_context_t ctx)
+{
+	return(syscall(__NR_io_destroy, ctx));
+}
+
+static
+int
+os_aio_linux_io_submit(aio_context_t ctx, long nr, struct iocb** iocbpp)
+{
+	return(syscall(__NR_io_submit, ctx, nr, iocbpp));
+}
+
+static
+int
+os_aio_linux_io_getevents(aio_context_t ctx, long min_nr, long nr,
+			struct io_event* events, struct timespec* timeout)
+{
+	return(syscall(__NR_io_getevents, ctx, min_nr, nr, events, timeout));
+}
+
+/**************************************************************************
+Checks if the Linux kernel aio system calls work. */
+
+ibool
+os_aio_linux_is_supported(
+/*======================*/
+				/* out: TRUE if Linux native aio can be
+				used */
+	ulint	n)		/* in: number of aio requests that must be
+				able to be pending at the same time */
+{
+	aio_context_t	ctx	= 0;
+
+	if (os_aio_linux_io_setup((unsigned) n, &ctx) != 0) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+"  InnoDB: Warning: Linux native aio is not available, io_setup() failed\n"
+"InnoDB: with errno %lu. Using simulated aio instead.\n", (ulong) errno);
+
+		if (errno == EAGAIN) {
+			fprintf(stderr,
+"InnoDB: You can raise the limit on pending aio requests in\n"
+"InnoDB: /proc/sys/fs/aio-max-nr or decrease innodb_aio_queue_depth.\n");
+		}
+
+		return(FALSE);
+	}
+
+	os_aio_linux_io_destroy(ctx);
+
+	return(TRUE);
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /****************************************************************************
 Creates an aio wait array. */
 static
@@ -2827,7 +2919,35 @@ os_aio_array_create(
 		*((array->native_events) + i) = over->hEvent;
 #endif
 	}
-	
+
+#ifdef LINUX_NATIVE_AIO
+	array->aio_ctx = NULL;
+	array->aio_events = NULL;
+
+	if (os_aio_use_native_aio) {
+		/* Every segment has its own kernel context, so that its
+		i/o-handler thread reaps only the completions of its own
+		slots */
+
+		array->aio_ctx = ut_malloc(n_segments * sizeof(aio_context_t));
+		array->aio_events = ut_malloc(n * sizeof(struct io_event));
+
+		for (i = 0; i < n_segments; i++) {
+			array->aio_ctx[i] = 0;
+
+			if (os_aio_linux_io_setup((unsigned) (n / n_segments),
+						  array->aio_ctx + i) != 0) {
+				fprintf(stderr,
+"InnoDB: Error: io_setup() for %lu aio requests failed with errno %lu.\n"
+"InnoDB: Start mysqld with --skip-innodb-use-native-aio or\n"
+"InnoDB: a smaller innodb_aio_queue_depth.\n",
+					(ulong) (n / n_segments),
+					(ulong) errno);
+				ut_error;
+			}
+		}
+	}
+#endif
 	return(array);
 }
 
@@ -3354,6 +3474,62 @@ os_aio_simulated_put_read_threads_to_sleep(void)
 	}
 }
 
+#ifdef LINUX_NATIVE_AIO
+/***********************************************************************
+Submits an aio request reserved in a slot to the kernel aio context of
+the segment of the slot. */
+static
+int
+os_aio_linux_dispatch(
+/*==================*/
+				/* out: 0 if the request was queued, else
+				nonzero and errno is set */
+	os_aio_array_t*	array,	/* in: aio array */
+	os_aio_slot_t*	slot)	/* in: reserved slot */
+{
+	struct iocb*	iocb;
+	ulint		segment;
+	int		ret;
+
+	iocb = &(slot->control);
+	memset(iocb, 0, sizeof(struct iocb));
+
+	iocb->aio_data = (ulint) slot;
+	iocb->aio_lio_opcode = slot->type == OS_FILE_READ
+				? IOCB_CMD_PREAD : IOCB_CMD_PWRITE;
+	iocb->aio_fildes = slot->file;
+	iocb->aio_buf = (ulint) slot->buf;
+	iocb->aio_nbytes = slot->len;
+	iocb->aio_offset = (((ib_longlong) slot->offset_high) << 32)
+				+ slot->offset;
+
+	segment = slot->pos / (array->n_slots / array->n_segments);
+
+	for (;;) {
+		ret = os_aio_linux_io_submit(array->aio_ctx[segment], 1,
+					     &iocb);
+		if (ret == 1) {
+
+			return(0);
+		}
+
+		if (ret < 0 && (errno == EAGAIN || errno == EINTR)) {
+			/* The kernel queue is temporarily full */
+
+			os_thread_sleep(1000);
+
+			continue;
+		}
+
+		if (ret >= 0) {
+			errno = EIO;
+		}
+
+		return(-1);
+	}
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /***********************************************************************
 Requests an asynchronous i/o operation. */
 
@@ -3473,6 +3649,11 @@ try_again:
 			
 			ret = ReadFile(file, buf, (DWORD)n, &len,
 							&(slot->control));
+#elif defined(LINUX_NATIVE_AIO)
+			os_n_file_reads++;
+			os_bytes_read_since_printout += n;
+
+			err = (ulint) os_aio_linux_dispatch(array, slot);
 #elif defined(POSIX_ASYNC_IO)
 			slot->control.aio_lio_opcode = LIO_READ;
 			err = (ulint) aio_read(&(slot->control));
@@ -3490,6 +3671,10 @@ try_again:
 			os_n_file_writes++;
 			ret = WriteFile(file, buf, (DWORD)n, &len,
 							&(slot->control));
+#elif defined(LINUX_NATIVE_AIO)
+			os_n_file_writes++;
+
+			err = (ulint) os_aio_linux_dispatch(array, slot);
 #elif defined(POSIX_ASYNC_IO)
 			slot->control.aio_lio_opcode = LIO_WRITE;
 			err = (ulint) aio_write(&(slot->control));
@@ -3653,6 +3838,148 @@ os_aio_windows_handle(
 }
 #endif
 
+#ifdef LINUX_NATIVE_AIO
+/**************************************************************************
+This function is only used in Linux native asynchronous i/o.
+Waits for an aio operation in a segment to complete. The i/o-handler
+thread of the segment reaps the completion events of the kernel context
+of the segment and marks the corresponding slots done. A request which
+failed or transferred less than requested is redone synchronously.
+NOTE: this function will also take care of freeing the aio slot,
+therefore no other thread is allowed to do the freeing! */
+
+ibool
+os_aio_linux_handle(
+/*================*/
+				/* out: TRUE if the aio operation succeeded */
+	ulint	global_segment,	/* in: the number of the segment in the aio
+				arrays to wait for; segment 0 is the ibuf
+				i/o thread, segment 1 the log i/o thread,
+				then follow the non-ibuf read threads, and as
+				the last are the non-ibuf write threads */
+	fil_node_t**message1,	/* out: the messages passed with the aio
+				request; note that also in the case where
+				the aio operation failed, these output
+				parameters are valid and can be used to
+				restart the operation, for example */
+	void**	message2,
+	ulint*	type)		/* out: OS_FILE_WRITE or ..._READ */
+{
+	os_aio_array_t*	array;
+	os_aio_slot_t*	slot;
+	struct io_event* events;
+	struct timespec	timeout;
+	ulint		segment;
+	ulint		n;
+	ulint		i;
+	int		ret;
+	ibool		ret_val;
+
+	segment = os_aio_get_array_and_local_segment(&array, global_segment);
+
+	/* NOTE! We only access constant fields in os_aio_array. Therefore
+	we do not have to acquire the protecting mutex yet */
+
+	ut_ad(os_aio_validate());
+	ut_ad(segment < array->n_segments);
+
+	n = array->n_slots / array->n_segments;
+	events = array->aio_events + segment * n;
+
+	for (;;) {
+		os_mutex_enter(array->mutex);
+
+		for (i = 0; i < n; i++) {
+			slot = os_aio_array_get_nth_slot(array,
+							 i + segment * n);
+			if (slot->reserved && slot->io_already_done) {
+
+				goto found;
+			}
+		}
+
+		os_mutex_exit(array->mutex);
+
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+			os_thread_exit(NULL);
+		}
+
+		srv_set_io_thread_op_info(global_segment,
+					  "waiting for completed aio requests");
+
+		/* Only this thread reaps the events of the context of the
+		segment, so the event array of the segment is ours */
+
+		timeout.tv_sec = 0;
+		timeout.tv_nsec = OS_AIO_LINUX_REAP_TIMEOUT * 1000;
+
+		ret = os_aio_linux_io_getevents(array->aio_ctx[segment], 1,
+						(long) n, events, &timeout);
+		if (ret < 0) {
+			if (errno != EINTR) {
+				ut_print_timestamp(stderr);
+				fprintf(stderr,
+"  InnoDB: Error: io_getevents() returned errno %lu\n", (ulong) errno);
+				os_thread_sleep(100000);
+			}
+
+			continue;
+		}
+
+		os_mutex_enter(array->mutex);
+
+		for (i = 0; i < (ulint) ret; i++) {
+			slot = (os_aio_slot_t*)(ulint) events[i].data;
+
+			ut_a(slot->reserved);
+
+			slot->n_bytes = (long) events[i].res;
+			slot->io_already_done = TRUE;
+		}
+
+		os_mutex_exit(array->mutex);
+	}
+
+found:
+	srv_set_io_thread_op_info(global_segment,
+				  "handling a completed aio request");
+
+	*message1 = slot->message1;
+	*message2 = slot->message2;
+	*type = slot->type;
+
+	os_mutex_exit(array->mutex);
+
+	ret_val = TRUE;
+
+	if (slot->n_bytes != (long) slot->len) {
+		/* The request failed or was only partially done: redo it
+		synchronously, which reports the error if it persists */
+
+		if (slot->type == OS_FILE_READ) {
+			ret_val = os_file_read(slot->file, slot->buf,
+					slot->offset, slot->offset_high,
+					slot->len);
+		} else {
+			ret_val = os_file_write(slot->name, slot->file,
+					slot->buf, slot->offset,
+					slot->offset_high, slot->len);
+		}
+	}
+
+# ifdef UNIV_DO_FLUSH
+	if (slot->type == OS_FILE_WRITE
+				&& !os_do_not_call_flush_at_each_write) {
+		ut_a(TRUE == os_file_flush(slot->file));
+	}
+# endif /* UNIV_DO_FLUSH */
+
+	os_aio_array_free_slot(array, slot);
+
+	return(ret_val);
+}
+#endif /* LINUX_NATIVE_AIO */
+
 #ifdef POSIX_ASYNC_IO
 
 /**************************************************************************
@@ -188,13 +188,16 @@ page_set_max_trx_id(
 	dulint	trx_id)	/* in: transaction id */
 {
 	buf_block_t*	block;
+	rw_lock_t*	search_latch;
 
 	ut_ad(page);
 
 	block = buf_block_align(page);
 
+	search_latch = btr_search_get_latch(btr_page_get_index_id(page));
+
 	if (block->is_hashed) {
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(search_latch);
 	}
 
 	/* It is not necessary to write this change to the redo log, as
@@ -204,7 +207,7 @@ page_set_max_trx_id(
 	mach_write_to_8(page + PAGE_HEADER + PAGE_MAX_TRX_ID, trx_id);
 
 	if (block->is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(search_latch);
 	}
 }
 
@@ -16,6 +16,7 @@ Created 5/27/1996 Heikki Tuuri
 #include "usr0sess.h"
 #include "trx0trx.h"
 #include "trx0roll.h"
+#include "trx0purge.h"
 #include "row0undo.h"
 #include "row0ins.h"
 #include "row0upd.h"
@@ -751,8 +752,12 @@ que_thr_move_to_run_state(
 
 		thr->is_active = TRUE;
 
-		ut_ad((thr->graph)->n_active_thrs == 1);
-		ut_ad(trx->n_active_thrs == 1);
+		/* Only the purge runs several query threads in
+		parallel */
+		ut_ad((thr->graph)->n_active_thrs == 1
+		      || (thr->graph)->fork_type == QUE_FORK_PURGE);
+		ut_ad(trx->n_active_thrs == 1
+		      || (thr->graph)->fork_type == QUE_FORK_PURGE);
 	}
 	
 	thr->state = QUE_THR_RUNNING;
@@ -817,8 +822,10 @@ que_thr_dec_refer_count(
 		}
 	}	
 
-	ut_ad(fork->n_active_thrs == 1);
-	ut_ad(trx->n_active_thrs == 1);
+	ut_ad(fork->n_active_thrs == 1
+	      || fork->fork_type == QUE_FORK_PURGE);
+	ut_ad(trx->n_active_thrs == 1
+	      || fork->fork_type == QUE_FORK_PURGE);
 
 	fork->n_active_thrs--;
 	trx->n_active_thrs--;
@@ -834,6 +841,14 @@ que_thr_dec_refer_count(
 	
 	fork_type = fork->fork_type;
 
+	if (fork_type == QUE_FORK_PURGE) {
+		/* None of the query threads of the purge batch is active
+		any more: wake up the thread running trx_purge(), which
+		waits for them */
+
+		os_event_set(purge_sys->event);
+	}
+
 	/* Check if all query threads in the same fork are completed */
 
 	if (que_fork_all_thrs_in_state(fork, QUE_THR_COMPLETED)) {
@@ -56,7 +56,7 @@ read_view_oldest_copy_or_open_new(
 	ulint		i;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	old_view = UT_LIST_GET_LAST(trx_sys->view_list);
 
@@ -133,10 +133,11 @@ read_view_open_now(
 	read_view_t*	view;
 	trx_t*		trx;
 	ulint		n;
+	ulint		i;
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
-	view = read_view_create_low(UT_LIST_GET_LEN(trx_sys->trx_list), heap);
+	view = read_view_create_low(trx_sys->n_active_ids, heap);
 
 	view->creator = cr_trx;
 
@@ -147,32 +148,35 @@ read_view_open_now(
 
 	view->can_be_too_old = FALSE;
 
-	n = 0;
-	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	/* NOTE that a transaction whose trx number is < trx_sys->max_trx_id
+	can still be active, if it is in the middle of its commit! Such
+	transactions are in serial_list, the first of them having the
+	smallest trx number. */
 
-	/* No active transaction should be visible, except cr_trx */
+	trx = UT_LIST_GET_FIRST(trx_sys->serial_list);
 
-	while (trx) {
-                if (trx != cr_trx && (trx->conc_state == TRX_ACTIVE ||
-                                        trx->conc_state == TRX_PREPARED)) {
+	if (trx != NULL) {
+		view->low_limit_no = trx->no;
+	}
 
-			read_view_set_nth_trx_id(view, n, trx->id);
+	/* No active transaction should be visible, except cr_trx. The view
+	stores the ids in descending order, trx_sys->active_ids is sorted
+	ascending. A read-only cr_trx is not in the array, and its id may be
+	the id of another active transaction. */
 
-			n++;
+	n = 0;
+	i = trx_sys->n_active_ids;
 
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			ut_dulint_max. */
+	while (i > 0) {
+		i--;
 
-			if (ut_dulint_cmp(view->low_limit_no, trx->no) > 0) {
+		if (cr_trx == NULL || cr_trx->read_only
+		    || ut_dulint_cmp(trx_sys->active_ids[i], cr_trx->id)) {
 
-				view->low_limit_no = trx->no;
-			}	
+			read_view_set_nth_trx_id(view, n,
+						trx_sys->active_ids[i]);
+			n++;
 		}
-
-		trx = UT_LIST_GET_NEXT(trx_list, trx);
 	}
 
 	view->n_trx_ids = n;		
@@ -198,7 +202,7 @@ read_view_close(
 	read_view_t*	view)	/* in: read view */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
 } 
@@ -214,7 +218,7 @@ read_view_close_for_mysql(
 {
 	ut_a(trx->global_read_view);
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
 
 	read_view_close(trx->global_read_view);
 
@@ -223,7 +227,7 @@ read_view_close_for_mysql(
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(trx_sys->mutex));
 }
 	
 /*************************************************************************
@@ -271,10 +275,7 @@ read_cursor_view_create_for_mysql(
 	trx_t*	cr_trx)	/* in: trx where cursor view is created */
 {
 	cursor_view_t*	curview;
-	read_view_t*	view;
 	mem_heap_t*	heap;
-	trx_t*		trx;
-	ulint		n;
 
 	ut_a(cr_trx);
 
@@ -291,64 +292,15 @@ read_cursor_view_create_for_mysql(
 	curview->n_mysql_tables_in_use = cr_trx->n_mysql_tables_in_use;
 	cr_trx->n_mysql_tables_in_use = 0;
 
-	mutex_enter(&kernel_mutex);
-
-	curview->read_view = read_view_create_low(
-				UT_LIST_GET_LEN(trx_sys->trx_list), 
-					curview->heap);
-
-	view = curview->read_view;
-	view->creator = cr_trx;
-
-	/* No future transactions should be visible in the view */
-
-  	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
-
-	view->can_be_too_old = FALSE;
-
-	n = 0;
-	trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
+	mutex_enter(&(trx_sys->mutex));
 
 	/* No active transaction should be visible, except cr_trx.
 	This is quick fix for a bug 12456 and needs to be fixed when
 	semi-consistent high-granularity read view is implemented. */
 
-	while (trx) {
-                if (trx != cr_trx && (trx->conc_state == TRX_ACTIVE ||
-					trx->conc_state == TRX_PREPARED)) {
-
-			read_view_set_nth_trx_id(view, n, trx->id);
-
-			n++;
-
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			ut_dulint_max. */
-
-			if (ut_dulint_cmp(view->low_limit_no, trx->no) > 0) {
+	curview->read_view = read_view_open_now(cr_trx, curview->heap);
 
-				view->low_limit_no = trx->no;
-			}	
-		}
-
-		trx = UT_LIST_GET_NEXT(trx_list, trx);
-	}
-
-	view->n_trx_ids = n;		
-
-	if (n > 0) {
-		/* The last active transaction has the smallest id: */
-		view->up_limit_id = read_view_get_nth_trx_id(view, n - 1);
-	} else {
-		view->up_limit_id = view->low_limit_id;
-	}
-
-	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
-	
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(trx_sys->mutex));
 
 	return(curview);
 }
@@ -371,12 +323,12 @@ read_cursor_view_close_for_mysql(
           belong to this transaction */
 	trx->n_mysql_tables_in_use += curview->n_mysql_tables_in_use;
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
 
 	read_view_close(curview->read_view);
 	trx->read_view = trx->global_read_view;
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(trx_sys->mutex));
 
 	mem_heap_free(curview->heap);
 }
@@ -394,7 +346,7 @@ read_cursor_set_for_mysql(
 {
 	ut_a(trx);
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
 
 	if (UNIV_LIKELY(curview != NULL)) {
 		trx->read_view = curview->read_view;
@@ -402,5 +354,5 @@ read_cursor_set_for_mysql(
 		trx->read_view = trx->global_read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(trx_sys->mutex));
 }
@@ -0,0 +1,1169 @@
+/******************************************************
+Creation and removal of secondary indexes of existing tables
+
+(c) 2008 Innobase Oy
+
+Created 10/18/2008
+*******************************************************/
+
+#include "row0merge.h"
+
+#include "dict0dict.h"
+#include "dict0crea.h"
+#include "dict0mem.h"
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "btr0pcur.h"
+#include "page0page.h"
+#include "rem0rec.h"
+#include "rem0cmp.h"
+#include "row0row.h"
+#include "row0mysql.h"
+#include "mach0data.h"
+#include "read0read.h"
+#include "trx0trx.h"
+#include "que0que.h"
+#include "pars0pars.h"
+#include "os0file.h"
+#include "ut0sort.h"
+
+/* Maximum number of sorted runs that wait to be merged. A run is merged
+with the one before it as soon as they are of the same level, so that the
+stack holds at most one run of each level. */
+#define ROW_MERGE_MAX_RUNS	64
+
+/* A buffer of index entries that are sorted in memory */
+typedef struct row_merge_buf_struct	row_merge_buf_t;
+
+struct row_merge_buf_struct{
+	dict_index_t*	index;		/* index of the entries */
+	mem_heap_t*	heap;		/* memory heap where the entries
+					and their data are allocated */
+	ulint		max_size;	/* the buffer is full when the heap
+					has grown to this size */
+	ulint		n_tuples;	/* number of entries */
+	ulint		max_tuples;	/* size of the tuples array */
+	dtuple_t**	tuples;		/* the entries, from mem_alloc() */
+};
+
+/* A sorted run of index entries in a temporary file */
+typedef struct row_merge_run_struct	row_merge_run_t;
+
+struct row_merge_run_struct{
+	FILE*		file;		/* temporary file */
+	ulint		level;		/* number of merges the run is made
+					of */
+};
+
+/* Reads records from a sorted run. Every record is stored in the file
+as its extra size and data size in 4 bytes each, followed by the
+record. */
+typedef struct row_merge_reader_struct	row_merge_reader_t;
+
+struct row_merge_reader_struct{
+	FILE*		file;		/* temporary file */
+	dict_index_t*	index;		/* index of the records */
+	byte*		buf;		/* buffer of the current record,
+					from mem_alloc() */
+	ulint		buf_size;	/* size of buf */
+	ulint		size;		/* size of the current record */
+	rec_t*		rec;		/* current record, or NULL at the end
+					of the run */
+	ulint*		offsets;	/* rec_get_offsets(rec, index) */
+	mem_heap_t*	heap;		/* memory heap for offsets */
+};
+
+/*************************************************************************
+Creates a sort buffer. */
+static
+row_merge_buf_t*
+row_merge_buf_create(
+/*=================*/
+					/* out, own: sort buffer */
+	dict_index_t*	index,		/* in: index of the entries */
+	ulint		max_size)	/* in: size of the buffer */
+{
+	row_merge_buf_t*	buf;
+
+	buf = mem_alloc(sizeof(row_merge_buf_t));
+
+	buf->index = index;
+	buf->heap = mem_heap_create(1024);
+	buf->max_size = max_size;
+	buf->n_tuples = 0;
+	buf->max_tuples = 256;
+	buf->tuples = mem_alloc(buf->max_tuples * sizeof(dtuple_t*));
+
+	return(buf);
+}
+
+/*************************************************************************
+Frees a sort buffer. */
+static
+void
+row_merge_buf_free(
+/*===============*/
+	row_merge_buf_t*	buf)	/* in, own: sort buffer */
+{
+	mem_heap_free(buf->heap);
+	mem_free(buf->tuples);
+	mem_free(buf);
+}
+
+/*************************************************************************
+Empties a sort buffer. */
+static
+void
+row_merge_buf_empty(
+/*================*/
+	row_merge_buf_t*	buf)	/* in: sort buffer */
+{
+	mem_heap_empty(buf->heap);
+	buf->n_tuples = 0;
+}
+
+/*************************************************************************
+Checks if a sort buffer is full. */
+UNIV_INLINE
+ibool
+row_merge_buf_is_full(
+/*==================*/
+					/* out: TRUE if full */
+	row_merge_buf_t*	buf)	/* in: sort buffer */
+{
+	return(mem_heap_get_size(buf->heap) >= buf->max_size);
+}
+
+/*************************************************************************
+Builds the index entry of a row and copies it to a sort buffer. */
+static
+void
+row_merge_buf_add(
+/*==============*/
+	row_merge_buf_t*	buf,	/* in: sort buffer */
+	dtuple_t*		row)	/* in: row whose fields may point to
+					a buffer page */
+{
+	dtuple_t*	entry;
+	dfield_t*	field;
+	ulint		len;
+	byte*		data;
+	ulint		i;
+
+	if (buf->n_tuples == buf->max_tuples) {
+		dtuple_t**	tuples;
+
+		tuples = mem_alloc(2 * buf->max_tuples * sizeof(dtuple_t*));
+		ut_memcpy(tuples, buf->tuples,
+					buf->max_tuples * sizeof(dtuple_t*));
+		mem_free(buf->tuples);
+
+		buf->tuples = tuples;
+		buf->max_tuples *= 2;
+	}
+
+	entry = row_build_index_entry(row, buf->index, buf->heap);
+
+	/* The entry points to the clustered index page: copy the data */
+
+	for (i = 0; i < dtuple_get_n_fields(entry); i++) {
+		field = dtuple_get_nth_field(entry, i);
+		len = dfield_get_len(field);
+
+		if (len != UNIV_SQL_NULL && len > 0) {
+			data = mem_heap_alloc(buf->heap, len);
+			ut_memcpy(data, dfield_get_data(field), len);
+			dfield_set_data(field, data, len);
+		}
+	}
+
+	buf->tuples[buf->n_tuples++] = entry;
+}
+
+/*************************************************************************
+Compares two index entries of the same index. */
+static
+int
+row_merge_tuple_cmp(
+/*================*/
+				/* out: 1, 0, -1 if a is greater, equal,
+				less than b */
+	dtuple_t*	a,	/* in: index entry */
+	dtuple_t*	b)	/* in: index entry */
+{
+	ulint	n_fields	= dtuple_get_n_fields(a);
+	ulint	i;
+	int	cmp;
+
+	for (i = 0; i < n_fields; i++) {
+		cmp = cmp_dfield_dfield(dtuple_get_nth_field(a, i),
+					dtuple_get_nth_field(b, i));
+		if (cmp) {
+
+			return(cmp);
+		}
+	}
+
+	return(0);
+}
+
+/*************************************************************************
+Sorts an array of index entries. */
+static
+void
+row_merge_tuple_sort(
+/*=================*/
+	dtuple_t**	tuples,		/* in/out: entries */
+	dtuple_t**	aux,		/* in: work space of the same size */
+	ulint		low,		/* in: lower bound, inclusive */
+	ulint		high)		/* in: upper bound, exclusive */
+{
+	UT_SORT_FUNCTION_BODY(row_merge_tuple_sort, tuples, aux, low, high,
+			      row_merge_tuple_cmp);
+}
+
+/*************************************************************************
+Sorts the entries of a sort buffer. */
+static
+void
+row_merge_buf_sort(
+/*===============*/
+	row_merge_buf_t*	buf)	/* in: sort buffer */
+{
+	dtuple_t**	aux;
+
+	if (buf->n_tuples < 2) {
+
+		return;
+	}
+
+	aux = mem_alloc(buf->n_tuples * sizeof(dtuple_t*));
+
+	row_merge_tuple_sort(buf->tuples, aux, 0, buf->n_tuples);
+
+	mem_free(aux);
+}
+
+/*************************************************************************
+Writes the header of a record to a run. */
+static
+ibool
+row_merge_write_header(
+/*===================*/
+				/* out: TRUE if success */
+	FILE*	file,		/* in: temporary file */
+	ulint	extra_size,	/* in: extra size of the record */
+	ulint	data_size)	/* in: data size of the record */
+{
+	byte	header[8];
+
+	mach_write_to_4(header, extra_size);
+	mach_write_to_4(header + 4, data_size);
+
+	return(fwrite(header, 1, sizeof header, file) == sizeof header);
+}
+
+/*************************************************************************
+Writes the sorted entries of a sort buffer to a new temporary file. */
+static
+FILE*
+row_merge_buf_write(
+/*================*/
+					/* out, own: file positioned at the
+					start, or NULL on error */
+	row_merge_buf_t*	buf)	/* in: sorted buffer */
+{
+	FILE*		file;
+	mem_heap_t*	heap;
+	dtuple_t*	entry;
+	byte*		rec_buf;
+	rec_t*		rec;
+	ulint		size;
+	ulint		i;
+
+	file = os_file_create_tmpfile();
+
+	if (file == NULL) {
+
+		return(NULL);
+	}
+
+	heap = mem_heap_create(UNIV_PAGE_SIZE);
+
+	for (i = 0; i < buf->n_tuples; i++) {
+		entry = buf->tuples[i];
+		size = rec_get_converted_size(buf->index, entry);
+
+		rec_buf = mem_heap_alloc(heap, size);
+		rec = rec_convert_dtuple_to_rec(rec_buf, buf->index, entry);
+
+		if (!row_merge_write_header(file, rec - rec_buf,
+					    size - (rec - rec_buf))
+		    || fwrite(rec_buf, 1, size, file) != size) {
+
+			fclose(file);
+			file = NULL;
+			break;
+		}
+
+		mem_heap_empty(heap);
+	}
+
+	mem_heap_free(heap);
+
+	if (file) {
+		rewind(file);
+	}
+
+	return(file);
+}
+
+/*************************************************************************
+Reads the next record of a run. */
+static
+ibool
+row_merge_read(
+/*===========*/
+					/* out: FALSE on a read error */
+	row_merge_reader_t*	reader)	/* in: reader; reader->rec is set
+					to NULL at the end of the run */
+{
+	byte	header[8];
+	ulint	extra_size;
+
+	reader->rec = NULL;
+
+	if (fread(header, 1, sizeof header, reader->file) != sizeof header) {
+
+		return(!ferror(reader->file));
+	}
+
+	extra_size = mach_read_from_4(header);
+	reader->size = extra_size + mach_read_from_4(header + 4);
+
+	if (reader->size > reader->buf_size) {
+		if (reader->buf) {
+			mem_free(reader->buf);
+		}
+
+		reader->buf_size = ut_max(reader->size, 2 * reader->buf_size);
+		reader->buf = mem_alloc(reader->buf_size);
+	}
+
+	if (fread(reader->buf, 1, reader->size, reader->file)
+	    != reader->size) {
+
+		return(FALSE);
+	}
+
+	reader->rec = reader->buf + extra_size;
+	reader->offsets = rec_get_offsets(reader->rec, reader->index,
+					  reader->offsets, ULINT_UNDEFINED,
+					  &reader->heap);
+	return(TRUE);
+}
+
+/*************************************************************************
+Starts to read a run from the beginning. */
+static
+ibool
+row_merge_reader_open(
+/*==================*/
+					/* out: FALSE on a read error */
+	row_merge_reader_t*	reader,	/* out: reader */
+	FILE*			file,	/* in: run */
+	dict_index_t*		index)	/* in: index of the records */
+{
+	reader->file = file;
+	reader->index = index;
+	reader->buf = NULL;
+	reader->buf_size = 0;
+	reader->offsets = NULL;
+	reader->heap = NULL;
+
+	return(row_merge_read(reader));
+}
+
+/*************************************************************************
+Frees the buffers of a reader and closes its file. */
+static
+void
+row_merge_reader_close(
+/*===================*/
+	row_merge_reader_t*	reader)	/* in, own: reader */
+{
+	fclose(reader->file);
+
+	if (reader->buf) {
+		mem_free(reader->buf);
+	}
+
+	if (reader->heap) {
+		mem_heap_free(reader->heap);
+	}
+}
+
+/*************************************************************************
+Copies the current record of a reader to a run and reads the next one. */
+static
+ibool
+row_merge_copy(
+/*===========*/
+					/* out: FALSE on an I/O error */
+	row_merge_reader_t*	reader,	/* in: reader positioned on a
+					record */
+	FILE*			file)	/* in: run being written */
+{
+	ulint	extra_size	= reader->rec - reader->buf;
+
+	return(row_merge_write_header(file, extra_size,
+				      reader->size - extra_size)
+	       && fwrite(reader->buf, 1, reader->size, file) == reader->size
+	       && row_merge_read(reader));
+}
+
+/*************************************************************************
+Merges two sorted runs into a new one. The input files are closed. */
+static
+FILE*
+row_merge_runs(
+/*===========*/
+				/* out, own: merged run positioned at the
+				start, or NULL on error */
+	dict_index_t*	index,	/* in: index of the records */
+	FILE*		file1,	/* in, own: run */
+	FILE*		file2)	/* in, own: run */
+{
+	row_merge_reader_t	reader1;
+	row_merge_reader_t	reader2;
+	FILE*			file;
+	ibool			success;
+
+	file = os_file_create_tmpfile();
+
+	success = row_merge_reader_open(&reader1, file1, index);
+	success = row_merge_reader_open(&reader2, file2, index) && success;
+
+	if (file == NULL) {
+		success = FALSE;
+	}
+
+	while (success && reader1.rec && reader2.rec) {
+		if (cmp_rec_rec(reader1.rec, reader2.rec, reader1.offsets,
+				reader2.offsets, index) <= 0) {
+			success = row_merge_copy(&reader1, file);
+		} else {
+			success = row_merge_copy(&reader2, file);
+		}
+	}
+
+	while (success && reader1.rec) {
+		success = row_merge_copy(&reader1, file);
+	}
+
+	while (success && reader2.rec) {
+		success = row_merge_copy(&reader2, file);
+	}
+
+	row_merge_reader_close(&reader1);
+	row_merge_reader_close(&reader2);
+
+	if (!success) {
+		if (file) {
+			fclose(file);
+		}
+
+		return(NULL);
+	}
+
+	rewind(file);
+
+	return(file);
+}
+
+/*************************************************************************
+Sorts the entries of a full sort buffer, writes them to a run and merges
+runs of the same level, so that merges stay balanced. Empties the
+buffer. */
+static
+ulint
+row_merge_buf_flush(
+/*================*/
+					/* out: DB_SUCCESS or DB_ERROR */
+	row_merge_buf_t*	buf,	/* in: sort buffer */
+	row_merge_run_t*	runs,	/* in/out: stack of runs */
+	ulint*			n_runs)	/* in/out: number of runs */
+{
+	FILE*	file;
+	ulint	level	= 0;
+
+	row_merge_buf_sort(buf);
+
+	file = row_merge_buf_write(buf);
+
+	row_merge_buf_empty(buf);
+
+	while (file && *n_runs > 0 && runs[*n_runs - 1].level == level) {
+		(*n_runs)--;
+		file = row_merge_runs(buf->index, runs[*n_runs].file, file);
+		level++;
+	}
+
+	if (file == NULL) {
+
+		return(DB_ERROR);
+	}
+
+	ut_a(*n_runs < ROW_MERGE_MAX_RUNS);
+
+	runs[*n_runs].file = file;
+	runs[*n_runs].level = level;
+	(*n_runs)++;
+
+	return(DB_SUCCESS);
+}
+
+/*************************************************************************
+Checks if two adjacent entries of a unique index are duplicates. Entries
+with SQL NULL values are never duplicates. */
+static
+ibool
+row_merge_is_dup(
+/*=============*/
+				/* out: TRUE if duplicates */
+	dict_index_t*	index,	/* in: unique index */
+	dtuple_t*	a,	/* in: index entry */
+	dtuple_t*	b)	/* in: index entry */
+{
+	dfield_t*	field;
+	ulint		n_unique	= dict_index_get_n_unique(index);
+	ulint		i;
+
+	for (i = 0; i < n_unique; i++) {
+		field = dtuple_get_nth_field(a, i);
+
+		if (dfield_get_len(field) == UNIV_SQL_NULL
+		    || cmp_dfield_dfield(field, dtuple_get_nth_field(b, i))) {
+
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+
+/*************************************************************************
+Inserts an entry to a new index. The entries come in ascending order, so
+that the pages are split at the insert point and left full. */
+static
+ulint
+row_merge_insert(
+/*=============*/
+				/* out: DB_SUCCESS, DB_DUPLICATE_KEY or
+				DB_OUT_OF_FILE_SPACE */
+	trx_t*		trx,	/* in: transaction that created the index */
+	dict_index_t*	index,	/* in: new index */
+	dtuple_t*	entry,	/* in: entry to insert */
+	dtuple_t*	prev)	/* in: the previous entry, or NULL */
+{
+	btr_cur_t	cursor;
+	big_rec_t*	big_rec;
+	rec_t*		rec;
+	mtr_t		mtr;
+	ulint		err;
+
+	if (prev && (index->type & DICT_UNIQUE)
+	    && row_merge_is_dup(index, prev, entry)) {
+
+		return(DB_DUPLICATE_KEY);
+	}
+
+	mtr_start(&mtr);
+
+	btr_cur_search_to_nth_level(index, 0, entry, PAGE_CUR_LE,
+				    BTR_MODIFY_LEAF, &cursor, 0, &mtr);
+
+	err = btr_cur_optimistic_insert(BTR_NO_LOCKING_FLAG, &cursor, entry,
+					&rec, &big_rec, NULL, &mtr);
+
+	if (err == DB_FAIL) {
+		mtr_commit(&mtr);
+		mtr_start(&mtr);
+
+		btr_cur_search_to_nth_level(index, 0, entry, PAGE_CUR_LE,
+					    BTR_MODIFY_TREE, &cursor, 0, &mtr);
+
+		err = btr_cur_pessimistic_insert(BTR_NO_LOCKING_FLAG, &cursor,
+						 entry, &rec, &big_rec, NULL,
+						 &mtr);
+	}
+
+	ut_a(err != DB_SUCCESS || big_rec == NULL);
+
+	if (err == DB_SUCCESS) {
+		/* Consistent reads must not trust the entries without
+		checking the clustered index record; see also
+		row_merge_is_index_usable() */
+
+		page_update_max_trx_id(buf_frame_align(rec), trx->id);
+	}
+
+	mtr_commit(&mtr);
+
+	return(err);
+}
+
+/*************************************************************************
+Inserts the sorted entries of a run to a new index. */
+static
+ulint
+row_merge_insert_run(
+/*=================*/
+				/* out: DB_SUCCESS or error code */
+	trx_t*		trx,	/* in: transaction that created the index */
+	dict_index_t*	index,	/* in: new index */
+	FILE*		file)	/* in, own: run */
+{
+	row_merge_reader_t	reader;
+	mem_heap_t*		heap;
+	mem_heap_t*		prev_heap;
+	mem_heap_t*		tmp;
+	dtuple_t*		entry;
+	dtuple_t*		prev	= NULL;
+	ulint			err	= DB_SUCCESS;
+
+	heap = mem_heap_create(1024);
+	prev_heap = mem_heap_create(1024);
+
+	if (!row_merge_reader_open(&reader, file, index)) {
+		err = DB_ERROR;
+	}
+
+	while (err == DB_SUCCESS && reader.rec) {
+		entry = row_rec_to_index_entry(ROW_COPY_DATA, index,
+					       reader.rec, heap);
+
+		err = row_merge_insert(trx, index, entry, prev);
+
+		if (err == DB_SUCCESS && !row_merge_read(&reader)) {
+			err = DB_ERROR;
+		}
+
+		/* Keep the entry for the duplicate check of the next one */
+
+		prev = entry;
+		tmp = prev_heap;
+		prev_heap = heap;
+		heap = tmp;
+		mem_heap_empty(heap);
+	}
+
+	row_merge_reader_close(&reader);
+
+	mem_heap_free(heap);
+	mem_heap_free(prev_heap);
+
+	return(err);
+}
+
+/*************************************************************************
+Creates a secondary index in the data dictionary and adds it to the
+dictionary cache. The index is empty: it is filled with
+row_merge_build_index(). The caller must hold the dictionary lock, and
+commit the transaction after the index has been built, or roll back the
+transaction, which frees the index tree, and then remove the index from
+the cache with dict_index_remove_from_cache(). */
+
+ulint
+row_merge_create_index(
+/*===================*/
+					/* out: DB_SUCCESS or error code */
+	trx_t*		trx,		/* in: dictionary transaction */
+	dict_index_t*	index_def,	/* in, own: index definition from
+					dict_mem_index_create() */
+	const ulint*	field_lengths,	/* in: actual field lengths of the
+					index columns, or NULL, see
+					row_check_index_for_mysql() */
+	dict_index_t**	index)		/* out: the index in the dictionary
+					cache */
+{
+	ind_node_t*	node;
+	mem_heap_t*	heap;
+	que_thr_t*	thr;
+	dict_table_t*	table;
+	char*		index_name;
+	ulint		err;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+	ut_ad(mutex_own(&(dict_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+	ut_ad(!(index_def->type & DICT_CLUSTERED));
+
+	*index = NULL;
+
+	trx->op_info = "creating index";
+
+	trx_start_if_not_started(trx);
+
+	table = dict_table_get_low(index_def->table_name);
+
+	err = row_check_index_for_mysql(index_def, trx, field_lengths);
+
+	if (err != DB_SUCCESS || table == NULL) {
+		dict_mem_index_free(index_def);
+		trx->op_info = "";
+
+		return(table ? err : DB_TABLE_NOT_FOUND);
+	}
+
+	/* dict_index_add_to_cache() frees the definition */
+
+	index_name = mem_strdup(index_def->name);
+
+	heap = mem_heap_create(512);
+
+	node = ind_create_graph_create(index_def, heap);
+
+	thr = pars_complete_graph_for_exec(node, trx, heap);
+
+	ut_a(thr == que_fork_start_command(que_node_get_parent(thr)));
+	que_run_threads(thr);
+
+	err = trx->error_state;
+
+	que_graph_free((que_t*) que_node_get_parent(thr));
+
+	if (err == DB_SUCCESS) {
+		*index = dict_table_get_index(table, index_name);
+		ut_a(*index);
+
+		(*index)->trx_id = trx->id;
+	} else {
+		trx->error_state = DB_SUCCESS;
+	}
+
+	mem_free(index_name);
+
+	trx->op_info = "";
+
+	return(err);
+}
+
+/*************************************************************************
+Fills an empty secondary index created with row_merge_create_index().
+The clustered index is scanned once, the entries of the new index are
+sorted in buffers of buf_size bytes, the sorted runs are merged in
+temporary files, and the entries are inserted into the index tree in
+ascending order, so that the pages get filled. The caller must hold an
+S-lock on the table, so that there are neither uncommitted changes nor
+new changes to the rows while the index is built. */
+
+ulint
+row_merge_build_index(
+/*==================*/
+					/* out: DB_SUCCESS, DB_DUPLICATE_KEY,
+					DB_OUT_OF_FILE_SPACE or DB_ERROR */
+	trx_t*		trx,		/* in: transaction that created the
+					index */
+	dict_index_t*	index,		/* in: the new index */
+	ulint		buf_size)	/* in: size of the sort buffer */
+{
+	dict_index_t*		clust_index;
+	row_merge_buf_t*	buf;
+	row_merge_run_t		runs[ROW_MERGE_MAX_RUNS];
+	ulint			n_runs		= 0;
+	btr_pcur_t		pcur;
+	mtr_t			mtr;
+	rec_t*			rec;
+	dtuple_t*		row;
+	mem_heap_t*		row_heap;
+	mem_heap_t*		offsets_heap	= NULL;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*			offsets		= offsets_;
+	ibool			comp;
+	ulint			err		= DB_SUCCESS;
+	ulint			i;
+
+	*offsets_ = (sizeof offsets_) / sizeof *offsets_;
+
+	ut_ad(!(index->type & DICT_CLUSTERED));
+
+	trx->op_info = "building index";
+
+	clust_index = dict_table_get_first_index(index->table);
+	comp = index->table->comp;
+
+	buf = row_merge_buf_create(index, buf_size);
+	row_heap = mem_heap_create(1024);
+
+	/* Scan the clustered index and collect the entries of the rows
+	that are not delete-marked */
+
+	mtr_start(&mtr);
+
+	btr_pcur_open_at_index_side(TRUE, clust_index, BTR_SEARCH_LEAF,
+				    &pcur, TRUE, &mtr);
+
+	while (btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+
+		if (row_merge_buf_is_full(buf)) {
+			/* Do not keep the page latched while the buffer is
+			sorted and written */
+
+			btr_pcur_store_position(&pcur, &mtr);
+			mtr_commit(&mtr);
+
+			err = row_merge_buf_flush(buf, runs, &n_runs);
+
+			mtr_start(&mtr);
+
+			if (err != DB_SUCCESS) {
+
+				break;
+			}
+
+			/* If purge removed the record meanwhile, the cursor
+			is restored on a record that was processed */
+
+			if (!btr_pcur_restore_position(BTR_SEARCH_LEAF, &pcur,
+						       &mtr)
+			    && !btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+
+				break;
+			}
+		}
+
+		rec = btr_pcur_get_rec(&pcur);
+
+		if (rec_get_deleted_flag(rec, comp)) {
+
+			continue;
+		}
+
+		offsets = rec_get_offsets(rec, clust_index, offsets,
+					  ULINT_UNDEFINED, &offsets_heap);
+
+		row = row_build(ROW_COPY_POINTERS, clust_index, rec, offsets,
+				row_heap);
+
+		row_merge_buf_add(buf, row);
+
+		mem_heap_empty(row_heap);
+	}
+
+	btr_pcur_close(&pcur);
+	mtr_commit(&mtr);
+
+	mem_heap_free(row_heap);
+
+	if (UNIV_LIKELY_NULL(offsets_heap)) {
+		mem_heap_free(offsets_heap);
+	}
+
+	if (err != DB_SUCCESS) {
+		/* Nothing to do */
+	} else if (n_runs == 0) {
+		/* All entries fit in memory */
+
+		row_merge_buf_sort(buf);
+
+		for (i = 0; i < buf->n_tuples && err == DB_SUCCESS; i++) {
+			err = row_merge_insert(trx, index, buf->tuples[i],
+					       i ? buf->tuples[i - 1] : NULL);
+		}
+	} else {
+		if (buf->n_tuples) {
+			err = row_merge_buf_flush(buf, runs, &n_runs);
+		}
+
+		while (err == DB_SUCCESS && n_runs > 1) {
+			n_runs--;
+			runs[n_runs - 1].file = row_merge_runs(
+				index, runs[n_runs - 1].file,
+				runs[n_runs].file);
+
+			if (runs[n_runs - 1].file == NULL) {
+				n_runs--;
+				err = DB_ERROR;
+			}
+		}
+
+		if (err == DB_SUCCESS) {
+			n_runs--;
+			err = row_merge_insert_run(trx, index,
+						   runs[n_runs].file);
+		}
+	}
+
+	while (n_runs > 0) {
+		fclose(runs[--n_runs].file);
+	}
+
+	row_merge_buf_free(buf);
+
+	if (err == DB_DUPLICATE_KEY) {
+		trx->error_info = index;
+	}
+
+	trx->op_info = "";
+
+	return(err);
+}
+
+/*************************************************************************
+Looks for an index that a foreign key constraint can use instead of an index
+that is going to be dropped: it must begin with the same columns, and must
+not be a column prefix index. */
+static
+dict_index_t*
+row_merge_find_foreign_index(
+/*=========================*/
+					/* out: index, or NULL if none */
+	dict_table_t*	table,		/* in: table */
+	dict_index_t*	old_index,	/* in: index used by the constraint */
+	ulint		n_fields,	/* in: number of columns in the
+					constraint */
+	dict_index_t**	indexes,	/* in: indexes to be dropped */
+	ulint		n_indexes)	/* in: number of indexes to be
+					dropped */
+{
+	dict_index_t*	index;
+	ulint		i;
+
+	index = dict_table_get_first_index(table);
+
+	while (index) {
+		for (i = 0; i < n_indexes; i++) {
+			if (index == indexes[i]) {
+
+				goto next_index;
+			}
+		}
+
+		if (dict_index_get_n_fields(index) < n_fields) {
+
+			goto next_index;
+		}
+
+		for (i = 0; i < n_fields; i++) {
+			dict_field_t*	field
+				= dict_index_get_nth_field(index, i);
+
+			if (field->prefix_len != 0
+			    || field->col
+			    != dict_index_get_nth_field(old_index, i)->col) {
+
+				goto next_index;
+			}
+		}
+
+		return(index);
+next_index:
+		index = dict_table_get_next_index(index);
+	}
+
+	return(NULL);
+}
+
+/*************************************************************************
+Checks that secondary indexes can be dropped: each foreign key constraint
+that uses one of them must be able to use another index of the table. The
+constraints are switched to those other indexes. If the check fails, some
+constraints may already have been switched, which is harmless, because
+the index they use serves them equally well. */
+
+ulint
+row_merge_check_drop_indexes(
+/*=========================*/
+					/* out: DB_SUCCESS or
+					DB_CANNOT_DROP_CONSTRAINT */
+	dict_table_t*	table,		/* in: table */
+	dict_index_t**	indexes,	/* in: secondary indexes */
+	ulint		n_indexes)	/* in: number of indexes */
+{
+	dict_foreign_t*	foreign;
+	dict_index_t*	index;
+	ulint		i;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&(dict_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+
+	foreign = UT_LIST_GET_FIRST(table->foreign_list);
+
+	while (foreign) {
+		for (i = 0; i < n_indexes; i++) {
+			if (foreign->foreign_index != indexes[i]) {
+
+				continue;
+			}
+
+			index = row_merge_find_foreign_index(table,
+					foreign->foreign_index,
+					foreign->n_fields, indexes, n_indexes);
+			if (index == NULL) {
+
+				return(DB_CANNOT_DROP_CONSTRAINT);
+			}
+
+			foreign->foreign_index = index;
+			break;
+		}
+
+		foreign = UT_LIST_GET_NEXT(foreign_list, foreign);
+	}
+
+	foreign = UT_LIST_GET_FIRST(table->referenced_list);
+
+	while (foreign) {
+		for (i = 0; i < n_indexes; i++) {
+			if (foreign->referenced_index != indexes[i]) {
+
+				continue;
+			}
+
+			index = row_merge_find_foreign_index(table,
+					foreign->referenced_index,
+					foreign->n_fields, indexes, n_indexes);
+			if (index == NULL) {
+
+				return(DB_CANNOT_DROP_CONSTRAINT);
+			}
+
+			foreign->referenced_index = index;
+			break;
+		}
+
+		foreign = UT_LIST_GET_NEXT(referenced_list, foreign);
+	}
+
+	return(DB_SUCCESS);
+}
+
+/*************************************************************************
+Drops a secondary index: deletes its definition from the data dictionary,
+which frees the index tree, and removes it from the dictionary cache. The
+caller must hold the dictionary lock and an X-lock on the table, and
+commit the transaction. */
+
+ulint
+row_merge_drop_index(
+/*=================*/
+					/* out: DB_SUCCESS or error code */
+	trx_t*		trx,		/* in: dictionary transaction */
+	dict_table_t*	table,		/* in: table */
+	dict_index_t*	index)		/* in, own: secondary index */
+{
+	/* Deleting a row from SYS_INDEXES frees the index tree, see
+	row_upd_clust_step() */
+
+	static const char str1[] =
+	"PROCEDURE DROP_INDEX_PROC () IS\n"
+	"table_id CHAR;\n"
+	"index_id CHAR;\n"
+	"BEGIN\n"
+	"SELECT ID INTO table_id\n"
+	"FROM SYS_TABLES\n"
+	"WHERE NAME = ";
+	static const char str2[] =
+	";\n"
+	"SELECT ID INTO index_id\n"
+	"FROM SYS_INDEXES\n"
+	"WHERE TABLE_ID = table_id AND NAME = ";
+	static const char str3[] =
+	";\n"
+	"DELETE FROM SYS_FIELDS WHERE INDEX_ID = index_id;\n"
+	"DELETE FROM SYS_INDEXES WHERE ID = index_id\n"
+	"			 AND TABLE_ID = table_id;\n"
+	"END;\n";
+
+	char*		table_name;
+	char*		index_name;
+	ulint		table_len;
+	ulint		index_len;
+	char*		sql;
+	char*		ptr;
+	que_t*		graph;
+	que_thr_t*	thr;
+	ulint		err;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+	ut_ad(mutex_own(&(dict_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+	ut_ad(!(index->type & DICT_CLUSTERED));
+
+	trx->op_info = "dropping index";
+
+	trx_start_if_not_started(trx);
+
+	table_name = mem_strdupq(table->name, '\'');
+	index_name = mem_strdupq(index->name, '\'');
+	table_len = strlen(table_name);
+	index_len = strlen(index_name);
+
+	ptr = sql = mem_alloc((sizeof str1) + (sizeof str2) + (sizeof str3)
+			      + table_len + index_len);
+	memcpy(ptr, str1, (sizeof str1) - 1);
+	ptr += (sizeof str1) - 1;
+	memcpy(ptr, table_name, table_len);
+	ptr += table_len;
+	memcpy(ptr, str2, (sizeof str2) - 1);
+	ptr += (sizeof str2) - 1;
+	memcpy(ptr, index_name, index_len);
+	ptr += index_len;
+	memcpy(ptr, str3, sizeof str3);
+
+	mem_free(table_name);
+	mem_free(index_name);
+
+	graph = pars_sql(sql);
+
+	ut_a(graph);
+	mem_free(sql);
+
+	graph->trx = trx;
+	trx->graph = NULL;
+
+	graph->fork_type = QUE_FORK_MYSQL_INTERFACE;
+
+	/* Do not set trx->dict_operation: crash recovery would drop the
+	table with trx->table_id after rolling the transaction back */
+
+	ut_a(thr = que_fork_start_command(graph));
+
+	que_run_threads(thr);
+
+	err = trx->error_state;
+
+	que_graph_free(graph);
+
+	if (err == DB_SUCCESS) {
+		dict_index_remove_from_cache(table, index);
+	} else {
+		trx->error_state = DB_SUCCESS;
+	}
+
+	trx->op_info = "";
+
+	return(err);
+}
+
+/*************************************************************************
+Checks if a consistent read of a transaction can use an index. An index
+built by row_merge_build_index() only contains the latest versions of the
+rows, which a read view created before the index is not allowed to see. */
+
+ibool
+row_merge_is_index_usable(
+/*======================*/
+					/* out: TRUE if the index can be
+					used */
+	trx_t*		trx,		/* in: transaction */
+	dict_index_t*	index)		/* in: index */
+{
+	return(ut_dulint_is_zero(index->trx_id)
+	       || !trx->read_view
+	       || read_view_sees_trx_id(trx->read_view, index->trx_id));
+}
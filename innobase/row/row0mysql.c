@@ -121,6 +121,47 @@ row_mysql_prebuilt_free_blob_heap(
 	prebuilt->blob_heap = NULL;
 }
 
+/***********************************************************************
+Frees the fetch cache in prebuilt. Any rows still cached are discarded. */
+
+void
+row_mysql_prebuilt_free_fetch_cache(
+/*================================*/
+	row_prebuilt_t*	prebuilt)	/* in: prebuilt struct of a
+					ha_innobase:: table handle */
+{
+	ulint	i;
+
+	if (prebuilt->fetch_cache == NULL) {
+
+		return;
+	}
+
+	for (i = 0; i < prebuilt->fetch_cache_size; i++) {
+		if ((ROW_PREBUILT_FETCH_MAGIC_N !=
+		    mach_read_from_4((prebuilt->fetch_cache[i]) - 4))
+		    || (ROW_PREBUILT_FETCH_MAGIC_N !=
+		    mach_read_from_4((prebuilt->fetch_cache[i])
+		    			+ prebuilt->mysql_row_len))) {
+			fputs(
+			"InnoDB: Error: trying to free a corrupt\n"
+			"InnoDB: fetch buffer.\n", stderr);
+
+			mem_analyze_corruption(prebuilt->fetch_cache[i]);
+
+			ut_error;
+		}
+	}
+
+	mem_free(prebuilt->fetch_cache);
+
+	prebuilt->fetch_cache = NULL;
+	prebuilt->fetch_cache_size = 0;
+	prebuilt->fetch_cache_first = 0;
+	prebuilt->n_fetch_cached = 0;
+	prebuilt->fetch_batch = 0;
+}
+
 /***********************************************************************
 Stores a >= 5.0.3 format true VARCHAR length to dest, in the MySQL row
 format. */
@@ -596,7 +637,6 @@ row_create_prebuilt(
 	dict_index_t*	clust_index;
 	dtuple_t*	ref;
 	ulint		ref_len;
-	ulint		i;
 	
 	heap = mem_heap_create(128);
 
@@ -653,11 +693,13 @@ row_create_prebuilt(
 
 	prebuilt->clust_ref = ref;
 
-	for (i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
-		prebuilt->fetch_cache[i] = NULL;
-	}
-
+	prebuilt->fetch_cache = NULL;
+	prebuilt->fetch_cache_size = 0;
+	prebuilt->fetch_cache_first = 0;
 	prebuilt->n_fetch_cached = 0;
+	prebuilt->fetch_batch = 0;
+	prebuilt->fetch_cache_budget = 0;
+	prebuilt->fetch_bulk = FALSE;
 
 	prebuilt->blob_heap = NULL;
 
@@ -674,8 +716,6 @@ row_prebuilt_free(
 /*==============*/
 	row_prebuilt_t*	prebuilt)	/* in, own: prebuilt struct */
 {
-	ulint	i;
-
 	if (prebuilt->magic_n != ROW_PREBUILT_ALLOCATED
 	    || prebuilt->magic_n2 != ROW_PREBUILT_ALLOCATED) {
 		fprintf(stderr,
@@ -721,27 +761,7 @@ row_prebuilt_free(
 		mem_heap_free(prebuilt->old_vers_heap);
 	}
 	
-	for (i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
-		if (prebuilt->fetch_cache[i] != NULL) {
-
-			if ((ROW_PREBUILT_FETCH_MAGIC_N !=
-			    mach_read_from_4((prebuilt->fetch_cache[i]) - 4))
-			    || (ROW_PREBUILT_FETCH_MAGIC_N !=
-			    mach_read_from_4((prebuilt->fetch_cache[i])
-			    			+ prebuilt->mysql_row_len))) {
-				fputs(
-			"InnoDB: Error: trying to free a corrupt\n"
-			"InnoDB: fetch buffer.\n", stderr);
-
-				mem_analyze_corruption(
-						prebuilt->fetch_cache[i]);
-
-				ut_error;
-			}
-
-			mem_free((prebuilt->fetch_cache[i]) - 4);
-		}
-	}
+	row_mysql_prebuilt_free_fetch_cache(prebuilt);
 
 	dict_table_decrement_handle_count(prebuilt->table);
 
@@ -1991,14 +2011,14 @@ row_create_table_for_mysql(
 }
 
 /*************************************************************************
-Does an index creation operation for MySQL. TODO: currently failure
-to create an index results in dropping the whole table! This is no problem
-currently as all indexes must be created at the same time as the table. */
+Checks the columns of an index definition before the index is created. */
 
-int
-row_create_index_for_mysql(
-/*=======================*/
-					/* out: error number or DB_SUCCESS */
+ulint
+row_check_index_for_mysql(
+/*======================*/
+					/* out: DB_SUCCESS,
+					DB_COL_APPEARS_TWICE_IN_INDEX or
+					DB_TOO_BIG_RECORD */
 	dict_index_t*	index,		/* in: index definition */
 	trx_t*		trx,		/* in: transaction handle */
 	const ulint*	field_lengths)	/* in: if not NULL, must contain
@@ -2008,22 +2028,8 @@ row_create_index_for_mysql(
 					then checked for not being too
 					large. */
 {
-	ind_node_t*	node;
-	mem_heap_t*	heap;
-	que_thr_t*	thr;
-	ulint		err;
 	ulint		i, j;
 	ulint		len;
-	
-#ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
-	ut_ad(mutex_own(&(dict_sys->mutex)));
-#endif /* UNIV_SYNC_DEBUG */
-	ut_ad(trx->mysql_thread_id == os_thread_get_curr_id());
-	
-	trx->op_info = "creating index";
-
-	trx_start_if_not_started(trx);
 
 	/* Check that the same column does not appear twice in the index.
 	Starting from 4.0.14, InnoDB should be able to cope with that, but
@@ -2046,9 +2052,7 @@ row_create_index_for_mysql(
 				"InnoDB: This is not allowed in InnoDB.\n",
 					stderr);
 
-				err = DB_COL_APPEARS_TWICE_IN_INDEX;
-
-				goto error_handling;
+				return(DB_COL_APPEARS_TWICE_IN_INDEX);
 			}
 		}
 		
@@ -2062,12 +2066,54 @@ row_create_index_for_mysql(
 		}
 		
 		if (len >= DICT_MAX_INDEX_COL_LEN) {
-			err = DB_TOO_BIG_RECORD;
 
-			goto error_handling;
+			return(DB_TOO_BIG_RECORD);
 		}
 	}
 
+	return(DB_SUCCESS);
+}
+
+/*************************************************************************
+Does an index creation operation for MySQL. TODO: currently failure
+to create an index results in dropping the whole table! This is no problem
+currently as all indexes must be created at the same time as the table. */
+
+int
+row_create_index_for_mysql(
+/*=======================*/
+					/* out: error number or DB_SUCCESS */
+	dict_index_t*	index,		/* in: index definition */
+	trx_t*		trx,		/* in: transaction handle */
+	const ulint*	field_lengths)	/* in: if not NULL, must contain
+					dict_index_get_n_fields(index)
+					actual field lengths for the
+					index columns, which are
+					then checked for not being too
+					large. */
+{
+	ind_node_t*	node;
+	mem_heap_t*	heap;
+	que_thr_t*	thr;
+	ulint		err;
+	
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+	ut_ad(mutex_own(&(dict_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+	ut_ad(trx->mysql_thread_id == os_thread_get_curr_id());
+	
+	trx->op_info = "creating index";
+
+	trx_start_if_not_started(trx);
+
+	err = row_check_index_for_mysql(index, trx, field_lengths);
+
+	if (err != DB_SUCCESS) {
+
+		goto error_handling;
+	}
+
 	if (row_mysql_is_recovered_tmp_table(index->table_name)) {
 
 		return(DB_SUCCESS);
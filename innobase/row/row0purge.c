@@ -469,8 +469,8 @@ ibool
 row_purge_parse_undo_rec(
 /*=====================*/
 				/* out: TRUE if purge operation required:
-				NOTE that then the CALLER must unfreeze
-				data dictionary! */
+				NOTE that then the CALLER must s-unlatch
+				dict_operation_lock! */
 	purge_node_t*	node,	/* in: row undo node */
 	ibool*		updated_extern,
 				/* out: TRUE if an externally stored field
@@ -514,9 +514,11 @@ row_purge_parse_undo_rec(
 	}
 	
 	/* Prevent DROP TABLE etc. from running when we are doing the purge
-	for this row */
+	for this row. The purge query threads share the purge trx, and thus
+	we cannot use row_mysql_freeze_data_dictionary(), which records the
+	latch in the trx. */
 
-	row_mysql_freeze_data_dictionary(trx);
+	rw_lock_s_lock(&dict_operation_lock);
 
 	mutex_enter(&(dict_sys->mutex));
 
@@ -527,7 +529,7 @@ row_purge_parse_undo_rec(
 	if (node->table == NULL) {
 		/* The table has been dropped: no need to do purge */
 
-		row_mysql_unfreeze_data_dictionary(trx);
+		rw_lock_s_unlock(&dict_operation_lock);
 
 		return(FALSE);
 	}
@@ -537,7 +539,7 @@ row_purge_parse_undo_rec(
 
 		node->table = NULL;
 
-		row_mysql_unfreeze_data_dictionary(trx);
+		rw_lock_s_unlock(&dict_operation_lock);
 
 		return(FALSE);
 	}
@@ -547,7 +549,7 @@ row_purge_parse_undo_rec(
 	if (clust_index == NULL) {
 		/* The table was corrupt in the data dictionary */
 
-		row_mysql_unfreeze_data_dictionary(trx);
+		rw_lock_s_unlock(&dict_operation_lock);
 
 		return(FALSE);
 	}
@@ -585,12 +587,9 @@ row_purge(
 	dulint	roll_ptr;
 	ibool	purge_needed;
 	ibool	updated_extern;
-	trx_t*	trx;
 	
 	ut_ad(node && thr);
 
-	trx = thr_get_trx(thr);
-	
 	node->undo_rec = trx_purge_fetch_next_rec(&roll_ptr,
 						&(node->reservation),
 						node->heap);
@@ -609,8 +608,8 @@ row_purge(
 	} else {
 		purge_needed = row_purge_parse_undo_rec(node, &updated_extern,
 									thr);
-		/* If purge_needed == TRUE, we must also remember to unfreeze
-		data dictionary! */
+		/* If purge_needed == TRUE, we must also remember to s-unlatch
+		dict_operation_lock! */
 	}
 
 	if (purge_needed) {
@@ -632,7 +631,7 @@ row_purge(
 			btr_pcur_close(&(node->pcur));
 		}
 
-		row_mysql_unfreeze_data_dictionary(trx);
+		rw_lock_s_unlock(&dict_operation_lock);
 	}
 
 	/* Do some cleanup */
@@ -31,6 +31,7 @@ Created 12/19/1997 Heikki Tuuri
 #include "pars0pars.h"
 #include "row0mysql.h"
 #include "read0read.h"
+#include "row0merge.h"
 #include "buf0lru.h"
 
 /* Maximum number of rows to prefetch; MySQL interface has another parameter */
@@ -1002,7 +1003,7 @@ row_sel_try_search_shortcut(
 	ut_ad(plan->unique_search);
 	ut_ad(!plan->must_get_clust);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
+	ut_ad(rw_lock_own(btr_search_get_latch(index->id), RW_LOCK_SHARED));
 #endif /* UNIV_SYNC_DEBUG */
 	
 	row_sel_open_pcur(node, plan, TRUE, mtr);
@@ -1090,6 +1091,7 @@ row_sel(
 	rec_t*		old_vers;
 	rec_t*		clust_rec;
 	ibool		search_latch_locked;
+	rw_lock_t*	search_latch	= NULL;
 	ibool		consistent_read;
 	
 		/* The following flag becomes TRUE when we are doing a
@@ -1174,11 +1176,23 @@ table_loop:
 
 	if (consistent_read && plan->unique_search && !plan->pcur_is_open
 						&& !plan->must_get_clust) {
+		if (search_latch_locked
+		    && search_latch != btr_search_get_latch(index->id)) {
+			/* The previous table in the join was searched in
+			another hash index partition */
+
+			rw_lock_s_unlock(search_latch);
+
+			search_latch_locked = FALSE;
+		}
+
 		if (!search_latch_locked) {
-			rw_lock_s_lock(&btr_search_latch);
+			search_latch = btr_search_get_latch(index->id);
+
+			rw_lock_s_lock(search_latch);
 
 			search_latch_locked = TRUE;
-		} else if (btr_search_latch.writer_is_wait_ex) {
+		} else if (search_latch->writer_is_wait_ex) {
 
 			/* There is an x-latch request waiting: release the
 			s-latch for a moment; as an s-latch here is often
@@ -1187,8 +1201,8 @@ table_loop:
 			from acquiring an s-latch for a long time, lowering
 			performance significantly in multiprocessors. */
 
-			rw_lock_s_unlock(&btr_search_latch);
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
+			rw_lock_s_lock(search_latch);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan, &mtr);
@@ -1211,7 +1225,7 @@ table_loop:
 	}
 
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 
 		search_latch_locked = FALSE;
 	}
@@ -1663,7 +1677,7 @@ next_table_no_mtr:
 		thr->run_node = que_node_get_parent(node);
 
 		if (search_latch_locked) {
-			rw_lock_s_unlock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
 		}
 
 		err = DB_SUCCESS;
@@ -1711,7 +1725,7 @@ table_exhausted_no_mtr:
 			thr->run_node = que_node_get_parent(node);
 
 			if (search_latch_locked) {
-				rw_lock_s_unlock(&btr_search_latch);
+				rw_lock_s_unlock(search_latch);
 			}
 		
 			goto func_exit;
@@ -1722,7 +1736,7 @@ table_exhausted_no_mtr:
 		thr->run_node = que_node_get_parent(node);
 
 		if (search_latch_locked) {
-			rw_lock_s_unlock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
 		}
 		
 		goto func_exit;
@@ -2913,41 +2927,98 @@ row_sel_pop_cached_row_for_mysql(
 }
 
 /************************************************************************
-Pushes a row for MySQL to the fetch cache. */
-UNIV_INLINE
+Starts a new batch of rows in the fetch cache and makes sure that the cache
+has room for it. The first batch after positioning the cursor is small,
+because MySQL may want only a few rows, unless MySQL has told us that it
+will read the whole result set of a scan that starts from either end of the
+index. Every following batch of the same scan is twice as big as the
+previous one, up to what fits in the memory budget. */
+static
 void
-row_sel_push_cache_row_for_mysql(
-/*=============================*/
-	row_prebuilt_t*	prebuilt,	/* in: prebuilt struct */
-	rec_t*		rec,		/* in: record to push */
-	const ulint*	offsets)	/* in: rec_get_offsets() */
+row_sel_start_fetch_batch(
+/*======================*/
+	row_prebuilt_t*	prebuilt)	/* in: prebuilt struct */
 {
 	byte*	buf;
+	ulint	slot_size;
+	ulint	budget;
+	ulint	max_batch;
+	ulint	batch;
 	ulint	i;
 
-	ut_ad(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
-	ut_ad(rec_offs_validate(rec, NULL, offsets));
-	ut_a(!prebuilt->templ_contains_blob);
+	ut_ad(prebuilt->n_fetch_cached == 0);
+	ut_ad(prebuilt->fetch_cache_first == 0);
 
-	if (prebuilt->fetch_cache[0] == NULL) {
-		/* Allocate memory for the fetch cache */
+	/* A user has reported memory corruption in these buffers in Linux.
+	Put magic numbers at both ends of each row to help to track a
+	possible bug. */
 
-		for (i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
+	slot_size = ut_calc_align(prebuilt->mysql_row_len + 8, 8);
 
-			/* A user has reported memory corruption in these
-			buffers in Linux. Put magic numbers there to help
-			to track a possible bug. */
-			
-			buf = mem_alloc(prebuilt->mysql_row_len + 8);
+	budget = prebuilt->fetch_cache_budget;
+
+	if (budget == 0) {
+		budget = MYSQL_FETCH_CACHE_BUDGET;
+	}
+
+	max_batch = ut_min(budget / slot_size, MYSQL_FETCH_CACHE_MAX_SIZE);
+	max_batch = ut_max(max_batch, MYSQL_FETCH_CACHE_SIZE);
+
+	if (prebuilt->fetch_batch == 0) {
+		/* A range scan may end soon after the first rows even if
+		MySQL reads all of it: grow the batches also then */
+
+		batch = prebuilt->fetch_bulk
+			&& dtuple_get_n_fields(prebuilt->search_tuple) == 0
+			? max_batch : MYSQL_FETCH_CACHE_SIZE;
+	} else {
+		batch = ut_min(2 * prebuilt->fetch_batch, max_batch);
+	}
+
+	if (batch > prebuilt->fetch_cache_size) {
+		/* Allocate the row pointers and the rows in one block */
+
+		row_mysql_prebuilt_free_fetch_cache(prebuilt);
+
+		buf = mem_alloc(batch * (sizeof(byte*) + slot_size));
+
+		prebuilt->fetch_cache = (byte**) buf;
 
+		buf += batch * sizeof(byte*);
+
+		for (i = 0; i < batch; i++) {
 			prebuilt->fetch_cache[i] = buf + 4;
-				
+
 			mach_write_to_4(buf, ROW_PREBUILT_FETCH_MAGIC_N);
 			mach_write_to_4(buf + 4 + prebuilt->mysql_row_len,
 					ROW_PREBUILT_FETCH_MAGIC_N);
+			buf += slot_size;
 		}
+
+		prebuilt->fetch_cache_size = batch;
 	}
 
+	prebuilt->fetch_batch = batch;
+}
+
+/************************************************************************
+Pushes a row for MySQL to the fetch cache. */
+UNIV_INLINE
+void
+row_sel_push_cache_row_for_mysql(
+/*=============================*/
+	row_prebuilt_t*	prebuilt,	/* in: prebuilt struct */
+	rec_t*		rec,		/* in: record to push */
+	const ulint*	offsets)	/* in: rec_get_offsets() */
+{
+	ut_ad(rec_offs_validate(rec, NULL, offsets));
+	ut_a(!prebuilt->templ_contains_blob);
+
+	if (prebuilt->n_fetch_cached == 0) {
+		row_sel_start_fetch_batch(prebuilt);
+	}
+
+	ut_ad(prebuilt->n_fetch_cached < prebuilt->fetch_batch);
 	ut_ad(prebuilt->fetch_cache_first == 0);
 
 	if (UNIV_UNLIKELY(!row_sel_store_mysql_rec(
@@ -3156,15 +3227,16 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 	/* PHASE 0: Release a possible s-latch we are holding on the
 	adaptive hash index latch if there is someone waiting behind */
 
-	if (UNIV_UNLIKELY(btr_search_latch.writer != RW_LOCK_NOT_LOCKED)
-	    && trx->has_search_latch) {
+	if (trx->has_search_latch
+	    && UNIV_UNLIKELY(trx->search_latch->writer
+			     != RW_LOCK_NOT_LOCKED)) {
 
 		/* There is an x-latch request on the adaptive hash index:
 		release the s-latch to reduce starvation and wait for
 		BTR_SEA_TIMEOUT rounds before trying to keep it again over
 		calls from MySQL */
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 
 		trx->search_latch_timeout = BTR_SEA_TIMEOUT;
@@ -3189,6 +3261,7 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		prebuilt->fetch_batch = 0;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -3213,6 +3286,7 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 			prebuilt->n_rows_fetched = 0;
 			prebuilt->n_fetch_cached = 0;
 			prebuilt->fetch_cache_first = 0;
+			prebuilt->fetch_batch = 0;
 
 		} else if (UNIV_LIKELY(prebuilt->n_fetch_cached > 0)) {
 			row_sel_pop_cached_row_for_mysql(buf, prebuilt);
@@ -3225,7 +3299,7 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 		}
 
 		if (prebuilt->fetch_cache_first > 0
-		    && prebuilt->fetch_cache_first < MYSQL_FETCH_CACHE_SIZE) {
+		    && prebuilt->fetch_cache_first < prebuilt->fetch_batch) {
 
 		    	/* The previous returned row was popped from the fetch
 		    	cache, but the cache was not full at the time of the
@@ -3322,8 +3396,21 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 			hash index semaphore! */
 
 #ifndef UNIV_SEARCH_DEBUG			
+			if (trx->has_search_latch
+			    && trx->search_latch
+			    != btr_search_get_latch(index->id)) {
+				/* We hold the latch of the hash index
+				partition of another index: release it to
+				obey the latching order */
+
+				rw_lock_s_unlock(trx->search_latch);
+				trx->has_search_latch = FALSE;
+			}
+
 			if (!trx->has_search_latch) {
-				rw_lock_s_lock(&btr_search_latch);
+				trx->search_latch = btr_search_get_latch(
+								index->id);
+				rw_lock_s_lock(trx->search_latch);
 				trx->has_search_latch = TRUE;
 			}
 #endif
@@ -3355,7 +3442,7 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 
 					trx->search_latch_timeout--;
 
-			        	rw_lock_s_unlock(&btr_search_latch);
+			        	rw_lock_s_unlock(trx->search_latch);
 					trx->has_search_latch = FALSE;
 				}    	
 				
@@ -3375,7 +3462,7 @@ cursor lock count is done correctly. See bugs #12263 and #12456!
 
 					trx->search_latch_timeout--;
 
-			        	rw_lock_s_unlock(&btr_search_latch);
+			        	rw_lock_s_unlock(trx->search_latch);
 					trx->has_search_latch = FALSE;
 				}
 
@@ -3395,7 +3482,7 @@ shortcut_fails_too_big_rec:
 	/* PHASE 3: Open or restore index cursor position */
 
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 	}			
 
@@ -3521,6 +3608,13 @@ shortcut_fails_too_big_rec:
 		prebuilt->sql_stat_start = FALSE;
 	}
 
+	if (UNIV_UNLIKELY(prebuilt->select_lock_type == LOCK_NONE
+			  && !row_merge_is_index_usable(trx, index))) {
+
+		err = DB_MISSING_HISTORY;
+		goto normal_return;
+	}
+
 rec_loop:
 	/*-------------------------------------------------------------*/
 	/* PHASE 4: Look for matching records in a loop */
@@ -3946,6 +4040,7 @@ requires_clust_rec:
 				offsets));
 
 	if ((match_mode == ROW_SEL_EXACT
+		|| (prebuilt->fetch_bulk && prebuilt->n_rows_fetched > 0)
 		|| prebuilt->n_rows_fetched >= MYSQL_FETCH_CACHE_THRESHOLD)
 			&& prebuilt->select_lock_type == LOCK_NONE
 			&& !prebuilt->templ_contains_blob
@@ -3965,7 +4060,7 @@ requires_clust_rec:
 
 		row_sel_push_cache_row_for_mysql(prebuilt, result_rec,
 								offsets);
-		if (prebuilt->n_fetch_cached == MYSQL_FETCH_CACHE_SIZE) {
+		if (prebuilt->n_fetch_cached == prebuilt->fetch_batch) {
 			
 			goto got_row;
 		}
@@ -4206,9 +4301,13 @@ row_search_check_if_query_cache_permitted(
 		if (trx->isolation_level >= TRX_ISO_REPEATABLE_READ
 		    && !trx->read_view) {
 
+			mutex_enter(&(trx_sys->mutex));
+
 			trx->read_view = read_view_open_now(trx,
 						trx->global_read_view_heap);
 			trx->global_read_view = trx->read_view;
+
+			mutex_exit(&(trx_sys->mutex));
 		}
 	}
 	
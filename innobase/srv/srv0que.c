@@ -89,7 +89,11 @@ srv_que_task_enqueue_low(
 
 	UT_LIST_ADD_LAST(queue, srv_sys->tasks, thr);
 
+	mutex_enter(&(srv_sys->mutex));
+
 	srv_release_threads(SRV_WORKER, 1);
+
+	mutex_exit(&(srv_sys->mutex));
 }
 
 /**************************************************************************
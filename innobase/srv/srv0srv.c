@@ -161,11 +161,20 @@ ulint	srv_awe_window_size 	= 0;		/* size in pages; MySQL inits
 						this to bytes, but we
 						normalize it to pages in
 						srv_boot() */
+ulint	srv_buf_pool_instances	= 1;		/* number of buffer pool
+						instances; buf_pool_init()
+						may reduce it */
 ulint	srv_mem_pool_size	= ULINT_MAX;	/* size in bytes */ 
 ulint	srv_lock_table_size	= ULINT_MAX;
 
 ulint	srv_n_file_io_threads	= ULINT_MAX;
 
+/* Use the Linux kernel aio system calls instead of simulated aio if they
+are available */
+ibool	srv_use_native_aio	= TRUE;
+/* Maximum number of pending native aio requests per i/o-handler thread */
+ulint	srv_aio_queue_depth	= 256;
+
 #ifdef UNIV_LOG_ARCHIVE
 ibool	srv_log_archive_on	= FALSE;
 ibool	srv_archive_recovery	= 0;
@@ -187,6 +196,14 @@ that during a time of heavy update/insert activity. */
 
 ulong	srv_max_buf_pool_modified_pct	= 90;
 
+/* If this is TRUE, the master thread flushes the flush list at the rate
+of redo generation, see buf_flush_adaptive() */
+ibool	srv_adaptive_flushing	= TRUE;
+
+/* The maximum number of pages the master thread flushes per second in
+adaptive flushing */
+ulong	srv_io_capacity		= 200;
+
 /* variable counts amount of data read in total (in bytes) */
 ulint srv_data_read = 0;
 
@@ -321,6 +338,8 @@ int     srv_query_thread_priority = 0;
 disable adaptive hash indexes */
 ibool	srv_use_awe			= FALSE;
 ibool	srv_use_adaptive_hash_indexes 	= TRUE;
+ulint	srv_adaptive_hash_index_partitions = 8;	/* number of partitions of
+						the adaptive hash index */
 
 /*-------------------------------------------*/
 ulong	srv_n_spin_wait_rounds	= 20;
@@ -608,8 +627,8 @@ srv_sys_t*	srv_sys	= NULL;
 byte		srv_pad1[64];	/* padding to prevent other memory update
 				hotspots from residing on the same memory
 				cache line */
-mutex_t*	kernel_mutex_temp;/* mutex protecting the server, trx structs,
-				query threads, and lock table */
+mutex_t*	kernel_mutex_temp;/* mutex protecting the lock table, trx
+				structs and query threads */
 byte		srv_pad2[64];	/* padding to prevent other memory update
 				hotspots from residing on the same memory
 				cache line */
@@ -673,14 +692,14 @@ srv_get_n_threads(void)
 	ulint	i;
 	ulint	n_threads	= 0;
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 
 	for (i = SRV_COM; i < SRV_MASTER + 1; i++) {
 	
 		n_threads += srv_n_threads[i];
 	}
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	return(n_threads);
 }
@@ -688,7 +707,7 @@ srv_get_n_threads(void)
 /*************************************************************************
 Reserves a slot in the thread table for the current thread. Also creates the
 thread local storage struct for the current thread. NOTE! The server mutex
-has to be reserved by the caller! */
+srv_sys->mutex has to be reserved by the caller! */
 static
 ulint
 srv_table_reserve_slot(
@@ -699,6 +718,9 @@ srv_table_reserve_slot(
 	srv_slot_t*	slot;
 	ulint		i;
 	
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&(srv_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
 	ut_a(type > 0);
 	ut_a(type <= SRV_MASTER);
 
@@ -727,7 +749,7 @@ srv_table_reserve_slot(
 
 /*************************************************************************
 Suspends the calling thread to wait for the event in its thread slot.
-NOTE! The server mutex has to be reserved by the caller! */
+NOTE! The server mutex srv_sys->mutex has to be reserved by the caller! */
 static
 os_event_t
 srv_suspend_thread(void)
@@ -740,7 +762,7 @@ srv_suspend_thread(void)
 	ulint		type;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(srv_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	
 	slot_no = thr_local_get_slot_no(os_thread_get_curr_id());
@@ -774,7 +796,7 @@ srv_suspend_thread(void)
 
 /*************************************************************************
 Releases threads of the type given from suspension in the thread table.
-NOTE! The server mutex has to be reserved by the caller! */
+NOTE! The server mutex srv_sys->mutex has to be reserved by the caller! */
 
 ulint
 srv_release_threads(
@@ -793,7 +815,7 @@ srv_release_threads(
 	ut_ad(type <= SRV_MASTER);
 	ut_ad(n > 0);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(srv_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 	
 	for (i = 0; i < OS_THREAD_MAX_N; i++) {
@@ -838,7 +860,7 @@ srv_get_thread_type(void)
 	srv_slot_t*	slot;
 	ulint		type;
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	
 	slot_no = thr_local_get_slot_no(os_thread_get_curr_id());
 
@@ -849,7 +871,7 @@ srv_get_thread_type(void)
 	ut_ad(type >= SRV_WORKER);
 	ut_ad(type <= SRV_MASTER);
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	return(type);
 }
@@ -872,6 +894,9 @@ srv_init(void)
 	mutex_create(&kernel_mutex);
 	mutex_set_level(&kernel_mutex, SYNC_KERNEL);
 
+	mutex_create(&(srv_sys->mutex));
+	mutex_set_level(&(srv_sys->mutex), SYNC_SRV_SYS);
+
 	mutex_create(&srv_innodb_monitor_mutex);
 	mutex_set_level(&srv_innodb_monitor_mutex, SYNC_NO_ORDER_CHECK);
 	
@@ -983,6 +1008,12 @@ srv_general_init(void)
 /* Maximum allowable purge history length.  <=0 means 'infinite'. */
 ulong	srv_max_purge_lag		= 0;
 
+/* Number of threads doing the purge: if 0, the master thread runs the purge
+batches; otherwise a purge coordinator thread runs them, and each batch is
+divided among the coordinator and srv_n_purge_threads - 1 purge worker
+threads */
+ulint	srv_n_purge_threads		= 0;
+
 /*************************************************************************
 Puts an OS thread to wait if there are too many concurrent threads
 (>= srv_thread_concurrency) inside InnoDB. The threads wait in a FIFO queue. */
@@ -1686,7 +1717,7 @@ srv_printf_innodb_monitor(
 		"-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	btr_search_print_info(file);
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -1701,6 +1732,7 @@ srv_printf_innodb_monitor(
 		       "LOG\n"
 		"---\n", file);
 	log_print(file);
+	buf_flush_print_adaptive(file);
 
 	fputs("----------------------\n"
 		       "BUFFER POOL AND MEMORY\n"
@@ -1782,6 +1814,10 @@ Function to pass InnoDB status variables to MySQL */
 void
 srv_export_innodb_status(void)
 {
+        buf_pool_stat_t stat;
+        ulint           LRU_len;
+        ulint           free_len;
+        ulint           flush_list_len;
 
         mutex_enter(&srv_innodb_monitor_mutex);
         export_vars.innodb_data_pending_reads= os_n_pending_reads;
@@ -1800,13 +1836,14 @@ srv_export_innodb_status(void)
         export_vars.innodb_buffer_pool_reads= srv_buf_pool_reads;
         export_vars.innodb_buffer_pool_read_ahead_rnd= srv_read_ahead_rnd;
         export_vars.innodb_buffer_pool_read_ahead_seq= srv_read_ahead_seq;
-        export_vars.innodb_buffer_pool_pages_data= UT_LIST_GET_LEN(buf_pool->LRU);
-        export_vars.innodb_buffer_pool_pages_dirty= UT_LIST_GET_LEN(buf_pool->flush_list);
-        export_vars.innodb_buffer_pool_pages_free= UT_LIST_GET_LEN(buf_pool->free);
+        buf_get_total_list_len(&LRU_len, &free_len, &flush_list_len);
+        export_vars.innodb_buffer_pool_pages_data= LRU_len;
+        export_vars.innodb_buffer_pool_pages_dirty= flush_list_len;
+        export_vars.innodb_buffer_pool_pages_free= free_len;
         export_vars.innodb_buffer_pool_pages_latched= buf_get_latched_pages_number();
         export_vars.innodb_buffer_pool_pages_total= buf_pool->curr_size;
         export_vars.innodb_buffer_pool_pages_misc= buf_pool->max_size -
-          UT_LIST_GET_LEN(buf_pool->LRU) - UT_LIST_GET_LEN(buf_pool->free);
+          LRU_len - free_len;
         export_vars.innodb_page_size= UNIV_PAGE_SIZE;
         export_vars.innodb_log_waits= srv_log_waits;
         export_vars.innodb_os_log_written= srv_os_log_written;
@@ -1817,9 +1854,12 @@ srv_export_innodb_status(void)
         export_vars.innodb_log_writes= srv_log_writes;
         export_vars.innodb_dblwr_pages_written= srv_dblwr_pages_written;
         export_vars.innodb_dblwr_writes= srv_dblwr_writes;
-        export_vars.innodb_pages_created= buf_pool->n_pages_created;
-        export_vars.innodb_pages_read= buf_pool->n_pages_read;
-        export_vars.innodb_pages_written= buf_pool->n_pages_written;
+        export_vars.innodb_history_list_length= trx_sys->rseg_history_len;
+        buf_get_total_stat(&stat);
+        export_vars.innodb_pages_created= stat.n_pages_created;
+        export_vars.innodb_pages_read= stat.n_pages_read;
+        export_vars.innodb_pages_written= stat.n_pages_written;
+        export_vars.innodb_purge_undo_records= purge_sys->n_recs_handled;
         export_vars.innodb_row_lock_waits= srv_n_lock_wait_count;
         export_vars.innodb_row_lock_current_waits= srv_n_lock_wait_current_count;
         export_vars.innodb_row_lock_time= srv_n_lock_wait_time / 1000;
@@ -2139,11 +2179,11 @@ srv_active_wake_master_thread(void)
 			
 	if (srv_n_threads_active[SRV_MASTER] == 0) {
 
-		mutex_enter(&kernel_mutex);
+		mutex_enter(&(srv_sys->mutex));
 
 		srv_release_threads(SRV_MASTER, 1);
 
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 	}
 }
 
@@ -2156,11 +2196,71 @@ srv_wake_master_thread(void)
 {
 	srv_activity_count++;
 			
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 
 	srv_release_threads(SRV_MASTER, 1);
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
+}
+
+/***********************************************************************
+Wakes up the purge coordinator thread if it is suspended, and at shutdown
+also the purge worker threads so that they exit. */
+
+void
+srv_wake_purge_thread(void)
+/*=======================*/
+{
+	mutex_enter(&(srv_sys->mutex));
+
+	srv_release_threads(SRV_PURGE, 1);
+
+	if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+		srv_release_threads(SRV_WORKER, SRV_MAX_N_PURGE_THREADS);
+	}
+
+	mutex_exit(&(srv_sys->mutex));
+}
+
+/*************************************************************************
+Does purge on behalf of the master thread. If there is a purge coordinator
+thread, it is only woken up, except at shutdown: then the coordinator stops
+after its current batch, and the master thread runs the rest of the purge
+itself after the coordinator has suspended itself. */
+static
+ulint
+srv_master_do_purge(void)
+/*=====================*/
+			/* out: number of undo log pages handled in the
+			batch */
+{
+	ulint	n_active;
+
+	if (srv_n_purge_threads > 0) {
+		if (srv_shutdown_state == 0) {
+			srv_wake_purge_thread();
+
+			return(0);
+		}
+
+		for (;;) {
+			mutex_enter(&(srv_sys->mutex));
+
+			n_active = srv_n_threads_active[SRV_PURGE];
+
+			mutex_exit(&(srv_sys->mutex));
+
+			if (n_active == 0) {
+
+				break;
+			}
+
+			os_thread_sleep(10000);
+		}
+	}
+
+	return(trx_purge());
 }
 
 /*************************************************************************
@@ -2191,6 +2291,7 @@ srv_master_thread(
 	ulint		n_ios_old;
 	ulint		n_ios_very_old;
 	ulint		n_pend_ios;
+	buf_pool_stat_t	buf_stat;
 	ibool		skip_sleep	= FALSE;
 	ulint		i;
 	
@@ -2201,13 +2302,13 @@ srv_master_thread(
 	srv_main_thread_process_no = os_proc_get_number();
 	srv_main_thread_id = os_thread_pf(os_thread_get_curr_id());
 	
-	srv_table_reserve_slot(SRV_MASTER);	
+	mutex_enter(&(srv_sys->mutex));
 
-	mutex_enter(&kernel_mutex);
+	srv_table_reserve_slot(SRV_MASTER);	
 
 	srv_n_threads_active[SRV_MASTER]++;
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	os_event_set(srv_sys->operational);
 loop:
@@ -2215,16 +2316,17 @@ loop:
 	/* ---- When there is database activity by users, we cycle in this
 	loop */
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	n_ios_very_old = log_sys->n_log_ios + buf_pool->n_pages_read
-						+ buf_pool->n_pages_written;
-	mutex_enter(&kernel_mutex);
+	buf_get_total_stat(&buf_stat);
+	n_ios_very_old = log_sys->n_log_ios + buf_stat.n_pages_read
+						+ buf_stat.n_pages_written;
+	mutex_enter(&(srv_sys->mutex));
 
 	/* Store the user activity counter at the start of this loop */
 	old_activity_count = srv_activity_count;
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	if (srv_force_recovery >= SRV_FORCE_NO_BACKGROUND) {
 
@@ -2237,8 +2339,9 @@ loop:
 	skip_sleep = FALSE;
 
 	for (i = 0; i < 10; i++) {
-		n_ios_old = log_sys->n_log_ios + buf_pool->n_pages_read
-						+ buf_pool->n_pages_written;
+		buf_get_total_stat(&buf_stat);
+		n_ios_old = log_sys->n_log_ios + buf_stat.n_pages_read
+						+ buf_stat.n_pages_written;
 		srv_main_thread_op_info = "sleeping";
 		
 		if (!skip_sleep) {
@@ -2273,6 +2376,13 @@ loop:
 		srv_main_thread_op_info = "making checkpoint";
 		log_free_check();
 
+		if (srv_n_purge_threads > 0) {
+			/* Let the purge thread keep up with the history
+			list while there is activity */
+
+			srv_wake_purge_thread();
+		}
+
 		/* If there were less than 5 i/os during the
 		one second sleep, we assume that there is free
 		disk i/o capacity available, and it makes sense to
@@ -2280,8 +2390,9 @@ loop:
 
 		n_pend_ios = buf_get_n_pending_ios()
 						+ log_sys->n_pending_writes;
-		n_ios = log_sys->n_log_ios + buf_pool->n_pages_read
-						+ buf_pool->n_pages_written;
+		buf_get_total_stat(&buf_stat);
+		n_ios = log_sys->n_log_ios + buf_stat.n_pages_read
+						+ buf_stat.n_pages_written;
 		if (n_pend_ios < 3 && (n_ios - n_ios_old < 5)) {
 			srv_main_thread_op_info = "doing insert buffer merge";
 			ibuf_contract_for_n_pages(TRUE, 5);
@@ -2304,8 +2415,23 @@ loop:
 			even more than 1 second, and also, there may be more
 			to flush. Do not sleep 1 second during the next
 			iteration of this loop. */
-			     
+
 			skip_sleep = TRUE;
+		} else if (srv_adaptive_flushing) {
+
+			/* Flush the oldest modified pages at the rate the
+			log grows, so that the user threads do not need to
+			preflush pages or wait for a checkpoint at the log
+			margins */
+
+			srv_main_thread_op_info =
+					"flushing buffer pool pages adaptively";
+			n_pages_flushed = buf_flush_adaptive();
+
+			if (n_pages_flushed > 0 && log_checkpoint_is_due()) {
+				srv_main_thread_op_info = "making checkpoint";
+				log_checkpoint(FALSE, FALSE);
+			}
 		}
 
 		if (srv_activity_count == old_activity_count) {
@@ -2330,8 +2456,9 @@ loop:
 	makes sense to flush 100 pages. */
 
 	n_pend_ios = buf_get_n_pending_ios() + log_sys->n_pending_writes;
-	n_ios = log_sys->n_log_ios + buf_pool->n_pages_read
-						+ buf_pool->n_pages_written;
+	buf_get_total_stat(&buf_stat);
+	n_ios = log_sys->n_log_ios + buf_stat.n_pages_read
+						+ buf_stat.n_pages_written;
 	if (n_pend_ios < 3 && (n_ios - n_ios_very_old < 200)) {
 
 		srv_main_thread_op_info = "flushing buffer pool pages";
@@ -2365,7 +2492,7 @@ loop:
 		}
 
 		srv_main_thread_op_info = "purging";
-		n_pages_purged = trx_purge();
+		n_pages_purged = srv_master_do_purge();
 
 		current_time = time(NULL);
 
@@ -2404,19 +2531,19 @@ loop:
 
 	log_checkpoint(TRUE, FALSE);
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	
 	/* ---- When there is database activity, we jump from here back to
 	the start of loop */
 
 	if (srv_activity_count != old_activity_count) {
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 		goto loop;
 	}
 	
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	/* If the database is quiet, we enter the background loop */
 
@@ -2457,7 +2584,7 @@ background_loop:
 		}
 
 		srv_main_thread_op_info = "purging";
-		n_pages_purged = trx_purge();
+		n_pages_purged = srv_master_do_purge();
 
 		current_time = time(NULL);
 
@@ -2469,14 +2596,14 @@ background_loop:
 		}
 	}
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	if (srv_activity_count != old_activity_count) {
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 		goto loop;
 	}
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 
 	srv_main_thread_op_info = "doing insert buffer merge";
 
@@ -2486,14 +2613,14 @@ background_loop:
 	        n_bytes_merged = ibuf_contract_for_n_pages(TRUE, 20);
 	}
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	if (srv_activity_count != old_activity_count) {
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 		goto loop;
 	}
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 	
 flush_loop:
 	srv_main_thread_op_info = "flushing buffer pool pages";
@@ -2508,14 +2635,14 @@ flush_loop:
 		n_pages_flushed = 0;
 	}
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	if (srv_activity_count != old_activity_count) {
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 		goto loop;
 	}
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 	
 	srv_main_thread_op_info = "waiting for buffer pool flush to end";
 	buf_flush_wait_batch_end(BUF_FLUSH_LIST);
@@ -2536,14 +2663,14 @@ flush_loop:
 		goto flush_loop;
 	}
 
-	srv_main_thread_op_info = "reserving kernel mutex";
+	srv_main_thread_op_info = "reserving server mutex";
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(srv_sys->mutex));
 	if (srv_activity_count != old_activity_count) {
-		mutex_exit(&kernel_mutex);
+		mutex_exit(&(srv_sys->mutex));
 		goto loop;
 	}
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(srv_sys->mutex));
 /*
 	srv_main_thread_op_info = "archiving log (if log archive is on)";
 	
@@ -2589,8 +2716,12 @@ suspend_thread:
 		goto loop;
 	}
 
+	mutex_enter(&(srv_sys->mutex));
+
 	event = srv_suspend_thread();
 
+	mutex_exit(&(srv_sys->mutex));
+
 	mutex_exit(&kernel_mutex);
 
 	srv_main_thread_op_info = "waiting for server activity";
@@ -2616,6 +2747,145 @@ suspend_thread:
 	
 	os_thread_exit(NULL);
 
+#ifndef __WIN__
+        return(NULL);				/* Not reached */
+#else
+	return(0);
+#endif
+}
+
+/*************************************************************************
+The purge coordinator thread. It runs the purge batches which the master
+thread runs when srv_n_purge_threads is 0, and hands out a query thread of
+each batch to every purge worker thread. */
+
+#ifndef __WIN__
+void*
+#else
+ulint
+#endif
+srv_purge_thread(
+/*=============*/
+			/* out: a dummy parameter */
+	void*	arg __attribute__((unused)))
+			/* in: a dummy parameter required by
+			os_thread_create */
+{
+	os_event_t	event;
+	ulint		n_pages_purged;
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "Purge thread starts, id %lu\n",
+			      os_thread_pf(os_thread_get_curr_id()));
+#endif
+	mutex_enter(&(srv_sys->mutex));
+
+	srv_table_reserve_slot(SRV_PURGE);
+
+	srv_n_threads_active[SRV_PURGE]++;
+
+	mutex_exit(&(srv_sys->mutex));
+
+	for (;;) {
+		/* Purge until the history list is empty or the purge view
+		does not let us proceed; at shutdown the master thread does
+		the rest of the purge */
+
+		do {
+			if (srv_shutdown_state > 0) {
+
+				break;
+			}
+
+			n_pages_purged = trx_purge();
+		} while (n_pages_purged > 0);
+
+		/* The master thread wakes us up once a second when there
+		is activity */
+
+		mutex_enter(&(srv_sys->mutex));
+
+		event = srv_suspend_thread();
+
+		mutex_exit(&(srv_sys->mutex));
+
+		os_event_wait(event);
+
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+			os_thread_exit(NULL);
+		}
+	}
+
+	os_thread_exit(NULL);			/* Not reached */
+
+#ifndef __WIN__
+        return(NULL);				/* Not reached */
+#else
+	return(0);
+#endif
+}
+
+/*************************************************************************
+A purge worker thread. It runs the query threads which the purge coordinator
+puts to the server task queue. */
+
+#ifndef __WIN__
+void*
+#else
+ulint
+#endif
+srv_purge_worker_thread(
+/*====================*/
+			/* out: a dummy parameter */
+	void*	arg __attribute__((unused)))
+			/* in: a dummy parameter required by
+			os_thread_create */
+{
+	os_event_t	event;
+
+	mutex_enter(&(srv_sys->mutex));
+
+	srv_table_reserve_slot(SRV_WORKER);
+
+	srv_n_threads_active[SRV_WORKER]++;
+
+	mutex_exit(&(srv_sys->mutex));
+
+	for (;;) {
+		srv_que_task_queue_check();
+
+		/* The task queue is protected by the kernel mutex: if it
+		is empty here, srv_que_task_enqueue_low() will release us
+		from the suspension */
+
+		mutex_enter(&kernel_mutex);
+
+		if (UT_LIST_GET_LEN(srv_sys->tasks) > 0) {
+
+			mutex_exit(&kernel_mutex);
+
+			continue;
+		}
+
+		mutex_enter(&(srv_sys->mutex));
+
+		event = srv_suspend_thread();
+
+		mutex_exit(&(srv_sys->mutex));
+
+		mutex_exit(&kernel_mutex);
+
+		os_event_wait(event);
+
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+
+			os_thread_exit(NULL);
+		}
+	}
+
+	os_thread_exit(NULL);			/* Not reached */
+
 #ifndef __WIN__
         return(NULL);				/* Not reached */
 #else
@@ -88,7 +88,8 @@ static mutex_t		ios_mutex;
 static ulint		ios;
 
 static ulint		n[SRV_MAX_N_IO_THREADS + 5];
-static os_thread_id_t	thread_ids[SRV_MAX_N_IO_THREADS + 5];
+static os_thread_id_t	thread_ids[SRV_MAX_N_IO_THREADS + 5
+					   + SRV_MAX_N_PURGE_THREADS];
 
 /* We use this mutex to test the return value of pthread_mutex_trylock
    on successful locking. HP-UX does NOT return 0, though Linux et al do. */
@@ -1211,6 +1212,30 @@ innobase_start_or_create_for_mysql(void)
 		srv_n_file_io_threads = SRV_MAX_N_IO_THREADS;
 	}
 
+	if (srv_n_purge_threads > SRV_MAX_N_PURGE_THREADS) {
+
+		srv_n_purge_threads = SRV_MAX_N_PURGE_THREADS;
+	}
+
+	if (srv_force_recovery >= SRV_FORCE_NO_BACKGROUND) {
+		/* The purge must not run at all */
+
+		srv_n_purge_threads = 0;
+	}
+
+#ifdef LINUX_NATIVE_AIO
+	if (srv_use_native_aio) {
+		/* We need at least one read and one write thread besides
+		the ibuf and log threads */
+
+		if (srv_n_file_io_threads < 4) {
+			srv_n_file_io_threads = 4;
+		}
+
+		os_aio_use_native_aio = os_aio_linux_is_supported(
+				srv_aio_queue_depth * srv_n_file_io_threads);
+	}
+#endif
 	if (!os_aio_use_native_aio) {
  		/* In simulated aio we currently have use only for 4 threads */
 		srv_n_file_io_threads = 4;
@@ -1220,7 +1245,12 @@ innobase_start_or_create_for_mysql(void)
 					srv_n_file_io_threads,
 					SRV_MAX_N_PENDING_SYNC_IOS);
 	} else {
-		os_aio_init(SRV_N_PENDING_IOS_PER_THREAD
+		os_aio_init(
+#ifdef LINUX_NATIVE_AIO
+			    srv_aio_queue_depth
+#else
+			    SRV_N_PENDING_IOS_PER_THREAD
+#endif
 						* srv_n_file_io_threads,
 					srv_n_file_io_threads,
 					SRV_MAX_N_PENDING_SYNC_IOS);
@@ -1571,6 +1601,20 @@ innobase_start_or_create_for_mysql(void)
 
 	os_thread_create(&srv_master_thread, NULL, thread_ids + 1 +
 							SRV_MAX_N_IO_THREADS);
+
+	/* Create the purge coordinator and worker threads, if the purge is
+	not left to the master thread */
+
+	if (srv_n_purge_threads > 0) {
+		os_thread_create(&srv_purge_thread, NULL, thread_ids + 5 +
+							SRV_MAX_N_IO_THREADS);
+
+		for (i = 1; i < srv_n_purge_threads; i++) {
+			os_thread_create(&srv_purge_worker_thread, NULL,
+					 thread_ids + 5 + i
+					 + SRV_MAX_N_IO_THREADS);
+		}
+	}
 #ifdef UNIV_DEBUG
 	/* buf_debug_prints = TRUE; */
 #endif /* UNIV_DEBUG */
@@ -1797,6 +1841,9 @@ innobase_shutdown_for_mysql(void)
 		/* c. We wake the master thread so that it exits */
 		srv_wake_master_thread();
 
+		/* c2. We wake the purge threads so that they exit */
+		srv_wake_purge_thread();
+
 		/* d. Exit the i/o threads */
 
 		os_aio_wake_all_threads_at_shutdown();
@@ -1114,6 +1114,10 @@ sync_thread_add_level(
 		ut_a(sync_thread_levels_g(array, SYNC_SEARCH_SYS));
 	} else if (level == SYNC_TRX_LOCK_HEAP) {
 		ut_a(sync_thread_levels_g(array, SYNC_TRX_LOCK_HEAP));
+	} else if (level == SYNC_TRX_SYS) {
+		ut_a(sync_thread_levels_g(array, SYNC_TRX_SYS));
+	} else if (level == SYNC_SRV_SYS) {
+		ut_a(sync_thread_levels_g(array, SYNC_SRV_SYS));
 	} else if (level == SYNC_REC_LOCK) {
 		ut_a((sync_thread_levels_contain(array, SYNC_KERNEL)
 			&& sync_thread_levels_g(array, SYNC_REC_LOCK - 1))
@@ -162,7 +162,9 @@ trx_purge_arr_get_biggest(
 
 /********************************************************************
 Builds a purge 'query' graph. The actual purge is performed by executing
-this query graph. */
+this query graph. The graph has a query thread for each purge thread, and
+the query threads fetch the undo log records to purge from the same purge
+pointer. */
 static
 que_t*
 trx_purge_graph_build(void)
@@ -172,19 +174,22 @@ trx_purge_graph_build(void)
 	mem_heap_t*	heap;
 	que_fork_t*	fork;
 	que_thr_t*	thr;
-/*	que_thr_t*	thr2; */
+	ulint		n_thrs;
+	ulint		i;
 	
+	n_thrs = ut_max(srv_n_purge_threads, 1);
+
+	ut_a(n_thrs <= SRV_MAX_N_PURGE_THREADS);
+
 	heap = mem_heap_create(512);
 	fork = que_fork_create(NULL, NULL, QUE_FORK_PURGE, heap);
 	fork->trx = purge_sys->trx;
 	
-	thr = que_thr_create(fork, heap);
-
-	thr->child = row_purge_node_create(thr, heap);  
+	for (i = 0; i < n_thrs; i++) {
+		thr = que_thr_create(fork, heap);
 
-/*	thr2 = que_thr_create(fork, fork, heap);
-
-	thr2->child = row_purge_node_create(fork, thr2, heap);   */
+		thr->child = row_purge_node_create(thr, heap);  
+	}
 
 	return(fork);
 }
@@ -206,6 +211,7 @@ trx_purge_sys_create(void)
 	purge_sys->state = TRX_STOP_PURGE;
 
 	purge_sys->n_pages_handled = 0;
+	purge_sys->n_recs_handled = 0;
 
 	purge_sys->purge_trx_no = ut_dulint_zero;
 	purge_sys->purge_undo_no = ut_dulint_zero;
@@ -217,6 +223,8 @@ trx_purge_sys_create(void)
 	mutex_create(&(purge_sys->mutex));
 	mutex_set_level(&(purge_sys->mutex), SYNC_PURGE_SYS);
 
+	purge_sys->event = os_event_create(NULL);
+
 	purge_sys->heap = mem_heap_create(256);
 
 	purge_sys->arr = trx_undo_arr_create();
@@ -230,9 +238,13 @@ trx_purge_sys_create(void)
 	ut_a(trx_start_low(purge_sys->trx, ULINT_UNDEFINED));
 
 	purge_sys->query = trx_purge_graph_build();
-				
+
+	mutex_enter(&(trx_sys->mutex));
+
 	purge_sys->view = read_view_oldest_copy_or_open_new(NULL,
 							purge_sys->heap);
+
+	mutex_exit(&(trx_sys->mutex));
 }
 
 /*================ UNDO LOG HISTORY LIST =============================*/
@@ -1006,6 +1018,10 @@ trx_purge_fetch_next_rec(
 	
 	undo_rec = trx_purge_get_next_rec(heap);
 
+	if (undo_rec != &trx_purge_dummy_rec) {
+		purge_sys->n_recs_handled++;
+	}
+
 	mutex_exit(&(purge_sys->mutex));
 
 	return(undo_rec);
@@ -1040,8 +1056,10 @@ trx_purge(void)
 				the batch */
 {
 	que_thr_t*	thr;
-/*	que_thr_t*	thr2; */
+	que_thr_t*	thr2;
+	ulint		n_thrs;
 	ulint		old_pages_handled;
+	ulint		i;
 
 	mutex_enter(&(purge_sys->mutex));
 
@@ -1058,7 +1076,7 @@ trx_purge(void)
 
 	rw_lock_x_lock(&(purge_sys->latch));
 
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
 
 	/* Close and free the old purge view */	
 
@@ -1092,15 +1110,18 @@ trx_purge(void)
 
 	purge_sys->view = read_view_oldest_copy_or_open_new(NULL,
 							purge_sys->heap);
-	mutex_exit(&kernel_mutex);	
+	mutex_exit(&(trx_sys->mutex));	
 
 	rw_lock_x_unlock(&(purge_sys->latch));
 
 	purge_sys->state = TRX_PURGE_ON;	
 	
-	/* Handle at most 20 undo log pages in one purge batch */
+	n_thrs = UT_LIST_GET_LEN(purge_sys->query->thrs);
+
+	/* Handle at most 20 undo log pages per query thread in one purge
+	batch */
 
-	purge_sys->handle_limit = purge_sys->n_pages_handled + 20;
+	purge_sys->handle_limit = purge_sys->n_pages_handled + 20 * n_thrs;
 
 	old_pages_handled = purge_sys->n_pages_handled;
 
@@ -1108,18 +1129,24 @@ trx_purge(void)
 
 	mutex_enter(&kernel_mutex);
 
+	os_event_reset(purge_sys->event);
+
 	thr = que_fork_start_command(purge_sys->query);
 
 	ut_ad(thr);
 	
-/*	thr2 = que_fork_start_command(purge_sys->query);
-	
-	ut_ad(thr2); */
+	/* The other query threads of the batch are run by the purge worker
+	threads */
+
+	for (i = 1; i < n_thrs; i++) {
+		thr2 = que_fork_start_command(purge_sys->query);
 	
+		ut_ad(thr2);
 
-	mutex_exit(&kernel_mutex);
+		srv_que_task_enqueue_low(thr2);
+	}
 
-/*	srv_que_task_enqueue(thr2); */
+	mutex_exit(&kernel_mutex);
 
 	if (srv_print_thread_releases) {
 	
@@ -1128,6 +1155,23 @@ trx_purge(void)
 
 	que_run_threads(thr);
 
+	/* Wait until the last query thread of the batch has completed: the
+	purge view must stay open until then */
+
+	os_event_wait(purge_sys->event);
+
+	if (n_thrs > 1) {
+		/* The query thread which ran out of records first could not
+		truncate the history while the others still had records
+		reserved */
+
+		mutex_enter(&(purge_sys->mutex));
+
+		trx_purge_truncate_if_arr_empty();
+
+		mutex_exit(&(purge_sys->mutex));
+	}
+
 	if (srv_print_thread_releases) {
 
 		fprintf(stderr,
@@ -128,6 +128,15 @@ trx_rollback_for_mysql(
 		return(DB_SUCCESS);
 	}
 
+	if (trx->read_only) {
+		/* A read-only transaction has made no changes: ending it
+		is the same as committing it */
+
+		trx_commit_for_mysql(trx);
+
+		return(DB_SUCCESS);
+	}
+
 	trx->op_info = "rollback";
 
 	/* If we are doing the XA recovery of prepared transactions, then
@@ -166,7 +175,7 @@ trx_rollback_last_sql_stat_for_mysql(
 {
 	int	err;
 
-	if (trx->conc_state == TRX_NOT_STARTED) {
+	if (trx->conc_state == TRX_NOT_STARTED || trx->read_only) {
 
 		return(DB_SUCCESS);
 	}
@@ -93,6 +93,10 @@ trx_doublewrite_init(
 	byte*	doublewrite)	/* in: pointer to the doublewrite buf
 				header on trx sys page */
 {
+	trx_doublewrite_region_t*	region;
+	ulint				n;
+	ulint				i;
+
 	trx_doublewrite = mem_alloc(sizeof(trx_doublewrite_t));
 
 	/* Since we now start to use the doublewrite buffer, no need to call
@@ -101,11 +105,6 @@ trx_doublewrite_init(
 	os_do_not_call_flush_at_each_write = TRUE;
 #endif /* UNIV_DO_FLUSH */
 
-	mutex_create(&(trx_doublewrite->mutex));
-	mutex_set_level(&(trx_doublewrite->mutex), SYNC_DOUBLEWRITE);
-
-	trx_doublewrite->first_free = 0;
-
 	trx_doublewrite->block1 = mach_read_from_4(
 						doublewrite
 						+ TRX_SYS_DOUBLEWRITE_BLOCK1);
@@ -123,6 +122,50 @@ trx_doublewrite_init(
 	trx_doublewrite->buf_block_arr = mem_alloc(
 					2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
 					* sizeof(void*));
+
+	/* Give the LRU and flush list batches of each buffer pool instance
+	a region of their own, if the maximum number of regions allows */
+
+	n = 2;
+
+	while (n < 2 * buf_pool->n_instances
+	       && n < TRX_SYS_DOUBLEWRITE_MAX_REGIONS) {
+
+		n *= 2;
+	}
+
+	trx_doublewrite->n_regions = n;
+
+	for (i = 0; i < n; i++) {
+		region = trx_doublewrite->regions + i;
+
+		mutex_create(&(region->mutex));
+		mutex_set_level(&(region->mutex), SYNC_DOUBLEWRITE);
+
+		mutex_create(&(region->pending_mutex));
+		mutex_set_level(&(region->pending_mutex), SYNC_ANY_LATCH);
+
+		region->size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE / n;
+
+		if (i < n / 2) {
+			region->page_no = trx_doublewrite->block1
+							+ i * region->size;
+		} else {
+			region->page_no = trx_doublewrite->block2
+						+ (i - n / 2) * region->size;
+		}
+
+		region->first_free = 0;
+		region->write_buf = trx_doublewrite->write_buf
+					+ i * region->size * UNIV_PAGE_SIZE;
+		region->buf_block_arr = trx_doublewrite->buf_block_arr
+							+ i * region->size;
+		region->must_flush = FALSE;
+
+		region->n_pending = 0;
+		region->no_pending = os_event_create(NULL);
+		os_event_set(region->no_pending);
+	}
 }
 
 /********************************************************************
@@ -328,6 +371,45 @@ start_again:
 	}
 }
 
+/********************************************************************
+Looks for the newest intact copy of a page in the doublewrite buffer pages
+which have been read to memory at a database startup. */
+static
+ulint
+trx_doublewrite_find_newest_copy(
+/*=============================*/
+				/* out: position of the intact copy with the
+				biggest lsn, or ULINT_UNDEFINED if there is
+				no intact copy of the page */
+	byte*	buf,		/* in: the doublewrite buffer pages */
+	ibool*	page_ok,	/* in: TRUE for the intact pages in buf */
+	ulint	space_id,	/* in: space id */
+	ulint	page_no)	/* in: page number */
+{
+	byte*	page;
+	ulint	newest		= ULINT_UNDEFINED;
+	dulint	newest_lsn	= ut_dulint_zero;
+	ulint	i;
+
+	for (i = 0; i < 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE; i++) {
+		page = buf + i * UNIV_PAGE_SIZE;
+
+		if (page_ok[i]
+		    && mach_read_from_4(page + FIL_PAGE_OFFSET) == page_no
+		    && mach_read_from_4(page
+				+ FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID) == space_id
+		    && (newest == ULINT_UNDEFINED
+			|| ut_dulint_cmp(mach_read_from_8(page + FIL_PAGE_LSN),
+					newest_lsn) > 0)) {
+
+			newest = i;
+			newest_lsn = mach_read_from_8(page + FIL_PAGE_LSN);
+		}
+	}
+
+	return(newest);
+}
+
 /********************************************************************
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
@@ -349,8 +431,11 @@ trx_sys_doublewrite_init_or_restore_pages(
 	ulint	source_page_no;
 	byte*	page;
 	byte*	doublewrite;
+	ibool*	page_ok;
+	ulint	n_pages;
 	ulint	space_id;
 	ulint	page_no;
+	ulint	newest;
 	ulint	i;
 	
 	/* We do the file i/o past the buffer pool */
@@ -405,18 +490,16 @@ trx_sys_doublewrite_init_or_restore_pages(
 			TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
 			buf + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
 			NULL);
-	/* Check if any of these pages is half-written in data files, in the
-	intended position */
+	n_pages = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
+
+	page_ok = ut_malloc(n_pages * sizeof(ibool));
 
 	page = buf;
 	
-	for (i = 0; i < TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * 2; i++) {
-		
-		page_no = mach_read_from_4(page + FIL_PAGE_OFFSET);
+	for (i = 0; i < n_pages; i++) {
 
 		if (trx_doublewrite_must_reset_space_ids) {
 
-		        space_id = 0;
 			mach_write_to_4(page
 					+ FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, 0);
 			/* We do not need to calculate new checksums for the
@@ -434,11 +517,30 @@ trx_sys_doublewrite_init_or_restore_pages(
 					      UNIV_PAGE_SIZE, page, NULL);
 			/* printf("Resetting space id in page %lu\n",
 						   source_page_no); */
-		} else {
-		        space_id = mach_read_from_4(
-				page + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
 		}
 
+		/* A page in the doublewrite buffer is corrupt if the
+		server crashed while the region holding it was written:
+		then the write of the page to the data file had not been
+		posted yet */
+
+		page_ok[i] = restore_corrupt_pages
+				&& !buf_page_is_corrupted(page);
+
+		page += UNIV_PAGE_SIZE;
+	}
+
+	/* Check if any of these pages is half-written in data files, in the
+	intended position */
+
+	page = buf;
+	
+	for (i = 0; i < n_pages; i++) {
+		
+		page_no = mach_read_from_4(page + FIL_PAGE_OFFSET);
+		space_id = mach_read_from_4(
+				page + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID);
+
 		if (!restore_corrupt_pages) {
 			/* The database was shut down gracefully: no need to
 			restore pages */
@@ -464,6 +566,13 @@ trx_sys_doublewrite_init_or_restore_pages(
 
 			/* It is an unwritten doublewrite buffer page:
 			do nothing */
+		} else if ((newest = trx_doublewrite_find_newest_copy(
+					buf, page_ok, space_id, page_no)) != i
+			   && newest != ULINT_UNDEFINED) {
+
+			/* Several regions of the doublewrite buffer may hold
+			a copy of the page: only the intact copy with the
+			biggest lsn can be needed */
 		} else {
 			/* Read in the actual page from the data files */
 			
@@ -479,7 +588,7 @@ trx_sys_doublewrite_init_or_restore_pages(
 		  		fprintf(stderr,
 		"InnoDB: Trying to recover it from the doublewrite buffer.\n");
 				
-				if (buf_page_is_corrupted(page)) {
+				if (!page_ok[i]) {
 					fprintf(stderr,
 		"InnoDB: Dump of the page:\n");
 					buf_page_print(read_buf);
@@ -511,6 +620,8 @@ trx_sys_doublewrite_init_or_restore_pages(
 		page += UNIV_PAGE_SIZE;
 	}
 
+	ut_free(page_ok);
+
 	fil_flush_file_spaces(FIL_TABLESPACE);
 	
 leave_func:
@@ -547,6 +658,118 @@ trx_in_trx_list(
 	return(FALSE);
 }
 
+/********************************************************************
+Looks for a trx id in trx_sys->active_ids. */
+
+ulint
+trx_sys_find_active_id(
+/*===================*/
+			/* out: position of the id in the array, or
+			ULINT_UNDEFINED if the transaction is not active */
+	dulint	trx_id)	/* in: trx id */
+{
+	ulint	low;
+	ulint	high;
+	ulint	mid;
+	int	cmp;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&kernel_mutex) || mutex_own(&(trx_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+
+	low = 0;
+	high = trx_sys->n_active_ids;
+
+	while (low < high) {
+		mid = (low + high) / 2;
+
+		cmp = ut_dulint_cmp(trx_id, trx_sys->active_ids[mid]);
+
+		if (cmp == 0) {
+
+			return(mid);
+		} else if (cmp > 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return(ULINT_UNDEFINED);
+}
+
+/********************************************************************
+Adds the id of a transaction which becomes active to
+trx_sys->active_ids. The caller must own both the kernel mutex and
+trx_sys->mutex. */
+
+void
+trx_sys_add_active_id(
+/*==================*/
+	dulint	trx_id)	/* in: trx id */
+{
+	dulint*	ids;
+	ulint	i;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+
+	if (trx_sys->n_active_ids == trx_sys->active_ids_size) {
+		ids = ut_malloc(2 * trx_sys->active_ids_size * sizeof(dulint));
+
+		ut_memcpy(ids, trx_sys->active_ids,
+				trx_sys->n_active_ids * sizeof(dulint));
+		ut_free(trx_sys->active_ids);
+
+		trx_sys->active_ids = ids;
+		trx_sys->active_ids_size *= 2;
+	}
+
+	/* A new transaction id is bigger than any id in the array: the
+	loop below only moves elements at the recovery of transactions */
+
+	i = trx_sys->n_active_ids;
+
+	while (i > 0
+	       && ut_dulint_cmp(trx_sys->active_ids[i - 1], trx_id) > 0) {
+
+		trx_sys->active_ids[i] = trx_sys->active_ids[i - 1];
+		i--;
+	}
+
+	trx_sys->active_ids[i] = trx_id;
+	trx_sys->n_active_ids++;
+}
+
+/********************************************************************
+Removes the id of a transaction which stops being active from
+trx_sys->active_ids. The caller must own both the kernel mutex and
+trx_sys->mutex. */
+
+void
+trx_sys_remove_active_id(
+/*=====================*/
+	dulint	trx_id)	/* in: trx id */
+{
+	ulint	i;
+
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
+#endif /* UNIV_SYNC_DEBUG */
+
+	i = trx_sys_find_active_id(trx_id);
+
+	ut_a(i != ULINT_UNDEFINED);
+
+	trx_sys->n_active_ids--;
+
+	ut_memmove(trx_sys->active_ids + i, trx_sys->active_ids + i + 1,
+			(trx_sys->n_active_ids - i) * sizeof(dulint));
+}
+
 /*********************************************************************
 Writes the value of max_trx_id to the file based trx system header. */
 
@@ -558,7 +781,7 @@ trx_sys_flush_max_trx_id(void)
 	mtr_t		mtr;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 
 	mtr_start(&mtr);
@@ -861,6 +1084,9 @@ trx_sys_init_at_db_start(void)
 	mutex_enter(&kernel_mutex);
 
 	trx_sys = mem_alloc(sizeof(trx_sys_t));
+
+	mutex_create(&(trx_sys->mutex));
+	mutex_set_level(&(trx_sys->mutex), SYNC_TRX_SYS);
 	
 	sys_header = trx_sysf_get(&mtr);
 
@@ -885,6 +1111,31 @@ trx_sys_init_at_db_start(void)
 	UT_LIST_INIT(trx_sys->mysql_trx_list);				
 	trx_lists_init_at_db_start();
 
+	trx_sys->active_ids_size = TRX_SYS_ACTIVE_IDS_INIT_SIZE;
+	trx_sys->active_ids = ut_malloc(trx_sys->active_ids_size
+						* sizeof(dulint));
+	trx_sys->n_active_ids = 0;
+
+	UT_LIST_INIT(trx_sys->serial_list);
+
+	mutex_enter(&(trx_sys->mutex));
+
+	/* trx_list is sorted on trx id, biggest first */
+
+	trx = UT_LIST_GET_LAST(trx_sys->trx_list);
+
+	while (trx != NULL) {
+		if (trx->conc_state == TRX_ACTIVE
+		    || trx->conc_state == TRX_PREPARED) {
+
+			trx_sys_add_active_id(trx->id);
+		}
+
+		trx = UT_LIST_GET_PREV(trx_list, trx);
+	}
+
+	mutex_exit(&(trx_sys->mutex));
+
 	if (UT_LIST_GET_LEN(trx_sys->trx_list) > 0) {
 		trx = UT_LIST_GET_FIRST(trx_sys->trx_list);
 
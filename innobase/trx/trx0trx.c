@@ -119,6 +119,7 @@ trx_create(
 
 	trx->id = ut_dulint_zero;
 	trx->no = ut_dulint_max;
+	trx->read_only = FALSE;
 
 	trx->support_xa = TRUE;
 
@@ -180,6 +181,7 @@ trx_create(
 
 	trx->dict_operation_lock_mode = 0;
 	trx->has_search_latch = FALSE;
+	trx->search_latch = NULL;
 	trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 
 	trx->declared_to_be_inside_innodb = FALSE;
@@ -267,7 +269,7 @@ trx_search_latch_release_if_reserved(
         trx_t*     trx) /* in: transaction */
 {
   	if (trx->has_search_latch) {
-    		rw_lock_s_unlock(&btr_search_latch);
+    		rw_lock_s_unlock(trx->search_latch);
 
     		trx->has_search_latch = FALSE;
   	}
@@ -621,7 +623,7 @@ trx_assign_rseg(void)
 	trx_rseg_t*	rseg	= trx_sys->latest_rseg;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(mutex_own(&(trx_sys->mutex)));
 #endif /* UNIV_SYNC_DEBUG */
 loop:
 	/* Get next rseg in a round-robin fashion */
@@ -660,7 +662,7 @@ trx_start_low(
 	trx_rseg_t*	rseg;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(mutex_own(&kernel_mutex));
+	ut_ad(trx->read_only || mutex_own(&kernel_mutex));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(trx->rseg == NULL);
 
@@ -673,6 +675,32 @@ trx_start_low(
 	}
 
 	ut_ad(trx->conc_state != TRX_ACTIVE);
+
+	if (trx->read_only) {
+		/* A read-only transaction writes no undo log and sets no
+		locks, so no other transaction needs to know about it: it
+		is not put to trx_list or to trx_sys->active_ids, and it
+		does not consume a transaction id. Its read view is still
+		put to the view list, because purge must respect it. */
+
+		mutex_enter(&(trx_sys->mutex));
+
+		trx->id = trx_sys->max_trx_id;
+
+		mutex_exit(&(trx_sys->mutex));
+
+		trx->no = ut_dulint_max;
+
+		trx->conc_state = TRX_ACTIVE;
+		trx->start_time = time(NULL);
+
+		return(TRUE);
+	}
+
+	/* The kernel mutex protects the trx list against the lock system,
+	the trx sys mutex against read views */
+
+	mutex_enter(&(trx_sys->mutex));
 	
 	if (rseg_id == ULINT_UNDEFINED) {
 
@@ -683,8 +711,8 @@ trx_start_low(
 
 	trx->id = trx_sys_get_new_trx_id();
 
-	/* The initial value for trx->no: ut_dulint_max is used in
-	read_view_open_now: */
+	/* The initial value for trx->no: the trx number is assigned in
+	the commit, when the trx is also put to trx_sys->serial_list */
 
 	trx->no = ut_dulint_max;
 
@@ -694,6 +722,9 @@ trx_start_low(
 	trx->start_time = time(NULL);
 
 	UT_LIST_ADD_FIRST(trx_list, trx_sys->trx_list, trx);
+	trx_sys_add_active_id(trx->id);
+
+	mutex_exit(&(trx_sys->mutex));
 
 	return(TRUE);
 }
@@ -711,6 +742,11 @@ trx_start(
 			automatically in a round-robin fashion */
 {
 	ibool	ret;
+
+	if (trx->read_only) {
+
+		return(trx_start_low(trx, rseg_id));
+	}
 	
 	mutex_enter(&kernel_mutex);
 
@@ -734,6 +770,7 @@ trx_commit_off_kernel(
 	trx_rseg_t*	rseg;
 	trx_undo_t*	undo;
 	ibool		must_flush_log	= FALSE;
+	ibool		serialised	= FALSE;
 	mtr_t		mtr;
 	
 #ifdef UNIV_SYNC_DEBUG
@@ -768,10 +805,17 @@ trx_commit_off_kernel(
 		undo = trx->update_undo;
 
 		if (undo) {
-			mutex_enter(&kernel_mutex);
+			mutex_enter(&(trx_sys->mutex));
 			trx->no = trx_sys_get_new_trx_no();
+
+			/* Until the trx is committed in memory, read views
+			take the limit for purge from its trx number */
+
+			UT_LIST_ADD_LAST(serial_list, trx_sys->serial_list,
+									trx);
+			serialised = TRUE;
 			
-			mutex_exit(&kernel_mutex);
+			mutex_exit(&(trx_sys->mutex));
 
 			/* It is not necessary to obtain trx->undo_mutex here
 			because only a single OS thread is allowed to do the
@@ -856,11 +900,19 @@ trx_commit_off_kernel(
 	flush fails, and T never gets committed, also T2 will never get
 	committed. */
 
+	mutex_enter(&(trx_sys->mutex));
+
 	/*--------------------------------------*/
 	trx->conc_state = TRX_COMMITTED_IN_MEMORY;
 	/*--------------------------------------*/
 
-	lock_release_off_kernel(trx);
+	if (!trx->read_only) {
+		trx_sys_remove_active_id(trx->id);
+	}
+
+	if (serialised) {
+		UT_LIST_REMOVE(serial_list, trx_sys->serial_list, trx);
+	}
 
 	if (trx->global_read_view) {
 		read_view_close(trx->global_read_view);
@@ -870,6 +922,10 @@ trx_commit_off_kernel(
 
 	trx->read_view = NULL;
 
+	mutex_exit(&(trx_sys->mutex));
+
+	lock_release_off_kernel(trx);
+
 	if (must_flush_log) {
 
 		mutex_exit(&kernel_mutex);
@@ -951,7 +1007,17 @@ trx_commit_off_kernel(
 	ut_ad(UT_LIST_GET_LEN(trx->wait_thrs) == 0);
 	ut_ad(UT_LIST_GET_LEN(trx->trx_locks) == 0);
 
+	if (trx->read_only) {
+		trx->read_only = FALSE;
+
+		return;
+	}
+
+	mutex_enter(&(trx_sys->mutex));
+
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+
+	mutex_exit(&(trx_sys->mutex));
 }
 
 /********************************************************************
@@ -969,12 +1035,18 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
+	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
+
 	trx->conc_state = TRX_NOT_STARTED;
 	trx->rseg = NULL;
 	trx->undo_no = ut_dulint_zero;
 	trx->last_sql_stat_start.least_undo_no = ut_dulint_zero;
 
 	UT_LIST_REMOVE(trx_list, trx_sys->trx_list, trx);
+
+	mutex_exit(&(trx_sys->mutex));
+	mutex_exit(&kernel_mutex);
 }
 
 /************************************************************************
@@ -994,7 +1066,7 @@ trx_assign_read_view(
 		return(trx->read_view);
 	}
 	
-	mutex_enter(&kernel_mutex);
+	mutex_enter(&(trx_sys->mutex));
 
 	if (!trx->read_view) {
 		trx->read_view = read_view_open_now(trx,
@@ -1002,7 +1074,7 @@ trx_assign_read_view(
 		trx->global_read_view = trx->read_view;
 	}
 
-	mutex_exit(&kernel_mutex);
+	mutex_exit(&(trx_sys->mutex));
 	
 	return(trx->read_view);
 }
@@ -1624,6 +1696,33 @@ trx_commit_for_mysql(
 
 	trx_start_if_not_started(trx);
 
+	if (trx->read_only) {
+		/* A read-only transaction has no undo logs, locks or
+		place in trx_list: it is enough to close its read view,
+		and the kernel mutex is not needed */
+
+		mutex_enter(&(trx_sys->mutex));
+
+		if (trx->global_read_view) {
+			read_view_close(trx->global_read_view);
+			mem_heap_empty(trx->global_read_view_heap);
+			trx->global_read_view = NULL;
+		}
+
+		trx->read_view = NULL;
+
+		mutex_exit(&(trx_sys->mutex));
+
+		trx_roll_savepoints_free(trx, NULL);
+
+		trx->conc_state = TRX_NOT_STARTED;
+		trx->read_only = FALSE;
+
+		trx->op_info = "";
+
+		return(0);
+	}
+
 	mutex_enter(&kernel_mutex);
 
 	trx_commit_off_kernel(trx);
@@ -1946,6 +2045,15 @@ trx_prepare_for_mysql(
 	
 	trx_start_if_not_started(trx);
 
+	if (trx->read_only) {
+		/* There is nothing to prepare in a read-only
+		transaction */
+
+		trx->op_info = "";
+
+		return(0);
+	}
+
 	mutex_enter(&kernel_mutex);
 
 	trx_prepare_off_kernel(trx);
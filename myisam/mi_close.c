@@ -36,7 +36,16 @@ int mi_close(register MI_INFO *info)
     info->lock_type=F_UNLCK;			/* HA_EXTRA_NO_USER_CHANGE */
 
   if (share->reopen == 1 && share->kfile >= 0)
+  {
+    if (share->compact_deleted && !share->tot_locks)
+    {
+      pthread_mutex_lock(&share->intern_lock);
+      share->compact_deleted= 0;
+      VOID(mi_compact_deleted(info));
+      pthread_mutex_unlock(&share->intern_lock);
+    }
     _mi_decrement_open_count(info);
+  }
 
   if (info->lock_type != F_UNLCK)
   {
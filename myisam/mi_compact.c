@@ -0,0 +1,291 @@
+/* Copyright (C) 2008 MySQL AB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Compaction of the chain of deleted rows.
+
+  With myisam_concurrent_insert == 2 rows inserted while other threads
+  read the table are put at the end of the data file and the holes of
+  deleted rows are left alone.  mi_write() marks such tables and when they
+  are not used any more the server calls mi_compact_deleted_chains() from
+  a background thread; the last mi_close() of a marked table does the same
+  for it.  It sorts the deleted rows on their position in the
+  data file, joins adjacent deleted blocks and cuts off deleted space at
+  the end of the file.  Later inserts that reuse holes then fill the data
+  file from the start.
+*/
+
+#include "myisamdef.h"
+
+typedef struct st_mi_hole
+{
+  my_off_t pos;
+  ulong length;
+  my_off_t next, prev;                          /* Links on disk */
+  my_bool joined;                               /* Length has changed */
+} MI_HOLE;
+
+
+static int cmp_hole(const void *a, const void *b)
+{
+  my_off_t pos_a= ((const MI_HOLE*) a)->pos, pos_b= ((const MI_HOLE*) b)->pos;
+  return pos_a < pos_b ? -1 : pos_a > pos_b ? 1 : 0;
+}
+
+
+/*
+  Read the chain of deleted rows of a table
+
+  RETURN
+    0  ok, *count holes are in holes[]
+    1  the chain is broken (more links than state.del or not a deleted row)
+*/
+
+static int read_deleted_chain(MI_INFO *info, MI_HOLE *holes, ha_rows *count)
+{
+  MYISAM_SHARE *share=info->s;
+  my_off_t pos;
+  ha_rows found= 0;
+  DBUG_ENTER("read_deleted_chain");
+
+  for (pos= share->state.dellink ; pos != HA_OFFSET_ERROR ; )
+  {
+    MI_HOLE *hole= holes + found;
+    if (found++ == share->state.state.del)
+      DBUG_RETURN(1);
+    hole->pos= pos;
+    hole->joined= 0;
+    if (share->options & HA_OPTION_PACK_RECORD)
+    {
+      MI_BLOCK_INFO block_info;
+      block_info.second_read= 0;
+      if (!(_mi_get_block_info(&block_info, info->dfile, pos) &
+            BLOCK_DELETED))
+        DBUG_RETURN(1);
+      hole->length= block_info.block_len;
+      hole->next= block_info.next_filepos;
+      hole->prev= block_info.prev_filepos;
+    }
+    else
+    {
+      uchar temp[9];                            /* 1+sizeof(uint32) */
+      if (my_pread(info->dfile, (char*) temp, 1+share->base.rec_reflength,
+                   pos, MYF(MY_NABP)) || temp[0])
+        DBUG_RETURN(1);
+      hole->length= share->base.pack_reclength;
+      hole->next= _mi_rec_pos(share, temp+1);
+    }
+    pos= hole->next;
+  }
+  *count= found;
+  DBUG_RETURN(found != share->state.state.del);
+}
+
+
+/* Test if the header of holes[i] must be written to link holes[] in order */
+
+static my_bool hole_changed(MYISAM_SHARE *share, MI_HOLE *holes, ha_rows i,
+                            ha_rows count)
+{
+  MI_HOLE *hole= holes + i;
+  if (hole->next != (i+1 < count ? hole[1].pos : HA_OFFSET_ERROR))
+    return 1;
+  return ((share->options & HA_OPTION_PACK_RECORD) &&
+          (hole->joined || hole->prev != (i ? hole[-1].pos : HA_OFFSET_ERROR)));
+}
+
+
+/* Write the changed links of the deleted rows in the order of holes[] */
+
+static int write_deleted_chain(MI_INFO *info, MI_HOLE *holes, ha_rows count)
+{
+  MYISAM_SHARE *share=info->s;
+  ha_rows i;
+  DBUG_ENTER("write_deleted_chain");
+
+  for (i= 0 ; i < count ; i++)
+  {
+    MI_HOLE *hole= holes + i;
+    my_off_t next= i+1 < count ? hole[1].pos : HA_OFFSET_ERROR;
+    if (!hole_changed(share, holes, i, count))
+      continue;
+    if (share->options & HA_OPTION_PACK_RECORD)
+    {
+      uchar header[MI_DYN_DELETE_BLOCK_HEADER];
+      header[0]= 0;
+      mi_int3store(header+1, hole->length);
+      mi_sizestore(header+4, next);
+      mi_sizestore(header+12, i ? hole[-1].pos : HA_OFFSET_ERROR);
+      if (my_pwrite(info->dfile, (byte*) header, sizeof(header), hole->pos,
+                    MYF(MY_NABP)))
+        DBUG_RETURN(1);
+    }
+    else
+    {
+      uchar temp[9];                            /* 1+sizeof(uint32) */
+      temp[0]= 0;
+      _mi_dpointer(info, temp+1, next);
+      if (my_pwrite(info->dfile, (byte*) temp, 1+share->base.rec_reflength,
+                    hole->pos, MYF(MY_NABP)))
+        DBUG_RETURN(1);
+    }
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Compact the chain of deleted rows of a table
+
+  SYNOPSIS
+    mi_compact_deleted()
+    info		Any handler of the table
+
+  NOTES
+    The caller must hold share->intern_lock and no handler of the table
+    may have it locked.
+
+  RETURN
+    0      ok (or nothing to do)
+    #      error number; the table is marked as crashed if the chain
+           couldn't be written
+*/
+
+int mi_compact_deleted(MI_INFO *info)
+{
+  MYISAM_SHARE *share=info->s;
+  MI_HOLE *holes, *from, *to, *end;
+  ha_rows count, i;
+  my_off_t data_file_length= share->state.state.data_file_length;
+  int error= 0;
+  DBUG_ENTER("mi_compact_deleted");
+
+  if ((share->options & (HA_OPTION_COMPRESS_RECORD | HA_OPTION_READ_ONLY_DATA |
+                         HA_OPTION_TMP_TABLE)) ||
+      !myisam_single_user || share->kfile < 0 ||
+      share->state.dellink == HA_OFFSET_ERROR ||
+      share->state.state.del > MI_MAX_COMPACT_DELETED)
+    DBUG_RETURN(0);
+  if (!(holes= (MI_HOLE*) my_malloc((uint) share->state.state.del *
+                                    sizeof(MI_HOLE), MYF(0))))
+    DBUG_RETURN(0);                             /* Try again later */
+
+  if (read_deleted_chain(info, holes, &count))
+  {
+    error= HA_ERR_WRONG_IN_RECORD;
+    goto err;
+  }
+  info->rec_cache.seek_not_done=1;		/* We have done a seek */
+  qsort((void*) holes, (size_t) count, sizeof(MI_HOLE), cmp_hole);
+
+  /* Join adjacent deleted blocks of dynamic rows */
+  end= holes + count;
+  for (from= to= holes ; from < end ; from++)
+  {
+    if (to != from && (share->options & HA_OPTION_PACK_RECORD) &&
+        to[-1].pos + to[-1].length == from->pos &&
+        to[-1].length + from->length < MI_DYN_MAX_BLOCK_LENGTH)
+    {
+      to[-1].length+= from->length;
+      to[-1].joined= 1;
+      continue;
+    }
+    *to++= *from;
+  }
+  /* Cut off deleted space at the end of the data file */
+  while (to > holes && to[-1].pos + to[-1].length == data_file_length)
+  {
+    to--;
+    data_file_length= to->pos;
+  }
+  count= (ha_rows) (to - holes);
+
+  if (data_file_length == share->state.state.data_file_length &&
+      holes[0].pos == share->state.dellink)
+  {
+    for (i= 0 ; i < count && !hole_changed(share, holes, i, count) ; i++) ;
+    if (i == count)
+      goto end;                                 /* Already compact */
+  }
+
+  DBUG_PRINT("info",("deleted: %lu -> %lu  data_file_length: %lu -> %lu",
+                     (ulong) share->state.state.del, (ulong) count,
+                     (ulong) share->state.state.data_file_length,
+                     (ulong) data_file_length));
+  if (_mi_mark_file_changed(info) ||
+      write_deleted_chain(info, holes, count))
+  {
+    error= my_errno;
+    goto err;
+  }
+  share->state.state.empty-= (share->state.state.data_file_length -
+                              data_file_length);
+  share->state.state.del= count;
+  share->state.dellink= count ? holes[0].pos : HA_OFFSET_ERROR;
+  if (data_file_length != share->state.state.data_file_length)
+  {
+    share->state.state.data_file_length= data_file_length;
+    if (my_chsize(info->dfile, data_file_length, 0, MYF(MY_WME)))
+      error= my_errno;
+  }
+  if (mi_state_info_write(share->kfile, &share->state, 1))
+    error= my_errno;
+  if (error)
+    goto err;
+
+end:
+  my_free((gptr) holes, MYF(0));
+  DBUG_RETURN(0);
+
+err:
+  my_free((gptr) holes, MYF(0));
+  mi_print_error(share, HA_ERR_CRASHED);
+  mi_mark_crashed(info);
+  DBUG_RETURN(error ? error : HA_ERR_CRASHED);
+}
+
+
+/*
+  Compact the deleted rows of all tables where mi_write() left holes
+
+  NOTES
+    Called by a background thread.  Tables that are locked again are
+    skipped; they are marked and are done after their next unlock.
+*/
+
+void mi_compact_deleted_chains(void)
+{
+  LIST *list_element;
+  DBUG_ENTER("mi_compact_deleted_chains");
+
+  pthread_mutex_lock(&THR_LOCK_myisam);
+  for (list_element=myisam_open_list ; list_element ;
+       list_element=list_element->next)
+  {
+    MI_INFO *info=(MI_INFO*) list_element->data;
+    MYISAM_SHARE *share=info->s;
+    if (!share->compact_deleted)
+      continue;
+    pthread_mutex_lock(&share->intern_lock);
+    if (!share->tot_locks)
+    {
+      share->compact_deleted= 0;
+      VOID(mi_compact_deleted(info));
+    }
+    pthread_mutex_unlock(&share->intern_lock);
+  }
+  pthread_mutex_unlock(&THR_LOCK_myisam);
+  DBUG_VOID_RETURN;
+}
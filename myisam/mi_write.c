@@ -70,6 +70,8 @@ int mi_write(MI_INFO *info, byte *record)
              !info->append_insert_at_end) ?
 	    share->state.dellink :
 	    info->state->data_file_length);
+  if (info->append_insert_at_end && share->state.dellink != HA_OFFSET_ERROR)
+    share->compact_deleted= 1;		/* See mi_compact_deleted_chains() */
 
   if (share->base.reloc == (ha_rows) 1 &&
       share->base.records == (ha_rows) 1 &&
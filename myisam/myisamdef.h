@@ -202,7 +202,8 @@ typedef struct st_mi_isam_share {	/* Shared between opens */
     global_changed,			/* If changed since open */
     not_flushed,
     temporary,delay_key_write,
-    concurrent_insert;
+    concurrent_insert,
+    compact_deleted;			/* Inserts skipped deleted rows */
 #ifdef THREAD
   THR_LOCK lock;
   pthread_mutex_t intern_lock;		/* Locking for use with _locking */
@@ -444,6 +445,7 @@ typedef struct st_mi_sort_param
 #define MI_MIN_ROWS_TO_USE_BULK_INSERT 100
 #define MI_MIN_ROWS_TO_DISABLE_INDEXES 100
 #define MI_MIN_ROWS_TO_USE_WRITE_CACHE 10
+#define MI_MAX_COMPACT_DELETED	65536L	/* Longest chain mi_compact sorts */
 
 /* The UNIQUE check is done with a hashed long key */
 
@@ -731,6 +733,7 @@ int _mi_cmp_dynamic_unique(MI_INFO *info, MI_UNIQUEDEF *def,
 int mi_unique_comp(MI_UNIQUEDEF *def, const byte *a, const byte *b,
 		   my_bool null_are_equal);
 void mi_get_status(void* param, int concurrent_insert);
+int mi_compact_deleted(MI_INFO *info);
 void mi_update_status(void* param);
 void mi_restore_status(void* param);
 void mi_copy_status(void* to,void *from);
@@ -36,6 +36,14 @@
   blocks_unused is the sum of never used blocks in the pool and of currently
   free blocks. blocks_used is the number of blocks fetched from the pool and
   as such gives the maximum number of in-use blocks at any time.
+
+  A key cache can be split into segments (param_segments > 0). Each
+  segment is a complete key cache of its own, with its own hash, LRU
+  chain, lists of changed blocks and cache_lock. A key cache block is kept
+  in the segment selected by KEYCACHE_SEGMENT() from the file and the
+  number of the block, so threads using different blocks mostly lock
+  different mutexes. The public functions below pass requests for a
+  segmented key cache on to its segments block by block.
 */
 
 #include "mysys_priv.h"
@@ -160,6 +168,29 @@ KEY_CACHE *dflt_key_cache= &dflt_key_cache_var;
 #define FLUSH_CACHE         2000            /* sort this many blocks at once */
 
 static int flush_all_key_blocks(KEY_CACHE *keycache);
+static int init_simple_key_cache(KEY_CACHE *keycache,
+                                 uint key_cache_block_size,
+                                 size_t use_mem, uint division_limit,
+                                 uint age_threshold);
+static int init_key_cache_segments(KEY_CACHE *keycache,
+                                   uint key_cache_block_size,
+                                   size_t use_mem, uint division_limit,
+                                   uint age_threshold);
+static int resize_key_cache_segments(KEY_CACHE *keycache,
+                                     uint key_cache_block_size,
+                                     size_t use_mem, uint division_limit,
+                                     uint age_threshold);
+static byte *key_cache_segments_read(KEY_CACHE *keycache, uint segments,
+                                     File file, my_off_t filepos, int level,
+                                     byte *buff, uint length,
+                                     uint block_length);
+static int key_cache_segments_insert(KEY_CACHE *keycache, uint segments,
+                                     File file, my_off_t filepos, int level,
+                                     byte *buff, uint length);
+static int key_cache_segments_write(KEY_CACHE *keycache, uint segments,
+                                    File file, my_off_t filepos, int level,
+                                    byte *buff, uint length,
+                                    uint block_length, int dont_write);
 #ifdef THREAD
 static void link_into_queue(KEYCACHE_WQUEUE *wqueue,
                                    struct st_my_thread_var *thread);
@@ -176,6 +207,8 @@ static void test_key_cache(KEY_CACHE *keycache,
 (((ulong) ((pos) / keycache->key_cache_block_size) +                          \
                                      (ulong) (f)) & (keycache->hash_entries-1))
 #define FILE_HASH(f)                 ((uint) (f) & (CHANGED_BLOCKS_HASH-1))
+#define KEYCACHE_SEGMENT(f, pos, block_size, segments)                        \
+(((ulong) ((pos) / (block_size)) + (ulong) (f)) % (segments))
 
 #define DEFAULT_KEYCACHE_DEBUG_LOG  "keycache_debug.log"
 
@@ -263,6 +296,24 @@ static int keycache_pthread_cond_signal(pthread_cond_t *cond);
 #define keycache_pthread_cond_signal pthread_cond_signal
 #endif /* defined(KEYCACHE_DEBUG) */
 
+/*
+  Lock the key cache, counting the times the lock was held by another
+  thread in global_cache_lock_waits
+*/
+
+static inline void lock_key_cache(KEY_CACHE *keycache)
+{
+#if defined(THREAD) && !defined(KEYCACHE_DEBUG)
+  if (pthread_mutex_trylock(&keycache->cache_lock))
+  {
+    keycache_pthread_mutex_lock(&keycache->cache_lock);
+    keycache->global_cache_lock_waits++;
+  }
+#else
+  keycache_pthread_mutex_lock(&keycache->cache_lock);
+#endif
+}
+
 static uint next_power(uint value)
 {
   uint old_value= 1;
@@ -276,10 +327,10 @@ static uint next_power(uint value)
 
 
 /*
-  Initialize a key cache
+  Initialize a key cache that is not split into segments
 
   SYNOPSIS
-    init_key_cache()
+    init_simple_key_cache()
     keycache			pointer to a key cache data structure
     key_cache_block_size	size of blocks to keep cached data
     use_mem                 	total memory to use for the key cache
@@ -300,14 +351,15 @@ static uint next_power(uint value)
 
 */
 
-int init_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
-                   size_t use_mem, uint division_limit,
-                   uint age_threshold)
+static int init_simple_key_cache(KEY_CACHE *keycache,
+                                 uint key_cache_block_size,
+                                 size_t use_mem, uint division_limit,
+                                 uint age_threshold)
 {
   ulong blocks, hash_links;
   size_t length;
   int error;
-  DBUG_ENTER("init_key_cache");
+  DBUG_ENTER("init_simple_key_cache");
   DBUG_ASSERT(key_cache_block_size >= 512);
 
   KEYCACHE_DEBUG_OPEN;
@@ -319,6 +371,7 @@ int init_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
 
   keycache->global_cache_w_requests= keycache->global_cache_r_requests= 0;
   keycache->global_cache_read= keycache->global_cache_write= 0;
+  keycache->global_cache_lock_waits= 0;
   keycache->disk_blocks= -1;
   if (! keycache->key_cache_inited)
   {
@@ -452,10 +505,43 @@ err:
 
 
 /*
-  Resize a key cache
+  Initialize a key cache
 
   SYNOPSIS
-    resize_key_cache()
+    init_key_cache()
+    keycache			pointer to a key cache data structure
+    key_cache_block_size	size of blocks to keep cached data
+    use_mem                 	total memory to use for the key cache
+    division_limit		division limit (may be zero)
+    age_threshold		age threshold (may be zero)
+
+  RETURN VALUE
+    number of blocks in the key cache, if successful,
+    0 - otherwise.
+
+  NOTES.
+    If keycache->param_segments is not 0 the key cache is split into
+    that many segments, each of them getting an equal part of use_mem.
+    See init_simple_key_cache() for the rest.
+*/
+
+int init_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
+                   size_t use_mem, uint division_limit,
+                   uint age_threshold)
+{
+  if (keycache->param_segments)
+    return init_key_cache_segments(keycache, key_cache_block_size, use_mem,
+                                   division_limit, age_threshold);
+  return init_simple_key_cache(keycache, key_cache_block_size, use_mem,
+                               division_limit, age_threshold);
+}
+
+
+/*
+  Resize a key cache that is not split into segments
+
+  SYNOPSIS
+    resize_simple_key_cache()
     keycache     	        pointer to a key cache data structure
     key_cache_block_size        size of blocks to keep cached data
     use_mem			total memory to use for the new key cache
@@ -473,21 +559,22 @@ err:
     If they differ the function free the the memory allocated for the
     old key cache blocks by calling the end_key_cache function and
     then rebuilds the key cache with new blocks by calling
-    init_key_cache.
+    init_simple_key_cache.
 
     The function starts the operation only when all other threads
     performing operations with the key cache let her to proceed
     (when cnt_for_resize=0).
 */
 
-int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
-                     size_t use_mem, uint division_limit,
-                     uint age_threshold)
+static int resize_simple_key_cache(KEY_CACHE *keycache,
+                                   uint key_cache_block_size,
+                                   size_t use_mem, uint division_limit,
+                                   uint age_threshold)
 {
   int blocks;
   struct st_my_thread_var *thread;
   KEYCACHE_WQUEUE *wqueue;
-  DBUG_ENTER("resize_key_cache");
+  DBUG_ENTER("resize_simple_key_cache");
 
   if (!keycache->key_cache_inited)
     DBUG_RETURN(keycache->disk_blocks);
@@ -536,8 +623,8 @@ int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
 
   end_key_cache(keycache, 0);			/* Don't free mutex */
   /* The following will work even if use_mem is 0 */
-  blocks= init_key_cache(keycache, key_cache_block_size, use_mem,
-			 division_limit, age_threshold);
+  blocks= init_simple_key_cache(keycache, key_cache_block_size, use_mem,
+                                division_limit, age_threshold);
 
 finish:
 #ifdef THREAD
@@ -555,6 +642,41 @@ finish:
 }
 
 
+/*
+  Resize a key cache
+
+  SYNOPSIS
+    resize_key_cache()
+    keycache     	        pointer to a key cache data structure
+    key_cache_block_size        size of blocks to keep cached data
+    use_mem			total memory to use for the new key cache
+    division_limit		new division limit (if not zero)
+    age_threshold		new age threshold (if not zero)
+
+  RETURN VALUE
+    number of blocks in the key cache, if successful,
+    0 - otherwise.
+
+  NOTES.
+    A key cache that is segmented or has to become segmented (or stop
+    being segmented) because param_segments was changed is rebuilt by
+    resize_key_cache_segments().
+*/
+
+int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
+                     size_t use_mem, uint division_limit,
+                     uint age_threshold)
+{
+  if (!keycache->key_cache_inited)
+    return keycache->disk_blocks;
+  if (keycache->segments || keycache->param_segments)
+    return resize_key_cache_segments(keycache, key_cache_block_size, use_mem,
+                                     division_limit, age_threshold);
+  return resize_simple_key_cache(keycache, key_cache_block_size, use_mem,
+                                 division_limit, age_threshold);
+}
+
+
 /*
   Increment counter blocking resize key cache operation
 */
@@ -605,8 +727,16 @@ static inline void dec_counter_for_resize_op(KEY_CACHE *keycache)
 void change_key_cache_param(KEY_CACHE *keycache, uint division_limit,
 			    uint age_threshold)
 {
+  uint i, segments;
   DBUG_ENTER("change_key_cache_param");
 
+  if ((segments= keycache->segments))
+  {
+    for (i= 0; i < segments; i++)
+      change_key_cache_param(keycache->segment + i, division_limit,
+                             age_threshold);
+    DBUG_VOID_RETURN;
+  }
   keycache_pthread_mutex_lock(&keycache->cache_lock);
   if (division_limit)
     keycache->min_warm_blocks= (keycache->disk_blocks *
@@ -639,6 +769,20 @@ void end_key_cache(KEY_CACHE *keycache, my_bool cleanup)
   if (!keycache->key_cache_inited)
     DBUG_VOID_RETURN;
 
+  if (keycache->segment)
+  {
+    uint i;
+    keycache->segments= 0;
+    keycache->can_be_used= 0;
+    for (i= 0; i < KEY_CACHE_MAX_SEGMENTS; i++)
+      end_key_cache(keycache->segment + i, cleanup);
+    if (cleanup)
+    {
+      my_free((gptr) keycache->segment, MYF(0));
+      keycache->segment= NULL;
+    }
+  }
+
   if (keycache->disk_blocks > 0)
   {
     if (keycache->block_mem)
@@ -1793,12 +1937,16 @@ byte *key_cache_read(KEY_CACHE *keycache,
 		     int return_buffer __attribute__((unused)))
 {
   int error=0;
-  uint offset= 0;
+  uint offset= 0, segments;
   byte *start= buff;
   DBUG_ENTER("key_cache_read");
   DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
                (uint) file, (ulong) filepos, length));
 
+  if ((segments= keycache->segments))
+    DBUG_RETURN(key_cache_segments_read(keycache, segments, file, filepos,
+                                        level, buff, length, block_length));
+
   if (keycache->can_be_used)
   {
     /* Key cache is used */
@@ -1811,7 +1959,7 @@ byte *key_cache_read(KEY_CACHE *keycache,
     /* Read data in key_cache_block_size increments */
     do
     {
-      keycache_pthread_mutex_lock(&keycache->cache_lock);
+      lock_key_cache(keycache);
       if (!keycache->can_be_used)
       {
 	keycache_pthread_mutex_unlock(&keycache->cache_lock);
@@ -1933,10 +2081,15 @@ int key_cache_insert(KEY_CACHE *keycache,
                      File file, my_off_t filepos, int level,
                      byte *buff, uint length)
 {
+  uint segments;
   DBUG_ENTER("key_cache_insert");
   DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
                (uint) file,(ulong) filepos, length));
 
+  if ((segments= keycache->segments))
+    DBUG_RETURN(key_cache_segments_insert(keycache, segments, file, filepos,
+                                          level, buff, length));
+
   if (keycache->can_be_used)
   {
     /* Key cache is used */
@@ -1949,7 +2102,7 @@ int key_cache_insert(KEY_CACHE *keycache,
     offset= (uint) (filepos % keycache->key_cache_block_size);
     do
     {
-      keycache_pthread_mutex_lock(&keycache->cache_lock);
+      lock_key_cache(keycache);
       if (!keycache->can_be_used)
       {
 	keycache_pthread_mutex_unlock(&keycache->cache_lock);
@@ -2055,12 +2208,18 @@ int key_cache_write(KEY_CACHE *keycache,
 {
   reg1 BLOCK_LINK *block;
   int error=0;
+  uint segments;
   DBUG_ENTER("key_cache_write");
   DBUG_PRINT("enter",
 	     ("fd: %u  pos: %lu  length: %u  block_length: %u  key_block_length: %u",
 	      (uint) file, (ulong) filepos, length, block_length,
 	      keycache ? keycache->key_cache_block_size : 0));
 
+  if ((segments= keycache->segments))
+    DBUG_RETURN(key_cache_segments_write(keycache, segments, file, filepos,
+                                         level, buff, length, block_length,
+                                         dont_write));
+
   if (!dont_write)
   {
     /* Force writing from buff into disk */
@@ -2084,7 +2243,7 @@ int key_cache_write(KEY_CACHE *keycache,
     offset= (uint) (filepos % keycache->key_cache_block_size);
     do
     {
-      keycache_pthread_mutex_lock(&keycache->cache_lock);
+      lock_key_cache(keycache);
       if (!keycache->can_be_used)
       {
 	keycache_pthread_mutex_unlock(&keycache->cache_lock);
@@ -2544,12 +2703,19 @@ int flush_key_blocks(KEY_CACHE *keycache,
                      File file, enum flush_type type)
 {
   int res;
+  uint i, segments;
   DBUG_ENTER("flush_key_blocks");
   DBUG_PRINT("enter", ("keycache: 0x%lx", (long) keycache));
 
+  if ((segments= keycache->segments))
+  {
+    for (res= 0, i= 0; i < segments; i++)
+      res|= flush_key_blocks(keycache->segment + i, file, type);
+    DBUG_RETURN(res);
+  }
   if (keycache->disk_blocks <= 0)
     DBUG_RETURN(0);
-  keycache_pthread_mutex_lock(&keycache->cache_lock);
+  lock_key_cache(keycache);
   inc_counter_for_resize_op(keycache);
   res= flush_key_blocks_int(keycache, file, type);
   dec_counter_for_resize_op(keycache);
@@ -2623,10 +2789,323 @@ int reset_key_cache_counters(const char *name __attribute__((unused)),
   key_cache->global_cache_read= 0;       /* Key_reads */
   key_cache->global_cache_w_requests= 0; /* Key_write_requests */
   key_cache->global_cache_write= 0;      /* Key_writes */
+  key_cache->global_cache_lock_waits= 0; /* Key_lock_waits */
+  if (key_cache->segments)
+  {
+    uint i;
+    for (i= 0; i < key_cache->segments; i++)
+      reset_key_cache_counters(name, key_cache->segment + i);
+  }
   DBUG_RETURN(0);
 }
 
 
+/*
+  Sum the counters of the segments of a key cache
+
+  SYNOPSIS
+    sum_key_cache_counters()
+    keycache   pointer to the key cache
+
+  DESCRIPTION
+    The blocks and the statistics of a segmented key cache are kept in its
+    segments. This function sets the counters of the key cache itself to
+    their sums, so that they can be reported as for a key cache that is
+    not segmented. It does nothing for a key cache without segments.
+*/
+
+void sum_key_cache_counters(KEY_CACHE *keycache)
+{
+  ulong blocks_used= 0, blocks_unused= 0, blocks_changed= 0;
+  ulonglong w_requests= 0, writes= 0, r_requests= 0, reads= 0, lock_waits= 0;
+  uint i, segments;
+
+  if (!(segments= keycache->segments))
+    return;
+  for (i= 0; i < segments; i++)
+  {
+    KEY_CACHE *segment= keycache->segment + i;
+    blocks_used+=    segment->blocks_used;
+    blocks_unused+=  segment->blocks_unused;
+    blocks_changed+= segment->global_blocks_changed;
+    w_requests+=     segment->global_cache_w_requests;
+    writes+=         segment->global_cache_write;
+    r_requests+=     segment->global_cache_r_requests;
+    reads+=          segment->global_cache_read;
+    lock_waits+=     segment->global_cache_lock_waits;
+  }
+  keycache->blocks_used=             blocks_used;
+  keycache->blocks_unused=           blocks_unused;
+  keycache->global_blocks_changed=   blocks_changed;
+  keycache->global_cache_w_requests= w_requests;
+  keycache->global_cache_write=      writes;
+  keycache->global_cache_r_requests= r_requests;
+  keycache->global_cache_read=       reads;
+  keycache->global_cache_lock_waits= lock_waits;
+}
+
+
+/*
+  Initialize a segmented key cache
+
+  SYNOPSIS
+    init_key_cache_segments()
+    keycache			pointer to a key cache data structure
+    key_cache_block_size	size of blocks to keep cached data
+    use_mem                 	total memory to use for all segments
+    division_limit		division limit (may be zero)
+    age_threshold		age threshold (may be zero)
+
+  RETURN VALUE
+    number of blocks in all segments, if successful,
+    0 - otherwise.
+
+  NOTES.
+    The array of segments is allocated for KEY_CACHE_MAX_SEGMENTS
+    segments the first time the key cache is segmented. It is freed only
+    by end_key_cache(keycache, 1), as other threads may still be working
+    with a segment while the key cache is resized.
+    A segment that gets too little memory is not used: the requests for
+    its blocks go directly to the file.
+*/
+
+static int init_key_cache_segments(KEY_CACHE *keycache,
+                                   uint key_cache_block_size,
+                                   size_t use_mem, uint division_limit,
+                                   uint age_threshold)
+{
+  uint i, segments;
+  int blocks= 0;
+  DBUG_ENTER("init_key_cache_segments");
+
+  if (keycache->key_cache_inited && keycache->disk_blocks > 0)
+  {
+    DBUG_PRINT("warning",("key cache already in use"));
+    DBUG_RETURN(0);
+  }
+  if (! keycache->key_cache_inited)
+  {
+    keycache->key_cache_inited= 1;
+    keycache->in_init= 0;
+    pthread_mutex_init(&keycache->cache_lock, MY_MUTEX_INIT_FAST);
+    keycache->resize_queue.last_thread= NULL;
+  }
+  keycache->global_cache_w_requests= keycache->global_cache_r_requests= 0;
+  keycache->global_cache_read= keycache->global_cache_write= 0;
+  keycache->global_cache_lock_waits= 0;
+  keycache->blocks_used= keycache->blocks_unused= 0;
+  keycache->blocks_changed= keycache->global_blocks_changed= 0;
+  keycache->key_cache_mem_size= use_mem;
+  keycache->key_cache_block_size= key_cache_block_size;
+  keycache->disk_blocks= 0;
+  keycache->can_be_used= 0;
+
+  if (! keycache->segment &&
+      ! (keycache->segment= (KEY_CACHE*) my_malloc(sizeof(KEY_CACHE) *
+                                                   KEY_CACHE_MAX_SEGMENTS,
+                                                   MYF(MY_ZEROFILL))))
+  {
+    keycache->blocks= 0;
+    my_errno= ENOMEM;
+    DBUG_RETURN(0);
+  }
+
+  segments= (uint) min(keycache->param_segments, KEY_CACHE_MAX_SEGMENTS);
+  for (i= 0; i < segments; i++)
+  {
+    int segment_blocks= init_simple_key_cache(keycache->segment + i,
+                                              key_cache_block_size,
+                                              use_mem / segments,
+                                              division_limit, age_threshold);
+    if (segment_blocks > 0)
+      blocks+= segment_blocks;
+  }
+  DBUG_PRINT("exit", ("segments: %u  blocks: %d", segments, blocks));
+
+  keycache->disk_blocks= keycache->blocks= blocks;
+  keycache->can_be_used= blocks > 0;
+  /* Requests are passed on to the segments from now on */
+  keycache->segments= segments;
+  DBUG_RETURN(blocks);
+}
+
+
+/*
+  Resize a segmented key cache
+
+  SYNOPSIS
+    resize_key_cache_segments()
+    keycache     	        pointer to a key cache data structure
+    key_cache_block_size        size of blocks to keep cached data
+    use_mem			total memory to use for the new key cache
+    division_limit		new division limit (if not zero)
+    age_threshold		new age threshold (if not zero)
+
+  RETURN VALUE
+    number of blocks in the key cache, if successful,
+    0 - otherwise.
+
+  NOTES.
+    This is also used when a key cache is split into segments or stops
+    being segmented because param_segments was changed.
+
+    The segment of a block depends on the block size and the number of
+    segments, so all the old segments (or the old key cache) are flushed
+    and emptied before any new segment is initialized. Meanwhile the
+    requests that reach an emptied segment go directly to the file.
+*/
+
+static int resize_key_cache_segments(KEY_CACHE *keycache,
+                                     uint key_cache_block_size,
+                                     size_t use_mem, uint division_limit,
+                                     uint age_threshold)
+{
+  uint i;
+  int blocks;
+  DBUG_ENTER("resize_key_cache_segments");
+
+  if (key_cache_block_size == keycache->key_cache_block_size &&
+      use_mem == keycache->key_cache_mem_size &&
+      keycache->segments == min(keycache->param_segments,
+                                KEY_CACHE_MAX_SEGMENTS))
+  {
+    change_key_cache_param(keycache, division_limit, age_threshold);
+    DBUG_RETURN(keycache->disk_blocks);
+  }
+
+  /* Empty the old segments or the old key cache */
+  keycache->can_be_used= 0;
+  if (keycache->segments)
+  {
+    for (i= 0; i < keycache->segments; i++)
+      resize_simple_key_cache(keycache->segment + i,
+                              keycache->key_cache_block_size, 0, 0, 0);
+    /* The requests go directly to the file until the cache is rebuilt */
+    keycache->segments= 0;
+  }
+  else
+    resize_simple_key_cache(keycache, keycache->key_cache_block_size, 0, 0, 0);
+  keycache->disk_blocks= -1;
+
+  if (keycache->param_segments)
+    blocks= init_key_cache_segments(keycache, key_cache_block_size, use_mem,
+                                    division_limit, age_threshold);
+  else
+    blocks= init_simple_key_cache(keycache, key_cache_block_size, use_mem,
+                                  division_limit, age_threshold);
+  DBUG_RETURN(blocks);
+}
+
+
+/*
+  Read a block of data from a segmented key cache
+
+  SYNOPSIS
+    key_cache_segments_read()
+    keycache            pointer to a key cache data structure
+    segments            number of segments of the key cache
+    (the rest as for key_cache_read())
+
+  NOTES
+    The request is split at the borders of the key cache blocks and every
+    part is read through the segment that keeps its block.
+*/
+
+static byte *key_cache_segments_read(KEY_CACHE *keycache, uint segments,
+                                     File file, my_off_t filepos, int level,
+                                     byte *buff, uint length,
+                                     uint block_length)
+{
+  uint block_size= keycache->key_cache_block_size;
+  uint read_length, offset;
+  byte *start= buff;
+
+  do
+  {
+    offset= (uint) (filepos % block_size);
+    read_length= length;
+    set_if_smaller(read_length, block_size - offset);
+    if (!key_cache_read(keycache->segment +
+                        KEYCACHE_SEGMENT(file, filepos, block_size, segments),
+                        file, filepos, level, buff, read_length,
+                        block_length, 0))
+      return (byte*) 0;
+    buff+= read_length;
+    filepos+= read_length;
+  } while ((length-= read_length));
+  return start;
+}
+
+
+/*
+  Insert a block of file data into a segmented key cache
+
+  SYNOPSIS
+    key_cache_segments_insert()
+    keycache            pointer to a key cache data structure
+    segments            number of segments of the key cache
+    (the rest as for key_cache_insert())
+*/
+
+static int key_cache_segments_insert(KEY_CACHE *keycache, uint segments,
+                                     File file, my_off_t filepos, int level,
+                                     byte *buff, uint length)
+{
+  uint block_size= keycache->key_cache_block_size;
+  uint read_length, offset;
+
+  do
+  {
+    offset= (uint) (filepos % block_size);
+    read_length= length;
+    set_if_smaller(read_length, block_size - offset);
+    if (key_cache_insert(keycache->segment +
+                         KEYCACHE_SEGMENT(file, filepos, block_size, segments),
+                         file, filepos, level, buff, read_length))
+      return 1;
+    buff+= read_length;
+    filepos+= read_length;
+  } while ((length-= read_length));
+  return 0;
+}
+
+
+/*
+  Write a buffer into a segmented key cache
+
+  SYNOPSIS
+    key_cache_segments_write()
+    keycache            pointer to a key cache data structure
+    segments            number of segments of the key cache
+    (the rest as for key_cache_write())
+*/
+
+static int key_cache_segments_write(KEY_CACHE *keycache, uint segments,
+                                    File file, my_off_t filepos, int level,
+                                    byte *buff, uint length,
+                                    uint block_length, int dont_write)
+{
+  uint block_size= keycache->key_cache_block_size;
+  uint read_length, offset;
+  int error= 0;
+
+  do
+  {
+    offset= (uint) (filepos % block_size);
+    read_length= length;
+    set_if_smaller(read_length, block_size - offset);
+    if (key_cache_write(keycache->segment +
+                        KEYCACHE_SEGMENT(file, filepos, block_size, segments),
+                        file, filepos, level, buff, read_length,
+                        block_length, dont_write))
+      error= 1;
+    buff+= read_length;
+    filepos+= read_length;
+  } while ((length-= read_length));
+  return error;
+}
+
+
 #ifndef DBUG_OFF
 /*
   Test if disk-cache is ok
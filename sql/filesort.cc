@@ -45,6 +45,7 @@ static ha_rows find_all_keys(SORTPARAM *param,SQL_SELECT *select,
 static int write_keys(SORTPARAM *param,uchar * *sort_keys,
 		      uint count, IO_CACHE *buffer_file, IO_CACHE *tempfile);
 static void make_sortkey(SORTPARAM *param,uchar *to, byte *ref_pos);
+static void sort_buffer_keys(SORTPARAM *param, uchar **keys, uint count);
 static int merge_index(SORTPARAM *param,uchar *sort_buffer,
 		       BUFFPEK *buffpek,
 		       uint maxbuffer,IO_CACHE *tempfile,
@@ -171,6 +172,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   }
   param.rec_length= param.sort_length+param.addon_length;
   param.max_rows= max_rows;
+  param.sort_threads= (uint) thd->variables.sort_threads;
 
   if (select && select->quick)
   {
@@ -617,7 +619,7 @@ write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
 #ifdef MC68000
   quicksort(sort_keys,count,sort_length);
 #else
-  my_string_ptr_sort((gptr) sort_keys, (uint) count, sort_length);
+  sort_buffer_keys(param, sort_keys, count);
 #endif
   if (!my_b_inited(tempfile) &&
       open_cached_file(tempfile, mysql_tmpdir, TEMP_PREFIX, DISK_BUFFER_SIZE,
@@ -904,6 +906,322 @@ static void make_sortkey(register SORTPARAM *param,
   return;
 }
 
+/*
+  A key in the sort buffer together with its first bytes, stored as a
+  number that compares the same way as the key does
+*/
+
+typedef struct st_sort_key_ref
+{
+  ulonglong prefix;
+  uchar *key;
+  uint pos;                             /* Position in the sort buffer */
+} SORT_KEY_REF;
+
+/*
+  Loser tree used to merge sorted sequences of keys.
+  leaf[n] is the current key of sequence n, leaf[n].key is 0 when the
+  sequence is exhausted. node[0] is the sequence with the smallest key,
+  node[1..leaves-1] are the losers of the matches played to find it.
+*/
+
+typedef struct st_loser_tree
+{
+  uint leaves;
+  uint *node;
+  SORT_KEY_REF *leaf;
+  uint sort_length;
+  qsort2_cmp compare;                   /* Set if keys can't be memcmp()'ed */
+  void *compare_arg;
+} LOSER_TREE;
+
+/* A part of the sort buffer, sorted by a thread of its own */
+
+typedef struct st_sort_part
+{
+  SORT_KEY_REF *refs;
+  uint count;
+  uint sort_length;
+  pthread_mutex_t *lock;
+  pthread_cond_t *cond;
+  uint *running;
+} SORT_PART;
+
+
+static inline ulonglong sort_key_prefix(const uchar *key, uint length)
+{
+  ulonglong prefix;
+  uint i;
+  if (length >= 8)
+    return mi_uint8korr(key);
+  for (prefix= 0, i= 0 ; i < 8 ; i++)
+    prefix= (prefix << 8) | (i < length ? key[i] : 0);
+  return prefix;
+}
+
+
+/*
+  Compare keys on their prefixes, and on the rest of the keys only when
+  the prefixes are equal. Equal keys are kept in the order they were
+  put into the sort buffer.
+*/
+
+static int cmp_sort_key_ref(const void *length_arg, const void *a_arg,
+                            const void *b_arg)
+{
+  const SORT_KEY_REF *a= (const SORT_KEY_REF*) a_arg;
+  const SORT_KEY_REF *b= (const SORT_KEY_REF*) b_arg;
+  uint length= *(const uint*) length_arg;
+  int res;
+
+  if (a->prefix != b->prefix)
+    return a->prefix < b->prefix ? -1 : 1;
+  if (length > 8 && (res= memcmp(a->key+8, b->key+8, length-8)))
+    return res;
+  return a->pos < b->pos ? -1 : (a->pos > b->pos ? 1 : 0);
+}
+
+
+static bool init_loser_tree(LOSER_TREE *tree, uint leaves, uint sort_length,
+                            qsort2_cmp compare, void *compare_arg)
+{
+  if (!(tree->leaf= (SORT_KEY_REF*) my_malloc(leaves*(sizeof(SORT_KEY_REF)+
+                                                      sizeof(uint)),
+                                              MYF(MY_WME))))
+    return 1;
+  tree->node= (uint*) (tree->leaf+leaves);
+  tree->leaves= leaves;
+  tree->sort_length= sort_length;
+  tree->compare= compare;
+  tree->compare_arg= compare_arg;
+  return 0;
+}
+
+
+static inline void set_loser_tree_key(LOSER_TREE *tree, uint leaf, uchar *key)
+{
+  tree->leaf[leaf].key= key;
+  if (key && !tree->compare)
+    tree->leaf[leaf].prefix= sort_key_prefix(key, tree->sort_length);
+}
+
+
+/* Return 1 if the key of sequence a is to be merged before that of b */
+
+static inline bool loser_tree_less(LOSER_TREE *tree, uint a, uint b)
+{
+  SORT_KEY_REF *x= tree->leaf+a, *y= tree->leaf+b;
+  int res;
+
+  if (!x->key)
+    return 0;                                   // Exhausted sequences lose
+  if (!y->key)
+    return 1;
+  if (tree->compare)
+    res= (*tree->compare)(tree->compare_arg, &x->key, &y->key);
+  else if (x->prefix != y->prefix)
+    return x->prefix < y->prefix;
+  else
+    res= (tree->sort_length > 8 ?
+          memcmp(x->key+8, y->key+8, tree->sort_length-8) : 0);
+  return res ? res < 0 : a < b;                 // Earlier sequence first
+}
+
+
+/* Play all matches below 'node', return the winner */
+
+static uint loser_tree_play(LOSER_TREE *tree, uint node)
+{
+  uint a, b;
+  if (node >= tree->leaves)
+    return node - tree->leaves;
+  a= loser_tree_play(tree, node*2);
+  b= loser_tree_play(tree, node*2+1);
+  if (loser_tree_less(tree, a, b))
+  {
+    tree->node[node]= b;
+    return a;
+  }
+  tree->node[node]= a;
+  return b;
+}
+
+
+static void build_loser_tree(LOSER_TREE *tree)
+{
+  tree->node[0]= tree->leaves > 1 ? loser_tree_play(tree, 1) : 0;
+}
+
+
+/* Find the new winner after the key of the last one has changed */
+
+static inline void loser_tree_replay(LOSER_TREE *tree)
+{
+  uint winner= tree->node[0];
+  for (uint node= (winner + tree->leaves)/2 ; node ; node/= 2)
+  {
+    if (loser_tree_less(tree, tree->node[node], winner))
+      swap_variables(uint, tree->node[node], winner);
+  }
+  tree->node[0]= winner;
+}
+
+
+pthread_handler_t sort_part_thread(void *arg)
+{
+  SORT_PART *part= (SORT_PART*) arg;
+
+  my_thread_init();
+  my_qsort2((byte*) part->refs, part->count, sizeof(SORT_KEY_REF),
+            cmp_sort_key_ref, (void*) &part->sort_length);
+  pthread_mutex_lock(part->lock);
+  if (!--*part->running)
+    pthread_cond_signal(part->cond);
+  pthread_mutex_unlock(part->lock);
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Sort 'refs' in 'n_parts' threads and merge the parts into 'keys'
+*/
+
+static void sort_parts(uchar **keys, SORT_KEY_REF *refs, uint count,
+                       uint sort_length, SORT_PART *parts, uint n_parts)
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t th;
+  uint running, i;
+  SORT_PART *part;
+  SORT_KEY_REF *ref;
+  LOSER_TREE tree;
+  DBUG_ENTER("sort_parts");
+
+  pthread_mutex_init(&lock, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&cond, NULL);
+  running= n_parts-1;
+  for (i= 0, ref= refs ; i < n_parts ; i++)
+  {
+    part= parts+i;
+    part->refs= ref;
+    part->count= count/n_parts + (i < count % n_parts);
+    part->sort_length= sort_length;
+    part->lock= &lock;
+    part->cond= &cond;
+    part->running= &running;
+    ref+= part->count;
+  }
+  for (i= 1 ; i < n_parts ; i++)
+  {
+    if (pthread_create(&th, &connection_attrib, sort_part_thread,
+                       (void*) (parts+i)))
+    {
+      DBUG_PRINT("warning", ("Can't create sort thread: %d", errno));
+      my_qsort2((byte*) parts[i].refs, parts[i].count, sizeof(SORT_KEY_REF),
+                cmp_sort_key_ref, (void*) &sort_length);
+      pthread_mutex_lock(&lock);
+      running--;
+      pthread_mutex_unlock(&lock);
+    }
+  }
+  my_qsort2((byte*) parts->refs, parts->count, sizeof(SORT_KEY_REF),
+            cmp_sort_key_ref, (void*) &sort_length);
+  pthread_mutex_lock(&lock);
+  while (running)
+    pthread_cond_wait(&cond, &lock);
+  pthread_mutex_unlock(&lock);
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&lock);
+
+  if (init_loser_tree(&tree, n_parts, sort_length, 0, 0))
+  {
+    /* Out of memory, sort the whole (partly sorted) buffer instead */
+    my_qsort2((byte*) refs, count, sizeof(SORT_KEY_REF), cmp_sort_key_ref,
+              (void*) &sort_length);
+    for (i= 0 ; i < count ; i++)
+      keys[i]= refs[i].key;
+    DBUG_VOID_RETURN;
+  }
+  for (i= 0 ; i < n_parts ; i++)
+    tree.leaf[i]= *parts[i].refs;
+  build_loser_tree(&tree);
+  for (i= 0 ; i < count ; i++)
+  {
+    uint winner= tree.node[0];
+    part= parts+winner;
+    keys[i]= part->refs->key;
+    if (--part->count)
+      tree.leaf[winner]= *++part->refs;
+    else
+      tree.leaf[winner].key= 0;
+    loser_tree_replay(&tree);
+  }
+  my_free((gptr) tree.leaf, MYF(0));
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Sort the keys in the sort buffer
+
+  SYNOPSIS
+    sort_buffer_keys()
+      param             Sort parameters
+      keys              Array of pointers to the keys to sort
+      count             Number of elements in keys
+
+  DESCRIPTION
+    The keys are sorted as an array of (key prefix, key pointer) pairs, so
+    that most comparisons are done on integers stored next to each other
+    instead of on keys spread all over the sort buffer. Keys that are
+    equal keep the order they were put in the buffer.
+
+    A buffer of at least MIN_KEYS_PER_SORT_THREAD keys per thread is
+    split between param->sort_threads threads, and the sorted parts are
+    merged back into 'keys'. If there is no memory for the pairs the keys
+    are sorted as before with my_string_ptr_sort().
+*/
+
+static void sort_buffer_keys(SORTPARAM *param, uchar **keys, uint count)
+{
+  SORT_KEY_REF *refs;
+  uint sort_length= param->sort_length, n_parts, i;
+  DBUG_ENTER("sort_buffer_keys");
+
+  if (count <= 1)
+    DBUG_VOID_RETURN;
+  n_parts= min(param->sort_threads, count / MIN_KEYS_PER_SORT_THREAD);
+  set_if_bigger(n_parts, 1);
+  if (!(refs= (SORT_KEY_REF*) my_malloc(count*sizeof(SORT_KEY_REF)+
+                                        n_parts*sizeof(SORT_PART), MYF(0))))
+  {
+    my_string_ptr_sort((gptr) keys, count, sort_length);
+    DBUG_VOID_RETURN;
+  }
+  for (i= 0 ; i < count ; i++)
+  {
+    refs[i].prefix= sort_key_prefix(keys[i], sort_length);
+    refs[i].key= keys[i];
+    refs[i].pos= i;
+  }
+  if (n_parts > 1)
+    sort_parts(keys, refs, count, sort_length, (SORT_PART*) (refs+count),
+               n_parts);
+  else
+  {
+    my_qsort2((byte*) refs, count, sizeof(SORT_KEY_REF), cmp_sort_key_ref,
+              (void*) &sort_length);
+    for (i= 0 ; i < count ; i++)
+      keys[i]= refs[i].key;
+  }
+  my_free((gptr) refs, MYF(0));
+  DBUG_VOID_RETURN;
+}
+
+
 static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count, 
                        FILESORT_INFO *table_sort)
 {
@@ -911,7 +1229,7 @@ static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count,
   byte *to;
   DBUG_ENTER("save_index");
 
-  my_string_ptr_sort((gptr) sort_keys, (uint) count, param->sort_length);
+  sort_buffer_keys(param, sort_keys, count);
   res_length= param->res_length;
   offset= param->rec_length-res_length;
   if ((ha_rows) count > param->max_rows)
@@ -928,17 +1246,40 @@ static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count,
 }
 
 
-	/* Merge buffers to make < MERGEBUFF2 buffers */
+/*
+  Number of sequences to merge at once
+
+  SYNOPSIS
+    merge_width()
+      keys              Number of keys that fit in the merge buffer
+      rec_length        Length of a key
+
+  DESCRIPTION
+    All sequences are merged at once if every one of them can still be
+    read MERGEBUFF_MIN_READ bytes at a time, but never less than
+    MERGEBUFF2 of them.
+*/
+
+uint merge_width(uint keys, uint rec_length)
+{
+  ulonglong width= ((ulonglong) keys * rec_length) / MERGEBUFF_MIN_READ;
+  return (uint) max(width, MERGEBUFF2);
+}
+
+
+	/* Merge buffers to make < merge_width() buffers */
 
 int merge_many_buff(SORTPARAM *param, uchar *sort_buffer,
 		    BUFFPEK *buffpek, uint *maxbuffer, IO_CACHE *t_file)
 {
   register uint i;
+  uint width;
   IO_CACHE t_file2,*from_file,*to_file,*temp;
   BUFFPEK *lastbuff;
   DBUG_ENTER("merge_many_buff");
 
-  if (*maxbuffer < MERGEBUFF2)
+  width= merge_width(param->keys, param->rec_length);
+  if (*maxbuffer < width)
     DBUG_RETURN(0);				/* purecov: inspected */
   if (flush_io_cache(t_file) ||
       open_cached_file(&t_file2,mysql_tmpdir,TEMP_PREFIX,DISK_BUFFER_SIZE,
@@ -946,17 +1287,17 @@ int merge_many_buff(SORTPARAM *param, uchar *sort_buffer,
     DBUG_RETURN(1);				/* purecov: inspected */
 
   from_file= t_file ; to_file= &t_file2;
-  while (*maxbuffer >= MERGEBUFF2)
+  while (*maxbuffer >= width)
   {
     if (reinit_io_cache(from_file,READ_CACHE,0L,0,0))
       goto cleanup;
     if (reinit_io_cache(to_file,WRITE_CACHE,0L,0,0))
       goto cleanup;
     lastbuff=buffpek;
-    for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+    for (i=0 ; i + width*3/2 <= *maxbuffer ; i+=width)
     {
       if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-			buffpek+i,buffpek+i+MERGEBUFF-1,0))
+			buffpek+i,buffpek+i+width-1,0))
       goto cleanup;
     }
     if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
@@ -977,7 +1318,7 @@ cleanup:
     setup_io_cache(t_file);
   }
 
-  DBUG_RETURN(*maxbuffer >= MERGEBUFF2);	/* Return 1 if interrupted */
+  DBUG_RETURN(*maxbuffer >= width);	/* Return 1 if interrupted */
 } /* merge_many_buff */
 
 
@@ -1037,6 +1378,35 @@ void reuse_freed_buff(QUEUE *queue, BUFFPEK *reuse, uint key_length)
 }
 
 
+/*
+  Same as reuse_freed_buff() for the sequences of merge_buffers(); the
+  ones that still have keys in memory are those with mem_count != 0
+*/
+
+static void reuse_freed_buffpek(BUFFPEK *Fb, BUFFPEK *Tb, BUFFPEK *reuse,
+                                uint key_length)
+{
+  uchar *reuse_end= reuse->base + reuse->max_keys * key_length;
+  for (BUFFPEK *bp= Fb; bp <= Tb; bp++)
+  {
+    if (bp == reuse || !bp->mem_count)
+      continue;
+    if (bp->base + bp->max_keys * key_length == reuse->base)
+    {
+      bp->max_keys+= reuse->max_keys;
+      return;
+    }
+    else if (bp->base == reuse_end)
+    {
+      bp->base= reuse->base;
+      bp->max_keys+= reuse->max_keys;
+      return;
+    }
+  }
+  DBUG_ASSERT(0);
+}
+
+
 /* 
   Merge buffers to one buffer
   SYNOPSIS
@@ -1050,6 +1420,12 @@ void reuse_freed_buff(QUEUE *queue, BUFFPEK *reuse, uint key_length)
       Tb           Last element in source BUFFPEKs array
       flag
 
+  NOTES
+    The sequences are merged with a loser tree. Unless a compare function
+    is given for Unique, the tree holds the first bytes of every current
+    key as a number, so that most matches are decided without looking at
+    the keys themselves.
+
   RETURN
     0     - OK
     other - error
@@ -1061,13 +1437,13 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
                   int flag)
 {
   int error;
-  uint rec_length,sort_length,res_length,offset;
+  uint rec_length,sort_length,res_length,offset,active,winner;
   ulong maxcount;
   ha_rows max_rows,org_max_rows;
   my_off_t to_start_filepos;
   uchar *strpos;
   BUFFPEK *buffpek;
-  QUEUE queue;
+  LOSER_TREE tree;
   qsort2_cmp cmp;
   void *first_cmp_arg;
   volatile THD::killed_state *killed= &current_thd->killed;
@@ -1102,11 +1478,11 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
   }
   else
   {
-    cmp= get_ptr_compare(sort_length);
-    first_cmp_arg= (void*) &sort_length;
+    cmp= 0;                                        // Not unique
+    first_cmp_arg= 0;
   }
-  if (init_queue(&queue, (uint) (Tb-Fb)+1, offsetof(BUFFPEK,key), 0,
-                 (queue_compare) cmp, first_cmp_arg))
+  if (init_loser_tree(&tree, (uint) (Tb-Fb)+1, sort_length, cmp,
+                      first_cmp_arg))
     DBUG_RETURN(1);                                /* purecov: inspected */
   for (buffpek= Fb ; buffpek <= Tb ; buffpek++)
   {
@@ -1117,8 +1493,10 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
     if (error == -1)
       goto err;					/* purecov: inspected */
     buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
-    queue_insert(&queue, (byte*) buffpek);
+    set_loser_tree_key(&tree, (uint) (buffpek-Fb), buffpek->key);
   }
+  build_loser_tree(&tree);
+  active= tree.leaves;
 
   if (param->unique_buff)
   {
@@ -1130,7 +1508,8 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
        This is safe as we know that there is always more than one element
        in each block to merge (This is guaranteed by the Unique:: algorithm
     */
-    buffpek= (BUFFPEK*) queue_top(&queue);
+    winner= tree.node[0];
+    buffpek= Fb + winner;
     memcpy(param->unique_buff, buffpek->key, rec_length);
     if (my_b_write(to_file, (byte*) buffpek->key, rec_length))
     {
@@ -1143,65 +1522,65 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       error= 0;                                       /* purecov: inspected */
       goto end;                                       /* purecov: inspected */
     }
-    queue_replaced(&queue);                        // Top element has been used
+    set_loser_tree_key(&tree, winner, buffpek->key);
+    loser_tree_replay(&tree);                      // Top element has been used
   }
-  else
-    cmp= 0;                                        // Not unique
 
-  while (queue.elements > 1)
+  while (active > 1)
   {
-    if (*killed)
+    winner= tree.node[0];
+    buffpek= Fb + winner;
+    if (cmp)                                        // Remove duplicates
     {
-      error= 1; goto err;                        /* purecov: inspected */
+      if (!(*cmp)(first_cmp_arg, &(param->unique_buff),
+                  (uchar**) &buffpek->key))
+        goto skip_duplicate;
+      memcpy(param->unique_buff, (uchar*) buffpek->key, rec_length);
     }
-    for (;;)
+    if (flag == 0)
     {
-      buffpek= (BUFFPEK*) queue_top(&queue);
-      if (cmp)                                        // Remove duplicates
-      {
-        if (!(*cmp)(first_cmp_arg, &(param->unique_buff),
-                    (uchar**) &buffpek->key))
-              goto skip_duplicate;
-            memcpy(param->unique_buff, (uchar*) buffpek->key, rec_length);
-      }
-      if (flag == 0)
+      if (my_b_write(to_file,(byte*) buffpek->key, rec_length))
       {
-        if (my_b_write(to_file,(byte*) buffpek->key, rec_length))
-        {
-          error=1; goto err;                        /* purecov: inspected */
-        }
+        error=1; goto err;                        /* purecov: inspected */
       }
-      else
+    }
+    else
+    {
+      if (my_b_write(to_file, (byte*) buffpek->key+offset, res_length))
       {
-        if (my_b_write(to_file, (byte*) buffpek->key+offset, res_length))
-        {
-          error=1; goto err;                        /* purecov: inspected */
-        }
+        error=1; goto err;                        /* purecov: inspected */
       }
-      if (!--max_rows)
+    }
+    if (!--max_rows)
+    {
+      error= 0;                               /* purecov: inspected */
+      goto end;                               /* purecov: inspected */
+    }
+
+  skip_duplicate:
+    buffpek->key+= rec_length;
+    if (! --buffpek->mem_count)
+    {
+      if (*killed)
       {
-        error= 0;                               /* purecov: inspected */
-        goto end;                               /* purecov: inspected */
+        error= 1; goto err;                        /* purecov: inspected */
       }
-
-    skip_duplicate:
-      buffpek->key+= rec_length;
-      if (! --buffpek->mem_count)
+      if (!(error= (int) read_to_buffer(from_file,buffpek,
+                                        rec_length)))
       {
-        if (!(error= (int) read_to_buffer(from_file,buffpek,
-                                          rec_length)))
-        {
-          VOID(queue_remove(&queue,0));
-          reuse_freed_buff(&queue, buffpek, rec_length);
-          break;                        /* One buffer have been removed */
-        }
-        else if (error == -1)
-          goto err;                        /* purecov: inspected */
+        reuse_freed_buffpek(Fb, Tb, buffpek, rec_length);
+        set_loser_tree_key(&tree, winner, 0);
+        active--;                       /* One buffer have been removed */
+        loser_tree_replay(&tree);
+        continue;
       }
-      queue_replaced(&queue);              /* Top element has been replaced */
+      else if (error == -1)
+        goto err;                        /* purecov: inspected */
     }
+    set_loser_tree_key(&tree, winner, buffpek->key);
+    loser_tree_replay(&tree);              /* Top element has been replaced */
   }
-  buffpek= (BUFFPEK*) queue_top(&queue);
+  buffpek= Fb + tree.node[0];
   buffpek->base= sort_buffer;
   buffpek->max_keys= param->keys;
 
@@ -1256,7 +1635,7 @@ end:
   lastbuff->count= min(org_max_rows-max_rows, param->max_rows);
   lastbuff->file_pos= to_start_filepos;
 err:
-  delete_queue(&queue);
+  my_free((gptr) tree.leaf, MYF(0));
   DBUG_RETURN(error);
 } /* merge_buffers */
 
@@ -84,6 +84,8 @@ int ha_heap::open(const char *name, int mode, uint test_if_locked)
   {
     HA_CREATE_INFO create_info;
     bzero(&create_info, sizeof(create_info));
+    if (test_if_locked & HA_OPEN_TMP_TABLE)
+      create_info.options|= HA_LEX_CREATE_INTERNAL_TMP_TABLE;
     if (!create(name, table, &create_info))
     {
       file= heap_open(name, mode);
@@ -560,27 +562,41 @@ ha_rows ha_heap::records_in_range(uint inx, key_range *min_key,
 }
 
 
+/* Order of the columns given to heap_create() */
+
+static int column_cmp(const HP_COLUMNDEF *a, const HP_COLUMNDEF *b)
+{
+  return (a->offset < b->offset) ? -1 : (a->offset > b->offset) ? 1 : 0;
+}
+
+
 int ha_heap::create(const char *name, TABLE *table_arg,
 		    HA_CREATE_INFO *create_info)
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
-  uint auto_key= 0, auto_key_type= 0;
+  uint auto_key= 0, auto_key_type= 0, columns= 0;
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_COLUMNDEF *columndef;
   char buff[FN_REFLEN];
   int error;
   TABLE_SHARE *share= table_arg->s;
   bool found_real_auto_increment= 0;
+  bool dynamic= share->blob_fields || share->row_type == ROW_TYPE_DYNAMIC;
 
   for (key= parts= 0; key < keys; key++)
     parts+= table_arg->key_info[key].key_parts;
+  if (dynamic)
+    columns= share->fields;
 
   if (!(keydef= (HP_KEYDEF*) my_malloc(keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+				       columns * sizeof(HP_COLUMNDEF),
 				       MYF(MY_WME))))
     return my_errno;
   seg= my_reinterpret_cast(HA_KEYSEG*) (keydef + keys);
+  columndef= my_reinterpret_cast(HP_COLUMNDEF*) (seg + parts);
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -651,26 +667,76 @@ int ha_heap::create(const char *name, TABLE *table_arg,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
-  max_rows = (ha_rows) (table->in_use->variables.max_heap_table_size /
-			(ulonglong) mem_per_row);
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
     found_real_auto_increment= share->next_number_key_offset == 0;
   }
   HP_CREATE_INFO hp_create_info;
+  bzero((char*) &hp_create_info, sizeof(hp_create_info));
   hp_create_info.auto_key= auto_key;
   hp_create_info.auto_key_type= auto_key_type;
   hp_create_info.auto_increment= (create_info->auto_increment_value ?
 				  create_info->auto_increment_value - 1 : 0);
   hp_create_info.max_table_size=current_thd->variables.max_heap_table_size;
   hp_create_info.with_auto_increment= found_real_auto_increment;
-  max_rows = (ha_rows) (hp_create_info.max_table_size / mem_per_row);
+  if (dynamic)
+  {
+    for (Field **field= table_arg->field; *field; field++)
+    {
+      HP_COLUMNDEF *column= columndef + hp_create_info.columns++;
+      column->offset= (uint) ((*field)->ptr - (char*) table_arg->record[0]);
+      column->length= (*field)->pack_length();
+      if ((*field)->null_ptr)
+      {
+        column->null_bit= (*field)->null_bit;
+        column->null_pos= (uint) ((*field)->null_ptr -
+                                  (uchar*) table_arg->record[0]);
+      }
+      else
+      {
+        column->null_bit= 0;
+        column->null_pos= 0;
+      }
+      if ((*field)->flags & BLOB_FLAG)
+      {
+        column->type= HP_COLUMN_BLOB;
+        column->length_bytes= column->length - share->blob_ptr_size;
+      }
+      else if ((*field)->real_type() == MYSQL_TYPE_VARCHAR)
+      {
+        column->type= HP_COLUMN_VARCHAR;
+        column->length_bytes= ((Field_varstring*) *field)->length_bytes;
+      }
+      else
+      {
+        column->type= HP_COLUMN_FIXED;
+        column->length_bytes= 0;
+      }
+    }
+    qsort(columndef, hp_create_info.columns, sizeof(HP_COLUMNDEF),
+          (qsort_cmp) column_cmp);
+    hp_create_info.columndef= columndef;
+    /*
+      The size of a row is not known: only the memory limits the number
+      of rows. The rows of an internal temporary table also have to fit
+      in tmp_table_size, which create_tmp_table() can't compute as a
+      number of rows.
+    */
+    if (create_info->options & HA_LEX_CREATE_INTERNAL_TMP_TABLE)
+      set_if_smaller(hp_create_info.max_table_size,
+                     current_thd->variables.tmp_table_size);
+    max_rows= 0;
+  }
+  else
+  {
+    mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
+    max_rows = (ha_rows) (hp_create_info.max_table_size / mem_per_row);
+  }
   error= heap_create(fn_format(buff,name,"","",
                                MY_REPLACE_EXT|MY_UNPACK_FILENAME),
 		     keys, keydef, share->reclength,
-		     (ulong) ((share->max_rows < max_rows &&
+		     (ulong) (((share->max_rows < max_rows || !max_rows) &&
 			       share->max_rows) ? 
 			      share->max_rows : max_rows),
 		     (ulong) share->min_rows, &hp_create_info);
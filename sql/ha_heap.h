@@ -43,12 +43,16 @@ public:
     return ((table->key_info[inx].algorithm == HA_KEY_ALG_BTREE) ? "BTREE" :
 	    "HASH");
   }
-  /* Rows also use a fixed-size format */
-  enum row_type get_row_type() const { return ROW_TYPE_FIXED; }
+  /* Rows with BLOBs or ROW_FORMAT=DYNAMIC are stored in chunks */
+  enum row_type get_row_type() const
+  {
+    return (file && file->s->chunk_length) ? ROW_TYPE_DYNAMIC :
+                                             ROW_TYPE_FIXED;
+  }
   const char **bas_ext() const;
   ulong table_flags() const
   {
-    return (HA_FAST_KEY_READ | HA_NO_BLOBS | HA_NULL_IN_KEY |
+    return (HA_FAST_KEY_READ | HA_NULL_IN_KEY |
             HA_REC_NOT_IN_SEQ | HA_READ_RND_SAME |
             HA_CAN_INSERT_DELAYED);
   }
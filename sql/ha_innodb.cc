@@ -44,9 +44,7 @@ have disabled the InnoDB inlining in this file. */
 
 #include "ha_innodb.h"
 
-pthread_mutex_t innobase_share_mutex, /* to protect innobase_open_files */
-                prepare_commit_mutex; /* to force correct commit order in
-				      binlog */
+pthread_mutex_t innobase_share_mutex; /* to protect innobase_open_files */
 ulong commit_threads= 0;
 pthread_mutex_t commit_threads_m;
 pthread_cond_t commit_cond;
@@ -122,6 +120,7 @@ extern "C" {
 #include "../innobase/include/row0ins.h"
 #include "../innobase/include/row0mysql.h"
 #include "../innobase/include/row0sel.h"
+#include "../innobase/include/row0merge.h"
 #include "../innobase/include/row0upd.h"
 #include "../innobase/include/log0log.h"
 #include "../innobase/include/lock0lock.h"
@@ -146,7 +145,9 @@ long innobase_mirrored_log_groups, innobase_log_files_in_group,
      innobase_log_buffer_size, innobase_buffer_pool_awe_mem_mb,
      innobase_additional_mem_pool_size, innobase_file_io_threads,
      innobase_lock_wait_timeout, innobase_force_recovery,
-     innobase_open_files;
+     innobase_open_files, innobase_aio_queue_depth,
+     innobase_buffer_pool_instances, innobase_adaptive_hash_index_partitions,
+     innobase_purge_threads;
 
 longlong innobase_buffer_pool_size, innobase_log_file_size;
 
@@ -169,12 +170,13 @@ my_bool innobase_log_archive			= FALSE;/* unused */
 my_bool innobase_use_doublewrite    = TRUE;
 my_bool innobase_use_checksums      = TRUE;
 my_bool innobase_use_large_pages    = FALSE;
-my_bool	innobase_use_native_aio			= FALSE;
+my_bool	innobase_use_native_aio			= TRUE;
 my_bool	innobase_file_per_table			= FALSE;
 my_bool innobase_locks_unsafe_for_binlog        = FALSE;
 my_bool innobase_rollback_on_timeout		= FALSE;
 my_bool innobase_create_status_file		= FALSE;
 my_bool innobase_adaptive_hash_index		= TRUE;
+my_bool innobase_adaptive_flushing		= TRUE;
 
 static char *internal_innobase_data_file_path	= NULL;
 
@@ -282,6 +284,8 @@ struct show_var_st innodb_status_variables[]= {
   (char*) &export_vars.innodb_dblwr_pages_written,        SHOW_LONG},
   {"dblwr_writes",
   (char*) &export_vars.innodb_dblwr_writes,               SHOW_LONG},
+  {"history_list_length",
+  (char*) &export_vars.innodb_history_list_length,        SHOW_LONG},
   {"log_waits",
   (char*) &export_vars.innodb_log_waits,                  SHOW_LONG},
   {"log_write_requests",
@@ -304,6 +308,8 @@ struct show_var_st innodb_status_variables[]= {
   (char*) &export_vars.innodb_pages_read,                 SHOW_LONG},
   {"pages_written",
   (char*) &export_vars.innodb_pages_written,              SHOW_LONG},
+  {"purge_undo_records",
+  (char*) &export_vars.innodb_purge_undo_records,         SHOW_LONG},
   {"row_lock_current_waits",
   (char*) &export_vars.innodb_row_lock_current_waits,     SHOW_LONG},
   {"row_lock_time",
@@ -525,6 +531,9 @@ convert_error_code_to_mysql(
 	} else if (error == DB_UNSUPPORTED) {
 
 		return(HA_ERR_UNSUPPORTED);
+	} else if (error == DB_MISSING_HISTORY) {
+
+		return(HA_ERR_TABLE_DEF_CHANGED);
     	} else {
     		return(-1);			// Unknown error
     	}
@@ -789,6 +798,11 @@ check_trx_exists(
 
 			ut_a(0);
 		}
+
+		/* With the pool-of-threads scheduler the statements of a
+		connection may run in different OS threads */
+
+		trx->mysql_thread_id = os_thread_get_curr_id();
 	}
 
 	if (thd->options & OPTION_NO_FOREIGN_KEY_CHECKS) {
@@ -1370,10 +1384,17 @@ innobase_init(void)
                 determined by .._awe_mem_mb. */
         }
 
+	srv_buf_pool_instances = (ulint) innobase_buffer_pool_instances;
+
 	srv_mem_pool_size = (ulint) innobase_additional_mem_pool_size;
 
 	srv_n_file_io_threads = (ulint) innobase_file_io_threads;
 
+	srv_n_purge_threads = (ulint) innobase_purge_threads;
+
+	srv_use_native_aio = (ibool) innobase_use_native_aio;
+	srv_aio_queue_depth = (ulint) innobase_aio_queue_depth;
+
 	srv_lock_wait_timeout = (ulint) innobase_lock_wait_timeout;
 	srv_force_recovery = (ulint) innobase_force_recovery;
 
@@ -1381,6 +1402,9 @@ innobase_init(void)
 	srv_use_checksums = (ibool) innobase_use_checksums;
 
 	srv_use_adaptive_hash_indexes = (ibool) innobase_adaptive_hash_index;
+	srv_adaptive_hash_index_partitions =
+		(ulint) innobase_adaptive_hash_index_partitions;
+	srv_adaptive_flushing = (ibool) innobase_adaptive_flushing;
 
 	os_use_large_pages = (ibool) innobase_use_large_pages;
 	os_large_page_size = (ulint) innobase_large_page_size;
@@ -1429,10 +1453,15 @@ innobase_init(void)
                 goto error;
 	}
 
+	/* Show whether native aio is actually used */
+	innobase_use_native_aio = (my_bool) os_aio_use_native_aio;
+
+	/* Show the number of buffer pool instances actually created */
+	innobase_buffer_pool_instances = (long) srv_buf_pool_instances;
+
 	(void) hash_init(&innobase_open_tables,system_charset_info, 32, 0, 0,
 			 		(hash_get_key) innobase_get_key, 0, 0);
         pthread_mutex_init(&innobase_share_mutex, MY_MUTEX_INIT_FAST);
-        pthread_mutex_init(&prepare_commit_mutex, MY_MUTEX_INIT_FAST);
         pthread_mutex_init(&commit_threads_m, MY_MUTEX_INIT_FAST);
         pthread_mutex_init(&commit_cond_m, MY_MUTEX_INIT_FAST);
         pthread_cond_init(&commit_cond, NULL);
@@ -1487,7 +1516,6 @@ innobase_end(void)
 	  	my_free(internal_innobase_data_file_path,
 						MYF(MY_ALLOW_ZERO_PTR));
                 pthread_mutex_destroy(&innobase_share_mutex);
-                pthread_mutex_destroy(&prepare_commit_mutex);
                 pthread_mutex_destroy(&commit_threads_m);
                 pthread_mutex_destroy(&commit_cond_m);
                 pthread_cond_destroy(&commit_cond);
@@ -1645,11 +1673,21 @@ innobase_commit(
         if (all
 	    || (!(thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)))) {
 
+		ibool	ordered_commit	= (trx->active_trans == 2);
+		ibool	flush_log_later	= trx->flush_log_later;
+
  		/* We were instructed to commit the whole transaction, or
 		this is an SQL statement end and autocommit is on */
 
-                /* We need current binlog position for ibbackup to work.
-                Note, the position is current because of prepare_commit_mutex */
+		if (ordered_commit) {
+			/* Commit in the same order as the transactions
+			were written to the binlog; see
+			innobase_xa_prepare(). We must not hold a commit
+			concurrency slot while we wait for our turn. */
+
+			mysql_bin_log.enter_commit_order(
+				thd->transaction.commit_ticket);
+		}
 retry:
                 if (srv_commit_concurrency > 0)
                 {
@@ -1666,9 +1704,24 @@ retry:
                     pthread_mutex_unlock(&commit_cond_m);
                 }
 
+                /* We need the binlog position for ibbackup to work */
                 trx->mysql_log_file_name = mysql_bin_log.get_log_fname();
-                trx->mysql_log_offset =
-                        (ib_longlong)mysql_bin_log.get_log_file()->pos_in_file;
+                if (ordered_commit && thd->transaction.commit_ticket) {
+                        trx->mysql_log_offset = (ib_longlong)
+                                thd->transaction.commit_binlog_pos;
+                } else {
+                        trx->mysql_log_offset = (ib_longlong)
+                                mysql_bin_log.get_log_file()->pos_in_file;
+                }
+
+		if (ordered_commit) {
+			/* Flush the log only after we have let the next
+			transaction commit: the flushes of all the
+			transactions in the queue can then be done by a
+			single log_write_up_to() call */
+
+			trx->flush_log_later = TRUE;
+		}
 
 		innobase_commit_low(trx);
 
@@ -1680,9 +1733,16 @@ retry:
                   pthread_mutex_unlock(&commit_cond_m);
                 }
 
-                if (trx->active_trans == 2) {
+                if (ordered_commit) {
+			mysql_bin_log.exit_commit_order(
+				thd->transaction.commit_ticket);
+			thd->transaction.commit_ticket = 0;
 
-                        pthread_mutex_unlock(&prepare_commit_mutex);
+			trx->flush_log_later = flush_log_later;
+
+			if (!flush_log_later) {
+				trx_commit_complete_for_mysql(trx);
+			}
                 }
 
                 trx->active_trans = 0;
@@ -2025,6 +2085,12 @@ innobase_close_connection(
 
 	ut_a(trx);
 
+	/* trx_free_for_mysql() frees the thread local storage of
+	mysql_thread_id: make sure it is the current thread and not the
+	pool-of-threads worker that ran an earlier statement */
+
+	trx->mysql_thread_id = os_thread_get_curr_id();
+
         if (trx->active_trans == 0
 	    && trx->conc_state != TRX_NOT_STARTED) {
 
@@ -4446,56 +4512,38 @@ create_table_def(
 }
 
 /*********************************************************************
-Creates an index in an InnoDB database. */
+Builds the InnoDB definition of an index of a MySQL table. */
 static
-int
-create_index(
-/*=========*/
-	trx_t*		trx,		/* in: InnoDB transaction handle */
+dict_index_t*
+create_index_def(
+/*=============*/
+					/* out, own: index definition */
 	TABLE*		form,		/* in: information on table
-					columns and indexes */
+					columns */
 	const char*	table_name,	/* in: table name */
-	uint		key_num)	/* in: index number */
+	KEY*		key,		/* in: index */
+	ulint		ind_type,	/* in: DICT_CLUSTERED, DICT_UNIQUE,
+					or 0 */
+	ulint*		field_lengths)	/* out: lengths of the key parts */
 {
 	Field*		field;
 	dict_index_t*	index;
-  	int 		error;
 	ulint		n_fields;
-	KEY*		key;
 	KEY_PART_INFO*	key_part;
-	ulint		ind_type;
 	ulint		col_type;
 	ulint		prefix_len;
 	ulint		is_unsigned;
   	ulint		i;
   	ulint		j;
-	ulint*		field_lengths;
-
-  	DBUG_ENTER("create_index");
-
-	key = form->key_info + key_num;
 
     	n_fields = key->key_parts;
 
-    	ind_type = 0;
-
-    	if (key_num == form->s->primary_key) {
-		ind_type = ind_type | DICT_CLUSTERED;
-	}
-
-	if (key->flags & HA_NOSAME ) {
-		ind_type = ind_type | DICT_UNIQUE;
-	}
-
 	/* We pass 0 as the space id, and determine at a lower level the space
 	id where to store the table */
 
 	index = dict_mem_index_create((char*) table_name, key->name, 0,
 						ind_type, n_fields);
 
-	field_lengths = (ulint*) my_malloc(sizeof(ulint) * n_fields,
-		MYF(MY_FAE));
-
 	for (i = 0; i < n_fields; i++) {
 		key_part = key->key_part + i;
 
@@ -4560,6 +4608,47 @@ create_index(
 				0, prefix_len);
 	}
 
+	return(index);
+}
+
+/*********************************************************************
+Creates an index in an InnoDB database. */
+static
+int
+create_index(
+/*=========*/
+	trx_t*		trx,		/* in: InnoDB transaction handle */
+	TABLE*		form,		/* in: information on table
+					columns and indexes */
+	const char*	table_name,	/* in: table name */
+	uint		key_num)	/* in: index number */
+{
+	dict_index_t*	index;
+  	int 		error;
+	KEY*		key;
+	ulint		ind_type;
+	ulint*		field_lengths;
+
+  	DBUG_ENTER("create_index");
+
+	key = form->key_info + key_num;
+
+    	ind_type = 0;
+
+    	if (key_num == form->s->primary_key) {
+		ind_type = ind_type | DICT_CLUSTERED;
+	}
+
+	if (key->flags & HA_NOSAME ) {
+		ind_type = ind_type | DICT_UNIQUE;
+	}
+
+	field_lengths = (ulint*) my_malloc(sizeof(ulint) * key->key_parts,
+		MYF(MY_FAE));
+
+	index = create_index_def(form, table_name, key, ind_type,
+				 field_lengths);
+
 	/* Even though we've defined max_supported_key_part_length, we
 	still do our own checking using field_lengths to be absolutely
 	sure we don't create too long indexes. */
@@ -4811,6 +4900,235 @@ cleanup:
 	DBUG_RETURN(error);
 }
 
+/*********************************************************************
+Tells which indexes can be created and dropped without copying the
+table: secondary indexes, with the table locked. */
+
+ulong
+ha_innobase::index_ddl_flags(
+/*=========================*/
+				/* out: HA_DDL_SUPPORT | HA_DDL_WITH_LOCK,
+				or HA_DDL_SUPPORT */
+	KEY*	wanted_index) const /* in: index */
+{
+	if (wanted_index->flags & (HA_FULLTEXT | HA_SPATIAL)
+	    || 0 == innobase_strcasecmp(wanted_index->name, "PRIMARY")) {
+
+		return(HA_DDL_SUPPORT);
+	}
+
+	return(HA_DDL_SUPPORT | HA_DDL_WITH_LOCK);
+}
+
+/*********************************************************************
+Creates secondary indexes on an InnoDB table without copying the table.
+The table is S-locked while the indexes are built, so that it can be
+read but not modified. */
+
+int
+ha_innobase::add_index(
+/*===================*/
+				/* out: error number */
+	TABLE*	table_arg,	/* in: table with the new definition */
+	KEY*	key_info,	/* in: the indexes to create */
+	uint	num_of_keys)	/* in: number of indexes */
+{
+	row_prebuilt_t*	prebuilt	= (row_prebuilt_t*) innobase_prebuilt;
+	dict_index_t**	indexes;
+	dict_index_t*	index_def;
+	ulint*		field_lengths;
+	trx_t*		trx;
+	KEY*		key;
+	ulint		n_created;
+	ulint		error;
+	uint		i;
+
+	DBUG_ENTER("ha_innobase::add_index");
+
+	update_thd(current_thd);
+
+	/* In case MySQL calls this in the middle of a SELECT query, release
+	possible adaptive hash latch to avoid deadlocks of threads */
+
+	trx_search_latch_release_if_reserved(prebuilt->trx);
+
+	/* Wait for the transactions that have modified the table, and keep
+	others from modifying it until the end of the ALTER TABLE */
+
+	error = row_lock_table_for_mysql(prebuilt, prebuilt->table, LOCK_S);
+
+	if (error != DB_SUCCESS) {
+
+		DBUG_RETURN(convert_error_code_to_mysql((int) error,
+							user_thd));
+	}
+
+	indexes = (dict_index_t**) my_malloc(sizeof(dict_index_t*)
+					     * num_of_keys, MYF(MY_FAE));
+
+	trx = trx_allocate_for_mysql();
+
+	trx->mysql_thd = user_thd;
+	trx->mysql_query_str = &((*user_thd).query);
+
+	row_mysql_lock_data_dictionary(trx);
+
+	error = DB_SUCCESS;
+
+	for (n_created = 0; n_created < num_of_keys; n_created++) {
+		key = key_info + n_created;
+
+		field_lengths = (ulint*) my_malloc(
+			sizeof(ulint) * key->key_parts, MYF(MY_FAE));
+
+		index_def = create_index_def(table_arg, prebuilt->table->name,
+					     key, (key->flags & HA_NOSAME)
+					     ? DICT_UNIQUE : 0,
+					     field_lengths);
+
+		error = row_merge_create_index(trx, index_def, field_lengths,
+					       indexes + n_created);
+
+		my_free((gptr) field_lengths, MYF(0));
+
+		if (error != DB_SUCCESS) {
+
+			break;
+		}
+	}
+
+	row_mysql_unlock_data_dictionary(trx);
+
+	for (i = 0; error == DB_SUCCESS && i < num_of_keys; i++) {
+
+		error = row_merge_build_index(trx, indexes[i],
+					user_thd->variables.sortbuff_size);
+	}
+
+	if (error == DB_SUCCESS) {
+		innobase_commit_low(trx);
+	} else {
+		/* Rolling back the inserts to SYS_INDEXES frees the index
+		trees. The indexes are removed from the cache after that,
+		because the adaptive hash index of the freed pages refers
+		to them. */
+
+		row_mysql_lock_data_dictionary(trx);
+
+		trx_general_rollback_for_mysql(trx, FALSE, NULL);
+
+		for (i = 0; i < n_created; i++) {
+			dict_index_remove_from_cache(prebuilt->table,
+						     indexes[i]);
+		}
+
+		row_mysql_unlock_data_dictionary(trx);
+
+		/* A duplicate key is reported without the index, which
+		does not exist in MySQL, see info() */
+
+		prebuilt->trx->error_info = NULL;
+	}
+
+	/* Flush the log to reduce probability that the .frm files and
+	the InnoDB data dictionary get out-of-sync if the user runs
+	with innodb_flush_log_at_trx_commit = 0 */
+
+	log_buffer_flush_to_disk();
+
+	srv_active_wake_master_thread();
+
+	trx_free_for_mysql(trx);
+
+	my_free((gptr) indexes, MYF(0));
+
+	DBUG_RETURN(convert_error_code_to_mysql((int) error, user_thd));
+}
+
+/*********************************************************************
+Drops secondary indexes of an InnoDB table without copying the table.
+The indexes needed by foreign key constraints cannot be dropped. */
+
+int
+ha_innobase::drop_index(
+/*====================*/
+				/* out: error number */
+	TABLE*	table_arg,	/* in: table */
+	uint*	key_num,	/* in: the numbers of the keys to drop */
+	uint	num_of_keys)	/* in: number of keys */
+{
+	row_prebuilt_t*	prebuilt	= (row_prebuilt_t*) innobase_prebuilt;
+	dict_index_t**	indexes;
+	trx_t*		trx;
+	ulint		error;
+	uint		i;
+
+	DBUG_ENTER("ha_innobase::drop_index");
+
+	update_thd(current_thd);
+
+	trx_search_latch_release_if_reserved(prebuilt->trx);
+
+	error = row_lock_table_for_mysql(prebuilt, prebuilt->table, LOCK_X);
+
+	if (error != DB_SUCCESS) {
+
+		DBUG_RETURN(convert_error_code_to_mysql((int) error,
+							user_thd));
+	}
+
+	indexes = (dict_index_t**) my_malloc(sizeof(dict_index_t*)
+					     * num_of_keys, MYF(MY_FAE));
+
+	trx = trx_allocate_for_mysql();
+
+	trx->mysql_thd = user_thd;
+	trx->mysql_query_str = &((*user_thd).query);
+
+	row_mysql_lock_data_dictionary(trx);
+
+	/* Check all the indexes before dropping any of them */
+
+	for (i = 0; error == DB_SUCCESS && i < num_of_keys; i++) {
+		indexes[i] = dict_table_get_index_noninline(prebuilt->table,
+				table_arg->key_info[key_num[i]].name);
+
+		if (indexes[i] == NULL
+		    || (indexes[i]->type & DICT_CLUSTERED)) {
+
+			error = DB_ERROR;
+		}
+	}
+
+	if (error == DB_SUCCESS) {
+		error = row_merge_check_drop_indexes(prebuilt->table,
+						     indexes, num_of_keys);
+	}
+
+	for (i = 0; error == DB_SUCCESS && i < num_of_keys; i++) {
+
+		error = row_merge_drop_index(trx, prebuilt->table,
+					     indexes[i]);
+	}
+
+	prebuilt->index = dict_table_get_first_index_noninline(
+							prebuilt->table);
+
+	innobase_commit_low(trx);
+
+	row_mysql_unlock_data_dictionary(trx);
+
+	log_buffer_flush_to_disk();
+
+	srv_active_wake_master_thread();
+
+	trx_free_for_mysql(trx);
+
+	my_free((gptr) indexes, MYF(0));
+
+	DBUG_RETURN(convert_error_code_to_mysql((int) error, user_thd));
+}
+
 /*********************************************************************
 Discards or imports an InnoDB tablespace. */
 
@@ -5448,13 +5766,13 @@ ha_innobase::info(
     	}
 
 	if (flag & HA_STATUS_CONST) {
-		index = dict_table_get_first_index_noninline(ib_table);
+		for (i = 0; i < table->s->keys; i++) {
+			/* The order of the indexes in InnoDB differs from
+			the order of the keys in MySQL after add_index() */
 
-		if (prebuilt->clust_index_was_generated) {
-			index = dict_table_get_next_index_noninline(index);
-		}
+			index = dict_table_get_index_noninline(ib_table,
+						table->key_info[i].name);
 
-		for (i = 0; i < table->s->keys; i++) {
 			if (index == NULL) {
 				ut_print_timestamp(stderr);
 				sql_print_error("Table %s contains fewer "
@@ -5508,17 +5826,26 @@ ha_innobase::info(
 				  rec_per_key >= ~(ulong) 0 ? ~(ulong) 0 :
 				  (ulong) rec_per_key;
 			}
-
-			index = dict_table_get_next_index_noninline(index);
 		}
 	}
 
   	if (flag & HA_STATUS_ERRKEY) {
 		ut_a(prebuilt->trx && prebuilt->trx->magic_n == TRX_MAGIC_N);
 
-		errkey = (unsigned int) row_get_mysql_key_number_for_index(
-				       (dict_index_t*)
-				       trx_get_error_info(prebuilt->trx));
+		index = (dict_index_t*) trx_get_error_info(prebuilt->trx);
+
+		/* The index is not known to MySQL if add_index() failed */
+
+		errkey = (uint) -1;
+
+		for (i = 0; index && i < table->s->keys; i++) {
+			if (0 == innobase_strcasecmp(index->name,
+					table->key_info[i].name)) {
+				errkey = (uint) i;
+
+				break;
+			}
+		}
   	}
 
 	if (flag & HA_STATUS_AUTO && table->found_next_number_field) {
@@ -5916,6 +6243,40 @@ ha_innobase::free_foreign_key_create_info(
 	}
 }
 
+/**********************************************************************
+Checks if the current SQL statement will read the whole result set of the
+scans on its tables, so that InnoDB can prefetch the rows in big batches
+right from the start of each scan. This is the case in INSERT ... SELECT
+and CREATE TABLE ... SELECT, and in a SELECT that groups or sorts its
+result, as long as no LIMIT or subquery can stop a scan early. */
+static
+ibool
+innobase_stmt_reads_all_rows(
+/*=========================*/
+			/* out: TRUE if the scans read all rows */
+	THD*	thd)	/* in: user thread handle */
+{
+	LEX*		lex = thd->lex;
+	SELECT_LEX*	select_lex = &lex->select_lex;
+
+	if (!lex->is_single_level_stmt() || select_lex->explicit_limit) {
+
+		return(FALSE);
+	}
+
+	switch (lex->sql_command) {
+		case SQLCOM_INSERT_SELECT:
+		case SQLCOM_REPLACE_SELECT:
+		case SQLCOM_CREATE_TABLE:
+			return(TRUE);
+		case SQLCOM_SELECT:
+			return(select_lex->group_list.elements > 0
+			       || select_lex->order_list.elements > 0);
+		default:
+			return(FALSE);
+	}
+}
+
 /***********************************************************************
 Tells something additional to the handler about how to do things. */
 
@@ -5943,8 +6304,15 @@ ha_innobase::extra(
                         if (prebuilt->blob_heap) {
                                 row_mysql_prebuilt_free_blob_heap(prebuilt);
                         }
+			/* Do not keep a fetch cache grown by a big scan
+			allocated while the handle sits in the table cache */
+			if (prebuilt->fetch_cache_size
+			    > MYSQL_FETCH_CACHE_SIZE) {
+				row_mysql_prebuilt_free_fetch_cache(prebuilt);
+			}
                         prebuilt->keep_other_fields_on_keyread = 0;
                         prebuilt->read_just_key = 0;
+			prebuilt->fetch_bulk = FALSE;
                         break;
   		case HA_EXTRA_RESET_STATE:
 	        	prebuilt->keep_other_fields_on_keyread = 0;
@@ -5969,6 +6337,13 @@ ha_innobase::extra(
 		case HA_EXTRA_KEYREAD_PRESERVE_FIELDS:
 			prebuilt->keep_other_fields_on_keyread = 1;
 			break;
+		case HA_EXTRA_CACHE:
+			prebuilt->fetch_bulk = TRUE;
+			break;
+		case HA_EXTRA_NO_CACHE:
+			prebuilt->fetch_bulk = innobase_stmt_reads_all_rows(
+							current_thd);
+			break;
 		default:/* Do nothing */
 			;
 	}
@@ -5976,6 +6351,29 @@ ha_innobase::extra(
 	return(0);
 }
 
+/**********************************************************************
+MySQL calls this with HA_EXTRA_CACHE before it reads all rows of the table
+in a sequential scan, for example in filesort. We then prefetch the rows in
+big batches and use the size of the MySQL read cache as the memory budget
+of the fetch cache. */
+
+int
+ha_innobase::extra_opt(
+/*===================*/
+				/* out: 0 or error number */
+	enum ha_extra_function operation,
+				/* in: HA_EXTRA_CACHE or some other flag */
+	ulong	cache_size)	/* in: size of the read cache in bytes */
+{
+	row_prebuilt_t*	prebuilt = (row_prebuilt_t*) innobase_prebuilt;
+
+	if (operation == HA_EXTRA_CACHE) {
+		prebuilt->fetch_cache_budget = cache_size;
+	}
+
+	return(extra(operation));
+}
+
 /**********************************************************************
 MySQL calls this function at the start of each SQL statement inside LOCK
 TABLES. Inside LOCK TABLES the ::external_lock method does not work to
@@ -6015,6 +6413,8 @@ ha_innobase::start_stmt(
 	prebuilt->hint_need_to_fetch_extra_cols = 0;
 	prebuilt->read_just_key = 0;
         prebuilt->keep_other_fields_on_keyread = FALSE;
+	prebuilt->fetch_cache_budget = thd->variables.read_buff_size;
+	prebuilt->fetch_bulk = innobase_stmt_reads_all_rows(thd);
 
 	if (!prebuilt->mysql_has_locked) {
 	        /* This handle is for a temporary table created inside
@@ -6110,6 +6510,10 @@ ha_innobase::external_lock(
 	prebuilt->read_just_key = 0;
 	prebuilt->keep_other_fields_on_keyread = FALSE;
 
+	prebuilt->fetch_cache_budget = thd->variables.read_buff_size;
+	prebuilt->fetch_bulk = lock_type != F_UNLCK
+			&& innobase_stmt_reads_all_rows(thd);
+
 	if (lock_type == F_WRLCK) {
 
 		/* If this is a SELECT, then it is in UPDATE TABLE ...
@@ -6149,6 +6553,16 @@ ha_innobase::external_lock(
 
 				read_view_close_for_mysql(trx);
                         }
+
+			/* A SELECT in the AUTOCOMMIT=1 mode is a read-only
+			transaction if it only does consistent reads: InnoDB
+			does not put such a transaction to its trx list, and
+			does not reserve the kernel mutex for it */
+
+			trx->read_only = trx->conc_state == TRX_NOT_STARTED
+				&& !(thd->options
+				     & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN))
+				&& thd->lex->sql_command == SQLCOM_SELECT;
 		}
 
 		if (trx->isolation_level == TRX_ISO_SERIALIZABLE
@@ -6168,6 +6582,16 @@ ha_innobase::external_lock(
 			prebuilt->stored_select_lock_type = LOCK_S;
 		}
 
+		if (prebuilt->select_lock_type != LOCK_NONE) {
+			/* A locking read or a write to any table of the
+			statement makes the transaction read-write */
+
+			ut_ad(!trx->read_only
+			      || trx->conc_state == TRX_NOT_STARTED);
+
+			trx->read_only = FALSE;
+		}
+
 		/* Starting from 4.1.9, no InnoDB table lock is taken in LOCK
 		TABLES if AUTOCOMMIT=1. It does not make much sense to acquire
 		an InnoDB table lock if it is released immediately at the end
@@ -6236,6 +6660,12 @@ ha_innobase::external_lock(
 				read_view_close_for_mysql(trx);
 			}
 		}
+
+		if (trx->conc_state == TRX_NOT_STARTED) {
+			/* The statement did not start the transaction */
+
+			trx->read_only = FALSE;
+		}
 	}
 
 	DBUG_RETURN(0);
@@ -7231,8 +7661,11 @@ innobase_xa_prepare(
                   thread2> prepare; write to binlog; commit
                   thread1>                           ... commit
 
-                To ensure this will not happen we're taking the mutex on
-                prepare, and releasing it on commit.
+                To ensure this will not happen the binlog hands out a
+                ticket with every transaction it writes, and
+                innobase_commit() commits in ticket order. Preparing
+                needs no ordering, so the log flushes of concurrent
+                prepares are grouped by log_write_up_to().
 
                 Note: only do it for normal commits, done via ha_commit_trans.
                 If 2pc protocol is executed by external transaction
@@ -7242,7 +7675,6 @@ innobase_xa_prepare(
                 will be between XA PREPARE and XA COMMIT, and we don't want
                 to block for undefined period of time.
                 */
-                pthread_mutex_lock(&prepare_commit_mutex);
                 trx->active_trans = 2;
         }
 
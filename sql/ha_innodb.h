@@ -144,6 +144,7 @@ class ha_innobase: public handler
         int optimize(THD* thd,HA_CHECK_OPT* check_opt);
 	int discard_or_import_tablespace(my_bool discard);
   	int extra(enum ha_extra_function operation);
+	int extra_opt(enum ha_extra_function operation, ulong cache_size);
   	int external_lock(THD *thd, int lock_type);
 	int transactional_table_lock(THD *thd, int lock_type);
         int start_stmt(THD *thd, thr_lock_type lock_type);
@@ -156,6 +157,9 @@ class ha_innobase: public handler
 	void update_create_info(HA_CREATE_INFO* create_info);
   	int create(const char *name, register TABLE *form,
 					HA_CREATE_INFO *create_info);
+	ulong index_ddl_flags(KEY* wanted_index) const;
+	int add_index(TABLE* table_arg, KEY* key_info, uint num_of_keys);
+	int drop_index(TABLE* table_arg, uint* key_num, uint num_of_keys);
 	int delete_all_rows();
   	int delete_table(const char *name);
 	int rename_table(const char* from, const char* to);
@@ -203,9 +207,13 @@ extern longlong innobase_buffer_pool_size, innobase_log_file_size;
 extern long innobase_log_buffer_size;
 extern long innobase_additional_mem_pool_size;
 extern long innobase_buffer_pool_awe_mem_mb;
+extern long innobase_buffer_pool_instances;
 extern long innobase_file_io_threads, innobase_lock_wait_timeout;
+extern long innobase_aio_queue_depth;
+extern long innobase_adaptive_hash_index_partitions;
 extern long innobase_force_recovery;
 extern long innobase_open_files;
+extern long innobase_purge_threads;
 extern char *innobase_data_home_dir, *innobase_data_file_path;
 extern char *innobase_log_group_home_dir, *innobase_log_arch_dir;
 extern char *innobase_unix_file_flush_method;
@@ -218,7 +226,8 @@ extern my_bool innobase_log_archive,
 	       innobase_file_per_table, innobase_locks_unsafe_for_binlog,
 	       innobase_rollback_on_timeout,
                innobase_create_status_file,
-               innobase_adaptive_hash_index;
+               innobase_adaptive_hash_index,
+               innobase_adaptive_flushing;
 extern my_bool innobase_very_fast_shutdown; /* set this to 1 just before
 					    calling innobase_end() if you want
 					    InnoDB to shut down without
@@ -226,6 +235,7 @@ extern my_bool innobase_very_fast_shutdown; /* set this to 1 just before
 					    is equivalent to a 'crash' */
 extern "C" {
 extern ulong srv_max_buf_pool_modified_pct;
+extern ulong srv_io_capacity;
 extern ulong srv_max_purge_lag;
 extern ulong srv_auto_extend_increment;
 extern ulong srv_n_spin_wait_rounds;
@@ -506,7 +506,8 @@ ha_myisam::ha_myisam(TABLE *table_arg)
   int_table_flags(HA_NULL_IN_KEY | HA_CAN_FULLTEXT | HA_CAN_SQL_HANDLER |
                   HA_DUPP_POS | HA_CAN_INDEX_BLOBS | HA_AUTO_PART_KEY |
                   HA_FILE_BASED | HA_CAN_GEOMETRY | HA_READ_RND_SAME |
-                  HA_CAN_INSERT_DELAYED | HA_CAN_BIT_FIELD | HA_CAN_RTREEKEYS),
+                  HA_CAN_INSERT_DELAYED | HA_CAN_BIT_FIELD | HA_CAN_RTREEKEYS |
+                  HA_RND_IN_REF_ORDER),
   can_enable_indexes(1)
 {}
 
@@ -1745,9 +1746,23 @@ int ha_myisam::delete_table(const char *name)
 
 int ha_myisam::external_lock(THD *thd, int lock_type)
 {
-  return mi_lock_database(file, !table->s->tmp_table ?
-			  lock_type : ((lock_type == F_UNLCK) ?
-				       F_UNLCK : F_EXTRA_LCK));
+  int error= mi_lock_database(file, !table->s->tmp_table ?
+                              lock_type : ((lock_type == F_UNLCK) ?
+                                           F_UNLCK : F_EXTRA_LCK));
+  /*
+    Concurrent inserts left holes of deleted rows behind; let the manager
+    thread put them in order when nobody uses the table any more.
+    Testing without a lock: the manager checks again.
+  */
+  if (lock_type == F_UNLCK && file->s->compact_deleted &&
+      !file->s->tot_locks && manager_thread_in_use)
+  {
+    pthread_mutex_lock(&LOCK_manager);
+    manager_status|= MANAGER_MYISAM_COMPACT;
+    pthread_mutex_unlock(&LOCK_manager);
+    pthread_cond_signal(&COND_manager);
+  }
+  return error;
 }
 
 THR_LOCK_DATA **ha_myisam::store_lock(THD *thd,
@@ -2510,6 +2510,14 @@ int ha_table_exists_in_engine(THD* thd, const char* db, const char* name)
     Sorting is done within each range. If you want an overall sort, enter
     'ranges' with sorted ranges.
 
+    If the result need not be sorted and the caller gives a buffer that
+    the handler doesn't need for itself, the rows of a table whose rows
+    are not stored in primary key order are read in the order of their
+    rowids: the index is read first (only the index, which needs
+    HA_KEYREAD_ONLY) and the rowids of as many rows as fit into the
+    buffer are sorted and then read with rnd_pos().  The rows are then
+    returned in the order they are stored in, not per range.
+
   RETURN
     0			OK, found a row
     HA_ERR_END_OF_FILE	No rows in range
@@ -2525,6 +2533,22 @@ int handler::read_multi_range_first(KEY_MULTI_RANGE **found_range_p,
   multi_range_sorted= sorted;
   multi_range_buffer= buffer;
 
+  multi_range_rowid_order=
+    (!sorted && buffer && !table->key_read &&
+     !(table_flags() & HA_NEED_READ_RANGE_BUFFER) &&
+     !primary_key_is_clustered() &&
+     (index_flags(active_index, 0, 1) & HA_KEYREAD_ONLY) &&
+     (size_t) (buffer->buffer_end - buffer->buffer) >=
+     ref_length + sizeof(KEY_MULTI_RANGE*));
+  if (multi_range_rowid_order)
+  {
+    multi_range_curr= ranges;
+    multi_range_end= ranges + range_count;
+    multi_range_skip= 0;
+    multi_range_rowid_curr= multi_range_rowid_end= 0;
+    DBUG_RETURN(read_multi_range_next(found_range_p));
+  }
+
   for (multi_range_curr= ranges, multi_range_end= ranges + range_count;
        multi_range_curr < multi_range_end;
        multi_range_curr++)
@@ -2569,6 +2593,29 @@ int handler::read_multi_range_next(KEY_MULTI_RANGE **found_range_p)
   int result;
   DBUG_ENTER("handler::read_multi_range_next");
 
+  if (multi_range_rowid_order)
+  {
+    uint entry_length= ref_length + sizeof(KEY_MULTI_RANGE*);
+    for (;;)
+    {
+      while (multi_range_rowid_curr < multi_range_rowid_end)
+      {
+        byte *entry= multi_range_rowid_curr;
+        multi_range_rowid_curr+= entry_length;
+        if ((result= rnd_pos(table->record[0], entry)) ==
+            HA_ERR_RECORD_DELETED)
+          continue;
+        memcpy((byte*) found_range_p, entry + ref_length,
+               sizeof(KEY_MULTI_RANGE*));
+        DBUG_RETURN(result);
+      }
+      if (multi_range_curr == multi_range_end)
+        DBUG_RETURN(HA_ERR_END_OF_FILE);
+      if ((result= read_multi_range_rowids()))
+        DBUG_RETURN(result);
+    }
+  }
+
   /* We should not be called after the last call returned EOF. */
   DBUG_ASSERT(multi_range_curr < multi_range_end);
 
@@ -2616,6 +2663,89 @@ int handler::read_multi_range_next(KEY_MULTI_RANGE **found_range_p)
 }
 
 
+static int cmp_multi_range_rowid(const void *file, const void *a,
+                                 const void *b)
+{
+  return ((handler*) file)->cmp_ref((const byte*) a, (const byte*) b);
+}
+
+
+/*
+  Read the rowids of the next rows of a multi-range set and sort them
+
+  SYNOPSIS
+    read_multi_range_rowids()
+
+  NOTES
+    Fills multi_range_buffer with (rowid, range) pairs, starting with
+    row multi_range_skip of range multi_range_curr.  A range that doesn't
+    fit is read again from its start the next time; its first rows are
+    skipped.
+
+  RETURN
+    0			OK
+    #			Error code
+*/
+
+int handler::read_multi_range_rowids()
+{
+  uint entry_length= ref_length + sizeof(KEY_MULTI_RANGE*);
+  byte *pos= (byte*) multi_range_buffer->buffer;
+  const byte *end= multi_range_buffer->buffer_end;
+  int result= 0;
+  DBUG_ENTER("handler::read_multi_range_rowids");
+
+  extra(HA_EXTRA_KEYREAD);
+  for (; multi_range_curr < multi_range_end;
+       multi_range_curr++, multi_range_skip= 0)
+  {
+    ha_rows skip= multi_range_skip;
+    for (result= read_range_first(multi_range_curr->start_key.length ?
+                                  &multi_range_curr->start_key : 0,
+                                  multi_range_curr->end_key.length ?
+                                  &multi_range_curr->end_key : 0,
+                                  test(multi_range_curr->range_flag &
+                                       EQ_RANGE),
+                                  FALSE);
+         !result ;
+         result= read_range_next())
+    {
+      if (skip)
+      {
+        skip--;
+        continue;
+      }
+      if (pos + entry_length > end)
+        goto full;
+      position(table->record[0]);
+      memcpy(pos, ref, ref_length);
+      memcpy(pos + ref_length, (byte*) &multi_range_curr,
+             sizeof(KEY_MULTI_RANGE*));
+      pos+= entry_length;
+      multi_range_skip++;
+      if (multi_range_curr->range_flag == (UNIQUE_RANGE | EQ_RANGE))
+        break;
+    }
+    if (result && result != HA_ERR_END_OF_FILE)
+      break;
+    result= 0;
+  }
+full:
+  extra(HA_EXTRA_NO_KEYREAD);
+  if (result)
+    DBUG_RETURN(result);
+
+  multi_range_rowid_curr= (byte*) multi_range_buffer->buffer;
+  multi_range_rowid_end= pos;
+  my_qsort2(multi_range_rowid_curr,
+            (size_t) (pos - multi_range_rowid_curr) / entry_length,
+            entry_length, cmp_multi_range_rowid, (void*) this);
+  DBUG_PRINT("info", ("rowids: %lu",
+                      (ulong) (pos - multi_range_rowid_curr) / entry_length));
+  DBUG_RETURN(0);
+}
+
+
 /*
   Read first row between two ranges.
   Store ranges for future calls to read_range_next
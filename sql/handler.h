@@ -80,6 +80,7 @@
 */
 #define HA_CAN_INSERT_DELAYED  (1 << 14)
 #define HA_PRIMARY_KEY_IN_READ_INDEX (1 << 15)
+#define HA_RND_IN_REF_ORDER    (1 << 16) /* rnd_next() in cmp_ref() order */
 #define HA_CAN_RTREEKEYS       (1 << 17)
 #define HA_NOT_DELETE_WITH_CACHE (1 << 18)
 #define HA_NO_PREFIX_CHAR_KEYS (1 << 20)
@@ -164,6 +165,7 @@
 #define HA_LEX_CREATE_TMP_TABLE	1
 #define HA_LEX_CREATE_IF_NOT_EXISTS 2
 #define HA_LEX_CREATE_TABLE_LIKE 4
+#define HA_LEX_CREATE_INTERNAL_TMP_TABLE 8
 #define HA_OPTION_NO_CHECKSUM	(1L << 17)
 #define HA_OPTION_NO_DELAY_KEY_WRITE (1L << 18)
 #define HA_MAX_REC_LENGTH	65535
@@ -584,6 +586,10 @@ public:
   KEY_MULTI_RANGE *multi_range_curr;
   KEY_MULTI_RANGE *multi_range_end;
   HANDLER_BUFFER *multi_range_buffer;
+  /* Rows are read in rowid order, see read_multi_range_first() */
+  bool multi_range_rowid_order;
+  byte *multi_range_rowid_curr, *multi_range_rowid_end;
+  ha_rows multi_range_skip;             /* Rows of multi_range_curr read */
 
   /* The following are for read_range() */
   key_range save_end_range, *end_range;
@@ -718,6 +724,9 @@ public:
                                      KEY_MULTI_RANGE *ranges, uint range_count,
                                      bool sorted, HANDLER_BUFFER *buffer);
   virtual int read_multi_range_next(KEY_MULTI_RANGE **found_range_p);
+private:
+  int read_multi_range_rowids();
+public:
   virtual int read_range_first(const key_range *start_key,
                                const key_range *end_key,
                                bool eq_range, bool sorted);
@@ -3428,6 +3428,7 @@ void debug_sync_point(const char* lock_name, uint lock_timeout)
   {
     ull->locked=1;
     ull->thread=thd->real_id;
+    ull->thread_id= thd->thread_id;
     thd->ull=ull;
   }
   pthread_mutex_unlock(&LOCK_user_locks);
@@ -3605,11 +3606,16 @@ longlong Item_func_release_lock::val_int()
   }
   else
   {
-    DBUG_PRINT("info", ("ull->locked=%d ull->thread=%ld thd=%ld", 
+    DBUG_PRINT("info", ("ull->locked=%d ull->thread_id=%lu thd=%lu", 
                         (int) ull->locked,
-                        (long)ull->thread,
-                        (long)thd->real_id));
-    if (ull->locked && pthread_equal(thd->real_id,ull->thread))
+                        ull->thread_id,
+                        thd->thread_id));
+    /*
+      Compare the connection rather than the OS thread: with the
+      pool-of-threads scheduler each statement of a connection may run
+      in a different thread.
+    */
+    if (ull->locked && ull->thread_id == thd->thread_id)
     {
       DBUG_PRINT("info", ("release lock"));
       result=1;					// Release is ok
@@ -27,6 +27,7 @@ SUBSELECT TODO:
 
 #include "mysql_priv.h"
 #include "sql_select.h"
+#include <myisam.h>
 
 inline Item * and_items(Item* cond, Item *item)
 {
@@ -641,6 +642,20 @@ void Item_exists_subselect::fix_length_and_dec()
   unit->global_parameters->select_limit= new Item_int((int32) 1);
 }
 
+
+void Item_in_subselect::fix_length_and_dec()
+{
+  if (!is_materialized())
+  {
+    Item_exists_subselect::fix_length_and_dec();
+    return;
+  }
+  /* All rows of a materialized subquery are needed: no LIMIT 1 here */
+  decimals= 0;
+  max_length= 1;
+  max_columns= engine->cols();
+}
+
 double Item_exists_subselect::val_real()
 {
   DBUG_ASSERT(fixed == 1);
@@ -1403,6 +1418,181 @@ Item_in_subselect::row_value_transformer(JOIN *join)
 }
 
 
+/*
+  Check if a column type is compared as a temporal value
+*/
+
+static bool is_temporal_type(enum_field_types type)
+{
+  return (type == MYSQL_TYPE_DATE || type == MYSQL_TYPE_NEWDATE ||
+          type == MYSQL_TYPE_TIME || type == MYSQL_TYPE_DATETIME ||
+          type == MYSQL_TYPE_TIMESTAMP || type == MYSQL_TYPE_YEAR);
+}
+
+
+/*
+  Decide whether an IN subquery is executed by materialization
+
+  SYNOPSIS
+    Item_in_subselect::choose_materialization()
+      join  Join object of the subquery (i.e. 'child' join).
+
+  DESCRIPTION
+    Materialization is possible for an uncorrelated single SELECT when
+    every column pair of the predicate can be compared by looking up the
+    left value in a unique key over the subquery columns: both sides must
+    have the same result type, collation and signedness, temporal values
+    the same column type, and the columns must fit into a key (no BLOBs).
+    NULLs in a row comparison are only allowed if the predicate is a
+    top-level one, where NULL and FALSE need not be told apart.
+
+    The IN->EXISTS transformation executes the subquery for every outer
+    row, but it may turn into an index lookup when the first subquery
+    column is indexed (unique_subquery/index_subquery). The cost of both
+    methods is estimated in rows read:
+
+      IN->EXISTS:       outer_rows * (indexed ? 1 : inner_rows)
+      materialization:  inner_rows + outer_rows
+
+  RETURN
+    TRUE   materialize the subquery
+    FALSE  use the IN->EXISTS transformation
+*/
+
+bool Item_in_subselect::choose_materialization(JOIN *join)
+{
+  SELECT_LEX *select_lex= join->select_lex;
+  List_iterator_fast<Item> it(select_lex->item_list);
+  TABLE_LIST *tl;
+  Item *inner;
+  uint key_length= 0;
+  double outer_rows= 1.0, inner_rows= 1.0, exists_cost;
+  bool indexed= FALSE;
+  DBUG_ENTER("Item_in_subselect::choose_materialization");
+
+  if (!thd->variables.optimizer_subquery_materialization ||
+      substype() != IN_SUBS ||
+      engine->engine_type() != subselect_engine::SINGLE_SELECT_ENGINE ||
+      select_lex->master_unit()->uncacheable || select_lex->uncacheable ||
+      !select_lex->table_list.elements ||
+      select_lex->item_list.elements != left_expr->cols() ||
+      left_expr->cols() > MAX_REF_PARTS)
+    DBUG_RETURN(FALSE);
+
+  for (uint i= 0; (inner= it++); i++)
+  {
+    Item *outer= left_expr->element_index(i);
+    Item_result type= inner->result_type();
+
+    if (outer->result_type() != type || type == ROW_RESULT ||
+        (!abort_on_null && left_expr->cols() > 1 &&
+         (outer->maybe_null || inner->maybe_null)))
+      DBUG_RETURN(FALSE);
+    if (type == INT_RESULT && outer->unsigned_flag != inner->unsigned_flag)
+      DBUG_RETURN(FALSE);
+    if (type == STRING_RESULT &&
+        (outer->collation.collation != inner->collation.collation ||
+         inner->max_length / inner->collation.collation->mbmaxlen >
+         CONVERT_IF_BIGGER_TO_BLOB))
+      DBUG_RETURN(FALSE);
+    if ((is_temporal_type(outer->field_type()) ||
+         is_temporal_type(inner->field_type())) &&
+        outer->field_type() != inner->field_type())
+      DBUG_RETURN(FALSE);
+    switch (inner->field_type()) {
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_GEOMETRY:
+    case MYSQL_TYPE_BIT:
+      DBUG_RETURN(FALSE);
+    default:
+      break;
+    }
+    /* value, NULL marker and VARCHAR length */
+    key_length+= inner->max_length + 3;
+  }
+  if (key_length >= MI_MAX_KEY_LENGTH)
+    DBUG_RETURN(FALSE);
+
+  inner= select_lex->item_list.head()->real_item();
+  if (inner->type() == Item::FIELD_ITEM &&
+      !((Item_field *) inner)->field->key_start.is_clear_all())
+    indexed= TRUE;
+
+  for (tl= select_lex->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    if (!tl->table)
+      continue;
+    tl->table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    inner_rows*= (double) max(tl->table->file->records, 1);
+  }
+  for (tl= select_lex->outer_select()->leaf_tables; tl; tl= tl->next_leaf)
+  {
+    if (!tl->table)
+      continue;
+    tl->table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    outer_rows*= (double) max(tl->table->file->records, 1);
+  }
+  exists_cost= outer_rows * (indexed ? 1.0 : inner_rows);
+  DBUG_PRINT("info", ("outer rows: %g  inner rows: %g  indexed: %d",
+                      outer_rows, inner_rows, (int) indexed));
+  DBUG_RETURN(inner_rows + outer_rows < exists_cost);
+}
+
+
+/*
+  Set up execution of an IN subquery by materialization
+
+  SYNOPSIS
+    Item_in_subselect::materialize_transformer()
+      join  Join object of the subquery (i.e. 'child' join).
+
+  DESCRIPTION
+    Unlike the IN->EXISTS transformers this injects nothing into the
+    subquery, which stays uncorrelated. Its rows are sent to a
+    select_materialize_subselect, and the engine is replaced with a
+    subselect_materialize_engine wrapping the original one. The predicate
+    is still wrapped into Item_in_optimizer, which caches the value of the
+    left expression and handles the NULL IN (SELECT ...) case.
+
+  RETURN
+    RES_OK     OK
+    RES_ERROR  Error
+*/
+
+Item_subselect::trans_res
+Item_in_subselect::materialize_transformer(JOIN *join)
+{
+  SELECT_LEX *current= thd->lex->current_select;
+  subselect_single_select_engine *select_engine=
+    (subselect_single_select_engine *) engine;
+  select_materialize_subselect *mat_result;
+  subselect_engine *mat_engine;
+  DBUG_ENTER("Item_in_subselect::materialize_transformer");
+
+  substitution= optimizer;
+  thd->lex->current_select= current->return_after_parsing();
+  //optimizer never use Item **ref => we can pass 0 as parameter
+  if (!optimizer || optimizer->fix_left(thd, 0))
+  {
+    thd->lex->current_select= current;
+    DBUG_RETURN(RES_ERROR);
+  }
+  thd->lex->current_select= current;
+
+  if (!(mat_result= new select_materialize_subselect(this)) ||
+      !(mat_engine= new subselect_materialize_engine(thd, this,
+                                                     select_engine,
+                                                     mat_result)) ||
+      select_engine->change_result(this, mat_result))
+    DBUG_RETURN(RES_ERROR);
+  engine= mat_engine;
+  DBUG_RETURN(RES_OK);
+}
+
+
 Item_subselect::trans_res
 Item_in_subselect::select_transformer(JOIN *join)
 {
@@ -1497,7 +1687,9 @@ Item_in_subselect::select_in_like_transformer(JOIN *join, Comp_creator *func)
     of Item, we have to call fix_fields() for it only with original arena to
     avoid memory leack)
   */
-  if (left_expr->cols() == 1)
+  if (choose_materialization(join))
+    res= materialize_transformer(join);
+  else if (left_expr->cols() == 1)
     res= single_value_transformer(join, func);
   else
   {
@@ -1521,7 +1713,7 @@ err:
 
 void Item_in_subselect::print(String *str)
 {
-  if (transformed)
+  if (transformed && !is_materialized())
     str->append(STRING_WITH_LEN("<exists>"));
   else
   {
@@ -2091,6 +2283,10 @@ int subselect_uniquesubquery_engine::exec()
   TABLE *table= tab->table;
   empty_result_set= TRUE;
   table->status= 0;
+
+  if (table->derived_pending &&
+      mysql_derived_materialize(thd, table->pos_in_table_list))
+    DBUG_RETURN(1);
  
   /* TODO: change to use of 'full_scan' here? */
   if (copy_ref_key())
@@ -2204,6 +2400,10 @@ int subselect_indexsubquery_engine::exec()
   null_keypart= 0;
   table->status= 0;
 
+  if (table->derived_pending &&
+      mysql_derived_materialize(thd, table->pos_in_table_list))
+    DBUG_RETURN(1);
+
   if (check_null)
   {
     /* We need to check for NULL if there wasn't a matching value */
@@ -2537,3 +2737,359 @@ bool subselect_uniquesubquery_engine::no_tables()
   /* returning value is correct, but this method should never be called */
   return 0;
 }
+
+
+/*
+  Create the temporary table that holds the result of a materialized
+  IN subquery
+
+  SYNOPSIS
+    select_materialize_subselect::create_result_table()
+      thd           thread handle
+      column_types  items that define the columns of the table
+
+  DESCRIPTION
+    The table has a unique key over all columns, which removes duplicates
+    on insert and is used by subselect_materialize_engine to look up the
+    value of the left expression of the IN predicate.
+
+  RETURN
+    FALSE  OK
+    TRUE   error
+*/
+
+bool
+select_materialize_subselect::create_result_table(THD *thd_arg,
+                                                  List<Item> *column_types)
+{
+  DBUG_ENTER("select_materialize_subselect::create_result_table");
+  DBUG_ASSERT(table == 0);
+  tmp_table_param.init();
+  tmp_table_param.field_count= column_types->elements;
+
+  if (!(table= create_tmp_table(thd_arg, &tmp_table_param, *column_types,
+                                (ORDER*) 0, 1, 1,
+                                thd_arg->options | TMP_TABLE_ALL_COLUMNS,
+                                HA_POS_ERROR, (char*) "")))
+    DBUG_RETURN(TRUE);
+  table->file->extra(HA_EXTRA_IGNORE_DUP_KEY);
+  records= 0;
+  has_null_row= 0;
+  DBUG_RETURN(FALSE);
+}
+
+
+bool select_materialize_subselect::send_data(List<Item> &items)
+{
+  int error;
+  DBUG_ENTER("select_materialize_subselect::send_data");
+  records++;
+  fill_record(thd, table->field, items, 1);
+  if (thd->net.report_error)
+    DBUG_RETURN(1);
+  /*
+    A row with a NULL never matches the left expression, it can only turn
+    a FALSE result of the IN predicate into NULL; so we just remember it.
+  */
+  for (Field **field= table->field; *field; field++)
+  {
+    if ((*field)->is_null())
+    {
+      has_null_row= 1;
+      DBUG_RETURN(0);
+    }
+  }
+  if ((error= table->file->write_row(table->record[0])))
+  {
+    /* create_myisam_from_heap will generate error if needed */
+    if (error != HA_ERR_FOUND_DUPP_KEY && error != HA_ERR_FOUND_DUPP_UNIQUE &&
+        create_myisam_from_heap(thd, table, &tmp_table_param, error, 1))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+void select_materialize_subselect::cleanup()
+{
+  if (table)
+  {
+    free_tmp_table(thd, table);
+    table= 0;
+  }
+  records= 0;
+  has_null_row= 0;
+}
+
+
+
+
+subselect_materialize_engine::~subselect_materialize_engine()
+{
+  delete materialize_engine;
+}
+
+
+void subselect_materialize_engine::cleanup()
+{
+  TABLE *table= ((select_materialize_subselect *) result)->table;
+  DBUG_ENTER("subselect_materialize_engine::cleanup");
+  if (materialized && table->file->inited)
+    table->file->ha_index_end();
+  materialized= 0;
+  key_buff= 0;
+  /* This also frees the table through select_materialize_subselect */
+  materialize_engine->cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+int subselect_materialize_engine::prepare()
+{
+  materialize_engine->set_thd(thd);
+  return materialize_engine->prepare();
+}
+
+
+void subselect_materialize_engine::fix_length_and_dec(Item_cache **row)
+{
+  materialize_engine->fix_length_and_dec(row);
+}
+
+
+/*
+  Execute the subquery and store its result in the temporary table
+
+  SYNOPSIS
+    subselect_materialize_engine::materialize()
+
+  RETURN
+    FALSE  OK
+    TRUE   error
+*/
+
+bool subselect_materialize_engine::materialize()
+{
+  select_materialize_subselect *mat_result=
+    (select_materialize_subselect *) result;
+  List_iterator_fast<Item> it(materialize_engine->select_lex->item_list);
+  List<Item> column_types;
+  Item *sel_item;
+  TABLE *table;
+  int error;
+  DBUG_ENTER("subselect_materialize_engine::materialize");
+
+  while ((sel_item= it++))
+  {
+    if (column_types.push_back(new Item_type_holder(thd, sel_item)))
+      DBUG_RETURN(TRUE);
+  }
+  if (mat_result->create_result_table(thd, &column_types) ||
+      materialize_engine->exec())
+    DBUG_RETURN(TRUE);
+
+  table= mat_result->table;
+  /* choose_materialization() has checked that the columns fit into a key */
+  DBUG_ASSERT(table->s->keys == 1 && !table->s->uniques);
+  if (!(key_buff= (byte*) thd->alloc(table->key_info->key_length +
+                                     table->key_info->key_parts *
+                                     (HA_KEY_BLOB_LENGTH + 1))))
+    DBUG_RETURN(TRUE);
+  if ((error= table->file->ha_index_init(0)))
+  {
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(TRUE);
+  }
+  DBUG_PRINT("info", ("materialized %lu rows",
+                      (ulong) table->file->records));
+  materialized= 1;
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Check that storing a value into a column has not changed it
+
+  DESCRIPTION
+    choose_materialization() only allows columns of the same result type
+    as the left expression, so the only change possible here is that the
+    value is truncated, rounded or clipped to the range of the column. Such
+    a value cannot be equal to any value in the table.
+*/
+
+static bool stored_value_equal(Field *field, Item *value)
+{
+  switch (value->result_type()) {
+  case INT_RESULT:
+    return field->val_int() == value->val_int();
+  case REAL_RESULT:
+    return field->val_real() == value->val_real();
+  case DECIMAL_RESULT:
+  {
+    my_decimal field_buff, value_buff;
+    return !my_decimal_cmp(field->val_decimal(&field_buff),
+                           value->val_decimal(&value_buff));
+  }
+  case STRING_RESULT:
+  {
+    char field_buff[MAX_FIELD_WIDTH], value_buff[MAX_FIELD_WIDTH];
+    String field_str(field_buff, sizeof(field_buff), field->charset());
+    String value_str(value_buff, sizeof(value_buff),
+                     value->collation.collation);
+    String *res1= field->val_str(&field_str);
+    String *res2= value->val_str(&value_str);
+    return !sortcmp(res1, res2, value->collation.collation);
+  }
+  default:
+    DBUG_ASSERT(0);
+    return FALSE;
+  }
+}
+
+
+/*
+  Build the lookup key from the value of the left expression
+
+  SYNOPSIS
+    subselect_materialize_engine::make_lookup_key()
+      cache  cached value of the left expression
+
+  DESCRIPTION
+    The value is stored into the columns of the table and the key is
+    copied from there in the format the temporary table handlers expect:
+    a NULL marker for nullable columns and a 2 byte length for VARCHAR.
+
+  RETURN
+    TRUE   key_buff holds the key
+    FALSE  the value cannot be in the table: a part of it is NULL or does
+           not fit into its column
+*/
+
+bool subselect_materialize_engine::make_lookup_key(Item_cache *cache)
+{
+  TABLE *table= ((select_materialize_subselect *) result)->table;
+  KEY_PART_INFO *key_part= table->key_info->key_part;
+  KEY_PART_INFO *key_part_end= key_part + table->key_info->key_parts;
+  enum_check_fields save_count_cuted_fields= thd->count_cuted_fields;
+  byte *key= key_buff;
+  bool res= TRUE;
+
+  restore_record(table, s->default_values);
+  thd->count_cuted_fields= CHECK_FIELD_IGNORE;
+  for (uint i= 0; res && i < cache->cols(); i++)
+  {
+    Item *value= cache->element_index(i);
+    Field *field= table->field[i];
+    if (value->null_value)
+      res= FALSE;
+    else
+    {
+      (void) value->save_in_field(field, 1);
+      res= stored_value_equal(field, value);
+    }
+  }
+  thd->count_cuted_fields= save_count_cuted_fields;
+  if (!res)
+    return FALSE;
+
+  for (; key_part < key_part_end; key_part++)
+  {
+    Field *field= key_part->field;
+    if (field->real_maybe_null())
+      *key++= 0;
+    if (field->type() == MYSQL_TYPE_VARCHAR)
+    {
+      field->get_key_image((char*) key, key_part->length, Field::itRAW);
+      key+= HA_KEY_BLOB_LENGTH + key_part->length;
+    }
+    else
+    {
+      memcpy(key, table->record[0] + key_part->offset, key_part->length);
+      key+= key_part->length;
+    }
+  }
+  key_length= (uint) (key - key_buff);
+  return TRUE;
+}
+
+
+/*
+  Look up the left expression in the materialized subquery
+
+  SYNOPSIS
+    subselect_materialize_engine::exec()
+
+  DESCRIPTION
+    The subquery is executed on the first call only. The IN predicate is
+    TRUE if the value is found in the table, NULL if it is not found but
+    the subquery returned a row with a NULL, and FALSE otherwise. The
+    NULL IN (SELECT ...) case is handled by Item_in_optimizer with the
+    help of no_rows().
+
+  RETURN
+    0  OK
+    1  Error
+*/
+
+int subselect_materialize_engine::exec()
+{
+  Item_in_subselect *item_in= (Item_in_subselect *) item;
+  select_materialize_subselect *mat_result=
+    (select_materialize_subselect *) result;
+  TABLE *table;
+  int error;
+  DBUG_ENTER("subselect_materialize_engine::exec");
+
+  if (!materialized && materialize())
+    DBUG_RETURN(1);
+  table= mat_result->table;
+  item_in->value= 0;
+  item_in->was_null= 0;
+
+  if (!make_lookup_key(*item_in->optimizer->get_cache()))
+  {
+    item_in->was_null= mat_result->has_null_row;
+    DBUG_RETURN(0);
+  }
+  error= table->file->index_read(table->record[1], key_buff, key_length,
+                                 HA_READ_KEY_EXACT);
+  if (error && error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
+  {
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(1);
+  }
+  item_in->value= !error;
+  item_in->was_null= error && mat_result->has_null_row;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Check if the materialized subquery returned any rows, including rows
+  with NULLs that were not stored in the table
+*/
+
+bool subselect_materialize_engine::no_rows()
+{
+  return !((select_materialize_subselect *) result)->records;
+}
+
+
+void subselect_materialize_engine::print(String *str)
+{
+  str->append(STRING_WITH_LEN("<materialize>("));
+  materialize_engine->print(str);
+  str->append(')');
+}
+
+
+/*
+  change select_result emulation, never should be called
+*/
+
+bool subselect_materialize_engine::change_result(Item_subselect *si,
+                                                 select_subselect *res)
+{
+  DBUG_ASSERT(0);
+  return TRUE;
+}
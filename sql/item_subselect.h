@@ -118,6 +118,11 @@ public:
   */
   bool is_evaluated() const;
   bool is_uncacheable() const;
+  /*
+    True if the subquery result is materialized into a temporary table that
+    is looked up for every outer row (see subselect_materialize_engine).
+  */
+  bool is_materialized() const;
 
   /*
     Used by max/min subquery to initialize value presence registration
@@ -302,6 +307,9 @@ public:
   trans_res select_in_like_transformer(JOIN *join, Comp_creator *func);
   trans_res single_value_transformer(JOIN *join, Comp_creator *func);
   trans_res row_value_transformer(JOIN * join);
+  bool choose_materialization(JOIN *join);
+  trans_res materialize_transformer(JOIN *join);
+  void fix_length_and_dec();
   longlong val_int();
   double val_real();
   String *val_str(String*);
@@ -317,6 +325,7 @@ public:
   friend class Item_ref_null_helper;
   friend class Item_is_not_null_test;
   friend class subselect_indexsubquery_engine;
+  friend class subselect_materialize_engine;
 };
 
 
@@ -348,6 +357,9 @@ protected:
   enum_field_types res_field_type; /* column type of the results */
   bool maybe_null; /* may be null (first item in select) */
 public:
+  enum enum_engine_type {ABSTRACT_ENGINE, SINGLE_SELECT_ENGINE,
+                         UNION_ENGINE, UNIQUESUBQUERY_ENGINE,
+                         INDEXSUBQUERY_ENGINE, MATERIALIZE_ENGINE};
 
   subselect_engine(Item_subselect *si, select_subselect *res)
     :thd(0)
@@ -404,6 +416,7 @@ public:
   virtual bool is_executed() const { return FALSE; }
   /* Check if subquery produced any rows during last query execution */
   virtual bool no_rows() = 0;
+  virtual enum_engine_type engine_type() { return ABSTRACT_ENGINE; }
 
 protected:
   void set_row(List<Item> &item_list, Item_cache **row);
@@ -435,6 +448,9 @@ public:
   bool may_be_null();
   bool is_executed() const { return executed; }
   bool no_rows();
+  enum_engine_type engine_type() { return SINGLE_SELECT_ENGINE; }
+
+  friend class subselect_materialize_engine;
 };
 
 
@@ -458,6 +474,7 @@ public:
   bool no_tables();
   bool is_executed() const;
   bool no_rows();
+  enum_engine_type engine_type() { return UNION_ENGINE; }
 };
 
 
@@ -516,6 +533,7 @@ public:
   int scan_table();
   bool copy_ref_key();
   bool no_rows() { return empty_result_set; }
+  enum_engine_type engine_type() { return UNIQUESUBQUERY_ENGINE; }
 };
 
 
@@ -565,6 +583,56 @@ public:
   {}
   int exec();
   void print (String *str);
+  enum_engine_type engine_type() { return INDEXSUBQUERY_ENGINE; }
+};
+
+
+/*
+  Engine for an uncorrelated "left_expr IN (SELECT ...)" subquery that is
+  executed only once: the wrapped single select engine sends its rows to a
+  select_materialize_subselect, which stores them in a temporary table with
+  a unique key over all columns. For every outer row the value of the left
+  expression is then looked up in that key.
+*/
+
+class subselect_materialize_engine: public subselect_engine
+{
+  /* the engine that executes the subquery and fills the table */
+  subselect_single_select_engine *materialize_engine;
+  bool materialized; /* the table is filled for this execution */
+  byte *key_buff; /* lookup key built from the left expression */
+  uint key_length;
+
+  bool materialize();
+  bool make_lookup_key(Item_cache *cache);
+public:
+  subselect_materialize_engine(THD *thd_arg, Item_subselect *subs,
+                               subselect_single_select_engine *engine_arg,
+                               select_subselect *result_arg)
+    :subselect_engine(subs, result_arg),
+     materialize_engine(engine_arg), materialized(0), key_buff(0),
+     key_length(0)
+  {
+    set_thd(thd_arg);
+  }
+  ~subselect_materialize_engine();
+  void cleanup();
+  int prepare();
+  void fix_length_and_dec(Item_cache** row);
+  int exec();
+  uint cols() { return materialize_engine->cols(); }
+  uint8 uncacheable() { return materialize_engine->uncacheable(); }
+  void exclude() { materialize_engine->exclude(); }
+  table_map upper_select_const_tables()
+  {
+    return materialize_engine->upper_select_const_tables();
+  }
+  void print (String *str);
+  bool change_result(Item_subselect *si, select_subselect *result);
+  bool no_tables() { return materialize_engine->no_tables(); }
+  bool is_executed() const { return materialized; }
+  bool no_rows();
+  enum_engine_type engine_type() { return MATERIALIZE_ENGINE; }
 };
 
 
@@ -578,4 +646,9 @@ inline bool Item_subselect::is_uncacheable() const
   return engine->uncacheable();
 }
 
+inline bool Item_subselect::is_materialized() const
+{
+  return engine->engine_type() == subselect_engine::MATERIALIZE_ENGINE;
+}
+
 
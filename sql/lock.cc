@@ -896,11 +896,14 @@ int lock_table_name(THD *thd, TABLE_LIST *table_list)
   key_length= (uint)(strmov(strmov(key, db) + 1, table_list->table_name) -
                      key) + 1;
 
-  /* Only insert the table if we haven't insert it already */
+  /*
+    Only insert the table if we haven't insert it already.
+    Tables in the private table cache of the thread are not in use.
+  */
   for (table=(TABLE*) hash_first(&open_cache, (byte*)key, key_length, &state);
        table ;
        table = (TABLE*) hash_next(&open_cache, (byte*)key, key_length, &state))
-    if (table->in_use == thd)
+    if (table->in_use == thd && !unlink_private_table(table))
       DBUG_RETURN(0);
 
   if (!(table= table_cache_insert_placeholder(thd, key, key_length)))
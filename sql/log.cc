@@ -1965,6 +1965,8 @@ uint MYSQL_LOG::next_file_id()
 
 bool MYSQL_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event)
 {
+  File sync_fd= -1;
+  ulong ticket= 0;
   DBUG_ENTER("MYSQL_LOG::write(THD *, IO_CACHE *, Log_event *)");
   VOID(pthread_mutex_lock(&LOCK_log));
 
@@ -2130,7 +2132,22 @@ bool MYSQL_LOG::write(THD *thd, IO_CACHE *cache, Log_event *commit_event)
 #ifndef DBUG_OFF
 DBUG_skip_commit:
 #endif
-    if (flush_and_sync())
+    if (commit_event->get_type_code() == XID_EVENT)
+    {
+      /*
+        Only flush here; the sync is done below, after LOCK_log is
+        released, so that it can be shared with the transactions which
+        are written while we wait for the disk.
+      */
+      if (flush_io_cache(&log_file))
+        goto err;
+      if (++sync_binlog_counter >= sync_binlog_period && sync_binlog_period)
+      {
+        sync_binlog_counter= 0;
+        sync_fd= log_file.file;
+      }
+    }
+    else if (flush_and_sync())
       goto err;
     DBUG_EXECUTE_IF("half_binlogged_transaction", abort(););
     if (cache->error)				// Error on read
@@ -2153,12 +2170,35 @@ DBUG_skip_commit:
       pthread_mutex_lock(&LOCK_prep_xids);
       prepared_xids++;
       pthread_mutex_unlock(&LOCK_prep_xids);
+
+      /*
+        Tickets are handed out under LOCK_log, so their order is the
+        order of the transactions in the binlog.
+      */
+      pthread_mutex_lock(&LOCK_commit_ordered);
+      if (!++last_commit_ticket)
+        last_commit_ticket= 1;
+      ticket= last_commit_ticket;
+      pthread_mutex_unlock(&LOCK_commit_ordered);
+      thd->transaction.commit_ticket= ticket;
+      thd->transaction.commit_binlog_pos= my_b_tell(&log_file);
+      statistic_increment(binlog_commits, &LOCK_status);
     }
     else
       rotate_and_purge(RP_LOCK_LOG_IS_ALREADY_LOCKED);
   }
   VOID(pthread_mutex_unlock(&LOCK_log));
 
+  /*
+    The binlog can't be rotated before this transaction is unlogged,
+    so sync_fd stays valid without LOCK_log.
+  */
+  if (sync_fd >= 0 && sync_commit_group(sync_fd, ticket))
+  {
+    sql_print_error(ER(ER_ERROR_ON_WRITE), name, errno);
+    unlog(0, 0);
+    DBUG_RETURN(1);
+  }
   DBUG_RETURN(0);
 
 err:
@@ -3190,6 +3230,12 @@ int TC_LOG_BINLOG::open(const char *opt_name)
 
   pthread_mutex_init(&LOCK_prep_xids, MY_MUTEX_INIT_FAST);
   pthread_cond_init (&COND_prep_xids, 0);
+  pthread_mutex_init(&LOCK_commit_ordered, MY_MUTEX_INIT_FAST);
+  pthread_cond_init (&COND_commit_ordered, 0);
+  pthread_cond_init (&COND_binlog_synced, 0);
+  last_commit_ticket= synced_commit_ticket= 0;
+  commit_turn= 1;
+  binlog_syncing= FALSE;
 
   if (!my_b_inited(&index_file))
   {
@@ -3271,10 +3317,22 @@ void TC_LOG_BINLOG::close()
   DBUG_ASSERT(prepared_xids==0);
   pthread_mutex_destroy(&LOCK_prep_xids);
   pthread_cond_destroy (&COND_prep_xids);
+  pthread_mutex_destroy(&LOCK_commit_ordered);
+  pthread_cond_destroy (&COND_commit_ordered);
+  pthread_cond_destroy (&COND_binlog_synced);
 }
 
 /*
-  TODO group commit
+  Group commit.
+
+  MYSQL_LOG::write() gives every Xid event a ticket, in binlog order,
+  and does not sync the binlog under LOCK_log. Instead every committer
+  calls sync_commit_group(): the first one to get there syncs the file
+  for all tickets written so far, the others just wait for it.
+  Afterwards the engines commit in ticket order (enter_commit_order()
+  and exit_commit_order()), so the commit order in a transactional
+  engine is the same as in the binlog, but an engine can flush its own
+  log outside of the ordered section (see innobase_commit()).
 
   RETURN
          0  - error
@@ -3284,11 +3342,101 @@ int TC_LOG_BINLOG::log_xid(THD *thd, my_xid xid)
 {
   Xid_log_event xle(thd, xid);
   IO_CACHE *trans_log= (IO_CACHE*)thd->ha_data[binlog_hton.slot];
+  thd->transaction.commit_ticket= 0;
   return !binlog_end_trans(thd, trans_log, &xle);  // invert return value
 }
 
+/*
+  TRUE if ticket a was handed out before ticket b; tickets wrap around
+*/
+#define COMMIT_TICKET_BEFORE(a, b) ((long) ((a) - (b)) < 0)
+
+/*
+  Make sure the binlog is on disk up to (at least) the given ticket
+
+  SYNOPSIS
+    sync_commit_group()
+    fd       binlog file to sync
+    ticket   ticket of the caller
+
+  RETURN
+    0  ok
+    1  error
+*/
+
+bool MYSQL_LOG::sync_commit_group(File fd, ulong ticket)
+{
+  bool error= 0;
+  pthread_mutex_lock(&LOCK_commit_ordered);
+  while (COMMIT_TICKET_BEFORE(synced_commit_ticket, ticket))
+  {
+    ulong sync_up_to;
+    if (binlog_syncing)
+    {
+      pthread_cond_wait(&COND_binlog_synced, &LOCK_commit_ordered);
+      continue;
+    }
+    /* nobody is syncing: become the leader of the group */
+    binlog_syncing= TRUE;
+    sync_up_to= last_commit_ticket;
+    pthread_mutex_unlock(&LOCK_commit_ordered);
+
+    error= my_sync(fd, MYF(MY_WME));
+    statistic_increment(binlog_group_commits, &LOCK_status);
+
+    pthread_mutex_lock(&LOCK_commit_ordered);
+    binlog_syncing= FALSE;
+    if (!error && COMMIT_TICKET_BEFORE(synced_commit_ticket, sync_up_to))
+      synced_commit_ticket= sync_up_to;
+    pthread_cond_broadcast(&COND_binlog_synced);
+    if (error)
+      break;
+  }
+  pthread_mutex_unlock(&LOCK_commit_ordered);
+  return error;
+}
+
+/*
+  Wait until all transactions binlogged before the ticket have
+  committed in the engines
+*/
+
+void MYSQL_LOG::enter_commit_order(ulong ticket)
+{
+  if (!ticket)
+    return;
+  pthread_mutex_lock(&LOCK_commit_ordered);
+  while (COMMIT_TICKET_BEFORE(commit_turn, ticket))
+    pthread_cond_wait(&COND_commit_ordered, &LOCK_commit_ordered);
+  pthread_mutex_unlock(&LOCK_commit_ordered);
+}
+
+/*
+  Let the next transaction in binlog order commit. It's a no-op if the
+  ticket has already passed.
+*/
+
+void MYSQL_LOG::exit_commit_order(ulong ticket)
+{
+  if (!ticket)
+    return;
+  pthread_mutex_lock(&LOCK_commit_ordered);
+  if (commit_turn == ticket)
+  {
+    if (!++commit_turn)
+      commit_turn= 1;
+    pthread_cond_broadcast(&COND_commit_ordered);
+  }
+  pthread_mutex_unlock(&LOCK_commit_ordered);
+}
+
 void TC_LOG_BINLOG::unlog(ulong cookie, my_xid xid)
 {
+  THD *thd= current_thd;
+  /* no engine has taken our turn: make sure the queue keeps moving */
+  enter_commit_order(thd->transaction.commit_ticket);
+  exit_commit_order(thd->transaction.commit_ticket);
+  thd->transaction.commit_ticket= 0;
   pthread_mutex_lock(&LOCK_prep_xids);
   if (--prepared_xids == 0)
     pthread_cond_signal(&COND_prep_xids);
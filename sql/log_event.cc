@@ -1144,7 +1144,8 @@ bool Query_log_event::write(IO_CACHE* file)
             1+6+           // code of charset and charset
             1+1+MAX_TIME_ZONE_NAME_LENGTH+ // code of tz and tz length and tz name
             1+2+           // code of lc_time_names and lc_time_names_number
-            1+2            // code of charset_database and charset_database_number
+            1+2+           // code of charset_database and charset_database_number
+            1+1+MAX_DBS_IN_QUERY_EVENT*(NAME_LEN+1) // code, count and db names
             ], *start, *start_of_status;
   ulong event_length;
 
@@ -1270,6 +1271,30 @@ bool Query_log_event::write(IO_CACHE* file)
     int2store(start, charset_database_number);
     start+= 2;
   }
+  if (accessed_dbs)
+  {
+    /*
+      Older slaves refuse events with more status than
+      MAX_SIZE_LOG_EVENT_STATUS, so if the names do not fit we only say
+      that they are not known.
+    */
+    uint names_len= 0;
+    if (accessed_dbs != OVER_MAX_DBS_IN_QUERY_EVENT)
+    {
+      for (uint i= 0; i < accessed_dbs; i++)
+        names_len+= strlen(accessed_db_names[i]) + 1;
+      if ((uint) (start - start_of_status) + 2 + names_len >
+          MAX_SIZE_LOG_EVENT_STATUS)
+        accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+    }
+    *start++= Q_UPDATED_DB_NAMES;
+    *start++= (uchar) accessed_dbs;
+    if (accessed_dbs != OVER_MAX_DBS_IN_QUERY_EVENT)
+    {
+      for (uint i= 0; i < accessed_dbs; i++)
+        start= (uchar*) strmov((char*) start, accessed_db_names[i]) + 1;
+    }
+  }
   /*
     Here there could be code like
     if (command-line-option-which-says-"log_this_variable" && inited)
@@ -1308,7 +1333,7 @@ bool Query_log_event::write(IO_CACHE* file)
   to the log.  
 */
 Query_log_event::Query_log_event()
-  :Log_event(), data_buf(0)
+  :Log_event(), data_buf(0), accessed_dbs(0)
 {
 }
 
@@ -1348,7 +1373,7 @@ Query_log_event::Query_log_event(THD* thd_arg, const char* query_arg,
    auto_increment_increment(thd_arg->variables.auto_increment_increment),
    auto_increment_offset(thd_arg->variables.auto_increment_offset),
    lc_time_names_number(thd_arg->variables.lc_time_names->number),
-   charset_database_number(0)
+   charset_database_number(0), accessed_dbs(0)
 {
   time_t end_time;
 
@@ -1393,9 +1418,81 @@ Query_log_event::Query_log_event(THD* thd_arg, const char* query_arg,
   }
   else
     time_zone_len= 0;
+
+  /*
+    Tell the slave which databases a data changing statement worked on, so
+    that its parallel appliers can run it alongside statements on other
+    databases. Nothing is logged when it only worked on the default
+    database, which the slave assumes for an INSERT, UPDATE, DELETE or
+    REPLACE without Q_UPDATED_DB_NAMES. Other statements are applied in
+    order on the slave.
+  */
+  if (thd_arg->system_thread & SYSTEM_THREAD_DELAYED_INSERT)
+    accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+  else
+  {
+    switch (thd_arg->lex->sql_command) {
+    case SQLCOM_INSERT:
+    case SQLCOM_INSERT_SELECT:
+    case SQLCOM_REPLACE:
+    case SQLCOM_REPLACE_SELECT:
+    case SQLCOM_UPDATE:
+    case SQLCOM_UPDATE_MULTI:
+    case SQLCOM_DELETE:
+    case SQLCOM_DELETE_MULTI:
+      if (query_arg == thd_arg->query)
+        set_accessed_dbs(thd_arg->lex->query_tables);
+      else
+        accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+      break;
+    default:
+      break;
+    }
+  }
   DBUG_PRINT("info",("Query_log_event has flags2: %lu  sql_mode: %lu",
                      (ulong) flags2, sql_mode));
 }
+
+
+/*
+  Collect the distinct databases of a table list (including the tables of
+  views, triggers and stored functions, which are all in the prelocking
+  list) into accessed_db_names.
+
+  If a temporary table is used, or there are more than
+  MAX_DBS_IN_QUERY_EVENT databases, the databases are reported as unknown.
+  If only the default database is used, none are reported.
+*/
+
+void Query_log_event::set_accessed_dbs(TABLE_LIST *tables)
+{
+  accessed_dbs= 0;
+  for (; tables; tables= tables->next_global)
+  {
+    uint i;
+    if (tables->derived || tables->schema_table || !tables->db ||
+        !tables->db[0])
+      continue;
+    if (tables->table && tables->table->s->tmp_table != NO_TMP_TABLE)
+    {
+      accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+      return;
+    }
+    for (i= 0; i < accessed_dbs; i++)
+      if (!strcmp(accessed_db_names[i], tables->db))
+        break;
+    if (i < accessed_dbs)
+      continue;
+    if (accessed_dbs == MAX_DBS_IN_QUERY_EVENT)
+    {
+      accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+      return;
+    }
+    accessed_db_names[accessed_dbs++]= tables->db;
+  }
+  if (accessed_dbs == 1 && db && !strcmp(accessed_db_names[0], db))
+    accessed_dbs= 0;
+}
 #endif /* MYSQL_CLIENT */
 
 
@@ -1471,6 +1568,7 @@ code_name(int code)
   case Q_CATALOG_NZ_CODE: return "Q_CATALOG_NZ_CODE";
   case Q_LC_TIME_NAMES_CODE: return "Q_LC_TIME_NAMES_CODE";
   case Q_CHARSET_DATABASE_CODE: return "Q_CHARSET_DATABASE_CODE";
+  case Q_UPDATED_DB_NAMES: return "Q_UPDATED_DB_NAMES";
   }
   sprintf(buf, "CODE#%d", code);
   return buf;
@@ -1507,13 +1605,16 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
    db(NullS), catalog_len(0), status_vars_len(0),
    flags2_inited(0), sql_mode_inited(0), charset_inited(0),
    auto_increment_increment(1), auto_increment_offset(1),
-   time_zone_len(0), lc_time_names_number(0), charset_database_number(0)
+   time_zone_len(0), lc_time_names_number(0), charset_database_number(0),
+   accessed_dbs(0)
 {
   ulong data_len;
   uint32 tmp;
   uint8 common_header_len, post_header_len;
   Log_event::Byte *start;
   const Log_event::Byte *end;
+  const Log_event::Byte *db_names= 0;
+  uint db_names_len= 0;
   bool catalog_nz= 1;
   DBUG_ENTER("Query_log_event::Query_log_event(char*,...)");
 
@@ -1649,6 +1750,34 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
       charset_database_number= uint2korr(pos);
       pos+= 2;
       break;
+    case Q_UPDATED_DB_NAMES:
+    {
+      CHECK_SPACE(pos, end, 1);
+      accessed_dbs= *pos++;
+      if (accessed_dbs > MAX_DBS_IN_QUERY_EVENT)
+      {
+        accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+        break;
+      }
+      db_names= pos;
+      for (uint i= 0; i < accessed_dbs; i++)
+      {
+        const Log_event::Byte *name_end=
+          (const Log_event::Byte*) memchr(pos, 0, (uint) (end - pos));
+        if (!name_end)
+        {
+          /* Truncated list: treat as unknown */
+          accessed_dbs= OVER_MAX_DBS_IN_QUERY_EVENT;
+          pos= end;
+          break;
+        }
+        accessed_db_names[i]= (const char*) pos;    // Will be copied later
+        pos= name_end + 1;
+      }
+      if (accessed_dbs != OVER_MAX_DBS_IN_QUERY_EVENT)
+        db_names_len= (uint) (pos - db_names);
+      break;
+    }
     default:
       /* That's why you must write status vars in growing order of code */
       DBUG_PRINT("info",("Query_log_event has unknown status vars (first has\
@@ -1660,6 +1789,7 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
 #if !defined(MYSQL_CLIENT) && defined(HAVE_QUERY_CACHE)
   if (!(start= data_buf = (Log_event::Byte*) my_malloc(catalog_len + 1 +
                                               time_zone_len + 1 +
+                                              db_names_len +
                                               data_len + 1 +
                                               QUERY_CACHE_FLAGS_SIZE +
                                               db_len + 1,
@@ -1667,6 +1797,7 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
 #else
   if (!(start= data_buf = (Log_event::Byte*) my_malloc(catalog_len + 1 +
                                              time_zone_len + 1 +
+                                             db_names_len +
                                              data_len + 1,
                                              MYF(MY_WME))))
 #endif
@@ -1684,6 +1815,14 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
   }
   if (time_zone_len)
     copy_str_and_move(&time_zone_str, &start, time_zone_len);
+  if (db_names_len)
+  {
+    memcpy(start, db_names, db_names_len);
+    for (uint i= 0; i < accessed_dbs; i++)
+      accessed_db_names[i]= (const char*) start +
+                            (accessed_db_names[i] - (const char*) db_names);
+    start+= db_names_len;
+  }
 
   /* A 2nd variable part; this is common to all versions */ 
   memcpy((char*) start, end, data_len);          // Copy db and query
@@ -1874,7 +2013,7 @@ void Query_log_event::print(FILE* file, PRINT_EVENT_INFO* print_event_info)
 
 #if defined(HAVE_REPLICATION) && !defined(MYSQL_CLIENT)
 
-static const char *rewrite_db(const char *db)
+const char *rewrite_db(const char *db)
 {
   if (replicate_rewrite_db.is_empty() || db == NULL)
     return db;
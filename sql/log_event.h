@@ -273,6 +273,18 @@ struct sql_ex_info
 #define Q_LC_TIME_NAMES_CODE    7
 
 #define Q_CHARSET_DATABASE_CODE 8
+
+/*
+  Q_UPDATED_DB_NAMES lists the databases a DML statement accessed, so that
+  a slave with parallel appliers knows which events are independent: a
+  count byte and that many zero-terminated names.
+  OVER_MAX_DBS_IN_QUERY_EVENT as count means "unknown, apply in order".
+  It is not logged when the statement only accessed the default database.
+*/
+#define Q_UPDATED_DB_NAMES      12
+
+#define MAX_DBS_IN_QUERY_EVENT       16
+#define OVER_MAX_DBS_IN_QUERY_EVENT  254
 /* Intvar event post-header */
 
 #define I_TYPE_OFFSET        0
@@ -800,6 +812,13 @@ public:
   const char *time_zone_str;
   uint lc_time_names_number; /* 0 means en_US */
   uint charset_database_number;
+  /*
+    Databases of the tables the statement accessed (Q_UPDATED_DB_NAMES):
+    0 means not logged (only the default database for a DML statement),
+    OVER_MAX_DBS_IN_QUERY_EVENT means not known.
+  */
+  uint accessed_dbs;
+  const char *accessed_db_names[MAX_DBS_IN_QUERY_EVENT];
 
 #ifndef MYSQL_CLIENT
 
@@ -807,6 +826,7 @@ public:
                   bool using_trans, bool suppress_use,
                   THD::killed_state killed_err_arg= THD::KILLED_NO_VALUE);
   const char* get_db() { return db; }
+  void set_accessed_dbs(TABLE_LIST *tables);
 #ifdef HAVE_REPLICATION
   void pack_info(Protocol* protocol);
   int exec_event(struct st_relay_log_info* rli);
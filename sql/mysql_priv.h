@@ -216,6 +216,12 @@ MY_LOCALE *my_locale_by_number(uint number);
 */
 #define TIME_FOR_COMPARE_ROWID  (TIME_FOR_COMPARE*2)
 
+/*
+  The same for index_merge with optimizer_sort_intersect, where rowids are
+  compared in memory with handler::cmp_ref() and no row is checked
+*/
+#define TIME_FOR_COMPARE_ROWID_MEM  (TIME_FOR_COMPARE*100)
+
 /*
   For sequential disk seeks the cost formula is:
     DISK_SEEK_BASE_COST + DISK_SEEK_PROP_COST * #blocks_to_skip  
@@ -662,7 +668,7 @@ struct Query_cache_query_flags
 #define query_cache_store_query(A, B) query_cache.store_query(A, B)
 #define query_cache_destroy() query_cache.destroy()
 #define query_cache_result_size_limit(A) query_cache.result_size_limit(A)
-#define query_cache_init() query_cache.init()
+#define query_cache_init() query_cache.init(query_cache_partitions)
 #define query_cache_resize(A) query_cache.resize(A)
 #define query_cache_set_min_res_unit(A) query_cache.set_min_res_unit(A)
 #define query_cache_invalidate3(A, B, C) query_cache.invalidate(A, B, C)
@@ -729,6 +735,11 @@ void init_update_queries(void);
 void free_max_user_conn(void);
 pthread_handler_t handle_one_connection(void *arg);
 pthread_handler_t handle_bootstrap(void *arg);
+bool login_connection(THD *thd);
+void end_connection(THD *thd);
+bool do_command(THD *thd);
+void create_thread_to_handle_connection(THD *thd);
+void unlink_thd(THD *thd);
 void end_thread(THD *thd,bool put_in_cache);
 void flush_thread_cache();
 int mysql_execute_command(THD *thd);
@@ -805,6 +816,7 @@ bool mysql_handle_derived(LEX *lex, bool (*processor)(THD *thd,
                                                       TABLE_LIST *table));
 bool mysql_derived_prepare(THD *thd, LEX *lex, TABLE_LIST *t);
 bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *t);
+bool mysql_derived_materialize(THD *thd, TABLE_LIST *t);
 Field *create_tmp_field(THD *thd, TABLE *table,Item *item, Item::Type type,
 			Item ***copy_func, Field **from_field,
                         Field **def_field,
@@ -1137,6 +1149,8 @@ bool rename_temporary_table(THD* thd, TABLE *table, const char *new_db,
 			    const char *table_name);
 void remove_db_from_cache(const char *db);
 void flush_tables();
+bool unlink_private_table(TABLE *table);
+void close_private_tables(THD *thd);
 bool is_equal(const LEX_STRING *a, const LEX_STRING *b);
 
 /* bits for last argument to remove_table_from_cache() */
@@ -1194,6 +1208,8 @@ int write_record(THD *thd, TABLE *table, COPY_INFO *info);
 /* sql_manager.cc */
 /* bits set in manager_status */
 #define MANAGER_BERKELEY_LOG_CLEANUP    (1L << 0)
+#define MANAGER_QUERY_CACHE_RECLAIM     (1L << 1)
+#define MANAGER_MYISAM_COMPACT          (1L << 2)
 extern ulong volatile manager_status;
 extern bool volatile manager_thread_in_use, mqh_used;
 extern pthread_t manager_thread;
@@ -1288,6 +1304,7 @@ extern ulonglong keybuff_size;
 extern ulonglong thd_startup_options;
 extern ulong flush_version, thread_id;
 extern ulong binlog_cache_use, binlog_cache_disk_use;
+extern ulong binlog_commits, binlog_group_commits;
 extern ulong aborted_threads,aborted_connects;
 extern ulong delayed_insert_timeout;
 extern ulong delayed_insert_limit, delayed_queue_size;
@@ -1295,10 +1312,11 @@ extern ulong delayed_insert_threads, delayed_insert_writes;
 extern ulong delayed_rows_in_use,delayed_insert_errors;
 extern ulong slave_open_temp_tables;
 extern ulong query_cache_size, query_cache_min_res_unit;
+extern ulong query_cache_limit, query_cache_partitions;
 extern ulong slow_launch_threads, slow_launch_time;
-extern ulong table_cache_size;
+extern ulong table_cache_size, table_cache_per_thread;
 extern ulong max_connections,max_connect_errors, connect_timeout;
-extern ulong slave_net_timeout, slave_trans_retries;
+extern ulong slave_net_timeout, slave_trans_retries, slave_parallel_workers;
 extern uint max_user_connections;
 extern ulong what_to_log,flush_time;
 extern ulong query_buff_size, thread_stack;
@@ -1561,6 +1579,7 @@ void init_read_record(READ_RECORD *info, THD *thd, TABLE *reg_form,
 		      int use_record_cache, bool print_errors);
 void init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table, 
                           bool print_error, uint idx);
+void init_read_record_rowids(READ_RECORD *info, THD *thd, TABLE *table);
 void end_read_record(READ_RECORD *info);
 ha_rows filesort(THD *thd, TABLE *form,struct st_sort_field *sortorder,
 		 uint s_length, SQL_SELECT *select,
@@ -22,6 +22,7 @@
 #include "stacktrace.h"
 #include "mysqld_suffix.h"
 #include "mysys_err.h"
+#include "scheduler.h"
 #ifdef HAVE_BERKELEY_DB
 #include "ha_berkeley.h"
 #endif
@@ -300,6 +301,15 @@ static TYPELIB tc_heuristic_recover_typelib=
   array_elements(tc_heuristic_recover_names)-1,"",
   tc_heuristic_recover_names, NULL
 };
+const char *thread_handling_names[]=
+{
+  "one-thread-per-connection", "pool-of-threads", NullS
+};
+TYPELIB thread_handling_typelib=
+{
+  array_elements(thread_handling_names)-1,"",
+  thread_handling_names, NULL
+};
 const char *first_keyword= "first", *binary_keyword= "BINARY";
 const char *my_localhost= "localhost", *delayed_user= "DELAYED";
 #if SIZEOF_OFF_T > 4 && defined(BIG_TABLES)
@@ -430,11 +440,15 @@ uint tc_heuristic_recover= 0;
 uint volatile thread_count, thread_running;
 ulonglong thd_startup_options;
 ulong back_log, connect_timeout, concurrency, server_id;
-ulong table_cache_size, thread_stack, what_to_log;
+ulong table_cache_size, table_cache_per_thread, thread_stack, what_to_log;
 ulong query_buff_size, slow_launch_time, slave_open_temp_tables;
 ulong open_files_limit, max_binlog_size, max_relay_log_size;
-ulong slave_net_timeout, slave_trans_retries;
+ulong slave_net_timeout, slave_trans_retries, slave_parallel_workers;
 ulong thread_cache_size=0, binlog_cache_size=0, max_binlog_cache_size=0;
+ulong thread_handling;
+ulong thread_pool_size, thread_pool_max_active, thread_pool_stall_limit;
+ulong thread_pool_max_threads, thread_pool_threads;
+scheduler_functions thread_scheduler;
 ulong query_cache_size=0;
 ulong refresh_version, flush_version;	/* Increments on each reload */
 query_id_t global_query_id;
@@ -444,6 +458,7 @@ ulong delayed_insert_threads, delayed_insert_writes, delayed_rows_in_use;
 ulong delayed_insert_errors,flush_time;
 ulong specialflag=0;
 ulong binlog_cache_use= 0, binlog_cache_disk_use= 0;
+ulong binlog_commits= 0, binlog_group_commits= 0;
 ulong max_connections, max_connect_errors;
 uint  max_user_connections= 0;
 /*
@@ -581,6 +596,7 @@ static int cleanup_done;
 static ulong opt_specialflag, opt_myisam_block_size;
 static char *opt_logname, *opt_update_logname, *opt_binlog_index_name;
 static char *opt_slow_logname, *opt_tc_heuristic_recover;
+char *opt_thread_handling;
 static char *mysql_home_ptr, *pidfile_name_ptr;
 static char **defaults_argv;
 static char *opt_bin_logname;
@@ -634,9 +650,10 @@ int allow_severity = LOG_INFO;
 int deny_severity = LOG_WARNING;
 #endif
 #ifdef HAVE_QUERY_CACHE
-static ulong query_cache_limit= 0;
+ulong query_cache_limit= 0;
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
-Query_cache query_cache;
+ulong query_cache_partitions= 1;
+Partitioned_query_cache query_cache;
 #endif
 #ifdef HAVE_SMEM
 char *shared_memory_base_name= default_shared_memory_base_name;
@@ -823,6 +840,7 @@ static void close_connections(void)
       continue;
 
     tmp->killed= THD::KILL_CONNECTION;
+    thread_scheduler.post_kill_notification(tmp);
     if (tmp->mysys_var)
     {
       tmp->mysys_var->abort=1;
@@ -883,6 +901,7 @@ static void close_connections(void)
   }
   (void) pthread_mutex_unlock(&LOCK_thread_count);
 
+  thread_scheduler.end();
   DBUG_PRINT("quit",("close_connections thread"));
   DBUG_VOID_RETURN;
 }
@@ -1703,6 +1722,32 @@ extern "C" sig_handler end_thread_signal(int sig __attribute__((unused)))
 }
 
 
+/*
+  Remove a connection from the list of threads and free it
+
+  SYNOPSIS
+    unlink_thd()
+    thd		 Thread handler
+
+  NOTES
+    Used by schedulers that don't end the OS thread together with the
+    connection.
+*/
+
+void unlink_thd(THD *thd)
+{
+  DBUG_ENTER("unlink_thd");
+  thd->cleanup();
+  (void) pthread_mutex_lock(&LOCK_thread_count);
+  thread_count--;
+  delete thd;
+  (void) pthread_mutex_unlock(&LOCK_thread_count);
+  /* It's safe to broadcast outside a lock (COND... is not deleted here) */
+  (void) pthread_cond_broadcast(&COND_thread_count);
+  DBUG_VOID_RETURN;
+}
+
+
 void end_thread(THD *thd, bool put_in_cache)
 {
   DBUG_ENTER("end_thread");
@@ -3508,6 +3553,10 @@ static void create_maintenance_thread()
 #ifdef HAVE_BERKELEY_DB
       (have_berkeley_db == SHOW_OPTION_YES) ||
 #endif
+#ifdef HAVE_QUERY_CACHE
+      query_cache_size ||
+#endif
+      myisam_concurrent_insert ||
       (flush_time && flush_time != ~(ulong) 0L))
   {
     pthread_t hThread;
@@ -3828,6 +3877,12 @@ we force server id to 2, but this MySQL server will not act as a slave.");
     }
   }
 
+  if (thread_scheduler.init())
+  {
+    end_thr_alarm(1);				// Don't allow alarms
+    unireg_abort(1);
+  }
+
   create_shutdown_thread();
   create_maintenance_thread();
 
@@ -4144,6 +4199,72 @@ static bool read_init_file(char *file_name)
 
 
 #ifndef EMBEDDED_LIBRARY
+/*
+  Create a thread, or wake up a cached one, to handle a new connection
+
+  SYNOPSIS
+    create_thread_to_handle_connection()
+      thd           Thread handle of the connection
+
+  NOTES
+    This is the add_connection() function of the one-thread-per-connection
+    scheduler. It's called with LOCK_thread_count locked and unlocks it.
+
+    In single-threaded mode (#define ONE_THREAD) connection will be
+    handled inside this function.
+*/
+
+void create_thread_to_handle_connection(THD *thd)
+{
+  safe_mutex_assert_owner(&LOCK_thread_count);
+#ifdef ONE_THREAD
+  if (test_flags & TEST_NO_THREADS)		// For debugging under Linux
+  {
+    thread_cache_size=0;			// Safety
+    threads.append(thd);
+    thd->real_id=pthread_self();
+    (void) pthread_mutex_unlock(&LOCK_thread_count);
+    handle_one_connection((void*) thd);
+    return;
+  }
+#endif
+  if (cached_thread_count > wake_thread)
+  {
+    thread_cache.append(thd);
+    wake_thread++;
+    pthread_cond_signal(&COND_thread_cache);
+  }
+  else
+  {
+    int error;
+    thread_created++;
+    threads.append(thd);
+    DBUG_PRINT("info",(("creating thread %lu"), thd->thread_id));
+    thd->connect_time = time(NULL);
+    if ((error=pthread_create(&thd->real_id,&connection_attrib,
+                              handle_one_connection,
+                              (void*) thd)))
+    {
+      DBUG_PRINT("error",
+                 ("Can't create thread to handle request (error %d)",
+                  error));
+      thread_count--;
+      thd->killed= THD::KILL_CONNECTION;			// Safety
+      (void) pthread_mutex_unlock(&LOCK_thread_count);
+      statistic_increment(aborted_connects,&LOCK_status);
+      net_printf_error(thd, ER_CANT_CREATE_THREAD, error);
+      (void) pthread_mutex_lock(&LOCK_thread_count);
+      close_connection(thd,0,0);
+      delete thd;
+      (void) pthread_mutex_unlock(&LOCK_thread_count);
+      return;
+    }
+  }
+  (void) pthread_mutex_unlock(&LOCK_thread_count);
+  DBUG_PRINT("info",("Thread created"));
+}
+
+
 /*
   Create new thread to handle incoming connection.
 
@@ -4152,12 +4273,10 @@ static bool read_init_file(char *file_name)
       thd in/out    Thread handle of future thread.
 
   DESCRIPTION
-    This function will create new thread to handle the incoming
-    connection.  If there are idle cached threads one will be used.
-    'thd' will be pushed into 'threads'.
-
-    In single-threaded mode (#define ONE_THREAD) connection will be
-    handled inside this function.
+    This function will check the connection limits and hand the new
+    connection over to the thread scheduler, which either creates a
+    thread for it (or wakes up a cached one) or queues it in the pool of
+    threads. 'thd' will be pushed into 'threads'.
 
   RETURN VALUE
     none
@@ -4187,57 +4306,10 @@ static void create_new_thread(THD *thd)
   /* Start a new thread to handle connection */
   thread_count++;
 
-#ifdef ONE_THREAD
-  if (test_flags & TEST_NO_THREADS)		// For debugging under Linux
-  {
-    thread_cache_size=0;			// Safety
-    threads.append(thd);
-    thd->real_id=pthread_self();
-    (void) pthread_mutex_unlock(&LOCK_thread_count);
-    handle_one_connection((void*) thd);
-  }
-  else
-#endif
-  {
-    if (thread_count-delayed_insert_threads > max_used_connections)
-      max_used_connections=thread_count-delayed_insert_threads;
+  if (thread_count-delayed_insert_threads > max_used_connections)
+    max_used_connections=thread_count-delayed_insert_threads;
 
-    if (cached_thread_count > wake_thread)
-    {
-      thread_cache.append(thd);
-      wake_thread++;
-      pthread_cond_signal(&COND_thread_cache);
-    }
-    else
-    {
-      int error;
-      thread_created++;
-      threads.append(thd);
-      DBUG_PRINT("info",(("creating thread %lu"), thd->thread_id));
-      thd->connect_time = time(NULL);
-      if ((error=pthread_create(&thd->real_id,&connection_attrib,
-				handle_one_connection,
-				(void*) thd)))
-      {
-	DBUG_PRINT("error",
-		   ("Can't create thread to handle request (error %d)",
-		    error));
-	thread_count--;
-	thd->killed= THD::KILL_CONNECTION;			// Safety
-	(void) pthread_mutex_unlock(&LOCK_thread_count);
-	statistic_increment(aborted_connects,&LOCK_status);
-	net_printf_error(thd, ER_CANT_CREATE_THREAD, error);
-	(void) pthread_mutex_lock(&LOCK_thread_count);
-	close_connection(thd,0,0);
-	delete thd;
-	(void) pthread_mutex_unlock(&LOCK_thread_count);
-	DBUG_VOID_RETURN;
-      }
-    }
-    (void) pthread_mutex_unlock(&LOCK_thread_count);
-
-  }
-  DBUG_PRINT("info",("Thread created"));
+  thread_scheduler.add_connection(thd);
   DBUG_VOID_RETURN;
 }
 #endif /* EMBEDDED_LIBRARY */
@@ -4892,6 +4964,7 @@ enum options_mysqld
   OPT_INTERACTIVE_TIMEOUT, OPT_JOIN_BUFF_SIZE,
   OPT_KEY_BUFFER_SIZE, OPT_KEY_CACHE_BLOCK_SIZE,
   OPT_KEY_CACHE_DIVISION_LIMIT, OPT_KEY_CACHE_AGE_THRESHOLD,
+  OPT_KEY_CACHE_SEGMENTS,
   OPT_LONG_QUERY_TIME,
   OPT_LOWER_CASE_TABLE_NAMES, OPT_MAX_ALLOWED_PACKET,
   OPT_MAX_BINLOG_CACHE_SIZE, OPT_MAX_BINLOG_SIZE,
@@ -4911,14 +4984,17 @@ enum options_mysqld
   OPT_OPEN_FILES_LIMIT,
   OPT_PRELOAD_BUFFER_SIZE,
   OPT_QUERY_CACHE_LIMIT, OPT_QUERY_CACHE_MIN_RES_UNIT, OPT_QUERY_CACHE_SIZE,
-  OPT_QUERY_CACHE_TYPE, OPT_QUERY_CACHE_WLOCK_INVALIDATE, OPT_RECORD_BUFFER,
+  OPT_QUERY_CACHE_PARTITIONS, OPT_QUERY_CACHE_TYPE, OPT_QUERY_CACHE_WLOCK_INVALIDATE, OPT_RECORD_BUFFER,
   OPT_RECORD_RND_BUFFER, OPT_DIV_PRECINCREMENT, OPT_RELAY_LOG_SPACE_LIMIT,
   OPT_RELAY_LOG_PURGE,
   OPT_SLAVE_NET_TIMEOUT, OPT_SLAVE_COMPRESSED_PROTOCOL, OPT_SLOW_LAUNCH_TIME,
-  OPT_SLAVE_TRANS_RETRIES, OPT_READONLY, OPT_DEBUGGING,
-  OPT_SORT_BUFFER, OPT_TABLE_CACHE,
+  OPT_SLAVE_TRANS_RETRIES, OPT_SLAVE_PARALLEL_WORKERS, OPT_READONLY,
+  OPT_DEBUGGING,
+  OPT_SORT_BUFFER, OPT_SORT_THREADS, OPT_TABLE_CACHE, OPT_TABLE_CACHE_PER_THREAD,
   OPT_THREAD_CONCURRENCY, OPT_THREAD_CACHE_SIZE,
   OPT_TMP_TABLE_SIZE, OPT_THREAD_STACK,
+  OPT_THREAD_HANDLING, OPT_THREAD_POOL_SIZE, OPT_THREAD_POOL_MAX_ACTIVE,
+  OPT_THREAD_POOL_STALL_LIMIT, OPT_THREAD_POOL_MAX_THREADS,
   OPT_WAIT_TIMEOUT, OPT_MYISAM_REPAIR_THREADS,
   OPT_INNODB_MIRRORED_LOG_GROUPS,
   OPT_INNODB_LOG_FILES_IN_GROUP,
@@ -4926,6 +5002,7 @@ enum options_mysqld
   OPT_INNODB_LOG_BUFFER_SIZE,
   OPT_INNODB_BUFFER_POOL_SIZE,
   OPT_INNODB_BUFFER_POOL_AWE_MEM_MB,
+  OPT_INNODB_BUFFER_POOL_INSTANCES,
   OPT_INNODB_ADDITIONAL_MEM_POOL_SIZE,
   OPT_INNODB_MAX_PURGE_LAG,
   OPT_INNODB_FILE_IO_THREADS,
@@ -4938,6 +5015,7 @@ enum options_mysqld
   OPT_INNODB_TABLE_LOCKS,
   OPT_INNODB_SUPPORT_XA,
   OPT_INNODB_OPEN_FILES,
+  OPT_INNODB_PURGE_THREADS,
   OPT_INNODB_AUTOEXTEND_INCREMENT,
   OPT_INNODB_SYNC_SPIN_LOOPS,
   OPT_INNODB_CONCURRENCY_TICKETS,
@@ -4975,6 +5053,13 @@ enum options_mysqld
   OPT_SYSDATE_IS_NOW,
   OPT_OPTIMIZER_SEARCH_DEPTH,
   OPT_OPTIMIZER_PRUNE_LEVEL,
+  OPT_OPTIMIZER_BATCHED_KEY_ACCESS,
+  OPT_OPTIMIZER_DERIVED_KEYS,
+  OPT_OPTIMIZER_DERIVED_MERGE,
+  OPT_OPTIMIZER_HASH_JOIN,
+  OPT_OPTIMIZER_PLAN_CACHE,
+  OPT_OPTIMIZER_SORT_INTERSECT,
+  OPT_OPTIMIZER_SUBQUERY_MATERIALIZATION,
   OPT_UPDATABLE_VIEWS_WITH_LIMIT,
   OPT_SP_AUTOMATIC_PRIVILEGES,
   OPT_MAX_SP_RECURSION_DEPTH,
@@ -4990,6 +5075,11 @@ enum options_mysqld
   OPT_SECURE_FILE_PRIV,
   OPT_KEEP_FILES_ON_CREATE,
   OPT_INNODB_ADAPTIVE_HASH_INDEX,
+  OPT_INNODB_ADAPTIVE_HASH_INDEX_PARTITIONS,
+  OPT_INNODB_USE_NATIVE_AIO,
+  OPT_INNODB_AIO_QUEUE_DEPTH,
+  OPT_INNODB_ADAPTIVE_FLUSHING,
+  OPT_INNODB_IO_CAPACITY,
   OPT_FEDERATED
 };
 
@@ -5103,7 +5193,7 @@ Disable with --skip-bdb (will save memory).",
    (gptr*) &max_system_variables.completion_type, 0, GET_ULONG,
    REQUIRED_ARG, 0, 0, 2, 0, 1, 0},
   {"concurrent-insert", OPT_CONCURRENT_INSERT,
-   "Use concurrent insert with MyISAM. Disable with --concurrent-insert=0",
+   "Use concurrent insert with MyISAM. With 2 rows are inserted at the end of tables with holes while they are read; the holes are put in order in the background. Disable with --concurrent-insert=0",
    (gptr*) &myisam_concurrent_insert, (gptr*) &myisam_concurrent_insert,
    0, GET_ULONG, OPT_ARG, 1, 0, 2, 0, 0, 0},
   {"console", OPT_CONSOLE, "Write error output on screen; Don't remove the console window on windows.",
@@ -5221,6 +5311,13 @@ Disable with --skip-innodb-checksums.", (gptr*) &innobase_use_checksums,
    "The common part for InnoDB table spaces.", (gptr*) &innobase_data_home_dir,
    (gptr*) &innobase_data_home_dir, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0,
    0},
+  {"innodb_adaptive_flushing", OPT_INNODB_ADAPTIVE_FLUSHING,
+   "Flush dirty pages in the background at the rate the redo log grows "
+   "(enabled by default).  "
+   "Disable with --skip-innodb-adaptive-flushing.",
+   (gptr*) &innobase_adaptive_flushing,
+   (gptr*) &innobase_adaptive_flushing,
+   0, GET_BOOL, NO_ARG, 1, 0, 0, 0, 0, 0},
   {"innodb_adaptive_hash_index", OPT_INNODB_ADAPTIVE_HASH_INDEX,
    "Enable InnoDB adaptive hash index (enabled by default).  "
    "Disable with --skip-innodb-adaptive-hash-index.",
@@ -5271,6 +5368,11 @@ Disable with --skip-innodb-doublewrite.", (gptr*) &innobase_use_doublewrite,
    "Path to InnoDB log files.", (gptr*) &innobase_log_group_home_dir,
    (gptr*) &innobase_log_group_home_dir, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0,
    0, 0},
+  {"innodb_io_capacity", OPT_INNODB_IO_CAPACITY,
+   "Maximum number of pages per second the adaptive flushing of InnoDB "
+   "writes in the background.",
+   (gptr*) &srv_io_capacity, (gptr*) &srv_io_capacity,
+   0, GET_ULONG, REQUIRED_ARG, 200, 100, ULONG_MAX, 0, 0, 0},
   {"innodb_max_dirty_pages_pct", OPT_INNODB_MAX_DIRTY_PAGES_PCT,
    "Percentage of dirty pages allowed in bufferpool.", (gptr*) &srv_max_buf_pool_modified_pct,
    (gptr*) &srv_max_buf_pool_modified_pct, 0, GET_ULONG, REQUIRED_ARG, 90, 0, 100, 0, 0, 0},
@@ -5297,6 +5399,12 @@ Disable with --skip-innodb-doublewrite.", (gptr*) &innobase_use_doublewrite,
    (gptr*) &global_system_variables.innodb_table_locks,
    (gptr*) &global_system_variables.innodb_table_locks,
    0, GET_BOOL, OPT_ARG, 1, 0, 0, 0, 0, 0},
+  {"innodb_use_native_aio", OPT_INNODB_USE_NATIVE_AIO,
+   "Use native asynchronous I/O for InnoDB data files on Linux if the kernel "
+   "supports it (enabled by default). "
+   "Disable with --skip-innodb-use-native-aio.",
+   (gptr*) &innobase_use_native_aio, (gptr*) &innobase_use_native_aio,
+   0, GET_BOOL, NO_ARG, 1, 0, 0, 0, 0, 0},
 #endif /* End HAVE_INNOBASE_DB */
   {"isam", OPT_ISAM, "Obsolete. ISAM storage engine is no longer supported.",
    (gptr*) &opt_isam, (gptr*) &opt_isam, 0, GET_BOOL, NO_ARG, 0, 0, 0,
@@ -5916,6 +6024,13 @@ log and this option does nothing anymore.",
     (gptr*) &max_system_variables.group_concat_max_len, 0, GET_ULONG,
     REQUIRED_ARG, 1024, 4, ULONG_MAX, 0, 1, 0},
 #ifdef HAVE_INNOBASE_DB
+  {"innodb_adaptive_hash_index_partitions",
+   OPT_INNODB_ADAPTIVE_HASH_INDEX_PARTITIONS,
+   "Number of partitions of the InnoDB adaptive hash index; the indexes "
+   "are spread over the partitions, each with its own latch.",
+   (gptr*) &innobase_adaptive_hash_index_partitions,
+   (gptr*) &innobase_adaptive_hash_index_partitions, 0,
+   GET_LONG, REQUIRED_ARG, 8, 1, 64, 0, 1, 0},
   {"innodb_additional_mem_pool_size", OPT_INNODB_ADDITIONAL_MEM_POOL_SIZE,
    "Size of a memory pool InnoDB uses to store data dictionary information and other internal data structures.",
    (gptr*) &innobase_additional_mem_pool_size,
@@ -5926,10 +6041,21 @@ log and this option does nothing anymore.",
    (gptr*) &srv_auto_extend_increment,
    (gptr*) &srv_auto_extend_increment,
    0, GET_ULONG, REQUIRED_ARG, 8L, 1L, 1000L, 0, 1L, 0},
+  {"innodb_aio_queue_depth", OPT_INNODB_AIO_QUEUE_DEPTH,
+   "Maximum number of pending native asynchronous I/O requests per InnoDB "
+   "file I/O thread.",
+   (gptr*) &innobase_aio_queue_depth, (gptr*) &innobase_aio_queue_depth, 0,
+   GET_LONG, REQUIRED_ARG, 256, 32, 4096, 0, 1, 0},
   {"innodb_buffer_pool_awe_mem_mb", OPT_INNODB_BUFFER_POOL_AWE_MEM_MB,
    "If Windows AWE is used, the size of InnoDB buffer pool allocated from the AWE memory.",
    (gptr*) &innobase_buffer_pool_awe_mem_mb, (gptr*) &innobase_buffer_pool_awe_mem_mb, 0,
    GET_LONG, REQUIRED_ARG, 0, 0, 63000, 0, 1, 0},
+  {"innodb_buffer_pool_instances", OPT_INNODB_BUFFER_POOL_INSTANCES,
+   "Number of parts the InnoDB buffer pool is divided into; each part has "
+   "its own mutex, page hash, LRU list and flush list.",
+   (gptr*) &innobase_buffer_pool_instances,
+   (gptr*) &innobase_buffer_pool_instances, 0,
+   GET_LONG, REQUIRED_ARG, 1, 1, 64, 0, 1, 0},
   {"innodb_buffer_pool_size", OPT_INNODB_BUFFER_POOL_SIZE,
    "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
    (gptr*) &innobase_buffer_pool_size, (gptr*) &innobase_buffer_pool_size, 0,
@@ -5979,6 +6105,12 @@ log and this option does nothing anymore.",
    "How many files at the maximum InnoDB keeps open at the same time.",
    (gptr*) &innobase_open_files, (gptr*) &innobase_open_files, 0,
    GET_LONG, REQUIRED_ARG, 300L, 10L, LONG_MAX, 0, 1L, 0},
+  {"innodb_purge_threads", OPT_INNODB_PURGE_THREADS,
+   "Number of threads InnoDB purges old row versions with; 0 lets the "
+   "master thread do the purge, otherwise a dedicated purge thread runs "
+   "the purge batches together with this number minus one purge workers.",
+   (gptr*) &innobase_purge_threads, (gptr*) &innobase_purge_threads, 0,
+   GET_LONG, REQUIRED_ARG, 0, 0, 32, 0, 1, 0},
   {"innodb_sync_spin_loops", OPT_INNODB_SYNC_SPIN_LOOPS,
    "Count of spin-loop rounds in InnoDB mutexes",
    (gptr*) &srv_n_spin_wait_rounds,
@@ -6038,6 +6170,12 @@ log and this option does nothing anymore.",
    (gptr*) 0,
    0, (GET_ULONG | GET_ASK_ADDR) , REQUIRED_ARG, 100,
    1, 100, 0, 1, 0},
+  {"key_cache_segments", OPT_KEY_CACHE_SEGMENTS,
+   "The number of segments in a key cache. Each segment has its own lock, so threads reading different index blocks do not wait for each other. 0 means that the key cache is not segmented.",
+   (gptr*) &dflt_key_cache_var.param_segments,
+   (gptr*) 0,
+   0, (GET_ULONG | GET_ASK_ADDR), REQUIRED_ARG, 0,
+   0, KEY_CACHE_MAX_SEGMENTS, 0, 1, 0},
   {"long_query_time", OPT_LONG_QUERY_TIME,
    "Log all queries that have taken more than long_query_time seconds to execute to file.",
    (gptr*) &global_system_variables.long_query_time,
@@ -6206,6 +6344,31 @@ The minimum value for this variable is 4096.",
    "If this is not 0, then mysqld will use this value to reserve file descriptors to use with setrlimit(). If this value is 0 then mysqld will reserve max_connections*5 or max_connections + table_cache*2 (whichever is larger) number of files.",
    (gptr*) &open_files_limit, (gptr*) &open_files_limit, 0, GET_ULONG,
    REQUIRED_ARG, 0, 0, OS_FILE_LIMIT, 0, 1, 0},
+  {"optimizer_batched_key_access", OPT_OPTIMIZER_BATCHED_KEY_ACCESS,
+   "Look up the rows of a table joined by key for a join buffer of rows of the preceding tables at once, in key order, and read them in the order they are stored in.",
+   (gptr*) &global_system_variables.optimizer_batched_key_access,
+   (gptr*) &max_system_variables.optimizer_batched_key_access,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
+  {"optimizer_derived_keys", OPT_OPTIMIZER_DERIVED_KEYS,
+   "Fill a derived table that has to be materialized only when its first row is read, and give it an index on the columns the outer query joins on.",
+   (gptr*) &global_system_variables.optimizer_derived_keys,
+   (gptr*) &max_system_variables.optimizer_derived_keys,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
+  {"optimizer_derived_merge", OPT_OPTIMIZER_DERIVED_MERGE,
+   "Merge a derived table without grouping, aggregates, DISTINCT, LIMIT or UNION into the outer query like a view with ALGORITHM=MERGE instead of materializing it.",
+   (gptr*) &global_system_variables.optimizer_derived_merge,
+   (gptr*) &max_system_variables.optimizer_derived_merge,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
+  {"optimizer_hash_join", OPT_OPTIMIZER_HASH_JOIN,
+   "Join a table that is read with a full scan through a hash table built from the join buffer when it has equality conditions with the preceding tables.",
+   (gptr*) &global_system_variables.optimizer_hash_join,
+   (gptr*) &max_system_variables.optimizer_hash_join,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
+  {"optimizer_plan_cache", OPT_OPTIMIZER_PLAN_CACHE,
+   "Keep the join order and access methods of the SELECTs of prepared statements and stored procedures for their next executions while the tables, their indexes and the range estimates stay the same.",
+   (gptr*) &global_system_variables.optimizer_plan_cache,
+   (gptr*) &max_system_variables.optimizer_plan_cache,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
   {"optimizer_prune_level", OPT_OPTIMIZER_PRUNE_LEVEL,
    "Controls the heuristic(s) applied during query optimization to prune less-promising partial plans from the optimizer search space. Meaning: 0 - do not apply any heuristic, thus perform exhaustive search; 1 - prune plans based on number of retrieved rows.",
    (gptr*) &global_system_variables.optimizer_prune_level,
@@ -6216,6 +6379,17 @@ The minimum value for this variable is 4096.",
    (gptr*) &global_system_variables.optimizer_search_depth,
    (gptr*) &max_system_variables.optimizer_search_depth,
    0, GET_ULONG, OPT_ARG, MAX_TABLES+1, 0, MAX_TABLES+2, 0, 1, 0},
+  {"optimizer_sort_intersect", OPT_OPTIMIZER_SORT_INTERSECT,
+   "Consider index_merge intersections of range scans that don't return rows in rowid order, and cost index_merge unions on the estimated number of different rows.",
+   (gptr*) &global_system_variables.optimizer_sort_intersect,
+   (gptr*) &max_system_variables.optimizer_sort_intersect,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
+  {"optimizer_subquery_materialization",
+   OPT_OPTIMIZER_SUBQUERY_MATERIALIZATION,
+   "Evaluate an uncorrelated IN subquery by materializing its result once into a temporary table with a unique key and looking up every outer value there, when that is estimated to be cheaper than executing the subquery for every outer row.",
+   (gptr*) &global_system_variables.optimizer_subquery_materialization,
+   (gptr*) &max_system_variables.optimizer_subquery_materialization,
+   0, GET_BOOL, OPT_ARG, 0, 0, 0, 0, 0, 0},
    {"preload_buffer_size", OPT_PRELOAD_BUFFER_SIZE,
     "The size of the buffer that is allocated when preloading indexes",
     (gptr*) &global_system_variables.preload_buff_size,
@@ -6236,6 +6410,12 @@ The minimum value for this variable is 4096.",
    (gptr*) &query_cache_min_res_unit, (gptr*) &query_cache_min_res_unit,
    0, GET_ULONG, REQUIRED_ARG, QUERY_CACHE_MIN_RESULT_DATA_SIZE,
    0, (longlong) ULONG_MAX, 0, 1, 0},
+  {"query_cache_partitions", OPT_QUERY_CACHE_PARTITIONS,
+   "Number of parts the query cache is divided into. A query is cached in "
+   "the part chosen by the hash of its text; every part has its own memory "
+   "and lock.",
+   (gptr*) &query_cache_partitions, (gptr*) &query_cache_partitions, 0,
+   GET_ULONG, REQUIRED_ARG, 1, 1, QUERY_CACHE_MAX_PARTITIONS, 0, 1, 0},
 #endif /*HAVE_QUERY_CACHE*/
   {"query_cache_size", OPT_QUERY_CACHE_SIZE,
    "The memory allocated to store results from old queries.",
@@ -6307,6 +6487,13 @@ The minimum value for this variable is 4096.",
    "Number of seconds to wait for more data from a master/slave connection before aborting the read.",
    (gptr*) &slave_net_timeout, (gptr*) &slave_net_timeout, 0,
    GET_ULONG, REQUIRED_ARG, SLAVE_NET_TIMEOUT, 1, LONG_TIMEOUT, 0, 1, 0},
+  {"slave_parallel_workers", OPT_SLAVE_PARALLEL_WORKERS,
+   "Number of applier threads the slave SQL thread hands transactions to. "
+   "Transactions on different databases are applied in parallel, those on "
+   "the same database in the master's order. 0 applies everything in the "
+   "slave SQL thread. Takes effect at the next START SLAVE.",
+   (gptr*) &slave_parallel_workers, (gptr*) &slave_parallel_workers, 0,
+   GET_ULONG, REQUIRED_ARG, 0, 0, SLAVE_MAX_WORKERS, 0, 1, 0},
   {"slave_transaction_retries", OPT_SLAVE_TRANS_RETRIES,
    "Number of times the slave SQL thread will retry a transaction in case "
    "it failed with a deadlock or elapsed lock wait timeout, "
@@ -6324,6 +6511,11 @@ The minimum value for this variable is 4096.",
    (gptr*) &max_system_variables.sortbuff_size, 0, GET_ULONG, REQUIRED_ARG,
    MAX_SORT_MEMORY, MIN_SORT_MEMORY+MALLOC_OVERHEAD*2, UINT_MAX32, MALLOC_OVERHEAD,
    1, 0},
+  {"sort_threads", OPT_SORT_THREADS,
+   "Number of threads that sort a big sort buffer together.",
+   (gptr*) &global_system_variables.sort_threads,
+   (gptr*) &max_system_variables.sort_threads, 0, GET_ULONG, REQUIRED_ARG,
+   1, 1, 64, 0, 1, 0},
 #ifdef HAVE_BERKELEY_DB
   {"sync-bdb-logs", OPT_BDB_SYNC,
    "Synchronously flush Berkeley DB logs. Enabled by default",
@@ -6342,6 +6534,12 @@ The minimum value for this variable is 4096.",
    "The number of open tables for all threads.", (gptr*) &table_cache_size,
    (gptr*) &table_cache_size, 0, GET_ULONG, REQUIRED_ARG,
    TABLE_OPEN_CACHE_DEFAULT, 1, 512*1024L, 0, 1, 0},
+  {"table_cache_per_thread", OPT_TABLE_CACHE_PER_THREAD,
+   "The number of tables each thread keeps open for its next statements, "
+   "so they can be reused without locking the shared table cache. "
+   "0 disables the per-thread cache.",
+   (gptr*) &table_cache_per_thread, (gptr*) &table_cache_per_thread, 0,
+   GET_ULONG, REQUIRED_ARG, 16, 0, 1024, 0, 1, 0},
   {"table_lock_wait_timeout", OPT_TABLE_LOCK_WAIT_TIMEOUT, "Timeout in "
     "seconds to wait for a table level lock before returning an error. Used"
      " only if the connection has active cursors.",
@@ -6355,6 +6553,30 @@ The minimum value for this variable is 4096.",
    "Permits the application to give the threads system a hint for the desired number of threads that should be run at the same time.",
    (gptr*) &concurrency, (gptr*) &concurrency, 0, GET_ULONG, REQUIRED_ARG,
    DEFAULT_CONCURRENCY, 1, 512, 0, 1, 0},
+  {"thread-handling", OPT_THREAD_HANDLING,
+   "Define threads usage for handling queries: one-thread-per-connection or "
+   "pool-of-threads. pool-of-threads is only supported on Linux.",
+   (gptr*) &opt_thread_handling, (gptr*) &opt_thread_handling,
+   0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"thread_pool_max_active", OPT_THREAD_POOL_MAX_ACTIVE,
+   "How many statements each thread group of the pool-of-threads scheduler "
+   "executes concurrently before new statements are queued.",
+   (gptr*) &thread_pool_max_active, (gptr*) &thread_pool_max_active, 0,
+   GET_ULONG, REQUIRED_ARG, 4, 1, 1024, 0, 1, 0},
+  {"thread_pool_max_threads", OPT_THREAD_POOL_MAX_THREADS,
+   "Maximum number of worker threads in the pool of threads.",
+   (gptr*) &thread_pool_max_threads, (gptr*) &thread_pool_max_threads, 0,
+   GET_ULONG, REQUIRED_ARG, 500, 1, 65536, 0, 1, 0},
+  {"thread_pool_size", OPT_THREAD_POOL_SIZE,
+   "Number of thread groups in the pool of threads. Connections are "
+   "assigned to groups round robin. 0 means the number of CPUs.",
+   (gptr*) &thread_pool_size, (gptr*) &thread_pool_size, 0,
+   GET_ULONG, REQUIRED_ARG, 0, 0, 128, 0, 1, 0},
+  {"thread_pool_stall_limit", OPT_THREAD_POOL_STALL_LIMIT,
+   "Time in milliseconds after which a thread group that has queued "
+   "statements but made no progress is allowed another active thread.",
+   (gptr*) &thread_pool_stall_limit, (gptr*) &thread_pool_stall_limit, 0,
+   GET_ULONG, REQUIRED_ARG, 500, 10, 60*1000L, 0, 1, 0},
   {"thread_stack", OPT_THREAD_STACK,
    "The stack size for each thread.", (gptr*) &thread_stack,
    (gptr*) &thread_stack, 0, GET_ULONG, REQUIRED_ARG,DEFAULT_THREAD_STACK,
@@ -6404,6 +6626,8 @@ struct show_var_st status_vars[]= {
   {"Aborted_connects",         (char*) &aborted_connects,       SHOW_LONG},
   {"Binlog_cache_disk_use",    (char*) &binlog_cache_disk_use,  SHOW_LONG},
   {"Binlog_cache_use",         (char*) &binlog_cache_use,       SHOW_LONG},
+  {"Binlog_commits",           (char*) &binlog_commits,         SHOW_LONG},
+  {"Binlog_group_commits",     (char*) &binlog_group_commits,   SHOW_LONG},
   {"Bytes_received",           (char*) offsetof(STATUS_VAR, bytes_received), SHOW_LONGLONG_STATUS},
   {"Bytes_sent",               (char*) offsetof(STATUS_VAR, bytes_sent), SHOW_LONGLONG_STATUS},
   {"Com_admin_commands",       (char*) offsetof(STATUS_VAR, com_other), SHOW_LONG_STATUS},
@@ -6539,6 +6763,7 @@ struct show_var_st status_vars[]= {
   {"Key_blocks_not_flushed",   (char*) &dflt_key_cache_var.global_blocks_changed, SHOW_KEY_CACHE_LONG},
   {"Key_blocks_unused",        (char*) &dflt_key_cache_var.blocks_unused, SHOW_KEY_CACHE_CONST_LONG},
   {"Key_blocks_used",          (char*) &dflt_key_cache_var.blocks_used, SHOW_KEY_CACHE_CONST_LONG},
+  {"Key_lock_waits",           (char*) &dflt_key_cache_var.global_cache_lock_waits, SHOW_KEY_CACHE_LONGLONG},
   {"Key_read_requests",        (char*) &dflt_key_cache_var.global_cache_r_requests, SHOW_KEY_CACHE_LONGLONG},
   {"Key_reads",                (char*) &dflt_key_cache_var.global_cache_read, SHOW_KEY_CACHE_LONGLONG},
   {"Key_write_requests",       (char*) &dflt_key_cache_var.global_cache_w_requests, SHOW_KEY_CACHE_LONGLONG},
@@ -6555,14 +6780,14 @@ struct show_var_st status_vars[]= {
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONG_STATUS},
   {"Prepared_stmt_count",      (char*) &prepared_stmt_count,    SHOW_LONG_CONST},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_CONST},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_CONST},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_CONST},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_CONST},
+  {"Qcache_free_blocks",       (char*) &query_cache.partition[0].free_memory_blocks, SHOW_QUERY_CACHE_CONST_LONG},
+  {"Qcache_free_memory",       (char*) &query_cache.partition[0].free_memory, SHOW_QUERY_CACHE_CONST_LONG},
+  {"Qcache_hits",              (char*) &query_cache.partition[0].hits, SHOW_QUERY_CACHE_LONG},
+  {"Qcache_inserts",           (char*) &query_cache.partition[0].inserts, SHOW_QUERY_CACHE_LONG},
+  {"Qcache_lowmem_prunes",     (char*) &query_cache.partition[0].lowmem_prunes, SHOW_QUERY_CACHE_LONG},
+  {"Qcache_not_cached",        (char*) &query_cache.partition[0].refused, SHOW_QUERY_CACHE_LONG},
+  {"Qcache_queries_in_cache",  (char*) &query_cache.partition[0].queries_in_cache, SHOW_QUERY_CACHE_CONST_LONG},
+  {"Qcache_total_blocks",      (char*) &query_cache.partition[0].total_blocks, SHOW_QUERY_CACHE_CONST_LONG},
 #endif /*HAVE_QUERY_CACHE*/
   {"Questions",                (char*) 0,                       SHOW_QUESTION},
   {"Rpl_status",               (char*) 0,                 SHOW_RPL_STATUS},
@@ -6570,6 +6795,7 @@ struct show_var_st status_vars[]= {
   {"Select_full_range_join",   (char*) offsetof(STATUS_VAR, select_full_range_join_count), SHOW_LONG_STATUS},
   {"Select_range",             (char*) offsetof(STATUS_VAR, select_range_count), SHOW_LONG_STATUS},
   {"Select_range_check",       (char*) offsetof(STATUS_VAR, select_range_check_count), SHOW_LONG_STATUS},
+  {"Select_reused_plan",       (char*) offsetof(STATUS_VAR, select_plan_reuse_count), SHOW_LONG_STATUS},
   {"Select_scan",	       (char*) offsetof(STATUS_VAR, select_scan_count), SHOW_LONG_STATUS},
   {"Slave_open_temp_tables",   (char*) &slave_open_temp_tables, SHOW_LONG},
   {"Slave_retried_transactions",(char*) 0,                      SHOW_SLAVE_RETRIED_TRANS},
@@ -6612,6 +6838,7 @@ struct show_var_st status_vars[]= {
   {"Tc_log_page_size",         (char*) &tc_log_page_size,       SHOW_LONG},
   {"Tc_log_page_waits",        (char*) &tc_log_page_waits,      SHOW_LONG},
 #endif
+  {"Threadpool_threads",       (char*) &thread_pool_threads,    SHOW_LONG_CONST},
   {"Threads_cached",           (char*) &cached_thread_count,    SHOW_LONG_CONST},
   {"Threads_connected",        (char*) &thread_count,           SHOW_INT_CONST},
   {"Threads_created",	       (char*) &thread_created,		SHOW_LONG_CONST},
@@ -6702,6 +6929,8 @@ static void mysql_init_variables(void)
   opt_disable_networking= opt_skip_show_db=0;
   opt_logname= opt_update_logname= opt_binlog_index_name= opt_slow_logname= 0;
   opt_tc_log_file= (char *)"tc.log";      // no hostname in tc_log file name !
+  thread_handling= SCHEDULER_ONE_THREAD_PER_CONNECTION;
+  opt_thread_handling= (char*) thread_handling_names[thread_handling];
   opt_secure_auth= 0;
   opt_secure_file_priv= 0;
   opt_bootstrap= opt_myisam_log= 0;
@@ -6713,7 +6942,7 @@ static void mysql_init_variables(void)
   test_flags= select_errors= dropping_tables= ha_open_options=0;
   thread_count= thread_running= kill_cached_threads= wake_thread=0;
   slave_open_temp_tables= 0;
-  cached_thread_count= 0;
+  cached_thread_count= thread_pool_threads= 0;
   opt_endinfo= using_udf_functions= 0;
   opt_using_transactions= using_update_log= 0;
   abort_loop= select_thread_in_use= signal_thread_in_use= 0;
@@ -6723,6 +6952,7 @@ static void mysql_init_variables(void)
   delayed_insert_errors= thread_created= 0;
   specialflag= 0;
   binlog_cache_use=  binlog_cache_disk_use= 0;
+  binlog_commits= binlog_group_commits= 0;
   max_used_connections= slow_launch_threads = 0;
   mysqld_user= mysqld_chroot= opt_init_file= opt_bin_logname = 0;
   prepared_stmt_count= 0;
@@ -7465,6 +7695,18 @@ get_one_option(int optid, const struct my_option *opt __attribute__((unused)),
     else if (argument == disabled_my_option)
       myisam_concurrent_insert= 0;      /* --skip-concurrent-insert */
     break;
+  case OPT_THREAD_HANDLING:
+  {
+    int type;
+    if ((type= find_type(argument, &thread_handling_typelib, 2)) <= 0)
+    {
+      fprintf(stderr, "Unknown option to thread-handling: %s\n", argument);
+      exit(1);
+    }
+    thread_handling= (ulong) (type - 1);
+    opt_thread_handling= (char*) thread_handling_names[thread_handling];
+    break;
+  }
   case OPT_TC_HEURISTIC_RECOVER:
   {
     if ((tc_heuristic_recover=find_type(argument,
@@ -7546,6 +7788,7 @@ mysql_getopt_value(const char *keyname, uint key_length,
   case OPT_KEY_CACHE_BLOCK_SIZE:
   case OPT_KEY_CACHE_DIVISION_LIMIT:
   case OPT_KEY_CACHE_AGE_THRESHOLD:
+  case OPT_KEY_CACHE_SEGMENTS:
   {
     KEY_CACHE *key_cache;
     if (!(key_cache= get_or_create_key_cache(keyname, key_length)))
@@ -7559,6 +7802,8 @@ mysql_getopt_value(const char *keyname, uint key_length,
       return (gptr*) &key_cache->param_division_limit;
     case OPT_KEY_CACHE_AGE_THRESHOLD:
       return (gptr*) &key_cache->param_age_threshold;
+    case OPT_KEY_CACHE_SEGMENTS:
+      return (gptr*) &key_cache->param_segments;
     }
   }
   }
@@ -7642,6 +7887,10 @@ static void get_options(int argc,char **argv)
 #ifndef EMBEDDED_LIBRARY
   if (mysqld_chroot)
     set_root(mysqld_chroot);
+  if (thread_handling == SCHEDULER_POOL_OF_THREADS)
+    pool_of_threads_scheduler(&thread_scheduler);
+  else
+    one_thread_per_connection_scheduler(&thread_scheduler);
 #else
   max_allowed_packet= global_system_variables.max_allowed_packet;
   net_buffer_length= global_system_variables.net_buffer_length;
@@ -7936,6 +8185,10 @@ void refresh_status(THD *thd)
   {
     if (ptr->type == SHOW_LONG)
       *(ulong*) ptr->value= 0;
+#ifdef HAVE_QUERY_CACHE
+    else if (ptr->type == SHOW_QUERY_CACHE_LONG)
+      query_cache.status_reset(ptr->value);
+#endif
   }
 
   /* Reset the counters of all key caches (default and named). */
@@ -553,6 +553,7 @@ class TABLE_READ_PLAN;
   class TRP_ROR_INTERSECT;
   class TRP_ROR_UNION;
   class TRP_ROR_INDEX_MERGE;
+  class TRP_INDEX_INTERSECT;
   class TRP_GROUP_MIN_MAX;
 
 struct st_ror_scan_info;
@@ -589,6 +590,9 @@ static
 TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
                                          double read_time);
 static
+TRP_INDEX_INTERSECT *get_best_index_intersect(PARAM *param, SEL_TREE *tree,
+                                              double read_time);
+static
 TRP_GROUP_MIN_MAX *get_best_group_min_max(PARAM *param, SEL_TREE *tree);
 static double get_index_only_read_time(const PARAM* param, ha_rows records,
                                        int keynr);
@@ -1720,6 +1724,7 @@ public:
 class TRP_ROR_INTERSECT;
 class TRP_ROR_UNION;
 class TRP_INDEX_MERGE;
+class TRP_INDEX_INTERSECT;
 
 
 /*
@@ -1810,6 +1815,23 @@ public:
 };
 
 
+/*
+  Plan for QUICK_INDEX_INTERSECT_SELECT scan.
+  The rowids of the first scan are the ones put into Unique.
+*/
+
+class TRP_INDEX_INTERSECT : public TABLE_READ_PLAN
+{
+public:
+  TRP_INDEX_INTERSECT() {}                    /* Remove gcc warning */
+  virtual ~TRP_INDEX_INTERSECT() {}           /* Remove gcc warning */
+  QUICK_SELECT_I *make_quick(PARAM *param, bool retrieve_full_rows,
+                             MEM_ROOT *parent_alloc);
+  TRP_RANGE **range_scans; /* array of ptrs to plans of intersected scans */
+  TRP_RANGE **range_scans_end; /* end of the array */
+};
+
+
 /*
   Plan for a QUICK_GROUP_MIN_MAX_SELECT scan. 
 */
@@ -1962,7 +1984,8 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
   if ((specialflag & SPECIAL_SAFE_MODE) && ! force_quick_range ||
       !limit)
     DBUG_RETURN(0); /* purecov: inspected */
-  if (keys_to_use.is_clear_all())
+  /* A derived table that is not filled yet has no ranges to estimate */
+  if (keys_to_use.is_clear_all() || head->derived_pending)
     DBUG_RETURN(0);
   records= head->file->records;
   if (!records)
@@ -2107,6 +2130,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
       {
         TRP_RANGE         *range_trp;
         TRP_ROR_INTERSECT *rori_trp;
+        TRP_INDEX_INTERSECT *intersect_trp;
         bool can_build_covering= FALSE;
 
         /* Get best 'range' plan and prepare data for making other plans */
@@ -2143,9 +2167,21 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
             if (!rori_trp->is_covering && can_build_covering &&
                 (rori_trp= get_best_covering_ror_intersect(&param, tree,
                                                            best_read_time)))
+            {
               best_trp= rori_trp;
+              best_read_time= best_trp->read_cost;
+            }
           }
         }
+
+        /* Intersection of scans that don't return rowids in rowid order */
+        if (thd->variables.optimizer_sort_intersect &&
+            (intersect_trp= get_best_index_intersect(&param, tree,
+                                                     best_read_time)))
+        {
+          best_trp= intersect_trp;
+          best_read_time= best_trp->read_cost;
+        }
       }
       else
       {
@@ -2309,6 +2345,13 @@ double get_sweep_read_cost(const PARAM *param, ha_rows records)
       E(n_busy_blocks)*
        (DISK_SEEK_BASE_COST + DISK_SEEK_PROP_COST*n_blocks/E(n_busy_blocks)).
 
+      The rowids come out of Unique sorted, and init_read_record_rowids()
+      reads them with a table scan through the record cache when there is a
+      row in most blocks, so the rows of a block are read together.  With
+      optimizer_sort_intersect n_rows is the estimated number of different
+      rowids instead of the sum of the rows of all scans, and the rowid
+      comparisons below cost 1/TIME_FOR_COMPARE_ROWID_MEM.
+
     3. Cost of Unique use is calculated in Unique::get_use_cost function.
 
   ROR-union cost is calculated in the same way index_merge, but instead of
@@ -2333,6 +2376,8 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   double imerge_cost= 0.0;
   ha_rows cpk_scan_records= 0;
   ha_rows non_cpk_scan_records= 0;
+  ha_rows sweep_records;
+  double not_found_part= 1.0;
   bool pk_is_clustered= param->table->file->primary_key_is_clustered();
   bool all_scans_ror_able= TRUE;
   bool all_scans_rors= TRUE;
@@ -2342,6 +2387,9 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   double roru_index_costs;
   ha_rows roru_total_records;
   double roru_intersect_part= 1.0;
+  double rowid_cmp_factor= (param->thd->variables.optimizer_sort_intersect ?
+                            TIME_FOR_COMPARE_ROWID_MEM :
+                            TIME_FOR_COMPARE_ROWID);
   DBUG_ENTER("get_best_disjunct_quick");
   DBUG_PRINT("info", ("Full table scan cost: %g", read_time));
 
@@ -2384,12 +2432,29 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
       cpk_scan_records= (*cur_child)->records;
     }
     else
+    {
       non_cpk_scan_records += (*cur_child)->records;
+      not_found_part*= 1.0 - min(rows2double((*cur_child)->records) /
+                                 max(rows2double(param->table->file->records),
+                                     1.0), 1.0);
+    }
   }
 
+  /*
+    A row found by several scans is read only once from the sorted rowids.
+    With optimizer_sort_intersect estimate the number of different rowids
+    the same way as for the ROR-union below.
+  */
+  sweep_records= non_cpk_scan_records;
+  if (param->thd->variables.optimizer_sort_intersect &&
+      !imerge_too_expensive)
+    sweep_records= min(sweep_records,
+                       (ha_rows) (rows2double(param->table->file->records) *
+                                  (1.0 - not_found_part)) + 1);
+
   DBUG_PRINT("info", ("index_merge scans cost %g", imerge_cost));
   if (imerge_too_expensive || (imerge_cost > read_time) ||
-      (non_cpk_scan_records+cpk_scan_records >= param->table->file->records) &&
+      (sweep_records+cpk_scan_records >= param->table->file->records) &&
       read_time != DBL_MAX)
   {
     /*
@@ -2411,11 +2476,11 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
       Add one ROWID comparison for each row retrieved on non-CPK scan.  (it
       is done in QUICK_RANGE_SELECT::row_in_ranges)
      */
-    imerge_cost += non_cpk_scan_records / TIME_FOR_COMPARE_ROWID;
+    imerge_cost += non_cpk_scan_records / rowid_cmp_factor;
   }
 
   /* Calculate cost(rowid_to_row_scan) */
-  imerge_cost += get_sweep_read_cost(param, non_cpk_scan_records);
+  imerge_cost += get_sweep_read_cost(param, sweep_records);
   DBUG_PRINT("info",("index_merge cost with rowid-to-row scan: %g",
                      imerge_cost));
   if (imerge_cost > read_time)
@@ -2437,7 +2502,8 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
   imerge_cost +=
     Unique::get_use_cost(param->imerge_cost_buff, (uint)non_cpk_scan_records,
                          param->table->file->ref_length,
-                         param->thd->variables.sortbuff_size);
+                         param->thd->variables.sortbuff_size,
+                         rowid_cmp_factor);
   DBUG_PRINT("info",("index_merge total cost: %g (wanted: less then %g)",
                      imerge_cost, read_time));
   if (imerge_cost < read_time)
@@ -2445,7 +2511,7 @@ TABLE_READ_PLAN *get_best_disjunct_quick(PARAM *param, SEL_IMERGE *imerge,
     if ((imerge_trp= new (param->mem_root)TRP_INDEX_MERGE))
     {
       imerge_trp->read_cost= imerge_cost;
-      imerge_trp->records= non_cpk_scan_records + cpk_scan_records;
+      imerge_trp->records= sweep_records + cpk_scan_records;
       imerge_trp->records= min(imerge_trp->records,
                                param->table->file->records);
       imerge_trp->range_scans= range_scans;
@@ -2531,7 +2597,7 @@ skip_to_ror_scan:
   double roru_total_cost;
   roru_total_cost= roru_index_costs +
                    rows2double(roru_total_records)*log((double)n_child_scans) /
-                   (TIME_FOR_COMPARE_ROWID * M_LN2) +
+                   (rowid_cmp_factor * M_LN2) +
                    get_sweep_read_cost(param, roru_total_records);
 
   DBUG_PRINT("info", ("ROR-union: cost %g, %d members", roru_total_cost,
@@ -2552,6 +2618,142 @@ skip_to_ror_scan:
 }
 
 
+static int cmp_range_scan_records(TRP_RANGE **a, TRP_RANGE **b)
+{
+  return ((*a)->records < (*b)->records ? -1 :
+          (*a)->records > (*b)->records ? 1 : 0);
+}
+
+
+/*
+  Get best index intersection plan for a SEL_TREE of a conjunction.
+  SYNOPSIS
+    get_best_index_intersect()
+      param     Parameter from test_quick_select function
+      tree      Range tree of the conjunction; get_key_scans_params() has
+                left the row estimates of its key scans in
+                table->quick_rows
+      read_time Don't create plans with cost > read_time
+
+  NOTES
+    Unlike a ROR-intersection this works with any range scans.  The scans
+    are taken in the order of their number of rows and the plan uses the
+    first n of them for the n that gives the lowest cost:
+
+    cost(index_intersect(scan_1, ..., scan_n)) =
+      SUM_i(cost(index_only_read_i)) +
+      cost(unique_use(rows_1)) +
+      SUM_{i>1}(rows_i) * log2(rows_1) / TIME_FOR_COMPARE_ROWID_MEM +
+      cost(rowid_to_row_scan(out_rows)) + out_rows / TIME_FOR_COMPARE
+
+    where out_rows = table_rows * PROD_i(rows_i / table_rows), assuming the
+    conditions are independent as get_best_ror_intersect() does.  The
+    rowids of scan_1 must fit into the Unique tree in memory, otherwise the
+    other scans couldn't filter them.  The clustered primary key is not
+    used as it needs no rowid to row scan.
+
+  RETURN
+    Created read plan
+    NULL - Out of memory or no cheaper plan than read_time.
+*/
+
+static
+TRP_INDEX_INTERSECT *get_best_index_intersect(PARAM *param, SEL_TREE *tree,
+                                              double read_time)
+{
+  TABLE *table= param->table;
+  handler *file= table->file;
+  double table_records= max(rows2double(file->records), 1.0);
+  bool pk_is_clustered= file->primary_key_is_clustered();
+  TRP_RANGE **scans, **scans_end;
+  TRP_INDEX_INTERSECT *trp;
+  uint n_scans= 0, best_n_scans= 0, i;
+  double cost, best_cost= read_time, best_records= 0.0, out_records;
+  ulong max_in_memory;
+  uint unique_calc_buff_size;
+  DBUG_ENTER("get_best_index_intersect");
+
+  if (!(scans= (TRP_RANGE**) alloc_root(param->mem_root,
+                                        sizeof(TRP_RANGE*)*param->keys)))
+    DBUG_RETURN(NULL);
+  for (uint idx= 0; idx < param->keys; idx++)
+  {
+    uint keynr= param->real_keynr[idx];
+    if (!tree->keys[idx] || !table->quick_keys.is_set(keynr) ||
+        (pk_is_clustered && keynr == table->s->primary_key))
+      continue;
+    if (!(scans[n_scans]= new (param->mem_root) TRP_RANGE(tree->keys[idx],
+                                                          idx)))
+      DBUG_RETURN(NULL);
+    scans[n_scans]->records= table->quick_rows[keynr];
+    scans[n_scans]->read_cost=
+      get_index_only_read_time(param, table->quick_rows[keynr], keynr);
+    n_scans++;
+  }
+  if (n_scans < 2)
+    DBUG_RETURN(NULL);
+  qsort(scans, n_scans, sizeof(TRP_RANGE*), (qsort_cmp) cmp_range_scan_records);
+
+  max_in_memory= (ulong) (param->thd->variables.sortbuff_size /
+                          ALIGN_SIZE(sizeof(TREE_ELEMENT)+file->ref_length));
+  if (scans[0]->records > max_in_memory)
+    DBUG_RETURN(NULL);
+  unique_calc_buff_size=
+    Unique::get_cost_calc_buff_size((ulong) scans[0]->records,
+                                    file->ref_length,
+                                    param->thd->variables.sortbuff_size);
+  if (param->imerge_cost_buff_size < unique_calc_buff_size)
+  {
+    if (!(param->imerge_cost_buff= (uint*)alloc_root(param->mem_root,
+                                                     unique_calc_buff_size)))
+      DBUG_RETURN(NULL);
+    param->imerge_cost_buff_size= unique_calc_buff_size;
+  }
+
+  cost= scans[0]->read_cost +
+        Unique::get_use_cost(param->imerge_cost_buff,
+                             (uint) scans[0]->records, file->ref_length,
+                             param->thd->variables.sortbuff_size,
+                             TIME_FOR_COMPARE_ROWID_MEM);
+  out_records= rows2double(scans[0]->records);
+  for (i= 1; i < n_scans; i++)
+  {
+    double total_cost;
+    cost+= scans[i]->read_cost +
+           rows2double(scans[i]->records) *
+           log(rows2double(scans[0]->records) + 1.0) /
+           (TIME_FOR_COMPARE_ROWID_MEM * M_LN2);
+    if (cost >= best_cost)
+      break;
+    out_records*= rows2double(scans[i]->records) / table_records;
+    if (out_records < 1.0)
+      out_records= 1.0;
+    total_cost= cost + get_sweep_read_cost(param, (ha_rows) out_records) +
+                out_records / TIME_FOR_COMPARE;
+    DBUG_PRINT("info", ("index_intersect of %u scans: cost %g, records %g",
+                        i + 1, total_cost, out_records));
+    if (total_cost < best_cost)
+    {
+      best_cost= total_cost;
+      best_records= out_records;
+      best_n_scans= i + 1;
+    }
+  }
+  if (!best_n_scans)
+    DBUG_RETURN(NULL);
+
+  if (!(trp= new (param->mem_root) TRP_INDEX_INTERSECT))
+    DBUG_RETURN(NULL);
+  trp->range_scans= scans;
+  trp->range_scans_end= scans + best_n_scans;
+  trp->read_cost= best_cost;
+  trp->records= (ha_rows) best_records;
+  DBUG_PRINT("info", ("Returning index_intersect plan: cost %g, records %lu",
+                      trp->read_cost, (ulong) trp->records));
+  DBUG_RETURN(trp);
+}
+
+
 /*
   Calculate cost of 'index only' scan for given index and number of records.
 
@@ -3567,6 +3769,35 @@ QUICK_SELECT_I *TRP_INDEX_MERGE::make_quick(PARAM *param,
   return quick_imerge;
 }
 
+QUICK_SELECT_I *TRP_INDEX_INTERSECT::make_quick(PARAM *param,
+                                                bool retrieve_full_rows,
+                                                MEM_ROOT *parent_alloc)
+{
+  QUICK_INDEX_INTERSECT_SELECT *quick_intersect;
+  QUICK_RANGE_SELECT *quick;
+  /* index_merge always retrieves full rows, ignore retrieve_full_rows */
+  if (!(quick_intersect= new QUICK_INDEX_INTERSECT_SELECT(param->thd,
+                                                          param->table)))
+    return NULL;
+
+  quick_intersect->records= records;
+  quick_intersect->read_time= read_cost;
+  for (TRP_RANGE **range_scan= range_scans; range_scan != range_scans_end;
+       range_scan++)
+  {
+    if (!(quick= (QUICK_RANGE_SELECT*)
+          ((*range_scan)->make_quick(param, FALSE,
+                                     &quick_intersect->alloc))) ||
+        quick_intersect->push_quick_back(quick))
+    {
+      delete quick;
+      delete quick_intersect;
+      return NULL;
+    }
+  }
+  return quick_intersect;
+}
+
 QUICK_SELECT_I *TRP_ROR_INTERSECT::make_quick(PARAM *param,
                                               bool retrieve_full_rows,
                                               MEM_ROOT *parent_alloc)
@@ -6570,7 +6801,7 @@ int QUICK_INDEX_MERGE_SELECT::read_keys_and_merge()
   delete unique;
   doing_pk_scan= FALSE;
   /* start table scan */
-  init_read_record(&read_record, thd, head, (SQL_SELECT*) 0, 1, 1);
+  init_read_record_rowids(&read_record, thd, head);
   /* index_merge currently doesn't support "using index" at all */
   head->file->extra(HA_EXTRA_NO_KEYREAD);
 
@@ -6578,6 +6809,166 @@ int QUICK_INDEX_MERGE_SELECT::read_keys_and_merge()
 }
 
 
+/*
+  Find a rowid in a sorted array of rowids
+
+  RETURN
+    position of the rowid in the array
+    count  if the rowid is not in the array
+*/
+
+static ha_rows find_rowid(handler *file, byte *rowids, ha_rows count,
+                          const byte *ref)
+{
+  uint ref_length= file->ref_length;
+  ha_rows low= 0, high= count;
+  while (low < high)
+  {
+    ha_rows mid= low + (high - low) / 2;
+    int cmp= file->cmp_ref(rowids + mid * ref_length, ref);
+    if (!cmp)
+      return mid;
+    if (cmp < 0)
+      low= mid + 1;
+    else
+      high= mid;
+  }
+  return count;
+}
+
+
+/*
+  Perform the key scans of an index intersection and leave the rowids
+  found by all of them in head->sort, sorted.
+
+  NOTES
+    The rowids of the first scan go through Unique.  Each further scan
+    flags the rowids it finds in the sorted array and the array is then
+    shrunk to the flagged ones, so later scans search fewer rowids and
+    the scans stop when none are left.
+
+  RETURN
+    0     OK
+    other error
+*/
+
+int QUICK_INDEX_INTERSECT_SELECT::read_keys_and_merge()
+{
+  List_iterator_fast<QUICK_RANGE_SELECT> cur_quick_it(quick_selects);
+  QUICK_RANGE_SELECT* cur_quick;
+  handler *file= head->file;
+  uint ref_length= file->ref_length;
+  Unique *unique;
+  char *found= 0;
+  uint scan_no;
+  int result= 1;
+  DBUG_ENTER("QUICK_INDEX_INTERSECT_SELECT::read_keys_and_merge");
+
+  /* We're going to just read rowids, see QUICK_INDEX_MERGE_SELECT */
+  if (file->extra(HA_EXTRA_KEYREAD) ||
+      file->extra(HA_EXTRA_RETRIEVE_PRIMARY_KEY))
+    DBUG_RETURN(1);
+
+  if (!(unique= new Unique(refpos_order_cmp, (void *) file, ref_length,
+                           thd->variables.sortbuff_size)))
+    DBUG_RETURN(1);
+
+  cur_quick_it.rewind();
+  for (scan_no= 0; (cur_quick= cur_quick_it++); scan_no++)
+  {
+    ha_rows count= head->sort.found_records;
+    if (scan_no == 1)
+    {
+      result= unique->get(head);
+      delete unique;
+      unique= 0;
+      if (result)
+        goto err;
+      result= 1;
+      /*
+        If the rowids didn't fit into memory they are in a file; read all
+        of them, the WHERE condition is checked for each row anyway.
+      */
+      if (!head->sort.record_pointers)
+        break;
+      count= head->sort.found_records;
+      if (!count || !(found= (char*) my_malloc((uint) count, MYF(0))))
+        break;
+    }
+    if (scan_no && !count)
+      break;
+    if (found)
+      bzero(found, (uint) count);
+
+    /* We reuse the same instance of handler, see QUICK_INDEX_MERGE_SELECT */
+    if (cur_quick->file->inited != handler::NONE)
+      cur_quick->file->ha_index_end();
+    if (cur_quick->init() || cur_quick->reset())
+      goto err;
+    while (!(result= cur_quick->get_next()))
+    {
+      if (thd->killed)
+      {
+        result= 1;
+        break;
+      }
+      cur_quick->file->position(cur_quick->record);
+      if (!scan_no)
+      {
+        if ((result= unique->unique_add((char*) cur_quick->file->ref)))
+          break;
+      }
+      else
+      {
+        ha_rows pos= find_rowid(file, head->sort.record_pointers, count,
+                                cur_quick->file->ref);
+        if (pos != count)
+          found[pos]= 1;
+      }
+    }
+    cur_quick->range_end();
+    if (result != HA_ERR_END_OF_FILE)
+      goto err;
+    result= 1;
+
+    if (scan_no)
+    {
+      /* Keep the rowids found by this scan */
+      byte *from= head->sort.record_pointers, *to= from;
+      for (ha_rows i= 0; i < count; i++, from+= ref_length)
+      {
+        if (!found[i])
+          continue;
+        if (to != from)
+          memcpy(to, from, ref_length);
+        to+= ref_length;
+      }
+      head->sort.found_records= (ha_rows) (to - head->sort.record_pointers) /
+                                ref_length;
+    }
+  }
+  if (unique)
+  {
+    result= unique->get(head);
+    delete unique;
+    unique= 0;
+    if (result)
+      goto err;
+  }
+  my_free((gptr) found, MYF(MY_ALLOW_ZERO_PTR));
+  doing_pk_scan= FALSE;
+  init_read_record_rowids(&read_record, thd, head);
+  file->extra(HA_EXTRA_NO_KEYREAD);
+  DBUG_RETURN(0);
+
+err:
+  delete unique;
+  my_free((gptr) found, MYF(MY_ALLOW_ZERO_PTR));
+  file->extra(HA_EXTRA_NO_KEYREAD);
+  DBUG_RETURN(result);
+}
+
+
 /*
   Get next row for index_merge.
   NOTES
@@ -7344,6 +7735,23 @@ void QUICK_INDEX_MERGE_SELECT::add_info_string(String *str)
   str->append(')');
 }
 
+void QUICK_INDEX_INTERSECT_SELECT::add_info_string(String *str)
+{
+  QUICK_RANGE_SELECT *quick;
+  bool first= TRUE;
+  List_iterator_fast<QUICK_RANGE_SELECT> it(quick_selects);
+  str->append(STRING_WITH_LEN("sort_intersect("));
+  while ((quick= it++))
+  {
+    if (!first)
+      str->append(',');
+    else
+      first= FALSE;
+    quick->add_info_string(str);
+  }
+  str->append(')');
+}
+
 void QUICK_ROR_INTERSECT_SELECT::add_info_string(String *str)
 {
   bool first= TRUE;
@@ -179,7 +179,8 @@ public:
     QS_TYPE_FULLTEXT   = 3,
     QS_TYPE_ROR_INTERSECT = 4,
     QS_TYPE_ROR_UNION = 5,
-    QS_TYPE_GROUP_MIN_MAX = 6
+    QS_TYPE_GROUP_MIN_MAX = 6,
+    QS_TYPE_INDEX_INTERSECT = 7
   };
 
   /* Get type of this quick select - one of the QS_TYPE_* values */
@@ -293,6 +294,7 @@ protected:
                                               MEM_ROOT *alloc);
   friend class QUICK_SELECT_DESC;
   friend class QUICK_INDEX_MERGE_SELECT;
+  friend class QUICK_INDEX_INTERSECT_SELECT;
   friend class QUICK_ROR_INTERSECT_SELECT;
   friend class QUICK_GROUP_MIN_MAX_SELECT;
 
@@ -442,13 +444,39 @@ public:
 
   MEM_ROOT alloc;
   THD *thd;
-  int read_keys_and_merge();
+  virtual int read_keys_and_merge();
 
   /* used to get rows collected in Unique */
   READ_RECORD read_record;
 };
 
 
+/*
+  QUICK_INDEX_INTERSECT_SELECT - index_merge intersection of range scans
+  that need not return rowids in rowid order.
+
+  The rowids of the first scan (the one expected to return fewest rows) are
+  sorted and deduplicated with Unique.  Every other scan then marks the
+  rowids it finds in that sorted array with a binary search, and only the
+  rowids found by all scans are read, in rowid order.  Clustered primary
+  key scans are not used.
+
+  If the rowids of the first scan don't fit into memory the other scans are
+  skipped; the rows read are still checked against the WHERE condition.
+*/
+
+class QUICK_INDEX_INTERSECT_SELECT : public QUICK_INDEX_MERGE_SELECT
+{
+public:
+  QUICK_INDEX_INTERSECT_SELECT(THD *thd, TABLE *table)
+    :QUICK_INDEX_MERGE_SELECT(thd, table) {}
+
+  int get_type() { return QS_TYPE_INDEX_INTERSECT; }
+  void add_info_string(String *str);
+  int read_keys_and_merge();
+};
+
+
 /*
   Rowid-Ordered Retrieval (ROR) index intersection quick select.
   This quick select produces intersection of row sequences returned
@@ -122,11 +122,11 @@ int opt_sum_query(TABLE_LIST *tables, List<Item> &all_fields,COND *conds)
       If the storage manager of 'tl' gives exact row count, compute the total
       number of rows. If there are no outer table dependencies, this count
       may be used as the real count.
-      Schema tables are filled after this function is invoked, so we can't
-      get row count 
+      Schema tables and pending derived tables are filled after this
+      function is invoked, so we can't get row count
     */
     if ((tl->table->file->table_flags() & HA_NOT_EXACT_COUNT) ||
-        tl->schema_table)
+        tl->schema_table || tl->table->derived_pending)
     {
       is_exact_count= FALSE;
       count= 1;                                 // ensure count != 0
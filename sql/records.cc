@@ -24,6 +24,7 @@ static int rr_from_tempfile(READ_RECORD *info);
 static int rr_unpack_from_tempfile(READ_RECORD *info);
 static int rr_unpack_from_buffer(READ_RECORD *info);
 static int rr_from_pointers(READ_RECORD *info);
+static int rr_from_pointers_scan(READ_RECORD *info);
 static int rr_from_cache(READ_RECORD *info);
 static int init_rr_cache(THD *thd, READ_RECORD *info);
 static int rr_cmp(uchar *a,uchar *b);
@@ -183,6 +184,60 @@ void init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
 } /* init_read_record */
 
 
+/*
+  Init struct to read rows whose rowids are sorted in table->sort
+
+  SYNOPSIS
+    init_read_record_rowids()
+      info         READ_RECORD structure to initialize
+      thd          Thread handle
+      table        Table; table->sort holds the rowids in handler::cmp_ref()
+                   order, as Unique::get() leaves them
+
+  DESCRIPTION
+    If there is on average at least one row to read in each IO_SIZE block
+    of the data file and the handler returns its rows in rowid order, the
+    rows are read with a table scan through the record cache up to the last
+    wanted row and the rows not in the list are skipped.  This reads ahead
+    instead of seeking for every row.  Otherwise this is init_read_record().
+    The rows come in rowid order either way.
+*/
+
+void init_read_record_rowids(READ_RECORD *info, THD *thd, TABLE *table)
+{
+  handler *file= table->file;
+  DBUG_ENTER("init_read_record_rowids");
+
+  if (!table->sort.record_pointers || table->sort.addon_field ||
+      !(file->table_flags() & HA_RND_IN_REF_ORDER) ||
+      table->no_cache ||
+      (int) table->reginfo.lock_type > (int) TL_READ_HIGH_PRIORITY ||
+      (ulonglong) table->sort.found_records * IO_SIZE <
+      (ulonglong) file->data_file_length)
+  {
+    init_read_record(info, thd, table, (SQL_SELECT*) 0, 1, 1);
+    DBUG_VOID_RETURN;
+  }
+  DBUG_PRINT("info",("using rr_from_pointers_scan"));
+  bzero((char*) info,sizeof(*info));
+  info->thd=thd;
+  info->table=table;
+  info->file= file;
+  info->forms= &info->table;
+  info->record= table->record[0];
+  info->ref_length= file->ref_length;
+  info->print_error= 1;
+  table->status=0;
+  info->cache_pos=table->sort.record_pointers;
+  info->cache_end=info->cache_pos+
+                  table->sort.found_records*info->ref_length;
+  info->read_record= rr_from_pointers_scan;
+  file->ha_rnd_init(1);
+  VOID(file->extra_opt(HA_EXTRA_CACHE, thd->variables.read_buff_size));
+  DBUG_VOID_RETURN;
+}
+
+
 
 void end_read_record(READ_RECORD *info)
 {                   /* free cache if used */
@@ -386,6 +441,41 @@ static int rr_from_pointers(READ_RECORD *info)
   return tmp;
 }
 
+/*
+  Read the next row of a sorted list of rowids with a table scan
+
+  NOTES
+    The rowids are in the order the handler returns its rows, so one
+    comparison per row read finds out if the row is wanted.  Rowids of rows
+    that were deleted meanwhile are passed by.
+*/
+
+static int rr_from_pointers_scan(READ_RECORD *info)
+{
+  handler *file= info->file;
+  int tmp;
+
+  for (;;)
+  {
+    if (info->cache_pos == info->cache_end)
+      return -1;					/* End of file */
+    if ((tmp= rr_sequential(info)))
+      return tmp;
+    file->position(info->record);
+    while ((tmp= file->cmp_ref(info->cache_pos, file->ref)) < 0)
+    {
+      if ((info->cache_pos+= info->ref_length) == info->cache_end)
+        return -1;
+    }
+    if (!tmp)
+    {
+      info->cache_pos+= info->ref_length;
+      return 0;
+    }
+  }
+}
+
+
 /*
   Read a result set record from a buffer after sorting
 
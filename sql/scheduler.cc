@@ -0,0 +1,705 @@
+/* Copyright (C) 2008 MySQL AB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Thread schedulers: one thread per connection and a pool of threads
+
+  The pool of threads splits the connections over 'thread_pool_size'
+  thread groups. Each group has a listener thread that waits with epoll
+  for idle connections to send a new statement, and queues those that
+  are ready. Worker threads of the group take connections from the
+  queue, execute one statement and give the connection back to epoll.
+
+  At most 'thread_pool_max_active' workers of a group execute statements
+  at the same time. As a statement may block for a long time (row lock,
+  GET_LOCK(), a slow client), the listener checks every
+  'thread_pool_stall_limit' milliseconds if the group has made any
+  progress. If the queue is not empty and no connection was dequeued,
+  the group is considered stalled and one more active worker is allowed.
+
+  Connections that are in the middle of a transaction or hold table locks
+  are queued with high priority, so that they release their locks as
+  soon as possible.
+*/
+
+#include "mysql_priv.h"
+#include "scheduler.h"
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+static bool init_dummy(void) { return 0; }
+static void post_kill_dummy(THD *thd) {}
+static void end_dummy(void) {}
+
+
+/*
+  Initialize scheduler for --thread-handling=one-thread-per-connection
+*/
+
+void one_thread_per_connection_scheduler(scheduler_functions *func)
+{
+  func->init= init_dummy;
+  func->add_connection= create_thread_to_handle_connection;
+  func->post_kill_notification= post_kill_dummy;
+  func->end= end_dummy;
+}
+
+
+#ifdef HAVE_SYS_EPOLL_H
+
+#define POOL_MAX_EVENTS          64
+/* Seconds an extra idle worker waits for work before it ends */
+#define POOL_WORKER_IDLE_TIMEOUT 60
+
+struct thread_group;
+
+/* Per connection state, THD::scheduler points to it */
+
+struct pool_connection
+{
+  THD *thd;
+  thread_group *group;
+  pool_connection *next;                /* Next in queue or in idle list */
+  pool_connection **prev;               /* Previous in idle list */
+  time_t idle_since;
+  bool logged_in;                       /* login_connection() succeeded */
+  bool in_epoll;                        /* Socket registered in epoll */
+  bool waiting;                         /* Idle, owned by the listener */
+  bool timed_out;                       /* Socket shut down on wait_timeout */
+};
+
+struct connection_queue
+{
+  pool_connection *first, *last;
+};
+
+struct thread_group
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;                  /* Idle workers wait here */
+  int epoll_fd;
+  connection_queue high_queue, low_queue;
+  pool_connection *idle_list;           /* Connections waiting in epoll */
+  uint thread_count;                    /* Workers of this group */
+  uint idle_threads;                    /* Workers waiting on cond */
+  uint active_threads;                  /* Workers executing a connection */
+  uint stall_extra;                     /* Extra active workers allowed */
+  ulong dequeues, last_dequeues;
+  bool listener_running;
+  bool shutdown;
+};
+
+static thread_group *thread_groups;
+static uint thread_group_count;
+
+
+static inline bool queue_is_empty(connection_queue *queue)
+{
+  return queue->first == 0;
+}
+
+static inline void queue_push(connection_queue *queue, pool_connection *conn)
+{
+  conn->next= 0;
+  if (queue->last)
+    queue->last->next= conn;
+  else
+    queue->first= conn;
+  queue->last= conn;
+}
+
+static inline pool_connection *queue_pop(connection_queue *queue)
+{
+  pool_connection *conn;
+  if ((conn= queue->first) && !(queue->first= conn->next))
+    queue->last= 0;
+  return conn;
+}
+
+
+static inline void idle_list_add(thread_group *group, pool_connection *conn)
+{
+  if ((conn->next= group->idle_list))
+    conn->next->prev= &conn->next;
+  conn->prev= &group->idle_list;
+  group->idle_list= conn;
+}
+
+static inline void idle_list_remove(pool_connection *conn)
+{
+  if ((*conn->prev= conn->next))
+    conn->next->prev= conn->prev;
+}
+
+
+/*
+  Check if the connection should be given priority over new statements:
+  it is inside a transaction or holds table locks.
+*/
+
+static inline bool connection_has_priority(THD *thd)
+{
+  return (thd->locked_tables ||
+          ((thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)) &&
+           thd->transaction.all.nht));
+}
+
+
+/*
+  Check if data for the next statement has already been read from the
+  socket; epoll would not notice it.
+*/
+
+static bool connection_has_pending_data(THD *thd)
+{
+  NET *net= &thd->net;
+  Vio *vio= net->vio;
+  if (!vio)
+    return FALSE;
+  if (net->compress && net->remain_in_buf)
+    return TRUE;
+  if (vio->read_pos < vio->read_end)
+    return TRUE;
+#ifdef HAVE_OPENSSL
+  if (vio->type == VIO_TYPE_SSL && SSL_pending((SSL*) vio->ssl_arg) > 0)
+    return TRUE;
+#endif
+  return FALSE;
+}
+
+
+pthread_handler_t pool_worker(void *arg);
+
+/*
+  Hand a queued connection to a worker
+
+  NOTES
+    Called with group->mutex locked. Wakes up an idle worker, or creates
+    a new one if the group may have more active workers.
+*/
+
+static void wake_or_create_worker(thread_group *group)
+{
+  pthread_t id;
+  int error;
+
+  if (group->idle_threads)
+  {
+    pthread_cond_signal(&group->cond);
+    return;
+  }
+  /* Don't create another worker while one is still starting up */
+  if (group->thread_count > group->active_threads ||
+      group->active_threads >= thread_pool_max_active + group->stall_extra ||
+      thread_pool_threads >= thread_pool_max_threads)
+    return;
+
+  if ((error= pthread_create(&id, &connection_attrib, pool_worker,
+                             (void*) group)))
+  {
+    sql_print_error("Can't create worker thread for the pool of threads "
+                    "(errno= %d)", error);
+    return;
+  }
+  group->thread_count++;
+  thread_safe_increment(thread_pool_threads, &LOCK_status);
+}
+
+
+/*
+  Make the connection idle: give it back to epoll, waiting for the next
+  statement of the client
+
+  RETURN
+    0  ok, the connection may now be taken by another worker
+    1  error; the caller still owns the connection
+*/
+
+static bool connection_wait_for_data(pool_connection *conn)
+{
+  thread_group *group= conn->group;
+  THD *thd= conn->thd;
+  struct epoll_event ev;
+  int fd= thd->net.vio->sd;
+  bool error= 0;
+
+  /* Detach the THD from this thread */
+  pthread_mutex_lock(&thd->LOCK_delete);
+  thd->mysys_var= 0;
+  thd->real_id= 0;
+  pthread_mutex_unlock(&thd->LOCK_delete);
+  my_pthread_setspecific_ptr(THR_THD, 0);
+  my_pthread_setspecific_ptr(THR_MALLOC, 0);
+
+  /*
+    The socket is armed with the group mutex locked: the listener can't
+    see the event, and a kill can't be missed, before 'waiting' is set.
+  */
+  ev.events= EPOLLIN | EPOLLONESHOT;
+  ev.data.ptr= conn;
+  pthread_mutex_lock(&group->mutex);
+  if (thd->killed == THD::KILL_CONNECTION ||
+      epoll_ctl(group->epoll_fd, conn->in_epoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                fd, &ev))
+    error= 1;
+  else
+  {
+    conn->in_epoll= TRUE;
+    conn->waiting= TRUE;
+    conn->timed_out= FALSE;
+    conn->idle_since= time(NULL);
+    idle_list_add(group, conn);
+  }
+  pthread_mutex_unlock(&group->mutex);
+  return error;
+}
+
+
+/*
+  Attach the THD of a connection to the current worker thread
+*/
+
+static bool attach_connection(THD *thd)
+{
+  pthread_mutex_lock(&thd->LOCK_delete);
+  thd->real_id= pthread_self();
+  if (thd->store_globals())
+  {
+    pthread_mutex_unlock(&thd->LOCK_delete);
+    return 1;
+  }
+  pthread_mutex_unlock(&thd->LOCK_delete);
+  /*
+    THD::mysys_var::abort belongs to the physical thread; reset it as
+    end_thread() does for a cached thread.
+  */
+  thd->mysys_var->abort= 0;
+  return 0;
+}
+
+
+/*
+  Execute the login or the next statement(s) of a connection
+
+  NOTES
+    Called by a worker that took the connection from the queue. On return
+    the connection is either waiting in epoll or has been freed.
+*/
+
+static void process_connection(pool_connection *conn)
+{
+  THD *thd= conn->thd;
+  NET *net= &thd->net;
+
+  thd->thread_stack= (char*) &thd;
+  if (attach_connection(thd))
+  {
+    close_connection(thd, ER_OUT_OF_RESOURCES, 1);
+    goto end;
+  }
+
+  if (!conn->logged_in)
+  {
+    thd->thr_create_time= time(NULL);
+    if (login_connection(thd))
+      goto end;
+    conn->logged_in= TRUE;
+  }
+  else
+  {
+    if (net->error || !net->vio || thd->killed == THD::KILL_CONNECTION)
+      goto end;
+    net->no_send_error= 0;
+    if (do_command(thd))
+      goto end;
+  }
+
+  for (;;)
+  {
+    if (net->error || !net->vio || thd->killed == THD::KILL_CONNECTION)
+      goto end;
+    if (!connection_has_pending_data(thd))
+      break;
+    net->no_send_error= 0;
+    if (do_command(thd))
+      goto end;
+  }
+
+  if (!connection_wait_for_data(conn))
+    return;
+
+  /* Killed just before we got idle or couldn't register socket */
+  if (attach_connection(thd))
+    close_connection(thd, ER_OUT_OF_RESOURCES, 1);
+
+end:
+  if (conn->logged_in)
+    end_connection(thd);
+  close_connection(thd, 0, 1);
+  /* Closing the socket removed it from epoll */
+  unlink_thd(thd);
+  my_pthread_setspecific_ptr(THR_THD, 0);
+  my_pthread_setspecific_ptr(THR_MALLOC, 0);
+  /* Nobody can reach conn via the THD anymore */
+  my_free((gptr) conn, MYF(0));
+}
+
+
+/*
+  Worker thread of a thread group
+*/
+
+pthread_handler_t pool_worker(void *arg)
+{
+  thread_group *group= (thread_group*) arg;
+  pool_connection *conn;
+  struct timespec abstime;
+  int error;
+
+  my_thread_init();
+  DBUG_ENTER("pool_worker");
+
+  pthread_mutex_lock(&group->mutex);
+  for (;;)
+  {
+    conn= 0;
+    if (group->active_threads < thread_pool_max_active + group->stall_extra &&
+        !(conn= queue_pop(&group->high_queue)))
+      conn= queue_pop(&group->low_queue);
+    if (!conn)
+    {
+      if (group->shutdown)
+        break;
+      group->idle_threads++;
+      set_timespec(abstime, POOL_WORKER_IDLE_TIMEOUT);
+      error= pthread_cond_timedwait(&group->cond, &group->mutex, &abstime);
+      group->idle_threads--;
+      if (error == ETIMEDOUT && group->thread_count > 1 &&
+          queue_is_empty(&group->high_queue) &&
+          queue_is_empty(&group->low_queue))
+        break;
+      continue;
+    }
+    group->active_threads++;
+    group->dequeues++;
+    pthread_mutex_unlock(&group->mutex);
+
+    process_connection(conn);
+
+    pthread_mutex_lock(&group->mutex);
+    group->active_threads--;
+  }
+  group->thread_count--;
+  thread_safe_decrement(thread_pool_threads, &LOCK_status);
+  pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+
+  /*
+    SHOW PROCESSLIST may still be using our mysys_var through the THD we
+    executed last. It does so with LOCK_thread_count locked.
+  */
+  pthread_mutex_lock(&LOCK_thread_count);
+  pthread_mutex_unlock(&LOCK_thread_count);
+
+  DBUG_LEAVE;
+  my_thread_end();
+  pthread_exit(0);
+  return 0;                                     /* purecov: deadcode */
+}
+
+
+/*
+  Move a connection that got ready from the idle list to the queue
+
+  NOTES
+    Called by the listener with group->mutex locked.
+*/
+
+static void queue_connection(thread_group *group, pool_connection *conn)
+{
+  conn->waiting= FALSE;
+  idle_list_remove(conn);
+  queue_push(connection_has_priority(conn->thd) ? &group->high_queue :
+             &group->low_queue, conn);
+  wake_or_create_worker(group);
+}
+
+
+/*
+  Listener thread of a thread group
+
+  DESCRIPTION
+    Waits for idle connections to become readable and queues them.
+    Between epoll waits it also:
+    - detects stalls and allows one more active worker,
+    - shuts down the socket of connections that have been idle for
+      longer than their wait_timeout,
+    - on server shutdown, queues all idle connections so that the
+      workers close them.
+*/
+
+pthread_handler_t pool_listener(void *arg)
+{
+  thread_group *group= (thread_group*) arg;
+  struct epoll_event events[POOL_MAX_EVENTS];
+  ulonglong last_stall_check= my_getsystime();
+  time_t last_timeout_check= time(NULL);
+  int i, count;
+
+  my_thread_init();
+  DBUG_ENTER("pool_listener");
+
+  for (;;)
+  {
+    count= epoll_wait(group->epoll_fd, events, POOL_MAX_EVENTS,
+                      (int) thread_pool_stall_limit);
+
+    pthread_mutex_lock(&group->mutex);
+    if (group->shutdown)
+      break;
+    for (i= 0; i < count; i++)
+    {
+      pool_connection *conn= (pool_connection*) events[i].data.ptr;
+      if (conn->waiting)
+        queue_connection(group, conn);
+    }
+
+    /* my_getsystime() is in 100 ns units */
+    if (my_getsystime() - last_stall_check >=
+        (ulonglong) thread_pool_stall_limit * 10000)
+    {
+      bool queued= (!queue_is_empty(&group->high_queue) ||
+                    !queue_is_empty(&group->low_queue));
+      if (queued && group->dequeues == group->last_dequeues)
+      {
+        if (group->stall_extra < thread_pool_max_threads)
+          group->stall_extra++;
+        wake_or_create_worker(group);
+      }
+      else if (!queued && group->stall_extra)
+        group->stall_extra--;
+      group->last_dequeues= group->dequeues;
+      last_stall_check= my_getsystime();
+    }
+
+    if (abort_loop)
+    {
+      /*
+        close_connections() may have closed the socket of an idle
+        connection, which removes it from epoll
+      */
+      pool_connection *conn;
+      while ((conn= group->idle_list))
+      {
+        (void) epoll_ctl(group->epoll_fd, EPOLL_CTL_DEL,
+                         conn->thd->net.vio->sd, 0);
+        queue_connection(group, conn);
+      }
+    }
+    else if (time(NULL) != last_timeout_check)
+    {
+      pool_connection *conn;
+      last_timeout_check= time(NULL);
+      for (conn= group->idle_list; conn; conn= conn->next)
+      {
+        THD *thd= conn->thd;
+        if (!conn->timed_out &&
+            (ulong) (last_timeout_check - conn->idle_since) >=
+            thd->variables.net_wait_timeout)
+        {
+          /* The worker gets a read error and closes the connection */
+          conn->timed_out= TRUE;
+          (void) shutdown(thd->net.vio->sd, SHUT_RDWR);
+        }
+      }
+    }
+    pthread_mutex_unlock(&group->mutex);
+  }
+  group->listener_running= FALSE;
+  pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+
+  DBUG_LEAVE;
+  my_thread_end();
+  pthread_exit(0);
+  return 0;                                     /* purecov: deadcode */
+}
+
+
+static void pool_end(void);
+
+static bool pool_init(void)
+{
+  uint i;
+  pthread_t id;
+  DBUG_ENTER("pool_init");
+
+  thread_group_count= thread_pool_size;
+#ifdef _SC_NPROCESSORS_ONLN
+  if (!thread_group_count)
+    thread_group_count= (uint) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if ((int) thread_group_count <= 0)
+    thread_group_count= 1;
+
+  if (!(thread_groups= (thread_group*)
+        my_malloc(thread_group_count * sizeof(thread_group),
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+
+  for (i= 0; i < thread_group_count; i++)
+  {
+    thread_group *group= thread_groups + i;
+    pthread_mutex_init(&group->mutex, MY_MUTEX_INIT_FAST);
+    pthread_cond_init(&group->cond, NULL);
+    if ((group->epoll_fd= epoll_create(POOL_MAX_EVENTS)) < 0)
+    {
+      sql_print_error("Can't create epoll instance for the pool of threads "
+                      "(errno= %d)", errno);
+      thread_group_count= i + 1;
+      pool_end();
+      DBUG_RETURN(1);
+    }
+    group->listener_running= TRUE;
+    if (pthread_create(&id, &connection_attrib, pool_listener,
+                       (void*) group))
+    {
+      sql_print_error("Can't create listener thread for the pool of threads "
+                      "(errno= %d)", errno);
+      group->listener_running= FALSE;
+      thread_group_count= i + 1;
+      pool_end();
+      DBUG_RETURN(1);
+    }
+  }
+  sql_print_information("Using pool-of-threads with %u thread groups",
+                        thread_group_count);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Queue the login of a new connection
+*/
+
+static void pool_add_connection(THD *thd)
+{
+  pool_connection *conn;
+  thread_group *group;
+  DBUG_ENTER("pool_add_connection");
+
+  if (!(conn= (pool_connection*) my_malloc(sizeof(pool_connection),
+                                           MYF(MY_WME | MY_ZEROFILL))))
+  {
+    thread_count--;
+    close_connection(thd, ER_OUT_OF_RESOURCES, 0);
+    delete thd;
+    (void) pthread_mutex_unlock(&LOCK_thread_count);
+    statistic_increment(aborted_connects,&LOCK_status);
+    DBUG_VOID_RETURN;
+  }
+  group= thread_groups + thd->thread_id % thread_group_count;
+  conn->thd= thd;
+  conn->group= group;
+  thd->scheduler= conn;
+  thd->real_id= 0;                              // No thread yet
+  thd->connect_time= time(NULL);
+  threads.append(thd);
+  (void) pthread_mutex_unlock(&LOCK_thread_count);
+
+  pthread_mutex_lock(&group->mutex);
+  queue_push(&group->low_queue, conn);
+  wake_or_create_worker(group);
+  pthread_mutex_unlock(&group->mutex);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Wake up a killed connection if it's idle
+
+  NOTES
+    Called with LOCK_thread_count or THD::LOCK_delete locked, which keeps
+    the THD, and so the pool_connection, alive.
+*/
+
+static void pool_post_kill_notification(THD *thd)
+{
+  pool_connection *conn= (pool_connection*) thd->scheduler;
+  if (!conn)
+    return;
+  pthread_mutex_lock(&conn->group->mutex);
+  if (conn->waiting && thd->net.vio)
+    (void) shutdown(thd->net.vio->sd, SHUT_RDWR);
+  pthread_mutex_unlock(&conn->group->mutex);
+}
+
+
+/*
+  Stop all threads of the pool. Called after all connections are closed.
+*/
+
+static void pool_end(void)
+{
+  uint i;
+  DBUG_ENTER("pool_end");
+  if (!thread_groups)
+    DBUG_VOID_RETURN;
+
+  for (i= 0; i < thread_group_count; i++)
+  {
+    thread_group *group= thread_groups + i;
+    pthread_mutex_lock(&group->mutex);
+    group->shutdown= TRUE;
+    pthread_cond_broadcast(&group->cond);
+    /* The listener notices shutdown within thread_pool_stall_limit */
+    while (group->thread_count || group->listener_running)
+      pthread_cond_wait(&group->cond, &group->mutex);
+    pthread_mutex_unlock(&group->mutex);
+    if (group->epoll_fd >= 0)
+      (void) close(group->epoll_fd);
+    pthread_mutex_destroy(&group->mutex);
+    pthread_cond_destroy(&group->cond);
+  }
+  my_free((gptr) thread_groups, MYF(0));
+  thread_groups= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Initialize scheduler for --thread-handling=pool-of-threads
+*/
+
+void pool_of_threads_scheduler(scheduler_functions *func)
+{
+  func->init= pool_init;
+  func->add_connection= pool_add_connection;
+  func->post_kill_notification= pool_post_kill_notification;
+  func->end= pool_end;
+}
+
+#else /* HAVE_SYS_EPOLL_H */
+
+void pool_of_threads_scheduler(scheduler_functions *func)
+{
+  sql_print_warning("pool-of-threads is not supported on this platform, "
+                    "using one-thread-per-connection");
+  one_thread_per_connection_scheduler(func);
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
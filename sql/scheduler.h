@@ -0,0 +1,65 @@
+/* Copyright (C) 2008 MySQL AB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef _scheduler_h_
+#define _scheduler_h_
+
+/*
+  Thread scheduler interface
+
+  The scheduler decides which OS thread executes the statements of a
+  connection. With "one-thread-per-connection" every connection gets
+  its own (possibly cached) thread, which is blocked in a read between
+  statements. With "pool-of-threads" connections are multiplexed over a
+  small number of worker threads per thread group and an idle
+  connection does not own any thread.
+*/
+
+class THD;
+
+struct scheduler_functions
+{
+  /* Called once at startup, before any connection is accepted */
+  bool (*init)(void);
+  /*
+    Take care of a new connection. Called with LOCK_thread_count locked,
+    the function must unlock it.
+  */
+  void (*add_connection)(THD *thd);
+  /* Called by THD::awake() when a connection has been killed */
+  void (*post_kill_notification)(THD *thd);
+  /* Called at shutdown, after all connections have been closed */
+  void (*end)(void);
+};
+
+enum scheduler_types
+{
+  SCHEDULER_ONE_THREAD_PER_CONNECTION=0,
+  SCHEDULER_POOL_OF_THREADS
+};
+
+extern scheduler_functions thread_scheduler;
+extern const char *thread_handling_names[];
+extern TYPELIB thread_handling_typelib;
+extern ulong thread_handling;
+extern char *opt_thread_handling;
+extern ulong thread_pool_size, thread_pool_max_active;
+extern ulong thread_pool_stall_limit, thread_pool_max_threads;
+extern ulong thread_pool_threads;
+
+void one_thread_per_connection_scheduler(scheduler_functions *func);
+void pool_of_threads_scheduler(scheduler_functions *func);
+
+#endif /* _scheduler_h_ */
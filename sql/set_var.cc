@@ -54,6 +54,7 @@
 #include "mysql_priv.h"
 #include <mysql.h>
 #include "slave.h"
+#include "scheduler.h"
 #include <my_getopt.h>
 #include <thr_alarm.h>
 #include <myisam.h>
@@ -105,6 +106,7 @@ static void fix_net_retry_count(THD *thd, enum_var_type type);
 static void fix_max_join_size(THD *thd, enum_var_type type);
 static void fix_query_cache_size(THD *thd, enum_var_type type);
 static void fix_query_cache_min_res_unit(THD *thd, enum_var_type type);
+static void fix_query_cache_limit(THD *thd, enum_var_type type);
 static void fix_myisam_max_sort_file_size(THD *thd, enum_var_type type);
 static void fix_max_binlog_size(THD *thd, enum_var_type type);
 static void fix_max_relay_log_size(THD *thd, enum_var_type type);
@@ -202,6 +204,9 @@ sys_var_key_cache_long	sys_key_cache_division_limit("key_cache_division_limit",
 sys_var_key_cache_long  sys_key_cache_age_threshold("key_cache_age_threshold",
 						     offsetof(KEY_CACHE,
 							      param_age_threshold));
+sys_var_key_cache_long  sys_key_cache_segments("key_cache_segments",
+                                               offsetof(KEY_CACHE,
+                                                        param_segments));
 sys_var_bool_ptr	sys_local_infile("local_infile",
 					 &opt_local_infile);
 sys_var_bool_const_ptr sys_log("log", &opt_log);
@@ -307,10 +312,25 @@ sys_var_thd_ulong	sys_net_retry_count("net_retry_count",
 					    0, fix_net_retry_count);
 sys_var_thd_bool	sys_new_mode("new", &SV::new_mode);
 sys_var_thd_bool	sys_old_passwords("old_passwords", &SV::old_passwords);
+sys_var_thd_bool        sys_optimizer_batched_key_access("optimizer_batched_key_access",
+                                                         &SV::optimizer_batched_key_access);
+sys_var_thd_bool        sys_optimizer_derived_keys("optimizer_derived_keys",
+                                                   &SV::optimizer_derived_keys);
+sys_var_thd_bool        sys_optimizer_derived_merge("optimizer_derived_merge",
+                                                    &SV::optimizer_derived_merge);
+sys_var_thd_bool        sys_optimizer_hash_join("optimizer_hash_join",
+                                                &SV::optimizer_hash_join);
+sys_var_thd_bool        sys_optimizer_plan_cache("optimizer_plan_cache",
+                                                 &SV::optimizer_plan_cache);
+sys_var_thd_bool        sys_optimizer_sort_intersect("optimizer_sort_intersect",
+                                                     &SV::optimizer_sort_intersect);
 sys_var_thd_ulong       sys_optimizer_prune_level("optimizer_prune_level",
                                                   &SV::optimizer_prune_level);
 sys_var_thd_ulong       sys_optimizer_search_depth("optimizer_search_depth",
                                                    &SV::optimizer_search_depth);
+sys_var_thd_bool        sys_optimizer_subquery_materialization(
+                          "optimizer_subquery_materialization",
+                          &SV::optimizer_subquery_materialization);
 sys_var_thd_ulong       sys_preload_buff_size("preload_buffer_size",
                                               &SV::preload_buff_size);
 sys_var_thd_ulong	sys_read_buff_size("read_buffer_size",
@@ -348,7 +368,8 @@ sys_var_thd_ulong	sys_trans_prealloc_size("transaction_prealloc_size",
 
 #ifdef HAVE_QUERY_CACHE
 sys_var_long_ptr	sys_query_cache_limit("query_cache_limit",
-					      &query_cache.query_cache_limit);
+					      &query_cache_limit,
+					      fix_query_cache_limit);
 sys_var_long_ptr        sys_query_cache_min_res_unit("query_cache_min_res_unit",
 						     &query_cache_min_res_unit,
 						     fix_query_cache_min_res_unit);
@@ -370,11 +391,15 @@ sys_var_long_ptr	sys_slave_net_timeout("slave_net_timeout",
 					      &slave_net_timeout);
 sys_var_long_ptr	sys_slave_trans_retries("slave_transaction_retries",
                                                 &slave_trans_retries);
+sys_var_long_ptr	sys_slave_parallel_workers("slave_parallel_workers",
+                                                   &slave_parallel_workers);
 #endif
 sys_var_long_ptr	sys_slow_launch_time("slow_launch_time",
 					     &slow_launch_time);
 sys_var_thd_ulong	sys_sort_buffer("sort_buffer_size",
 					&SV::sortbuff_size);
+sys_var_thd_ulong	sys_sort_threads("sort_threads",
+					 &SV::sort_threads);
 sys_var_thd_sql_mode    sys_sql_mode("sql_mode",
                                      &SV::sql_mode);
 #ifdef HAVE_OPENSSL
@@ -409,6 +434,8 @@ sys_var_const_str	sys_system_time_zone("system_time_zone",
                                              system_time_zone);
 sys_var_long_ptr	sys_table_cache_size("table_cache",
 					     &table_cache_size);
+sys_var_long_ptr	sys_table_cache_per_thread("table_cache_per_thread",
+                                                   &table_cache_per_thread);
 sys_var_long_ptr	sys_table_lock_wait_timeout("table_lock_wait_timeout",
                                                     &table_lock_wait_timeout);
 sys_var_long_ptr	sys_thread_cache_size("thread_cache_size",
@@ -441,6 +468,8 @@ sys_var_long_ptr        sys_innodb_max_dirty_pages_pct("innodb_max_dirty_pages_p
                                                         &srv_max_buf_pool_modified_pct);
 sys_var_long_ptr	sys_innodb_max_purge_lag("innodb_max_purge_lag",
 							&srv_max_purge_lag);
+sys_var_long_ptr	sys_innodb_io_capacity("innodb_io_capacity",
+                                               &srv_io_capacity);
 sys_var_thd_bool	sys_innodb_table_locks("innodb_table_locks",
                                                &SV::innodb_table_locks);
 sys_var_thd_bool	sys_innodb_support_xa("innodb_support_xa",
@@ -666,6 +695,7 @@ sys_var *sys_variables[]=
   &sys_key_cache_block_size,
   &sys_key_cache_division_limit,
   &sys_key_cache_age_threshold,
+  &sys_key_cache_segments,
   &sys_last_insert_id,
   &sys_lc_time_names,
   &sys_license,
@@ -711,8 +741,15 @@ sys_var *sys_variables[]=
   &sys_net_write_timeout,
   &sys_new_mode,
   &sys_old_passwords,
+  &sys_optimizer_batched_key_access,
+  &sys_optimizer_derived_keys,
+  &sys_optimizer_derived_merge,
+  &sys_optimizer_hash_join,
+  &sys_optimizer_plan_cache,
   &sys_optimizer_prune_level,
   &sys_optimizer_search_depth,
+  &sys_optimizer_sort_intersect,
+  &sys_optimizer_subquery_materialization,
   &sys_preload_buff_size,
   &sys_pseudo_thread_id,
   &sys_query_alloc_block_size,
@@ -744,10 +781,12 @@ sys_var *sys_variables[]=
   &sys_slave_compressed_protocol,
   &sys_slave_net_timeout,
   &sys_slave_trans_retries,
+  &sys_slave_parallel_workers,
   &sys_slave_skip_counter,
 #endif
   &sys_slow_launch_time,
   &sys_sort_buffer,
+  &sys_sort_threads,
   &sys_sql_big_tables,
   &sys_sql_low_priority_updates,
   &sys_sql_max_join_size,
@@ -766,6 +805,7 @@ sys_var *sys_variables[]=
   &sys_sync_frm,
   &sys_system_time_zone,
   &sys_table_cache_size,
+  &sys_table_cache_per_thread,
   &sys_table_lock_wait_timeout,
   &sys_table_type,
   &sys_thread_cache_size,
@@ -789,6 +829,7 @@ sys_var *sys_variables[]=
   &sys_innodb_fast_shutdown,
   &sys_innodb_max_dirty_pages_pct,
   &sys_innodb_max_purge_lag,
+  &sys_innodb_io_capacity,
   &sys_innodb_table_locks,
   &sys_innodb_support_xa,
   &sys_innodb_autoextend_increment,
@@ -899,15 +940,19 @@ struct show_var_st init_vars[]= {
   {"init_slave",              (char*) &sys_init_slave,              SHOW_SYS},
 #ifdef HAVE_INNOBASE_DB
   {"innodb_additional_mem_pool_size", (char*) &innobase_additional_mem_pool_size, SHOW_LONG },
+  {"innodb_aio_queue_depth", (char*) &innobase_aio_queue_depth, SHOW_LONG },
   {sys_innodb_autoextend_increment.name, (char*) &sys_innodb_autoextend_increment, SHOW_SYS},
   {"innodb_buffer_pool_awe_mem_mb", (char*) &innobase_buffer_pool_awe_mem_mb, SHOW_LONG },
+  {"innodb_buffer_pool_instances", (char*) &innobase_buffer_pool_instances, SHOW_LONG },
   {"innodb_buffer_pool_size", (char*) &innobase_buffer_pool_size, SHOW_LONGLONG },
   {"innodb_checksums", (char*) &innobase_use_checksums, SHOW_MY_BOOL},
   {sys_innodb_commit_concurrency.name, (char*) &sys_innodb_commit_concurrency, SHOW_SYS},
   {sys_innodb_concurrency_tickets.name, (char*) &sys_innodb_concurrency_tickets, SHOW_SYS},
   {"innodb_data_file_path", (char*) &innobase_data_file_path,	    SHOW_CHAR_PTR},
   {"innodb_data_home_dir",  (char*) &innobase_data_home_dir,	    SHOW_CHAR_PTR},
+  {"innodb_adaptive_flushing", (char*) &innobase_adaptive_flushing, SHOW_MY_BOOL},
   {"innodb_adaptive_hash_index", (char*) &innobase_adaptive_hash_index, SHOW_MY_BOOL},
+  {"innodb_adaptive_hash_index_partitions", (char*) &innobase_adaptive_hash_index_partitions, SHOW_LONG},
   {"innodb_doublewrite", (char*) &innobase_use_doublewrite, SHOW_MY_BOOL},
   {sys_innodb_fast_shutdown.name,(char*) &sys_innodb_fast_shutdown, SHOW_SYS},
   {"innodb_file_io_threads", (char*) &innobase_file_io_threads, SHOW_LONG },
@@ -915,6 +960,7 @@ struct show_var_st init_vars[]= {
   {sys_innodb_flush_log_at_trx_commit.name, (char*) &sys_innodb_flush_log_at_trx_commit, SHOW_SYS},
   {"innodb_flush_method",    (char*) &innobase_unix_file_flush_method, SHOW_CHAR_PTR},
   {"innodb_force_recovery", (char*) &innobase_force_recovery, SHOW_LONG },
+  {sys_innodb_io_capacity.name, (char*) &sys_innodb_io_capacity, SHOW_SYS},
   {"innodb_lock_wait_timeout", (char*) &innobase_lock_wait_timeout, SHOW_LONG },
   {"innodb_locks_unsafe_for_binlog", (char*) &innobase_locks_unsafe_for_binlog, SHOW_MY_BOOL},
   {"innodb_log_arch_dir",   (char*) &innobase_log_arch_dir, 	    SHOW_CHAR_PTR},
@@ -927,12 +973,14 @@ struct show_var_st init_vars[]= {
   {sys_innodb_max_purge_lag.name, (char*) &sys_innodb_max_purge_lag, SHOW_SYS},
   {"innodb_mirrored_log_groups", (char*) &innobase_mirrored_log_groups, SHOW_LONG},
   {"innodb_open_files", (char*) &innobase_open_files, SHOW_LONG },
+  {"innodb_purge_threads", (char*) &innobase_purge_threads, SHOW_LONG },
   {"innodb_rollback_on_timeout", (char*) &innobase_rollback_on_timeout, SHOW_MY_BOOL},
   {sys_innodb_support_xa.name, (char*) &sys_innodb_support_xa, SHOW_SYS},
   {sys_innodb_sync_spin_loops.name, (char*) &sys_innodb_sync_spin_loops, SHOW_SYS},
   {sys_innodb_table_locks.name, (char*) &sys_innodb_table_locks, SHOW_SYS},
   {sys_innodb_thread_concurrency.name, (char*) &sys_innodb_thread_concurrency, SHOW_SYS},
   {sys_innodb_thread_sleep_delay.name, (char*) &sys_innodb_thread_sleep_delay, SHOW_SYS},
+  {"innodb_use_native_aio", (char*) &innobase_use_native_aio, SHOW_MY_BOOL},
 #endif
   {sys_interactive_timeout.name,(char*) &sys_interactive_timeout,   SHOW_SYS},
   {sys_join_buffer_size.name,   (char*) &sys_join_buffer_size,	    SHOW_SYS},
@@ -943,6 +991,7 @@ struct show_var_st init_vars[]= {
                                                                     SHOW_SYS},
   {sys_key_cache_division_limit.name,   (char*) &sys_key_cache_division_limit,
                                                                     SHOW_SYS},
+  {sys_key_cache_segments.name, (char*) &sys_key_cache_segments,    SHOW_SYS},
   {"language",                language,                             SHOW_CHAR},
   {"large_files_support",     (char*) &opt_large_files,             SHOW_BOOL},
   {"large_page_size",         (char*) &opt_large_page_size,         SHOW_INT},
@@ -1021,10 +1070,24 @@ struct show_var_st init_vars[]= {
   {sys_new_mode.name,         (char*) &sys_new_mode,                SHOW_SYS},
   {sys_old_passwords.name,    (char*) &sys_old_passwords,           SHOW_SYS},
   {"open_files_limit",	      (char*) &open_files_limit,	    SHOW_LONG},
+  {sys_optimizer_batched_key_access.name,
+   (char*) &sys_optimizer_batched_key_access, SHOW_SYS},
+  {sys_optimizer_derived_keys.name, (char*) &sys_optimizer_derived_keys,
+   SHOW_SYS},
+  {sys_optimizer_derived_merge.name, (char*) &sys_optimizer_derived_merge,
+   SHOW_SYS},
+  {sys_optimizer_hash_join.name, (char*) &sys_optimizer_hash_join,
+   SHOW_SYS},
+  {sys_optimizer_plan_cache.name, (char*) &sys_optimizer_plan_cache,
+   SHOW_SYS},
   {sys_optimizer_prune_level.name, (char*) &sys_optimizer_prune_level,
    SHOW_SYS},
   {sys_optimizer_search_depth.name,(char*) &sys_optimizer_search_depth,
    SHOW_SYS},
+  {sys_optimizer_sort_intersect.name, (char*) &sys_optimizer_sort_intersect,
+   SHOW_SYS},
+  {sys_optimizer_subquery_materialization.name,
+   (char*) &sys_optimizer_subquery_materialization, SHOW_SYS},
   {"pid_file",                (char*) pidfile_name,                 SHOW_CHAR},
   {"port",                    (char*) &mysqld_port,                  SHOW_INT},
   {sys_preload_buff_size.name, (char*) &sys_preload_buff_size,      SHOW_SYS},
@@ -1035,6 +1098,7 @@ struct show_var_st init_vars[]= {
   {sys_query_cache_limit.name,(char*) &sys_query_cache_limit,	    SHOW_SYS},
   {sys_query_cache_min_res_unit.name, (char*) &sys_query_cache_min_res_unit,
    SHOW_SYS},
+  {"query_cache_partitions",  (char*) &query_cache_partitions,      SHOW_LONG},
   {sys_query_cache_size.name, (char*) &sys_query_cache_size,	    SHOW_SYS},
   {sys_query_cache_type.name, (char*) &sys_query_cache_type,        SHOW_SYS},
   {sys_query_cache_wlock_invalidate.name,
@@ -1069,6 +1133,8 @@ struct show_var_st init_vars[]= {
     (char*) &sys_slave_compressed_protocol,           SHOW_SYS},
   {"slave_load_tmpdir",       (char*) &slave_load_tmpdir,           SHOW_CHAR_PTR},
   {sys_slave_net_timeout.name,(char*) &sys_slave_net_timeout,	    SHOW_SYS},
+  {sys_slave_parallel_workers.name,
+    (char*) &sys_slave_parallel_workers,              SHOW_SYS},
   {"slave_skip_errors",       (char*) &slave_error_mask,            SHOW_SLAVE_SKIP_ERRORS},
   {sys_slave_trans_retries.name,(char*) &sys_slave_trans_retries,   SHOW_SYS},
 #endif
@@ -1077,6 +1143,7 @@ struct show_var_st init_vars[]= {
   {"socket",                  (char*) &mysqld_unix_port,             SHOW_CHAR_PTR},
 #endif
   {sys_sort_buffer.name,      (char*) &sys_sort_buffer,             SHOW_SYS},
+  {sys_sort_threads.name,     (char*) &sys_sort_threads,            SHOW_SYS},
   {sys_big_selects.name,      (char*) &sys_big_selects,             SHOW_SYS},
   {sys_sql_mode.name,         (char*) &sys_sql_mode,                SHOW_SYS},
   {"sql_notes",               (char*) &sys_sql_notes,               SHOW_SYS},
@@ -1095,11 +1162,19 @@ struct show_var_st init_vars[]= {
   {"system_time_zone",        system_time_zone,                     SHOW_CHAR},
 #endif
   {"table_cache",             (char*) &table_cache_size,            SHOW_LONG},
+  {sys_table_cache_per_thread.name,(char*) &sys_table_cache_per_thread, SHOW_SYS},
   {"table_lock_wait_timeout", (char*) &table_lock_wait_timeout,     SHOW_LONG },
   {sys_table_type.name,	      (char*) &sys_table_type,	            SHOW_SYS},
   {sys_thread_cache_size.name,(char*) &sys_thread_cache_size,       SHOW_SYS},
 #ifdef HAVE_THR_SETCONCURRENCY
   {"thread_concurrency",      (char*) &concurrency,                 SHOW_LONG},
+#endif
+#ifndef EMBEDDED_LIBRARY
+  {"thread_handling",         (char*) &opt_thread_handling,         SHOW_CHAR_PTR},
+  {"thread_pool_max_active",  (char*) &thread_pool_max_active,      SHOW_LONG},
+  {"thread_pool_max_threads", (char*) &thread_pool_max_threads,     SHOW_LONG},
+  {"thread_pool_size",        (char*) &thread_pool_size,            SHOW_LONG},
+  {"thread_pool_stall_limit", (char*) &thread_pool_stall_limit,     SHOW_LONG},
 #endif
   {"thread_stack",            (char*) &thread_stack,                SHOW_LONG},
   {sys_time_format.name,      (char*) &sys_time_format,		    SHOW_SYS},
@@ -1358,6 +1433,11 @@ static void fix_query_cache_min_res_unit(THD *thd, enum_var_type type)
   query_cache_min_res_unit=
     query_cache.set_min_res_unit(query_cache_min_res_unit);
 }
+
+static void fix_query_cache_limit(THD *thd, enum_var_type type)
+{
+  query_cache.result_size_limit(query_cache_limit);
+}
 #endif
 
 
@@ -3763,6 +3843,7 @@ static KEY_CACHE *create_key_cache(const char *name, uint length)
       key_cache->param_block_size=     dflt_key_cache_var.param_block_size;
       key_cache->param_division_limit= dflt_key_cache_var.param_division_limit;
       key_cache->param_age_threshold=  dflt_key_cache_var.param_age_threshold;
+      key_cache->param_segments=       dflt_key_cache_var.param_segments;
     }
   }
   DBUG_RETURN(key_cache);
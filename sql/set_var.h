@@ -999,6 +999,7 @@ public:
   }
   friend bool process_key_caches(int (* func) (const char *name,
 					       KEY_CACHE *));
+  friend int fill_key_caches(THD *thd, TABLE_LIST *tables, COND *cond);
   friend void delete_elements(I_List<NAMED_LIST> *list,
 			      void (*free_element)(const char*, gptr));
 };
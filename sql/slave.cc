@@ -1133,7 +1133,7 @@ static bool sql_slave_killed(THD* thd, RELAY_LOG_INFO* rli)
 {
   DBUG_ASSERT(rli->sql_thd == thd);
   DBUG_ASSERT(rli->slave_running == 1);// tracking buffer overrun
-  return rli->abort_slave || abort_loop || thd->killed;
+  return rli->abort_slave || abort_loop || thd->killed || rli->jobs_abort;
 }
 
 
@@ -2636,7 +2636,9 @@ st_relay_log_info::st_relay_log_info()
    ignore_log_space_limit(0), last_master_timestamp(0), slave_skip_counter(0),
    abort_pos_wait(0), slave_run_id(0), sql_thd(0), last_slave_errno(0),
    inited(0), abort_slave(0), slave_running(0), until_condition(UNTIL_NONE),
-   until_log_pos(0), retried_trans(0)
+   until_log_pos(0), retried_trans(0), workers(0), n_workers(0), n_jobs(0),
+   jobs_first(0), jobs_last(0), cur_job(0), jobs_abort(0), worker(0),
+   recovery_pos(0), recovery_workers(0)
 {
   group_relay_log_name[0]= event_relay_log_name[0]=
     group_master_log_name[0]= 0;
@@ -2652,6 +2654,8 @@ st_relay_log_info::st_relay_log_info()
   pthread_cond_init(&start_cond, NULL);
   pthread_cond_init(&stop_cond, NULL);
   pthread_cond_init(&log_space_cond, NULL);
+  pthread_mutex_init(&jobs_lock, MY_MUTEX_INIT_FAST);
+  pthread_cond_init(&jobs_cond, NULL);
   relay_log.init_pthread_objects();
 }
 
@@ -2665,6 +2669,8 @@ st_relay_log_info::~st_relay_log_info()
   pthread_cond_destroy(&start_cond);
   pthread_cond_destroy(&stop_cond);
   pthread_cond_destroy(&log_space_cond);
+  pthread_mutex_destroy(&jobs_lock);
+  pthread_cond_destroy(&jobs_cond);
   relay_log.cleanup();
 }
 
@@ -3248,6 +3254,1099 @@ bool st_relay_log_info::cached_charset_compare(char *charset)
 }
 
 
+/*
+  Apply an event read from the relay log, skipping it if it must be
+  skipped, and retrying its transaction on a transient error.
+  Called with rli->data_lock held, which is released.
+*/
+
+static int apply_relay_log_event(THD* thd, RELAY_LOG_INFO* rli, Log_event* ev)
+{
+  int type_code = ev->get_type_code();
+  int exec_res;
+
+  /*
+    Queries originating from this server must be skipped.
+    Low-level events (Format_desc, Rotate, Stop) from this server
+    must also be skipped. But for those we don't want to modify
+    group_master_log_pos, because these events did not exist on the master.
+    Format_desc is not completely skipped.
+    Skip queries specified by the user in slave_skip_counter.
+    We can't however skip events that has something to do with the
+    log files themselves.
+    Filtering on own server id is extremely important, to ignore execution of
+    events created by the creation/rotation of the relay log (remember that
+    now the relay log starts with its Format_desc, has a Rotate etc).
+  */
+
+  DBUG_PRINT("info",("type_code: %d; server_id: %d; slave_skip_counter: %d",
+                     type_code, ev->server_id, rli->slave_skip_counter));
+
+  /*
+    If the slave skip counter is positive, we still need to set the
+    OPTION_BEGIN flag correctly and not skip the log events that
+    start or end a transaction. If we do this, the slave will not
+    notice that it is inside a transaction, and happily start
+    executing from inside the transaction.
+
+    Note that the code block below is strictly 5.0.
+   */
+#if MYSQL_VERSION_ID < 50100
+  if (unlikely(rli->slave_skip_counter > 0))
+  {
+    switch (type_code)
+    {
+    case QUERY_EVENT:
+    {
+      Query_log_event* const qev= (Query_log_event*) ev;
+      DBUG_PRINT("info", ("QUERY_EVENT { query: '%s', q_len: %u }",
+                          qev->query, qev->q_len));
+      if (memcmp("BEGIN", qev->query, qev->q_len+1) == 0)
+        thd->options|= OPTION_BEGIN;
+      else if (memcmp("COMMIT", qev->query, qev->q_len+1) == 0 ||
+               memcmp("ROLLBACK", qev->query, qev->q_len+1) == 0)
+        thd->options&= ~OPTION_BEGIN;
+    }
+    break;
+
+    case XID_EVENT:
+      DBUG_PRINT("info", ("XID_EVENT"));
+      thd->options&= ~OPTION_BEGIN;
+      break;
+    }
+  }
+#endif
+
+  if ((ev->server_id == (uint32) ::server_id &&
+       !replicate_same_server_id &&
+       type_code != FORMAT_DESCRIPTION_EVENT) ||
+      (rli->slave_skip_counter &&
+       type_code != ROTATE_EVENT && type_code != STOP_EVENT &&
+       type_code != START_EVENT_V3 && type_code!= FORMAT_DESCRIPTION_EVENT))
+  {
+    DBUG_PRINT("info", ("event skipped"));
+    if (thd->options & OPTION_BEGIN)
+      rli->inc_event_relay_log_pos();
+    else
+    {
+      rli->inc_group_relay_log_pos((type_code == ROTATE_EVENT ||
+                                    type_code == STOP_EVENT ||
+                                    type_code == FORMAT_DESCRIPTION_EVENT) ?
+                                   LL(0) : ev->log_pos,
+                                   1/* skip lock*/);
+      flush_relay_log_info(rli);
+    }
+
+    DBUG_PRINT("info", ("thd->options: %s",
+                        (thd->options & OPTION_BEGIN) ? "OPTION_BEGIN" : ""));
+
+    /*
+      Protect against common user error of setting the counter to 1
+      instead of 2 while recovering from an insert which used auto_increment,
+      rand or user var.
+    */
+    if (rli->slave_skip_counter &&
+        !((type_code == INTVAR_EVENT ||
+           type_code == RAND_EVENT ||
+           type_code == USER_VAR_EVENT ||
+           type_code == BEGIN_LOAD_QUERY_EVENT ||
+           type_code == APPEND_BLOCK_EVENT ||
+           type_code == CREATE_FILE_EVENT) &&
+          rli->slave_skip_counter == 1) &&
+#if MYSQL_VERSION_ID < 50100
+        /*
+          Decrease the slave skip counter only if we are not inside
+          a transaction or the slave skip counter is more than
+          1. The slave skip counter will be decreased from 1 to 0
+          when reaching the final ROLLBACK, COMMIT, or XID_EVENT.
+         */
+        (!(thd->options & OPTION_BEGIN) || rli->slave_skip_counter > 1) &&
+#endif
+        /*
+          The events from ourselves which have something to do with the relay
+          log itself must be skipped, true, but they mustn't decrement
+          rli->slave_skip_counter, because the user is supposed to not see
+          these events (they are not in the master's binlog) and if we
+          decremented, START SLAVE would for example decrement when it sees
+          the Rotate, so the event which the user probably wanted to skip
+          would not be skipped.
+        */
+        !(ev->server_id == (uint32) ::server_id &&
+          (type_code == ROTATE_EVENT ||
+           type_code == STOP_EVENT ||
+           type_code == START_EVENT_V3 ||
+           type_code == FORMAT_DESCRIPTION_EVENT)))
+      --rli->slave_skip_counter;
+    pthread_mutex_unlock(&rli->data_lock);
+    delete ev;
+    return 0;                                 // avoid infinite update loops
+  }
+  pthread_mutex_unlock(&rli->data_lock);
+
+  thd->server_id = ev->server_id; // use the original server id for logging
+  thd->set_time();				// time the query
+  thd->lex->current_select= 0;
+  if (!ev->when)
+    ev->when = time(NULL);
+  ev->thd = thd;
+  exec_res = ev->exec_event(rli);
+  DBUG_ASSERT(rli->sql_thd==thd);
+  /*
+     Format_description_log_event should not be deleted because it will be
+     used to read info about the relay log's format; it will be deleted when
+     the SQL thread does not need it, i.e. when this thread terminates.
+  */
+  if (ev->get_type_code() != FORMAT_DESCRIPTION_EVENT)
+  {
+    DBUG_PRINT("info", ("Deleting the event after it has been executed"));
+    delete ev;
+  }
+  if (slave_trans_retries)
+  {
+    if (exec_res &&
+        (thd->net.last_errno == ER_LOCK_DEADLOCK ||
+         thd->net.last_errno == ER_LOCK_WAIT_TIMEOUT) &&
+        !thd->is_fatal_error)
+    {
+      const char *errmsg;
+      /*
+        We were in a transaction which has been rolled back because of a
+      Sonera  deadlock. if lock wait timeout (innodb_lock_wait_timeout exceeded)
+	  there is no rollback since 5.0.13 (ref: manual).
+	  let's seek back to BEGIN log event and retry it all again.
+        We have to not only seek but also
+        a) init_master_info(), to seek back to hot relay log's start for later
+        (for when we will come back to this hot log after re-processing the
+        possibly existing old logs where BEGIN is: check_binlog_magic() will
+        then need the cache to be at position 0 (see comments at beginning of
+        init_master_info()).
+        b) init_relay_log_pos(), because the BEGIN may be an older relay log.
+      */
+      if (rli->trans_retries < slave_trans_retries)
+      {
+        if (init_master_info(rli->mi, 0, 0, 0, SLAVE_SQL))
+          sql_print_error("Failed to initialize the master info structure");
+        else if (init_relay_log_pos(rli,
+                                    rli->group_relay_log_name,
+                                    rli->group_relay_log_pos,
+                                    1, &errmsg, 1))
+          sql_print_error("Error initializing relay log position: %s",
+                          errmsg);
+        else
+        {
+          exec_res= 0;
+	    end_trans(thd, ROLLBACK);
+	    /* chance for concurrent connection to get more locks */
+          safe_sleep(thd, min(rli->trans_retries, MAX_SLAVE_RETRY_PAUSE),
+		       (CHECK_KILLED_FUNC)sql_slave_killed, (void*)rli);
+          pthread_mutex_lock(&rli->data_lock); // because of SHOW STATUS
+	    rli->trans_retries++;
+          rli->retried_trans++;
+          pthread_mutex_unlock(&rli->data_lock);
+          DBUG_PRINT("info", ("Slave retries transaction "
+                              "rli->trans_retries: %lu", rli->trans_retries));
+	  }
+      }
+      else
+        sql_print_error("Slave SQL thread retried transaction %lu time(s) "
+                        "in vain, giving up. Consider raising the value of "
+                        "the slave_transaction_retries variable.",
+                        slave_trans_retries);
+    }
+    else if (!((thd->options & OPTION_BEGIN) && opt_using_transactions))
+    {
+      /*
+        Only reset the retry counter if the event succeeded or
+        failed with a non-transient error.  On a successful event,
+        the execution will proceed as usual; in the case of a
+        non-transient error, the slave will stop with an error.
+	*/
+      rli->trans_retries= 0; // restart from fresh
+    }
+  }
+  return exec_res;
+}
+
+
+/*****************************************************************************
+
+  Parallel appliers
+
+  With slave_parallel_workers > 0 the SQL thread becomes a coordinator. It
+  reads the relay log and cuts it into groups: a transaction from BEGIN to
+  COMMIT/ROLLBACK/Xid, or a statement with the Intvar, Rand and User_var
+  events before it. A group whose statements all logged the databases they
+  accessed (Q_UPDATED_DB_NAMES), and whose databases all hash to the same
+  worker, is queued to that worker. As the groups of a database always go
+  to the same worker, they are applied in the order of the master.
+
+  Everything else (DDL, LOAD DATA, statements on temporary tables, groups
+  over the databases of several workers, events which are not part of a
+  group...) is applied by the coordinator itself, the classic way, once
+  all queued groups have been applied.
+
+  The group_* coordinates of the coordinator are advanced by the workers,
+  up to the end of the last group applied together with all groups before
+  it. Each worker also saves its own position in its info file: if the
+  slave stops uncleanly, the next run loads these positions and skips the
+  groups which were already applied by the worker of their database. The
+  files are deleted when the workers have caught up, or on a clean stop.
+
+*****************************************************************************/
+
+static void slave_worker_info_file_name(char *fname, uint id)
+{
+  char buf[FN_REFLEN];
+  my_snprintf(buf, sizeof(buf), "%s.%u", relay_log_info_file, id);
+  fn_format(fname, buf, mysql_data_home, "", 4+32);
+}
+
+
+void delete_slave_worker_info_files()
+{
+  char fname[FN_REFLEN+128];
+  for (uint id= 1; id <= SLAVE_MAX_WORKERS; id++)
+  {
+    slave_worker_info_file_name(fname, id);
+    (void) my_delete(fname, MYF(0));
+  }
+}
+
+
+static void slave_free_job_events(SLAVE_JOB *job)
+{
+  SLAVE_JOB_EVENT *je;
+  while ((je= job->first_event))
+  {
+    job->first_event= je->next;
+    delete je->ev;
+    my_free((gptr) je, MYF(0));
+  }
+  job->last_event= 0;
+}
+
+
+static void slave_free_job(SLAVE_JOB *job)
+{
+  slave_free_job_events(job);
+  my_free((gptr) job, MYF(0));
+}
+
+
+static uint slave_db_hash(const char *db)
+{
+  uint nr= 0;
+  /* Databases which replicate-rewrite-db merges must go to one worker */
+  for (db= rewrite_db(db); *db; db++)
+    nr= nr * 31 + (uchar) *db;
+  return nr;
+}
+
+
+/*
+  Check whether a query is an INSERT, UPDATE, DELETE or REPLACE that the
+  master logged without Q_UPDATED_DB_NAMES because it only worked on the
+  default database of the event.
+*/
+
+static bool slave_is_default_db_query(Query_log_event *qev)
+{
+  static const char *dml_words[]= { "INSERT", "UPDATE", "DELETE", "REPLACE",
+                                    NullS };
+  const char *pos= qev->query, *end= qev->query + qev->q_len;
+
+  if (qev->accessed_dbs || !qev->db_len)
+    return 0;
+  while (pos < end && my_isspace(system_charset_info, *pos))
+    pos++;
+  for (const char **word= dml_words; *word; word++)
+  {
+    uint length= strlen(*word);
+    if ((uint) (end - pos) > length &&
+        !my_strnncoll(system_charset_info, (const uchar*) pos, length,
+                      (const uchar*) *word, length) &&
+        !my_isvar(system_charset_info, pos[length]))
+      return 1;
+  }
+  return 0;
+}
+
+
+/*
+  Return the worker (among n_workers) of the databases of a group, or -1 if
+  they do not all belong to the same worker.
+*/
+
+static int slave_job_worker(SLAVE_JOB *job, uint n_workers)
+{
+  int key= -1;
+  for (SLAVE_JOB_EVENT *je= job->first_event; je; je= je->next)
+  {
+    Query_log_event *qev;
+    if (je->ev->get_type_code() != QUERY_EVENT)
+      continue;
+    qev= (Query_log_event*) je->ev;
+    if (qev->accessed_dbs > MAX_DBS_IN_QUERY_EVENT)
+      return -1;
+    if (slave_is_default_db_query(qev))
+    {
+      int k= (int) (slave_db_hash(qev->db) % n_workers);
+      if (key >= 0 && key != k)
+        return -1;
+      key= k;
+    }
+    for (uint i= 0; i < qev->accessed_dbs; i++)
+    {
+      int k= (int) (slave_db_hash(qev->accessed_db_names[i]) % n_workers);
+      if (key < 0)
+        key= k;
+      else if (key != k)
+        return -1;
+    }
+  }
+  return key;
+}
+
+
+/*
+  Move the group_* coordinates to the end of the last group applied
+  together with all groups before it. Called with rli->jobs_lock held.
+*/
+
+static void slave_advance_checkpoint(RELAY_LOG_INFO *rli)
+{
+  SLAVE_JOB *job;
+  if (!(job= rli->jobs_first) || !job->done)
+    return;
+  pthread_mutex_lock(&rli->data_lock);
+  do
+  {
+    strmake(rli->group_relay_log_name, job->relay_log_name,
+            sizeof(rli->group_relay_log_name)-1);
+    rli->notify_group_relay_log_name_update();
+    rli->group_relay_log_pos= job->relay_log_pos;
+    if (job->master_log_pos)
+      rli->group_master_log_pos= job->master_log_pos;
+    rli->last_master_timestamp= job->when;
+    rli->jobs_first= job->next;
+    rli->n_jobs--;
+    slave_free_job(job);
+  } while ((job= rli->jobs_first) && job->done);
+  if (!rli->jobs_first)
+    rli->jobs_last= 0;
+  flush_relay_log_info(rli);
+  pthread_mutex_unlock(&rli->data_lock);
+  pthread_cond_broadcast(&rli->data_cond);
+}
+
+
+/*
+  Stop the coordinator and the other workers after an error in a worker.
+*/
+
+static void slave_worker_abort(SLAVE_WORKER *w)
+{
+  RELAY_LOG_INFO *rli= w->coordinator;
+
+  pthread_mutex_lock(&rli->data_lock);
+  if (w->rli.last_slave_errno || w->rli.last_slave_error[0])
+  {
+    rli->last_slave_errno= w->rli.last_slave_errno;
+    strmake(rli->last_slave_error, w->rli.last_slave_error,
+            sizeof(rli->last_slave_error)-1);
+  }
+  else if (!rli->last_slave_errno)
+    slave_print_error(rli, 0, "Slave worker thread %u stopped", w->id);
+  pthread_mutex_unlock(&rli->data_lock);
+
+  pthread_mutex_lock(&rli->jobs_lock);
+  rli->jobs_abort= 1;
+  for (uint i= 0; i < rli->n_workers; i++)
+    pthread_cond_signal(&rli->workers[i]->cond);
+  pthread_cond_broadcast(&rli->jobs_cond);
+  pthread_mutex_unlock(&rli->jobs_lock);
+
+  /* Wake up the coordinator if it waits in next_event() */
+  pthread_mutex_lock(rli->relay_log.get_log_lock());
+  rli->relay_log.signal_update();
+  pthread_mutex_unlock(rli->relay_log.get_log_lock());
+}
+
+
+static bool slave_worker_killed(THD *thd, SLAVE_WORKER *w)
+{
+  return abort_loop || thd->killed || w->coordinator->jobs_abort;
+}
+
+
+static int slave_open_worker_info_file(SLAVE_WORKER *w)
+{
+  char fname[FN_REFLEN+128];
+  slave_worker_info_file_name(fname, w->id);
+  if ((w->rli.info_fd= my_open(fname, O_CREAT|O_TRUNC|O_RDWR|O_BINARY,
+                               MYF(MY_WME))) < 0)
+  {
+    sql_print_error("Failed to create the slave worker info file '%s' "
+                    "(errno %d)", fname, my_errno);
+    return 1;
+  }
+  if (init_io_cache(&w->rli.info_file, w->rli.info_fd, IO_SIZE, WRITE_CACHE,
+                    0L, 0, MYF(MY_WME)))
+  {
+    sql_print_error("Failed to create a cache on slave worker info file "
+                    "'%s'", fname);
+    my_close(w->rli.info_fd, MYF(0));
+    w->rli.info_fd= -1;
+    return 1;
+  }
+  return 0;
+}
+
+
+/*
+  Apply a group in a worker. A transaction which fails on a deadlock or a
+  lock wait timeout is retried, up to slave_transaction_retries times.
+*/
+
+static int slave_worker_apply_job(SLAVE_WORKER *w, SLAVE_JOB *job)
+{
+  THD *thd= w->thd;
+  RELAY_LOG_INFO *rli= &w->rli;
+  RELAY_LOG_INFO *c_rli= w->coordinator;
+  ulong retries= 0;
+  int exec_res;
+
+  if (rli->info_fd < 0 && slave_open_worker_info_file(w))
+    return 1;
+  strmake(rli->event_relay_log_name, job->relay_log_name,
+          sizeof(rli->event_relay_log_name)-1);
+  /* The coordinator changes it only when no worker has groups */
+  if (strcmp(rli->group_master_log_name, c_rli->group_master_log_name))
+    strmake(rli->group_master_log_name, c_rli->group_master_log_name,
+            sizeof(rli->group_master_log_name)-1);
+
+  for (;;)
+  {
+    exec_res= 0;
+    for (SLAVE_JOB_EVENT *je= job->first_event; je && !exec_res; je= je->next)
+    {
+      Log_event *ev= je->ev;
+      rli->future_event_relay_log_pos= je->relay_log_pos;
+      thd->server_id= ev->server_id; // use the original server id for logging
+      thd->set_time();
+      thd->lex->current_select= 0;
+      if (!ev->when)
+        ev->when= time(NULL);
+      ev->thd= thd;
+      exec_res= ev->exec_event(rli);
+    }
+    if (!exec_res)
+      break;
+    if (!(thd->net.last_errno == ER_LOCK_DEADLOCK ||
+          thd->net.last_errno == ER_LOCK_WAIT_TIMEOUT) ||
+        thd->is_fatal_error || slave_worker_killed(thd, w))
+      return 1;
+    if (retries >= slave_trans_retries)
+    {
+      sql_print_error("Slave worker thread %u retried transaction %lu "
+                      "time(s) in vain, giving up. Consider raising the "
+                      "value of the slave_transaction_retries variable.",
+                      w->id, slave_trans_retries);
+      return 1;
+    }
+    end_trans(thd, ROLLBACK);
+    /* chance for concurrent connection to get more locks */
+    safe_sleep(thd, min(++retries, MAX_SLAVE_RETRY_PAUSE),
+               (CHECK_KILLED_FUNC) slave_worker_killed, (void*) w);
+    pthread_mutex_lock(&c_rli->data_lock); // because of SHOW STATUS
+    c_rli->retried_trans++;
+    pthread_mutex_unlock(&c_rli->data_lock);
+  }
+  /* The group is not needed anymore, only its coordinates */
+  slave_free_job_events(job);
+  return 0;
+}
+
+
+/* Slave worker thread entry point */
+
+pthread_handler_t handle_slave_worker(void *arg)
+{
+  THD *thd;                     /* needs to be first for thread_stack */
+  SLAVE_WORKER *w= (SLAVE_WORKER*) arg;
+  RELAY_LOG_INFO *rli= w->coordinator;
+  SLAVE_JOB *job;
+  const char *old_msg;
+
+  my_thread_init();
+  DBUG_ENTER("handle_slave_worker");
+
+  thd= new THD;
+  thd->thread_stack= (char*) &thd;
+  w->thd= thd;
+  w->rli.sql_thd= thd;
+  pthread_detach_this_thread();
+  if (init_slave_thread(thd, SLAVE_THD_SQL))
+  {
+    sql_print_error("Failed during slave worker thread initialization");
+    slave_worker_abort(w);
+    goto err;
+  }
+  thd->init_for_queries();
+  pthread_mutex_lock(&LOCK_thread_count);
+  threads.append(thd);
+  pthread_mutex_unlock(&LOCK_thread_count);
+
+  for (;;)
+  {
+    pthread_mutex_lock(&rli->jobs_lock);
+    old_msg= thd->enter_cond(&w->cond, &rli->jobs_lock,
+                             "Waiting for a group from the slave SQL thread");
+    while (!w->first_job && !w->stop && !rli->jobs_abort && !thd->killed)
+      pthread_cond_wait(&w->cond, &rli->jobs_lock);
+    job= (rli->jobs_abort || thd->killed) ? 0 : w->first_job;
+    thd->exit_cond(old_msg);
+    if (!job)
+      break;
+
+    if (slave_worker_apply_job(w, job))
+    {
+      slave_worker_abort(w);
+      break;
+    }
+
+    pthread_mutex_lock(&rli->jobs_lock);
+    if (!(w->first_job= job->next_in_worker))
+      w->last_job= 0;
+    w->n_jobs--;
+    job->done= 1;
+    slave_advance_checkpoint(rli);
+    pthread_cond_broadcast(&rli->jobs_cond);
+    pthread_mutex_unlock(&rli->jobs_lock);
+  }
+  if (thd->killed && !rli->jobs_abort)
+    slave_worker_abort(w);
+
+err:
+  VOID(pthread_mutex_lock(&LOCK_thread_count));
+  thd->catalog= 0;
+  thd->reset_db(NULL, 0);
+  thd->query= 0;
+  thd->query_length= 0;
+  VOID(pthread_mutex_unlock(&LOCK_thread_count));
+  DBUG_ASSERT(thd->net.buff != 0);
+  net_end(&thd->net); // destructor will not free it, because we are weird
+  w->rli.sql_thd= 0;
+  pthread_mutex_lock(&LOCK_thread_count);
+  THD_CHECK_SENTRY(thd);
+  delete thd;
+  pthread_mutex_unlock(&LOCK_thread_count);
+  w->thd= 0;
+  if (w->rli.info_fd >= 0)
+  {
+    end_io_cache(&w->rli.info_file);
+    my_close(w->rli.info_fd, MYF(MY_WME));
+    w->rli.info_fd= -1;
+  }
+
+  /* The coordinator may free the worker as soon as we say we are done */
+  pthread_mutex_lock(&rli->jobs_lock);
+  w->running= 0;
+  pthread_cond_broadcast(&rli->jobs_cond);
+  pthread_mutex_unlock(&rli->jobs_lock);
+
+  my_thread_end();
+  pthread_exit(0);
+  DBUG_RETURN(0);                               // Can't return anything here
+}
+
+
+/*
+  Load the positions saved by the workers of the previous run. They are
+  only there if it did not end cleanly.
+*/
+
+static void load_slave_worker_positions(RELAY_LOG_INFO *rli)
+{
+  char fname[FN_REFLEN+128], relay_log_name[FN_REFLEN];
+  for (uint id= 1; id <= SLAVE_MAX_WORKERS; id++)
+  {
+    IO_CACHE file;
+    File fd;
+    int relay_log_pos, master_log_pos, n_workers;
+    SLAVE_WORKER_POS pos;
+
+    slave_worker_info_file_name(fname, id);
+    if (access(fname, F_OK))
+      continue;
+    if ((fd= my_open(fname, O_RDONLY|O_BINARY, MYF(MY_WME))) < 0)
+      continue;
+    if (init_io_cache(&file, fd, IO_SIZE, READ_CACHE, 0L, 0, MYF(MY_WME)))
+    {
+      my_close(fd, MYF(0));
+      continue;
+    }
+    if (init_strvar_from_file(relay_log_name, sizeof(relay_log_name),
+                              &file, "") ||
+        init_intvar_from_file(&relay_log_pos, &file, BIN_LOG_HEADER_SIZE) ||
+        init_strvar_from_file(pos.master_log_name,
+                              sizeof(pos.master_log_name), &file, "") ||
+        init_intvar_from_file(&master_log_pos, &file, 0) ||
+        init_intvar_from_file(&n_workers, &file, 0) ||
+        n_workers <= 0 || n_workers > SLAVE_MAX_WORKERS ||
+        (int) id > n_workers)
+      sql_print_warning("Ignoring the slave worker info file '%s'", fname);
+    else if (rli->recovery_pos ||
+             (rli->recovery_pos= (SLAVE_WORKER_POS*)
+              my_malloc(sizeof(SLAVE_WORKER_POS) * SLAVE_MAX_WORKERS,
+                        MYF(MY_WME | MY_ZEROFILL))))
+    {
+      pos.master_log_pos= (ulonglong) master_log_pos;
+      rli->recovery_pos[id-1]= pos;
+      rli->recovery_workers= (uint) n_workers;
+    }
+    end_io_cache(&file);
+    my_close(fd, MYF(0));
+  }
+  if (rli->recovery_workers)
+    sql_print_information("Slave SQL thread: found the positions of %u "
+                          "slave workers of the previous run, will skip the "
+                          "groups they applied", rli->recovery_workers);
+}
+
+
+static int slave_cmp_master_pos(const char *log_name_1, ulonglong log_pos_1,
+                                const char *log_name_2, ulonglong log_pos_2)
+{
+  int cmp= strcmp(log_name_1, log_name_2);
+  if (cmp)
+    return cmp;
+  return log_pos_1 < log_pos_2 ? -1 : log_pos_1 > log_pos_2 ? 1 : 0;
+}
+
+
+/*
+  Once the group_* coordinates are past all the positions of the workers
+  of the previous run, the groups can be handed to the workers again.
+*/
+
+static void slave_check_recovery_end(RELAY_LOG_INFO *rli)
+{
+  for (uint i= 0; i < rli->recovery_workers; i++)
+  {
+    if (slave_cmp_master_pos(rli->group_master_log_name,
+                             rli->group_master_log_pos,
+                             rli->recovery_pos[i].master_log_name,
+                             rli->recovery_pos[i].master_log_pos) < 0)
+      return;
+  }
+  sql_print_information("Slave SQL thread: caught up with the slave workers "
+                        "of the previous run");
+  delete_slave_worker_info_files();
+  my_free((gptr) rli->recovery_pos, MYF(0));
+  rli->recovery_pos= 0;
+  rli->recovery_workers= 0;
+}
+
+
+static int start_slave_workers(RELAY_LOG_INFO *rli, uint n_workers)
+{
+  DBUG_ENTER("start_slave_workers");
+
+  if (!(rli->workers= (SLAVE_WORKER**) my_malloc(sizeof(SLAVE_WORKER*) *
+                                                  n_workers,
+                                                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+  for (uint i= 0; i < n_workers; i++)
+  {
+    pthread_t th;
+    SLAVE_WORKER *w= new SLAVE_WORKER;
+    if (!w)
+      DBUG_RETURN(1);
+    w->id= i + 1;
+    w->coordinator= rli;
+    w->rli.worker= w;
+    w->rli.mi= rli->mi;
+    w->running= 1;
+    rli->workers[i]= w;
+    rli->n_workers= i + 1;
+    if (pthread_create(&th, &connection_attrib, handle_slave_worker,
+                       (void*) w))
+    {
+      w->running= 0;
+      sql_print_error("Can't create slave worker thread (errno= %d)", errno);
+      DBUG_RETURN(1);
+    }
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Let the workers apply the groups they have been given (all of them,
+  unless one of the workers failed), stop them, and free everything the
+  coordinator had.
+*/
+
+static void stop_slave_workers(RELAY_LOG_INFO *rli)
+{
+  bool clean;
+  DBUG_ENTER("stop_slave_workers");
+
+  if (rli->cur_job)
+  {
+    slave_free_job(rli->cur_job);
+    rli->cur_job= 0;
+  }
+  pthread_mutex_lock(&rli->jobs_lock);
+  for (uint i= 0; i < rli->n_workers; i++)
+  {
+    rli->workers[i]->stop= 1;
+    pthread_cond_signal(&rli->workers[i]->cond);
+  }
+  for (uint i= 0; i < rli->n_workers; i++)
+  {
+    while (rli->workers[i]->running)
+      pthread_cond_wait(&rli->jobs_cond, &rli->jobs_lock);
+  }
+  clean= !rli->jobs_first && !rli->jobs_abort;
+  while (rli->jobs_first)
+  {
+    SLAVE_JOB *job= rli->jobs_first;
+    rli->jobs_first= job->next;
+    slave_free_job(job);
+  }
+  rli->jobs_last= 0;
+  rli->n_jobs= 0;
+  pthread_mutex_unlock(&rli->jobs_lock);
+
+  for (uint i= 0; i < rli->n_workers; i++)
+    delete rli->workers[i];
+  my_free((gptr) rli->workers, MYF(MY_ALLOW_ZERO_PTR));
+  rli->workers= 0;
+  /* All groups given to the workers are within the group_* coordinates */
+  if (clean && rli->n_workers && !rli->recovery_workers)
+    delete_slave_worker_info_files();
+  rli->n_workers= 0;
+  my_free((gptr) rli->recovery_pos, MYF(MY_ALLOW_ZERO_PTR));
+  rli->recovery_pos= 0;
+  rli->recovery_workers= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Wait until the workers have applied all the groups they have been given,
+  so that the coordinator can apply an event itself.
+*/
+
+static int slave_wait_for_workers(THD *thd, RELAY_LOG_INFO *rli)
+{
+  const char *old_msg;
+  int error;
+
+  pthread_mutex_lock(&rli->jobs_lock);
+  old_msg= thd->enter_cond(&rli->jobs_cond, &rli->jobs_lock,
+                           "Waiting for the slave workers to apply their "
+                           "groups");
+  while (rli->jobs_first && !sql_slave_killed(thd, rli))
+    pthread_cond_wait(&rli->jobs_cond, &rli->jobs_lock);
+  error= rli->jobs_first != 0;
+  thd->exit_cond(old_msg);
+  return error;
+}
+
+
+static int slave_dispatch_job(THD *thd, RELAY_LOG_INFO *rli, SLAVE_JOB *job,
+                              SLAVE_WORKER *w)
+{
+  const char *old_msg;
+
+  pthread_mutex_lock(&rli->jobs_lock);
+  old_msg= thd->enter_cond(&rli->jobs_cond, &rli->jobs_lock,
+                           "Waiting for a slave worker to take more groups");
+  while ((w->n_jobs >= SLAVE_WORKER_MAX_JOBS ||
+          rli->n_jobs >= rli->n_workers * SLAVE_WORKER_MAX_JOBS) &&
+         !sql_slave_killed(thd, rli))
+    pthread_cond_wait(&rli->jobs_cond, &rli->jobs_lock);
+  if (sql_slave_killed(thd, rli))
+  {
+    thd->exit_cond(old_msg);
+    slave_free_job(job);
+    return 1;
+  }
+  if (rli->jobs_last)
+    rli->jobs_last->next= job;
+  else
+    rli->jobs_first= job;
+  rli->jobs_last= job;
+  rli->n_jobs++;
+  if (w->last_job)
+    w->last_job->next_in_worker= job;
+  else
+    w->first_job= job;
+  w->last_job= job;
+  w->n_jobs++;
+  pthread_cond_signal(&w->cond);
+  thd->exit_cond(old_msg);
+  return 0;
+}
+
+
+/*
+  Apply a group in the coordinator, after the workers are done with theirs.
+  If the transaction is rolled back to be retried, apply_relay_log_event()
+  has rewound the relay log to the group's start (which is the group_*
+  coordinates as the workers are idle): the rest of the group is dropped
+  and will be read again.
+*/
+
+static int slave_apply_job_serially(THD *thd, RELAY_LOG_INFO *rli,
+                                    SLAVE_JOB *job)
+{
+  SLAVE_JOB_EVENT *je;
+  ulonglong future_event_relay_log_pos= rli->future_event_relay_log_pos;
+  ulong retried_trans= rli->retried_trans;
+  int error= 0;
+
+  if (slave_wait_for_workers(thd, rli))
+  {
+    slave_free_job(job);
+    return 1;
+  }
+  while ((je= job->first_event))
+  {
+    Log_event *ev= je->ev;
+    job->first_event= je->next;
+    if (error || retried_trans != rli->retried_trans)
+      delete ev;
+    else
+    {
+      pthread_mutex_lock(&rli->data_lock);
+      rli->future_event_relay_log_pos= je->relay_log_pos;
+      error= apply_relay_log_event(thd, rli, ev);
+    }
+    my_free((gptr) je, MYF(0));
+  }
+  my_free((gptr) job, MYF(0));
+  rli->future_event_relay_log_pos= future_event_relay_log_pos;
+  return error;
+}
+
+
+/*
+  A group has been read entirely: hand it to its worker, skip it if a
+  worker of the previous run applied it, or apply it here.
+*/
+
+static int slave_complete_job(THD *thd, RELAY_LOG_INFO *rli, SLAVE_JOB *job)
+{
+  uint n_workers= rli->recovery_workers ? rli->recovery_workers :
+                                          rli->n_workers;
+  int key= -1;
+  int error;
+
+  if (!job->serial && n_workers && !rli->slave_skip_counter &&
+      !thd->one_shot_set)
+    key= slave_job_worker(job, n_workers);
+
+  if (!rli->recovery_workers)
+  {
+    if (key < 0)
+      return slave_apply_job_serially(thd, rli, job);
+    return slave_dispatch_job(thd, rli, job, rli->workers[key]);
+  }
+
+  if (key >= 0 &&
+      slave_cmp_master_pos(rli->group_master_log_name, job->master_log_pos,
+                           rli->recovery_pos[key].master_log_name,
+                           rli->recovery_pos[key].master_log_pos) <= 0)
+  {
+    DBUG_PRINT("info", ("group applied by worker %d before the restart",
+                        key + 1));
+    pthread_mutex_lock(&rli->data_lock);
+    rli->inc_group_relay_log_pos(job->master_log_pos, 1/* skip lock*/);
+    flush_relay_log_info(rli);
+    pthread_mutex_unlock(&rli->data_lock);
+    slave_free_job(job);
+    error= 0;
+  }
+  else
+    error= slave_apply_job_serially(thd, rli, job);
+  if (!error && !(thd->options & OPTION_BEGIN))
+    slave_check_recovery_end(rli);
+  return error;
+}
+
+
+static bool is_begin_query(Query_log_event *qev)
+{
+  return qev->q_len == 5 && !memcmp("BEGIN", qev->query, 5);
+}
+
+
+static bool is_end_query(Query_log_event *qev)
+{
+  return ((qev->q_len == 6 && !memcmp("COMMIT", qev->query, 6)) ||
+          (qev->q_len == 8 && !memcmp("ROLLBACK", qev->query, 8)));
+}
+
+
+/*
+  Add an event read from the relay log to the group being read, handing
+  the group on when it is complete. Called with rli->data_lock held, which
+  is released.
+*/
+
+static int coordinate_relay_log_event(THD* thd, RELAY_LOG_INFO* rli,
+                                      Log_event* ev)
+{
+  SLAVE_JOB *job= rli->cur_job;
+  SLAVE_JOB_EVENT *je;
+  int type_code= ev->get_type_code();
+  bool ends_group= 0;
+
+  /* The rest of a group which the coordinator had to start applying */
+  if (thd->options & OPTION_BEGIN)
+    return apply_relay_log_event(thd, rli, ev);
+
+  switch (type_code) {
+  case QUERY_EVENT:
+  case INTVAR_EVENT:
+  case RAND_EVENT:
+  case USER_VAR_EVENT:
+    break;
+  case XID_EVENT:
+    if (job)
+      break;
+    /* fall through */
+  default:
+    if (!job)
+    {
+      pthread_mutex_unlock(&rli->data_lock);
+      if (slave_wait_for_workers(thd, rli))
+      {
+        delete ev;
+        return 1;
+      }
+      pthread_mutex_lock(&rli->data_lock);
+      return apply_relay_log_event(thd, rli, ev);
+    }
+    if (type_code == ROTATE_EVENT || type_code == STOP_EVENT ||
+        (type_code == FORMAT_DESCRIPTION_EVENT &&
+         ev->server_id == (uint32) ::server_id))
+    {
+      /*
+        Events of the relay log itself, or a Rotate of a restarted I/O
+        thread: as inside a transaction, only the event coordinates move.
+      */
+      int error= 0;
+      if (type_code == FORMAT_DESCRIPTION_EVENT)
+      {
+        thd->options|= OPTION_BEGIN;
+        ev->thd= thd;
+        error= ev->exec_event(rli);
+        thd->options&= ~OPTION_BEGIN;
+      }
+      else
+      {
+        rli->inc_event_relay_log_pos();
+        delete ev;
+      }
+      pthread_mutex_unlock(&rli->data_lock);
+      return error;
+    }
+    /*
+      Something a worker cannot apply in the middle of a group: apply what
+      we have of the group here, and the rest of it too.
+    */
+    {
+      ulong retried_trans= rli->retried_trans;
+      rli->cur_job= 0;
+      pthread_mutex_unlock(&rli->data_lock);
+      if (slave_apply_job_serially(thd, rli, job))
+      {
+        delete ev;
+        return 1;
+      }
+      if (retried_trans != rli->retried_trans)
+      {
+        delete ev;
+        return 0;
+      }
+      pthread_mutex_lock(&rli->data_lock);
+      return apply_relay_log_event(thd, rli, ev);
+    }
+  }
+
+  if (!job)
+  {
+    if (!(job= (SLAVE_JOB*) my_malloc(sizeof(SLAVE_JOB),
+                                      MYF(MY_WME | MY_ZEROFILL))))
+    {
+      pthread_mutex_unlock(&rli->data_lock);
+      delete ev;
+      return 1;
+    }
+    rli->cur_job= job;
+  }
+  if (!(je= (SLAVE_JOB_EVENT*) my_malloc(sizeof(SLAVE_JOB_EVENT), MYF(MY_WME))))
+  {
+    pthread_mutex_unlock(&rli->data_lock);
+    delete ev;
+    return 1;
+  }
+  je->next= 0;
+  je->ev= ev;
+  je->relay_log_pos= rli->future_event_relay_log_pos;
+  if (job->last_event)
+    job->last_event->next= je;
+  else
+    job->first_event= je;
+  job->last_event= je;
+  rli->inc_event_relay_log_pos();
+
+  if ((ev->server_id == (uint32) ::server_id && !replicate_same_server_id) ||
+      (ev->flags & LOG_EVENT_THREAD_SPECIFIC_F))
+    job->serial= 1;
+  if (type_code == QUERY_EVENT)
+  {
+    Query_log_event *qev= (Query_log_event*) ev;
+    if (is_begin_query(qev))
+    {
+      if (job->first_event != je)
+        job->serial= 1;
+      job->in_trans= 1;
+    }
+    else if (is_end_query(qev))
+      ends_group= 1;
+    else
+    {
+      if (qev->accessed_dbs > MAX_DBS_IN_QUERY_EVENT ||
+          (!qev->accessed_dbs && !slave_is_default_db_query(qev)))
+        job->serial= 1;
+      ends_group= !job->in_trans;
+    }
+  }
+  else if (type_code == XID_EVENT)
+    ends_group= 1;
+
+  if (!ends_group)
+  {
+    pthread_mutex_unlock(&rli->data_lock);
+    return 0;
+  }
+  strmake(job->relay_log_name, rli->event_relay_log_name,
+          sizeof(job->relay_log_name)-1);
+  job->relay_log_pos= rli->event_relay_log_pos;
+  job->master_log_pos= ev->log_pos;
+  job->when= ev->when;
+  rli->cur_job= 0;
+  pthread_mutex_unlock(&rli->data_lock);
+  return slave_complete_job(thd, rli, job);
+}
+
+
 static int exec_relay_log_event(THD* thd, RELAY_LOG_INFO* rli)
 {
   /*
@@ -3269,15 +4368,13 @@ static int exec_relay_log_event(THD* thd, RELAY_LOG_INFO* rli)
   }
   if (ev)
   {
-    int type_code = ev->get_type_code();
-    int exec_res;
-
     /*
       This tests if the position of the beginning of the current event
       hits the UNTIL barrier.
     */
     if (rli->until_condition != RELAY_LOG_INFO::UNTIL_NONE &&
-        rli->is_until_satisfied((thd->options & OPTION_BEGIN || !ev->log_pos) ?
+        rli->is_until_satisfied((thd->options & OPTION_BEGIN ||
+                                 rli->cur_job || !ev->log_pos) ?
                                 rli->group_master_log_pos :
                                 ev->log_pos - ev->data_written))
     {
@@ -3293,206 +4390,9 @@ static int exec_relay_log_event(THD* thd, RELAY_LOG_INFO* rli)
       delete ev;
       return 1;
     }
-    /*
-      Queries originating from this server must be skipped.
-      Low-level events (Format_desc, Rotate, Stop) from this server
-      must also be skipped. But for those we don't want to modify
-      group_master_log_pos, because these events did not exist on the master.
-      Format_desc is not completely skipped.
-      Skip queries specified by the user in slave_skip_counter.
-      We can't however skip events that has something to do with the
-      log files themselves.
-      Filtering on own server id is extremely important, to ignore execution of
-      events created by the creation/rotation of the relay log (remember that
-      now the relay log starts with its Format_desc, has a Rotate etc).
-    */
-
-    DBUG_PRINT("info",("type_code: %d; server_id: %d; slave_skip_counter: %d",
-                       type_code, ev->server_id, rli->slave_skip_counter));
-
-    /*
-      If the slave skip counter is positive, we still need to set the
-      OPTION_BEGIN flag correctly and not skip the log events that
-      start or end a transaction. If we do this, the slave will not
-      notice that it is inside a transaction, and happily start
-      executing from inside the transaction.
-
-      Note that the code block below is strictly 5.0.
-     */
-#if MYSQL_VERSION_ID < 50100
-    if (unlikely(rli->slave_skip_counter > 0))
-    {
-      switch (type_code)
-      {
-      case QUERY_EVENT:
-      {
-        Query_log_event* const qev= (Query_log_event*) ev;
-        DBUG_PRINT("info", ("QUERY_EVENT { query: '%s', q_len: %u }",
-                            qev->query, qev->q_len));
-        if (memcmp("BEGIN", qev->query, qev->q_len+1) == 0)
-          thd->options|= OPTION_BEGIN;
-        else if (memcmp("COMMIT", qev->query, qev->q_len+1) == 0 ||
-                 memcmp("ROLLBACK", qev->query, qev->q_len+1) == 0)
-          thd->options&= ~OPTION_BEGIN;
-      }
-      break;
-
-      case XID_EVENT:
-        DBUG_PRINT("info", ("XID_EVENT"));
-        thd->options&= ~OPTION_BEGIN;
-        break;
-      }
-    }
-#endif
-
-    if ((ev->server_id == (uint32) ::server_id &&
-         !replicate_same_server_id &&
-         type_code != FORMAT_DESCRIPTION_EVENT) ||
-        (rli->slave_skip_counter &&
-         type_code != ROTATE_EVENT && type_code != STOP_EVENT &&
-         type_code != START_EVENT_V3 && type_code!= FORMAT_DESCRIPTION_EVENT))
-    {
-      DBUG_PRINT("info", ("event skipped"));
-      if (thd->options & OPTION_BEGIN)
-        rli->inc_event_relay_log_pos();
-      else
-      {
-        rli->inc_group_relay_log_pos((type_code == ROTATE_EVENT ||
-                                      type_code == STOP_EVENT ||
-                                      type_code == FORMAT_DESCRIPTION_EVENT) ?
-                                     LL(0) : ev->log_pos,
-                                     1/* skip lock*/);
-        flush_relay_log_info(rli);
-      }
-
-      DBUG_PRINT("info", ("thd->options: %s",
-                          (thd->options & OPTION_BEGIN) ? "OPTION_BEGIN" : ""));
-
-      /*
-        Protect against common user error of setting the counter to 1
-        instead of 2 while recovering from an insert which used auto_increment,
-        rand or user var.
-      */
-      if (rli->slave_skip_counter &&
-          !((type_code == INTVAR_EVENT ||
-             type_code == RAND_EVENT ||
-             type_code == USER_VAR_EVENT ||
-             type_code == BEGIN_LOAD_QUERY_EVENT ||
-             type_code == APPEND_BLOCK_EVENT ||
-             type_code == CREATE_FILE_EVENT) &&
-            rli->slave_skip_counter == 1) &&
-#if MYSQL_VERSION_ID < 50100
-          /*
-            Decrease the slave skip counter only if we are not inside
-            a transaction or the slave skip counter is more than
-            1. The slave skip counter will be decreased from 1 to 0
-            when reaching the final ROLLBACK, COMMIT, or XID_EVENT.
-           */
-          (!(thd->options & OPTION_BEGIN) || rli->slave_skip_counter > 1) &&
-#endif
-          /*
-            The events from ourselves which have something to do with the relay
-            log itself must be skipped, true, but they mustn't decrement
-            rli->slave_skip_counter, because the user is supposed to not see
-            these events (they are not in the master's binlog) and if we
-            decremented, START SLAVE would for example decrement when it sees
-            the Rotate, so the event which the user probably wanted to skip
-            would not be skipped.
-          */
-          !(ev->server_id == (uint32) ::server_id &&
-            (type_code == ROTATE_EVENT ||
-             type_code == STOP_EVENT ||
-             type_code == START_EVENT_V3 ||
-             type_code == FORMAT_DESCRIPTION_EVENT)))
-        --rli->slave_skip_counter;
-      pthread_mutex_unlock(&rli->data_lock);
-      delete ev;
-      return 0;                                 // avoid infinite update loops
-    }
-    pthread_mutex_unlock(&rli->data_lock);
-
-    thd->server_id = ev->server_id; // use the original server id for logging
-    thd->set_time();				// time the query
-    thd->lex->current_select= 0;
-    if (!ev->when)
-      ev->when = time(NULL);
-    ev->thd = thd;
-    exec_res = ev->exec_event(rli);
-    DBUG_ASSERT(rli->sql_thd==thd);
-    /*
-       Format_description_log_event should not be deleted because it will be
-       used to read info about the relay log's format; it will be deleted when
-       the SQL thread does not need it, i.e. when this thread terminates.
-    */
-    if (ev->get_type_code() != FORMAT_DESCRIPTION_EVENT)
-    {
-      DBUG_PRINT("info", ("Deleting the event after it has been executed"));
-      delete ev;
-    }
-    if (slave_trans_retries)
-    {
-      if (exec_res &&
-          (thd->net.last_errno == ER_LOCK_DEADLOCK ||
-           thd->net.last_errno == ER_LOCK_WAIT_TIMEOUT) &&
-          !thd->is_fatal_error)
-      {
-        const char *errmsg;
-        /*
-          We were in a transaction which has been rolled back because of a
-        Sonera  deadlock. if lock wait timeout (innodb_lock_wait_timeout exceeded)
-	  there is no rollback since 5.0.13 (ref: manual).
-	  let's seek back to BEGIN log event and retry it all again.
-          We have to not only seek but also
-          a) init_master_info(), to seek back to hot relay log's start for later
-          (for when we will come back to this hot log after re-processing the
-          possibly existing old logs where BEGIN is: check_binlog_magic() will
-          then need the cache to be at position 0 (see comments at beginning of
-          init_master_info()).
-          b) init_relay_log_pos(), because the BEGIN may be an older relay log.
-        */
-        if (rli->trans_retries < slave_trans_retries)
-        {
-          if (init_master_info(rli->mi, 0, 0, 0, SLAVE_SQL))
-            sql_print_error("Failed to initialize the master info structure");
-          else if (init_relay_log_pos(rli,
-                                      rli->group_relay_log_name,
-                                      rli->group_relay_log_pos,
-                                      1, &errmsg, 1))
-            sql_print_error("Error initializing relay log position: %s",
-                            errmsg);
-          else
-          {
-            exec_res= 0;
-	    end_trans(thd, ROLLBACK);
-	    /* chance for concurrent connection to get more locks */
-            safe_sleep(thd, min(rli->trans_retries, MAX_SLAVE_RETRY_PAUSE),
-		       (CHECK_KILLED_FUNC)sql_slave_killed, (void*)rli);
-            pthread_mutex_lock(&rli->data_lock); // because of SHOW STATUS
-	    rli->trans_retries++;
-            rli->retried_trans++;
-            pthread_mutex_unlock(&rli->data_lock);
-            DBUG_PRINT("info", ("Slave retries transaction "
-                                "rli->trans_retries: %lu", rli->trans_retries));
-	  }
-        }
-        else
-          sql_print_error("Slave SQL thread retried transaction %lu time(s) "
-                          "in vain, giving up. Consider raising the value of "
-                          "the slave_transaction_retries variable.",
-                          slave_trans_retries);
-      }
-      else if (!((thd->options & OPTION_BEGIN) && opt_using_transactions))
-      {
-        /*
-          Only reset the retry counter if the event succeeded or
-          failed with a non-transient error.  On a successful event,
-          the execution will proceed as usual; in the case of a
-          non-transient error, the slave will stop with an error.
-	*/
-        rli->trans_retries= 0; // restart from fresh
-      }
-    }
-    return exec_res;
+    if (rli->n_workers || rli->recovery_workers || rli->cur_job)
+      return coordinate_relay_log_event(thd, rli, ev);
+    return apply_relay_log_event(thd, rli, ev);
   }
   else
   {
@@ -4004,6 +4904,22 @@ Slave SQL thread aborted. Can't execute init_slave query");
     }
   }
 
+  /*
+    Parallel appliers are not used with START SLAVE UNTIL, but the groups
+    applied by those of a previous run are always skipped.
+  */
+  rli->jobs_abort= 0;
+  load_slave_worker_positions(rli);
+  if (slave_parallel_workers &&
+      rli->until_condition == RELAY_LOG_INFO::UNTIL_NONE &&
+      start_slave_workers(rli, min(slave_parallel_workers,
+                                   SLAVE_MAX_WORKERS)))
+  {
+    sql_print_error("Slave SQL thread aborted. Failed to start the slave "
+                    "worker threads");
+    goto err;
+  }
+
   /*
     First check until condition - probably there is nothing to execute. We
     do not want to wait for next event in this case.
@@ -4045,6 +4961,13 @@ the slave SQL thread with \"SLAVE START\". We stopped at log \
 		        RPL_LOG_NAME, llstr(rli->group_master_log_pos,llbuff));
 
  err:
+  stop_slave_workers(rli);
+  if (rli->jobs_abort)
+    sql_print_error("\
+Error running query in a slave worker thread, slave SQL thread aborted. Fix \
+the problem, and restart the slave SQL thread with \"SLAVE START\". We \
+stopped at log '%s' position %s", RPL_LOG_NAME,
+                    llstr(rli->group_master_log_pos, llbuff));
   VOID(pthread_mutex_lock(&LOCK_thread_count));
   /*
     Some extra safety, which should not been needed (normally, event deletion
@@ -4857,7 +5780,7 @@ bool flush_relay_log_info(RELAY_LOG_INFO* rli)
 {
   bool error=0;
   IO_CACHE *file = &rli->info_file;
-  char buff[FN_REFLEN*2+22*2+4], *pos;
+  char buff[FN_REFLEN*2+22*3+5], *pos;
 
   my_b_seek(file, 0L);
   pos=strmov(buff, rli->group_relay_log_name);
@@ -4867,6 +5790,12 @@ bool flush_relay_log_info(RELAY_LOG_INFO* rli)
   pos=strmov(pos, rli->group_master_log_name);
   *pos++='\n';
   pos=longlong2str(rli->group_master_log_pos, pos, 10);
+  if (rli->worker)
+  {
+    /* A worker also saves how many workers the groups were spread over */
+    *pos++='\n';
+    pos=int10_to_str((long) rli->worker->coordinator->n_workers, pos, 10);
+  }
   *pos='\n';
   if (my_b_write(file, (byte*) buff, (ulong) (pos-buff)+1))
     error=1;
@@ -91,6 +91,8 @@ extern my_bool opt_skip_slave_start, opt_reckless_slave;
 extern my_bool opt_log_slave_updates;
 extern ulonglong relay_log_space_limit;
 struct st_master_info;
+struct st_slave_worker;
+struct st_slave_job;
 
 /*
   3 possible values for MASTER_INFO::slave_running and
@@ -131,6 +133,15 @@ struct st_master_info;
 
   To clean up, call end_relay_log_info()
 
+  With slave_parallel_workers > 0 the SQL thread is a coordinator: it reads
+  the relay log, cuts it into groups and hands each group that only touches
+  the databases of one worker to that worker (see SLAVE_WORKER below). The
+  group_* coordinates then are those of the last group which has been
+  applied together with all groups before it. Each worker keeps its own
+  position in relay-log.info.<worker number> (same format, plus the number
+  of workers), so that the groups it applied beyond group_* can be skipped
+  after a crash.
+
 *****************************************************************************/
 
 typedef struct st_relay_log_info
@@ -301,6 +312,26 @@ typedef struct st_relay_log_info
   */
   ulong trans_retries, retried_trans;
 
+  /*
+    Parallel appliers; jobs_lock protects the job list, the workers' queues
+    and their state, and is taken before data_lock.
+    In the coordinator: workers[n_workers] are the worker threads, and
+    jobs_first..jobs_last the groups handed to them which are not yet
+    reflected in the group_* coordinates, in relay log order; cur_job is
+    the group being read. recovery_pos[recovery_workers] are the positions
+    reached by the workers of the previous run, if it did not end cleanly.
+    In the RELAY_LOG_INFO of a worker, 'worker' points to the worker.
+  */
+  struct st_slave_worker **workers;
+  uint n_workers, n_jobs;
+  struct st_slave_job *jobs_first, *jobs_last, *cur_job;
+  pthread_mutex_t jobs_lock;
+  pthread_cond_t jobs_cond;
+  bool jobs_abort;
+  struct st_slave_worker *worker;
+  struct st_slave_worker_pos *recovery_pos;
+  uint recovery_workers;
+
   /*
     If the end of the hot relay log is made of master's events ignored by the
     slave I/O thread, these two keep track of the coords (in the master's
@@ -367,6 +398,72 @@ typedef struct st_relay_log_info
 
 Log_event* next_event(RELAY_LOG_INFO* rli);
 
+/*
+  A group of events read by the coordinator, in the order of the relay log;
+  relay_log_name/pos and master_log_pos are the coordinates of its end.
+*/
+
+typedef struct st_slave_job_event
+{
+  struct st_slave_job_event *next;
+  Log_event *ev;
+  ulonglong relay_log_pos;                      /* End of the event */
+} SLAVE_JOB_EVENT;
+
+typedef struct st_slave_job
+{
+  struct st_slave_job *next;                    /* Next in the relay log */
+  struct st_slave_job *next_in_worker;          /* Next in worker's queue */
+  SLAVE_JOB_EVENT *first_event, *last_event;
+  char relay_log_name[FN_REFLEN];
+  ulonglong relay_log_pos;
+  ulonglong master_log_pos;
+  time_t when;
+  bool in_trans;                                /* Started with BEGIN */
+  bool serial;                                  /* Must be applied in order */
+  bool done;
+} SLAVE_JOB;
+
+typedef struct st_slave_worker_pos
+{
+  char master_log_name[FN_REFLEN];
+  ulonglong master_log_pos;
+} SLAVE_WORKER_POS;
+
+/*
+  A parallel applier thread. It applies the jobs of its queue with its own
+  THD and its own RELAY_LOG_INFO, which only serves as execution context
+  and to save the worker's position in its info file.
+*/
+
+typedef struct st_slave_worker
+{
+  uint id;
+  THD *thd;
+  RELAY_LOG_INFO rli;
+  RELAY_LOG_INFO *coordinator;
+  SLAVE_JOB *first_job, *last_job;
+  uint n_jobs;
+  bool running, stop;
+  pthread_cond_t cond;
+
+  st_slave_worker()
+    :id(0), thd(0), coordinator(0), first_job(0), last_job(0), n_jobs(0),
+     running(0), stop(0)
+  {
+    pthread_cond_init(&cond, NULL);
+  }
+
+  ~st_slave_worker()
+  {
+    pthread_cond_destroy(&cond);
+  }
+} SLAVE_WORKER;
+
+#define SLAVE_MAX_WORKERS      64
+/* Groups queued per worker before the coordinator waits */
+#define SLAVE_WORKER_MAX_JOBS  256
+
 /*****************************************************************************
 
   Replication IO Thread
@@ -578,6 +675,7 @@ int purge_relay_logs(RELAY_LOG_INFO* rli, THD *thd, bool just_reset,
 void set_slave_thread_options(THD* thd);
 void set_slave_thread_default_charset(THD* thd, RELAY_LOG_INFO *rli);
 void rotate_relay_log(MASTER_INFO* mi);
+void delete_slave_worker_info_files();
 
 pthread_handler_t handle_slave_io(void *arg);
 pthread_handler_t handle_slave_sql(void *arg);
@@ -605,6 +703,7 @@ extern my_string master_ssl_ca, master_ssl_capath, master_ssl_cert,
        
 extern I_List<i_string> replicate_do_db, replicate_ignore_db;
 extern I_List<i_string_pair> replicate_rewrite_db;
+const char *rewrite_db(const char *db);
 extern I_List<THD> threads;
 
 #endif
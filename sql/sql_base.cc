@@ -88,6 +88,7 @@ static int open_unireg_entry(THD *thd, TABLE *entry, const char *db,
 			     TABLE_LIST *table_list, MEM_ROOT *mem_root,
                              uint flags);
 static void free_cache_entry(TABLE *entry);
+static void cache_private_tables(THD *thd);
 static bool open_new_frm(THD *thd, const char *path, const char *alias,
                          const char *db, const char *table_name,
                          uint db_stat, uint prgflag,
@@ -220,7 +221,7 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
       if (!strcmp(table->table,share->table_name) &&
 	  !strcmp(table->db,entry->s->db))
       {
-	if (entry->in_use)
+	if (entry->in_use && !entry->in_private_cache)
 	  table->in_use++;
 	if (entry->locked_by_name)
 	  table->locked++;
@@ -239,7 +240,7 @@ OPEN_TABLE_LIST *list_open_tables(THD *thd, const char *db, const char *wild)
 	   strmov(((*start_list)->db= (char*) ((*start_list)+1)),
 		  entry->s->db)+1,
 	   entry->s->table_name);
-    (*start_list)->in_use= entry->in_use ? 1 : 0;
+    (*start_list)->in_use= entry->in_use && !entry->in_private_cache ? 1 : 0;
     (*start_list)->locked= entry->locked_by_name ? 1 : 0;
     start_list= &(*start_list)->next;
     *start_list=0;
@@ -325,6 +326,10 @@ bool close_cached_tables(THD *thd, bool if_wait_for_refresh,
   VOID(pthread_mutex_lock(&LOCK_open));
   if (!tables)
   {
+    refresh_version++;				// Force close of open tables
+    /* Tables in private caches are not used; close them too */
+    for (uint idx=0 ; idx < open_cache.records ; idx++)
+      unlink_private_table((TABLE*) hash_element(&open_cache,idx));
     while (unused_tables)
     {
 #ifdef EXTRA_DEBUG
@@ -334,7 +339,6 @@ bool close_cached_tables(THD *thd, bool if_wait_for_refresh,
       VOID(hash_delete(&open_cache,(byte*) unused_tables));
 #endif
     }
-    refresh_version++;				// Force close of open tables
   }
   else
   {
@@ -577,30 +581,42 @@ void close_thread_tables(THD *thd, bool lock_in_use, bool skip_derived)
   if (!thd->active_transaction())
     thd->transaction.xid_state.xid.null();
 
-  /* VOID(pthread_sigmask(SIG_SETMASK,&thd->block_signals,NULL)); */
-  if (!lock_in_use)
-    VOID(pthread_mutex_lock(&LOCK_open));
-  safe_mutex_assert_owner(&LOCK_open);
-
   DBUG_PRINT("info", ("thd->open_tables: %p", thd->open_tables));
 
-  found_old_table= 0;
-  while (thd->open_tables)
-    found_old_table|=close_thread_table(thd, &thd->open_tables);
-  thd->some_tables_deleted=0;
+  /*
+    Keep the tables that can be reused in the private table cache of the
+    thread. LOCK_open is only needed if some tables are left.
+  */
+  if (thd->open_tables && table_cache_per_thread)
+    cache_private_tables(thd);
 
-  /* Free tables to hold down open files */
-  while (open_cache.records > table_cache_size && unused_tables)
-    VOID(hash_delete(&open_cache,(byte*) unused_tables)); /* purecov: tested */
-  check_unused();
-  if (found_old_table)
+  if (!thd->open_tables)
+    thd->some_tables_deleted=0;
+  else
   {
-    /* Tell threads waiting for refresh that something has happened */
-    broadcast_refresh();
+    /* VOID(pthread_sigmask(SIG_SETMASK,&thd->block_signals,NULL)); */
+    if (!lock_in_use)
+      VOID(pthread_mutex_lock(&LOCK_open));
+    safe_mutex_assert_owner(&LOCK_open);
+
+    found_old_table= 0;
+    while (thd->open_tables)
+      found_old_table|=close_thread_table(thd, &thd->open_tables);
+    thd->some_tables_deleted=0;
+
+    /* Free tables to hold down open files */
+    while (open_cache.records > table_cache_size && unused_tables)
+      VOID(hash_delete(&open_cache,(byte*) unused_tables)); /* purecov: tested */
+    check_unused();
+    if (found_old_table)
+    {
+      /* Tell threads waiting for refresh that something has happened */
+      broadcast_refresh();
+    }
+    if (!lock_in_use)
+      VOID(pthread_mutex_unlock(&LOCK_open));
+    /*  VOID(pthread_sigmask(SIG_SETMASK,&thd->signals,NULL)); */
   }
-  if (!lock_in_use)
-    VOID(pthread_mutex_unlock(&LOCK_open));
-  /*  VOID(pthread_sigmask(SIG_SETMASK,&thd->signals,NULL)); */
 
   if (prelocked_mode == PRELOCKED)
   {
@@ -615,6 +631,191 @@ void close_thread_tables(THD *thd, bool lock_in_use, bool skip_derived)
   DBUG_VOID_RETURN;
 }
 
+/* Free memory used by the last statement and reset for next loop */
+
+static inline void reset_table_for_reuse(TABLE *table)
+{
+  if (table->s->flush_version != flush_version)
+  {
+    table->s->flush_version= flush_version;
+    table->file->extra(HA_EXTRA_FLUSH);
+  }
+  else
+    table->file->reset();
+}
+
+
+/*
+  Move tables that can be reused to the private table cache of the thread
+
+  SYNOPSIS
+    cache_private_tables()
+    thd			Thread handler
+
+  NOTES
+    Open tables of the current version are unlinked from thd->open_tables
+    and kept in thd->private_tables, as long as there is room for them
+    and the table cache is not full. The other tables are left in thd->open_tables, to be closed through
+    the shared table cache. No lock on LOCK_open is needed.
+
+    The versions are checked with LOCK_private_tables locked. Anyone
+    changing the version of a table or refresh_version does it before
+    taking LOCK_private_tables of the thread using the table (see
+    unlink_private_table()), so a table that has to be closed is never
+    kept.
+*/
+
+static void cache_private_tables(THD *thd)
+{
+  TABLE **prev= &thd->open_tables, *table;
+
+  while ((table= *prev))
+  {
+    if (table->db_stat && !table->needs_reopen_or_name_lock() &&
+        thd->version == refresh_version &&
+        thd->private_tables_count < table_cache_per_thread &&
+        open_cache.records <= table_cache_size)
+    {
+      DBUG_ASSERT(table->key_read == 0);
+      DBUG_ASSERT(!table->file || table->file->inited == handler::NONE);
+      reset_table_for_reuse(table);
+
+      pthread_mutex_lock(&thd->LOCK_private_tables);
+      if (!table->needs_reopen_or_name_lock() &&
+          thd->version == refresh_version)
+      {
+        *prev= table->next;
+        if ((table->next= thd->private_tables))
+          table->next->prev= table;
+        table->prev= 0;
+        thd->private_tables= table;
+        thd->private_tables_count++;
+        table->in_private_cache= 1;
+        pthread_mutex_unlock(&thd->LOCK_private_tables);
+        continue;
+      }
+      pthread_mutex_unlock(&thd->LOCK_private_tables);
+    }
+    prev= &table->next;
+  }
+}
+
+
+/*
+  Find a table in the private table cache of the thread
+
+  SYNOPSIS
+    get_private_table()
+    thd			Thread handler
+    key			Table cache key of the table
+    key_length		Length of key
+
+  RETURN
+    0	No usable table in the private cache
+    #	Table, unlinked from the private cache
+*/
+
+static TABLE *get_private_table(THD *thd, const char *key, uint key_length)
+{
+  TABLE *table;
+  pthread_mutex_lock(&thd->LOCK_private_tables);
+  for (table= thd->private_tables; table; table= table->next)
+  {
+    if (table->s->key_length == key_length &&
+        !memcmp(table->s->table_cache_key, key, key_length) &&
+        !table->needs_reopen_or_name_lock())
+    {
+      if (table->prev)
+        table->prev->next= table->next;
+      else
+        thd->private_tables= table->next;
+      if (table->next)
+        table->next->prev= table->prev;
+      thd->private_tables_count--;
+      table->in_private_cache= 0;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&thd->LOCK_private_tables);
+  return table;
+}
+
+
+/*
+  Take a table away from the private table cache of the thread using it
+
+  SYNOPSIS
+    unlink_private_table()
+    table		Table in open_cache
+
+  NOTES
+    We need to have a lock on LOCK_open when calling this.
+    A table found in a private cache is marked as not used and put first
+    in unused_tables, to be the first table to be freed.
+
+  RETURN
+    0	Table was not in a private cache
+    1	Table is now in unused_tables
+*/
+
+bool unlink_private_table(TABLE *table)
+{
+  THD *in_use= table->in_use;
+  bool found;
+  safe_mutex_assert_owner(&LOCK_open);
+
+  if (!in_use)
+    return 0;
+  pthread_mutex_lock(&in_use->LOCK_private_tables);
+  if ((found= table->in_private_cache))
+  {
+    if (table->prev)
+      table->prev->next= table->next;
+    else
+      in_use->private_tables= table->next;
+    if (table->next)
+      table->next->prev= table->prev;
+    in_use->private_tables_count--;
+    table->in_private_cache= 0;
+  }
+  pthread_mutex_unlock(&in_use->LOCK_private_tables);
+  if (!found)
+    return 0;
+
+  table->in_use= 0;
+  if (unused_tables)
+  {
+    table->next=unused_tables;
+    table->prev=unused_tables->prev;
+    unused_tables->prev=table;
+    table->prev->next=table;
+  }
+  else
+    table->next=table->prev=table;
+  unused_tables=table;
+  check_unused();
+  return 1;
+}
+
+
+/*
+  Give the tables in the private table cache of a thread back to the
+  shared table cache. Called when the thread ends.
+*/
+
+void close_private_tables(THD *thd)
+{
+  if (!thd->private_tables)
+    return;
+  VOID(pthread_mutex_lock(&LOCK_open));
+  while (thd->private_tables)
+    unlink_private_table(thd->private_tables);
+  while (open_cache.records > table_cache_size && unused_tables)
+    VOID(hash_delete(&open_cache,(byte*) unused_tables));
+  VOID(pthread_mutex_unlock(&LOCK_open));
+}
+
+
 /* move one table to free list */
 
 bool close_thread_table(THD *thd, TABLE **table_ptr)
@@ -640,16 +841,7 @@ bool close_thread_table(THD *thd, TABLE **table_ptr)
     */
     DBUG_ASSERT(!table->open_placeholder);
 
-    if (table->s->flush_version != flush_version)
-    {
-      table->s->flush_version= flush_version;
-      table->file->extra(HA_EXTRA_FLUSH);
-    }
-    else
-    {
-      // Free memory and reset for next loop
-      table->file->reset();
-    }
+    reset_table_for_reuse(table);
     table->in_use=0;
     if (unused_tables)
     {
@@ -1707,8 +1899,26 @@ TABLE *open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
   }
 
   /*
-    Non pre-locked/LOCK TABLES mode, and the table is not temporary:
-    this is the normal use case.
+    Non pre-locked/LOCK TABLES mode, and the table is not temporary.
+    If this thread has kept an instance of the table of the current
+    version in its private table cache, reuse it without LOCK_open.
+    HANDLER tables and a pending refresh are dealt with below.
+  */
+  if (refresh && !thd->handler_tables &&
+      (!thd->open_tables || thd->version == refresh_version) &&
+      (table= get_private_table(thd, key, key_length)))
+  {
+    if (!thd->open_tables)
+      thd->version= table->s->version;
+    DBUG_PRINT("info", ("Using table %p from the private cache", table));
+    table->next=thd->open_tables;		/* Link into simple list */
+    thd->open_tables=table;
+    table->reginfo.lock_type=TL_READ;		/* Assume read */
+    goto reset;
+  }
+
+  /*
+    This is the normal use case.
     Now we should:
     - try to find the table in the table cache.
     - if one of the discovered TABLE instances is name-locked
@@ -1854,6 +2064,24 @@ TABLE *open_table(THD *thd, TABLE_LIST *table_list, MEM_ROOT *mem_root,
       DBUG_RETURN(0);
     }
   }
+  if (!table)
+  {
+    /*
+      All instances are in use. Rather than opening a new instance take
+      one that another thread keeps idle in its private table cache;
+      unlink_private_table() puts it into unused_tables.
+    */
+    for (table= (TABLE*) hash_first(&open_cache, (byte*) key, key_length,
+                                    &state);
+         table;
+         table= (TABLE*) hash_next(&open_cache, (byte*) key, key_length,
+                                   &state))
+    {
+      if (table->in_use != thd && table->in_private_cache &&
+          unlink_private_table(table))
+        break;
+    }
+  }
   if (table)
   {
     /* Unlink the table from "unused_tables" list. */
@@ -3463,7 +3691,8 @@ find_field_in_view(THD *thd, TABLE_LIST *table_list,
   Query_arena *arena= 0, backup;  
   
   DBUG_ASSERT(table_list->schema_table_reformed ||
-              (ref != 0 && table_list->view != 0));
+              (ref != 0 && (table_list->view != 0 ||
+                            table_list->is_merged_derived())));
   for (; !field_it.end_of_fields(); field_it.next())
   {
     if (!my_strcasecmp(system_charset_info, field_it.name(), name))
@@ -3917,7 +4146,8 @@ find_field_in_tables(THD *thd, Item_ident *item,
       find_field_in_table even in the case of information schema tables
       when table_ref->field_translation != NULL.
       */
-    if (table_ref->table && !table_ref->view)
+    if (table_ref->table && !table_ref->view &&
+        !table_ref->is_merged_derived())
       found= find_field_in_table(thd, table_ref->table, name, length,
                                  TRUE, &(item->cached_field_index));
     else
@@ -5155,7 +5385,7 @@ TABLE_LIST **make_leaves_list(TABLE_LIST **list, TABLE_LIST *tables)
   {
     if (table->merge_underlying_list)
     {
-      DBUG_ASSERT(table->view &&
+      DBUG_ASSERT((table->view || table->derived) &&
                   table->effective_algorithm == VIEW_ALGORITHM_MERGE);
       list= make_leaves_list(list, table->merge_underlying_list);
     }
@@ -5266,7 +5496,7 @@ bool setup_tables(THD *thd, Name_resolution_context *context,
   {
     if (table_list->merge_underlying_list)
     {
-      DBUG_ASSERT(table_list->view &&
+      DBUG_ASSERT((table_list->view || table_list->derived) &&
                   table_list->effective_algorithm == VIEW_ALGORITHM_MERGE);
       Query_arena *arena= thd->stmt_arena, backup;
       bool res;
@@ -5455,7 +5685,8 @@ insert_fields(THD *thd, Name_resolution_context *context, const char *db_name,
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
     /* Ensure that we have access rights to all fields to be inserted. */
     if (!((table && (table->grant.privilege & SELECT_ACL) ||
-           tables->view && (tables->grant.privilege & SELECT_ACL))) &&
+           (tables->view || tables->is_merged_derived()) &&
+           (tables->grant.privilege & SELECT_ACL))) &&
         !any_privileges)
     {
       field_iterator.set(tables);
@@ -6022,7 +6253,7 @@ void remove_db_from_cache(const char *db)
     if (!strcmp(table->s->db, db))
     {
       table->s->version= 0L;			/* Free when thread is ready */
-      if (!table->in_use)
+      if (!table->in_use || unlink_private_table(table))
 	relink_unused(table);
     }
   }
@@ -6038,6 +6269,8 @@ void remove_db_from_cache(const char *db)
 void flush_tables()
 {
   (void) pthread_mutex_lock(&LOCK_open);
+  for (uint idx=0 ; idx < open_cache.records ; idx++)
+    unlink_private_table((TABLE*) hash_element(&open_cache,idx));
   while (unused_tables)
     hash_delete(&open_cache,(byte*) unused_tables);
   (void) pthread_mutex_unlock(&LOCK_open);
@@ -6083,7 +6316,7 @@ bool remove_table_from_cache(THD *thd, const char *db, const char *table_name,
     {
       THD *in_use;
       table->s->version=0L;		/* Free when thread is ready */
-      if (!(in_use=table->in_use))
+      if (!(in_use=table->in_use) || unlink_private_table(table))
       {
         DBUG_PRINT("info",("Table was not in use"));
         relink_unused(table);
@@ -268,6 +268,32 @@ are stored in one block.
 
 If join_results allocated new block(s) then we need call pack_cache again.
 
+8. Partitions.
+
+The global query_cache object (Partitioned_query_cache) divides the
+cache into query_cache_partitions Query_cache objects.  Each partition
+has its own memory pool, hashes, lists and structure_guard_mutex and
+gets an equal part of query_cache_size.  A statement is stored in and
+looked up from the partition selected by the hash of the statement
+text; the partition that stores the result of the current statement is
+remembered in THD::query_cache_partition for the writer functions
+(query_cache_insert() & co).  Table invalidation is done in every
+partition.
+
+9. Invalidation.
+
+Invalidation of a table only unlinks the queries that use it: they are
+removed from the queries hash, the query list and the table lists,
+their writer is told to stop caching, and they are put on the list of
+garbage queries (garbage_blocks).  Neither the result blocks are freed
+nor the query block locks are waited for under the structure mutex;
+this is done by free_garbage(), which frees the garbage queries that
+nobody reads.  Small amounts of garbage are freed by the invalidating
+thread itself after it has released the mutex, bigger ones are passed
+to the manager thread, which frees them QUERY_CACHE_RECLAIM_BATCH
+queries at a time.  Garbage left by readers is freed by the next
+reclaim or when the memory is needed (free_old_query()).
+
 TODO list:
 
   - Delayed till after-parsing qache answer (for column rights processing)
@@ -612,18 +638,20 @@ void query_cache_init_query(NET *net)
 
 void query_cache_insert(NET *net, const char *packet, ulong length)
 {
+  Query_cache *query_cache;
   DBUG_ENTER("query_cache_insert");
 
   /* See the comment on double-check locking usage above. */
   if (net->query_cache_query == 0)
     DBUG_VOID_RETURN;
 
-  STRUCT_LOCK(&query_cache.structure_guard_mutex);
+  query_cache= current_thd->query_cache_partition;
+  STRUCT_LOCK(&query_cache->structure_guard_mutex);
 
-  if (unlikely(query_cache.query_cache_size == 0 ||
-               query_cache.flush_in_progress))
+  if (unlikely(query_cache->query_cache_size == 0 ||
+               query_cache->flush_in_progress))
   {
-    STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+    STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
     DBUG_VOID_RETURN;
   }
 
@@ -634,52 +662,54 @@ void query_cache_insert(NET *net, const char *packet, ulong length)
     Query_cache_query *header = query_block->query();
     Query_cache_block *result = header->result();
 
-    DUMP(&query_cache);
+    DUMP(query_cache);
     BLOCK_LOCK_WR(query_block);
     DBUG_PRINT("qcache", ("insert packet %lu bytes long",length));
 
     /*
-      On success STRUCT_UNLOCK(&query_cache.structure_guard_mutex) will be
-      done by query_cache.append_result_data if success (if not we need
-      query_cache.structure_guard_mutex locked to free query)
+      On success STRUCT_UNLOCK(&query_cache->structure_guard_mutex) will be
+      done by query_cache->append_result_data if success (if not we need
+      query_cache->structure_guard_mutex locked to free query)
     */
-    if (!query_cache.append_result_data(&result, length, (gptr) packet,
-					query_block))
+    if (!query_cache->append_result_data(&result, length, (gptr) packet,
+					 query_block))
     {
       DBUG_PRINT("warning", ("Can't append data"));
       header->result(result);
       DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
       // The following call will remove the lock on query_block
-      query_cache.free_query(query_block);
+      query_cache->free_query(query_block);
       // append_result_data no success => we need unlock
-      STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+      STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
       DBUG_VOID_RETURN;
     }
     header->result(result);
     header->last_pkt_nr= net->pkt_nr;
     BLOCK_UNLOCK_WR(query_block);
-    DBUG_EXECUTE("check_querycache",query_cache.check_integrity(0););
+    DBUG_EXECUTE("check_querycache",query_cache->check_integrity(0););
   }
   else
-    STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+    STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
   DBUG_VOID_RETURN;
 }
 
 
 void query_cache_abort(NET *net)
 {
+  Query_cache *query_cache;
   DBUG_ENTER("query_cache_abort");
 
   /* See the comment on double-check locking usage above. */
   if (net->query_cache_query == 0)
     DBUG_VOID_RETURN;
 
-  STRUCT_LOCK(&query_cache.structure_guard_mutex);
+  query_cache= current_thd->query_cache_partition;
+  STRUCT_LOCK(&query_cache->structure_guard_mutex);
 
-  if (unlikely(query_cache.query_cache_size == 0 ||
-               query_cache.flush_in_progress))
+  if (unlikely(query_cache->query_cache_size == 0 ||
+               query_cache->flush_in_progress))
   {
-    STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+    STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
     DBUG_VOID_RETURN;
   }
 
@@ -687,15 +717,15 @@ void query_cache_abort(NET *net)
                                    net->query_cache_query);
   if (query_block)			// Test if changed by other thread
   {
-    DUMP(&query_cache);
+    DUMP(query_cache);
     BLOCK_LOCK_WR(query_block);
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
+    query_cache->free_query(query_block);
     net->query_cache_query= 0;
-    DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+    DBUG_EXECUTE("check_querycache",query_cache->check_integrity(1););
   }
 
-  STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+  STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
 
   DBUG_VOID_RETURN;
 }
@@ -703,6 +733,7 @@ void query_cache_abort(NET *net)
 
 void query_cache_end_of_result(THD *thd)
 {
+  Query_cache *query_cache;
   Query_cache_block *query_block;
   DBUG_ENTER("query_cache_end_of_result");
 
@@ -721,16 +752,17 @@ void query_cache_end_of_result(THD *thd)
                      emb_count_querycache_size(thd));
 #endif
 
-  STRUCT_LOCK(&query_cache.structure_guard_mutex);
+  query_cache= thd->query_cache_partition;
+  STRUCT_LOCK(&query_cache->structure_guard_mutex);
 
-  if (unlikely(query_cache.query_cache_size == 0 ||
-               query_cache.flush_in_progress))
+  if (unlikely(query_cache->query_cache_size == 0 ||
+               query_cache->flush_in_progress))
     goto end;
 
   query_block= ((Query_cache_block*) thd->net.query_cache_query);
   if (query_block)
   {
-    DUMP(&query_cache);
+    DUMP(query_cache);
     BLOCK_LOCK_WR(query_block);
     Query_cache_query *header= query_block->query();
     Query_cache_block *last_result_block;
@@ -747,34 +779,33 @@ void query_cache_end_of_result(THD *thd)
         and removed from QC.
       */
       DBUG_ASSERT(0);
-      query_cache.free_query(query_block);
+      query_cache->free_query(query_block);
       goto end;
     }
 
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= max(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= max(query_cache->min_allocation_unit, allign_size);
+    if (last_result_block->length >= query_cache->min_allocation_unit + len)
+      query_cache->split_block(last_result_block,len);
 
     header->found_rows(current_thd->limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
     header->writer(0);
     thd->net.query_cache_query= 0;
     BLOCK_UNLOCK_WR(query_block);
-    DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+    DBUG_EXECUTE("check_querycache",query_cache->check_integrity(1););
 
   }
 
 end:
-  STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+  STRUCT_UNLOCK(&query_cache->structure_guard_mutex);
   DBUG_VOID_RETURN;
 }
 
 void query_cache_invalidate_by_MyISAM_filename(const char *filename)
 {
   query_cache.invalidate_by_MyISAM_filename(filename);
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(0););
 }
 
 
@@ -790,7 +821,7 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0),
+   total_blocks(0), lowmem_prunes(0), garbage_blocks(0), garbage_queries(0),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -815,9 +846,9 @@ ulong Query_cache::resize(ulong query_cache_size_arg)
   STRUCT_LOCK(&structure_guard_mutex);
   free_cache();
   query_cache_size= query_cache_size_arg;
-  ::query_cache_size= init_cache();
+  query_cache_size_arg= init_cache();
   STRUCT_UNLOCK(&structure_guard_mutex);
-  DBUG_RETURN(::query_cache_size);
+  DBUG_RETURN(query_cache_size_arg);
 }
 
 
@@ -976,6 +1007,7 @@ def_week_frmt: %lu",
 	inserts++;
 	queries_in_cache++;
 	net->query_cache_query= (gptr) query_block;
+	thd->query_cache_partition= this;
 	header->writer(net);
 	header->tables_type(tables_type);
 
@@ -1558,7 +1590,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   STRUCT_UNLOCK(&structure_guard_mutex);
   DBUG_VOID_RETURN;
 }
@@ -1577,6 +1609,37 @@ void Query_cache::pack(ulong join_limit, uint iteration_limit)
 }
 
 
+/*
+  reclaim() - free the memory of invalidated queries.
+
+  SYNOPSIS
+    reclaim()
+      limit           Free at most this many queries at once (0 - all)
+
+  DESCRIPTION
+    The garbage queries are freed 'limit' queries at a time, and
+    'structure_guard_mutex' is released in between so that lookups
+    of other queries are not held up.  Queries that are still read
+    by other threads are left for the next reclaim().
+*/
+
+void Query_cache::reclaim(uint limit)
+{
+  DBUG_ENTER("Query_cache::reclaim");
+  STRUCT_LOCK(&structure_guard_mutex);
+  while (query_cache_size > 0 && !flush_in_progress)
+  {
+    if (free_garbage(limit) < limit || !limit)
+      break;
+    /* Let the waiting threads in before the next portion */
+    STRUCT_UNLOCK(&structure_guard_mutex);
+    STRUCT_LOCK(&structure_guard_mutex);
+  }
+  STRUCT_UNLOCK(&structure_guard_mutex);
+  DBUG_VOID_RETURN;
+}
+
+
 void Query_cache::destroy()
 {
   DBUG_ENTER("Query_cache::destroy");
@@ -1800,6 +1863,8 @@ void Query_cache::make_disabled()
   mem_bin_num= mem_bin_steps= 0;
   queries_in_cache= 0;
   first_block= 0;
+  garbage_blocks= 0;
+  garbage_queries= 0;
   DBUG_VOID_RETURN;
 }
 
@@ -1906,6 +1971,14 @@ void Query_cache::flush_cache()
     BLOCK_LOCK_WR(queries_blocks);
     free_query_internal(queries_blocks);
   }
+  while (garbage_blocks != 0)
+  {
+    Query_cache_block *query_block= garbage_blocks;
+    BLOCK_LOCK_WR(query_block);
+    double_linked_list_exclude(query_block, &garbage_blocks);
+    garbage_queries--;
+    free_query_memory(query_block);
+  }
 
   STRUCT_LOCK(&structure_guard_mutex);
   flush_in_progress= FALSE;
@@ -1920,6 +1993,9 @@ void Query_cache::flush_cache()
 my_bool Query_cache::free_old_query()
 {
   DBUG_ENTER("Query_cache::free_old_query");
+  /* Invalidated queries go first */
+  if (garbage_blocks && free_garbage(0))
+    DBUG_RETURN(0);
   if (queries_blocks)
   {
     /*
@@ -1996,6 +2072,31 @@ void Query_cache::free_query_internal(Query_cache_block *query_block)
 
   for (TABLE_COUNTER_TYPE i= 0; i < query_block->n_tables; i++)
     unlink_table(table++);
+  free_query_memory(query_block);
+
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  free_query_memory() - free memory of a query.
+
+  SYNOPSIS
+    free_query_memory()
+      query_block           Query_cache_block representing the query
+
+  DESCRIPTION
+    Places the result blocks and the query block to the list of free
+    blocks.  The query must already be unlinked from the hashes and
+    lists and 'query_block' must be locked for writing; this function
+    will release (and destroy) this lock.
+*/
+
+void Query_cache::free_query_memory(Query_cache_block *query_block)
+{
+  Query_cache_query *query= query_block->query();
+  DBUG_ENTER("Query_cache::free_query_memory");
+
   Query_cache_block *result_block= query->result();
 
   /*
@@ -2057,6 +2158,90 @@ void Query_cache::free_query(Query_cache_block *query_block)
   DBUG_VOID_RETURN;
 }
 
+
+/*
+  invalidate_query() - remove an invalidated query from the cache.
+
+  SYNOPSIS
+    invalidate_query()
+      query_block           Query_cache_block representing the query
+
+  DESCRIPTION
+    Unlinks the query like free_query() does, but neither locks
+    'query_block' nor frees its memory; the query is put on the
+    garbage list instead and freed by free_garbage() when no thread
+    reads it.  A thread that still writes the result is told to stop
+    caching it.
+*/
+
+void Query_cache::invalidate_query(Query_cache_block *query_block)
+{
+  Query_cache_query *query= query_block->query();
+  DBUG_ENTER("Query_cache::invalidate_query");
+  DBUG_PRINT("qcache", ("invalidate query 0x%lx", (ulong) query_block));
+
+  hash_delete(&queries, (byte *) query_block);
+  queries_in_cache--;
+  if (query->writer() != 0)
+  {
+    query->writer()->query_cache_query= 0;
+    query->writer(0);
+  }
+  double_linked_list_exclude(query_block, &queries_blocks);
+  Query_cache_block_table *table= query_block->table(0);
+  for (TABLE_COUNTER_TYPE i= 0; i < query_block->n_tables; i++)
+    unlink_table(table++);
+  double_linked_list_simple_include(query_block, &garbage_blocks);
+  garbage_queries++;
+
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  free_garbage() - free invalidated queries.
+
+  SYNOPSIS
+    free_garbage()
+      limit           Stop after so many queries are freed (0 - no limit)
+
+  DESCRIPTION
+    Frees the garbage queries which are not locked by a reader.
+    Requires 'structure_guard_mutex' to be locked.
+
+  RETURN
+    number of freed queries
+*/
+
+uint Query_cache::free_garbage(uint limit)
+{
+  uint freed= 0;
+  Query_cache_block *block= garbage_blocks, *last;
+  DBUG_ENTER("Query_cache::free_garbage");
+
+  if (block == 0)
+    DBUG_RETURN(0);
+  last= block->prev;
+  for (;;)
+  {
+    Query_cache_block *next= block->next;
+    my_bool is_last= (block == last);
+    if (block->query()->try_lock_writing())
+    {
+      double_linked_list_exclude(block, &garbage_blocks);
+      garbage_queries--;
+      free_query_memory(block);
+      if (++freed == limit)
+        break;
+    }
+    if (is_last)
+      break;
+    block= next;
+  }
+  DBUG_PRINT("qcache", ("freed %u queries, %u left", freed, garbage_queries));
+  DBUG_RETURN(freed);
+}
+
 /*****************************************************************************
  Query data creation
 *****************************************************************************/
@@ -2376,11 +2561,7 @@ void Query_cache::invalidate_table(Query_cache_block *table_block)
 {
   Query_cache_block_table *list_root =	table_block->table(0);
   while (list_root->next != list_root)
-  {
-    Query_cache_block *query_block = list_root->next->block();
-    BLOCK_LOCK_WR(query_block);
-    free_query(query_block);
-  }
+    invalidate_query(list_root->next->block());
 }
 
 
@@ -2641,7 +2822,7 @@ Query_cache::allocate_block(ulong len, my_bool not_less, ulong min,
   {
     STRUCT_LOCK(&structure_guard_mutex);
 
-    if (unlikely(query_cache.query_cache_size == 0 || flush_in_progress))
+    if (unlikely(query_cache_size == 0 || flush_in_progress))
     {
       STRUCT_UNLOCK(&structure_guard_mutex);
       DBUG_RETURN(0);
@@ -3220,7 +3401,18 @@ void Query_cache::pack_cache()
     DBUG_VOID_RETURN;
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  /*
+    Blocks of the invalidated queries can't be moved as they are not
+    in the hashes; don't pack while some of them are still read.
+  */
+  free_garbage(0);
+  if (garbage_blocks)
+  {
+    STRUCT_UNLOCK(&structure_guard_mutex);
+    DBUG_VOID_RETURN;
+  }
+
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   byte *border = 0;
   Query_cache_block *before = 0;
@@ -3252,7 +3444,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   STRUCT_UNLOCK(&structure_guard_mutex);
   DBUG_VOID_RETURN;
 }
@@ -3618,6 +3810,237 @@ uint Query_cache::filename_2_table_key (char *key, const char *path,
 			     filename) -key) + 1);
 }
 
+/*****************************************************************************
+  Partitioned_query_cache methods
+*****************************************************************************/
+
+void Partitioned_query_cache::init(uint partitions_arg)
+{
+  DBUG_ENTER("Partitioned_query_cache::init");
+  partitions= partitions_arg;
+  for (uint i= 0; i < partitions; i++)
+    partition[i].init();
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Find the partition of a statement
+
+  NOTE
+    send_result_to_client() and store_query() of the same statement
+    must get the same partition, so only the statement text is hashed.
+*/
+
+inline Query_cache *
+Partitioned_query_cache::partition_for(const char *query, uint query_length)
+{
+  ulong nr1= 1, nr2= 4;
+  if (partitions == 1)
+    return partition;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar*) query,
+                                 query_length, &nr1, &nr2);
+  return partition + nr1 % partitions;
+}
+
+
+/*
+  Free the memory of the queries invalidated by the last invalidation.
+
+  Small amounts are freed at once by the current thread, bigger ones
+  are passed to the manager thread if it runs.
+*/
+
+void Partitioned_query_cache::collect_garbage()
+{
+  bool wake_manager= FALSE;
+  for (uint i= 0; i < partitions; i++)
+  {
+    /* Testing without a lock: the worst is a reclaim which finds nothing */
+    uint garbage= partition[i].garbage();
+    if (!garbage)
+      continue;
+    if (garbage > QUERY_CACHE_RECLAIM_BATCH && manager_thread_in_use)
+      wake_manager= TRUE;
+    else
+      partition[i].reclaim(QUERY_CACHE_RECLAIM_BATCH);
+  }
+  if (wake_manager)
+  {
+    pthread_mutex_lock(&LOCK_manager);
+    manager_status|= MANAGER_QUERY_CACHE_RECLAIM;
+    pthread_mutex_unlock(&LOCK_manager);
+    pthread_cond_signal(&COND_manager);
+  }
+}
+
+
+/*
+  Resize the query cache; every partition gets an equal part of the
+  memory.
+*/
+
+ulong Partitioned_query_cache::resize(ulong query_cache_size_arg)
+{
+  ulong new_size= 0;
+  for (uint i= 0; i < partitions; i++)
+    new_size+= partition[i].resize(query_cache_size_arg / partitions);
+  return (::query_cache_size= new_size);
+}
+
+
+void Partitioned_query_cache::result_size_limit(ulong limit)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].result_size_limit(limit);
+}
+
+
+ulong Partitioned_query_cache::set_min_res_unit(ulong size)
+{
+  ulong res= size;
+  for (uint i= 0; i < partitions; i++)
+    res= partition[i].set_min_res_unit(size);
+  return res;
+}
+
+
+void Partitioned_query_cache::store_query(THD *thd, TABLE_LIST *used_tables)
+{
+  partition_for(thd->query, thd->query_length)->store_query(thd,
+                                                            used_tables);
+}
+
+
+int Partitioned_query_cache::send_result_to_client(THD *thd, char *query,
+                                                   uint query_length)
+{
+  return partition_for(query, query_length)->send_result_to_client(thd, query,
+                                                                   query_length);
+}
+
+
+void Partitioned_query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                         my_bool using_transactions)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate(thd, tables_used, using_transactions);
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::invalidate(CHANGED_TABLE_LIST *tables_used)
+{
+  if (!tables_used)
+    return;
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate(tables_used);
+  collect_garbage();
+}
+
+
+void
+Partitioned_query_cache::invalidate_locked_for_write(TABLE_LIST *tables_used)
+{
+  if (!tables_used)
+    return;
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate_locked_for_write(tables_used);
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::invalidate(THD *thd, TABLE *table,
+                                         my_bool using_transactions)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate(thd, table, using_transactions);
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::invalidate(THD *thd, const char *key,
+                                         uint32 key_length,
+                                         my_bool using_transactions)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate(thd, key, key_length, using_transactions);
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::invalidate(char *db)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].invalidate(db);
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::invalidate_by_MyISAM_filename(const char *filename)
+{
+  for (uint i= 0; i < partitions; i++)
+  {
+    partition[i].invalidate_by_MyISAM_filename(filename);
+    DBUG_EXECUTE("check_querycache",partition[i].check_integrity(0););
+  }
+  collect_garbage();
+}
+
+
+void Partitioned_query_cache::flush()
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].flush();
+}
+
+
+void Partitioned_query_cache::pack()
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].pack();
+}
+
+
+/* Called by the manager thread (MANAGER_QUERY_CACHE_RECLAIM) */
+
+void Partitioned_query_cache::reclaim()
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].reclaim(QUERY_CACHE_RECLAIM_BATCH);
+}
+
+
+void Partitioned_query_cache::destroy()
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].destroy();
+}
+
+
+/*
+  The Qcache_% status variables point to the counters of the first
+  partition; return the sum of that counter over all partitions.
+*/
+
+ulong Partitioned_query_cache::status_sum(char *var)
+{
+  size_t offset= var - (char*) partition;
+  ulong sum= 0;
+  for (uint i= 0; i < partitions; i++)
+    sum+= *(ulong*) ((char*) (partition + i) + offset);
+  return sum;
+}
+
+
+void Partitioned_query_cache::status_reset(char *var)
+{
+  size_t offset= var - (char*) partition;
+  for (uint i= 0; i < partitions; i++)
+    *(ulong*) ((char*) (partition + i) + offset)= 0;
+}
+
+
 /****************************************************************************
   Functions to be used when debugging
 ****************************************************************************/
@@ -3633,6 +4056,7 @@ my_bool check_integrity(bool not_locked) { return 0; }
 my_bool in_list(Query_cache_block * root, Query_cache_block * point,
 		const char *name) { return 0;}
 my_bool in_blocks(Query_cache_block * point) { return 0; }
+my_bool in_garbage(Query_cache_block * point) { return 0; }
 
 #else
 
@@ -3666,6 +4090,15 @@ void Query_cache::wreck(uint line, const char *message)
 }
 
 
+/* A block does not know its partition, so all of them are switched off */
+
+void Partitioned_query_cache::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < partitions; i++)
+    partition[i].wreck(line, message);
+}
+
+
 void Query_cache::bins_dump()
 {
   uint i;
@@ -3840,7 +4273,7 @@ my_bool Query_cache::check_integrity(bool locked)
   if (unlikely(query_cache_size == 0 || flush_in_progress))
   {
     if (!locked)
-      STRUCT_UNLOCK(&query_cache.structure_guard_mutex);
+      STRUCT_UNLOCK(&structure_guard_mutex);
 
     DBUG_PRINT("qcache", ("Query Cache not initialized"));
     DBUG_RETURN(0);
@@ -3935,6 +4368,9 @@ my_bool Query_cache::check_integrity(bool locked)
       break;
     case Query_cache_block::QUERY:
     {
+      // Invalidated queries are only in the garbage list
+      if (in_garbage(block))
+        break;
       if (in_list(queries_blocks, block, "query"))
 	result = 1;
       for (TABLE_COUNTER_TYPE j=0; j < block->n_tables; j++)
@@ -3972,7 +4408,8 @@ my_bool Query_cache::check_integrity(bool locked)
       else
       {
 	BLOCK_LOCK_RD(query_block);
-	if (in_list(queries_blocks, query_block, "query from results"))
+	if (!in_garbage(query_block) &&
+            in_list(queries_blocks, query_block, "query from results"))
 	  result = 1;
 	if (in_list(query_block->query()->result(), block,
 		    "results"))
@@ -4206,6 +4643,24 @@ err2:
   return result;
 }
 
+
+/* Test if the query block is in the list of invalidated queries */
+
+my_bool Query_cache::in_garbage(Query_cache_block * point)
+{
+  Query_cache_block *block= garbage_blocks;
+  if (block)
+  {
+    do
+    {
+      if (block == point)
+        return 1;
+      block= block->next;
+    } while (block != garbage_blocks);
+  }
+  return 0;
+}
+
 void dump_node(Query_cache_block_table * node, 
 	       const char * call, const char * descr)
 {
@@ -56,6 +56,15 @@
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* maximal number of query cache partitions (query_cache_partitions) */
+#define QUERY_CACHE_MAX_PARTITIONS		64
+
+/*
+  how many invalidated queries are freed at once under structure_guard_mutex;
+  if an invalidation leaves more, they are freed by the manager thread
+*/
+#define QUERY_CACHE_RECLAIM_BATCH		64
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -244,6 +253,7 @@ private:
   bool flush_in_progress;
 
   void free_query_internal(Query_cache_block *point);
+  void free_query_memory(Query_cache_block *point);
 
 protected:
   /*
@@ -265,6 +275,12 @@ protected:
   Query_cache_block *first_block;		// physical location block list
   Query_cache_block *queries_blocks;		// query list (LIFO)
   Query_cache_block *tables_blocks;
+  /*
+    Invalidated queries which are already removed from the hashes and
+    the query and table lists, but whose memory is not freed yet.
+  */
+  Query_cache_block *garbage_blocks;
+  uint garbage_queries;
 
   Query_cache_memory_bin *bins;			// free block lists
   Query_cache_memory_bin_step *steps;		// bins spacing info
@@ -293,6 +309,8 @@ protected:
   void flush_cache();
   my_bool free_old_query();
   void free_query(Query_cache_block *point);
+  void invalidate_query(Query_cache_block *point);
+  uint free_garbage(uint limit);
   my_bool allocate_data_chain(Query_cache_block **result_block,
 			      ulong data_len,
 			      Query_cache_block *query_block,
@@ -421,6 +439,10 @@ protected:
   void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
 	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
 
+  /* Free the memory of invalidated queries */
+  void reclaim(uint limit);
+  inline uint garbage() { return garbage_queries; }
+
   void destroy();
 
   friend void query_cache_init_query(NET *net);
@@ -445,9 +467,62 @@ protected:
 			Query_cache_block_table * point,
 			const char *name);
   my_bool in_blocks(Query_cache_block * point);
+  my_bool in_garbage(Query_cache_block * point);
+};
+
+
+/*
+  The query cache is divided into query_cache_partitions independent
+  Query_cache objects, each with its own memory, hashes and
+  structure_guard_mutex.  A statement is stored in and looked up from
+  the partition chosen by the hash of its text, so lookups of different
+  statements do not contend for one mutex.  Invalidation has to visit
+  every partition, but it only unlinks the queries and leaves freeing
+  their memory to free_garbage().
+*/
+
+class Partitioned_query_cache
+{
+  uint partitions;
+
+  inline Query_cache *partition_for(const char *query, uint query_length);
+  void collect_garbage();
+public:
+  Query_cache partition[QUERY_CACHE_MAX_PARTITIONS];
+
+  Partitioned_query_cache() :partitions(1) {}
+
+  void init(uint partitions_arg);
+  ulong resize(ulong query_cache_size);
+  void result_size_limit(ulong limit);
+  ulong set_min_res_unit(ulong size);
+
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  void invalidate(THD* thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(TABLE_LIST *tables_used);
+  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+  void invalidate(char *db);
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack();
+  void reclaim();
+  void destroy();
+
+  /* Sum and reset of the Qcache_% status variables over all partitions */
+  ulong status_sum(char *var);
+  void status_reset(char *var);
+
+  void wreck(uint line, const char *message);
 };
 
-extern Query_cache query_cache;
+extern Partitioned_query_cache query_cache;
 extern TYPELIB query_cache_type_typelib;
 void query_cache_init_query(NET *net);
 void query_cache_insert(NET *net, const char *packet, ulong length);
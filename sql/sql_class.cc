@@ -36,6 +36,7 @@
 
 #include "sp_rcontext.h"
 #include "sp_cache.h"
+#include "scheduler.h"
 
 /*
   The following is used to initialise Table_ident with a internal
@@ -231,8 +232,10 @@ THD::THD()
   net.last_error[0]=0;                          // If error on boot
 #ifdef HAVE_QUERY_CACHE
   query_cache_init_query(&net);                 // If error on boot
+  query_cache_partition= 0;
 #endif
   ull=0;
+  scheduler= 0;
   system_thread= cleanup_done= abort_on_warning= no_warnings_for_error= 0;
   peer_port= 0;					// For SHOW PROCESSLIST
 #ifdef	__WIN__
@@ -242,6 +245,9 @@ THD::THD()
   active_vio = 0;
 #endif
   pthread_mutex_init(&LOCK_delete, MY_MUTEX_INIT_FAST);
+  pthread_mutex_init(&LOCK_private_tables, MY_MUTEX_INIT_FAST);
+  private_tables= 0;
+  private_tables_count= 0;
 
   /* Variables with default values */
   proc_info="login";
@@ -425,6 +431,7 @@ void THD::cleanup(void)
   mysql_ha_flush(this, (TABLE_LIST*) 0,
                  MYSQL_HA_CLOSE_FINAL | MYSQL_HA_FLUSH_ALL, FALSE);
   hash_free(&handler_tables_hash);
+  close_private_tables(this);
   delete_dynamic(&user_var_events);
   hash_free(&user_vars);
   close_temporary_tables(this);
@@ -483,6 +490,7 @@ THD::~THD()
 #endif
   mysys_var=0;					// Safety (shouldn't be needed)
   pthread_mutex_destroy(&LOCK_delete);
+  pthread_mutex_destroy(&LOCK_private_tables);
 #ifndef DBUG_OFF
   dbug_sentry= THD_SENTRY_GONE;
 #endif  
@@ -562,6 +570,11 @@ void THD::awake(THD::killed_state state_to_set)
     }
     pthread_mutex_unlock(&mysys_var->mutex);
   }
+#ifndef EMBEDDED_LIBRARY
+  /* Wake up the connection if it's idle in the pool of threads */
+  if (state_to_set != THD::KILL_QUERY)
+    thread_scheduler.post_kill_notification(this);
+#endif
 }
 
 /*
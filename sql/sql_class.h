@@ -29,6 +29,7 @@ class Format_description_log_event;
 class sp_rcontext;
 class sp_cache;
 class Lex_input_stream;
+class Query_cache;
 
 enum enum_enable_or_disable { LEAVE_AS_IS, ENABLE, DISABLE };
 enum enum_ha_read_modes { RFIRST, RNEXT, RPREV, RLAST, RKEY, RNEXT_SAME };
@@ -200,6 +201,18 @@ class MYSQL_LOG: public TC_LOG
   pthread_mutex_t LOCK_log, LOCK_index;
   pthread_mutex_t LOCK_prep_xids;
   pthread_cond_t  COND_prep_xids;
+  /*
+    Binlog group commit (for tc log only). LOCK_commit_ordered protects
+    the tickets below: last_commit_ticket is the ticket of the last Xid
+    event written, commit_turn is the ticket which may commit in the
+    engines now and synced_commit_ticket is the last ticket known to be
+    on disk. A thread which finds nobody syncing becomes the leader and
+    syncs the binlog for everybody queued behind it.
+  */
+  pthread_mutex_t LOCK_commit_ordered;
+  pthread_cond_t  COND_commit_ordered, COND_binlog_synced;
+  ulong last_commit_ticket, commit_turn, synced_commit_ticket;
+  bool binlog_syncing;
   pthread_cond_t update_cond;
   ulonglong bytes_written;
   time_t last_time,query_start;
@@ -317,6 +330,9 @@ public:
 	     time_t query_start=0);
   bool write(Log_event* event_info); // binary log write
   bool write(THD *thd, IO_CACHE *cache, Log_event *commit_event);
+  bool sync_commit_group(File fd, ulong ticket);
+  void enter_commit_order(ulong ticket);
+  void exit_commit_order(ulong ticket);
 
   void start_union_events(THD *thd, query_id_t query_id_param);
   void stop_union_events(THD *thd);
@@ -545,6 +561,7 @@ struct system_variables
   ulong read_rnd_buff_size;
   ulong div_precincrement;
   ulong sortbuff_size;
+  ulong sort_threads;
   ulong table_type;
   ulong tx_isolation;
   ulong completion_type;
@@ -573,6 +590,13 @@ struct system_variables
   my_bool query_cache_wlock_invalidate;
   my_bool engine_condition_pushdown;
   my_bool keep_files_on_create;
+  my_bool optimizer_batched_key_access;
+  my_bool optimizer_derived_keys;
+  my_bool optimizer_derived_merge;
+  my_bool optimizer_hash_join;
+  my_bool optimizer_plan_cache;
+  my_bool optimizer_sort_intersect;
+  my_bool optimizer_subquery_materialization;
 
 #ifdef HAVE_INNOBASE_DB
   my_bool innodb_table_locks;
@@ -652,6 +676,7 @@ typedef struct system_status_var
   ulong select_range_count;
   ulong select_range_check_count;
   ulong select_scan_count;
+  ulong select_plan_reuse_count;
   ulong long_query_count;
   ulong filesort_merge_passes;
   ulong filesort_range_count;
@@ -1196,6 +1221,8 @@ public:
   struct st_mysql_stmt *current_stmt;
 #endif
   NET	  net;				// client connection descriptor
+  /* Query cache partition where net.query_cache_query is stored */
+  Query_cache *query_cache_partition;
   MEM_ROOT warn_root;			// For warnings and errors
   Protocol *protocol;			// Current protocol
   Protocol_simple protocol_simple;	// Normal protocol
@@ -1212,6 +1239,15 @@ public:
   THR_LOCK_OWNER *lock_id;              // If not main_lock_id, points to
                                         // the lock_id of a cursor.
   pthread_mutex_t LOCK_delete;		// Locked before thd is deleted
+  /*
+    Base tables released by this thread that it can reuse without
+    LOCK_open (linked through TABLE::next and TABLE::prev). They stay in
+    open_cache with in_use set to this thread. Other threads may take
+    them away while holding LOCK_open, see unlink_private_table().
+  */
+  pthread_mutex_t LOCK_private_tables;
+  TABLE *private_tables;
+  uint private_tables_count;
   /* all prepared statements and cursors of this connection */
   Statement_map stmt_map;
   /*
@@ -1293,6 +1329,14 @@ public:
        cache (instead of full list of changed in transaction tables).
     */
     CHANGED_TABLE_LIST* changed_tables;
+    /*
+      Binlog group commit: the ticket MYSQL_LOG::write() handed out with
+      the Xid event of this transaction (0 if none), and the binlog offset
+      where the events of the transaction ended. Engines use the ticket
+      to commit in the same order as the transactions were binlogged.
+    */
+    ulong commit_ticket;
+    my_off_t commit_binlog_pos;
     MEM_ROOT mem_root; // Transaction-life memory allocation pool
     void cleanup()
     {
@@ -1426,7 +1470,13 @@ public:
   */
   ulong      row_count;
   long	     dbug_thread_id;
+  /*
+    OS thread currently executing for this connection. 0 for an idle
+    connection of the pool-of-threads scheduler.
+  */
   pthread_t  real_id;
+  /* Per connection data of the pool-of-threads scheduler, see scheduler.cc */
+  void       *scheduler;
   uint	     tmp_table, global_read_lock;
   uint	     server_status,open_options,system_thread;
   uint       db_length;
@@ -2252,6 +2302,23 @@ public:
   bool send_data(List<Item> &items);
 };
 
+/* Materialized IN subselect interface class */
+class select_materialize_subselect :public select_subselect
+{
+  TMP_TABLE_PARAM tmp_table_param;
+public:
+  TABLE *table;
+  ha_rows records;                      /* rows received from the subquery */
+  bool has_null_row;                    /* received a row with a NULL */
+
+  select_materialize_subselect(Item_subselect *item_arg)
+    :select_subselect(item_arg), table(0), records(0), has_null_row(0)
+  {}
+  bool send_data(List<Item> &items);
+  bool create_result_table(THD *thd, List<Item> *column_types);
+  void cleanup();
+};
+
 /* Structs used when sorting */
 
 typedef struct st_sort_field {
@@ -2371,7 +2438,8 @@ public:
 
   bool get(TABLE *table);
   static double get_use_cost(uint *buffer, uint nkeys, uint key_size,
-                             ulonglong max_in_memory_size);
+                             ulonglong max_in_memory_size,
+                             double compare_factor);
   inline static int get_cost_calc_buff_size(ulong nkeys, uint key_size,
                                             ulonglong max_in_memory_size)
   {
@@ -73,6 +73,274 @@ out:
 }
 
 
+/*
+  Check if a join list contains a NATURAL/USING join
+
+  SYNOPSIS
+    has_natural_join()
+    join_list           list of table references of a FROM clause
+
+  RETURN
+    TRUE   there is a NATURAL/USING join on some nesting level
+    FALSE  otherwise
+*/
+
+static bool has_natural_join(List<TABLE_LIST> *join_list)
+{
+  List_iterator_fast<TABLE_LIST> it(*join_list);
+  TABLE_LIST *tbl;
+  while ((tbl= it++))
+  {
+    if (tbl->is_natural_join ||
+        tbl->nested_join && has_natural_join(&tbl->nested_join->join_list))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Check if a derived table can be merged into the outer query
+
+  SYNOPSIS
+    derived_can_be_merged()
+    thd			Thread handle
+    lex                 LEX for this thread
+    orig_table_list     TABLE_LIST of the derived table
+
+  DESCRIPTION
+    The same restrictions as for MERGE views apply (see
+    st_lex::can_be_merged()). In addition the SELECT must have no ORDER BY
+    and no RAND() or functions with side effects, whose results could change
+    if they were evaluated for every reference of the column. If the
+    derived table is on the inner side of an outer join all its columns
+    have to be columns of the underlying tables, because other expressions
+    are not NULL for the NULL complemented rows.
+
+  RETURN
+    TRUE   merge the derived table
+    FALSE  materialize it
+*/
+
+static bool derived_can_be_merged(THD *thd, LEX *lex,
+                                  TABLE_LIST *orig_table_list)
+{
+  SELECT_LEX_UNIT *unit= orig_table_list->derived;
+  SELECT_LEX *first_select= unit->first_select();
+
+  if (!thd->variables.optimizer_derived_merge ||
+      lex->sql_command != SQLCOM_SELECT ||
+      orig_table_list->view ||
+      !first_select->first_execution ||
+      unit->is_union() ||
+      first_select->table_list.elements == 0 ||
+      first_select->group_list.elements ||
+      first_select->order_list.elements ||
+      first_select->having ||
+      first_select->with_sum_func ||
+      (first_select->options & SELECT_DISTINCT) ||
+      first_select->select_limit ||
+      (first_select->uncacheable & (UNCACHEABLE_RAND |
+                                    UNCACHEABLE_SIDEEFFECT)))
+    return FALSE;
+
+  /* Subqueries are allowed in WHERE and ON only, as for views */
+  for (SELECT_LEX_UNIT *inner= first_select->first_inner_unit();
+       inner;
+       inner= inner->next_unit())
+  {
+    if (inner->first_select()->linkage == DERIVED_TABLE_TYPE)
+      continue;
+    if (inner->item == 0 ||
+        (inner->item->place() != IN_WHERE && inner->item->place() != IN_ON))
+      return FALSE;
+  }
+
+  /* '*' is expanded by expand_derived_wild() which does not coalesce columns */
+  if (first_select->with_wild &&
+      has_natural_join(&first_select->top_join_list))
+    return FALSE;
+
+  for (TABLE_LIST *tbl= orig_table_list; tbl; tbl= tbl->embedding)
+  {
+    if (tbl->outer_join)
+    {
+      List_iterator_fast<Item> it(first_select->item_list);
+      Item *item;
+      while ((item= it++))
+      {
+        if (item->type() != Item::FIELD_ITEM)
+          return FALSE;
+      }
+      break;
+    }
+  }
+  return TRUE;
+}
+
+
+/*
+  Expand '*' in the select list of a derived table that is merged
+
+  SYNOPSIS
+    expand_derived_wild()
+    thd			Thread handle
+    select              SELECT of the derived table
+
+  DESCRIPTION
+    Unlike setup_wild() this creates column references that are not fixed
+    yet, so that they are resolved (and the used columns marked) when the
+    outer query is prepared, as for the definition of a view.
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+static bool expand_derived_wild(THD *thd, SELECT_LEX *select)
+{
+  List_iterator<Item> it(select->item_list);
+  Item *item;
+
+  while ((item= it++))
+  {
+    Item_field *wild= (Item_field*) item;
+    bool found= FALSE;
+
+    if (item->type() != Item::FIELD_ITEM || wild->field_name[0] != '*')
+      continue;
+    for (TABLE_LIST *tbl= (TABLE_LIST*) select->table_list.first;
+         tbl;
+         tbl= tbl->next_local)
+    {
+      Field_iterator_table_ref field_it;
+      if (wild->table_name &&
+          my_strcasecmp(table_alias_charset, wild->table_name, tbl->alias))
+        continue;
+      if (tbl->merge_underlying_list && tbl->setup_underlying(thd))
+        return TRUE;
+      for (field_it.set(tbl); !field_it.end_of_fields(); field_it.next())
+      {
+        Item_field *field;
+        if (!(field= new Item_field(&select->context, NullS,
+                                    thd->strdup(tbl->alias),
+                                    thd->strdup(field_it.name()))))
+          return TRUE;
+        if (!found)
+        {
+          found= TRUE;
+          it.replace(field);
+        }
+        else
+          it.after(field);
+      }
+    }
+    if (!found)
+    {
+      if (wild->table_name)
+        my_error(ER_BAD_TABLE_ERROR, MYF(0), wild->table_name);
+      else
+        my_message(ER_NO_TABLES_USED, ER(ER_NO_TABLES_USED), MYF(0));
+      return TRUE;
+    }
+  }
+  select->with_wild= 0;
+  return FALSE;
+}
+
+
+/*
+  Merge a derived table into the outer query
+
+  SYNOPSIS
+    mysql_derived_merge()
+    thd			Thread handle
+    orig_table_list     TABLE_LIST of the derived table
+
+  DESCRIPTION
+    The derived table becomes a placeholder like a view with
+    ALGORITHM=MERGE (see mysql_make_view()): its tables are nested in
+    the join of the outer SELECT, its WHERE clause is added to the WHERE
+    or ON clause of the outer SELECT by TABLE_LIST::prep_where() and its
+    columns are translated to the select list items by
+    TABLE_LIST::setup_underlying(). Subqueries of the derived table are
+    moved to the outer SELECT.
+
+    The transformation is done once for prepared statements and stored
+    procedures. On re-execution mysql_derived_prepare() only calls
+    TABLE_LIST::set_underlying_merge().
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+static bool mysql_derived_merge(THD *thd, TABLE_LIST *orig_table_list)
+{
+  SELECT_LEX_UNIT *unit= orig_table_list->derived;
+  SELECT_LEX *first_select= unit->first_select();
+  SELECT_LEX *outer_select= orig_table_list->select_lex;
+  TABLE_LIST *tables= (TABLE_LIST*) first_select->table_list.first;
+  TABLE_LIST *tbl;
+  NESTED_JOIN *nested_join;
+  Query_arena *arena, backup;
+  bool res= TRUE;
+  DBUG_ENTER("mysql_derived_merge");
+
+  arena= thd->activate_stmt_arena_if_needed(&backup);
+
+  if (first_select->with_wild && expand_derived_wild(thd, first_select) ||
+      check_duplicate_names(first_select->item_list, 0))
+    goto err;
+
+  orig_table_list->effective_algorithm= VIEW_ALGORITHM_MERGE;
+  orig_table_list->merge_underlying_list= tables;
+  orig_table_list->multitable_view= (tables->next_local != 0);
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+  orig_table_list->grant.privilege= SELECT_ACL;
+#endif
+
+  /* make nested join structure for the tables of the derived table */
+  if (!(nested_join= orig_table_list->nested_join=
+        (NESTED_JOIN *) thd->calloc(sizeof(NESTED_JOIN))))
+    goto err;
+  nested_join->join_list= first_select->top_join_list;
+  {
+    List_iterator_fast<TABLE_LIST> ti(nested_join->join_list);
+    while ((tbl= ti++))
+    {
+      tbl->join_list= &nested_join->join_list;
+      tbl->embedding= orig_table_list;
+    }
+  }
+
+  /* Store WHERE clause for post-processing in setup_underlying */
+  orig_table_list->where= first_select->where;
+
+  /* resolve the columns of the derived table in its own tables */
+  first_select->context.resolve_in_table_list_only(tables);
+  first_select->context.select_lex= outer_select;
+  outer_select->select_n_having_items+= first_select->select_n_having_items;
+  outer_select->select_n_where_fields+= first_select->select_n_where_fields;
+  for (tbl= tables; tbl; tbl= tbl->next_local)
+    tbl->select_lex= outer_select;
+
+  /*
+    Remove the derived table from the tree of SELECTs and move its
+    subqueries to the outer SELECT.
+  */
+  unit->exclude_level(FALSE);
+
+  orig_table_list->set_underlying_merge();
+  res= FALSE;
+
+err:
+  if (arena)
+    thd->restore_active_arena(arena, &backup);
+  DBUG_RETURN(res);
+}
+
+
 /*
   Create temporary table structure (but do not fill it)
 
@@ -83,7 +351,8 @@ out:
     orig_table_list     TABLE_LIST for the upper SELECT
 
   IMPLEMENTATION
-    Derived table is resolved with temporary table.
+    Derived table is resolved with temporary table, or merged into the
+    outer query with optimizer_derived_merge (see mysql_derived_merge()).
 
     After table creation, the above TABLE_LIST is updated with a new table.
 
@@ -104,7 +373,7 @@ bool mysql_derived_prepare(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
   ulonglong create_options;
   DBUG_ENTER("mysql_derived_prepare");
   bool res= FALSE;
-  if (unit)
+  if (unit && !orig_table_list->merge_underlying_list)
   {
     SELECT_LEX *first_select= unit->first_select();
     TABLE *table= 0;
@@ -114,6 +383,9 @@ bool mysql_derived_prepare(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
     for (SELECT_LEX *sl= first_select; sl; sl= sl->next_select())
       sl->context.outer_context= 0;
 
+    if (derived_can_be_merged(thd, lex, orig_table_list))
+      DBUG_RETURN(mysql_derived_merge(thd, orig_table_list));
+
     if (!(derived_result= new select_union))
       DBUG_RETURN(TRUE); // out of memory
 
@@ -201,6 +473,35 @@ exit:
 }
 
 
+/*
+  Estimate the number of rows of an optimized derived table SELECT
+
+  SYNOPSIS
+    derived_rows_estimate()
+    join                optimized JOIN of the derived table
+    unit                unit of the derived table
+
+  RETURN
+    expected number of rows (the product of the rows read from each
+    non-constant table, limited by LIMIT)
+*/
+
+static ha_rows derived_rows_estimate(JOIN *join, SELECT_LEX_UNIT *unit)
+{
+  double rows= 1.0;
+
+  if (join->zero_result_cause)
+    return 0;
+  if (!join->group_list && join->tmp_table_param.sum_func_count)
+    return 1;                                   // Aggregate without GROUP BY
+  for (uint i= join->const_tables; i < join->tables; i++)
+    rows*= join->best_positions[i].records_read;
+  if (rows > (double) unit->select_limit_cnt)
+    return unit->select_limit_cnt;
+  return (ha_rows) rows;
+}
+
+
 /*
   fill derived table
 
@@ -219,6 +520,14 @@ exit:
     If you use this function, make sure it's not called at prepare.
     Due to evaluation of LIMIT clause it can not be used at prepared stage.
 
+    With optimizer_derived_keys a derived table of a SELECT statement that
+    is not a UNION is only optimized here. Unless it is expected to return
+    at most one row (in which case it is still filled at once, so that the
+    outer query can read it as a constant table) it is marked as pending
+    and filled by mysql_derived_materialize() when the outer join reads
+    its first row. EXPLAIN and a join that never reaches the derived table
+    do not execute the underlying SELECT at all.
+
   RETURN
     FALSE  OK
     TRUE   Error
@@ -231,7 +540,7 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
   bool res= FALSE;
 
   /*check that table creation pass without problem and it is derived table */
-  if (table && unit)
+  if (table && unit && !orig_table_list->merge_underlying_list)
   {
     SELECT_LEX *first_select= unit->first_select();
     select_union *derived_result= orig_table_list->derived_result;
@@ -250,18 +559,39 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
 	first_select->options&= ~OPTION_FOUND_ROWS;
 
       lex->current_select= first_select;
-      res= mysql_select(thd, &first_select->ref_pointer_array,
-			(TABLE_LIST*) first_select->table_list.first,
-			first_select->with_wild,
-			first_select->item_list, first_select->where,
-			(first_select->order_list.elements+
-			 first_select->group_list.elements),
-			(ORDER *) first_select->order_list.first,
-			(ORDER *) first_select->group_list.first,
-			first_select->having, (ORDER*) NULL,
-			(first_select->options | thd->options |
-			 SELECT_NO_UNLOCK),
-			derived_result, unit, first_select);
+      if (thd->variables.optimizer_derived_keys &&
+          lex->sql_command == SQLCOM_SELECT && !thd->in_sub_stmt &&
+          first_select->join)
+      {
+        JOIN *join= first_select->join;
+        join->select_options= (first_select->options | thd->options |
+                               SELECT_NO_UNLOCK);
+        if (!(res= join->optimize()) && !(res= thd->net.report_error))
+        {
+          table->derived_rows= derived_rows_estimate(join, unit);
+          if (table->derived_rows > 1)
+          {
+            table->derived_pending= TRUE;
+            lex->current_select= save_current_select;
+            return FALSE;
+          }
+          join->exec();
+          res= join->error;
+        }
+      }
+      else
+	res= mysql_select(thd, &first_select->ref_pointer_array,
+			  (TABLE_LIST*) first_select->table_list.first,
+			  first_select->with_wild,
+			  first_select->item_list, first_select->where,
+			  (first_select->order_list.elements+
+			   first_select->group_list.elements),
+			  (ORDER *) first_select->order_list.first,
+			  (ORDER *) first_select->group_list.first,
+			  first_select->having, (ORDER*) NULL,
+			  (first_select->options | thd->options |
+			   SELECT_NO_UNLOCK),
+			  derived_result, unit, first_select);
     }
 
     if (!res)
@@ -282,3 +612,45 @@ bool mysql_derived_filling(THD *thd, LEX *lex, TABLE_LIST *orig_table_list)
   }
   return res;
 }
+
+
+/*
+  Fill a derived table that mysql_derived_filling() left pending
+
+  SYNOPSIS
+    mysql_derived_materialize()
+    thd			Thread handle
+    orig_table_list     TABLE_LIST of the derived table
+
+  NOTES
+    Called before the first row of a table with TABLE::derived_pending set
+    is read. The underlying SELECT was already optimized by
+    mysql_derived_filling(), here it is only executed.
+
+  RETURN
+    FALSE  OK
+    TRUE   Error
+*/
+
+bool mysql_derived_materialize(THD *thd, TABLE_LIST *orig_table_list)
+{
+  SELECT_LEX_UNIT *unit= orig_table_list->derived;
+  SELECT_LEX *first_select= unit->first_select();
+  LEX *lex= thd->lex;
+  SELECT_LEX *save_current_select= lex->current_select;
+  const char *save_proc_info= thd->proc_info;
+  bool res;
+  DBUG_ENTER("mysql_derived_materialize");
+
+  orig_table_list->table->derived_pending= FALSE;
+  lex->current_select= first_select;
+  first_select->join->exec();
+  res= first_select->join->error || thd->net.report_error;
+  if (!res && orig_table_list->derived_result->flush())
+    res= TRUE;
+  if (!lex->describe)
+    unit->cleanup();
+  lex->current_select= save_current_select;
+  thd->proc_info= save_proc_info;
+  DBUG_RETURN(res);
+}
@@ -1219,6 +1219,7 @@ void st_select_lex::init_query()
   exclude_from_table_unique_test= no_wrap_view_item= FALSE;
   nest_level= 0;
   link_next= 0;
+  join_plan= 0;
 }
 
 void st_select_lex::init_select()
@@ -1347,17 +1348,23 @@ void st_select_lex_node::exclude()
 
   SYNOPSYS
     st_select_lex_unit::exclude_level()
+    unlink_global  - unlink SELECTs of the unit from global SELECTs list
 
   NOTE: units which belong to current will be brought up on level of
   currernt unit 
+
+  A merged derived table keeps its SELECT in the global list (unlink_global
+  is FALSE), so that tables of its FROM clause are still processed by
+  mysql_handle_derived() and prepared statement reinitialization.
 */
-void st_select_lex_unit::exclude_level()
+void st_select_lex_unit::exclude_level(bool unlink_global)
 {
   SELECT_LEX_UNIT *units= 0, **units_last= &units;
   for (SELECT_LEX *sl= first_select(); sl; sl= sl->next_select())
   {
     // unlink current level from global SELECTs list
-    if (sl->link_prev && (*sl->link_prev= sl->link_next))
+    if (unlink_global &&
+        sl->link_prev && (*sl->link_prev= sl->link_next))
       sl->link_next->link_prev= sl->link_prev;
 
     // bring up underlay levels
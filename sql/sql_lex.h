@@ -450,7 +450,7 @@ public:
     return my_reinterpret_cast(st_select_lex_unit*)(next);
   }
   st_select_lex* return_after_parsing() { return return_to; }
-  void exclude_level();
+  void exclude_level(bool unlink_global= TRUE);
   void exclude_tree();
 
   /* UNION methods */
@@ -621,6 +621,8 @@ public:
           defined as SUM_FUNC_USED.
   */
   uint8 full_group_by_flag;
+  /* Plan kept from an earlier execution (see check_join_plan()) */
+  struct st_join_plan *join_plan;
   void init_query();
   void init_select();
   st_select_lex_unit* master_unit();
@@ -730,6 +732,7 @@ inline bool st_select_lex_unit::is_union ()
 #define ALTER_KEYS_ONOFF        512
 #define ALTER_CONVERT          1024
 #define ALTER_FORCE		2048
+#define ALTER_FOREIGN_KEY	4096
 
 /**
   @brief Parsing data for CREATE or ALTER TABLE.
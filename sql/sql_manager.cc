@@ -19,10 +19,13 @@
  *
  *   o Flushing the tables every flush_time seconds.
  *   o Berkeley DB: removing unneeded log files.
+ *   o Query cache: freeing the memory of invalidated queries.
+ *   o MyISAM: compacting the deleted rows of tables after concurrent inserts.
  */
 
 #include "mysql_priv.h"
 #include "sql_manager.h"
+#include <myisam.h>
 
 ulong volatile manager_status;
 bool volatile manager_thread_in_use;
@@ -87,6 +90,20 @@ pthread_handler_t handle_manager(void *arg __attribute__((unused)))
     }
 #endif
 
+#ifdef HAVE_QUERY_CACHE
+    if (status & MANAGER_QUERY_CACHE_RECLAIM)
+    {
+      query_cache.reclaim();
+      status &= ~MANAGER_QUERY_CACHE_RECLAIM;
+    }
+#endif
+
+    if (status & MANAGER_MYISAM_COMPACT)
+    {
+      mi_compact_deleted_chains();
+      status &= ~MANAGER_MYISAM_COMPACT;
+    }
+
     if (status)
       DBUG_PRINT("error", ("manager did not handle something: %lx", status));
   }
@@ -94,9 +94,6 @@ const char *xa_state_names[]={
   "NON-EXISTING", "ACTIVE", "IDLE", "PREPARED"
 };
 
-#ifndef EMBEDDED_LIBRARY
-static bool do_command(THD *thd);
-#endif // EMBEDDED_LIBRARY
 
 #ifdef __WIN__
 extern void win_install_sigabrt_handler(void);
@@ -1077,6 +1074,118 @@ void execute_init_command(THD *thd, sys_var_str *init_command_var,
 }
 
 
+/*
+  Authenticate the user of a new connection and prepare the session
+  for queries
+
+  SYNOPSIS
+    login_connection()
+    thd       Thread handler of the connection
+
+  NOTES
+    Used both by handle_one_connection() and by the pool-of-threads
+    scheduler, which does the login in one of its worker threads.
+
+  RETURN
+    0  ok, queries can be read with do_command()
+    1  error; close the connection with close_connection()
+*/
+
+bool login_connection(THD *thd)
+{
+  int error;
+  NET *net= &thd->net;
+  Security_context *sctx= thd->security_ctx;
+  DBUG_ENTER("login_connection");
+  net->no_send_error= 0;
+
+  /* Use "connect_timeout" value during connection phase */
+  my_net_set_read_timeout(net, connect_timeout);
+  my_net_set_write_timeout(net, connect_timeout);
+
+  if ((error=check_connection(thd)))
+  {						// Wrong permissions
+    if (error > 0)
+      net_printf_error(thd, error, sctx->host_or_ip);
+#ifdef __NT__
+    if (vio_type(net->vio) == VIO_TYPE_NAMEDPIPE)
+      my_sleep(1000);				/* must wait after eof() */
+#endif
+    statistic_increment(aborted_connects,&LOCK_status);
+    DBUG_RETURN(1);
+  }
+#ifdef __NETWARE__
+  netware_reg_user(sctx->ip, sctx->user, "MySQL");
+#endif
+  if (thd->variables.max_join_size == HA_POS_ERROR)
+    thd->options |= OPTION_BIG_SELECTS;
+  if (thd->client_capabilities & CLIENT_COMPRESS)
+    net->compress=1;				// Use compression
+
+  thd->version= refresh_version;
+  thd->proc_info= 0;
+  thd->command= COM_SLEEP;
+  thd->init_for_queries();
+
+  if (sys_init_connect.value_length && !(sctx->master_access & SUPER_ACL))
+  {
+    execute_init_command(thd, &sys_init_connect, &LOCK_sys_init_connect);
+    if (thd->query_error)
+    {
+      thd->killed= THD::KILL_CONNECTION;
+      sql_print_warning(ER(ER_NEW_ABORTING_CONNECTION),
+                        thd->thread_id,(thd->db ? thd->db : "unconnected"),
+                        sctx->user ? sctx->user : "unauthenticated",
+                        sctx->host_or_ip, "init_connect command failed");
+      sql_print_warning("%s", net->last_error);
+    }
+    thd->proc_info=0;
+    thd->init_for_queries();
+  }
+
+  /* Connect completed, set read/write timeouts back to tdefault */
+  my_net_set_read_timeout(net, thd->variables.net_read_timeout);
+  my_net_set_write_timeout(net, thd->variables.net_write_timeout);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Update the statistics and report the error, if any, of a connection
+  that logged in successfully and is about to be closed
+*/
+
+void end_connection(THD *thd)
+{
+  NET *net= &thd->net;
+  Security_context *sctx= thd->security_ctx;
+
+  if (thd->user_connect)
+    decrease_user_connections(thd->user_connect);
+
+  if (thd->killed ||
+      net->vio && net->error && net->report_error)
+  {
+    statistic_increment(aborted_threads, &LOCK_status);
+  }
+
+  if (net->error && net->vio != 0 && net->report_error)
+  {
+    if (!thd->killed && thd->variables.log_warnings > 1)
+    {
+      sql_print_warning(ER(ER_NEW_ABORTING_CONNECTION),
+                        thd->thread_id,(thd->db ? thd->db : "unconnected"),
+                        sctx->user ? sctx->user : "unauthenticated",
+                        sctx->host_or_ip,
+                        (net->last_errno ? ER(net->last_errno) :
+                         ER(ER_UNKNOWN_ERROR)));
+    }
+
+    net_send_error(thd, net->last_errno, NullS);
+  }
+}
+
+
 pthread_handler_t handle_one_connection(void *arg)
 {
   THD *thd=(THD*) arg;
@@ -1127,58 +1236,10 @@ pthread_handler_t handle_one_connection(void *arg)
 
   do
   {
-    int error;
     NET *net= &thd->net;
-    Security_context *sctx= thd->security_ctx;
-    net->no_send_error= 0;
-
-    /* Use "connect_timeout" value during connection phase */
-    my_net_set_read_timeout(net, connect_timeout);
-    my_net_set_write_timeout(net, connect_timeout);
 
-    if ((error=check_connection(thd)))
-    {						// Wrong permissions
-      if (error > 0)
-	net_printf_error(thd, error, sctx->host_or_ip);
-#ifdef __NT__
-      if (vio_type(net->vio) == VIO_TYPE_NAMEDPIPE)
-	my_sleep(1000);				/* must wait after eof() */
-#endif
-      statistic_increment(aborted_connects,&LOCK_status);
+    if (login_connection(thd))
       goto end_thread;
-    }
-#ifdef __NETWARE__
-    netware_reg_user(sctx->ip, sctx->user, "MySQL");
-#endif
-    if (thd->variables.max_join_size == HA_POS_ERROR)
-      thd->options |= OPTION_BIG_SELECTS;
-    if (thd->client_capabilities & CLIENT_COMPRESS)
-      net->compress=1;				// Use compression
-
-    thd->version= refresh_version;
-    thd->proc_info= 0;
-    thd->command= COM_SLEEP;
-    thd->init_for_queries();
-
-    if (sys_init_connect.value_length && !(sctx->master_access & SUPER_ACL))
-    {
-      execute_init_command(thd, &sys_init_connect, &LOCK_sys_init_connect);
-      if (thd->query_error)
-      {
-	thd->killed= THD::KILL_CONNECTION;
-        sql_print_warning(ER(ER_NEW_ABORTING_CONNECTION),
-                          thd->thread_id,(thd->db ? thd->db : "unconnected"),
-                          sctx->user ? sctx->user : "unauthenticated",
-                          sctx->host_or_ip, "init_connect command failed");
-        sql_print_warning("%s", net->last_error);
-      }
-      thd->proc_info=0;
-      thd->init_for_queries();
-    }
-
-    /* Connect completed, set read/write timeouts back to tdefault */
-    my_net_set_read_timeout(net, thd->variables.net_read_timeout);
-    my_net_set_write_timeout(net, thd->variables.net_write_timeout);
 
     while (!net->error && net->vio != 0 &&
            !(thd->killed == THD::KILL_CONNECTION))
@@ -1187,29 +1248,7 @@ pthread_handler_t handle_one_connection(void *arg)
       if (do_command(thd))
 	break;
     }
-    if (thd->user_connect)
-      decrease_user_connections(thd->user_connect);
-
-    if (thd->killed ||
-        net->vio && net->error && net->report_error)
-    {
-      statistic_increment(aborted_threads, &LOCK_status);
-    }
-
-    if (net->error && net->vio != 0 && net->report_error)
-    {
-      if (!thd->killed && thd->variables.log_warnings > 1)
-      {
-        sql_print_warning(ER(ER_NEW_ABORTING_CONNECTION),
-                          thd->thread_id,(thd->db ? thd->db : "unconnected"),
-                          sctx->user ? sctx->user : "unauthenticated",
-                          sctx->host_or_ip,
-                          (net->last_errno ? ER(net->last_errno) :
-                           ER(ER_UNKNOWN_ERROR)));
-      }
-
-      net_send_error(thd, net->last_errno, NullS);
-    }
+    end_connection(thd);
 
 end_thread:
     close_connection(thd, 0, 1);
@@ -1515,7 +1554,7 @@ int end_trans(THD *thd, enum enum_mysql_completiontype completion)
     1  request of thread shutdown (see dispatch_command() description)
 */
 
-static bool do_command(THD *thd)
+bool do_command(THD *thd)
 {
   char *packet= 0;
   ulong packet_length;
@@ -5929,6 +5968,8 @@ void mysql_reset_thd_for_next_command(THD *thd)
   DBUG_ASSERT(thd->security_ctx== &thd->main_security_ctx);
   thd->tmp_table_used= 0;
   thd->thread_specific_used= FALSE;
+  if (!(thd->options & (OPTION_NOT_AUTOCOMMIT | OPTION_BEGIN)))
+    thd->transaction.all.modified_non_trans_table= FALSE;
   if (!thd->in_sub_stmt)
   {
     if (opt_bin_log)
@@ -1005,6 +1005,8 @@ int reset_slave(THD *thd, MASTER_INFO* mi)
     error=1;
     goto err;
   }
+  // and the positions of the parallel appliers
+  delete_slave_worker_info_files();
 
 err:
   unlock_slave_threads(mi);
@@ -1200,6 +1202,13 @@ bool change_master(THD* thd, MASTER_INFO* mi)
     unlock_slave_threads(mi);
     DBUG_RETURN(TRUE);
   }
+  /*
+    The positions of the parallel appliers of the last run do not relate to
+    the new coordinates.
+  */
+  if (lex_mi->host || lex_mi->port || lex_mi->log_file_name || lex_mi->pos ||
+      lex_mi->relay_log_name || lex_mi->relay_log_pos)
+    delete_slave_worker_info_files();
   if (need_relay_log_purge)
   {
     relay_log_purge= 1;
@@ -179,6 +179,15 @@ static int remove_dup_with_hash_index(THD *thd,TABLE *table,
 
 				      ulong key_length,Item *having);
 static int join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count);
+static table_map hash_join_dep(COND *cond, TABLE *table);
+static void join_init_cache_hash(JOIN_TAB *tab, table_map prefix_tables,
+                                 table_map const_tables);
+static bool cache_hash_value(JOIN_CACHE *cache, bool inner, ulong *hash);
+static enum_nested_loop_state
+flush_cached_keys(JOIN *join, JOIN_TAB *join_tab, uint records,
+                  bool skip_last);
+static CACHE_HASH_ENTRY *build_cache_hash(JOIN_TAB *tab, uint records,
+                                          uchar **last_pos);
 static ulong used_blob_length(CACHE_FIELD **ptr);
 static bool store_record_in_cache(JOIN_CACHE *cache);
 static void reset_cache_read(JOIN_CACHE *cache);
@@ -2332,6 +2341,218 @@ static ha_rows get_quick_record_count(THD *thd, SQL_SELECT *select,
   DBUG_RETURN(HA_POS_ERROR);			/* This shouldn't happend */
 }
 
+
+/*
+  Mark the columns of a table that a condition compares with other tables
+
+  SYNOPSIS
+    add_derived_key_fields()
+    cond          condition to scan (top level AND only)
+    table         table whose columns are marked
+    key_fields    key_fields[i] is set for table->field[i] if it is used
+                  in an equality with a non-constant expression that does
+                  not depend on table
+*/
+
+static void add_derived_key_fields(Item *cond, TABLE *table, bool *key_fields)
+{
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+    {
+      List_iterator_fast<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+        add_derived_key_fields(item, table, key_fields);
+    }
+    return;
+  }
+  if (cond->type() != Item::FUNC_ITEM)
+    return;
+
+  Item_func *func= (Item_func*) cond;
+  if (func->functype() == Item_func::MULT_EQUAL_FUNC)
+  {
+    Item_equal_iterator it(*(Item_equal*) cond);
+    Item_field *item;
+    bool other_table= FALSE;
+    while ((item= it++))
+    {
+      if (item->field->table != table)
+        other_table= TRUE;
+    }
+    if (!other_table)
+      return;
+    it.rewind();
+    while ((item= it++))
+    {
+      if (item->field->table == table)
+        key_fields[item->field->field_index]= TRUE;
+    }
+  }
+  else if (func->functype() == Item_func::EQ_FUNC)
+  {
+    for (uint i= 0; i < 2; i++)
+    {
+      Item *arg= func->arguments()[i]->real_item();
+      Item *value= func->arguments()[1 - i];
+      if (arg->type() == Item::FIELD_ITEM &&
+          ((Item_field*) arg)->field->table == table &&
+          !(value->used_tables() & table->map) && !value->const_item())
+        key_fields[((Item_field*) arg)->field->field_index]= TRUE;
+    }
+  }
+}
+
+
+/*
+  Add an index on the join columns of a derived table that is not filled yet
+
+  SYNOPSIS
+    add_derived_key()
+    join          join the derived table belongs to
+    table         the derived table
+    stat          JOIN_TAB array of join
+    stat_end      end of the JOIN_TAB array
+    conds         WHERE condition of join
+
+  DESCRIPTION
+    The derived table is still empty (see mysql_derived_materialize()), so
+    its HEAP table can be recreated with one BTREE key over the columns that
+    the WHERE and ON conditions compare with other tables, in column order.
+    The key is not unique and lets the optimizer read the derived table by
+    ref instead of scanning it for every row of the preceding tables.
+
+  RETURN
+    FALSE  OK (also if no key was added)
+    TRUE   Error
+*/
+
+static bool add_derived_key(JOIN *join, TABLE *table, JOIN_TAB *stat,
+                            JOIN_TAB *stat_end, COND *conds)
+{
+  KEY *keyinfo;
+  KEY_PART_INFO *key_part;
+  ulong *rec_per_key;
+  bool *key_fields;
+  uint i, key_parts= 0, key_length= 0;
+  DBUG_ENTER("add_derived_key");
+
+  if (table->s->db_type != DB_TYPE_HEAP || table->s->keys)
+    DBUG_RETURN(0);
+  if (!(key_fields= (bool*) join->thd->calloc(table->s->fields)))
+    DBUG_RETURN(1);
+  if (conds)
+    add_derived_key_fields(conds, table, key_fields);
+  for (JOIN_TAB *tab= stat; tab < stat_end; tab++)
+  {
+    for (TABLE_LIST *embedding= tab->table->pos_in_table_list;
+         embedding; embedding= embedding->embedding)
+    {
+      if (embedding->on_expr)
+        add_derived_key_fields(embedding->on_expr, table, key_fields);
+    }
+  }
+
+  for (i= 0; i < table->s->fields; i++)
+  {
+    Field *field= table->field[i];
+    uint store_length;
+    if (!key_fields[i])
+      continue;
+    store_length= field->key_length() +
+                  (field->null_ptr ? HA_KEY_NULL_LENGTH : 0) +
+                  (field->real_type() == MYSQL_TYPE_VARCHAR ?
+                   HA_KEY_BLOB_LENGTH : 0);
+    if ((field->flags & BLOB_FLAG) || field->type() == MYSQL_TYPE_BIT ||
+        key_parts == MAX_REF_PARTS ||
+        key_length + store_length > MI_MAX_KEY_LENGTH)
+      key_fields[i]= FALSE;
+    else
+    {
+      key_parts++;
+      key_length+= store_length;
+    }
+  }
+  if (!key_parts)
+    DBUG_RETURN(0);
+
+  if (!multi_alloc_root(&table->mem_root,
+                        &keyinfo, sizeof(*keyinfo),
+                        &key_part, sizeof(*key_part) * key_parts,
+                        &rec_per_key, sizeof(*rec_per_key) * key_parts,
+                        NullS))
+    DBUG_RETURN(1);
+  bzero((char*) keyinfo, sizeof(*keyinfo));
+  bzero((char*) key_part, sizeof(*key_part) * key_parts);
+  bzero((char*) rec_per_key, sizeof(*rec_per_key) * key_parts);
+  keyinfo->key_part= key_part;
+  keyinfo->key_parts= keyinfo->usable_key_parts= key_parts;
+  keyinfo->key_length= key_length;
+  keyinfo->algorithm= HA_KEY_ALG_BTREE;
+  keyinfo->name= (char*) "<auto_key>";
+  keyinfo->rec_per_key= rec_per_key;            // 0: not known
+  keyinfo->table= table;
+
+  (void) table->file->close();
+  (void) table->file->delete_table(table->s->table_name);
+
+  for (i= 0; i < table->s->fields; i++)
+  {
+    Field *field= table->field[i];
+    if (!key_fields[i])
+      continue;
+    key_part->field= field;
+    key_part->fieldnr= (uint16) (i + 1);
+    key_part->offset= field->offset();
+    key_part->length= key_part->store_length= (uint16) field->key_length();
+    key_part->type= (uint8) field->key_type();
+    key_part->key_type=
+      ((ha_base_keytype) key_part->type == HA_KEYTYPE_TEXT ||
+       (ha_base_keytype) key_part->type == HA_KEYTYPE_VARTEXT1 ||
+       (ha_base_keytype) key_part->type == HA_KEYTYPE_VARTEXT2) ?
+      0 : FIELDFLAG_BINARY;
+    if (field->null_ptr)
+    {
+      key_part->null_offset= (uint) ((byte*) field->null_ptr -
+                                     table->record[0]);
+      key_part->null_bit= field->null_bit;
+      key_part->store_length+= HA_KEY_NULL_LENGTH;
+      keyinfo->flags|= HA_NULL_PART_KEY;
+      keyinfo->extra_length+= HA_KEY_NULL_LENGTH;
+    }
+    if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      key_part->key_part_flag|= HA_VAR_LENGTH_PART;
+      key_part->store_length+= HA_KEY_BLOB_LENGTH;
+      keyinfo->extra_length+= HA_KEY_BLOB_LENGTH;
+      if (!(field->flags & BINARY_FLAG))
+        keyinfo->flags|= HA_END_SPACE_KEY;
+    }
+    if (key_part == keyinfo->key_part)
+    {
+      field->flags|= MULTIPLE_KEY_FLAG;
+      field->key_start.set_bit(0);
+    }
+    field->part_of_sortkey.set_bit(0);
+    field->flags|= PART_KEY_FLAG;
+    key_part++;
+  }
+
+  table->key_info= keyinfo;
+  table->s->keys= 1;
+  table->s->key_parts= key_parts;
+  table->s->max_key_length= key_length;
+  table->s->primary_key= MAX_KEY;
+  table->s->keys_in_use.set_bit(0);
+  table->keys_in_use_for_query.set_bit(0);
+  if (open_tmp_table(table))
+    DBUG_RETURN(1);
+  table->file->records= table->derived_rows;
+  DBUG_RETURN(0);
+}
+
+
 /*
    This structure is used to collect info on potentially sargable
    predicates in order to check whether they become sargable after
@@ -2346,6 +2567,270 @@ typedef struct st_sargable_param
   uint num_values;           /* number of values in the above array      */
 } SARGABLE_PARAM;  
 
+/*
+  Estimate the rows of a table that a range over its const keys reads
+
+  SYNOPSIS
+    estimate_range_rows()
+    join                    the join
+    s                       table with const keys
+    conds                   WHERE condition
+    found_const_table_map   const tables that were found; updated
+    const_count             number of const tables; updated
+
+  DESCRIPTION
+    Stores the range in s->quick and its estimate in s->found_records.
+    A table where the range is impossible is made a const table.
+
+  RETURN VALUES
+    0	ok
+    1	Fatal error
+*/
+
+static bool estimate_range_rows(JOIN *join, JOIN_TAB *s, COND *conds,
+                                table_map *found_const_table_map,
+                                uint *const_count)
+{
+  int error;
+  ha_rows records;
+  SQL_SELECT *select;
+  select= make_select(s->table, *found_const_table_map,
+                      *found_const_table_map,
+                      *s->on_expr_ref ? *s->on_expr_ref : conds,
+                      1, &error);
+  if (!select)
+    return 1;
+  records= get_quick_record_count(join->thd, select, s->table,
+                                  &s->const_keys, join->row_limit);
+  s->quick=select->quick;
+  s->needed_reg=select->needed_reg;
+  select->quick=0;
+  if (records == 0 && s->table->reginfo.impossible_range)
+  {
+    /*
+      Impossible WHERE or ON expression
+      In case of ON, we mark that the we match one empty NULL row.
+      In case of WHERE, don't set found_const_table_map to get the
+      caller to abort with a zero row result.
+    */
+    join->const_table_map|= s->table->map;
+    set_position(join,(*const_count)++,s,(KEYUSE*) 0);
+    s->type= JT_CONST;
+    if (*s->on_expr_ref)
+    {
+      /* Generate empty row */
+      s->info= "Impossible ON condition";
+      *found_const_table_map|= s->table->map;
+      s->type= JT_CONST;
+      mark_as_null_row(s->table);		// All fields are NULL
+    }
+  }
+  if (records != HA_POS_ERROR)
+  {
+    s->found_records=records;
+    s->read_time= (ha_rows) (s->quick ? s->quick->read_time : 0.0);
+  }
+  delete select;
+  return 0;
+}
+
+
+/*
+  Test if the plan of a join may be kept for the next execution
+
+  NOTES
+    Only prepared statements and statements of stored procedures are
+    executed more than once.  Derived and information schema tables are
+    filled anew for every execution and full text searches have their
+    own access method, so joins with them are always planned.
+*/
+
+static bool join_plan_allowed(JOIN *join)
+{
+  THD *thd= join->thd;
+  if (!thd->variables.optimizer_plan_cache ||
+      thd->stmt_arena->is_conventional() || thd->lex->describe ||
+      join->select_lex->ftfunc_list->elements)
+    return FALSE;
+  for (TABLE_LIST *tables= join->select_lex->leaf_tables; tables;
+       tables= tables->next_leaf)
+  {
+    if (tables->schema_table || tables->table->derived_pending ||
+        tables->derived)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/* Test if the kept plan reads table number 'tablenr' with a range */
+
+static bool join_plan_uses_range(JOIN_PLAN *plan, uint tablenr)
+{
+  for (CACHED_POSITION *pos= plan->positions, *end= pos + plan->tables;
+       pos < end ; pos++)
+  {
+    if (pos->table == tablenr)
+      return pos->use_quick;
+  }
+  return FALSE;
+}
+
+
+/* Find the first KEYUSE of a key of a table or 0 */
+
+static KEYUSE *find_keyuse(JOIN_TAB *s, uint key)
+{
+  KEYUSE *keyuse;
+  if (!(keyuse= s->keyuse))
+    return 0;
+  for (; keyuse->table == s->table ; keyuse++)
+  {
+    if (keyuse->key == key)
+      return keyuse;
+  }
+  return 0;
+}
+
+
+/*
+  Check that a plan kept from an earlier execution still fits the join
+
+  DESCRIPTION
+    The plan is kept if the same tables are const, the tables have the
+    keys that they had and that the plan uses, ref accesses can be made
+    from the tables before them and the ranges that the plan uses exist
+    and read roughly (within a factor of 10) the rows they were planned
+    with.
+
+  RETURN VALUES
+    TRUE    the plan can be used
+    FALSE   the join must be planned again
+*/
+
+static bool check_join_plan(JOIN *join, JOIN_PLAN *plan)
+{
+  table_map used_tables= join->const_table_map | OUTER_REF_TABLE_BIT;
+  DBUG_ENTER("check_join_plan");
+
+  if (plan->const_table_map != join->const_table_map ||
+      plan->tables != join->tables - join->const_tables)
+    DBUG_RETURN(FALSE);
+  for (CACHED_POSITION *pos= plan->positions, *end= pos + plan->tables;
+       pos < end ; pos++)
+  {
+    JOIN_TAB *s= join->join_tab + pos->table;
+    TABLE *table= s->table;
+    if (table->s->keys != pos->table_keys)
+      DBUG_RETURN(FALSE);
+    if (pos->use_quick)
+    {
+      if (!s->quick ||
+          s->found_records > (pos->found_records + 1) * 10 ||
+          (s->found_records + 1) * 10 < pos->found_records)
+      {
+        DBUG_PRINT("info", ("range of %s changed: %lu -> %lu",
+                            table->alias, (ulong) pos->found_records,
+                            (ulong) s->found_records));
+        DBUG_RETURN(FALSE);
+      }
+    }
+    if (pos->key != MAX_KEY)
+    {
+      KEYUSE *keyuse;
+      if (table->key_info[pos->key].key_parts != pos->key_parts ||
+          !(keyuse= find_keyuse(s, pos->key)) || keyuse->keypart != 0 ||
+          (keyuse->used_tables & ~used_tables))
+        DBUG_RETURN(FALSE);
+    }
+    used_tables|= table->map;
+  }
+  DBUG_RETURN(TRUE);
+}
+
+
+/*
+  Keep the plan found by choose_plan() for the next executions
+
+  NOTES
+    The plan is allocated in the memory of the statement the first time
+    and overwritten when the join is planned again.
+*/
+
+static bool save_join_plan(JOIN *join)
+{
+  JOIN_PLAN *plan= join->select_lex->join_plan;
+  uint tables= join->tables - join->const_tables;
+  DBUG_ENTER("save_join_plan");
+
+  if (!plan || plan->max_tables < tables)
+  {
+    MEM_ROOT *mem_root= join->thd->stmt_arena->mem_root;
+    if (!(plan= (JOIN_PLAN*) alloc_root(mem_root, sizeof(JOIN_PLAN))) ||
+        !(plan->positions= (CACHED_POSITION*)
+          alloc_root(mem_root, sizeof(CACHED_POSITION) * join->tables)))
+      DBUG_RETURN(TRUE);
+    plan->max_tables= join->tables;
+    join->select_lex->join_plan= plan;
+  }
+  plan->tables= tables;
+  plan->const_table_map= join->const_table_map;
+  plan->best_read= join->best_read;
+  plan->sort_by_tmp_table= join->sort_by_table == (TABLE*) 1;
+  for (uint i= 0 ; i < tables ; i++)
+  {
+    POSITION *position= join->best_positions + join->const_tables + i;
+    CACHED_POSITION *pos= plan->positions + i;
+    JOIN_TAB *s= position->table;
+    pos->records_read= position->records_read;
+    pos->read_time= position->read_time;
+    pos->found_records= s->found_records;
+    pos->table= (uint) (s - join->join_tab);
+    pos->table_keys= s->table->s->keys;
+    pos->key= position->key ? position->key->key : MAX_KEY;
+    pos->key_parts= (position->key ?
+                     s->table->key_info[pos->key].key_parts : 0);
+    pos->use_quick= !position->key && s->quick;
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Use a plan kept from an earlier execution instead of choose_plan()
+
+  NOTES
+    check_join_plan() must have accepted the plan.
+*/
+
+static void use_join_plan(JOIN *join, JOIN_PLAN *plan)
+{
+  THD *thd= join->thd;
+  DBUG_ENTER("use_join_plan");
+
+  memcpy((gptr) join->best_positions, (gptr) join->positions,
+         sizeof(POSITION)*join->const_tables);
+  for (uint i= 0 ; i < plan->tables ; i++)
+  {
+    POSITION *position= join->best_positions + join->const_tables + i;
+    CACHED_POSITION *pos= plan->positions + i;
+    position->records_read= pos->records_read;
+    position->read_time= pos->read_time;
+    position->table= join->join_tab + pos->table;
+    position->key= (pos->key == MAX_KEY ? 0 :
+                    find_keyuse(position->table, pos->key));
+  }
+  join->best_read= plan->best_read;
+  if (plan->sort_by_tmp_table)
+    join->sort_by_table= (TABLE*) 1;
+  if (thd->lex->orig_sql_command != SQLCOM_SHOW_STATUS &&
+      thd->lex->is_single_level_stmt())
+    thd->status_var.last_query_cost= join->best_read;
+  statistic_increment(thd->status_var.select_plan_reuse_count, &LOCK_status);
+  DBUG_VOID_RETURN;
+}
+
+
 /*
   Calculate the best possible join and initialize the join structure
 
@@ -2369,6 +2854,8 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
   table_map outer_join=0;
   SARGABLE_PARAM *sargables= 0;
   JOIN_TAB *stat_vector[MAX_TABLES+1];
+  JOIN_PLAN *plan;
+  table_map range_skipped= 0;
   DBUG_ENTER("make_join_statistics");
 
   table_count=join->tables;
@@ -2414,6 +2901,8 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
     s->key_dependent= 0;
     if (tables->schema_table)
       table->file->records= 2;
+    if (table->derived_pending)
+      table->file->records= table->derived_rows;
 
     s->on_expr_ref= &tables->on_expr;
     if (*s->on_expr_ref)
@@ -2491,6 +2980,14 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
     }
   }
 
+  /* Index the join columns of derived tables that are filled on first read */
+  for (s= stat ; s < stat_end ; s++)
+  {
+    if (s->table->derived_pending &&
+        add_derived_key(join, s->table, stat, stat_end, conds))
+      DBUG_RETURN(1);
+  }
+
   if (conds || outer_join)
     if (update_ref_and_keys(join->thd, keyuse_array, stat, join->tables,
                             conds, join->cond_equal,
@@ -2674,6 +3171,12 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
     }
   }
 
+  /* A plan from an earlier execution is used if it is still valid */
+  plan= join->select_lex->join_plan;
+  if (plan && (!join_plan_allowed(join) ||
+               plan->const_table_map != join->const_table_map))
+    plan= 0;
+
   /* Calc how many (possible) matched records in each table */
 
   for (s=stat ; s < stat_end ; s++)
@@ -2707,45 +3210,15 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
     if (!s->const_keys.is_clear_all() &&
         !s->table->pos_in_table_list->embedding)
     {
-      ha_rows records;
-      SQL_SELECT *select;
-      select= make_select(s->table, found_const_table_map,
-			  found_const_table_map,
-			  *s->on_expr_ref ? *s->on_expr_ref : conds,
-			  1, &error);
-      if (!select)
-        DBUG_RETURN(1);
-      records= get_quick_record_count(join->thd, select, s->table,
-				      &s->const_keys, join->row_limit);
-      s->quick=select->quick;
-      s->needed_reg=select->needed_reg;
-      select->quick=0;
-      if (records == 0 && s->table->reginfo.impossible_range)
+      /* A kept plan needs the ranges only of the tables it reads by range */
+      if (plan && !join_plan_uses_range(plan, (uint) (s - stat)))
       {
-	/*
-	  Impossible WHERE or ON expression
-	  In case of ON, we mark that the we match one empty NULL row.
-	  In case of WHERE, don't set found_const_table_map to get the
-	  caller to abort with a zero row result.
-	*/
-	join->const_table_map|= s->table->map;
-	set_position(join,const_count++,s,(KEYUSE*) 0);
-	s->type= JT_CONST;
-	if (*s->on_expr_ref)
-	{
-	  /* Generate empty row */
-	  s->info= "Impossible ON condition";
-	  found_const_table_map|= s->table->map;
-	  s->type= JT_CONST;
-	  mark_as_null_row(s->table);		// All fields are NULL
-	}
-      }
-      if (records != HA_POS_ERROR)
-      {
-	s->found_records=records;
-	s->read_time= (ha_rows) (s->quick ? s->quick->read_time : 0.0);
+        range_skipped|= s->table->map;
+        continue;
       }
-      delete select;
+      if (estimate_range_rows(join, s, conds, &found_const_table_map,
+                              &const_count))
+        DBUG_RETURN(1);
     }
   }
 
@@ -2755,12 +3228,40 @@ make_join_statistics(JOIN *join, TABLE_LIST *tables, COND *conds,
   join->const_tables=const_count;
   join->found_const_table_map=found_const_table_map;
 
+  if (plan && !check_join_plan(join, plan))
+  {
+    /* Make a new plan; do the range analysis that was skipped */
+    plan= 0;
+    for (s=stat ; s < stat_end ; s++)
+    {
+      if ((range_skipped & s->table->map) &&
+          estimate_range_rows(join, s, conds, &found_const_table_map,
+                              &const_count))
+        DBUG_RETURN(1);
+    }
+    join->const_tables=const_count;
+    join->found_const_table_map=found_const_table_map;
+  }
+
   /* Find an optimal join order of the non-constant tables. */
   if (join->const_tables != join->tables)
   {
     optimize_keyuse(join, keyuse_array);
-    if (choose_plan(join, all_table_map & ~join->const_table_map))
-      DBUG_RETURN(TRUE);
+    if (join->thd->variables.optimizer_hash_join)
+    {
+      for (s= stat ; s < stat_end ; s++)
+        s->hash_join_dep= hash_join_dep(conds, s->table) &
+                          ~join->const_table_map;
+    }
+    if (plan)
+      use_join_plan(join, plan);
+    else
+    {
+      if (choose_plan(join, all_table_map & ~join->const_table_map))
+        DBUG_RETURN(TRUE);
+      if (join_plan_allowed(join) && save_join_plan(join))
+        DBUG_RETURN(TRUE);
+    }
   }
   else
   {
@@ -4285,9 +4786,10 @@ best_access_path(JOIN      *join,
       else
       {
         /* We read the table as many times as join buffer becomes full. */
-        tmp*= (1.0 + floor((double) cache_record_length(join,idx) *
-                           record_count /
-                           (double) thd->variables.join_buff_size));
+        double fills= 1.0 + floor((double) cache_record_length(join,idx) *
+                                  record_count /
+                                  (double) thd->variables.join_buff_size);
+        tmp*= fills;
         /* 
             We don't make full cartesian product between rows in the scanned
            table and existing records because we skip all rows from the
@@ -4296,6 +4798,32 @@ best_access_path(JOIN      *join,
            take into account cost to read and skip these records.
         */
         tmp+= (s->records - rnd_records)/(double) TIME_FOR_COMPARE;
+
+        /*
+          With a hash join only the cached records with the same values of
+          the equi-join columns are compared with a row of the table. For
+          each fill of the join buffer we hash the cached records and
+          probe the hash with every row read. As for a 'ref' access without
+          index statistics, assume that a row matches
+          MATCHING_ROWS_IN_OTHER_TABLE-th of the records.
+          It is only used when there is no index for the equalities.
+        */
+        if (thd->variables.optimizer_hash_join && !best_key &&
+            (s->hash_join_dep & ~remaining_tables))
+        {
+          double hash_records= max(rows2double(rnd_records) /
+                                   MATCHING_ROWS_IN_OTHER_TABLE, 1.0);
+          double hash_tmp= tmp + (record_count + rnd_records * fills) /
+                                 (double) TIME_FOR_COMPARE;
+          if (best == DBL_MAX ||
+              (hash_tmp + record_count/(double) TIME_FOR_COMPARE*hash_records <
+               best + record_count/(double) TIME_FOR_COMPARE*records))
+          {
+            best= hash_tmp;
+            records= hash_records;
+            best_key= 0;
+          }
+        }
       }
     }
 
@@ -5444,6 +5972,8 @@ make_simple_join(JOIN *join,TABLE *tmp_table)
   join->do_send_rows = (join->row_limit) ? 1 : 0;
 
   join_tab->cache.buff=0;			/* No caching */
+  join_tab->cache.hash_keys= 0;
+  join_tab->cache.key_access= 0;
   join_tab->table=tmp_table;
   join_tab->select=0;
   join_tab->select_cond=0;
@@ -6167,6 +6697,14 @@ make_join_readinfo(JOIN *join, ulonglong options)
       if (i != join->const_tables && !(options & SELECT_NO_JOIN_CACHE) &&
           tab->use_quick != 2 && !tab->first_inner && !ordered_set)
       {
+        if (join->thd->variables.optimizer_hash_join)
+        {
+          table_map prefix_tables= 0;
+          for (JOIN_TAB *prev= join->join_tab+join->const_tables;
+               prev != tab; prev++)
+            prefix_tables|= prev->table->map;
+          join_init_cache_hash(tab, prefix_tables, join->const_table_map);
+        }
 	if ((options & SELECT_DESCRIBE) ||
 	    !join_init_cache(join->thd,join->join_tab+join->const_tables,
 			     i-join->const_tables))
@@ -6244,6 +6782,23 @@ make_join_readinfo(JOIN *join, ulonglong options)
     case JT_MAYBE_REF:
       abort();					/* purecov: deadcode */
     }
+    /*
+      Look up the rows of a ref table for a join buffer of records of the
+      previous tables at once, like a full join caches them
+    */
+    if ((tab->type == JT_REF || tab->type == JT_EQ_REF) &&
+        join->thd->variables.optimizer_batched_key_access &&
+        i != join->const_tables && !(options & SELECT_NO_JOIN_CACHE) &&
+        !tab->first_inner && !ordered_set)
+    {
+      tab->cache.key_access= 1;
+      if ((options & SELECT_DESCRIBE) ||
+          !join_init_cache(join->thd,join->join_tab+join->const_tables,
+                           i-join->const_tables))
+        tab[-1].next_select=sub_select_cache; /* Patch previous */
+      else
+        tab->cache.key_access= 0;
+    }
   }
   join->join_tab[join->tables-1].next_select=0; /* Set by do_select */
   DBUG_VOID_RETURN;
@@ -8261,6 +8816,8 @@ simplify_joins(JOIN *join, List<TABLE_LIST> *join_list, COND *conds, bool top)
   }
     
   /* Flatten nested joins that can be flattened. */
+  TABLE_LIST *right_neighbor= NULL;
+  bool fix_name_res= FALSE;
   li.rewind();
   while ((table= li++))
   {
@@ -8275,7 +8832,18 @@ simplify_joins(JOIN *join, List<TABLE_LIST> *join_list, COND *conds, bool top)
         tbl->join_list= table->join_list;
       }      
       li.replace(nested_join->join_list);
+      /*
+        The flattened list is kept for re-execution of PS/SP, where
+        setup_natural_join_row_types() starts name resolution from its
+        left-most table: update the name resolution chain accordingly.
+      */
+      fix_name_res= TRUE;
+      table= *li.ref();
     }
+    if (fix_name_res)
+      table->next_name_resolution_table= right_neighbor ?
+        right_neighbor->first_leaf_for_name_resolution() : NULL;
+    right_neighbor= table;
   }
   DBUG_RETURN(conds); 
 }
@@ -9536,8 +10104,13 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   *reg_field= 0;
   *blob_field= 0;				// End marker
 
-  /* If result table is small; use a heap */
-  if (blob_count || using_unique_constraint ||
+  /*
+    If result table is small; use a heap. HEAP tables can store BLOBs but
+    can't have unique constraints on them or remove duplicates of them
+    (see remove_duplicates()).
+  */
+  if ((blob_count && (distinct || (select_options & SELECT_DISTINCT))) ||
+      using_unique_constraint ||
       (select_options & (OPTION_BIG_TABLES | SELECT_SMALL_RESULT)) ==
       OPTION_BIG_TABLES || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
@@ -9578,6 +10151,9 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
       (reclength / string_total_length <= RATIO_TO_PACK_ROWS ||
        string_total_length / string_count >= AVG_STRING_LENGTH_TO_PACK_ROWS))
     use_packed_rows= 1;
+  /* HEAP stores such rows in chunks, only the used length takes memory */
+  if (use_packed_rows && table->s->db_type == DB_TYPE_HEAP)
+    table->s->row_type= ROW_TYPE_DYNAMIC;
 
   table->s->fields= field_count;
   table->s->reclength= reclength;
@@ -9707,7 +10283,8 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   param->recinfo=recinfo;
   store_record(table,s->default_values);        // Make empty default record
 
-  if (thd->variables.tmp_table_size == ~ (ulonglong) 0)		// No limit
+  if (thd->variables.tmp_table_size == ~ (ulonglong) 0 ||	// No limit
+      table->s->row_type == ROW_TYPE_DYNAMIC)	// Limited by ha_heap::create
     table->s->max_rows= ~(ha_rows) 0;
   else
     table->s->max_rows= (ha_rows) (((table->s->db_type == DB_TYPE_HEAP) ?
@@ -10021,7 +10598,7 @@ static bool create_myisam_tmp_table(TABLE *table,TMP_TABLE_PARAM *param,
   int error;
   MI_KEYDEF keydef;
   MI_UNIQUEDEF uniquedef;
-  KEY *keyinfo=param->keyinfo;
+  KEY *keyinfo=table->key_info;
   DBUG_ENTER("create_myisam_tmp_table");
 
   if (table->s->keys)
@@ -10055,9 +10632,10 @@ static bool create_myisam_tmp_table(TABLE *table,TMP_TABLE_PARAM *param,
     }
     else
     {
-      /* Create an unique key */
+      /* Create an unique key (not unique for the key of a derived table) */
       bzero((char*) &keydef,sizeof(keydef));
-      keydef.flag=HA_NOSAME | HA_BINARY_PACK_KEY | HA_PACK_KEY;
+      keydef.flag= ((keyinfo->flags & HA_NOSAME) | HA_BINARY_PACK_KEY |
+                    HA_PACK_KEY);
       keydef.keysegs=  keyinfo->key_parts;
       keydef.seg= seg;
     }
@@ -10644,6 +11222,10 @@ sub_select(JOIN *join,JOIN_TAB *join_tab,bool end_of_records)
       /* Set first_unmatched for the last inner table of this group */
       join_tab->last_inner->first_unmatched= join_tab;
     }
+    if (join_tab->table->derived_pending &&
+        mysql_derived_materialize(join->thd,
+                                  join_tab->table->pos_in_table_list))
+      return NESTED_LOOP_ERROR;
     join->thd->row_count= 0;
 
     error= (*join_tab->read_first_record)(join_tab);
@@ -10871,6 +11453,13 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
     return NESTED_LOOP_OK;                      /* Nothing to do */
   if (skip_last)
     (void) store_record_in_cache(&join_tab->cache); // Must save this for later
+  if (join_tab->table->derived_pending &&
+      mysql_derived_materialize(join->thd, join_tab->table->pos_in_table_list))
+    return NESTED_LOOP_ERROR;
+  if (join_tab->cache.key_access)
+    return flush_cached_keys(join, join_tab,
+                             join_tab->cache.records - (skip_last ? 1 : 0),
+                             skip_last);
   if (join_tab->use_quick == 2)
   {
     if (join_tab->select->quick)
@@ -10892,6 +11481,12 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
     tmp->table->status=0;
   }
 
+  uint records= join_tab->cache.records - (skip_last ? 1 : 0);
+  uchar *last_pos= 0;
+  CACHE_HASH_ENTRY *hash= 0;
+  if (join_tab->cache.hash_keys)
+    hash= build_cache_hash(join_tab, records, &last_pos);
+
   info= &join_tab->read_record;
   do
   {
@@ -10905,8 +11500,38 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
         (!join_tab->cache.select || !join_tab->cache.select->skip_record()))
     {
       uint i;
+      if (hash)
+      {
+        /*
+          Compare the row only with the cached records that have the same
+          hash value of the equi-join columns. A NULL value never matches.
+        */
+        ulong hash_value;
+        if (records &&
+            !cache_hash_value(&join_tab->cache, TRUE, &hash_value))
+        {
+          for (i= hash[hash_value % records].head ; i ; i= hash[i-1].next)
+          {
+            if (hash[i-1].hash != hash_value)
+              continue;
+            join_tab->cache.pos= hash[i-1].pos;
+            join_tab->cache.record_nr= i-1;
+            read_cached_record(join_tab);
+            if (!select || !select->skip_record())
+            {
+              rc= (join_tab->next_select)(join,join_tab+1,0);
+              if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+              {
+                reset_cache_write(&join_tab->cache);
+                return rc;
+              }
+            }
+          }
+        }
+        continue;
+      }
       reset_cache_read(&join_tab->cache);
-      for (i=(join_tab->cache.records- (skip_last ? 1 : 0)) ; i-- > 0 ;)
+      for (i= records ; i-- > 0 ;)
       {
 	read_cached_record(join_tab);
 	if (!select || !select->skip_record())
@@ -10923,7 +11548,14 @@ flush_cached_records(JOIN *join,JOIN_TAB *join_tab,bool skip_last)
   } while (!(error=info->read_record(info)));
 
   if (skip_last)
+  {
+    if (hash)
+    {
+      join_tab->cache.pos= last_pos;
+      join_tab->cache.record_nr= records;
+    }
     read_cached_record(join_tab);		// Restore current record
+  }
   reset_cache_write(&join_tab->cache);
   if (error > 0)				// Fatal error
     return NESTED_LOOP_ERROR;                   /* purecov: inspected */
@@ -12467,6 +13099,7 @@ test_if_skip_sort_order(JOIN_TAB *tab,ORDER *order,ha_rows select_limit,
     */
   
     if (quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE || 
+        quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT ||
         quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION || 
         quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT)
       DBUG_RETURN(0);
@@ -12556,6 +13189,7 @@ test_if_skip_sort_order(JOIN_TAB *tab,ORDER *order,ha_rows select_limit,
 	  {
             int quick_type= select->quick->get_type();
             if (quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE ||
+                quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT ||
                 quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT ||
                 quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION ||
                 quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
@@ -12753,6 +13387,10 @@ create_sort_index(THD *thd, JOIN *join, ORDER *order,
       !thd->lex->describe &&
       get_schema_tables_result(join, PROCESSED_BY_CREATE_SORT_INDEX))
     goto err;
+  /* Fill a derived table that was left pending before sorting it */
+  if (table->derived_pending &&
+      mysql_derived_materialize(thd, table->pos_in_table_list))
+    goto err;
 
   if (table->s->tmp_table)
     table->file->info(HA_STATUS_VARIABLE);	// Get record count
@@ -13154,7 +13792,7 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
 {
   reg1 uint i;
   uint length, blobs;
-  size_t size;
+  size_t size, mrr_size;
   CACHE_FIELD *copy,**blob_ptr;
   JOIN_CACHE  *cache;
   JOIN_TAB *join_tab;
@@ -13233,10 +13871,25 @@ join_init_cache(THD *thd,JOIN_TAB *tables,uint table_count)
   cache->length=length+blobs*sizeof(char*);
   cache->blobs=blobs;
   *blob_ptr=0;					/* End sequentel */
-  size=max(thd->variables.join_buff_size, cache->length);
-  if (!(cache->buff=(uchar*) my_malloc(size,MYF(0))))
+  /* The hash or key entries of the records are stored at the end of the buffer */
+  if (cache->key_access)
+    cache->entry_length= (ALIGN_SIZE(sizeof(KEY_MULTI_RANGE)) +
+                          ALIGN_SIZE(offsetof(CACHE_KEY_ENTRY, key) +
+                                     tables[table_count].ref.key_length));
+  else
+    cache->entry_length= cache->hash_keys ? sizeof(CACHE_HASH_ENTRY) : 0;
+  size=max(thd->variables.join_buff_size,
+           cache->length + 2 * cache->entry_length);
+  if (cache->entry_length)
+    size&= ~(size_t) (ALIGN_SIZE(1) - 1);
+  /* The rowids of the multi-range read are sorted in a quarter more */
+  mrr_size= cache->key_access ? ALIGN_SIZE(size / 4) : 0;
+  if (!(cache->buff=(uchar*) my_malloc(size + mrr_size,MYF(0))))
     DBUG_RETURN(1);				/* Don't use cache */ /* purecov: inspected */
   cache->end=cache->buff+size;
+  cache->mrr_buff.buffer= cache->end;
+  cache->mrr_buff.buffer_end= cache->end + mrr_size;
+  cache->mrr_buff.end_of_used_area= cache->end;
   reset_cache_write(cache);
   DBUG_RETURN(0);
 }
@@ -13270,7 +13923,9 @@ store_record_in_cache(JOIN_CACHE *cache)
   length=cache->length;
   if (cache->blobs)
     length+=used_blob_length(cache->blob_ptr);
-  if ((last_record= (length + cache->length > (size_t) (cache->end - pos))))
+  if ((last_record= (length + cache->length +
+                     (cache->records + 2) * cache->entry_length >
+                     (size_t) (cache->end - pos))))
     cache->ptr_record=cache->records;
 
   /*
@@ -13316,7 +13971,9 @@ store_record_in_cache(JOIN_CACHE *cache)
     }
   }
   cache->pos=pos;
-  return last_record || (size_t) (cache->end - pos) < cache->length;
+  return (last_record ||
+          (size_t) (cache->end - pos) <
+          cache->length + (cache->records + 1) * cache->entry_length);
 }
 
 
@@ -13386,6 +14043,505 @@ read_cached_record(JOIN_TAB *tab)
 }
 
 
+/*****************************************************************************
+  Hash join
+
+  When the condition attached to a table read with the join cache has
+  equalities between the table and the cached tables, the cached records
+  are hashed on the values of the equalities before the table is scanned,
+  and each row of the table is only compared with the cached records that
+  have the same hash value. The hash entries are stored at the end of the
+  join buffer, so when the cached records don't fit in join_buffer_size
+  the buffer is flushed in parts as for the block nested loop join.
+******************************************************************************/
+
+/*
+  Check whether an equality can be tested by comparing hash values
+
+  NOTES
+    Values that compare equal must have the same hash value. This is not
+    the case for temporal values that are compared as dates and for floating
+    point values that are compared with a precision.
+*/
+
+static bool hash_join_comparable(Item *a, Item *b)
+{
+  if (a->is_datetime() || b->is_datetime() ||
+      a->field_type() == MYSQL_TYPE_TIME || b->field_type() == MYSQL_TYPE_TIME)
+    return FALSE;
+  switch (item_cmp_type(a->result_type(), b->result_type())) {
+  case INT_RESULT:
+  case DECIMAL_RESULT:
+  case STRING_RESULT:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
+/*
+  Find the tables a table has equalities with that can be used for a
+  hash join
+
+  SYNOPSIS
+    hash_join_dep()
+    cond     WHERE condition with multiple equalities
+    table    table to check
+
+  RETURN
+    Map of the tables
+*/
+
+static table_map hash_join_dep(COND *cond, TABLE *table)
+{
+  table_map dep= 0;
+  if (!cond)
+    return 0;
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+    {
+      List_iterator_fast<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+        dep|= hash_join_dep(item, table);
+    }
+    return dep;
+  }
+  if (cond->type() != Item::FUNC_ITEM)
+    return 0;
+
+  Item_func *func= (Item_func*) cond;
+  if (func->functype() == Item_func::MULT_EQUAL_FUNC)
+  {
+    Item_equal *item_equal= (Item_equal*) cond;
+    Item_equal_iterator it(*item_equal);
+    Item_field *item, *own= 0;
+    if (item_equal->get_const())
+      return 0;                                 // Becomes field= const
+    while ((item= it++))
+    {
+      if (item->field->table == table)
+        own= item;
+    }
+    if (!own)
+      return 0;
+    it.rewind();
+    while ((item= it++))
+    {
+      if (item->field->table != table && hash_join_comparable(own, item))
+        dep|= item->field->table->map;
+    }
+  }
+  else if (func->functype() == Item_func::EQ_FUNC)
+  {
+    Item **args= func->arguments();
+    table_map map0= args[0]->used_tables(), map1= args[1]->used_tables();
+    if (((map0 | map1) & RAND_TABLE_BIT) ||
+        !hash_join_comparable(args[0], args[1]))
+      return 0;
+    if (map0 == table->map && !(map1 & table->map))
+      dep= map1;
+    else if (map1 == table->map && !(map0 & table->map))
+      dep= map0;
+  }
+  return dep & ~PSEUDO_TABLE_BITS;
+}
+
+
+static void add_cache_hash_keys(COND *cond, List<Item> *list)
+{
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+    {
+      List_iterator_fast<Item> li(*((Item_cond*) cond)->argument_list());
+      Item *item;
+      while ((item= li++))
+        add_cache_hash_keys(item, list);
+    }
+  }
+  else if (cond->type() == Item::FUNC_ITEM &&
+           ((Item_func*) cond)->functype() == Item_func::EQ_FUNC)
+    list->push_back(cond);
+}
+
+
+/*
+  Find the equalities of the condition attached to a table that are used
+  to look up the cached records matching a row of the table
+
+  SYNOPSIS
+    join_init_cache_hash()
+    tab            table read with the join cache
+    prefix_tables  tables stored in the join cache
+    const_tables   constant tables
+
+  NOTES
+    Only top level equalities between an expression of the cached tables
+    and an expression of the table are used. The whole condition is still
+    checked for the matching records. Sets tab->cache.hash_keys to 0 if
+    there are no such equalities.
+*/
+
+static void join_init_cache_hash(JOIN_TAB *tab, table_map prefix_tables,
+                                 table_map const_tables)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  table_map inner_tables= tab->table->map;
+  table_map allowed= const_tables | OUTER_REF_TABLE_BIT;
+  List<Item> eq_list;
+  Item *item;
+  DBUG_ENTER("join_init_cache_hash");
+
+  cache->hash_keys= 0;
+  if (!tab->select || !tab->select->cond)
+    DBUG_VOID_RETURN;
+  add_cache_hash_keys(tab->select->cond, &eq_list);
+  if (eq_list.is_empty() ||
+      !(cache->hash_key= (CACHE_HASH_KEY*)
+        sql_alloc(sizeof(CACHE_HASH_KEY) * eq_list.elements)))
+    DBUG_VOID_RETURN;
+
+  List_iterator_fast<Item> it(eq_list);
+  while ((item= it++))
+  {
+    Item_bool_func2 *eq= (Item_bool_func2*) item;
+    Item *outer= eq->arguments()[0], *inner= eq->arguments()[1];
+    if (outer->used_tables() & inner_tables)
+      swap_variables(Item*, outer, inner);
+    table_map outer_map= outer->used_tables();
+    table_map inner_map= inner->used_tables();
+    if (!(outer_map & prefix_tables) ||
+        (outer_map & ~(prefix_tables | allowed)) ||
+        !(inner_map & inner_tables) ||
+        (inner_map & ~(inner_tables | allowed)) ||
+        outer->with_subselect || inner->with_subselect ||
+        !hash_join_comparable(outer, inner))
+      continue;
+    CACHE_HASH_KEY *key= cache->hash_key + cache->hash_keys++;
+    key->outer= outer;
+    key->inner= inner;
+    key->type= item_cmp_type(outer->result_type(), inner->result_type());
+    key->collation= eq->compare_collation();
+  }
+  DBUG_PRINT("info", ("table: %s  hash keys: %u",
+                      tab->table->alias, cache->hash_keys));
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Calculate the hash value of the equi-join columns
+
+  SYNOPSIS
+    cache_hash_value()
+    cache      join cache
+    inner      calculate the value for the current row of the table (1)
+               or for the cached record that was read last (0)
+    hash       store the value here
+
+  RETURN
+    0  ok
+    1  one of the values is NULL, the row has no matches
+*/
+
+static bool cache_hash_value(JOIN_CACHE *cache, bool inner, ulong *hash)
+{
+  ulong nr1= 1, nr2= 4;
+  char buff[MAX_FIELD_WIDTH];
+  CACHE_HASH_KEY *key, *end;
+
+  for (key= cache->hash_key, end= key + cache->hash_keys ; key < end ; key++)
+  {
+    Item *item= inner ? key->inner : key->outer;
+    switch (key->type) {
+    case INT_RESULT:
+    {
+      longlong value= item->val_int();
+      if (item->null_value)
+        return 1;
+      int8store(buff, value);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, (uchar*) buff, 8,
+                                     &nr1, &nr2);
+      break;
+    }
+    case DECIMAL_RESULT:
+    {
+      /* Equal decimals are converted to the same double */
+      double value= item->val_real();
+      if (item->null_value)
+        return 1;
+      if (value == 0.0)
+        value= 0.0;                             // -0.0 and 0.0 are equal
+      float8store(buff, value);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, (uchar*) buff, 8,
+                                     &nr1, &nr2);
+      break;
+    }
+    default:
+    {
+      String tmp(buff, sizeof(buff), key->collation), *str;
+      if (!(str= item->val_str(&tmp)))
+        return 1;
+      key->collation->coll->hash_sort(key->collation, (uchar*) str->ptr(),
+                                      str->length(), &nr1, &nr2);
+      break;
+    }
+    }
+  }
+  *hash= nr1;
+  return 0;
+}
+
+
+/*
+  Build the hash of the cached records
+
+  SYNOPSIS
+    build_cache_hash()
+    tab        table read with the join cache
+    records    number of cached records to hash
+    last_pos   store the position of the record after them here
+
+  NOTES
+    The records of a hash chain are in the order they were cached, so that
+    the rows are joined in the same order as by the block nested loop.
+
+  RETURN
+    Array of the hash entries, indexed by record number
+*/
+
+static CACHE_HASH_ENTRY *
+build_cache_hash(JOIN_TAB *tab, uint records, uchar **last_pos)
+{
+  JOIN_CACHE *cache= &tab->cache;
+  CACHE_HASH_ENTRY *hash= ((CACHE_HASH_ENTRY*) cache->end) - records;
+  uint i;
+
+  reset_cache_read(cache);
+  for (i= 0 ; i < records ; i++)
+  {
+    CACHE_HASH_ENTRY *entry= hash + i;
+    entry->pos= cache->pos;
+    entry->head= entry->next= 0;
+    read_cached_record(tab);
+    if (cache_hash_value(cache, FALSE, &entry->hash))
+      entry->pos= 0;                            // NULL never matches
+  }
+  *last_pos= cache->pos;
+
+  for (i= records ; i-- > 0 ; )
+  {
+    CACHE_HASH_ENTRY *entry= hash + i;
+    if (entry->pos)
+    {
+      CACHE_HASH_ENTRY *bucket= hash + entry->hash % records;
+      entry->next= bucket->head;
+      bucket->head= i + 1;
+    }
+  }
+  return hash;
+}
+
+
+/*
+  Compare two ref keys of a table in the order of its index
+
+  NOTES
+    Prefixes of CHAR columns are compared as bytes, which is an order
+    as good as the index order for grouping equal keys.
+*/
+
+static int cmp_ref_keys(JOIN_TAB *tab, const byte *a, const byte *b)
+{
+  KEY_PART_INFO *part= tab->table->key_info[tab->ref.key].key_part;
+  KEY_PART_INFO *end= part + tab->ref.key_parts;
+  int res;
+
+  for (; part < end ; a+= part->store_length, b+= part->store_length, part++)
+  {
+    const byte *pa= a, *pb= b;
+    if (part->null_bit)
+    {
+      if (*a != *b)
+        return *a ? -1 : 1;                     // NULL first
+      if (*a)
+        continue;
+      pa++;
+      pb++;
+    }
+    if ((part->key_part_flag & HA_PART_KEY_SEG) &&
+        !(part->key_part_flag & (HA_BLOB_PART | HA_VAR_LENGTH_PART)))
+      res= memcmp(pa, pb, part->length);
+    else
+      res= part->field->key_cmp(pa, pb);
+    if (res)
+      return res;
+  }
+  return 0;
+}
+
+
+/* Order the ranges of the cached records on key, then on record number */
+
+static int cmp_cache_key_range(const void *tab, const void *a, const void *b)
+{
+  const KEY_MULTI_RANGE *range_a= (const KEY_MULTI_RANGE*) a;
+  const KEY_MULTI_RANGE *range_b= (const KEY_MULTI_RANGE*) b;
+  int res;
+  if ((res= cmp_ref_keys((JOIN_TAB*) tab, range_a->start_key.key,
+                         range_b->start_key.key)))
+    return res;
+  return (((CACHE_KEY_ENTRY*) range_a->ptr)->record_nr <
+          ((CACHE_KEY_ENTRY*) range_b->ptr)->record_nr ? -1 : 1);
+}
+
+
+/*
+  Join the cached records with the rows of a table read by ref
+  (batched key access)
+
+  SYNOPSIS
+    flush_cached_keys()
+    join       join
+    join_tab   table read by ref or eq_ref
+    records    number of cached records to join
+    skip_last  restore the record after them at the end
+
+  DESCRIPTION
+    The ref keys of all cached records are made first and sorted on key.
+    Records with the same key share one lookup.  The keys are read with one
+    multi-range read, which reads the rows in the order they are stored in
+    if the handler can (see handler::read_multi_range_first()).  Every row
+    found is joined with the records whose key it matches.
+*/
+
+static enum_nested_loop_state
+flush_cached_keys(JOIN *join, JOIN_TAB *join_tab, uint records,
+                  bool skip_last)
+{
+  JOIN_CACHE *cache= &join_tab->cache;
+  TABLE *table= join_tab->table;
+  TABLE_REF *ref= &join_tab->ref;
+  SQL_SELECT *select= join_tab->select;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  uint key_entry_length= ALIGN_SIZE(offsetof(CACHE_KEY_ENTRY, key) +
+                                    ref->key_length);
+  KEY_MULTI_RANGE *ranges= (KEY_MULTI_RANGE*) (cache->end -
+                                               records * cache->entry_length);
+  uchar *entries= (uchar*) ranges + records * ALIGN_SIZE(sizeof(KEY_MULTI_RANGE));
+  KEY_MULTI_RANGE *range, *end, *to, *found;
+  CACHE_KEY_ENTRY *entry, *last= 0;
+  uint i, count= 0;
+  uchar *last_pos;
+  int error;
+  DBUG_ENTER("flush_cached_keys");
+
+  /* Make the keys; a record with a NULL that rejects it has no match */
+  reset_cache_read(cache);
+  for (i= 0 ; i < records ; i++)
+  {
+    entry= (CACHE_KEY_ENTRY*) (entries + i * key_entry_length);
+    entry->pos= cache->pos;
+    entry->record_nr= i;
+    entry->next= 0;
+    read_cached_record(join_tab);
+    uint part;
+    for (part= 0 ; part < ref->key_parts ; part++)
+    {
+      if ((ref->null_rejecting & 1 << part) && ref->items[part]->is_null())
+        break;
+    }
+    if (part < ref->key_parts || cp_buffer_from_ref(join->thd, ref))
+      continue;
+    memcpy(entry->key, ref->key_buff, ref->key_length);
+    range= ranges + count++;
+    range->start_key.key= range->end_key.key= (byte*) entry->key;
+    range->start_key.length= range->end_key.length= ref->key_length;
+    range->start_key.flag= HA_READ_KEY_EXACT;
+    range->end_key.flag= HA_READ_AFTER_KEY;
+    range->range_flag= (join_tab->type == JT_EQ_REF ?
+                        UNIQUE_RANGE | EQ_RANGE : EQ_RANGE);
+    range->ptr= (char*) entry;
+  }
+  last_pos= cache->pos;
+
+  /* Sort the keys and look up equal keys only once */
+  my_qsort2((gptr) ranges, count, sizeof(KEY_MULTI_RANGE),
+            cmp_cache_key_range, (void*) join_tab);
+  for (range= to= ranges, end= ranges + count ; range < end ; range++)
+  {
+    entry= (CACHE_KEY_ENTRY*) range->ptr;
+    if (to != ranges && !cmp_ref_keys(join_tab, to[-1].start_key.key,
+                                      range->start_key.key))
+      last->next= entry;
+    else
+      *to++= *range;
+    last= entry;
+  }
+  count= (uint) (to - ranges);
+  DBUG_PRINT("info", ("records: %u  keys: %u", records, count));
+
+  for (JOIN_TAB *tmp=join->join_tab; tmp != join_tab ; tmp++)
+  {
+    tmp->status=tmp->table->status;
+    tmp->table->status=0;
+  }
+
+  if (!table->file->inited)
+    table->file->ha_index_init(ref->key);
+  error= (count ?
+          table->file->read_multi_range_first(&found, ranges, count, FALSE,
+                                              &cache->mrr_buff) :
+          HA_ERR_END_OF_FILE);
+  for (; !error ; error= table->file->read_multi_range_next(&found))
+  {
+    if (join->thd->killed)
+    {
+      join->thd->send_kill_message();
+      reset_cache_write(cache);
+      DBUG_RETURN(NESTED_LOOP_KILLED);          // Aborted by user
+    }
+    table->status= 0;
+    for (entry= (CACHE_KEY_ENTRY*) found->ptr ; entry ; entry= entry->next)
+    {
+      cache->pos= entry->pos;
+      cache->record_nr= entry->record_nr;
+      read_cached_record(join_tab);
+      if (!select || !select->skip_record())
+      {
+        rc= (join_tab->next_select)(join,join_tab+1,0);
+        if (rc != NESTED_LOOP_OK)
+          break;
+      }
+    }
+    if (rc == NESTED_LOOP_NO_MORE_ROWS)
+      break;
+    if (rc != NESTED_LOOP_OK)
+    {
+      reset_cache_write(cache);
+      DBUG_RETURN(rc);
+    }
+  }
+
+  if (skip_last)
+  {
+    cache->pos= last_pos;
+    cache->record_nr= records;
+    read_cached_record(join_tab);		// Restore current record
+  }
+  reset_cache_write(cache);
+  if (error > 0 && error != HA_ERR_END_OF_FILE &&
+      report_error(table, error) > 0)
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  for (JOIN_TAB *tmp2=join->join_tab; tmp2 != join_tab ; tmp2++)
+    tmp2->table->status=tmp2->status;
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 static bool
 cmp_buffer_with_ref(JOIN_TAB *tab)
 {
@@ -15249,6 +16405,7 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       {
         quick_type= tab->select->quick->get_type();
         if ((quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE) ||
+            (quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT) ||
             (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT) ||
             (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION))
           tab->type = JT_INDEX_MERGE;
@@ -15380,7 +16537,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
       {
         if (quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION || 
             quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT ||
-            quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE)
+            quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_MERGE ||
+            quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT)
         {
           extra.append(STRING_WITH_LEN("; Using "));
           tab->select->quick->add_info_string(&extra);
@@ -15421,6 +16579,10 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
           else
             extra.append(STRING_WITH_LEN("; Using index"));
         }
+	if (tab->cache.hash_keys)
+	  extra.append(STRING_WITH_LEN("; Using hash join"));
+	if (tab->cache.key_access)
+	  extra.append(STRING_WITH_LEN("; Using batched key access"));
 	if (table->reginfo.not_exists_optimize)
 	  extra.append(STRING_WITH_LEN("; Not exists"));
 	if (need_tmp_table)
@@ -15493,7 +16655,8 @@ bool mysql_explain_union(THD *thd, SELECT_LEX_UNIT *unit, select_result *result)
 		 ((uncacheable & UNCACHEABLE_DEPENDENT) ?
 		  "DEPENDENT SUBQUERY":
 		  (uncacheable?"UNCACHEABLE SUBQUERY":
-		   "SUBQUERY"))):
+		   (unit->item && unit->item->is_materialized() ?
+		    "MATERIALIZED" : "SUBQUERY")))):
 		((uncacheable & UNCACHEABLE_DEPENDENT) ?
 		 "DEPENDENT UNION":
 		 uncacheable?"UNCACHEABLE UNION":
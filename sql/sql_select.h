@@ -96,11 +96,58 @@ typedef struct st_cache_field {
 } CACHE_FIELD;
 
 
+/*
+  An equality 'outer= inner' of the condition attached to a cached table
+  that is used to look up the cached records matching a row of the table
+  (hash join). 'outer' depends only on the tables in the cache, 'inner'
+  only on the table itself.
+*/
+
+typedef struct st_cache_hash_key {
+  Item *outer, *inner;
+  Item_result type;
+  CHARSET_INFO *collation;
+} CACHE_HASH_KEY;
+
+
+/*
+  One entry per cached record, stored at the end of the join buffer.
+  'head' is the first record of the hash chain with number 'head-1',
+  'next' the following record with the same hash bucket (both are
+  record numbers + 1, 0 ends the chain).
+*/
+
+typedef struct st_cache_hash_entry {
+  uchar *pos;
+  ulong hash;
+  uint head,next;
+} CACHE_HASH_ENTRY;
+
+
+/*
+  The key of a cached record for batched key access, stored at the end of
+  the join buffer after the array of the ranges of all keys. 'next' is
+  the next record with the same key.
+*/
+
+typedef struct st_cache_key_entry {
+  uchar *pos;
+  uint record_nr;
+  struct st_cache_key_entry *next;
+  uchar key[1];
+} CACHE_KEY_ENTRY;
+
+
 typedef struct st_join_cache {
   uchar *buff,*pos,*end;
   uint records,record_nr,ptr_record,fields,length,blobs;
   CACHE_FIELD *field,**blob_ptr;
   SQL_SELECT *select;
+  CACHE_HASH_KEY *hash_key;
+  uint hash_keys;
+  uint entry_length;            /* Hash or key entry of each record */
+  bool key_access;              /* Batched key access of a ref table */
+  HANDLER_BUFFER mrr_buff;      /* For the multi-range read of the keys */
 } JOIN_CACHE;
 
 
@@ -173,6 +220,8 @@ typedef struct st_join_table {
   key_map       keys;                           /* all keys with can be used */
   ha_rows	records,found_records,read_time;
   table_map	dependent,key_dependent;
+  /* Tables with which the table has equalities usable for a hash join */
+  table_map	hash_join_dep;
   uint		use_quick,index;
   uint		status;				// Save status for cache
   uint		used_fields,used_fieldlength,used_blobs;
@@ -207,6 +256,33 @@ typedef struct st_position			/* Used in find_best */
   KEYUSE *key;
 } POSITION;
 
+/*
+  Join order and access methods of a SELECT of a prepared statement or
+  stored procedure, kept across executions (optimizer_plan_cache)
+*/
+
+typedef struct st_cached_position
+{
+  double records_read;
+  double read_time;
+  ha_rows found_records;        /* Range estimate the plan was made with */
+  uint table;                   /* Index in the JOIN_TAB array of tables */
+  uint table_keys;              /* Keys of the table when the plan was made */
+  uint key;                     /* Key of the ref access or MAX_KEY */
+  uint key_parts;
+  bool use_quick;               /* Table is read with a range */
+} CACHED_POSITION;
+
+typedef struct st_join_plan
+{
+  CACHED_POSITION *positions;
+  uint tables;                  /* Non-constant tables */
+  uint max_tables;              /* Size of positions[] */
+  table_map const_table_map;
+  double best_read;
+  bool sort_by_tmp_table;       /* JOIN::sort_by_table was set to 1 */
+} JOIN_PLAN;
+
 typedef struct st_rollup
 {
   enum State { STATE_NONE, STATE_INITED, STATE_READY };
@@ -1374,7 +1374,8 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
           pthread_mutex_unlock(&mysys_var->mutex);
 
 #if !defined(DONT_USE_THR_ALARM) && ! defined(SCO)
-        if (pthread_kill(tmp->real_id,0))
+        /* real_id is 0 for an idle pool-of-threads connection */
+        if (tmp->real_id && pthread_kill(tmp->real_id,0))
           tmp->proc_info="*** DEAD ***";        // This shouldn't happen
 #endif
 #ifdef EXTRA_DEBUG
@@ -1778,13 +1779,21 @@ static bool show_status_array(THD *thd, const char *wild,
 #endif /* HAVE_OPENSSL */
         case SHOW_KEY_CACHE_LONG:
         case SHOW_KEY_CACHE_CONST_LONG:
+          sum_key_cache_counters(dflt_key_cache);
           value= (value-(char*) &dflt_key_cache_var)+ (char*) dflt_key_cache;
           end= int10_to_str(*(long*) value, buff, 10);
           break;
         case SHOW_KEY_CACHE_LONGLONG:
+          sum_key_cache_counters(dflt_key_cache);
 	  value= (value-(char*) &dflt_key_cache_var)+ (char*) dflt_key_cache;
 	  end= longlong10_to_str(*(longlong*) value, buff, 10);
 	  break;
+#ifdef HAVE_QUERY_CACHE
+        case SHOW_QUERY_CACHE_LONG:
+        case SHOW_QUERY_CACHE_CONST_LONG:
+          end= int10_to_str((long) query_cache.status_sum(value), buff, 10);
+          break;
+#endif
         case SHOW_NET_COMPRESSION:
           end= strmov(buff, thd->net.compress ? "ON" : "OFF");
           break;
@@ -3549,6 +3558,76 @@ int fill_open_tables(THD *thd, TABLE_LIST *tables, COND *cond)
 }
 
 
+static bool store_key_cache_record(THD *thd, TABLE *table,
+                                   const char *name, uint name_length,
+                                   KEY_CACHE *key_cache,
+                                   uint segments, uint segment_number)
+{
+  CHARSET_INFO *cs= system_charset_info;
+  restore_record(table, s->default_values);
+  table->field[0]->store(name, name_length, cs);
+  if (segments)
+  {
+    table->field[1]->store((longlong) segments, TRUE);
+    table->field[1]->set_notnull();
+    if (segment_number)
+    {
+      table->field[2]->store((longlong) segment_number, TRUE);
+      table->field[2]->set_notnull();
+    }
+  }
+  table->field[3]->store((longlong) key_cache->key_cache_mem_size, TRUE);
+  table->field[4]->store((longlong) key_cache->key_cache_block_size, TRUE);
+  table->field[5]->store((longlong) key_cache->blocks_used, TRUE);
+  table->field[6]->store((longlong) key_cache->blocks_unused, TRUE);
+  table->field[7]->store((longlong) key_cache->global_blocks_changed, TRUE);
+  table->field[8]->store((longlong) key_cache->global_cache_r_requests, TRUE);
+  table->field[9]->store((longlong) key_cache->global_cache_read, TRUE);
+  table->field[10]->store((longlong) key_cache->global_cache_w_requests, TRUE);
+  table->field[11]->store((longlong) key_cache->global_cache_write, TRUE);
+  table->field[12]->store((longlong) key_cache->global_cache_lock_waits, TRUE);
+  return schema_table_store_record(thd, table);
+}
+
+
+/*
+  Fill INFORMATION_SCHEMA.KEY_CACHES
+
+  DESCRIPTION
+    Every key cache in use gets a row with SEGMENT_NUMBER NULL. For a
+    segmented key cache this row holds the sums over its segments and is
+    followed by a row for every segment.
+*/
+
+int fill_key_caches(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  I_List_iterator<NAMED_LIST> it(key_caches);
+  NAMED_LIST *element;
+  int res= 0;
+  DBUG_ENTER("fill_key_caches");
+
+  pthread_mutex_lock(&LOCK_global_system_variables);
+  while (!res && (element= it++))
+  {
+    KEY_CACHE *key_cache= (KEY_CACHE*) element->data;
+    uint i, segments;
+    if (!key_cache->key_cache_inited)
+      continue;
+    segments= key_cache->segments;
+    sum_key_cache_counters(key_cache);
+    res= store_key_cache_record(thd, table, element->name,
+                                element->name_length, key_cache, segments, 0);
+    for (i= 0; !res && i < segments; i++)
+      res= store_key_cache_record(thd, table, element->name,
+                                  element->name_length,
+                                  key_cache->segment + i, segments, i + 1);
+  }
+  pthread_mutex_unlock(&LOCK_global_system_variables);
+  DBUG_RETURN(res);
+}
+
+
 int fill_variables(THD *thd, TABLE_LIST *tables, COND *cond)
 {
   DBUG_ENTER("fill_variables");
@@ -4304,6 +4383,25 @@ ST_FIELD_INFO table_constraints_fields_info[]=
 };
 
 
+ST_FIELD_INFO key_caches_fields_info[]=
+{
+  {"KEY_CACHE_NAME", NAME_LEN, MYSQL_TYPE_STRING, 0, 0, 0},
+  {"SEGMENTS", 3, MYSQL_TYPE_LONG, 0, 1, 0},
+  {"SEGMENT_NUMBER", 3, MYSQL_TYPE_LONG, 0, 1, 0},
+  {"FULL_SIZE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"BLOCK_SIZE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"USED_BLOCKS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"UNUSED_BLOCKS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"DIRTY_BLOCKS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"READ_REQUESTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"READS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"WRITE_REQUESTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"WRITES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {"LOCK_WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0}
+};
+
+
 ST_FIELD_INFO key_column_usage_fields_info[]=
 {
   {"CONSTRAINT_CATALOG", FN_REFLEN, MYSQL_TYPE_STRING, 0, 1, 0},
@@ -4391,6 +4489,8 @@ ST_SCHEMA_TABLE schema_tables[]=
    get_all_tables, make_columns_old_format, get_schema_column_record, 1, 2, 0},
   {"COLUMN_PRIVILEGES", column_privileges_fields_info, create_schema_table,
     fill_schema_column_privileges, 0, 0, -1, -1, 0},
+  {"KEY_CACHES", key_caches_fields_info, create_schema_table,
+    fill_key_caches, 0, 0, -1, -1, 0},
   {"KEY_COLUMN_USAGE", key_column_usage_fields_info, create_schema_table,
     get_all_tables, 0, get_schema_key_column_usage_record, 4, 5, 0},
   {"OPEN_TABLES", open_tables_fields_info, create_schema_table,
@@ -17,6 +17,10 @@
 
 #define MERGEBUFF		7
 #define MERGEBUFF2		15
+/* Least number of bytes read at a time from every merged sequence */
+#define MERGEBUFF_MIN_READ	(IO_SIZE*4)
+/* Least number of keys each thread sorts when a buffer is split up */
+#define MIN_KEYS_PER_SORT_THREAD 8192
 
 /*
    The structure SORT_ADDON_FIELD describes a fixed layout
@@ -63,6 +67,7 @@ typedef struct st_sort_param {
   uint addon_length;        /* Length of added packed fields */
   uint res_length;          /* Length of records in final sorted file/buffer */
   uint keys;				/* Max keys / buffer */
+  uint sort_threads;                    /* Threads used to sort a buffer */
   ha_rows max_rows,examined_rows;
   TABLE *sort_form;			/* For quicker make_sortkey */
   SORT_FIELD *local_sortorder;
@@ -77,6 +82,7 @@ typedef struct st_sort_param {
 } SORTPARAM;
 
 
+uint merge_width(uint keys, uint rec_length);
 int merge_many_buff(SORTPARAM *param, uchar *sort_buffer,
 		    BUFFPEK *buffpek,
 		    uint *maxbuffer, IO_CACHE *t_file);
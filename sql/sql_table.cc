@@ -3066,6 +3066,157 @@ bool alter_table_manage_keys(TABLE *table, int indexes_were_disabled,
 }
 
 
+/*
+  Check if two keys have the same definition
+*/
+
+static bool alter_table_keys_are_equal(KEY *key, KEY *new_key)
+{
+  KEY_PART_INFO *key_part, *new_key_part, *end;
+
+  if (my_strcasecmp(system_charset_info, key->name, new_key->name) ||
+      ((key->flags ^ new_key->flags) & (HA_NOSAME | HA_FULLTEXT |
+                                        HA_SPATIAL)) ||
+      key->algorithm != new_key->algorithm ||
+      key->key_parts != new_key->key_parts)
+    return FALSE;
+  end= key->key_part + key->key_parts;
+  for (key_part= key->key_part, new_key_part= new_key->key_part ;
+       key_part < end ;
+       key_part++, new_key_part++)
+  {
+    if (key_part->fieldnr != new_key_part->fieldnr ||
+        key_part->length != new_key_part->length)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Add and drop keys in the storage engine without copying the table
+
+  SYNOPSIS
+    alter_table_change_indexes()
+      thd                    Thread handler
+      table                  Table to alter, opened and locked
+      path                   Name of the .frm file of the new definition,
+                             created with frm_only
+      create_info            Create info of the new definition
+      need_copy_table  out   Set to TRUE if the data must be copied
+
+  DESCRIPTION
+    Compares the keys of the table with the keys of the new definition.
+    If the handler can create and drop all keys that differ while the
+    table is locked (HA_DDL_WITH_LOCK), the new keys are created with
+    handler::add_index() and then the old ones are dropped with
+    handler::drop_index(). Readers of the table are only waited for
+    when keys are dropped.
+
+    The primary key is never changed in place, nor is a key dropped and
+    added again under the same name. In these cases the handler table
+    of the new definition is created and the data must be copied. The
+    data is also copied when a new unique key has duplicates, so that
+    the error names the duplicate value.
+
+  RETURN VALUES
+    FALSE  OK
+    TRUE   Error
+*/
+
+static
+bool alter_table_change_indexes(THD *thd, TABLE *table, const char *path,
+                                HA_CREATE_INFO *create_info,
+                                bool *need_copy_table)
+{
+  TABLE new_table;
+  KEY *key, *key_end, *new_key, *new_key_end;
+  KEY *add_keys;
+  uint *drop_keys;
+  uint add_count= 0, drop_count= 0;
+  int error= 0;
+  DBUG_ENTER("alter_table_change_indexes");
+
+  if (openfrm(thd, path, "", 0, (uint) READ_ALL, 0, &new_table))
+    DBUG_RETURN(TRUE);
+
+  add_keys= (KEY*) thd->alloc(sizeof(KEY) * new_table.s->keys + 1);
+  drop_keys= (uint*) thd->alloc(sizeof(uint) * table->s->keys + 1);
+  if (!add_keys || !drop_keys)
+  {
+    VOID(closefrm(&new_table));
+    DBUG_RETURN(TRUE);
+  }
+
+  key_end= table->key_info + table->s->keys;
+  new_key_end= new_table.key_info + new_table.s->keys;
+
+  for (key= table->key_info ; key < key_end ; key++)
+  {
+    for (new_key= new_table.key_info ; new_key < new_key_end ; new_key++)
+    {
+      if (alter_table_keys_are_equal(key, new_key))
+        break;
+    }
+    if (new_key == new_key_end)
+    {
+      if ((uint) (key - table->key_info) == table->s->primary_key ||
+          !(table->file->index_ddl_flags(key) & HA_DDL_WITH_LOCK))
+        goto copy;
+      drop_keys[drop_count++]= (uint) (key - table->key_info);
+    }
+  }
+
+  for (new_key= new_table.key_info ; new_key < new_key_end ; new_key++)
+  {
+    for (key= table->key_info ; key < key_end ; key++)
+    {
+      if (!my_strcasecmp(system_charset_info, key->name, new_key->name))
+        break;
+    }
+    if (key != key_end)
+    {
+      if (alter_table_keys_are_equal(key, new_key))
+        continue;
+      goto copy;                                // Redefined key
+    }
+    if ((uint) (new_key - new_table.key_info) == new_table.s->primary_key ||
+        !(table->file->index_ddl_flags(new_key) & HA_DDL_WITH_LOCK))
+      goto copy;
+    add_keys[add_count++]= *new_key;
+  }
+
+  thd->proc_info="manage keys";
+  if (add_count)
+  {
+    error= table->file->add_index(&new_table, add_keys, add_count);
+    /*
+      The handler has removed the new keys again. Copy the table, which
+      reports the duplicate value of the key.
+    */
+    if (error == HA_ERR_FOUND_DUPP_KEY)
+      goto copy;
+  }
+  if (!error && drop_count)
+  {
+    VOID(pthread_mutex_lock(&LOCK_open));
+    wait_while_table_is_used(thd, table, HA_EXTRA_FORCE_REOPEN);
+    VOID(pthread_mutex_unlock(&LOCK_open));
+    error= table->file->drop_index(table, drop_keys, drop_count);
+  }
+  if (error)
+    table->file->print_error(error, MYF(0));
+  VOID(closefrm(&new_table));
+  DBUG_RETURN(error != 0);
+
+copy:
+  VOID(closefrm(&new_table));
+  *need_copy_table= TRUE;
+  create_info->frm_only= FALSE;
+  DBUG_RETURN(ha_create_table(path, create_info, 0) != 0);
+}
+
+
 /*
   Alter table
 
@@ -3092,7 +3243,7 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   ulonglong next_insert_id;
   uint db_create_options, used_fields;
   enum db_type old_db_type, new_db_type, table_type;
-  bool need_copy_table;
+  bool need_copy_table, change_indexes;
   bool no_table_reopen= FALSE, varchar= FALSE;
   frm_type_enum frm_type;
   /*
@@ -3703,8 +3854,24 @@ view_err:
     disable fast alter table for all tables created by mysql versions
     prior to 5.0 branch.
     See BUG#6236.
+
+    Secondary keys may be added and dropped by the handler without a
+    copy of the table, see alter_table_change_indexes().
   */
-  need_copy_table= (alter_info->flags &
+  change_indexes= (alter_info->flags &&
+                   !(alter_info->flags &
+                     ~(ALTER_ADD_INDEX | ALTER_DROP_INDEX)) &&
+                   !(create_info->used_fields &
+                     ~(HA_CREATE_USED_COMMENT|HA_CREATE_USED_PASSWORD)) &&
+                   !table->s->tmp_table &&
+                   table->s->mysql_version &&
+                   !(table->s->frm_version < FRM_VER_TRUE_VARCHAR &&
+                     varchar) &&
+                   new_db_type == old_db_type &&
+                   new_name == table_name && new_db == db &&
+                   !ignore);
+  need_copy_table= !change_indexes &&
+                   (alter_info->flags &
                     ~(ALTER_CHANGE_COLUMN_DEFAULT|ALTER_OPTIONS) ||
                     (create_info->used_fields &
                      ~(HA_CREATE_USED_COMMENT|HA_CREATE_USED_PASSWORD)) ||
@@ -3769,6 +3936,17 @@ view_err:
     if (error)
       DBUG_RETURN(error);
   }
+  if (change_indexes)
+  {
+    char path[FN_REFLEN];
+    build_table_path(path, sizeof(path), new_db, tmp_name, reg_ext);
+    if (alter_table_change_indexes(thd, table, path, create_info,
+                                   &need_copy_table))
+    {
+      VOID(quick_rm_table(DB_TYPE_UNKNOWN, new_db, tmp_name));
+      goto err;
+    }
+  }
   if (need_copy_table)
   {
     if (table->s->tmp_table)
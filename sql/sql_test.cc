@@ -420,6 +420,7 @@ static int print_key_cache_status(const char *name, KEY_CACHE *key_cache)
   }
   else
   {
+    sum_key_cache_counters(key_cache);
     printf("%s\n\
 Buffer_size:    %10lu\n\
 Block_size:     %10lu\n\
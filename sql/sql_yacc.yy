@@ -3078,6 +3078,7 @@ key_def:
                          HA_KEY_ALG_UNDEF, 1,
                          lex->col_list);
             lex->alter_info.key_list.push_back(key);
+            lex->alter_info.flags|= ALTER_FOREIGN_KEY;
 	    lex->col_list.empty();		/* Alloced by sql_alloc */
 	  }
 	| constraint opt_check_constraint
@@ -3769,7 +3770,7 @@ alter_list_item:
 	  }
 	| DROP FOREIGN KEY_SYM opt_ident
           {
-	    Lex->alter_info.flags|= ALTER_DROP_INDEX;
+	    Lex->alter_info.flags|= ALTER_DROP_INDEX | ALTER_FOREIGN_KEY;
           }
 	| DROP PRIMARY_SYM KEY_SYM
 	  {
@@ -1825,12 +1825,13 @@ void TABLE_LIST::set_underlying_merge()
   if ((tbl= merge_underlying_list))
   {
     /* This is a view. Process all tables of view */
-    DBUG_ASSERT(view && effective_algorithm == VIEW_ALGORITHM_MERGE);
+    DBUG_ASSERT((view || derived) &&
+                effective_algorithm == VIEW_ALGORITHM_MERGE);
     do
     {
       if (tbl->merge_underlying_list)          // This is a view
       {
-        DBUG_ASSERT(tbl->view &&
+        DBUG_ASSERT((tbl->view || tbl->derived) &&
                     tbl->effective_algorithm == VIEW_ALGORITHM_MERGE);
         /*
           This is the only case where set_ancestor is called on an object
@@ -1849,6 +1850,27 @@ void TABLE_LIST::set_underlying_merge()
 }
 
 
+/*
+  Get the SELECT of a merged VIEW or derived table
+
+  SYNOPSIS
+    TABLE_LIST::get_single_select()
+
+  NOTE
+    Only VIEWs and derived tables without UNION are merged, so there
+    is only one SELECT.
+
+  RETURN
+    SELECT_LEX which columns are represented by this table reference
+*/
+
+st_select_lex *TABLE_LIST::get_single_select()
+{
+  SELECT_LEX_UNIT *unit= (view ? &view->unit : derived);
+  return unit->first_select();
+}
+
+
 /*
   setup fields of placeholder of merged VIEW
 
@@ -1873,7 +1895,7 @@ bool TABLE_LIST::setup_underlying(THD *thd)
   if (!field_translation && merge_underlying_list)
   {
     Field_translator *transl;
-    SELECT_LEX *select= &view->select_lex;
+    SELECT_LEX *select= get_single_select();
     Item *item;
     TABLE_LIST *tbl;
     List_iterator_fast<Item> it(select->item_list);
@@ -1913,12 +1935,12 @@ bool TABLE_LIST::setup_underlying(THD *thd)
     /* TODO: use hash for big number of fields */
 
     /* full text function moving to current select */
-    if (view->select_lex.ftfunc_list->elements)
+    if (select->ftfunc_list->elements)
     {
       Item_func_match *ifm;
       SELECT_LEX *current_select= thd->lex->current_select;
       List_iterator_fast<Item_func_match>
-        li(*(view->select_lex.ftfunc_list));
+        li(*(select->ftfunc_list));
       while ((ifm= li++))
         current_select->ftfunc_list->push_front(ifm);
     }
@@ -1952,7 +1974,8 @@ bool TABLE_LIST::prep_where(THD *thd, Item **conds,
 
   for (TABLE_LIST *tbl= merge_underlying_list; tbl; tbl= tbl->next_local)
   {
-    if (tbl->view && tbl->prep_where(thd, conds, no_where_clause))
+    if ((tbl->view || tbl->is_merged_derived()) &&
+        tbl->prep_where(thd, conds, no_where_clause))
     {
       DBUG_RETURN(TRUE);
     }
@@ -2332,8 +2355,8 @@ bool TABLE_LIST::set_insert_values(MEM_ROOT *mem_root)
 */
 bool TABLE_LIST::is_leaf_for_name_resolution()
 {
-  return (view || is_natural_join || is_join_columns_complete ||
-          !nested_join);
+  return (view || is_merged_derived() || is_natural_join ||
+          is_join_columns_complete || !nested_join);
 }
 
 
@@ -2791,7 +2814,7 @@ Item *create_view_field(THD *thd, TABLE_LIST *view, Item **field_ref,
   {
     DBUG_RETURN(field);
   }
-  Item *item= new Item_direct_view_ref(&view->view->select_lex.context,
+  Item *item= new Item_direct_view_ref(&view->get_single_select()->context,
                                        field_ref, view->alias,
                                        name);
   DBUG_RETURN(item);
@@ -2847,7 +2870,7 @@ void Field_iterator_table_ref::set_field_iterator()
   /* This is a merge view, so use field_translation. */
   else if (table_ref->field_translation)
   {
-    DBUG_ASSERT(table_ref->view &&
+    DBUG_ASSERT((table_ref->view || table_ref->derived) &&
                 table_ref->effective_algorithm == VIEW_ALGORITHM_MERGE);
     field_it= &view_field_it;
     DBUG_PRINT("info", ("field_it for '%s' is Field_iterator_view",
@@ -2898,6 +2921,8 @@ const char *Field_iterator_table_ref::table_name()
 {
   if (table_ref->view)
     return table_ref->view_name.str;
+  else if (table_ref->is_merged_derived())
+    return table_ref->alias;
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->table_name();
 
@@ -2911,6 +2936,8 @@ const char *Field_iterator_table_ref::db_name()
 {
   if (table_ref->view)
     return table_ref->view_db.str;
+  else if (table_ref->is_merged_derived())
+    return table_ref->db;
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->db_name();
 
@@ -2929,7 +2956,7 @@ const char *Field_iterator_table_ref::db_name()
 
 GRANT_INFO *Field_iterator_table_ref::grant()
 {
-  if (table_ref->view)
+  if (table_ref->view || table_ref->is_merged_derived())
     return &(table_ref->grant);
   else if (table_ref->is_natural_join)
     return natural_join_it.column_ref()->grant();
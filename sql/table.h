@@ -283,6 +283,8 @@ struct st_table {
   uint		db_stat;		/* mode of file as in handler.h */
   /* number of select if it is derived table */
   uint          derived_select_number;
+  /* estimated number of rows of a derived table that is not filled yet */
+  ha_rows       derived_rows;
   int		current_lock;           /* Type of lock on table */
   my_bool copy_blobs;			/* copy_blobs when storing */
 
@@ -319,7 +321,15 @@ struct st_table {
   */
   my_bool open_placeholder;
   my_bool locked_by_name;
+  /*
+    The table is kept in the private table cache of in_use between
+    statements, see close_thread_tables(). Protected by
+    in_use->LOCK_private_tables.
+  */
+  my_bool in_private_cache;
   my_bool fulltext_searched;
+  /* derived table is filled on first read, see mysql_derived_materialize() */
+  my_bool derived_pending;
   my_bool no_cache;
   /* To signal that we should reset query_id for tables and cols */
   my_bool clear_query_id;
@@ -374,6 +384,7 @@ enum enum_schema_tables
   SCH_COLLATION_CHARACTER_SET_APPLICABILITY,
   SCH_COLUMNS,
   SCH_COLUMN_PRIVILEGES,
+  SCH_KEY_CACHES,
   SCH_KEY_COLUMN_USAGE,
   SCH_OPEN_TABLES,
   SCH_PROCEDURES,
@@ -612,7 +623,7 @@ struct TABLE_LIST
   /*
     List (based on next_local) of underlying tables of this view. I.e. it
     does not include the tables of subqueries used in the view. Is set only
-    for merged views.
+    for merged views and merged derived tables.
   */
   TABLE_LIST	*merge_underlying_list;
   /*
@@ -740,6 +751,10 @@ struct TABLE_LIST
   TABLE_LIST *first_leaf_for_name_resolution();
   TABLE_LIST *last_leaf_for_name_resolution();
   bool is_leaf_for_name_resolution();
+  st_select_lex *get_single_select();
+  /* derived table merged into the outer query, see mysql_derived_prepare() */
+  inline bool is_merged_derived()
+    { return derived && merge_underlying_list; }
   inline TABLE_LIST *top_table()
     { return belong_to_view ? belong_to_view : this; }
   inline bool prepare_check_option(THD *thd)
@@ -103,6 +103,8 @@ inline double log2_n_fact(double x)
       elem_size   Size of element stored in buffer
       first       Pointer to first merged element size
       last        Pointer to last merged element size
+      compare_factor  # of rowid comparisons per disk seek, see
+                      TIME_FOR_COMPARE_ROWID
 
   RETURN
     Cost of merge_buffers operation in disk seeks.
@@ -120,11 +122,12 @@ inline double log2_n_fact(double x)
     the same length, so each of total_buf_size elements will be added to a sort
     heap with (n_buffers-1) elements. This gives the comparison cost:
 
-      total_buf_elems* log2(n_buffers) / TIME_FOR_COMPARE_ROWID;
+      total_buf_elems* log2(n_buffers) / compare_factor;
 */
 
 static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
-                                     uint *first, uint *last)
+                                     uint *first, uint *last,
+                                     double compare_factor)
 {
   uint total_buf_elems= 0;
   for (uint *pbuf= first; pbuf <= last; pbuf++)
@@ -135,7 +138,7 @@ static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
 
   /* Using log2(n)=log(n)/log(2) formula */
   return 2*((double)total_buf_elems*elem_size) / IO_SIZE +
-     total_buf_elems*log((double) n_buffers) / (TIME_FOR_COMPARE_ROWID * M_LN2);
+     total_buf_elems*log((double) n_buffers) / (compare_factor * M_LN2);
 }
 
 
@@ -154,6 +157,8 @@ static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
       max_n_elems   # of elements in first maxbuffer buffers
       last_n_elems  # of elements in last buffer
       elem_size     size of buffer element
+      width         # of buffers merged at once, see merge_width()
+      compare_factor  # of rowid comparisons per disk seek
 
   NOTES
     maxbuffer+1 buffers are merged, where first maxbuffer buffers contain
@@ -168,7 +173,8 @@ static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
 
 static double get_merge_many_buffs_cost(uint *buffer,
                                         uint maxbuffer, uint max_n_elems,
-                                        uint last_n_elems, int elem_size)
+                                        uint last_n_elems, int elem_size,
+                                        uint width, double compare_factor)
 {
   register int i;
   double total_cost= 0.0;
@@ -186,28 +192,31 @@ static double get_merge_many_buffs_cost(uint *buffer,
     Do it exactly as merge_many_buff function does, calling
     get_merge_buffers_cost to get cost of merge_buffers.
   */
-  if (maxbuffer >= MERGEBUFF2)
+  if (maxbuffer >= width)
   {
-    while (maxbuffer >= MERGEBUFF2)
+    while (maxbuffer >= width)
     {
       uint lastbuff= 0;
-      for (i = 0; i <= (int) maxbuffer - MERGEBUFF*3/2; i += MERGEBUFF)
+      for (i = 0; i <= (int) maxbuffer - (int) (width*3/2); i += width)
       {
         total_cost+=get_merge_buffers_cost(buff_elems, elem_size,
                                            buff_elems + i,
-                                           buff_elems + i + MERGEBUFF-1);
+                                           buff_elems + i + width-1,
+                                           compare_factor);
 	lastbuff++;
       }
       total_cost+=get_merge_buffers_cost(buff_elems, elem_size,
                                          buff_elems + i,
-                                         buff_elems + maxbuffer);
+                                         buff_elems + maxbuffer,
+                                         compare_factor);
       maxbuffer= lastbuff;
     }
   }
 
   /* Simulate final merge_buff call. */
   total_cost += get_merge_buffers_cost(buff_elems, elem_size,
-                                       buff_elems, buff_elems + maxbuffer);
+                                       buff_elems, buff_elems + maxbuffer,
+                                       compare_factor);
   return total_cost;
 }
 
@@ -223,6 +232,8 @@ static double get_merge_many_buffs_cost(uint *buffer,
       nkeys     #of elements in Unique
       key_size  size of each elements in bytes
       max_in_memory_size amount of memory Unique will be allowed to use
+      compare_factor  # of rowid comparisons per disk seek, normally
+                      TIME_FOR_COMPARE_ROWID
 
   RETURN
     Cost in disk seeks.
@@ -240,7 +251,7 @@ static double get_merge_many_buffs_cost(uint *buffer,
 
       n_compares = 2*(log2(2) + log2(3) + ... + log2(N+1)) = 2*log2((N+1)!)
 
-      then cost(tree_creation) = n_compares*ROWID_COMPARE_COST;
+      then cost(tree_creation) = n_compares / compare_factor;
 
       Total cost of creating trees:
       (n_trees - 1)*max_size_tree_cost + non_max_size_tree_cost.
@@ -260,16 +271,19 @@ static double get_merge_many_buffs_cost(uint *buffer,
 */
 
 double Unique::get_use_cost(uint *buffer, uint nkeys, uint key_size,
-                            ulonglong max_in_memory_size)
+                            ulonglong max_in_memory_size,
+                            double compare_factor)
 {
   ulong max_elements_in_tree;
   ulong last_tree_elems;
+  uint  keys_in_memory; /* as in Unique::get() */
   int   n_full_trees; /* number of trees in unique - 1 */
   double result;
 
   max_elements_in_tree= ((ulong) max_in_memory_size /
                          ALIGN_SIZE(sizeof(TREE_ELEMENT)+key_size));
 
+  keys_in_memory= (uint) (max_in_memory_size / key_size);
   n_full_trees=    nkeys / max_elements_in_tree;
   last_tree_elems= nkeys % max_elements_in_tree;
 
@@ -277,7 +291,7 @@ double Unique::get_use_cost(uint *buffer, uint nkeys, uint key_size,
   result= 2*log2_n_fact(last_tree_elems + 1.0);
   if (n_full_trees)
     result+= n_full_trees * log2_n_fact(max_elements_in_tree + 1.0);
-  result /= TIME_FOR_COMPARE_ROWID;
+  result /= compare_factor;
 
   DBUG_PRINT("info",("unique trees sizes: %u=%u*%lu + %lu", nkeys,
                      n_full_trees, n_full_trees?max_elements_in_tree:0,
@@ -298,7 +312,10 @@ double Unique::get_use_cost(uint *buffer, uint nkeys, uint key_size,
   /* Cost of merge */
   double merge_cost= get_merge_many_buffs_cost(buffer, n_full_trees,
                                                max_elements_in_tree,
-                                               last_tree_elems, key_size);
+                                               last_tree_elems, key_size,
+                                               merge_width(keys_in_memory,
+                                                           key_size),
+                                               compare_factor);
   if (merge_cost < 0.0)
     return merge_cost;
 